@@ -0,0 +1,303 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Microbenchmarks for the hot ADTs in ir/adt.
+ *
+ * The unittests cover correctness only; this harness measures the data
+ * structures the compiler leans on in every pass: the hashset instantiations
+ * (pset_new, set), the deq worklists, bitsets, the priority queue and
+ * obstack allocation patterns. The workloads are deterministic (fixed PRNG
+ * seed) and shaped like typical pass behaviour: worklist algorithms mixing
+ * pushes and pops, membership tests with a realistic hit rate, and
+ * allocation bursts that are released wholesale.
+ *
+ * Timing uses the cycle counter from ir/stat/stat_timing.h. Reports are
+ * JSON; pass a previous report with -b to detect regressions:
+ *
+ *   adtbench -o baseline.json           # record on the good revision
+ *   adtbench -b baseline.json -t 10     # compare after an ir/adt change
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchreport.h"
+#include "bitset.h"
+#include "obst.h"
+#include "pdeq.h"
+#include "pqueue.h"
+#include "pset_new.h"
+#include "set.h"
+#include "stat_timing.h"
+
+/** Scale factor for all workloads (-s). */
+static int scale   = 10;
+/** Number of measurement repetitions (-r), the fastest run counts. */
+static int repeats = 3;
+
+/** Sink to keep the compiler from optimizing workloads away. */
+static volatile uint64_t sink;
+
+static uint64_t rng_state;
+
+/** xorshift PRNG; fixed seed so every run replays the same workload. */
+static uint32_t rng_next(void)
+{
+	uint64_t x = rng_state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	rng_state = x;
+	return (uint32_t)x;
+}
+
+static void rng_reset(void)
+{
+	rng_state = 0x2545F4914F6CDD1DULL;
+}
+
+/**
+ * pset_new: pointer membership the way the optimizations track visited
+ * nodes; inserts, lookups with a realistic miss share, deletions.
+ */
+static void bench_pset_new(void)
+{
+	size_t const n = 20000 * (size_t)scale;
+
+	pset_new_t pset;
+	pset_new_init(&pset);
+	for (size_t i = 0; i < n; ++i)
+		pset_new_insert(&pset, (void*)(uintptr_t)((rng_next() << 4) | 8));
+
+	rng_reset();
+	uint64_t hits = 0;
+	for (size_t i = 0; i < 2 * n; ++i) {
+		uint32_t const r = rng_next();
+		/* every other probe hits an inserted pointer */
+		uintptr_t const key = (i % 2 == 0) ? ((uintptr_t)r << 4) | 8
+		                                   : ((uintptr_t)r << 4) | 4;
+		hits += pset_new_contains(&pset, (void*)key);
+	}
+
+	rng_reset();
+	for (size_t i = 0; i < n / 2; ++i) {
+		void *const ptr = (void*)(uintptr_t)((rng_next() << 4) | 8);
+		if (pset_new_contains(&pset, ptr))
+			pset_new_remove(&pset, ptr);
+	}
+
+	sink += hits + pset_new_size(&pset);
+	pset_new_destroy(&pset);
+}
+
+typedef struct set_key_t {
+	unsigned a;
+	unsigned b;
+} set_key_t;
+
+static int set_key_cmp(void const *const p1, void const *const p2,
+                       size_t const size)
+{
+	(void)size;
+	return memcmp(p1, p2, sizeof(set_key_t));
+}
+
+/**
+ * set: copying hashset keyed by small structs, as used for value tables.
+ */
+static void bench_set(void)
+{
+	size_t const n = 20000 * (size_t)scale;
+
+	set *const s = new_set(set_key_cmp, 64);
+	for (size_t i = 0; i < n; ++i) {
+		set_key_t key = { .a = rng_next() % (n / 4), .b = rng_next() % 16 };
+		set_insert(set_key_t, s, &key, sizeof(key), key.a ^ (key.b << 27));
+	}
+	rng_reset();
+	uint64_t hits = 0;
+	for (size_t i = 0; i < n; ++i) {
+		set_key_t key = { .a = rng_next() % (n / 4), .b = rng_next() % 16 };
+		hits += set_find(set_key_t, s, &key, sizeof(key),
+		                 key.a ^ (key.b << 27)) != NULL;
+	}
+	sink += hits + set_count(s);
+	del_set(s);
+}
+
+/**
+ * deq: breadth-first worklist pattern, bursts of pushes followed by pops.
+ */
+static void bench_deq(void)
+{
+	size_t const n = 40000 * (size_t)scale;
+	static char dummy[64];
+
+	deq_t deq;
+	deq_init(&deq);
+	size_t length = 0;
+	for (size_t i = 0; i < n; ++i) {
+		unsigned const burst = rng_next() % 8;
+		for (unsigned b = 0; b < burst; ++b) {
+			deq_push_pointer_right(&deq, &dummy[b]);
+			++length;
+		}
+		if (length > 0) {
+			sink += (uintptr_t)deq_pop_pointer_left(char, &deq);
+			--length;
+		}
+	}
+	while (!deq_empty(&deq))
+		sink += (uintptr_t)deq_pop_pointer_left(char, &deq);
+	deq_free(&deq);
+}
+
+/**
+ * pqueue: priority driven scheduling, interleaved puts and pops.
+ */
+static void bench_pqueue(void)
+{
+	size_t const n = 20000 * (size_t)scale;
+	static char dummy;
+
+	pqueue_t *const q = new_pqueue();
+	for (size_t i = 0; i < n; ++i) {
+		pqueue_put(q, &dummy, (int)(rng_next() % 1000));
+		if (i % 3 == 0)
+			sink += (uintptr_t)pqueue_pop_front(q);
+	}
+	while (!pqueue_empty(q))
+		sink += (uintptr_t)pqueue_pop_front(q);
+	del_pqueue(q);
+}
+
+/**
+ * bitset: sparse population, membership tests and full iterations, like
+ * the liveness and dominance bitsets in the backend.
+ */
+static void bench_bitset(void)
+{
+	size_t const n_bits = 1 << 18;
+	size_t const n_ops  = 20000 * (size_t)scale;
+
+	bitset_t *const bs = bitset_malloc(n_bits);
+	for (size_t i = 0; i < n_ops; ++i)
+		bitset_set(bs, rng_next() % n_bits);
+	uint64_t count = 0;
+	for (int sweep = 0; sweep < 8; ++sweep) {
+		bitset_foreach(bs, elm) {
+			count += elm;
+		}
+	}
+	for (size_t i = 0; i < n_ops; ++i)
+		count += bitset_is_set(bs, rng_next() % n_bits);
+	sink += count;
+	free(bs);
+}
+
+/**
+ * obstack: the allocate-much, free-wholesale pattern of per-pass scratch
+ * data.
+ */
+static void bench_obstack(void)
+{
+	size_t const n = 40000 * (size_t)scale;
+
+	struct obstack obst;
+	obstack_init(&obst);
+	void *checkpoint = obstack_alloc(&obst, 1);
+	for (size_t i = 0; i < n; ++i) {
+		size_t const size = 16 + rng_next() % 113;
+		char *const data = obstack_alloc(&obst, size);
+		data[0] = (char)i;
+		data[size - 1] = (char)size;
+		sink += (uintptr_t)data & 0xFF;
+		/* passes drop their scratch memory wholesale once in a while */
+		if (i % 8192 == 8191) {
+			obstack_free(&obst, checkpoint);
+			checkpoint = obstack_alloc(&obst, 1);
+		}
+	}
+	obstack_free(&obst, NULL);
+}
+
+typedef struct benchmark_t {
+	char const *name;
+	void      (*run)(void);
+} benchmark_t;
+
+static benchmark_t const benchmarks[] = {
+	{ "pset-new", bench_pset_new },
+	{ "set",      bench_set      },
+	{ "deq",      bench_deq      },
+	{ "pqueue",   bench_pqueue   },
+	{ "bitset",   bench_bitset   },
+	{ "obstack",  bench_obstack  },
+};
+
+#define N_BENCHMARKS ((int)(sizeof(benchmarks)/sizeof(benchmarks[0])))
+
+int main(int argc, char **argv)
+{
+	char const *output    = NULL;
+	char const *baseline  = NULL;
+	double      threshold = 10.0;
+
+	for (int i = 1; i < argc; ++i) {
+		char const *const arg = argv[i];
+		if (strcmp(arg, "-o") == 0 && i + 1 < argc) {
+			output = argv[++i];
+		} else if (strcmp(arg, "-b") == 0 && i + 1 < argc) {
+			baseline = argv[++i];
+		} else if (strcmp(arg, "-t") == 0 && i + 1 < argc) {
+			threshold = strtod(argv[++i], NULL);
+		} else if (strcmp(arg, "-r") == 0 && i + 1 < argc) {
+			repeats = atoi(argv[++i]);
+		} else if (strcmp(arg, "-s") == 0 && i + 1 < argc) {
+			scale = atoi(argv[++i]);
+		} else {
+			printf("usage: adtbench [-o report.json] [-b baseline.json]"
+			       " [-t threshold%%] [-r repeats] [-s scale]\n");
+			return strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0
+			     ? 0 : 2;
+		}
+	}
+
+	bench_result_t results[N_BENCHMARKS];
+	for (int i = 0; i < N_BENCHMARKS; ++i) {
+		unsigned long long best = 0;
+		for (int r = 0; r < repeats; ++r) {
+			rng_reset();
+			timing_ticks_t const start = timing_ticks();
+			benchmarks[i].run();
+			timing_ticks_t const ticks = timing_ticks() - start;
+			if (best == 0 || ticks < best)
+				best = ticks;
+		}
+		results[i].name  = benchmarks[i].name;
+		results[i].value = best;
+	}
+
+	if (output != NULL) {
+		FILE *const out = fopen(output, "w");
+		if (out == NULL) {
+			fprintf(stderr, "adtbench: cannot write '%s'\n", output);
+			return 2;
+		}
+		bench_write_report(out, results, N_BENCHMARKS);
+		fclose(out);
+	} else {
+		bench_write_report(stdout, results, N_BENCHMARKS);
+	}
+
+	if (baseline != NULL)
+		return bench_compare_baseline(baseline, results, N_BENCHMARKS,
+		                              threshold);
+	return 0;
+}
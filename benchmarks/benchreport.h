@@ -0,0 +1,112 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   JSON reporting and baseline comparison shared by the benchmark
+ *          harnesses.
+ *
+ * Reports are flat JSON objects mapping benchmark names to integral
+ * measurements. A report written by one run can be fed back as baseline to a
+ * later run; values above the allowed threshold are flagged as regressions.
+ */
+#ifndef FIRM_BENCHMARKS_BENCHREPORT_H
+#define FIRM_BENCHMARKS_BENCHREPORT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct bench_result_t {
+	char const        *name;
+	unsigned long long value;
+} bench_result_t;
+
+static void bench_write_report(FILE *const out,
+                               bench_result_t const *const results,
+                               int const n_results)
+{
+	unsigned long long total = 0;
+	fprintf(out, "{\n");
+	for (int i = 0; i < n_results; ++i) {
+		fprintf(out, "\t\"%s\": %llu,\n", results[i].name, results[i].value);
+		total += results[i].value;
+	}
+	fprintf(out, "\t\"total\": %llu\n}\n", total);
+}
+
+/**
+ * Look up @p key in a flat JSON object of the form written by
+ * bench_write_report(). Returns -1 if the key is missing.
+ */
+static long long bench_json_get(char const *const text, char const *const key)
+{
+	for (char const *c = text; (c = strchr(c, '"')) != NULL;) {
+		++c;
+		size_t const len = strlen(key);
+		if (strncmp(c, key, len) == 0 && c[len] == '"') {
+			c = strchr(c + len, ':');
+			if (c == NULL)
+				return -1;
+			return strtoll(c + 1, NULL, 10);
+		}
+		c = strchr(c, '"');
+		if (c == NULL)
+			break;
+		++c;
+	}
+	return -1;
+}
+
+static char *bench_read_file(char const *const filename)
+{
+	FILE *const f = fopen(filename, "r");
+	if (f == NULL)
+		return NULL;
+	fseek(f, 0, SEEK_END);
+	long const size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	char *const buf = malloc(size + 1);
+	size_t const got = fread(buf, 1, size, f);
+	buf[got] = '\0';
+	fclose(f);
+	return buf;
+}
+
+/**
+ * Compare @p results against the report in @p filename. Prints one line per
+ * benchmark to stderr. Returns 0 if everything is within @p threshold
+ * percent of the baseline, 1 on regression, 2 if the baseline is unreadable.
+ */
+static int bench_compare_baseline(char const *const filename,
+                                  bench_result_t const *const results,
+                                  int const n_results, double const threshold)
+{
+	char *const baseline = bench_read_file(filename);
+	if (baseline == NULL) {
+		fprintf(stderr, "cannot read baseline '%s'\n", filename);
+		return 2;
+	}
+
+	int regressions = 0;
+	for (int i = 0; i < n_results; ++i) {
+		long long const old_value = bench_json_get(baseline, results[i].name);
+		if (old_value <= 0)
+			continue;
+		double const factor = (double)results[i].value / (double)old_value;
+		double const delta  = (factor - 1.0) * 100.0;
+		char const *verdict = "ok";
+		if (delta > threshold) {
+			verdict = "REGRESSION";
+			++regressions;
+		}
+		fprintf(stderr, "%-16s %12llu  baseline %12lld  %+6.1f%%  %s\n",
+		        results[i].name, results[i].value, old_value, delta, verdict);
+	}
+	free(baseline);
+	return regressions > 0 ? 1 : 0;
+}
+
+#endif
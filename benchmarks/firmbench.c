@@ -0,0 +1,298 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Compile-time benchmark harness for libFirm passes.
+ *
+ * Runs a fixed middle-end pass pipeline over a corpus of graphs and reports
+ * the wall time spent in every stage as JSON. The corpus is either generated
+ * (large synthetic graphs, so nothing needs to be checked in) or imported
+ * from .ir files given on the command line. A previous report can be passed
+ * as baseline; the run then fails if a stage got slower than the allowed
+ * threshold, which makes compile-time regressions bisectable:
+ *
+ *   firmbench -o baseline.json            # record on the good revision
+ *   firmbench -b baseline.json -t 15      # compare while bisecting
+ */
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libfirm/firm.h>
+#include <libfirm/timing.h>
+
+#include "benchreport.h"
+
+/** Scale factor for the synthetic corpus (-s). */
+static int  scale   = 10;
+/** Number of measurement repetitions (-r), the fastest run counts. */
+static int  repeats = 3;
+
+static ir_type *int_type;
+static ir_type *int_method_type;
+
+static ir_graph *begin_function(char const *const name)
+{
+	ir_entity *const entity
+		= new_entity(get_glob_type(), new_id_from_str(name), int_method_type);
+	set_entity_visibility(entity, ir_visibility_external);
+	ir_graph *const irg = new_ir_graph(entity, 64);
+	set_current_ir_graph(irg);
+	return irg;
+}
+
+static void finish_function(ir_graph *const irg, ir_node *const value)
+{
+	ir_node *const ret = new_Return(get_store(), 1, &value);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_r_cur_block(irg));
+	irg_finalize_cons(irg);
+}
+
+/** Some arithmetic with deliberately repeated subexpressions, so value
+ * numbering and PRE have actual work to do. */
+static ir_node *grow_expression(ir_node *value, int const n_ops, int const seed)
+{
+	for (int i = 0; i < n_ops; ++i) {
+		ir_node *const c   = new_Const_long(mode_Is, (seed + i) % 31 + 1);
+		ir_node *const mul = new_Mul(value, c);
+		ir_node *const add = new_Add(mul, new_Const_long(mode_Is, seed % 7));
+		value = (i % 3 == 0) ? new_Eor(add, mul) : add;
+	}
+	return value;
+}
+
+/**
+ * A long chain of if/else diamonds. Stresses the CFG based optimizations
+ * and produces many phi functions.
+ */
+static void build_diamond_chain(char const *const name, int const n_diamonds,
+                                int const n_ops)
+{
+	ir_graph *const irg = begin_function(name);
+	ir_node *const args = get_irg_args(irg);
+	ir_node       *x    = new_Proj(args, mode_Is, 0);
+
+	for (int i = 0; i < n_diamonds; ++i) {
+		ir_node *const c    = new_Const_long(mode_Is, i + 1);
+		ir_node *const cmp  = new_Cmp(x, c, ir_relation_less);
+		ir_node *const cond = new_Cond(cmp);
+		ir_node *const tx   = new_Proj(cond, mode_X, pn_Cond_true);
+		ir_node *const fx   = new_Proj(cond, mode_X, pn_Cond_false);
+		mature_immBlock(get_r_cur_block(irg));
+
+		ir_node *const block_t = new_immBlock();
+		add_immBlock_pred(block_t, tx);
+		set_cur_block(block_t);
+		mature_immBlock(block_t);
+		ir_node *const val_t = grow_expression(x, n_ops, i);
+		ir_node *const jmp_t = new_Jmp();
+
+		ir_node *const block_f = new_immBlock();
+		add_immBlock_pred(block_f, fx);
+		set_cur_block(block_f);
+		mature_immBlock(block_f);
+		ir_node *const val_f = grow_expression(x, n_ops, i + 1);
+		ir_node *const jmp_f = new_Jmp();
+
+		ir_node *const merge = new_immBlock();
+		add_immBlock_pred(merge, jmp_t);
+		add_immBlock_pred(merge, jmp_f);
+		set_cur_block(merge);
+
+		ir_node *ins[] = { val_t, val_f };
+		x = new_Phi(2, ins, mode_Is);
+	}
+
+	finish_function(irg, x);
+}
+
+/**
+ * A counted loop with a fat body. Gives the loop based passes and the
+ * execution frequency estimation something non-trivial.
+ */
+static void build_loop(char const *const name, int const n_iter_ops)
+{
+	/* variable slots: 0 is the counter, 1 the accumulator */
+	ir_graph *const irg = begin_function(name);
+	ir_node *const args  = get_irg_args(irg);
+	ir_node *const limit = new_Proj(args, mode_Is, 0);
+	ir_node *const zero  = new_Const_long(mode_Is, 0);
+	set_value(0, zero);
+	set_value(1, zero);
+	ir_node *const jmp = new_Jmp();
+	mature_immBlock(get_r_cur_block(irg));
+
+	ir_node *const header = new_immBlock();
+	add_immBlock_pred(header, jmp);
+	set_cur_block(header);
+
+	ir_node *const cmp  = new_Cmp(get_value(0, mode_Is), limit,
+	                              ir_relation_less);
+	ir_node *const cond = new_Cond(cmp);
+	ir_node *const tx   = new_Proj(cond, mode_X, pn_Cond_true);
+	ir_node *const fx   = new_Proj(cond, mode_X, pn_Cond_false);
+
+	ir_node *const body = new_immBlock();
+	add_immBlock_pred(body, tx);
+	set_cur_block(body);
+	mature_immBlock(body);
+	ir_node *const sum    = grow_expression(get_value(1, mode_Is), n_iter_ops,
+	                                        3);
+	ir_node *const next_i = new_Add(get_value(0, mode_Is),
+	                                new_Const_long(mode_Is, 1));
+	set_value(0, next_i);
+	set_value(1, sum);
+	ir_node *const back = new_Jmp();
+
+	add_immBlock_pred(header, back);
+	mature_immBlock(header);
+
+	ir_node *const exit = new_immBlock();
+	add_immBlock_pred(exit, fx);
+	set_cur_block(exit);
+
+	finish_function(irg, get_value(1, mode_Is));
+}
+
+static void build_corpus(void)
+{
+	char name[64];
+	for (int i = 0; i < scale; ++i) {
+		snprintf(name, sizeof(name), "bench_diamonds_%d", i);
+		build_diamond_chain(name, 40 + 10 * i, 20);
+		snprintf(name, sizeof(name), "bench_loop_%d", i);
+		build_loop(name, 60 + 20 * i);
+	}
+}
+
+/* -------------------------------------------------------------------- */
+
+typedef void (*bench_pass_func)(ir_graph *irg);
+
+static void pass_execfreq(ir_graph *const irg)
+{
+	ir_estimate_execfreq(irg);
+}
+
+typedef struct bench_stage_t {
+	char const     *name;
+	bench_pass_func run;
+} bench_stage_t;
+
+/** The measured pipeline; roughly the order a frontend would use. */
+static bench_stage_t const stages[] = {
+	{ "local-opts",      optimize_graph_df },
+	{ "control-flow",    optimize_cf       },
+	{ "jump-threading",  opt_jumpthreading },
+	{ "gvn-pre",         do_gvn_pre        },
+	{ "local-opts-2",    optimize_graph_df },
+	{ "combo",           combo             },
+	{ "execfreq",        pass_execfreq     },
+};
+
+#define N_STAGES ((int)(sizeof(stages)/sizeof(stages[0])))
+
+static unsigned long stage_usec[N_STAGES];
+
+static void run_pipeline(void)
+{
+	for (int s = 0; s < N_STAGES; ++s) {
+		ir_timer_t *const timer = ir_timer_new();
+		ir_timer_start(timer);
+		for (size_t i = 0, n = get_irp_n_irgs(); i < n; ++i) {
+			stages[s].run(get_irp_irg(i));
+		}
+		ir_timer_stop(timer);
+		unsigned long const usec = ir_timer_elapsed_usec(timer);
+		if (stage_usec[s] == 0 || usec < stage_usec[s])
+			stage_usec[s] = usec;
+		ir_timer_free(timer);
+	}
+}
+
+/* -------------------------------------------------------------------- */
+
+static void collect_results(bench_result_t *const results)
+{
+	for (int s = 0; s < N_STAGES; ++s) {
+		results[s].name  = stages[s].name;
+		results[s].value = stage_usec[s];
+	}
+}
+
+int main(int argc, char **argv)
+{
+	char const *output    = NULL;
+	char const *baseline  = NULL;
+	double      threshold = 15.0;
+	bool        imported  = false;
+
+	ir_init();
+	int_type        = new_type_primitive(mode_Is);
+	int_method_type = new_type_method(1, 1, false, 0, mtp_no_property);
+	set_method_param_type(int_method_type, 0, int_type);
+	set_method_res_type(int_method_type, 0, int_type);
+
+	for (int i = 1; i < argc; ++i) {
+		char const *const arg = argv[i];
+		if (strcmp(arg, "-o") == 0 && i + 1 < argc) {
+			output = argv[++i];
+		} else if (strcmp(arg, "-b") == 0 && i + 1 < argc) {
+			baseline = argv[++i];
+		} else if (strcmp(arg, "-t") == 0 && i + 1 < argc) {
+			threshold = strtod(argv[++i], NULL);
+		} else if (strcmp(arg, "-r") == 0 && i + 1 < argc) {
+			repeats = atoi(argv[++i]);
+		} else if (strcmp(arg, "-s") == 0 && i + 1 < argc) {
+			scale = atoi(argv[++i]);
+		} else if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+			printf("usage: firmbench [-o report.json] [-b baseline.json]"
+			       " [-t threshold%%] [-r repeats] [-s scale] [file.ir ...]\n");
+			return 0;
+		} else {
+			if (!ir_import(arg)) {
+				fprintf(stderr, "firmbench: cannot import '%s'\n", arg);
+				return 2;
+			}
+			imported = true;
+		}
+	}
+
+	if (!imported)
+		build_corpus();
+
+	/* Note that only the first round sees the unoptimized graphs; later
+	 * rounds mostly measure pass overhead on already optimized code and
+	 * serve to smooth out timing noise of the cheap stages. */
+	for (int r = 0; r < repeats; ++r)
+		run_pipeline();
+
+	bench_result_t results[N_STAGES];
+	collect_results(results);
+
+	if (output != NULL) {
+		FILE *const out = fopen(output, "w");
+		if (out == NULL) {
+			fprintf(stderr, "firmbench: cannot write '%s'\n", output);
+			return 2;
+		}
+		bench_write_report(out, results, N_STAGES);
+		fclose(out);
+	} else {
+		bench_write_report(stdout, results, N_STAGES);
+	}
+
+	int result = 0;
+	if (baseline != NULL)
+		result = bench_compare_baseline(baseline, results, N_STAGES,
+		                                threshold);
+
+	ir_finish();
+	return result;
+}
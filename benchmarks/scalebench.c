@@ -0,0 +1,321 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Scalability stress harness for pathological graph shapes.
+ *
+ * Several passes have a history of superlinear behaviour that only shows
+ * up once a large enough input trips it. This harness synthesizes the
+ * shapes from those incidents in parameterized form - switch fans with
+ * many cases, long store chains, deep dominator ladders and wide phi
+ * webs - runs the affected passes on a small and on an 8x larger
+ * instance and fails if a pass scales clearly worse than linear. That
+ * turns the worst production incidents into reproducible checks:
+ *
+ *   scalebench                # check all cases against the slack factor
+ *   scalebench -t 5 -o report.json
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libfirm/firm.h>
+#include <libfirm/timing.h>
+
+#include "benchreport.h"
+
+/** Size multiplier between the small and the large instance. */
+#define GROWTH 8
+
+/** Scale factor for the base sizes (-s). */
+static int scale   = 10;
+/** Number of measurement repetitions (-r), the fastest run counts. */
+static int repeats = 3;
+
+/** Number of variables merged in the phi web shape. */
+#define N_PHI_VARS 16
+
+static ir_type *int_type;
+static ir_type *int_method_type;
+static ir_type *mem_method_type;
+
+static ir_graph *begin_function(char const *const name, ir_type *const mtp,
+                                int const n_loc)
+{
+	ir_entity *const entity
+		= new_entity(get_glob_type(), new_id_from_str(name), mtp);
+	set_entity_visibility(entity, ir_visibility_external);
+	ir_graph *const irg = new_ir_graph(entity, n_loc);
+	set_current_ir_graph(irg);
+	return irg;
+}
+
+static void finish_function(ir_graph *const irg, ir_node *const value)
+{
+	ir_node *const ret = new_Return(get_store(), 1, &value);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_r_cur_block(irg));
+	irg_finalize_cons(irg);
+}
+
+/**
+ * A Switch with @p size cases, each jumping to its own block returning a
+ * constant. Historically quadratic in the block merging of cfopt and
+ * shape_blocks.
+ */
+static ir_graph *build_switch_fan(int const size)
+{
+	ir_graph *const irg = begin_function("stress", int_method_type, 4);
+	ir_node  *const sel = new_Proj(get_irg_args(irg), mode_Is, 0);
+
+	ir_switch_table *const table = ir_new_switch_table(irg, size);
+	for (int i = 0; i < size; ++i) {
+		ir_tarval *const tv = new_tarval_from_long(i, mode_Is);
+		ir_switch_table_set(table, i, tv, tv, i + 1);
+	}
+	ir_node *const sw = new_Switch(sel, size + 1, table);
+	mature_immBlock(get_r_cur_block(irg));
+
+	for (int i = 0; i <= size; ++i) {
+		unsigned const pn = i == size ? pn_Switch_default : (unsigned)(i + 1);
+		ir_node *const block = new_immBlock();
+		add_immBlock_pred(block, new_Proj(sw, mode_X, pn));
+		set_cur_block(block);
+		mature_immBlock(block);
+		ir_node *const value = new_Const_long(mode_Is, i * 7 + 1);
+		ir_node *const ret   = new_Return(get_store(), 1, &value);
+		add_immBlock_pred(get_irg_end_block(irg), ret);
+	}
+	irg_finalize_cons(irg);
+	return irg;
+}
+
+/**
+ * A chain of @p size load/modify/store round trips through one pointer.
+ * The load/store optimization walks such chains when searching for
+ * earlier accesses.
+ */
+static ir_graph *build_store_chain(int const size)
+{
+	ir_graph *const irg = begin_function("stress", mem_method_type, 4);
+	ir_node  *const ptr = new_Proj(get_irg_args(irg), mode_P, 0);
+
+	ir_node *value = new_Const_long(mode_Is, 0);
+	for (int i = 0; i < size; ++i) {
+		ir_node *const store = new_Store(get_store(), ptr, value, int_type,
+		                                 cons_none);
+		set_store(new_Proj(store, mode_M, pn_Store_M));
+		ir_node *const load = new_Load(get_store(), ptr, mode_Is, int_type,
+		                               cons_none);
+		set_store(new_Proj(load, mode_M, pn_Load_M));
+		ir_node *const res = new_Proj(load, mode_Is, pn_Load_res);
+		value = new_Add(res, new_Const_long(mode_Is, i + 1));
+	}
+	finish_function(irg, value);
+	return irg;
+}
+
+/**
+ * A ladder of @p size conditional blocks each dominating the rest of the
+ * function; every rung bails out with its own Return. Stresses everything
+ * that walks dominators per block.
+ */
+static ir_graph *build_dom_ladder(int const size)
+{
+	ir_graph *const irg = begin_function("stress", int_method_type, 4);
+	ir_node  *const x   = new_Proj(get_irg_args(irg), mode_Is, 0);
+
+	for (int i = 0; i < size; ++i) {
+		ir_node *const c    = new_Const_long(mode_Is, i + 1);
+		ir_node *const cmp  = new_Cmp(x, c, ir_relation_less);
+		ir_node *const cond = new_Cond(cmp);
+		ir_node *const tx   = new_Proj(cond, mode_X, pn_Cond_true);
+		ir_node *const fx   = new_Proj(cond, mode_X, pn_Cond_false);
+		mature_immBlock(get_r_cur_block(irg));
+
+		ir_node *const bail = new_immBlock();
+		add_immBlock_pred(bail, tx);
+		set_cur_block(bail);
+		mature_immBlock(bail);
+		ir_node *const value = new_Const_long(mode_Is, i);
+		ir_node *const ret   = new_Return(get_store(), 1, &value);
+		add_immBlock_pred(get_irg_end_block(irg), ret);
+
+		ir_node *const next = new_immBlock();
+		add_immBlock_pred(next, fx);
+		set_cur_block(next);
+		mature_immBlock(next);
+	}
+	finish_function(irg, x);
+	return irg;
+}
+
+/**
+ * A merge block with @p size predecessors joining N_PHI_VARS variables,
+ * i.e. @p size * N_PHI_VARS phi inputs. Stresses phi handling in the
+ * local optimizer and cfopt.
+ */
+static ir_graph *build_phi_web(int const size)
+{
+	ir_graph *const irg = begin_function("stress", int_method_type,
+	                                     N_PHI_VARS + 1);
+	ir_node  *const x     = new_Proj(get_irg_args(irg), mode_Is, 0);
+	ir_node  *const merge = new_immBlock();
+
+	for (int i = 0; i < size; ++i) {
+		ir_node *const c    = new_Const_long(mode_Is, i + 1);
+		ir_node *const cmp  = new_Cmp(x, c, ir_relation_less);
+		ir_node *const cond = new_Cond(cmp);
+		ir_node *const tx   = new_Proj(cond, mode_X, pn_Cond_true);
+		ir_node *const fx   = new_Proj(cond, mode_X, pn_Cond_false);
+		mature_immBlock(get_r_cur_block(irg));
+
+		ir_node *const setter = new_immBlock();
+		add_immBlock_pred(setter, tx);
+		set_cur_block(setter);
+		mature_immBlock(setter);
+		for (int j = 0; j < N_PHI_VARS; ++j)
+			set_value(j, new_Const_long(mode_Is, i * 31 + j));
+		add_immBlock_pred(merge, new_Jmp());
+
+		ir_node *const next = new_immBlock();
+		add_immBlock_pred(next, fx);
+		set_cur_block(next);
+		mature_immBlock(next);
+	}
+	/* the fall through predecessor */
+	for (int j = 0; j < N_PHI_VARS; ++j)
+		set_value(j, x);
+	add_immBlock_pred(merge, new_Jmp());
+	mature_immBlock(get_r_cur_block(irg));
+
+	set_cur_block(merge);
+	mature_immBlock(merge);
+	ir_node *sum = get_value(0, mode_Is);
+	for (int j = 1; j < N_PHI_VARS; ++j)
+		sum = new_Add(sum, get_value(j, mode_Is));
+	finish_function(irg, sum);
+	return irg;
+}
+
+/* -------------------------------------------------------------------- */
+
+typedef struct stress_case_t {
+	char const *name;            /**< shape/pass combination */
+	ir_graph  *(*build)(int size);
+	void       (*run)(ir_graph *irg);
+	int          base_size;      /**< small instance size at -s 10 */
+} stress_case_t;
+
+static stress_case_t const cases[] = {
+	{ "switch-fan/cfopt",        build_switch_fan,  optimize_cf,         1000 },
+	{ "switch-fan/shape-blocks", build_switch_fan,  shape_blocks,        1000 },
+	{ "store-chain/ldstopt",     build_store_chain, optimize_load_store, 1000 },
+	{ "dom-ladder/cfopt",        build_dom_ladder,  optimize_cf,         1000 },
+	{ "dom-ladder/jump-thread",  build_dom_ladder,  opt_jumpthreading,   1000 },
+	{ "phi-web/local-opts",      build_phi_web,     optimize_graph_df,    400 },
+	{ "phi-web/cfopt",           build_phi_web,     optimize_cf,          400 },
+};
+
+#define N_CASES ((int)(sizeof(cases)/sizeof(cases[0])))
+
+/** Fastest pass time over the repetitions on a fresh graph each time. */
+static unsigned long measure(stress_case_t const *const scase, int const size)
+{
+	unsigned long best = 0;
+	for (int r = 0; r < repeats; ++r) {
+		ir_graph *const irg = scase->build(size);
+		ir_timer_t *const timer = ir_timer_new();
+		ir_timer_start(timer);
+		scase->run(irg);
+		ir_timer_stop(timer);
+		unsigned long const usec = ir_timer_elapsed_usec(timer);
+		ir_timer_free(timer);
+		free_ir_graph(irg);
+		if (best == 0 || usec < best)
+			best = usec;
+	}
+	return best;
+}
+
+int main(int argc, char **argv)
+{
+	char const *output = NULL;
+	double      slack  = 3.0;
+
+	for (int i = 1; i < argc; ++i) {
+		char const *const arg = argv[i];
+		if (strcmp(arg, "-o") == 0 && i + 1 < argc) {
+			output = argv[++i];
+		} else if (strcmp(arg, "-t") == 0 && i + 1 < argc) {
+			slack = strtod(argv[++i], NULL);
+		} else if (strcmp(arg, "-r") == 0 && i + 1 < argc) {
+			repeats = atoi(argv[++i]);
+		} else if (strcmp(arg, "-s") == 0 && i + 1 < argc) {
+			scale = atoi(argv[++i]);
+		} else {
+			printf("usage: scalebench [-o report.json] [-t slack]"
+			       " [-r repeats] [-s scale]\n");
+			return strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0
+			     ? 0 : 2;
+		}
+	}
+
+	ir_init();
+	int_type        = new_type_primitive(mode_Is);
+	int_method_type = new_type_method(1, 1, false, 0, mtp_no_property);
+	set_method_param_type(int_method_type, 0, int_type);
+	set_method_res_type(int_method_type, 0, int_type);
+	mem_method_type = new_type_method(1, 1, false, 0, mtp_no_property);
+	set_method_param_type(mem_method_type, 0, new_type_pointer(int_type));
+	set_method_res_type(mem_method_type, 0, int_type);
+
+	bench_result_t results[2 * N_CASES];
+	char           names[2 * N_CASES][64];
+	int            exit_code = 0;
+
+	for (int i = 0; i < N_CASES; ++i) {
+		stress_case_t const *const scase = &cases[i];
+		int const size_small = scase->base_size * scale / 10;
+		unsigned long const t_small = measure(scase, size_small);
+		unsigned long const t_large = measure(scase, size_small * GROWTH);
+
+		snprintf(names[2 * i], sizeof(names[0]), "%s-x1", scase->name);
+		snprintf(names[2 * i + 1], sizeof(names[0]), "%s-x%d", scase->name,
+		         GROWTH);
+		results[2 * i].name      = names[2 * i];
+		results[2 * i].value     = t_small;
+		results[2 * i + 1].name  = names[2 * i + 1];
+		results[2 * i + 1].value = t_large;
+
+		/* guard against timer granularity on very fast runs */
+		unsigned long const floor_usec = 1000;
+		double const base  = t_small > floor_usec ? (double)t_small
+		                                          : (double)floor_usec;
+		double const ratio = (double)t_large / base;
+		double const limit = (double)GROWTH * slack;
+		bool const bad     = ratio > limit;
+		fprintf(stderr, "%-26s %8lu -> %8lu usec at %dx size"
+		        " (ratio %.1f, limit %.1f)%s\n", scase->name, t_small,
+		        t_large, GROWTH, ratio, limit, bad ? " SUPERLINEAR" : "");
+		if (bad)
+			exit_code = 1;
+	}
+
+	if (output != NULL) {
+		FILE *const out = fopen(output, "w");
+		if (out == NULL) {
+			fprintf(stderr, "scalebench: cannot write '%s'\n", output);
+			return 2;
+		}
+		bench_write_report(out, results, 2 * N_CASES);
+		fclose(out);
+	}
+
+	ir_finish();
+	return exit_code;
+}
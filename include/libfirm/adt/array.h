@@ -72,6 +72,32 @@ FIRM_API void *ir_new_arr_f(size_t nelts, size_t elts_size);
  */
 FIRM_API void *ir_new_arr_d(struct obstack *obstack, size_t nelts, size_t elts_size);
 
+/**
+ * Creates a resizable array on an obstack.
+ *
+ * @param obstack    An struct obstack * were the data will be allocated
+ * @param nelts      The number of elements
+ * @param elts_size  The size of the array elements.
+ *
+ * @return A pointer to the array (can be used as a pointer to the
+ *         first element of this array).
+ *
+ * @remark Helper function, use NEW_ARR_O() instead.
+ */
+FIRM_API void *ir_new_arr_o(struct obstack *obstack, size_t nelts, size_t elts_size);
+
+/**
+ * Initializes caller provided storage as a small-buffer array.
+ *
+ * @param descr     Storage for the descriptor followed by the elements.
+ * @param capacity  The number of elements the storage can hold.
+ *
+ * @return A pointer to the (empty) array.
+ *
+ * @remark Helper function, use DECL_ARR_S() instead.
+ */
+FIRM_API void *ir_arr_init_s(ir_arr_descr *descr, size_t capacity);
+
 /**
  * Resize a flexible array, allocate more data if needed but do NOT
  * reduce.
@@ -201,6 +227,47 @@ FIRM_API void DEL_ARR_F(void *arr);
 #define DUP_ARR_D(type, obstack, arr) \
   ((type*)memcpy(NEW_ARR_D(type, (obstack), ARR_LEN((arr))), (arr), sizeof(type) * ARR_LEN ((arr))))
 
+/**
+ * Creates a resizable array on an obstack.
+ *
+ * @param type     The element type of the new array.
+ * @param obstack  A struct obstack * were the data will be allocated
+ * @param nelts    A size_t expression evaluating to the number of elements
+ *
+ * Like NEW_ARR_F() the array may be resized later (ARR_APP1(), ARR_RESIZE(),
+ * ...), but all memory comes from the given obstack.  Growth reuses the
+ * trailing obstack space when the array is still the topmost allocation,
+ * otherwise the old copy is abandoned to the obstack.  There is no delete:
+ * the array dies with the obstack.
+ *
+ * @return A pointer to the array (can be used as a pointer to the
+ *         first element of this array).
+ */
+#define NEW_ARR_O(type, obstack, nelts) \
+  ((type *)ir_new_arr_o((obstack), (nelts), sizeof(type) * (nelts)))
+
+/**
+ * Declares an empty small-buffer array backed by automatic storage.
+ *
+ * @param type      The element type of the new array.
+ * @param name      The name of the array variable to declare.
+ * @param capacity  Number of elements the automatic storage can hold,
+ *                  must be a compile time constant.
+ *
+ * The array starts with length 0 and supports the usual macros
+ * (ARR_APP1(), ARR_LEN(), ...).  As long as at most \p capacity elements
+ * are held no heap allocation happens; growing beyond that migrates the
+ * contents to a heap allocated flexible array.  Always dispose of the
+ * array with DEL_ARR_F(), which is a no-op while it still lives in the
+ * buffer.
+ */
+#define DECL_ARR_S(type, name, capacity) \
+	union { \
+		ir_arr_descr descr; \
+		char data[ARR_ELTS_OFFS + sizeof(type) * (capacity)]; \
+	} name##__storage; \
+	type *name = (type*)ir_arr_init_s(&name##__storage.descr, (capacity))
+
 /**
  * Returns the length of an array
  *
@@ -25,6 +25,14 @@ FIRM_API void gs_delete_matrix(gs_matrix_t *m);
 FIRM_API void gs_matrix_set(gs_matrix_t *m, unsigned row, unsigned col,
                             double val);
 
+/**
+ * Finalize the matrix after construction. The per-row entry arrays are
+ * copied into one contiguous compressed-row layout (dropping entries set
+ * back to zero), which the iteration kernel streams over. After this call
+ * the matrix must not be modified anymore. Calling it again is a no-op.
+ */
+FIRM_API void gs_matrix_compact(gs_matrix_t *m);
+
 /**
  * Returns the value stored in m[row, col].
  */
@@ -34,8 +42,11 @@ FIRM_API double gs_matrix_get(const gs_matrix_t *m, unsigned row, unsigned col);
  * Performs one step of the Gauss-Seidel algorithm
  * @p m         The iteration matrix
  * @p x         The iteration vector
+ * @p omega     Relaxation factor; 1.0 is the plain Gauss-Seidel update,
+ *              larger values over-relax (SOR)
  */
-FIRM_API double gs_matrix_gauss_seidel(const gs_matrix_t *m, double *x);
+FIRM_API double gs_matrix_gauss_seidel(const gs_matrix_t *m, double *x,
+                                       double omega);
 
 FIRM_API unsigned gs_matrix_get_n_entries(const gs_matrix_t *m);
 
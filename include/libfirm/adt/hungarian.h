@@ -100,6 +100,13 @@ FIRM_API void hungarian_free(hungarian_problem_t *p);
 
 /**
  * This method computes the optimal assignment.
+ *
+ * After a successful solve the problem may be edited further with
+ * hungarian_add()/hungarian_remove() and solved again. Such a re-solve
+ * reuses the previous matching and dual values and only repairs the
+ * edited rows, which is much cheaper than solving from scratch when
+ * consecutive problems differ in a few rows only.
+ *
  * @param p              The hungarian object
  * @param assignment     The final assignment
  * @param final_cost     The final costs
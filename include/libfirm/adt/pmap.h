@@ -53,7 +53,9 @@ FIRM_API void pmap_insert(pmap *map, void const *key, void *value);
 /** Checks if an entry with key "key" exists. */
 FIRM_API int pmap_contains(pmap const *map, void const *key);
 
-/** Returns the key, value pair of "key". */
+/** Returns the key, value pair of "key".
+ *  @note The returned entry lives inside the map and is only valid until
+ *        the next insertion into the pmap. */
 FIRM_API pmap_entry *pmap_find(pmap const *map, void const *key);
 
 /** Returns the value of "key". */
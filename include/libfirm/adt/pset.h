@@ -143,6 +143,10 @@ FIRM_API void *pset_insert(pset *pset, void const *key, unsigned hash);
  *    It is not possible to insert an element more than once. If an element
  *    that should be inserted is already in the pset, this functions does
  *    nothing but returning its pset_entry.
+ *
+ * @note
+ *    The returned entry lives inside the hash table and is only valid
+ *    until the next insertion into or removal from the pset.
  */
 FIRM_API pset_entry *pset_hinsert(pset *pset, void const *key, unsigned hash);
 
@@ -55,6 +55,53 @@ FIRM_API void *xrealloc(void *ptr, size_t size);
  */
 FIRM_API char *xstrdup(const char *str);
 
+/**
+ * Nonzero while allocation accounting is active.  The allocation wrappers
+ * test this flag on their fast path, so the accounting layer costs a
+ * single predictable branch when disabled.
+ */
+FIRM_API int xmalloc_account_enabled;
+
+/**
+ * Start allocation accounting.  All following xmalloc()/xrealloc()/
+ * xstrdup() calls are attributed to the innermost accounting scope.
+ * Previously collected counters are reset.
+ */
+FIRM_API void xmalloc_account_begin(void);
+
+/** Stop allocation accounting and discard the collected counters. */
+FIRM_API void xmalloc_account_end(void);
+
+/**
+ * Open an accounting scope named @p tag (e.g. the current pass or graph).
+ * Allocations are attributed to the innermost open scope; scopes with the
+ * same tag share their counters.
+ */
+FIRM_API void xmalloc_account_push(const char *tag);
+
+/** Close the innermost accounting scope. */
+FIRM_API void xmalloc_account_pop(void);
+
+/**
+ * Callback type for xmalloc_account_report().
+ *
+ * @param tag    the scope tag
+ * @param bytes  bytes requested while the tag was the innermost scope
+ * @param calls  number of allocation calls attributed to the tag
+ * @param peak   largest number of bytes (including nested scopes)
+ *               requested during a single activation of the tag
+ * @param env    the environment passed to xmalloc_account_report()
+ */
+typedef void (*xmalloc_account_report_func)(const char *tag,
+                                            unsigned long long bytes,
+                                            unsigned long long calls,
+                                            unsigned long long peak,
+                                            void *env);
+
+/** Invoke @p func for every tag seen since xmalloc_account_begin(). */
+FIRM_API void xmalloc_account_report(xmalloc_account_report_func func,
+                                     void *env);
+
 /**
  * Allocate n objects of a certain type
  */
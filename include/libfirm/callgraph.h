@@ -94,6 +94,33 @@ FIRM_API void compute_callgraph(void);
 /** Destruct the callgraph. */
 FIRM_API void free_callgraph(void);
 
+/**
+ * Registers a newly created graph (e.g. a procedure clone) with the
+ * callgraph. No-op if no callgraph is computed.
+ */
+FIRM_API void callgraph_note_new_irg(ir_graph *irg);
+
+/**
+ * Patches the callgraph for a new call site, keeping it consistent
+ * across transformations like inlining and procedure cloning without a
+ * full recomputation. No-op if no callgraph is computed.
+ *
+ * @param caller  the graph containing the new Call
+ * @param call    the new Call node
+ * @param callee  the called graph
+ */
+FIRM_API void callgraph_note_new_call(ir_graph *caller, ir_node *call,
+                                      ir_graph *callee);
+
+/**
+ * Patches the callgraph for a removed call site. The callgraph edge is
+ * weakened but never removed, so it stays an over-approximation and the
+ * recursion information remains valid. No-op if no callgraph is
+ * computed.
+ */
+FIRM_API void callgraph_note_removed_call(ir_graph *caller, ir_node *call,
+                                          ir_graph *callee);
+
 
 /** A function type for functions passed to the callgraph walker. */
 typedef void callgraph_walk_func(ir_graph *g, void *env);
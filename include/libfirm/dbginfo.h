@@ -173,6 +173,18 @@ FIRM_API void ir_set_type_debug_retrieve(retrieve_type_dbg_func func);
  */
 FIRM_API src_loc_t ir_retrieve_dbg_info(dbg_info const *dbg);
 
+/**
+ * Interns a source location in the library's location pool.
+ *
+ * The returned dbg_info packs (file, line, column) into 8 bytes and is
+ * deduplicated: interning the same location again yields the same pointer,
+ * so pooled locations can be compared by pointer. Column numbers beyond
+ * 65535 are saturated. The pool installs its own retriever, so a frontend
+ * using it must not register one of its own with ir_set_debug_retrieve().
+ */
+FIRM_API dbg_info *ir_dbg_info_intern(const char *file, unsigned line,
+                                      unsigned column);
+
 /**
  * Retrieve type debug info
  */
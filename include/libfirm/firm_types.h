@@ -263,6 +263,10 @@ typedef enum mtp_additional_properties {
 	mtp_temporary                   = 1u << 12,
 	/** marker used for oo analyses needing info whether method is constructor or not */
 	mtp_property_is_constructor     = 1u << 13,
+	/** The function is unlikely to be executed; place it apart from the
+	 * hot code. Set from profile data or by the frontend.
+	 * GCC: __attribute__((cold)). */
+	mtp_property_cold               = 1u << 14,
 } mtp_additional_properties;
 ENUM_BITSET(mtp_additional_properties)
 
@@ -48,9 +48,19 @@ FIRM_API unsigned get_irn_height(const ir_heights_t *h, const ir_node *irn);
 FIRM_API int heights_reachable_in_block(ir_heights_t *h, const ir_node *src,
                                         const ir_node *tgt);
 
+/**
+ * Marks a block as dirty, i.e. its contents changed since the heights
+ * were computed. Height information of dirty blocks is recomputed
+ * lazily; all other blocks keep their cached heights.
+ * @param h     The heights object.
+ * @param block The block
+ */
+FIRM_API void heights_dirty_block(ir_heights_t *h, ir_node *block);
+
 /**
  * Recomputes the height information for a certain block.
- * This can be used to recompute the height information of a block.
+ * This is a no-op for blocks that are not dirty (see
+ * heights_dirty_block()): for those the cached maximum is returned.
  * @param h     The heights object.
  * @param block The block
  * @return The maximum over all heights in the block.
@@ -69,6 +69,57 @@ FIRM_API void construct_confirms_only(ir_graph *irg);
  */
 FIRM_API void remove_confirms(ir_graph *irg);
 
+/**
+ * Opaque handle for a dominance-scoped confirmation table.
+ *
+ * The table records the same facts that construct_confirms() would
+ * materialize as Confirm nodes, but keeps them out-of-band: the graph is
+ * not modified, no Confirm nodes have to be skipped by later passes and
+ * no remove_confirms() rewrite is needed afterwards.
+ */
+typedef struct ir_confirm_table_t ir_confirm_table_t;
+
+/**
+ * Compute the confirmation table for a graph.
+ *
+ * Records for every value the relations established by dominating
+ * conditional branches (and, if global null pointer elimination is
+ * enabled, the non-null facts implied by dereferences).  The table stays
+ * valid as long as the control flow and dominance information of the
+ * graph are unchanged.
+ *
+ * @param irg  the graph
+ */
+FIRM_API ir_confirm_table_t *ir_confirm_table_compute(ir_graph *irg);
+
+/** Frees a confirmation table created by ir_confirm_table_compute(). */
+FIRM_API void ir_confirm_table_free(ir_confirm_table_t *table);
+
+/**
+ * Callback for ir_confirm_table_foreach().
+ *
+ * Announces that the queried value fulfills @p relation against
+ * @p bound at the queried position.
+ */
+typedef void (*ir_confirm_range_cb)(void *env, ir_relation relation,
+                                    ir_node *bound);
+
+/**
+ * Invoke @p cb for every recorded fact about @p value that holds in
+ * @p block, i.e. every fact whose establishing branch target dominates
+ * @p block.
+ *
+ * @param table  the confirmation table
+ * @param value  the value in question
+ * @param block  the block in which the value is used
+ * @param cb     invoked once per valid fact
+ * @param env    environment passed to @p cb
+ */
+FIRM_API void ir_confirm_table_foreach(const ir_confirm_table_t *table,
+                                       const ir_node *value,
+                                       const ir_node *block,
+                                       ir_confirm_range_cb cb, void *env);
+
 #include "end.h"
 
 #endif
@@ -175,6 +175,21 @@ FIRM_API void postdom_tree_walk_irg(ir_graph *irg, irg_walk_func *pre,
  */
 FIRM_API void compute_doms(ir_graph *irg);
 
+/** Updates the dominance relation after @p block was inserted on a control
+ * flow edge.
+ *
+ * @p block must have exactly one predecessor and a single Jmp as its only
+ * successor, jumping to @p succ, as produced when splitting the edge from
+ * the predecessor to @p succ.  Such an insertion changes no path between
+ * the existing blocks, so the dominator tree can be updated in place
+ * instead of being invalidated and recomputed from scratch.
+ *
+ * @return non-zero if the dominance information was updated, zero if the
+ *         graph had no consistent dominance information (the caller then
+ *         has to invalidate it as usual).
+ */
+FIRM_API int ir_dominance_block_inserted(ir_node *block, ir_node *succ);
+
 /** Computes the post dominance relation for all basic blocks of a given graph.
  *
  * Sets a flag in irg to "dom_consistent".
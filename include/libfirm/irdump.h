@@ -288,6 +288,10 @@ ENUM_BITSET(ir_dump_flags_t)
 
 /** override currently set dump flags with new ones */
 FIRM_API void ir_set_dump_flags(ir_dump_flags_t flags);
+
+/** Sets a node-count limit for full graph dumps: graphs with more nodes
+ * are dumped as a CFG summary only.  0 (the default) disables the limit. */
+FIRM_API void ir_set_dump_node_limit(size_t limit);
 /** add flags to the currently set dump flags */
 FIRM_API void ir_add_dump_flags(ir_dump_flags_t flags);
 /** disable certain dump flags */
@@ -201,6 +201,21 @@ FIRM_API int edges_verify(ir_graph *irg);
  */
 FIRM_API int edges_verify_kind(ir_graph *irg, ir_edge_kind_t kind);
 
+/**
+ * Cheap verification of the out edges of graph @p irg: only checks that
+ * the out lists match the in arrays.  Suitable for frequent use with
+ * incremental edge maintenance.
+ * @return 0 if a problem was found
+ */
+FIRM_API int edges_verify_cheap(ir_graph *irg);
+
+/**
+ * Enables/disables incremental out-edge maintenance.  While enabled,
+ * edges_deactivate() keeps the edge sets alive and the notify hooks patch
+ * them across passes, so a following edges_activate() needs no rebuild.
+ */
+FIRM_API void edges_set_incremental(int enable);
+
 /**
  * Sets edge verification flag.
  */
@@ -60,6 +60,20 @@ FIRM_API void optimize_graph_df(ir_graph *irg);
  */
 FIRM_API void local_opts_const_code(void);
 
+/** A graph-local optimization pipeline: may only touch state of @p irg. */
+typedef void (*irg_pipeline_func)(ir_graph *irg);
+
+/** Runs a graph-local pipeline over all graphs of the current ir_prog,
+ * distributing the graphs over @p n_threads worker threads.
+ *
+ * The pipeline must restrict itself to graph-local state; the global
+ * interning tables (idents, tarvals) are protected internally.
+ * With @p n_threads <= 1 (or on platforms without thread support) the
+ * graphs are processed serially on the calling thread.
+ */
+FIRM_API void run_irg_pipeline_parallel(irg_pipeline_func func,
+                                        unsigned n_threads);
+
 /**
  * Eliminates (obviously) unreachable code
  */
@@ -132,6 +132,15 @@ FIRM_API ir_graph *new_ir_graph(ir_entity *ent, int n_loc);
  */
 FIRM_API void free_ir_graph(ir_graph *irg);
 
+/** Frees the node storage of the passed irgraph but keeps the ir_graph
+ * structure itself alive and on the list in irprog.
+ * Sets the field irgraph in the corresponding entity to NULL; the graph
+ * must not be used afterwards except for free_ir_graph().  Allows
+ * releasing graphs one by one while the program is iterated, e.g. after
+ * their code generation finished.
+ */
+FIRM_API void free_ir_graph_content(ir_graph *irg);
+
 /** Returns the entity of an IR graph. */
 FIRM_API ir_entity *get_irg_entity(const ir_graph *irg);
 /** Sets the entity of an IR graph. */
@@ -234,6 +243,13 @@ FIRM_API irg_callee_info_state get_irg_callee_info_state(const ir_graph *irg);
 /** Sets the callee_info_state of an IR graph. */
 FIRM_API void set_irg_callee_info_state(ir_graph *irg, irg_callee_info_state s);
 
+/** Enables/disables recycling of the storage of killed nodes.
+ *  While enabled, kill_node() returns node memory to per-size free lists
+ *  and node creation reuses it, so long optimization pipelines stop
+ *  growing the graph obstack monotonically.  May only be enabled while no
+ *  stale references to killed nodes are kept. */
+FIRM_API void set_irg_node_recycling(ir_graph *irg, int enable);
+
 /** A void * field to link arbitrary information to the node. */
 FIRM_API void set_irg_link(ir_graph *irg, void *thing);
 /** Return void* field previously set by set_irg_link() */
@@ -434,6 +450,19 @@ FIRM_API void add_irg_properties(ir_graph *irg, ir_graph_properties_t props);
  * Just sets the flags, use confirm_irg_properties() with inverted @p props to also invalidate the analysis state.
  */
 FIRM_API void clear_irg_properties(ir_graph *irg, ir_graph_properties_t props);
+/**
+ * Clears the graph properties in @p props like clear_irg_properties(),
+ * but additionally declares that the structural change is confined to
+ * the predecessors of @p block.  assure_irg_properties() then tries to
+ * revalidate the analysis by inspecting the declared blocks instead of
+ * recomputing it from scratch (currently supported for
+ * IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE).  @p block must have existed
+ * when the analysis was last computed; use plain clear_irg_properties()
+ * for newly created blocks or changes whose extent is unknown.
+ */
+FIRM_API void clear_irg_properties_local(ir_graph *irg,
+                                         ir_graph_properties_t props,
+                                         ir_node *block);
 /**
  * queries whether @p irg has all properties in  @p props set.
  */
@@ -462,6 +491,14 @@ FIRM_API void *get_irg_loc_description(ir_graph *irg, int n);
 /** Returns the last irn index for this graph. */
 FIRM_API unsigned get_irg_last_idx(const ir_graph *irg);
 
+/**
+ * Returns the number of bytes currently allocated on the internal node
+ * obstack of @p irg.  If @p n_chunks is non-NULL, it is set to the number
+ * of malloc'ed chunks backing the obstack.
+ */
+FIRM_API size_t get_irg_obstack_memory(const ir_graph *irg,
+                                       unsigned *n_chunks);
+
 /** @} */
 
 #include "end.h"
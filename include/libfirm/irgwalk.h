@@ -127,6 +127,28 @@ FIRM_API void irg_walk_topological(ir_graph *irg, irg_walk_func *walker,
  */
 FIRM_API void all_irg_walk(irg_walk_func *pre, irg_walk_func *post, void *env);
 
+/**
+ * A private visited epoch for one analysis: a dense visited map indexed by
+ * node index, independent of the shared visited counter in the graph.
+ * Several read-only analyses holding their own map can walk one graph
+ * concurrently without trampling each other.
+ */
+typedef struct ir_visited_map_t ir_visited_map_t;
+
+/** Allocates a visited map for @p irg, sized for its current node count. */
+FIRM_API ir_visited_map_t *new_visited_map(ir_graph *irg);
+
+/** Frees a visited map. */
+FIRM_API void free_visited_map(ir_visited_map_t *map);
+
+/**
+ * Like irg_walk(), but tracks visited state in @p map instead of the
+ * shared per-graph counter.  The callbacks must not create new nodes.
+ */
+FIRM_API void visited_map_walk(ir_visited_map_t *map, ir_node *node,
+                               irg_walk_func *pre, irg_walk_func *post,
+                               void *env);
+
 /** Walks only over Block nodes in the graph.
  *
  * @param node  the start node
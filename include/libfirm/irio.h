@@ -52,6 +52,44 @@ FIRM_API int ir_import(const char *filename);
  */
 FIRM_API int ir_import_file(FILE *input, const char *inputname);
 
+/**
+ * Imports the data stored in the given file, but postpones parsing of
+ * function bodies.  Types, entities and the constant graph are read
+ * eagerly; for each function graph only its position in the file is
+ * recorded.  A body is parsed on the first call to
+ * ir_load_deferred_irg() for its entity, so the import cost depends on
+ * the graphs actually used instead of the program size.  The reader
+ * state of the file stays allocated until all bodies are materialized.
+ *
+ * @param filename  the name of the file
+ * @returns 0 if no errors occured, other values in case of errors
+ */
+FIRM_API int ir_import_lazy(const char *filename);
+
+/**
+ * Returns the graph of @p entity, parsing its body now if it was
+ * deferred by ir_import_lazy().  Returns NULL if the entity has neither
+ * a graph nor a deferred body.
+ */
+FIRM_API ir_graph *ir_load_deferred_irg(ir_entity *entity);
+
+/** Materializes all bodies still deferred by lazy imports. */
+FIRM_API void ir_load_all_deferred_irgs(void);
+
+/**
+ * Combines the modules imported so far into one program.
+ *
+ * Entities from different modules that carry the same linker ident are
+ * unified: all references are redirected to the defining entity and the
+ * superseded declarations are removed.  Local entities whose linker
+ * idents collide are renamed instead.  Afterwards interprocedural
+ * optimizations like inlining work across module boundaries.
+ *
+ * @returns 0 if no errors occured, other values if a symbol is defined
+ *          more than once
+ */
+FIRM_API int ir_link_program(void);
+
 /** @} */
 
 #include "end.h"
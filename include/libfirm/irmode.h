@@ -99,6 +99,25 @@ FIRM_API ir_mode *new_float_mode(const char *name,
  */
 FIRM_API ir_mode *new_non_arithmetic_mode(const char *name, unsigned bit_size);
 
+/**
+ * Creates a new vector mode with @p n_lanes lanes of @p lane_mode.
+ *
+ * The lane mode must be an integer or float mode.  Vector values do not
+ * support scalar arithmetic (the arithmetic is irma_none), but tarvals of
+ * vector modes are folded lane-wise.  The name of the mode is derived from
+ * the lane mode and the lane count.
+ */
+FIRM_API ir_mode *new_vector_mode(ir_mode *lane_mode, unsigned n_lanes);
+
+/** Returns 1 if @p mode is a vector mode, 0 otherwise */
+FIRM_API int mode_is_vector(const ir_mode *mode);
+
+/** Returns the mode of a single lane of vector mode @p mode. */
+FIRM_API ir_mode *get_mode_lane_mode(const ir_mode *mode);
+
+/** Returns the number of lanes of vector mode @p mode. */
+FIRM_API unsigned get_mode_n_lanes(const ir_mode *mode);
+
 /** Returns the ident* of the mode */
 FIRM_API ident *get_mode_ident(const ir_mode *mode);
 
@@ -385,6 +404,13 @@ FIRM_API size_t ir_get_n_modes(void);
 /** Returns known mode number @p num. */
 FIRM_API ir_mode *ir_get_mode(size_t num);
 
+/**
+ * Returns the dense index of @p mode.  Indices count modes in creation
+ * order, so they are small, consecutive and stable; ir_get_mode() is the
+ * inverse. Useful to key per-mode lookup tables.
+ */
+FIRM_API unsigned get_mode_idx(const ir_mode *mode);
+
 /** @} */
 
 #include "end.h"
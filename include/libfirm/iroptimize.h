@@ -10,6 +10,9 @@
 #ifndef FIRM_IROPTIMIZE_H
 #define FIRM_IROPTIMIZE_H
 
+#include <stddef.h>
+#include <stdio.h>
+
 #include "firm_types.h"
 
 #include "begin.h"
@@ -397,6 +400,25 @@ FIRM_API void opt_tail_rec_irg(ir_graph *irg);
  */
 FIRM_API void combo(ir_graph *irg);
 
+/**
+ * Incremental variant of combo() for use after local CFG edits.
+ *
+ * Re-propagates constants and identities only through the cone affected
+ * by the given changed nodes, so the cost is proportional to the edit
+ * instead of the graph.  Because the optimistic fixpoint of combo()
+ * cannot be resumed soundly once the graph changed, the incremental run
+ * performs a pessimistic propagation; it is sound from any start state
+ * but may find fewer facts than a full run.  Passing NULL for @p changed
+ * or a seed set covering a large part of the graph falls back to a full
+ * combo() run.
+ *
+ * @param irg        the graph to run on
+ * @param changed    array of nodes changed since the last analysis
+ * @param n_changed  number of entries in @p changed
+ */
+FIRM_API void combo_incremental(ir_graph *irg, ir_node *const *changed,
+                                size_t n_changed);
+
 /** pointer to an optimization function */
 typedef void (*opt_ptr)(ir_graph *irg);
 
@@ -480,6 +502,21 @@ FIRM_API void garbage_collect_entities(void);
  */
 FIRM_API void dead_node_elimination(ir_graph *irg);
 
+/** In-place variant of dead_node_elimination().
+ *
+ *  Reclaims the memory of unreachable nodes by threading it onto the
+ *  graph's node free lists instead of copying the live graph to a new
+ *  obstack.  Live nodes keep their identity, so out edges, dominance
+ *  and other node-based analysis results stay valid; only the value
+ *  table for CSE is renewed.  Prefer this over dead_node_elimination()
+ *  whenever downstream passes rely on cached analyses, the copying
+ *  variant only pays off when the obstack itself has become badly
+ *  fragmented.
+ *
+ * @param irg  The graph to be cleaned up.
+ */
+FIRM_API void dead_node_reclamation(ir_graph *irg);
+
 /**
  * Code Placement.
  *
@@ -527,6 +564,18 @@ FIRM_API ir_tarval *computed_value_Cmp_Confirm(ir_node *left, ir_node *right,
  */
 FIRM_API ir_entity *create_compilerlib_entity(char const *name, ir_type *mt);
 
+/**
+ * Writes a report about the per-op rule callbacks of the local optimizer
+ * (equivalent_node/transform_node) to @p out and resets the counters.
+ * Rules are ranked by attempts that did not fire, i.e. by the scan cost
+ * paid without any benefit on the compiled workload.
+ *
+ * The counters are only collected while statistic events are enabled
+ * (see stat_ev_begin()) with the middle end optimization category active;
+ * the report is empty otherwise.
+ */
+FIRM_API void ir_localopt_dump_rule_stats(FILE *out);
+
 /** @} */
 
 #include "end.h"
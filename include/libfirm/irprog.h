@@ -242,6 +242,17 @@ FIRM_API size_t get_irp_n_asms(void);
 /** Returns the global asm include at position pos. */
 FIRM_API ident *get_irp_asm(size_t pos);
 
+/**
+ * Renumbers the debug node numbers of all nodes in the program
+ * sequentially, following a graph walk instead of allocation order.
+ * Graphs and dumps produced afterwards are reproducible across runs:
+ * the numbers no longer depend on how many temporary nodes earlier
+ * transformations allocated and discarded.
+ * Must not be called while node hash sets or hash maps are in use, as
+ * these hash nodes by their number.
+ */
+FIRM_API void ir_normalize_node_nrs(void);
+
 /** @} */
 
 #include "end.h"
@@ -38,6 +38,30 @@ FIRM_API int irn_verify(const ir_node *node);
  */
 FIRM_API int irg_verify(ir_graph *irg);
 
+/**
+ * Like irg_verify(), but only tests the local well-formedness of nodes
+ * created since the last successful irg_verify() or irg_verify_incremental()
+ * on @p irg. Global properties (control flow shape, dominance of uses) are
+ * not re-checked. Falls back to a full irg_verify() if the graph has never
+ * been verified before.
+ *
+ * @param irg  the IR-graph to check
+ * @return NON-zero if no problems were found
+ */
+FIRM_API int irg_verify_incremental(ir_graph *irg);
+
+/**
+ * Calls irg_verify() for every graph of the program, distributing the graphs
+ * over @p n_threads worker threads. Verification does not modify the graphs
+ * apart from recomputing per-graph dominance, so the graphs can be checked
+ * independently.
+ *
+ * @param n_threads  number of threads to use, 0 picks a default; a value of
+ *                   1 verifies serially
+ * @return NON-zero if no problems were found in any graph
+ */
+FIRM_API int irp_verify(unsigned n_threads);
+
 /**
  * Convenience function: Checks graph for errors, in case of error the graph
  * is dumped to a file with "-assert" suffix and the program aborted.
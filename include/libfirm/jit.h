@@ -10,6 +10,8 @@
 #ifndef FIRM_JIT_H
 #define FIRM_JIT_H
 
+#include <stdio.h>
+
 #include "firm_types.h"
 
 #include "begin.h"
@@ -69,9 +71,46 @@ FIRM_API unsigned be_get_function_size(ir_jit_function_t const *function);
 
 /**
  * Emit \p function into \p buffer and resolve symbols and relocations.
+ * The buffer is owned and mapped by the caller; several functions may be
+ * packed into a single executable arena and enabled with one protection
+ * change, libfirm performs no memory mapping of its own.
  */
 FIRM_API void be_emit_function(char *buffer, ir_jit_function_t *function);
 
+/**
+ * A collection of compiled functions to be written as a relocatable ELF
+ * object file. This bypasses the assembler: the machine code bytes produced
+ * by the jit encoders are packed into a .text section and unresolved entity
+ * references become ELF relocations against undefined symbols.
+ */
+typedef struct ir_jit_object_t ir_jit_object_t;
+
+/**
+ * Create a new (empty) object file collection.
+ */
+FIRM_API ir_jit_object_t *be_new_jit_object(void);
+
+/**
+ * Destroy \p object. Does not touch the jit segment holding the added
+ * functions.
+ */
+FIRM_API void be_destroy_jit_object(ir_jit_object_t *object);
+
+/**
+ * Add jit compiled \p function to \p object as a global symbol named after
+ * \p entity.
+ */
+FIRM_API void be_jit_object_add_function(ir_jit_object_t *object,
+                                         ir_entity *entity,
+                                         ir_jit_function_t *function);
+
+/**
+ * Write \p object as a relocatable ELF file to \p out.
+ * \returns 0 on success, a negative number if the target backend does not
+ *          support direct object emission.
+ */
+FIRM_API int be_jit_object_write_elf(ir_jit_object_t *object, FILE *out);
+
 /** @} */
 
 #include "end.h"
@@ -79,7 +79,10 @@ FIRM_API void lower_CopyB(ir_graph *irg, unsigned max_small_size,
 
 /**
  * Lowers all Switches (Cond nodes with non-boolean mode) depending on spare_size.
- * They will either remain the same or be converted into if-cascades.
+ * They will either remain the same or be converted into if-cascades; dense
+ * case clusters inside a cascade become inner jump tables again.  When
+ * profile data is loaded, cases dominating the executions of a switch are
+ * peeled off into comparisons in front of it.
  *
  * @param irg        The ir graph to be lowered.
  * @param small_switch  If switch has <= cases then change it to an if-cascade.
@@ -19,6 +19,10 @@
  * \see machine_triple describes the format of @p target_triple.
  * Note that preparation isn't finished until ir_target_init() is called.
  *
+ * May be called again after code was generated to select another target
+ * without reinitializing the whole library; graphs and types constructed for
+ * the previous target must not be used with the new one.
+ *
  * @returns 1 if successfull, 0 if @p target_triple is malformed or unsupported.
  */
 FIRM_API int ir_target_set(const char *target_triple);
@@ -159,6 +159,28 @@ FIRM_API ir_tarval *new_tarval_from_bytes(unsigned char const *buf,
 FIRM_API ir_tarval *new_tarval_nan(ir_mode *mode, int signaling,
                                    ir_tarval const *payload);
 
+/**
+ * Construct a new vector tarval from its lane values.
+ *
+ * @param lanes    array of get_mode_n_lanes(mode) tarvals of the lane mode
+ * @param n_lanes  number of entries in @p lanes, must match the mode
+ * @param mode     vector mode for the resulting value
+ * @return A newly created (or cached) tarval representing the value.
+ */
+FIRM_API ir_tarval *new_tarval_vector(ir_tarval *const *lanes, size_t n_lanes,
+                                      ir_mode *mode);
+
+/**
+ * Construct a new vector tarval with all lanes set to @p lane_value.
+ */
+FIRM_API ir_tarval *new_tarval_vector_splat(ir_tarval *lane_value,
+                                            ir_mode *mode);
+
+/**
+ * Returns lane @p lane of the vector tarval @p tv.
+ */
+FIRM_API ir_tarval *get_tarval_vector_lane(ir_tarval const *tv, unsigned lane);
+
 /**
  * Write tarval to a sequence of bytes. The value is written in a
  * "little endian" fashion which means the less significant bytes come first.
@@ -50,6 +50,14 @@ typedef struct {
  */
 FIRM_API void set_vrp_data(ir_graph *irg);
 
+/**
+ * Prepares irg for demand-driven value range queries without running the
+ * whole-graph fixpoint of set_vrp_data(). Ranges are then computed
+ * lazily by vrp_get_or_compute_info() and memoized.
+ * @param irg graph on which to answer vrp queries
+ */
+FIRM_API void vrp_init_data(ir_graph *irg);
+
 /**
  * free vrp infos in an irg
  */
@@ -73,6 +81,18 @@ FIRM_API ir_relation vrp_cmp(const ir_node *left, const ir_node *right);
  */
 FIRM_API vrp_attr *vrp_get_info(const ir_node *n);
 
+/**
+ * Returns the vrp data for this node, computing it on demand along the
+ * SSA def chain if it is not memoized yet. Cycles through Phi nodes are
+ * cut off conservatively.
+ *
+ * @param n: the node for which to return the vrp information
+ * @return a pointer to the vrp data or NULL if there is no vrp store on
+ *         the graph (neither vrp_init_data() nor set_vrp_data() was
+ *         called) or the node does not have an integer mode
+ */
+FIRM_API vrp_attr *vrp_get_or_compute_info(const ir_node *n);
+
 /** @} */
 
 #include "end.h"
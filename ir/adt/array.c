@@ -11,12 +11,26 @@
 #include "array.h"
 
 #include "fourcc.h"
+#include "panic.h"
 #include "util.h"
 #include "xmalloc.h"
 #include <stdlib.h>
+#include <string.h>
 
 #define ARR_D_MAGIC FOURCC('A','R','R','D')
 #define ARR_F_MAGIC FOURCC('A','R','R','F')
+#define ARR_O_MAGIC FOURCC('A','R','R','O')
+#define ARR_S_MAGIC FOURCC('A','R','R','S')
+
+/** Header of an obstack backed flexible array: the common descriptor
+ * prefixed by the obstack the array grows on. */
+typedef struct ir_arr_obst_descr {
+	struct obstack *obst;
+	ir_arr_descr    descr;
+} ir_arr_obst_descr;
+
+#define ARR_OBST_DESCR(dp) \
+	((ir_arr_obst_descr*)((char*)(dp) - offsetof(ir_arr_obst_descr, descr)))
 
 /**
  * An empty dynamic array descriptor.
@@ -27,7 +41,8 @@ void ir_verify_arr(const void *arr)
 {
 #ifndef NDEBUG
 	ir_arr_descr *const descr = ARR_DESCR(arr);
-	assert(descr->magic == ARR_D_MAGIC || descr->magic == ARR_F_MAGIC);
+	assert(descr->magic == ARR_D_MAGIC || descr->magic == ARR_F_MAGIC
+	    || descr->magic == ARR_O_MAGIC || descr->magic == ARR_S_MAGIC);
 	assert(descr->allocated >= descr->nelts);
 #else
 	(void) arr;
@@ -38,9 +53,7 @@ void *ir_new_arr_d(struct obstack *obstack, size_t nelts, size_t elts_size)
 {
 	ir_arr_descr *const dp
 		= (ir_arr_descr*)obstack_alloc(obstack, sizeof(*dp) + elts_size);
-#ifndef NDEBUG
 	dp->magic = ARR_D_MAGIC;
-#endif
 	dp->allocated = dp->nelts = nelts;
 	return dp->elts;
 }
@@ -48,23 +61,46 @@ void *ir_new_arr_d(struct obstack *obstack, size_t nelts, size_t elts_size)
 void *ir_new_arr_f(size_t nelts, size_t elts_size)
 {
 	ir_arr_descr *const dp = (ir_arr_descr*)xmalloc(sizeof(*dp)+elts_size);
-#ifndef NDEBUG
 	dp->magic = ARR_F_MAGIC;
-#endif
 	dp->allocated = dp->nelts = nelts;
 	return dp->elts;
 }
 
+void *ir_new_arr_o(struct obstack *obstack, size_t nelts, size_t elts_size)
+{
+	ir_arr_obst_descr *const odp = (ir_arr_obst_descr*)
+		obstack_alloc(obstack, sizeof(*odp) + elts_size);
+	odp->obst = obstack;
+	odp->descr.magic = ARR_O_MAGIC;
+	odp->descr.allocated = odp->descr.nelts = nelts;
+	return odp->descr.elts;
+}
+
+void *ir_arr_init_s(ir_arr_descr *descr, size_t capacity)
+{
+	descr->magic = ARR_S_MAGIC;
+	descr->allocated = capacity;
+	descr->nelts = 0;
+	return descr->elts;
+}
+
 void DEL_ARR_F(void *elts)
 {
 	ir_verify_arr(elts);
 
 	ir_arr_descr *const dp = ARR_DESCR(elts);
-	assert(dp->magic == ARR_F_MAGIC);
+	assert(dp->magic == ARR_F_MAGIC || dp->magic == ARR_S_MAGIC);
+	if (dp->magic == ARR_F_MAGIC) {
 #ifndef NDEBUG
-	dp->magic = 0xdeadbeef;
+		dp->magic = 0xdeadbeef;
+#endif
+		free(dp);
+	} else {
+		/* small-buffer array that never outgrew its stack storage */
+#ifndef NDEBUG
+		dp->magic = 0xdeadbeef;
 #endif
-	free(dp);
+	}
 }
 
 void *ir_arr_setlen(void *elts, size_t nelts, size_t elts_size)
@@ -78,12 +114,83 @@ void *ir_arr_setlen(void *elts, size_t nelts, size_t elts_size)
 	return dp->elts;
 }
 
+/** Geometric growth resize of an obstack backed array.  Shrinking only
+ * adjusts the length; growth reuses the trailing obstack space when the
+ * array is still the topmost allocation, otherwise the old copy is
+ * abandoned to the arena. */
+static void *ir_arr_resize_o(ir_arr_descr *dp, size_t nelts, size_t eltsize)
+{
+	if (nelts <= dp->allocated) {
+		dp->nelts = nelts;
+		return dp->elts;
+	}
+
+	size_t n = MAX(1, dp->allocated);
+	while (nelts > n)
+		n <<= 1;
+
+	ir_arr_obst_descr *const odp  = ARR_OBST_DESCR(dp);
+	struct obstack    *const obst = odp->obst;
+	char *const old_end
+		= (char*)odp + sizeof(*odp) + eltsize * dp->allocated;
+	if (old_end == (char*)obstack_next_free(obst)
+	 && (size_t)obstack_room(obst) >= eltsize * (n - dp->allocated)) {
+		/* Topmost allocation and the grown array still fits into the
+		 * current chunk: give the old space back so the allocation below
+		 * extends it in place.  Freeing without the room check would let
+		 * obstack release the old chunk before the contents are copied. */
+		obstack_free(obst, odp);
+	}
+	ir_arr_obst_descr *const ndp = (ir_arr_obst_descr*)
+		obstack_alloc(obst, sizeof(*ndp) + eltsize * n);
+	if (ndp != odp)
+		memcpy(ndp, odp, sizeof(*odp) + eltsize * dp->nelts);
+	ndp->descr.allocated = n;
+	ndp->descr.nelts     = nelts;
+	return ndp->descr.elts;
+}
+
+/** Resize of a small-buffer array: stays in its stack storage while the
+ * capacity suffices and migrates to a heap allocated flexible array
+ * otherwise. */
+static void *ir_arr_resize_s(ir_arr_descr *dp, size_t nelts, size_t eltsize)
+{
+	if (nelts <= dp->allocated) {
+		dp->nelts = nelts;
+		return dp->elts;
+	}
+
+	size_t n = MAX(1, dp->allocated);
+	while (nelts > n)
+		n <<= 1;
+
+	ir_arr_descr *const ndp = (ir_arr_descr*)xmalloc(sizeof(*ndp)
+	                                                 + eltsize * n);
+	ndp->magic     = ARR_F_MAGIC;
+	ndp->allocated = n;
+	ndp->nelts     = nelts;
+	memcpy(ndp->elts, dp->elts, eltsize * dp->nelts);
+#ifndef NDEBUG
+	dp->magic = 0xdeadbeef;
+#endif
+	return ndp->elts;
+}
+
 void *ir_arr_resize(void *elts, size_t nelts, size_t eltsize)
 {
 	ir_verify_arr(elts);
 
 	ir_arr_descr *dp = ARR_DESCR(elts);
-	assert(dp->magic == ARR_F_MAGIC);
+	switch (dp->magic) {
+	case ARR_O_MAGIC:
+		return ir_arr_resize_o(dp, nelts, eltsize);
+	case ARR_S_MAGIC:
+		return ir_arr_resize_s(dp, nelts, eltsize);
+	case ARR_F_MAGIC:
+		break;
+	default:
+		panic("attempt to resize a non-resizable array");
+	}
 
 	/* @@@ lots of resizes for small nelts */
 	size_t n = MAX(1, dp->allocated);
@@ -374,6 +374,18 @@ static inline void bitset_or(bitset_t *tgt, bitset_t const *src)
 	rbitset_or(tgt->data, src->data, src->size);
 }
 
+/**
+ * Perform Union, tgt = tgt u src, and report whether tgt grew.
+ * @param tgt  The target bitset.
+ * @param src  The source bitset.
+ * @return true if the union added at least one new bit to tgt.
+ */
+static inline bool bitset_or_changed(bitset_t *tgt, bitset_t const *src)
+{
+	assert(tgt->size == src->size);
+	return rbitset_or_changed(tgt->data, src->data, src->size);
+}
+
 /**
  * Perform tgt = tgt ^ src operation.
  * @param tgt  The target bitset.
@@ -4,14 +4,72 @@
  */
 #include "deq.h"
 
+#include "firm_thread.h"
 #include "xmalloc.h"
 #include <stdlib.h>
 #include <string.h>
 
+/** Maximum number of blocks kept for reuse. */
+#define DEQ_POOL_SIZE 16
+
+/* All blocks have the same size, so instead of bouncing them through
+ * malloc/free a small pool keeps freed blocks for reuse.  Walkers and
+ * schedulers create thousands of short-lived deqs per compilation and
+ * the allocator churn was visible in profiles.  The pool is a simple
+ * singly linked list through next_right, bounded so that a single
+ * large queue cannot pin memory for the rest of the compilation.
+ * Graph-local passes use deqs and may run concurrently under a parallel
+ * driver, so pushes and pops are guarded like the interning tables. */
+static deq_block_t *block_pool;
+static unsigned     block_pool_size;
+
+static deq_block_t *alloc_block(void)
+{
+	firm_alloc_lock();
+	deq_block_t *block = block_pool;
+	if (block != NULL) {
+		block_pool = block->next_right;
+		--block_pool_size;
+	}
+	firm_alloc_unlock();
+	if (block == NULL)
+		block = XMALLOCF(deq_block_t, data, DEQ_BLOCK_DATA_SIZE);
+	return block;
+}
+
+static void release_block(deq_block_t *block)
+{
+	bool pooled = false;
+	firm_alloc_lock();
+	if (block_pool_size < DEQ_POOL_SIZE) {
+		block->next_right = block_pool;
+		block_pool = block;
+		++block_pool_size;
+		pooled = true;
+	}
+	firm_alloc_unlock();
+	if (!pooled)
+		free(block);
+}
+
+void deq_pool_finish(void)
+{
+	for (deq_block_t *block = block_pool, *next; block != NULL;
+	     block = next) {
+		next = block->next_right;
+		free(block);
+	}
+	block_pool      = NULL;
+	block_pool_size = 0;
+}
+
 void deq_init(deq_t *deq)
 {
-	deq_block_t *block = XMALLOCF(deq_block_t, data, DEQ_BLOCK_DATA_SIZE);
-	memset(block, 0, sizeof(deq_block_t));
+	deq_block_t *block = alloc_block();
+	block->l          = 0;
+	block->r          = 0;
+	block->next_left  = NULL;
+	block->next_right = NULL;
 	deq->left_end  = block;
 	deq->right_end = block;
 }
@@ -21,7 +79,7 @@ void deq_free(deq_t *deq)
 	for (deq_block_t *block = deq->left_end, *next; block != NULL;
 	     block = next) {
 	    next = block->next_right;
-		free(block);
+		release_block(block);
 	}
 #ifndef NDEBUG
 	deq->left_end = NULL;
@@ -40,7 +98,7 @@ deq_block_t *deq_append_block_left_priv(deq_t *deq)
 		assert(newb->next_left == NULL);
 		assert(newb->next_right == NULL);
 	} else {
-		newb = XMALLOCF(deq_block_t, data, DEQ_BLOCK_DATA_SIZE);
+		newb = alloc_block();
 		newb->next_left  = NULL;
 		newb->next_right = left_end;
 
@@ -63,7 +121,7 @@ deq_block_t *deq_append_block_right_priv(deq_t *deq)
 		assert(newb->next_left == NULL);
 		assert(newb->next_right == NULL);
 	} else {
-		newb = XMALLOCF(deq_block_t, data, DEQ_BLOCK_DATA_SIZE);
+		newb = alloc_block();
 		newb->next_left  = right_end;
 		newb->next_right = NULL;
 
@@ -86,7 +144,7 @@ void deq_left_end_block_empty_priv(deq_t *deq)
 		assert(next_right->next_left == block);
 		deq->left_end = next_right;
 		next_right->next_left = NULL;
-		free(block);
+		release_block(block);
 	} else {
 		assert(block == deq->right_end);
 		block->l = 0;
@@ -104,10 +162,32 @@ void deq_right_end_block_empty_priv(deq_t *deq)
 		assert(next_left->next_right == block);
 		deq->right_end = next_left;
 		next_left->next_right = NULL;
-		free(block);
+		release_block(block);
 	} else {
 		assert(block == deq->left_end);
 		block->l = 0;
 		block->r = 0;
 	}
 }
+
+void deq_push_array_right(deq_t *deq, void const *data, unsigned size,
+                          size_t count)
+{
+	assert(size < DEQ_BLOCK_DATA_SIZE);
+	char const *src = (char const*)data;
+	while (count > 0) {
+		deq_block_t *right_end = deq->right_end;
+		size_t       fit       = (DEQ_BLOCK_DATA_SIZE - right_end->r) / size;
+		if (fit == 0) {
+			right_end = deq_append_block_right_priv(deq);
+			fit = DEQ_BLOCK_DATA_SIZE / size;
+		}
+		if (fit > count)
+			fit = count;
+		size_t const bytes = fit * size;
+		memcpy(right_end->data + right_end->r, src, bytes);
+		right_end->r += (unsigned)bytes;
+		src   += bytes;
+		count -= fit;
+	}
+}
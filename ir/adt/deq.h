@@ -23,7 +23,7 @@
  */
 
 #define DEQ_BLOCK_SIZE        2048
-#define DEQ_BLOCK_DATA_SIZE   DEQ_BLOCK_SIZE - sizeof(deq_block_t)
+#define DEQ_BLOCK_DATA_SIZE   (DEQ_BLOCK_SIZE - sizeof(deq_block_t))
 
 typedef struct deq_block_t deq_block_t;
 struct deq_block_t {
@@ -55,6 +55,21 @@ void deq_init(deq_t *deq);
  */
 void deq_free(deq_t *deq);
 
+/**
+ * Free the pool of data blocks kept for reuse by the deq implementation.
+ * Only needed on library shutdown; using any deq afterwards is fine and
+ * simply refills the pool.
+ */
+void deq_pool_finish(void);
+
+/**
+ * Append \p count objects of \p size bytes each from the array \p data to
+ * the right end of double ended queue \p deq, copying block-sized runs at
+ * a time instead of pushing the objects one by one.
+ */
+void deq_push_array_right(deq_t *deq, void const *data, unsigned size,
+                          size_t count);
+
 /** Returns true if the double ended queue \p deq is empty, false otherwise. */
 static inline bool deq_empty(deq_t const *const deq)
 {
@@ -6,6 +6,10 @@
 #include <math.h>
 #include <string.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 typedef struct {
 	double   v;
 	unsigned col_idx;
@@ -22,6 +26,13 @@ struct gs_matrix_t {
 	unsigned   c_rows;
 	unsigned   n_zero_entries; /**< Upper bound on number of 0 entries */
 	row_col_t *rows;
+	/* Compressed row storage, built by gs_matrix_compact(). The values and
+	 * column indices are kept in separate arrays so the iteration kernel
+	 * can stream over them; zero entries are dropped during compaction. */
+	double   *csr_vals;  /**< all off-diagonal values, row by row */
+	unsigned *csr_cols;  /**< column index for every value in csr_vals */
+	unsigned *row_start; /**< c_rows+1 offsets into csr_vals/csr_cols */
+	double   *diags;     /**< the (inverted) diagonal of every row */
 };
 
 static void alloc_cols(row_col_t *row, unsigned c_cols)
@@ -58,18 +69,72 @@ gs_matrix_t *gs_new_matrix(unsigned n_init_rows, unsigned n_init_cols)
 
 void gs_delete_matrix(gs_matrix_t *m)
 {
-	for (unsigned i = 0; i < m->c_rows; ++i) {
-		if (m->rows[i].c_cols)
-			free(m->rows[i].cols);
-	}
-	if (m->c_rows)
+	if (m->rows != NULL) {
+		for (unsigned i = 0; i < m->c_rows; ++i) {
+			if (m->rows[i].c_cols)
+				free(m->rows[i].cols);
+		}
 		free(m->rows);
+	}
+	free(m->csr_vals);
+	free(m->csr_cols);
+	free(m->row_start);
+	free(m->diags);
 	free(m);
 }
 
+void gs_matrix_compact(gs_matrix_t *m)
+{
+	unsigned const n = m->c_rows;
+
+	if (m->row_start != NULL)
+		return;
+
+	unsigned n_entries = 0;
+	for (unsigned r = 0; r < n; ++r)
+		n_entries += m->rows[r].n_cols;
+
+	m->csr_vals  = XMALLOCN(double, n_entries);
+	m->csr_cols  = XMALLOCN(unsigned, n_entries);
+	m->row_start = XMALLOCN(unsigned, n + 1);
+	m->diags     = XMALLOCN(double, n);
+
+	unsigned k = 0;
+	for (unsigned r = 0; r < n; ++r) {
+		row_col_t *row = &m->rows[r];
+
+		m->row_start[r] = k;
+		m->diags[r]     = row->diag;
+		for (unsigned c = 0; c < row->n_cols; ++c) {
+			/* zero entries contribute nothing, drop them */
+			if (row->cols[c].v == 0.0)
+				continue;
+			m->csr_vals[k] = row->cols[c].v;
+			m->csr_cols[k] = row->cols[c].col_idx;
+			++k;
+		}
+
+		if (row->c_cols)
+			free(row->cols);
+	}
+	m->row_start[n] = k;
+	m->n_zero_entries = 0;
+
+	free(m->rows);
+	m->rows = NULL;
+}
+
 unsigned gs_matrix_get_n_entries(const gs_matrix_t *m)
 {
 	unsigned n_entries = 0;
+
+	if (m->row_start != NULL) {
+		n_entries = m->row_start[m->c_rows];
+		for (unsigned i = 0; i < m->c_rows; ++i)
+			n_entries += (m->diags[i] != 0.0) ? 1 : 0;
+		return n_entries;
+	}
+
 	for (unsigned i = 0; i < m->c_rows; ++i) {
 		n_entries += m->rows[i].n_cols;
 		n_entries += (m->rows[i].diag != 0.0) ? 1 : 0;
@@ -82,6 +147,7 @@ void gs_matrix_set(gs_matrix_t *m, unsigned row, unsigned col, double val)
 {
 	assert(row < m->c_rows);
 	assert(col < m->c_rows);
+	assert(m->row_start == NULL && "matrix was compacted, no more modifications allowed");
 	row_col_t *the_row = &m->rows[row];
 
 	if (row == col) {
@@ -139,6 +205,17 @@ void gs_matrix_set(gs_matrix_t *m, unsigned row, unsigned col, double val)
 double gs_matrix_get(const gs_matrix_t *m, unsigned row, unsigned col)
 {
 	assert(row < m->c_rows);
+
+	if (m->row_start != NULL) {
+		if (row == col)
+			return m->diags[row] != 0.0 ? 1.0 / m->diags[row] : 0.0;
+		for (unsigned c = m->row_start[row]; c < m->row_start[row+1]; ++c) {
+			if (m->csr_cols[c] == col)
+				return m->csr_vals[c];
+		}
+		return 0.0;
+	}
+
 	row_col_t *the_row = &m->rows[row];
 	if (row == col)
 		return the_row->diag != 0.0 ? 1.0 / the_row->diag : 0.0;
@@ -155,18 +232,63 @@ double gs_matrix_get(const gs_matrix_t *m, unsigned row, unsigned col)
 	return the_row->cols[c].v;
 }
 
+/**
+ * Computes the dot product of a compacted row with the vector @p x.
+ */
+static double gs_row_dot(double const *const vals, unsigned const *const cols,
+                         unsigned const len, double const *const x)
+{
+	double   sum = 0.0;
+	unsigned c   = 0;
+
+#ifdef __SSE2__
+	if (len >= 2) {
+		__m128d acc = _mm_setzero_pd();
+		for (; c + 2 <= len; c += 2) {
+			__m128d v  = _mm_loadu_pd(&vals[c]);
+			__m128d xs = _mm_set_pd(x[cols[c+1]], x[cols[c]]);
+			acc = _mm_add_pd(acc, _mm_mul_pd(v, xs));
+		}
+		acc = _mm_add_sd(acc, _mm_unpackhi_pd(acc, acc));
+		sum = _mm_cvtsd_f64(acc);
+	}
+#endif
+	for (; c < len; ++c)
+		sum += vals[c] * x[cols[c]];
+
+	return sum;
+}
+
 /* NOTE: You can slice out miss_rate and weights.
  * This does ONE step of gauss_seidel. Termination must be checked outside!
  * This solves m*x=0. You must add stuff for m*x=b. See wikipedia german and english article. Should be simple.
  * param a is the number of rows in the matrix that should be considered.
  *
+ * An omega of 1.0 gives the plain Gauss-Seidel update; values above 1.0
+ * over-relax towards the new value (SOR).
+ *
  * Note that the diagonal element is stored separately in this matrix implementation.
  * */
-double gs_matrix_gauss_seidel(const gs_matrix_t *m, double *x)
+double gs_matrix_gauss_seidel(const gs_matrix_t *m, double *x, double omega)
 {
 	double res = 0.0;
 	unsigned n = m->c_rows;
 
+	if (m->row_start != NULL) {
+		for (unsigned r = 0; r < n; ++r) {
+			unsigned const start = m->row_start[r];
+			double   const sum   = gs_row_dot(&m->csr_vals[start],
+			                                  &m->csr_cols[start],
+			                                  m->row_start[r+1] - start, x);
+
+			double old = x[r];
+			double nw  = old + omega * (- sum * m->diags[r] - old);
+			res += fabs(old - nw);
+			x[r] = nw;
+		}
+		return res;
+	}
+
 	for (unsigned r = 0; r < n; ++r) {
 		row_col_t *row  = &m->rows[r];
 		col_val_t *cols = row->cols;
@@ -178,8 +300,7 @@ double gs_matrix_gauss_seidel(const gs_matrix_t *m, double *x)
 		}
 
 		double old = x[r];
-		double nw  = - sum * row->diag;
-		/* nw = old - overdrive * (old + sum * row->diag); */
+		double nw  = old + omega * (- sum * row->diag - old);
 		res += fabs(old - nw);
 		x[r] = nw;
 	}
@@ -194,15 +315,21 @@ void gs_matrix_dump(const gs_matrix_t *m, FILE *out)
 
 	/* The rows which have some content */
 	for (unsigned r = 0; r < size; ++r) {
-		row_col_t *row = &m->rows[r];
-
 		memset(elems, 0, size * sizeof(*elems));
 
-		for (unsigned c = 0; c < row->n_cols; ++c) {
-			unsigned col_idx = row->cols[c].col_idx;
-			elems[col_idx] = row->cols[c].v;
+		if (m->row_start != NULL) {
+			for (unsigned c = m->row_start[r]; c < m->row_start[r+1]; ++c)
+				elems[m->csr_cols[c]] = m->csr_vals[c];
+			elems[r] = m->diags[r] != 0.0 ? 1.0 / m->diags[r] : 0.0;
+		} else {
+			row_col_t *row = &m->rows[r];
+
+			for (unsigned c = 0; c < row->n_cols; ++c) {
+				unsigned col_idx = row->cols[c].col_idx;
+				elems[col_idx] = row->cols[c].v;
+			}
+			elems[r] = row->diag != 0.0 ? 1.0 / row->diag : 0.0;
 		}
-		elems[r] = row->diag != 0.0 ? 1.0 / row->diag : 0.0;
 
 		for (unsigned i = 0; i < size; ++i) {
 			if (elems[i] != 0.0)
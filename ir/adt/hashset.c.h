@@ -40,8 +40,9 @@
  * You can further fine tune your hashset by defining the following:
  *
  * <ul>
- *  <li><b>JUMP(num_probes)</b> The probing method</li>
- *  <li><b>Alloc(count)</b>     Allocates count hashset entries (NOT bytes)</li>
+ *  <li><b>Alloc(count)</b>     Allocates count hashset entries (NOT bytes).
+ *                              Note that the set allocates a few entries more
+ *                              than num_buckets to hold the control bytes</li>
  *  <li><b>Free(ptr)</b>        Frees a block of memory allocated by Alloc</li>
  *  <li><b>SetRangeEmpty(ptr,count)</b> Efficiently sets a range of elements to
  *                                      the Null value</li>
@@ -52,14 +53,14 @@
 
 #include <limits.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
-#include "bitfiddle.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
-/* quadratic probing */
-#ifndef JUMP
-#define JUMP(num_probes)      (num_probes)
-#endif /* JUMP */
+#include "bitfiddle.h"
 
 #ifndef Hash
 #define ID_HASH
@@ -72,9 +73,15 @@
 #define EntryGetHash(self,entry)       Hash(self, GetKey(entry))
 #define EntryGetValue(entry)           (entry)
 #else /* ! DO_REHASH */
+#ifndef EntryGetHash
 #define EntryGetHash(self,entry)       (entry).hash
+#endif
+#ifndef EntrySetHash
 #define EntrySetHash(entry,new_hash)   (entry).hash = (new_hash)
+#endif
+#ifndef EntryGetValue
 #define EntryGetValue(entry)           (entry).data
+#endif
 #endif /* DO_REHASH */
 
 #ifndef Alloc
@@ -159,6 +166,83 @@
 
 #define ILLEGAL_POS       ((size_t)-1)
 
+/* Swiss-table style probing: a separate control byte per bucket, stored
+ * behind the entries in the same allocation and scanned a whole group at a
+ * time. An empty byte terminates the probe sequence; a full byte carries
+ * 7 bits of the hash so candidate entries are filtered before the entry
+ * itself is touched. Deletions only turn full bytes into deleted ones, so
+ * stopping at the first empty byte stays correct. */
+#define CTRL_EMPTY        0x00
+#define CTRL_DELETED      0x01
+#define CTRL_GROUP_SIZE   16
+#define CtrlOfHash(hash)  ((unsigned char)(0x80u | ((hash) & 0x7fu)))
+
+/**
+ * Number of additional entry slots needed to store one control byte per
+ * bucket.
+ * @internal
+ */
+static inline size_t ctrl_overhead(size_t num_buckets)
+{
+	return (num_buckets + sizeof(HashSetEntry) - 1) / sizeof(HashSetEntry);
+}
+
+/**
+ * Returns the control byte array of an entry array.
+ * @internal
+ */
+static inline unsigned char *ctrl_of(HashSetEntry *entries, size_t num_buckets)
+{
+	return (unsigned char*)(entries + num_buckets);
+}
+
+/**
+ * Size of one probe group. Tables smaller than CTRL_GROUP_SIZE consist of a
+ * single group.
+ * @internal
+ */
+static inline size_t ctrl_group_size(size_t num_buckets)
+{
+	return num_buckets < CTRL_GROUP_SIZE ? num_buckets : CTRL_GROUP_SIZE;
+}
+
+/**
+ * Returns a bitmask of the control bytes in the group at @p base that are
+ * equal to @p byte.
+ * @internal
+ */
+static inline unsigned ctrl_match(unsigned char const *control, size_t base,
+                                  size_t group_size, unsigned char byte)
+{
+#ifdef __SSE2__
+	if (group_size == CTRL_GROUP_SIZE) {
+		__m128i const group = _mm_loadu_si128((__m128i const*)&control[base]);
+		__m128i const match = _mm_cmpeq_epi8(group, _mm_set1_epi8((char)byte));
+		return (unsigned)_mm_movemask_epi8(match);
+	}
+#endif
+	unsigned mask = 0;
+	for (size_t i = 0; i < group_size; ++i) {
+		if (control[base + i] == byte)
+			mask |= 1u << i;
+	}
+	return mask;
+}
+
+/**
+ * Allocates an entry array including its control bytes, which are
+ * initialized to empty. Takes the set because the Alloc macro of some
+ * instantiations refers to it.
+ * @internal
+ */
+static inline HashSetEntry *alloc_entries(HashSet *self, size_t num_buckets)
+{
+	(void)self;
+	HashSetEntry *entries = Alloc(num_buckets + ctrl_overhead(num_buckets));
+	memset(ctrl_of(entries, num_buckets), CTRL_EMPTY, num_buckets);
+	return entries;
+}
+
 #ifdef hashset_size
 /**
  * Returns the number of elements in the hashset
@@ -183,47 +267,52 @@ static inline size_t hashset_size(const HashSet *self)
  */
 static inline FindReturnValue insert_nogrow(HashSet *self, KeyType key)
 {
-	size_t   num_probes  = 0;
-	size_t   num_buckets = self->num_buckets;
-	size_t   hashmask    = num_buckets - 1;
-	unsigned hash        = Hash(self, key);
-	size_t   bucknum     = hash & hashmask;
-	size_t   insert_pos  = ILLEGAL_POS;
+	size_t         num_buckets = self->num_buckets;
+	unsigned       hash        = Hash(self, key);
+	unsigned char *control     = ctrl_of(self->entries, num_buckets);
+	unsigned char  h2          = CtrlOfHash(hash);
+	size_t         group_size  = ctrl_group_size(num_buckets);
+	size_t         group_mask  = num_buckets / group_size - 1;
+	size_t         group       = (hash & (num_buckets - 1)) / group_size;
+	size_t         insert_pos  = ILLEGAL_POS;
 
 	assert((num_buckets & (num_buckets - 1)) == 0);
 
-	for (;;) {
-		HashSetEntry *entry = & self->entries[bucknum];
+	for (size_t step = 0;;) {
+		size_t const base = group * group_size;
 
-		if (EntryIsEmpty(*entry)) {
-			size_t p;
-			HashSetEntry *nentry;
-
-			if (insert_pos != ILLEGAL_POS) {
-				p = insert_pos;
-			} else {
-				p = bucknum;
+		for (unsigned match = ctrl_match(control, base, group_size, h2);
+		     match != 0; match &= match - 1) {
+			HashSetEntry *entry = &self->entries[base + ntz(match)];
+			if (EntryGetHash(self, *entry) == hash
+			 && KeysEqual(self, GetKey(EntryGetValue(*entry)), key)) {
+				// Value already in the set, return it
+				return GetFindReturnValue(*entry, true);
 			}
+		}
 
-			nentry = &self->entries[p];
+		if (insert_pos == ILLEGAL_POS) {
+			unsigned const deleted
+				= ctrl_match(control, base, group_size, CTRL_DELETED);
+			if (deleted != 0)
+				insert_pos = base + ntz(deleted);
+		}
+
+		unsigned const empty
+			= ctrl_match(control, base, group_size, CTRL_EMPTY);
+		if (empty != 0) {
+			size_t const p = insert_pos != ILLEGAL_POS
+			               ? insert_pos : base + ntz(empty);
+			HashSetEntry *nentry = &self->entries[p];
 			InitData(self, EntryGetValue(*nentry), key);
 			EntrySetHash(*nentry, hash);
+			control[p] = h2;
 			self->num_elements++;
 			return GetFindReturnValue(*nentry, false);
 		}
-		if (EntryIsDeleted(*entry)) {
-			if (insert_pos == ILLEGAL_POS)
-				insert_pos = bucknum;
-		} else if (EntryGetHash(self, *entry) == hash) {
-			if (KeysEqual(self, GetKey(EntryGetValue(*entry)), key)) {
-				// Value already in the set, return it
-				return GetFindReturnValue(*entry, true);
-			}
-		}
 
-		++num_probes;
-		bucknum = (bucknum + JUMP(num_probes)) & hashmask;
-		assert(num_probes < num_buckets);
+		group = (group + ++step) & group_mask;
+		assert(step < num_buckets);
 	}
 }
 
@@ -246,38 +335,32 @@ static inline void reset_thresholds(HashSet *self)
  */
 static void insert_new(HashSet *self, unsigned hash, ValueType value)
 {
-	size_t num_probes  = 0;
-	size_t num_buckets = self->num_buckets;
-	size_t hashmask    = num_buckets - 1;
-	size_t bucknum     = hash & hashmask;
-	size_t insert_pos  = ILLEGAL_POS;
+	size_t         num_buckets = self->num_buckets;
+	unsigned char *control     = ctrl_of(self->entries, num_buckets);
+	size_t         group_size  = ctrl_group_size(num_buckets);
+	size_t         group_mask  = num_buckets / group_size - 1;
+	size_t         group       = (hash & (num_buckets - 1)) / group_size;
 
 	//assert(value != NullValue);
 
-	for (;;) {
-		HashSetEntry *entry = & self->entries[bucknum];
-
-		if (EntryIsEmpty(*entry)) {
-			size_t        p;
-			HashSetEntry *nentry;
+	for (size_t step = 0;;) {
+		size_t   const base = group * group_size;
+		unsigned const empty
+			= ctrl_match(control, base, group_size, CTRL_EMPTY);
 
-			if (insert_pos != ILLEGAL_POS) {
-				p = insert_pos;
-			} else {
-				p = bucknum;
-			}
-			nentry = &self->entries[p];
+		if (empty != 0) {
+			size_t const p = base + ntz(empty);
+			HashSetEntry *nentry = &self->entries[p];
 
 			EntryGetValue(*nentry) = value;
 			EntrySetHash(*nentry, hash);
+			control[p] = CtrlOfHash(hash);
 			self->num_elements++;
 			return;
 		}
-		assert(!EntryIsDeleted(*entry));
 
-		++num_probes;
-		bucknum = (bucknum + JUMP(num_probes)) & hashmask;
-		assert(num_probes < num_buckets);
+		group = (group + ++step) & group_mask;
+		assert(step < num_buckets);
 	}
 }
 
@@ -293,7 +376,7 @@ static inline void resize(HashSet *self, size_t new_size)
 	HashSetEntry *new_entries;
 
 	/* allocate a new array with double size */
-	new_entries = Alloc(new_size);
+	new_entries = alloc_entries(self, new_size);
 	SetRangeEmpty(new_entries, new_size);
 
 	/* use the new array */
@@ -409,30 +492,32 @@ FindReturnValue hashset_insert(HashSet *self, KeyType key)
  */
 FindReturnValue hashset_find(const HashSet *self, ConstKeyType key)
 {
-	size_t   num_probes  = 0;
-	size_t   num_buckets = self->num_buckets;
-	size_t   hashmask    = num_buckets - 1;
-	unsigned hash        = Hash(self, key);
-	size_t   bucknum     = hash & hashmask;
-
-	for (;;) {
-		HashSetEntry *entry = & self->entries[bucknum];
-
-		if (EntryIsEmpty(*entry)) {
-			return NullReturnValue;
-		}
-		if (EntryIsDeleted(*entry)) {
-			// value is deleted
-		} else if (EntryGetHash(self, *entry) == hash) {
-			if (KeysEqual(self, GetKey(EntryGetValue(*entry)), key)) {
+	size_t         num_buckets = self->num_buckets;
+	unsigned       hash        = Hash(self, key);
+	unsigned char *control     = ctrl_of(self->entries, num_buckets);
+	unsigned char  h2          = CtrlOfHash(hash);
+	size_t         group_size  = ctrl_group_size(num_buckets);
+	size_t         group_mask  = num_buckets / group_size - 1;
+	size_t         group       = (hash & (num_buckets - 1)) / group_size;
+
+	for (size_t step = 0;;) {
+		size_t const base = group * group_size;
+
+		for (unsigned match = ctrl_match(control, base, group_size, h2);
+		     match != 0; match &= match - 1) {
+			HashSetEntry *entry = &self->entries[base + ntz(match)];
+			if (EntryGetHash(self, *entry) == hash
+			 && KeysEqual(self, GetKey(EntryGetValue(*entry)), key)) {
 				// found the value
 				return GetFindReturnValue(*entry, true);
 			}
 		}
 
-		++num_probes;
-		bucknum = (bucknum + JUMP(num_probes)) & hashmask;
-		assert(num_probes < num_buckets);
+		if (ctrl_match(control, base, group_size, CTRL_EMPTY) != 0)
+			return NullReturnValue;
+
+		group = (group + ++step) & group_mask;
+		assert(step < num_buckets);
 	}
 }
 #endif
@@ -447,36 +532,40 @@ FindReturnValue hashset_find(const HashSet *self, ConstKeyType key)
  */
 void hashset_remove(HashSet *self, ConstKeyType key)
 {
-	size_t   num_probes  = 0;
-	size_t   num_buckets = self->num_buckets;
-	size_t   hashmask    = num_buckets - 1;
-	unsigned hash        = Hash(self, key);
-	size_t   bucknum     = hash & hashmask;
+	size_t         num_buckets = self->num_buckets;
+	unsigned       hash        = Hash(self, key);
+	unsigned char *control     = ctrl_of(self->entries, num_buckets);
+	unsigned char  h2          = CtrlOfHash(hash);
+	size_t         group_size  = ctrl_group_size(num_buckets);
+	size_t         group_mask  = num_buckets / group_size - 1;
+	size_t         group       = (hash & (num_buckets - 1)) / group_size;
 
 #ifndef NDEBUG
 	self->entries_version++;
 #endif
 
-	for (;;) {
-		HashSetEntry *entry = & self->entries[bucknum];
+	for (size_t step = 0;;) {
+		size_t const base = group * group_size;
 
-		if (EntryIsEmpty(*entry)) {
-			return;
-		}
-		if (EntryIsDeleted(*entry)) {
-			// entry is deleted
-		} else if (EntryGetHash(self, *entry) == hash) {
-			if (KeysEqual(self, GetKey(EntryGetValue(*entry)), key)) {
+		for (unsigned match = ctrl_match(control, base, group_size, h2);
+		     match != 0; match &= match - 1) {
+			size_t        p     = base + ntz(match);
+			HashSetEntry *entry = &self->entries[p];
+			if (EntryGetHash(self, *entry) == hash
+			 && KeysEqual(self, GetKey(EntryGetValue(*entry)), key)) {
 				EntrySetDeleted(*entry);
+				control[p] = CTRL_DELETED;
 				self->num_deleted++;
 				self->consider_shrink = 1;
 				return;
 			}
 		}
 
-		++num_probes;
-		bucknum = (bucknum + JUMP(num_probes)) & hashmask;
-		assert(num_probes < num_buckets);
+		if (ctrl_match(control, base, group_size, CTRL_EMPTY) != 0)
+			return;
+
+		group = (group + ++step) & group_mask;
+		assert(step < num_buckets);
 	}
 }
 #endif
@@ -490,7 +579,7 @@ static inline void init_size(HashSet *self, size_t initial_size)
 	if (initial_size < 4)
 		initial_size = 4;
 
-	self->entries         = Alloc(initial_size);
+	self->entries         = alloc_entries(self, initial_size);
 	SetRangeEmpty(self->entries, initial_size);
 	self->num_buckets     = initial_size;
 	self->consider_shrink = 0;
@@ -613,6 +702,8 @@ void hashset_remove_iterator(HashSet *self, const HashSetIterator *iter)
 		return;
 
 	EntrySetDeleted(*entry);
+	ctrl_of(self->entries, self->num_buckets)[entry - self->entries]
+		= CTRL_DELETED;
 	self->num_deleted++;
 	self->consider_shrink = 1;
 }
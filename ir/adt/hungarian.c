@@ -37,6 +37,7 @@
 #include "xmalloc.h"
 #include <assert.h>
 #include <limits.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -52,6 +53,21 @@ struct hungarian_problem_t {
 	                                  the right side */
 	unsigned     *missing_right; /**< bitset: right side nodes having no edge to
 	                              the left side */
+	/* State kept across solves. A solved problem may be edited and solved
+	 * again; only the edited rows are repaired then (warm start). */
+	bool          solved;        /**< a valid matching and potentials exist */
+	unsigned     *dirty_rows;    /**< bitset: rows edited since the last solve */
+	unsigned     *col_mate;      /**< matched column for every row */
+	unsigned     *row_mate;      /**< matched row for every column */
+	int          *row_pot;       /**< row potentials (dual values) */
+	int          *col_pot;       /**< column potentials (dual values) */
+	int          *col_sub;       /**< column minima of the first solve, base
+	                                  value for the cost_threshold check */
+	/* scratch space for hungarian_solve() */
+	unsigned     *parent_row;
+	unsigned     *unchosen_row;
+	int          *slack;
+	unsigned     *slack_row;
 };
 
 static void hungarian_dump_f(FILE *const f, const unsigned *const cost,
@@ -101,6 +117,18 @@ hungarian_problem_t *hungarian_new(unsigned const num_rows,
 
 	/* Allocate space for cost matrix */
 	p->cost = XMALLOCNZ(unsigned, size*size);
+
+	/* Solver state and scratch space, reused across solves */
+	p->dirty_rows   = rbitset_malloc(size);
+	p->col_mate     = XMALLOCNZ(unsigned, size);
+	p->row_mate     = XMALLOCNZ(unsigned, size);
+	p->row_pot      = XMALLOCNZ(int, size);
+	p->col_pot      = XMALLOCNZ(int, size);
+	p->col_sub      = XMALLOCNZ(int, size);
+	p->parent_row   = XMALLOCNZ(unsigned, size);
+	p->unchosen_row = XMALLOCNZ(unsigned, size);
+	p->slack        = XMALLOCNZ(int, size);
+	p->slack_row    = XMALLOCNZ(unsigned, size);
 	return p;
 }
 
@@ -121,6 +149,10 @@ void hungarian_prepare_cost_matrix(hungarian_problem_t *const p,
 	} else {
 		panic("unknown hungarian problem mode");
 	}
+
+	/* all cells were rewritten, a previous solution is of no use anymore */
+	if (p->solved)
+		rbitset_set_all(p->dirty_rows, p->num_rows);
 }
 
 void hungarian_add(hungarian_problem_t *const p, unsigned const left,
@@ -132,6 +164,9 @@ void hungarian_add(hungarian_problem_t *const p, unsigned const left,
 	p->cost[left*p->num_cols + right] = cost;
 	p->max_cost                       = MAX(p->max_cost, cost);
 
+	if (p->solved)
+		rbitset_set(p->dirty_rows, left);
+
 	if (p->match_type == HUNGARIAN_MATCH_NORMAL) {
 		rbitset_clear(p->missing_left, left);
 		rbitset_clear(p->missing_right, right);
@@ -145,6 +180,9 @@ void hungarian_remove(hungarian_problem_t *p, unsigned left, unsigned right)
 
 	p->cost[left*p->num_cols + right] = 0;
 
+	if (p->solved)
+		rbitset_set(p->dirty_rows, left);
+
 	if (p->match_type == HUNGARIAN_MATCH_NORMAL) {
 		rbitset_set(p->missing_left, left);
 		rbitset_set(p->missing_right, right);
@@ -156,6 +194,16 @@ void hungarian_free(hungarian_problem_t *const p)
 	free(p->missing_left);
 	free(p->missing_right);
 	free(p->cost);
+	free(p->dirty_rows);
+	free(p->col_mate);
+	free(p->row_mate);
+	free(p->row_pot);
+	free(p->col_pot);
+	free(p->col_sub);
+	free(p->parent_row);
+	free(p->unchosen_row);
+	free(p->slack);
+	free(p->slack_row);
 	free(p);
 }
 
@@ -167,71 +215,101 @@ int hungarian_solve(hungarian_problem_t *const p, unsigned *const assignment,
 	unsigned  const num_rows     = p->num_rows;
 	unsigned  const num_cols     = p->num_cols;
 	unsigned *const cost         = p->cost;
-	unsigned *const col_mate     = XMALLOCNZ(unsigned, num_rows);
-	unsigned *const row_mate     = XMALLOCNZ(unsigned, num_cols);
-	unsigned *const parent_row   = XMALLOCNZ(unsigned, num_cols);
-	unsigned *const unchosen_row = XMALLOCNZ(unsigned, num_rows);
-	int      *const row_dec      = XMALLOCNZ(int, num_rows);
-	int      *const col_inc      = XMALLOCNZ(int, num_cols);
-	int      *const slack        = XMALLOCNZ(int, num_cols);
-	unsigned *const slack_row    = XMALLOCNZ(unsigned, num_rows);
+	unsigned *const col_mate     = p->col_mate;
+	unsigned *const row_mate     = p->row_mate;
+	unsigned *const parent_row   = p->parent_row;
+	unsigned *const unchosen_row = p->unchosen_row;
+	int      *const row_dec      = p->row_pot;
+	int      *const col_pot      = p->col_pot;
+	int      *const slack        = p->slack;
+	unsigned *const slack_row    = p->slack_row;
+	unsigned        unmatched    = 0;
 
 	memset(assignment, -1, num_rows * sizeof(assignment[0]));
 
-	/* Begin subtract column minima in order to start with lots of zeros 12 */
-	DBG((dbg, LEVEL_1, "Using heuristic\n"));
-
 	for (unsigned c = 0; c < num_cols; ++c) {
-		unsigned col_mininum = cost[0*num_cols + c];
-		for (unsigned r = 1; r < num_rows; ++r) {
-			if (cost[r*num_cols + c] < col_mininum)
-				col_mininum = cost[r*num_cols + c];
-		}
-		if (col_mininum == 0)
-			continue;
-
-		res_cost += col_mininum;
-		for (unsigned r = 0; r < num_rows; ++r)
-			cost[r*num_cols + c] -= col_mininum;
-	}
-	/* End subtract column minima in order to start with lots of zeros 12 */
-
-	/* Begin initial state 16 */
-	for (unsigned c = 0; c < num_cols; ++c) {
-		row_mate[c]   = ~0u;
 		parent_row[c] = ~0u;
-		col_inc[c]    = 0;
 		slack[c]      = INT_MAX;
 	}
 
-	unsigned unmatched = 0;
-	for (unsigned r = 0; r < num_rows; ++r) {
-		unsigned row_minimum = cost[r*num_cols + 0];
-		for (unsigned c = 1; c < num_cols; ++c) {
-			if (cost[r*num_cols + c] < row_minimum)
-				row_minimum = cost[r*num_cols + c];
+	if (!p->solved) {
+		/* Begin subtract column minima in order to start with lots of zeros 12 */
+		DBG((dbg, LEVEL_1, "Using heuristic\n"));
+
+		for (unsigned c = 0; c < num_cols; ++c) {
+			unsigned col_mininum = cost[0*num_cols + c];
+			for (unsigned r = 1; r < num_rows; ++r) {
+				if (cost[r*num_cols + c] < col_mininum)
+					col_mininum = cost[r*num_cols + c];
+			}
+			col_pot[c]    = col_mininum;
+			p->col_sub[c] = col_mininum;
 		}
+		/* End subtract column minima in order to start with lots of zeros 12 */
 
-		row_dec[r] = row_minimum;
+		/* Begin initial state 16 */
+		for (unsigned c = 0; c < num_cols; ++c)
+			row_mate[c] = ~0u;
 
-		for (unsigned c = 0; c < num_cols; ++c) {
-			if (cost[r*num_cols + c] != row_minimum)
-				continue;
-			if (row_mate[c] != ~0u)
-				continue;
+		for (unsigned r = 0; r < num_rows; ++r) {
+			int row_minimum = (int)cost[r*num_cols + 0] - col_pot[0];
+			for (unsigned c = 1; c < num_cols; ++c) {
+				int reduced = (int)cost[r*num_cols + c] - col_pot[c];
+				if (reduced < row_minimum)
+					row_minimum = reduced;
+			}
 
-			col_mate[r] = c;
-			row_mate[c] = r;
-			DBG((dbg, LEVEL_1, "matching col %u == row %u\n", c, r));
-			goto row_done;
-		}
+			row_dec[r] = row_minimum;
 
-		col_mate[r] = ~0u;
-		DBG((dbg, LEVEL_1, "node %u: unmatched row %u\n", unmatched, r));
-		unchosen_row[unmatched++] = r;
+			for (unsigned c = 0; c < num_cols; ++c) {
+				if ((int)cost[r*num_cols + c] - col_pot[c] != row_minimum)
+					continue;
+				if (row_mate[c] != ~0u)
+					continue;
+
+				col_mate[r] = c;
+				row_mate[c] = r;
+				DBG((dbg, LEVEL_1, "matching col %u == row %u\n", c, r));
+				goto row_done;
+			}
+
+			col_mate[r] = ~0u;
+			DBG((dbg, LEVEL_1, "node %u: unmatched row %u\n", unmatched, r));
+			unchosen_row[unmatched++] = r;
 row_done: ;
+		}
+		/* End initial state 16 */
+	} else {
+		/* Warm start: the matching and the potentials of the last solve are
+		 * still valid for all untouched rows. Unmatch the edited rows, give
+		 * them a feasible potential again and let the algorithm repair only
+		 * those. */
+		DBG((dbg, LEVEL_1, "Using warm start\n"));
+
+		rbitset_foreach(p->dirty_rows, num_rows, r) {
+			unsigned const mate = col_mate[r];
+			if (mate != ~0u) {
+				row_mate[mate] = ~0u;
+				col_mate[r]    = ~0u;
+			}
+
+			int row_minimum = (int)cost[r*num_cols + 0] - col_pot[0];
+			for (unsigned c = 1; c < num_cols; ++c) {
+				int reduced = (int)cost[r*num_cols + c] - col_pot[c];
+				if (reduced < row_minimum)
+					row_minimum = reduced;
+			}
+			row_dec[r] = row_minimum;
+		}
+
+		for (unsigned r = 0; r < num_rows; ++r) {
+			if (col_mate[r] == ~0u) {
+				DBG((dbg, LEVEL_1, "node %u: unmatched row %u\n", unmatched, r));
+				unchosen_row[unmatched++] = r;
+			}
+		}
 	}
-	/* End initial state 16 */
+	p->solved = false;
 
 	/* Begin Hungarian algorithm 18 */
 	if (unmatched == 0)
@@ -254,7 +332,7 @@ row_done: ;
 					if (!slack[c])
 						continue;
 
-					int del = cost[r*num_cols + c] - s + col_inc[c];
+					int del = (int)cost[r*num_cols + c] - s - col_pot[c];
 					if (del < slack[c]) {
 						if (del == 0) {
 							if (row_mate[c] == ~0u) {
@@ -297,7 +375,7 @@ row_done: ;
 						if (row_mate[c] == ~0u) {
 							for (unsigned j = c + 1; j < num_cols; ++j) {
 								if (slack[j] == 0)
-									col_inc[j] += s;
+									col_pot[j] -= s;
 							}
 							breakthru_r = r;
 							breakthru_c = c;
@@ -310,7 +388,7 @@ row_done: ;
 						/* End look at a new zero 22 */
 					}
 				} else {
-					col_inc[c] += s;
+					col_pot[c] -= s;
 				}
 			}
 			/* End introduce a new zero into the matrix 21 */
@@ -357,7 +435,7 @@ done:
 	/* Begin double check the solution 23 */
 	for (unsigned r = 0; r < num_rows; ++r) {
 		for (unsigned c = 0; c < num_cols; ++c) {
-			if ((int) cost[r*num_cols + c] < row_dec[r] - col_inc[c]) {
+			if ((int) cost[r*num_cols + c] < row_dec[r] + col_pot[c]) {
 				result = -1;
 				goto ret;
 			}
@@ -367,14 +445,14 @@ done:
 	for (unsigned r = 0; r < num_rows; ++r) {
 		unsigned c = col_mate[r];
 		if (c == ~0u
-		    || cost[r*num_cols + c] != (unsigned) (row_dec[r] - col_inc[c])) {
+		    || cost[r*num_cols + c] != (unsigned) (row_dec[r] + col_pot[c])) {
 		    result = -2;
 		    goto ret;
 		}
 	}
 
 	for (unsigned c = 0, r = 0; c < num_cols; ++c) {
-		if (col_inc[c]) {
+		if (col_pot[c] != p->col_sub[c]) {
 			++r;
 			if (r > num_rows) {
 				result = -3;
@@ -386,13 +464,19 @@ done:
 
 	/* End Hungarian algorithm 18 */
 
+	/* The matching and the potentials stay valid, so the next solve after
+	 * editing some rows only has to repair those. */
+	p->solved = true;
+	rbitset_clear_all(p->dirty_rows, num_rows);
+
 	/* collect the assigned values */
 	for (unsigned r = 0; r < num_rows; ++r) {
+		unsigned const c = col_mate[r];
 		if (cost_threshold > 0
-		 && cost[r*num_cols + col_mate[r]] >= cost_threshold)
+		 && (int)cost[r*num_cols + c] - p->col_sub[c] >= (int)cost_threshold)
 			assignment[r] = -1; /* remove matching having cost > threshold */
 		else
-			assignment[r] = col_mate[r];
+			assignment[r] = c;
 	}
 
 	/* In case of normal matching: remove impossible ones */
@@ -404,17 +488,13 @@ done:
 		}
 	}
 
-	for (unsigned r = 0; r < num_rows; ++r) {
-		for (unsigned c = 0; c < num_cols; ++c) {
-			cost[r*num_cols + c] = cost[r*num_cols + c] - row_dec[r] + col_inc[c];
-		}
-	}
-
+	/* The total of the potentials equals the cost of the matching. The cost
+	 * matrix itself is left untouched, so later edits use plain costs. */
 	for (unsigned r = 0; r < num_rows; ++r)
 		res_cost += row_dec[r];
 
 	for (unsigned c = 0; c < num_cols; ++c)
-		res_cost -= col_inc[c];
+		res_cost += col_pot[c];
 
 	DBG((dbg, LEVEL_1, "Cost is %d\n", res_cost));
 
@@ -422,14 +502,5 @@ ret:
 	if (final_cost != NULL)
 		*final_cost = res_cost;
 
-	free(col_mate);
-	free(row_mate);
-	free(parent_row);
-	free(unchosen_row);
-	free(row_dec);
-	free(col_inc);
-	free(slack);
-	free(slack_row);
-
 	return result;
 }
@@ -0,0 +1,199 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2026 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Indexed priority queue with decrease-key.
+ *
+ * The heap layout matches pqueue.c: 4-ary, 0-based, children of index i
+ * at 4*i+1 .. 4*i+4, parent at (i-1)/4.  On top of that a position map
+ * records for every caller-supplied id where its element currently sits
+ * in the heap array (index + 1, 0 meaning "not queued"), which makes
+ * priority updates O(log n) instead of forcing a re-insert.
+ */
+#include "iheap.h"
+
+#include "array.h"
+#include "panic.h"
+#include "util.h"
+#include "xmalloc.h"
+
+#include <string.h>
+
+/** number of children per heap node */
+#define IHEAP_ARITY 4
+
+typedef struct iheap_el_t {
+	void    *data;
+	int      priority;
+	unsigned id;
+} iheap_el_t;
+
+struct iheap_t {
+	iheap_el_t *elems;
+	/** maps id to heap index + 1; 0 means the id is not queued */
+	unsigned   *pos;
+	size_t      pos_size;
+};
+
+/** Make sure the position map covers @p id. */
+static void iheap_reserve_pos(iheap_t *heap, unsigned id)
+{
+	if (id < heap->pos_size)
+		return;
+	size_t new_size = MAX(heap->pos_size * 2, 32u);
+	while (id >= new_size)
+		new_size *= 2;
+	heap->pos = XREALLOC(heap->pos, unsigned, new_size);
+	memset(heap->pos + heap->pos_size, 0,
+	       (new_size - heap->pos_size) * sizeof(heap->pos[0]));
+	heap->pos_size = new_size;
+}
+
+/** Place element @p el at heap position @p pos and update the map. */
+static void iheap_set(iheap_t *heap, size_t pos, iheap_el_t el)
+{
+	heap->elems[pos]   = el;
+	heap->pos[el.id]   = pos + 1;
+}
+
+static void iheap_sift_up(iheap_t *heap, size_t pos)
+{
+	iheap_el_t const el = heap->elems[pos];
+	while (pos != 0) {
+		size_t const parent = (pos - 1) / IHEAP_ARITY;
+		if (heap->elems[parent].priority >= el.priority)
+			break;
+		iheap_set(heap, pos, heap->elems[parent]);
+		pos = parent;
+	}
+	iheap_set(heap, pos, el);
+}
+
+static void iheap_sift_down(iheap_t *heap, size_t pos)
+{
+	size_t     const len = ARR_LEN(heap->elems);
+	iheap_el_t const el  = heap->elems[pos];
+	for (;;) {
+		size_t child = pos * IHEAP_ARITY + 1;
+		if (child >= len)
+			break;
+
+		size_t       best = child;
+		size_t const last = MIN(child + IHEAP_ARITY, len);
+		for (++child; child < last; ++child) {
+			if (heap->elems[best].priority < heap->elems[child].priority)
+				best = child;
+		}
+		if (heap->elems[best].priority <= el.priority)
+			break;
+
+		iheap_set(heap, pos, heap->elems[best]);
+		pos = best;
+	}
+	iheap_set(heap, pos, el);
+}
+
+iheap_t *new_iheap(void)
+{
+	iheap_t *res = XMALLOCZ(iheap_t);
+	res->elems = NEW_ARR_F(iheap_el_t, 0);
+	return res;
+}
+
+void del_iheap(iheap_t *heap)
+{
+	DEL_ARR_F(heap->elems);
+	free(heap->pos);
+	free(heap);
+}
+
+size_t iheap_length(iheap_t const *heap)
+{
+	return ARR_LEN(heap->elems);
+}
+
+bool iheap_empty(iheap_t const *heap)
+{
+	return ARR_LEN(heap->elems) == 0;
+}
+
+bool iheap_contains(iheap_t const *heap, unsigned id)
+{
+	return id < heap->pos_size && heap->pos[id] != 0;
+}
+
+void iheap_put(iheap_t *heap, unsigned id, void *data, int priority)
+{
+	iheap_reserve_pos(heap, id);
+	iheap_el_t const el = {
+		.data     = data,
+		.priority = priority,
+		.id       = id
+	};
+
+	unsigned const mapped = heap->pos[id];
+	if (mapped != 0) {
+		/* update in place and sift towards the new position */
+		size_t const pos      = mapped - 1;
+		int    const old_prio = heap->elems[pos].priority;
+		heap->elems[pos] = el;
+		if (priority > old_prio) {
+			iheap_sift_up(heap, pos);
+		} else if (priority < old_prio) {
+			iheap_sift_down(heap, pos);
+		}
+		return;
+	}
+
+	ARR_APP1(iheap_el_t, heap->elems, el);
+	iheap_sift_up(heap, ARR_LEN(heap->elems) - 1);
+}
+
+void *iheap_pop(iheap_t *heap)
+{
+	size_t const len = ARR_LEN(heap->elems);
+	if (len == 0)
+		panic("attempt to retrieve element from empty indexed heap");
+
+	iheap_el_t const front = heap->elems[0];
+	heap->pos[front.id] = 0;
+	if (len > 1) {
+		iheap_set(heap, 0, heap->elems[len - 1]);
+		ARR_SHRINKLEN(heap->elems, len - 1);
+		iheap_sift_down(heap, 0);
+	} else {
+		ARR_SHRINKLEN(heap->elems, 0);
+	}
+	return front.data;
+}
+
+void iheap_append(iheap_t *heap, unsigned id, void *data, int priority)
+{
+	iheap_reserve_pos(heap, id);
+	assert(heap->pos[id] == 0);
+	iheap_el_t const el = {
+		.data     = data,
+		.priority = priority,
+		.id       = id
+	};
+	ARR_APP1(iheap_el_t, heap->elems, el);
+	heap->pos[id] = (unsigned)ARR_LEN(heap->elems);
+}
+
+void iheap_build(iheap_t *heap)
+{
+	size_t const len = ARR_LEN(heap->elems);
+	if (len <= 1)
+		return;
+	/* Floyd's bottom-up heap construction */
+	size_t pos = (len - 2) / IHEAP_ARITY;
+	for (;;) {
+		iheap_sift_down(heap, pos);
+		if (pos == 0)
+			break;
+		--pos;
+	}
+}
@@ -0,0 +1,58 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2026 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Indexed priority queue with decrease-key.
+ *
+ * A 4-ary max-heap over (data, priority) pairs where every element is
+ * identified by a small unsigned id supplied by the caller.  A position
+ * map keyed by this id allows updating the priority of a queued element
+ * in place instead of re-inserting it and filtering stale entries on pop.
+ */
+#ifndef FIRM_ADT_IHEAP_H
+#define FIRM_ADT_IHEAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct iheap_t iheap_t;
+
+/** Create a new empty indexed heap. */
+iheap_t *new_iheap(void);
+
+/** Free all memory used by the indexed heap @p heap. */
+void del_iheap(iheap_t *heap);
+
+/** Return the number of elements queued in @p heap. */
+size_t iheap_length(iheap_t const *heap);
+
+/** Return true if @p heap contains no elements. */
+bool iheap_empty(iheap_t const *heap);
+
+/** Return true if an element with id @p id is currently queued. */
+bool iheap_contains(iheap_t const *heap, unsigned id);
+
+/**
+ * Insert @p data with @p priority under id @p id, or, if @p id is already
+ * queued, change its priority (and data) in place.  The element is sifted
+ * towards its new position in either direction.
+ */
+void iheap_put(iheap_t *heap, unsigned id, void *data, int priority);
+
+/** Remove and return the element with the highest priority. */
+void *iheap_pop(iheap_t *heap);
+
+/**
+ * Append @p data with @p priority under id @p id without restoring the
+ * heap property.  @p id must not be queued yet.  Use together with
+ * iheap_build() to set up a heap from n elements in O(n).
+ */
+void iheap_append(iheap_t *heap, unsigned id, void *data, int priority);
+
+/** Restore the heap property after a series of iheap_append() calls. */
+void iheap_build(iheap_t *heap);
+
+#endif
@@ -0,0 +1,148 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2026 University of Karlsruhe.
+ */
+#include "obstack_pool.h"
+
+#include "firm_thread.h"
+#include "xmalloc.h"
+#include <stdlib.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/** Maximum number of large chunks kept for reuse. */
+#define OBST_POOL_SIZE 8
+
+/* Freed chunks of exactly FIRM_OBST_LARGE_CHUNK_SIZE are kept on a
+ * bounded free list instead of being returned to malloc.  Graph
+ * obstacks come and go with every constructed and freed ir_graph, so
+ * without the pool every graph pays the malloc round trip for each of
+ * its chunks again.  The list is threaded through the chunk's prev
+ * pointer.  Graph obstacks grow concurrently when a parallel driver is
+ * running, so pushes and pops are guarded like the interning tables. */
+static struct _obstack_chunk *chunk_pool;
+static unsigned               chunk_pool_size;
+
+static void *firm_obstack_chunk_alloc(ptrdiff_t size)
+{
+	if (size == FIRM_OBST_LARGE_CHUNK_SIZE) {
+		firm_alloc_lock();
+		struct _obstack_chunk *const chunk = chunk_pool;
+		if (chunk != NULL) {
+			chunk_pool = chunk->prev;
+			--chunk_pool_size;
+		}
+		firm_alloc_unlock();
+		if (chunk != NULL)
+			return chunk;
+	}
+	if (size >= FIRM_OBST_HUGE_CHUNK_SIZE) {
+		/* Align huge chunks to their own size so the kernel can back
+		 * them with huge pages. */
+		void *ptr = NULL;
+		if (posix_memalign(&ptr, FIRM_OBST_HUGE_CHUNK_SIZE, size) == 0) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+			madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+			return ptr;
+		}
+		/* fall through to plain malloc on alignment failure */
+	}
+	return xmalloc(size);
+}
+
+static void firm_obstack_chunk_free(void *ptr)
+{
+	struct _obstack_chunk *const chunk = (struct _obstack_chunk*)ptr;
+	ptrdiff_t const size = chunk->limit - (char*)chunk;
+	if (size == FIRM_OBST_LARGE_CHUNK_SIZE) {
+		bool pooled = false;
+		firm_alloc_lock();
+		if (chunk_pool_size < OBST_POOL_SIZE) {
+			chunk->prev = chunk_pool;
+			chunk_pool  = chunk;
+			++chunk_pool_size;
+			pooled = true;
+		}
+		firm_alloc_unlock();
+		if (pooled)
+			return;
+	}
+	free(chunk);
+}
+
+void firm_obstack_init_large(struct obstack *obst)
+{
+	_obstack_begin(obst, FIRM_OBST_LARGE_CHUNK_SIZE, 0,
+	               firm_obstack_chunk_alloc, firm_obstack_chunk_free);
+}
+
+void firm_obstack_init_huge(struct obstack *obst)
+{
+	_obstack_begin(obst, FIRM_OBST_HUGE_CHUNK_SIZE, 0,
+	               firm_obstack_chunk_alloc, firm_obstack_chunk_free);
+}
+
+/* Temporary obstacks for pass-local data.  Nearly every pass opens a
+ * private obstack with lifetime = pass duration; recycling a small set
+ * of initialized obstacks turns the per-pass setup and teardown into a
+ * free list pop and a reset to a mark which keeps the first chunk.  Like
+ * the chunk pool above the free list is guarded, passes grabbing
+ * temporary obstacks may run concurrently under a parallel driver. */
+typedef struct temp_obst_t temp_obst_t;
+struct temp_obst_t {
+	struct obstack obst; /**< must stay the first member, the public
+	                          interface hands out a pointer to it */
+	temp_obst_t   *next; /**< next free temporary obstack */
+	void          *base; /**< mark directly after initialization */
+};
+
+static temp_obst_t *temp_obst_free_list;
+
+struct obstack *firm_temp_obst_grab(void)
+{
+	firm_alloc_lock();
+	temp_obst_t *tmp = temp_obst_free_list;
+	if (tmp != NULL)
+		temp_obst_free_list = tmp->next;
+	firm_alloc_unlock();
+	if (tmp == NULL) {
+		tmp = XMALLOC(temp_obst_t);
+		firm_obstack_init_large(&tmp->obst);
+		tmp->base = obstack_alloc(&tmp->obst, 0);
+	}
+	return &tmp->obst;
+}
+
+void firm_temp_obst_release(struct obstack *obst)
+{
+	/* the obstack is the first member, so the pointers coincide */
+	temp_obst_t *const tmp = (temp_obst_t*)obst;
+	obstack_free(obst, tmp->base);
+	firm_alloc_lock();
+	tmp->next           = temp_obst_free_list;
+	temp_obst_free_list = tmp;
+	firm_alloc_unlock();
+}
+
+void firm_obstack_pool_finish(void)
+{
+	for (temp_obst_t *tmp = temp_obst_free_list, *next; tmp != NULL;
+	     tmp = next) {
+		next = tmp->next;
+		obstack_free(&tmp->obst, NULL);
+		free(tmp);
+	}
+	temp_obst_free_list = NULL;
+
+	for (struct _obstack_chunk *chunk = chunk_pool, *prev; chunk != NULL;
+	     chunk = prev) {
+		prev = chunk->prev;
+		free(chunk);
+	}
+	chunk_pool      = NULL;
+	chunk_pool_size = 0;
+}
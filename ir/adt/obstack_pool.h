@@ -0,0 +1,64 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2026 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Obstack initialization with larger, pooled chunks.
+ *
+ * The default obstack configuration allocates slightly-below-4k chunks
+ * from malloc.  For long-lived, large obstacks like the per-graph node
+ * obstack this produces a long chain of small chunks and constant
+ * malloc traffic while graphs are built and dropped.  The initializers
+ * here use bigger chunks, recycle freed chunks through a bounded pool
+ * and, where the OS supports it, advise huge page backing for the
+ * really large ones.
+ */
+#ifndef FIRM_ADT_OBSTACK_POOL_H
+#define FIRM_ADT_OBSTACK_POOL_H
+
+#include "obst.h"
+
+/** Chunk size used by firm_obstack_init_large(). */
+#define FIRM_OBST_LARGE_CHUNK_SIZE (256 * 1024)
+
+/** Chunk size used by firm_obstack_init_huge(). */
+#define FIRM_OBST_HUGE_CHUNK_SIZE  (2 * 1024 * 1024)
+
+/**
+ * Initialize obstack \p obst with large chunks taken from (and returned
+ * to) a bounded chunk pool.  Use for obstacks expected to grow beyond a
+ * few kilobytes, e.g. the per-graph node obstack.
+ */
+void firm_obstack_init_large(struct obstack *obst);
+
+/**
+ * Initialize obstack \p obst with huge-page sized, suitably aligned
+ * chunks.  On Linux the chunks are madvise()d for transparent huge page
+ * backing.  Use only for obstacks expected to grow into the megabytes.
+ */
+void firm_obstack_init_huge(struct obstack *obst);
+
+/**
+ * Returns a temporary obstack for pass-local data.  The obstacks are
+ * kept on a free list and handed out initialized, so a pass does not
+ * pay the obstack setup and chunk allocation on every invocation.
+ * Grabbing nests: a pass running inside another pass gets its own
+ * obstack.
+ */
+struct obstack *firm_temp_obst_grab(void);
+
+/**
+ * Returns a temporary obstack to the free list.  All objects on it are
+ * freed, but its first chunk is kept for the next firm_temp_obst_grab().
+ */
+void firm_temp_obst_release(struct obstack *obst);
+
+/**
+ * Free all chunks kept for reuse.  Only needed on library shutdown;
+ * initializing further obstacks afterwards is fine and refills the pool.
+ */
+void firm_obstack_pool_finish(void);
+
+#endif
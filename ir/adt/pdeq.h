@@ -26,6 +26,12 @@ static inline void deq_push_pointer_right(deq_t *deq, void *ptr)
 	*space = ptr;
 }
 
+static inline void deq_push_pointer_array_right(deq_t *deq, void *const *ptrs,
+                                                size_t count)
+{
+	deq_push_array_right(deq, ptrs, sizeof(void*), count);
+}
+
 static inline void *deq_pop_pointer_left(deq_t *deq)
 {
 	void *result = *((void**)deq_left_end(deq));
@@ -11,29 +11,72 @@
  */
 #include "pmap.h"
 
+#include "bitfiddle.h"
 #include "hashptr.h"
-#include "set.h"
+#include "util.h"
+#include "xmalloc.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
 
 #define INITIAL_SLOTS 64
 
-/** map a pmap into a set */
-#define M2S(map)  (set*)(map)
+/* Open addressing table with the key/value pairs stored inline: one
+ * flat allocation, linear probing and power-of-two growth.  There is no
+ * removal in the pmap API, so no tombstones are needed.  A NULL key
+ * marks an empty slot; an entry for the NULL key itself is kept
+ * separately. */
+struct pmap {
+	pmap_entry *entries;       /**< slot array, capacity mask+1 */
+	size_t      mask;          /**< capacity - 1, capacity is a power of two */
+	size_t      num_elements;  /**< number of used slots */
+	size_t      iter_pos;      /**< current slot of a running iteration */
+	pmap_entry  null_entry;    /**< entry for the NULL key */
+	bool        has_null;      /**< whether the NULL key is mapped */
+#ifndef NDEBUG
+	bool        iterating;     /**< a first/next iteration is running */
+#endif
+};
+
+static void pmap_init_table(pmap *map, size_t capacity)
+{
+	map->entries = XMALLOCNZ(pmap_entry, capacity);
+	map->mask    = capacity - 1;
+}
 
-/**
- * compare the keys of two entry pairs
- */
-static int pmap_entry_cmp(void const *p1, void const *p2, size_t size)
+/** Find the slot of @p key, or the empty slot where it would go. */
+static pmap_entry *pmap_find_slot(pmap const *map, void const *key)
 {
-	const pmap_entry *entry1 = (const pmap_entry*)p1;
-	const pmap_entry *entry2 = (const pmap_entry*)p2;
-	(void)size;
+	size_t i = hash_ptr(key) & map->mask;
+	for (;;) {
+		pmap_entry *const entry = &((pmap*)map)->entries[i];
+		if (entry->key == key || entry->key == NULL)
+			return entry;
+		i = (i + 1) & map->mask;
+	}
+}
 
-	return entry1->key != entry2->key;
+static void pmap_grow(pmap *map)
+{
+	assert(!map->iterating && "pmap grew during iteration");
+
+	pmap_entry *const old_entries = map->entries;
+	size_t      const old_size    = map->mask + 1;
+	pmap_init_table(map, old_size * 2);
+	for (size_t i = 0; i < old_size; ++i) {
+		pmap_entry const *const entry = &old_entries[i];
+		if (entry->key == NULL)
+			continue;
+		*pmap_find_slot(map, entry->key) = *entry;
+	}
+	free(old_entries);
 }
 
 pmap *pmap_create_ex(size_t slots)
 {
-	return (pmap *)new_set(pmap_entry_cmp, slots);
+	pmap *const map = XMALLOCZ(pmap);
+	pmap_init_table(map, ceil_po2(MAX(slots, 16)));
+	return map;
 }
 
 pmap *pmap_create(void)
@@ -43,16 +86,28 @@ pmap *pmap_create(void)
 
 void pmap_destroy(pmap *map)
 {
-	del_set(M2S(map));
+	free(map->entries);
+	free(map);
 }
 
 void pmap_insert(pmap *map, const void *key, void *value)
 {
-	pmap_entry entry, *p;
-
-	entry.key = key;
-	p = set_insert(pmap_entry, M2S(map), &entry, sizeof(pmap_entry), hash_ptr(key));
-	p->value = value;
+	if (key == NULL) {
+		map->null_entry.value = value;
+		map->has_null = true;
+		return;
+	}
+
+	/* grow at 75% load */
+	if (map->num_elements + 1 > map->mask - (map->mask >> 2))
+		pmap_grow(map);
+
+	pmap_entry *const entry = pmap_find_slot(map, key);
+	if (entry->key == NULL) {
+		entry->key = key;
+		++map->num_elements;
+	}
+	entry->value = value;
 }
 
 int pmap_contains(pmap const *map, const void *key)
@@ -62,11 +117,12 @@ int pmap_contains(pmap const *map, const void *key)
 
 pmap_entry *pmap_find(pmap const *map, const void *key)
 {
-	pmap_entry const entry = { key, 0 };
-	return set_find(pmap_entry, M2S(map), &entry, sizeof(entry), hash_ptr(key));
+	if (key == NULL)
+		return map->has_null ? &((pmap*)map)->null_entry : NULL;
+	pmap_entry *const entry = pmap_find_slot(map, key);
+	return entry->key != NULL ? entry : NULL;
 }
 
-
 void *(pmap_get)(pmap const *map, const void *key)
 {
 	pmap_entry * entry = pmap_find(map, key);
@@ -75,20 +131,39 @@ void *(pmap_get)(pmap const *map, const void *key)
 
 size_t pmap_count(pmap const *map)
 {
-	return set_count(M2S(map));
+	return map->num_elements + map->has_null;
 }
 
-pmap_entry *pmap_first(pmap *map)
+pmap_entry *pmap_next(pmap *map)
 {
-	return set_first(pmap_entry, M2S(map));
+	for (size_t i = map->iter_pos; i <= map->mask; ++i) {
+		pmap_entry *const entry = &map->entries[i];
+		if (entry->key == NULL)
+			continue;
+		map->iter_pos = i + 1;
+		return entry;
+	}
+#ifndef NDEBUG
+	map->iterating = false;
+#endif
+	return NULL;
 }
 
-pmap_entry *pmap_next(pmap *map)
+pmap_entry *pmap_first(pmap *map)
 {
-	return set_next(pmap_entry, M2S(map));
+#ifndef NDEBUG
+	assert(!map->iterating);
+	map->iterating = true;
+#endif
+	map->iter_pos = 0;
+	if (map->has_null)
+		return &map->null_entry;
+	return pmap_next(map);
 }
 
 void pmap_break(pmap *map)
 {
-	set_break(M2S(map));
+#ifndef NDEBUG
+	map->iterating = false;
+#endif
 }
@@ -7,17 +7,11 @@
  * @file
  * Implements a heap.
  *
- * Implementation note: It might seem strange that we start indexing at 0
- * but use 2*i and 2*i+1 to find the left and right sucessor of an index.
- * The trick is that for index 0 the left successor is 0 again, and the
- * right successor is 1 in this scheme. For the right successor 1 everything
- * works like usual. We simply took care in the algorithms that they still
- * work with the left child of 0 being 0 again. This was possible without
- * any extra ifs or arithmetic.
- * Thus we can save the wastage of 1 array position you can see in other
- * implementations or the ugly (i+1)*2 - 1 and (i+1)*2 for calculating the
- * left and right child. (At the expense that stuff easily breaks when you make
- * changes and don't think that the left child of 0 is 0 :-/)
+ * Implementation note: The heap is 4-ary instead of binary: the up to four
+ * children of a node sit next to each other in the array, so a sift-down
+ * compares against one cache line per level and the tree is only half as
+ * deep. Indexing is the standard 0-based scheme, the children of index i
+ * are 4*i+1 .. 4*i+4 and the parent of i is (i-1)/4.
  *
  * @author  Christian Wuerdig, Matthias Braun
  * @brief   Priority Queue implementation based on the heap data structure
@@ -26,6 +20,10 @@
 
 #include "array.h"
 #include "panic.h"
+#include "util.h"
+
+/** Number of children per heap node. */
+#define PQUEUE_ARITY 4
 
 typedef struct pqueue_el_t {
 	void *data;
@@ -42,16 +40,18 @@ struct pqueue_t {
  */
 static void pqueue_heapify(pqueue_t *q, size_t pos)
 {
-	size_t len = ARR_LEN(q->elems);
-	while (pos * 2 < len) {
-		size_t exchange = pos;
-		if (q->elems[exchange].priority < q->elems[pos * 2].priority)
-			exchange = pos * 2;
-
-		if ((pos * 2 + 1) < len
-		    && q->elems[exchange].priority < q->elems[pos * 2 + 1].priority)
-			exchange = pos * 2 + 1;
+	size_t const len = ARR_LEN(q->elems);
+	for (;;) {
+		size_t child = pos * PQUEUE_ARITY + 1;
+		if (child >= len)
+			break;
 
+		size_t       exchange = pos;
+		size_t const last     = MIN(child + PQUEUE_ARITY, len);
+		for (; child < last; ++child) {
+			if (q->elems[exchange].priority < q->elems[child].priority)
+				exchange = child;
+		}
 		if (exchange == pos)
 			break;
 
@@ -68,12 +68,16 @@ static void pqueue_heapify(pqueue_t *q, size_t pos)
  */
 static void pqueue_sift_up(pqueue_t *q, size_t pos)
 {
-	while (q->elems[pos].priority > q->elems[pos / 2].priority) {
-		pqueue_el_t tmp   = q->elems[pos];
-		q->elems[pos]     = q->elems[pos / 2];
-		q->elems[pos / 2] = tmp;
+	while (pos != 0) {
+		size_t const parent = (pos - 1) / PQUEUE_ARITY;
+		if (q->elems[parent].priority >= q->elems[pos].priority)
+			break;
+
+		pqueue_el_t tmp  = q->elems[pos];
+		q->elems[pos]    = q->elems[parent];
+		q->elems[parent] = tmp;
 
-		pos /= 2;
+		pos = parent;
 	}
 }
 
@@ -29,6 +29,10 @@
 #include "bitfiddle.h"
 #include "obst.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #define BITS_PER_ELEM                (sizeof(unsigned) * 8)
 #define BITSET_SIZE_ELEMS(size_bits) ((size_bits+BITS_PER_ELEM-1)/BITS_PER_ELEM)
 #define BITSET_SIZE_BYTES(size_bits) (BITSET_SIZE_ELEMS(size_bits) * sizeof(unsigned))
@@ -379,7 +383,16 @@ static inline size_t rbitset_prev(const unsigned *bitset, size_t pos,
  */
 static inline void rbitset_and(unsigned *dst, const unsigned *src, size_t size)
 {
-	for (size_t i = 0, n = BITSET_SIZE_ELEMS(size); i < n; ++i) {
+	size_t const n = BITSET_SIZE_ELEMS(size);
+	size_t       i = 0;
+#ifdef __SSE2__
+	for (; i + 4 <= n; i += 4) {
+		__m128i const d = _mm_loadu_si128((__m128i const*)&dst[i]);
+		__m128i const s = _mm_loadu_si128((__m128i const*)&src[i]);
+		_mm_storeu_si128((__m128i*)&dst[i], _mm_and_si128(d, s));
+	}
+#endif
+	for (; i < n; ++i) {
 		dst[i] &= src[i];
 	}
 }
@@ -393,11 +406,60 @@ static inline void rbitset_and(unsigned *dst, const unsigned *src, size_t size)
  */
 static inline void rbitset_or(unsigned *dst, const unsigned *src, size_t size)
 {
-	for (size_t i = 0, n = BITSET_SIZE_ELEMS(size); i < n; ++i) {
+	size_t const n = BITSET_SIZE_ELEMS(size);
+	size_t       i = 0;
+#ifdef __SSE2__
+	for (; i + 4 <= n; i += 4) {
+		__m128i const d = _mm_loadu_si128((__m128i const*)&dst[i]);
+		__m128i const s = _mm_loadu_si128((__m128i const*)&src[i]);
+		_mm_storeu_si128((__m128i*)&dst[i], _mm_or_si128(d, s));
+	}
+#endif
+	for (; i < n; ++i) {
 		dst[i] |= src[i];
 	}
 }
 
+/**
+ * Inplace Union of two sets which additionally reports whether the
+ * destination grew.  Dataflow fixpoint loops use this to fold the
+ * union, the comparison against the previous iteration and the copy
+ * into a single pass over the sets.
+ *
+ * @param dst   the destination bitset and first operand
+ * @param src   the second bitset
+ * @param size  size of both bitsets in bits
+ * @return true if the union added at least one new bit to dst
+ */
+static inline bool rbitset_or_changed(unsigned *dst, const unsigned *src,
+                                      size_t size)
+{
+	size_t const n    = BITSET_SIZE_ELEMS(size);
+	size_t       i    = 0;
+	unsigned     diff = 0;
+#ifdef __SSE2__
+	if (n >= 4) {
+		__m128i vdiff = _mm_setzero_si128();
+		for (; i + 4 <= n; i += 4) {
+			__m128i const d = _mm_loadu_si128((__m128i const*)&dst[i]);
+			__m128i const s = _mm_loadu_si128((__m128i const*)&src[i]);
+			/* every bit of src not yet present in dst is a change */
+			vdiff = _mm_or_si128(vdiff, _mm_andnot_si128(d, s));
+			_mm_storeu_si128((__m128i*)&dst[i], _mm_or_si128(d, s));
+		}
+		vdiff = _mm_or_si128(vdiff, _mm_srli_si128(vdiff, 8));
+		vdiff = _mm_or_si128(vdiff, _mm_srli_si128(vdiff, 4));
+		diff  = (unsigned)_mm_cvtsi128_si32(vdiff);
+	}
+#endif
+	for (; i < n; ++i) {
+		unsigned const old = dst[i];
+		diff   |= src[i] & ~old;
+		dst[i]  = old | src[i];
+	}
+	return diff != 0;
+}
+
 /**
  * Remove all bits in src from dst.
  *
@@ -408,7 +470,16 @@ static inline void rbitset_or(unsigned *dst, const unsigned *src, size_t size)
 static inline void rbitset_andnot(unsigned *dst, const unsigned *src,
                                   size_t size)
 {
-	for (size_t i = 0, n = BITSET_SIZE_ELEMS(size); i < n; ++i) {
+	size_t const n = BITSET_SIZE_ELEMS(size);
+	size_t       i = 0;
+#ifdef __SSE2__
+	for (; i + 4 <= n; i += 4) {
+		__m128i const d = _mm_loadu_si128((__m128i const*)&dst[i]);
+		__m128i const s = _mm_loadu_si128((__m128i const*)&src[i]);
+		_mm_storeu_si128((__m128i*)&dst[i], _mm_andnot_si128(s, d));
+	}
+#endif
+	for (; i < n; ++i) {
 		dst[i] &= ~src[i];
 	}
 }
@@ -422,7 +493,16 @@ static inline void rbitset_andnot(unsigned *dst, const unsigned *src,
  */
 static inline void rbitset_xor(unsigned *dst, const unsigned *src, size_t size)
 {
-	for (size_t i = 0, n = BITSET_SIZE_ELEMS(size); i < n; ++i) {
+	size_t const n = BITSET_SIZE_ELEMS(size);
+	size_t       i = 0;
+#ifdef __SSE2__
+	for (; i + 4 <= n; i += 4) {
+		__m128i const d = _mm_loadu_si128((__m128i const*)&dst[i]);
+		__m128i const s = _mm_loadu_si128((__m128i const*)&src[i]);
+		_mm_storeu_si128((__m128i*)&dst[i], _mm_xor_si128(d, s));
+	}
+#endif
+	for (; i < n; ++i) {
 		dst[i] ^= src[i];
 	}
 }
@@ -563,6 +643,43 @@ static inline void rbitset_copy(unsigned *dst, const unsigned *src,
 	memcpy(dst, src, BITSET_SIZE_BYTES(size));
 }
 
+/**
+ * Copy a raw bitset into another and report whether the destination
+ * changed.  This fuses the compare-then-copy sequence of dataflow
+ * fixpoint loops into a single pass over the sets.
+ *
+ * @param dst   the destination set
+ * @param src   the source set
+ * @param size  size of both bitsets in bits
+ * @return true if dst differed from src before the copy
+ */
+static inline bool rbitset_copy_changed(unsigned *dst, const unsigned *src,
+                                        size_t size)
+{
+	size_t const n    = BITSET_SIZE_ELEMS(size);
+	size_t       i    = 0;
+	unsigned     diff = 0;
+#ifdef __SSE2__
+	if (n >= 4) {
+		__m128i vdiff = _mm_setzero_si128();
+		for (; i + 4 <= n; i += 4) {
+			__m128i const d = _mm_loadu_si128((__m128i const*)&dst[i]);
+			__m128i const s = _mm_loadu_si128((__m128i const*)&src[i]);
+			vdiff = _mm_or_si128(vdiff, _mm_xor_si128(d, s));
+			_mm_storeu_si128((__m128i*)&dst[i], s);
+		}
+		vdiff = _mm_or_si128(vdiff, _mm_srli_si128(vdiff, 8));
+		vdiff = _mm_or_si128(vdiff, _mm_srli_si128(vdiff, 4));
+		diff  = (unsigned)_mm_cvtsi128_si32(vdiff);
+	}
+#endif
+	for (; i < n; ++i) {
+		diff  |= dst[i] ^ src[i];
+		dst[i] = src[i];
+	}
+	return diff != 0;
+}
+
 /**
  * Convenience macro for raw bitset iteration.
  * @param bitset The bitset.
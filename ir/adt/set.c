@@ -9,36 +9,25 @@
  * @author      Markus Armbruster
  */
 
-/*  This code is derived from:
-
-    From: ejp@ausmelb.oz.AU (Esmond Pitt)
-    Date: Tue, 7 Mar 1989 22:06:26 GMT
-    Subject: v06i042: dynamic hashing version of hsearch(3)
-    Message-ID: <1821@basser.oz>
-    Newsgroups: comp.sources.misc
-    Sender: msgs@basser.oz
-
-    Posting-number: Volume 6, Issue 42
-    Submitted-By: Esmond Pitt <ejp@ausmelb.oz.AU>
-    Archive-name: dynamic-hash
-
-    * Dynamic hashing, after CACM April 1988 pp 446-457, by Per-Ake Larson.
-    * Coded into C, with minor code improvements, and with hsearch(3) interface,
-    * by ejp@ausmelb.oz, Jul 26, 1988: 13:16;
- */
+/* The deprecated set/pset interfaces are nowadays thin layers over the
+ * open addressed hashset.c.h template, so their many remaining users get
+ * cache friendly probing without a rewrite.  The historic implementation
+ * (dynamic hashing after Per-Ake Larson, CACM April 1988, as posted to
+ * comp.sources.misc by Esmond Pitt) chased one pointer per chain link on
+ * every lookup.
+ *
+ * Both variants are generated from this file: pset.c defines PSET and
+ * includes it. */
 #ifdef PSET
 # define SET pset
 # define PMANGLE(pre) pre##_pset
 # define MANGLEP(post) pset_##post
 # define MANGLE(pre, post) pre##pset##post
-# define EQUAL(cmp, elt, key, siz) (!(cmp) ((elt)->entry.dptr, (key)))
 #else
 # define SET set
 # define PMANGLE(pre) pre##_set
 # define MANGLEP(post) set_##post
 # define MANGLE(pre, post) pre##set##post
-# define EQUAL(cmp, elt, key, siz) \
-    (((elt)->entry.size == (siz)) && !(cmp) ((elt)->entry.dptr, (key), (siz)))
 #endif
 
 #ifdef PSET
@@ -48,209 +37,165 @@
 #endif
 
 #include <assert.h>
+#include <stdbool.h>
 #include <stdlib.h>
-#include <stdio.h>
+#include <string.h>
 
-#include "xmalloc.h"
-#include "lc_printf.h"
 #include "obst.h"
+#include "xmalloc.h"
 
-#define SEGMENT_SIZE_SHIFT   8
-#define SEGMENT_SIZE         (1 << SEGMENT_SIZE_SHIFT)
-#define DIRECTORY_SIZE_SHIFT 8
-#define DIRECTORY_SIZE       (1 << DIRECTORY_SIZE_SHIFT)
-#define MAX_LOAD_FACTOR      4
-
-typedef struct element {
-	struct element *chain;    /**< for chaining Elements */
-	MANGLEP(entry)  entry;
-} element_t, *segment_t;
+/* A table bucket holds the element (pset: the pointer itself, set: a
+ * pointer to the obstack allocated copy) plus a cached copy of its full
+ * hash, so probing never touches the element data of foreign buckets. */
+#ifdef PSET
+typedef pset_entry HashSetEntry;
+#else
+typedef struct HashSetEntry {
+	set_entry *dptr;  /**< the obstack allocated element, NULL/-1 when the
+	                       bucket is empty/deleted */
+	unsigned   hash;  /**< cached hash value of the element */
+} HashSetEntry;
+#endif
 
 struct SET {
-	size_t p;             /**< Next bucket to be split */
-	size_t maxp;          /**< upper bound on p during expansion */
-	size_t nkey;          /**< current # keys */
-	size_t nseg;          /**< current # segments */
-	segment_t *dir[DIRECTORY_SIZE];
-	MANGLEP(cmp_fun) cmp;     /**< function comparing entries */
-	unsigned   iter_i;
-	unsigned   iter_j;
-	element_t *iter_tail;       /**< non-NULL while iterating over elts */
-#ifdef PSET
-	element_t *free_list;       /**< list of free Elements */
+	HashSetEntry *entries;
+	size_t num_buckets;
+	size_t enlarge_threshold;
+	size_t shrink_threshold;
+	size_t num_elements;
+	size_t num_deleted;
+	int consider_shrink;
+#ifndef NDEBUG
+	unsigned entries_version;
 #endif
-	struct obstack obst;      /**< obstack for allocation all data */
+	MANGLEP(cmp_fun) cmp;   /**< function comparing entries */
+	unsigned lookup_hash;   /**< caller supplied hash of the current
+	                             search/insert/remove key */
+#ifndef PSET
+	size_t lookup_size;     /**< caller supplied size of the current key */
+	bool   zero_terminate;  /**< append a '\0' when copying the element */
+	struct obstack obst;    /**< obstack holding all element copies */
+#endif
+	size_t iter_pos;        /**< next bucket of the running iteration */
+	bool   iterating;       /**< a MANGLEP(first)()ed iteration is running */
 };
 
+#ifndef PSET
+/**
+ * Copies an element behind a fresh entry header onto the set's obstack.
+ * The obstack keeps element addresses stable over the lifetime of the
+ * set, no matter how often the hash table itself is resized.
+ * @internal
+ */
+static set_entry *alloc_element(set *table, void const *key)
+{
+	obstack_blank(&table->obst, offsetof(set_entry, dptr));
+	if (table->zero_terminate)
+		obstack_grow0(&table->obst, key, table->lookup_size);
+	else
+		obstack_grow(&table->obst, key, table->lookup_size);
+	set_entry *entry = (set_entry*)obstack_finish(&table->obst);
+	entry->hash = table->lookup_hash;
+	entry->size = table->lookup_size;
+	return entry;
+}
+#endif
+
+#define HashSet                   SET
+#ifdef PSET
+#define ValueType                 void*
+#define InitData(self,value,key)  (value) = (void*)(key)
+#define KeysEqual(self,elt,key)   ((self)->cmp((elt), (key)) == 0)
+/** the element pointer the public interface hands out */
+#define ELEMENT(value)            (value)
+#else
+#define ValueType                 set_entry*
+#define InitData(self,value,key)  (value) = alloc_element(self, key)
+#define KeysEqual(self,elt,key) \
+	((elt)->size == (self)->lookup_size \
+	 && (self)->cmp((elt)->dptr, (key), (self)->lookup_size) == 0)
+#define ELEMENT(value)            ((void*)(value)->dptr)
+#endif
+#define KeyType                   void const*
+#define ConstKeyType              void const*
+#define GetKey(value)             (value)
+/* the hash is supplied by the caller, the public entry points stash it */
+#define Hash(self,key)            ((void)(key), (self)->lookup_hash)
+#define NullValue                 null_element
+#define EntryGetValue(entry)      (entry).dptr
+#define EntrySetEmpty(entry)      (entry).dptr = NULL
+#define EntrySetDeleted(entry)    (entry).dptr = (ValueType)-1
+#define EntryIsEmpty(entry)       ((entry).dptr == NULL)
+#define EntryIsDeleted(entry)     ((entry).dptr == (ValueType)-1)
+#define SetRangeEmpty(ptr,size)   memset(ptr, 0, (size) * sizeof((ptr)[0]))
+
+static ValueType null_element;
+
+ValueType *MANGLEP(find_)(const SET *self, void const *key);
+#define hashset_find            MANGLEP(find_)
+#define hashset_size            MANGLEP(count)
+
+#include "hashset.c.h"
 
 SET *(PMANGLE(new))(MANGLEP(cmp_fun) cmp, size_t nslots)
 {
-	if (nslots > SEGMENT_SIZE * DIRECTORY_SIZE) {
-		nslots = DIRECTORY_SIZE;
-	} else {
-		/* Adjust nslots up to next power of 2, minimum SEGMENT_SIZE */
-		size_t i = SEGMENT_SIZE;
-		while (i < nslots)
-			i <<= 1;
-		nslots = i >> SEGMENT_SIZE_SHIFT;
-	}
-
 	SET *table = XMALLOC(SET);
-	table->nseg      = table->p = table->nkey = 0;
-	table->maxp      = nslots << SEGMENT_SIZE_SHIFT;
+	if (nslots < HT_MIN_BUCKETS)
+		nslots = HT_MIN_BUCKETS;
+	init_size(table, ceil_po2(nslots));
 	table->cmp       = cmp;
-	table->iter_tail = NULL;
-#ifdef PSET
-	table->free_list = NULL;
-#endif
+	table->iterating = false;
+#ifndef PSET
 	obstack_init(&table->obst);
-
-	/* Make segments */
-	for (size_t i = 0; i < nslots;  ++i) {
-		table->dir[i] = OALLOCNZ(&table->obst, segment_t, SEGMENT_SIZE);
-		table->nseg++;
-	}
-
+#endif
 	return table;
 }
 
 void PMANGLE(del)(SET *table)
 {
+#ifndef PSET
 	obstack_free(&table->obst, NULL);
+#endif
+	Free(table->entries);
 	free(table);
 }
 
-size_t MANGLEP(count)(SET const *table)
-{
-	return table->nkey;
-}
-
 /**
- * do one iteration step, return 1
- * if still data in the set, 0 else
+ * Advances the running iteration to the next occupied bucket, finishing
+ * the iteration when the table is exhausted.
+ * @internal
  */
-static inline bool iter_step(SET *table)
+static void *iter_next(SET *table)
 {
-	if (++table->iter_j >= SEGMENT_SIZE) {
-		table->iter_j = 0;
-		if (++table->iter_i >= table->nseg) {
-			table->iter_i = 0;
-			return false;
-		}
+	for (size_t i = table->iter_pos; i < table->num_buckets; ++i) {
+		HashSetEntry *entry = &table->entries[i];
+		if (EntryIsEmpty(*entry) || EntryIsDeleted(*entry))
+			continue;
+		table->iter_pos = i + 1;
+		return ELEMENT(EntryGetValue(*entry));
 	}
-	return true;
+	table->iterating = false;
+	return NULL;
 }
 
 void *(MANGLEP(first))(SET *table)
 {
-	assert(!table->iter_tail);
-	table->iter_i = 0;
-	table->iter_j = 0;
-	while (!table->dir[table->iter_i][table->iter_j]) {
-		if (!iter_step(table))
-			return NULL;
-	}
-	table->iter_tail = table->dir[table->iter_i][table->iter_j];
-	assert(table->iter_tail->entry.dptr);
-	return table->iter_tail->entry.dptr;
+	assert(!table->iterating);
+	table->iterating = true;
+	table->iter_pos  = 0;
+	return iter_next(table);
 }
 
 void *(MANGLEP(next))(SET *table)
 {
-	if (!table->iter_tail)
+	if (!table->iterating)
 		return NULL;
-
-	/* follow collision chain */
-	table->iter_tail = table->iter_tail->chain;
-	if (!table->iter_tail) {
-		/* go to next segment */
-		do {
-			if (!iter_step(table))
-				return NULL;
-		} while (!table->dir[table->iter_i][table->iter_j]);
-		table->iter_tail = table->dir[table->iter_i][table->iter_j];
-	}
-	assert(table->iter_tail->entry.dptr);
-	return table->iter_tail->entry.dptr;
+	return iter_next(table);
 }
 
 void MANGLEP(break)(SET *table)
 {
-	table->iter_tail = NULL;
-}
-
-/** Limit the hash value */
-static inline unsigned limit_hash(SET const *table, unsigned const h)
-{
-	unsigned address = h & (table->maxp - 1);       /* h % table->maxp */
-	if (address < (unsigned)table->p)
-		address = h & ((table->maxp << 1) - 1); /* h % (2*table->maxp) */
-	return address;
-}
-
-/**
- * Returns non-zero if the number of elements in
- * the set is greater then number of segments * MAX_LOAD_FACTOR
- */
-static inline bool loaded(SET *table)
-{
-	return ++table->nkey > (table->nseg << SEGMENT_SIZE_SHIFT) * MAX_LOAD_FACTOR;
-}
-
-/**
- * Expand the hash-table: the algorithm is split, so on every
- * insert, only ONE segment is rehashed!
- *
- * table->p contains the current segment to split
- * after all segments were split, table->p is set to zero and
- * table->maxp is duplicated.
- */
-static void expand_table(SET *table)
-{
-	if (table->maxp + table->p >= (DIRECTORY_SIZE << SEGMENT_SIZE_SHIFT))
-		return;
-
-	/* Locate the bucket to be split */
-	size_t     OldSegmentDir   = table->p >> SEGMENT_SIZE_SHIFT;
-	segment_t *OldSegment      = table->dir[OldSegmentDir];
-	size_t     OldSegmentIndex = table->p & (SEGMENT_SIZE - 1);
-
-	/* Expand address space; if necessary create a new segment */
-	size_t NewAddress      = table->maxp + table->p;
-	size_t NewSegmentDir   = NewAddress >> SEGMENT_SIZE_SHIFT;
-	size_t NewSegmentIndex = NewAddress & (SEGMENT_SIZE - 1);
-	if (NewSegmentIndex == 0) {
-		table->dir[NewSegmentDir] = OALLOCNZ(&table->obst, segment_t, SEGMENT_SIZE);
-		table->nseg++;
-	}
-	segment_t *NewSegment = table->dir[NewSegmentDir];
-
-	/* Adjust state variables */
-	table->p++;
-	if (table->p == table->maxp) {
-		table->maxp <<= 1;  /* table->maxp *= 2 */
-		table->p      = 0;
-	}
-
-	/* Relocate records to the new bucket */
-	element_t **Previous  = &OldSegment[OldSegmentIndex];
-	element_t  *Current   = *Previous;
-	element_t **LastOfNew = &NewSegment[NewSegmentIndex];
-	*LastOfNew = NULL;
-	while (Current != NULL) {
-		if (limit_hash(table, Current->entry.hash) == NewAddress) {
-			/* Move to new chain */
-			*LastOfNew = Current;
-			*Previous  = Current->chain;
-			LastOfNew  = &Current->chain;
-			Current    = Current->chain;
-			*LastOfNew = NULL;
-		} else {
-			/* Leave on old chain */
-			Previous = &Current->chain;
-			Current  = Current->chain;
-		}
-	}
+	table->iterating = false;
 }
 
 void *MANGLE(_,_search)(SET *table, void const *key,
@@ -262,59 +207,38 @@ void *MANGLE(_,_search)(SET *table, void const *key,
 	assert(table);
 	assert(key);
 
-	/* Find collision chain */
-	unsigned    h               = limit_hash(table, hash);
-	unsigned    segment_index   = h & (SEGMENT_SIZE-1);
-	segment_t  *current_segment = table->dir[h >> SEGMENT_SIZE_SHIFT];
-	assert(current_segment != NULL);
-	segment_t   q               = current_segment[segment_index];
-
-	/* Follow collision chain */
-	MANGLEP(cmp_fun) cmp = table->cmp;
-	while (q && !EQUAL(cmp, q, key, size)) {
-		q = q->chain;
-	}
+	table->lookup_hash    = hash;
+#ifndef PSET
+	table->lookup_size    = size;
+	table->zero_terminate = action == _set_hinsert0;
+#endif
 
-	if (!q && (action != MANGLE(_,_find))) { /* not found, insert */
-		assert(!table->iter_tail && "insert an element into a set that is iterated");
+	if (action == MANGLE(_,_find)) {
+		ValueType *slot = MANGLEP(find_)(table, key);
+		return slot != &null_element ? ELEMENT(*slot) : NULL;
+	}
 
-#ifdef PSET
-		if (table->free_list) {
-			q                = table->free_list;
-			table->free_list = q->chain;
-		} else {
-			q = OALLOC(&table->obst, element_t);
-		}
-		q->entry.dptr = (void *)key;
-#else
-		obstack_blank(&table->obst, offsetof(element_t, entry.dptr));
-		if (action == _set_hinsert0)
-			obstack_grow0(&table->obst, key, size);
-		else
-			obstack_grow(&table->obst, key, size);
-		q = (segment_t)obstack_finish(&table->obst);
-		q->entry.size = size;
-#endif
-		q->chain                       = current_segment[segment_index];
-		q->entry.hash                  = hash;
-		current_segment[segment_index] = q;
-
-		if (loaded(table)) {
-			/* does not affect q */
-			expand_table(table);
-		}
+	/* growing (or cleaning out tombstones) would move entries under a
+	 * running iteration; only inserts of present elements are legal then */
+	if (!table->iterating) {
+		maybe_shrink(table);
+		maybe_grow(table);
 	}
+#ifndef NDEBUG
+	size_t const count_before = MANGLEP(count)(table);
+#endif
+	ValueType *slot = insert_nogrow(table, key);
+	assert((MANGLEP(count)(table) == count_before || !table->iterating)
+	       && "insert an element into a set that is iterated");
 
-	if (!q)
-		return NULL;
 #ifdef PSET
 	if (action == _pset_hinsert)
-		return &q->entry;
+		return (pset_entry*)((char*)slot - offsetof(pset_entry, dptr));
 #else
 	if (action == _set_hinsert || action == _set_hinsert0)
-		return &q->entry;
+		return *slot;
 #endif
-	return q->entry.dptr;
+	return ELEMENT(*slot);
 }
 
 #ifdef PSET
@@ -326,42 +250,22 @@ int pset_default_ptr_cmp(void const *x, void const *y)
 
 void *pset_remove(SET *table, void const *key, unsigned hash)
 {
-	assert(table && !table->iter_tail);
-
-	/* Find collision chain */
-	unsigned    h               = limit_hash(table, hash);
-	unsigned    segment_index   = h & (SEGMENT_SIZE - 1);
-	segment_t  *current_segment = table->dir[h >> SEGMENT_SIZE_SHIFT];
-	assert(current_segment != NULL);
-	segment_t  *p               = &current_segment[segment_index];
-
-	/* Follow collision chain */
-	pset_cmp_fun cmp = table->cmp;
-	while (!EQUAL(cmp, *p, key, size)) {
-		p = &(*p)->chain;
-		assert(*p);
-	}
+	assert(table && !table->iterating);
 
-	segment_t q = *p;
-	if (q == table->iter_tail) {
-		/* removing current element */
-		table->iter_tail = q->chain;
-		if (!table->iter_tail) {
-			/* go to next segment */
-			do {
-				if (!iter_step(table))
-					break;
-			} while (!table->dir[table->iter_i][table->iter_j]);
-			table->iter_tail = table->dir[table->iter_i][table->iter_j];
-		}
-	}
+	table->lookup_hash = hash;
+	void **slot = pset_find_(table, key);
+	if (slot == &null_element)
+		return NULL;
 
-	*p               = (*p)->chain;
-	q->chain         = table->free_list;
-	table->free_list = q;
-	--table->nkey;
+	void       *value = *slot;
+	pset_entry *entry = (pset_entry*)((char*)slot - offsetof(pset_entry, dptr));
+	EntrySetDeleted(*entry);
+	ctrl_of(table->entries, table->num_buckets)[entry - table->entries]
+		= CTRL_DELETED;
+	table->num_deleted++;
+	table->consider_shrink = 1;
 
-	return q->entry.dptr;
+	return value;
 }
 
 void *(pset_find)(SET *se, void const *key, unsigned hash)
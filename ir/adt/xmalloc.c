@@ -11,10 +11,113 @@
 #include "xmalloc.h"
 
 #include "funcattr.h"
+#include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+int xmalloc_account_enabled = 0;
+
+/** Maximum number of distinct accounting tags. */
+#define MAX_ACCOUNT_TAGS  256
+/** Maximum nesting depth of accounting scopes. */
+#define MAX_ACCOUNT_DEPTH 32
+
+typedef struct account_tag_t {
+	const char        *name;
+	unsigned long long bytes;
+	unsigned long long calls;
+	unsigned long long peak;
+} account_tag_t;
+
+typedef struct account_scope_t {
+	unsigned           tag;
+	/** bytes requested during this activation, including nested scopes */
+	unsigned long long act_bytes;
+} account_scope_t;
+
+static account_tag_t   account_tags[MAX_ACCOUNT_TAGS];
+static unsigned        n_account_tags;
+static account_scope_t account_stack[MAX_ACCOUNT_DEPTH];
+static unsigned        account_sp;
+
+/** Attribute an allocation of @p size bytes to the innermost scope. */
+static void account_alloc(size_t size)
+{
+	account_tag_t *const tag = &account_tags[account_stack[account_sp].tag];
+	tag->bytes += size;
+	++tag->calls;
+	account_stack[account_sp].act_bytes += size;
+}
+
+void xmalloc_account_begin(void)
+{
+	memset(account_tags, 0, sizeof(account_tags));
+	account_tags[0].name = "<toplevel>";
+	account_tags[1].name = "<overflow>";
+	n_account_tags   = 2;
+	account_sp       = 0;
+	account_stack[0].tag       = 0;
+	account_stack[0].act_bytes = 0;
+	xmalloc_account_enabled = 1;
+}
+
+void xmalloc_account_end(void)
+{
+	xmalloc_account_enabled = 0;
+}
+
+void xmalloc_account_push(const char *name)
+{
+	if (!xmalloc_account_enabled)
+		return;
+	assert(account_sp + 1 < MAX_ACCOUNT_DEPTH);
+
+	/* tags are few and pushes are rare (per pass/graph), so a linear
+	 * search beats maintaining a hash table here */
+	unsigned tag = 1;
+	for (unsigned i = 0; i < n_account_tags; ++i) {
+		if (account_tags[i].name != NULL
+		 && strcmp(account_tags[i].name, name) == 0) {
+			tag = i;
+			goto found;
+		}
+	}
+	if (n_account_tags < MAX_ACCOUNT_TAGS) {
+		tag = n_account_tags++;
+		account_tags[tag].name = name;
+	}
+found:;
+	account_scope_t *const scope = &account_stack[++account_sp];
+	scope->tag       = tag;
+	scope->act_bytes = 0;
+}
+
+void xmalloc_account_pop(void)
+{
+	if (!xmalloc_account_enabled)
+		return;
+	assert(account_sp > 0);
+
+	account_scope_t *const scope = &account_stack[account_sp--];
+	account_tag_t   *const tag   = &account_tags[scope->tag];
+	if (scope->act_bytes > tag->peak)
+		tag->peak = scope->act_bytes;
+	/* the parent was shadowed meanwhile, so its activation inherits the
+	 * nested volume for peak tracking */
+	account_stack[account_sp].act_bytes += scope->act_bytes;
+}
+
+void xmalloc_account_report(xmalloc_account_report_func func, void *env)
+{
+	for (unsigned i = 0; i < n_account_tags; ++i) {
+		account_tag_t const *const tag = &account_tags[i];
+		if (tag->calls == 0)
+			continue;
+		func(tag->name, tag->bytes, tag->calls, tag->peak, env);
+	}
+}
+
 static FIRM_NORETURN xnomem(void)
 {
 	/* Do not use panic() here, because it might try to allocate memory! */
@@ -24,6 +127,8 @@ static FIRM_NORETURN xnomem(void)
 
 void *xmalloc(size_t size)
 {
+	if (xmalloc_account_enabled)
+		account_alloc(size);
 	void *res = malloc(size);
 
 	if (!res) xnomem();
@@ -32,6 +137,9 @@ void *xmalloc(size_t size)
 
 void *xrealloc(void *ptr, size_t size)
 {
+	/* the old size is unknown here, so the full new size is attributed */
+	if (xmalloc_account_enabled)
+		account_alloc(size);
 	/* ANSI blesses realloc (0, x) but SunOS chokes on it */
 	void *res = ptr ? realloc (ptr, size) : malloc (size);
 
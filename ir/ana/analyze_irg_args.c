@@ -8,11 +8,13 @@
  * @brief      read/write analyze of graph argument, which have mode reference.
  * @author     Beyhan Veliev
  */
-#include "analyze_irg_args.h"
+#include "analyze_irg_args_t.h"
 
 #include "array.h"
 #include "cgana.h"
 #include "entity_t.h"
+#include "irgraph_t.h"
+#include "irhooks.h"
 #include "irmode_t.h"
 #include "irnode_t.h"
 #include "irouts_t.h"
@@ -20,6 +22,41 @@
 #include "util.h"
 #include <stdlib.h>
 
+/**
+ * hook_replace callback: a node of the graph is rewritten, so the cached
+ * parameter summaries of its entity may be stale.  Drop them; they are
+ * recomputed from the current graph on the next query.
+ */
+static void drop_arg_summaries(void *context, ir_node *old_node,
+                               ir_node *new_node)
+{
+	(void)context;
+	(void)new_node;
+	ir_graph  *irg = get_irn_irg(old_node);
+	ir_entity *ent = get_irg_entity(irg);
+	if (ent == NULL)
+		return;
+
+	if (ent->attr.mtd_attr.param_access != NULL) {
+		DEL_ARR_F(ent->attr.mtd_attr.param_access);
+		ent->attr.mtd_attr.param_access = NULL;
+	}
+	if (ent->attr.mtd_attr.param_weight != NULL) {
+		DEL_ARR_F(ent->attr.mtd_attr.param_weight);
+		ent->attr.mtd_attr.param_weight = NULL;
+	}
+}
+
+static hook_entry_t arg_summary_hook;
+
+void firm_register_arg_summary_invalidation(void)
+{
+	if (arg_summary_hook.hook._hook_replace != NULL)
+		return;
+	arg_summary_hook.hook._hook_replace = drop_arg_summaries;
+	register_hook(hook_replace, &arg_summary_hook);
+}
+
 /**
  * Walk recursive the successors of a graph argument
  * with mode reference and mark if it will be read,
@@ -154,6 +191,7 @@ static void analyze_ent_args(ir_entity *ent)
 	ir_type *mtp     = get_entity_type(ent);
 	size_t   nparams = get_method_n_params(mtp);
 
+	firm_register_arg_summary_invalidation();
 	ent->attr.mtd_attr.param_access = NEW_ARR_F(ptr_access_kind, nparams);
 
 	/* If the method haven't parameters we have
@@ -175,6 +213,8 @@ static void analyze_ent_args(ir_entity *ent)
 	}
 
 	assure_irg_outs(irg);
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_VISITED);
+	inc_irg_visited(irg);
 	ir_node *irg_args = get_irg_args(irg);
 
 	/* A array to save the information for each argument with
@@ -197,6 +237,8 @@ static void analyze_ent_args(ir_entity *ent)
 
 	/* copy the temporary info */
 	MEMCPY(ent->attr.mtd_attr.param_access, rw_info, nparams);
+
+	ir_free_resources(irg, IR_RESOURCE_IRN_VISITED);
 }
 
 void analyze_irg_args(ir_graph *irg)
@@ -350,6 +392,7 @@ static void analyze_method_params_weight(ir_entity *ent)
 	/* allocate a new array. currently used as 'analysed' flag */
 	ir_type *mtp      = get_entity_type(ent);
 	size_t   nparams  = get_method_n_params(mtp);
+	firm_register_arg_summary_invalidation();
 	ent->attr.mtd_attr.param_weight = NEW_ARR_F(unsigned, nparams);
 
 	/* If the method has no parameters, we have nothing to do */
@@ -368,12 +411,16 @@ static void analyze_method_params_weight(ir_entity *ent)
 
 	/* Call algorithm that computes the out edges */
 	assure_irg_outs(irg);
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_VISITED);
+	inc_irg_visited(irg);
 
 	ir_node *irg_args = get_irg_args(irg);
 	foreach_irn_out_r(irg_args, i, arg) {
 		unsigned const proj_nr = get_Proj_num(arg);
 		ent->attr.mtd_attr.param_weight[proj_nr] += calc_method_param_weight(arg);
 	}
+
+	ir_free_resources(irg, IR_RESOURCE_IRN_VISITED);
 }
 
 unsigned get_method_param_weight(ir_entity *ent, size_t pos)
@@ -397,8 +444,5 @@ void analyze_irg_args_weight(ir_graph *irg)
 	if (entity->attr.mtd_attr.param_weight != NULL)
 		return;
 
-	ir_reserve_resources(irg, IR_RESOURCE_IRN_VISITED);
-	inc_irg_visited(irg);
 	analyze_method_params_weight(entity);
-	ir_free_resources(irg, IR_RESOURCE_IRN_VISITED);
 }
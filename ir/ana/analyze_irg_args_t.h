@@ -0,0 +1,24 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief     read/write analyze of graph argument -- private header.
+ * @author    Beyhan Veliev
+ */
+#ifndef FIRM_ANA_ANALYZE_IRG_ARGS_T_H
+#define FIRM_ANA_ANALYZE_IRG_ARGS_T_H
+
+#include "analyze_irg_args.h"
+
+/**
+ * Makes sure the hook_replace hook that drops cached parameter summaries
+ * of modified graphs is registered.  Called whenever a summary is stored
+ * on an entity (by the analysis itself and by the ir file reader), so
+ * programs that never use the summaries do not pay for the hook.
+ */
+void firm_register_arg_summary_invalidation(void);
+
+#endif
@@ -269,6 +269,106 @@ void free_callgraph(void)
 	set_irp_callgraph_state(irp_callgraph_none);
 }
 
+/** Searches the edge from caller to callee, NULL if there is none. */
+static cg_callee_entry *find_callee_entry(ir_graph *caller, ir_graph *callee)
+{
+	for (size_t i = 0, n = ARR_LEN(caller->callees); i < n; ++i) {
+		if (caller->callees[i]->irg == callee)
+			return caller->callees[i];
+	}
+	return NULL;
+}
+
+static bool has_caller(ir_graph *callee, ir_graph *caller)
+{
+	for (size_t i = 0, n = ARR_LEN(callee->callers); i < n; ++i) {
+		if (callee->callers[i] == caller)
+			return true;
+	}
+	return false;
+}
+
+/** Extends a backedge bitset by one (clear) bit for a newly appended edge. */
+static unsigned *grow_isbe(unsigned *isbe, size_t old_n)
+{
+	unsigned *res = rbitset_malloc(old_n + 1);
+	rbitset_copy(res, isbe, old_n);
+	free(isbe);
+	return res;
+}
+
+void callgraph_note_new_irg(ir_graph *irg)
+{
+	if (get_irp_callgraph_state() == irp_callgraph_none)
+		return;
+	assert(irg->callees == NULL && irg->callers == NULL);
+	irg->callees = NEW_ARR_F(cg_callee_entry*, 0);
+	irg->callers = NEW_ARR_F(ir_graph*, 0);
+}
+
+void callgraph_note_new_call(ir_graph *caller, ir_node *call,
+                             ir_graph *callee)
+{
+	if (get_irp_callgraph_state() == irp_callgraph_none
+	    || caller->callees == NULL)
+		return;
+
+	cg_callee_entry *entry = find_callee_entry(caller, callee);
+	if (entry == NULL) {
+		entry = OALLOC(get_irg_obstack(caller), cg_callee_entry);
+		entry->irg       = callee;
+		entry->call_list = NEW_ARR_F(ir_node*, 0);
+		entry->max_depth = 0;
+
+		size_t const n = ARR_LEN(caller->callees);
+		ARR_APP1(cg_callee_entry*, caller->callees, entry);
+		if (caller->callee_isbe != NULL) {
+			caller->callee_isbe = grow_isbe(caller->callee_isbe, n);
+			/* a direct self call is the only cycle a transferred call can
+			 * introduce locally; all other backedges already existed */
+			if (caller == callee)
+				rbitset_set(caller->callee_isbe, n);
+		}
+
+		if (callee->callers != NULL && !has_caller(callee, caller)) {
+			size_t const m = ARR_LEN(callee->callers);
+			ARR_APP1(ir_graph*, callee->callers, caller);
+			if (callee->caller_isbe != NULL) {
+				callee->caller_isbe = grow_isbe(callee->caller_isbe, m);
+				if (caller == callee)
+					rbitset_set(callee->caller_isbe, m);
+			}
+		}
+	}
+
+	ARR_APP1(ir_node*, entry->call_list, call);
+	ir_loop *const loop = get_irn_loop(get_nodes_block(call));
+	if (loop != NULL)
+		entry->max_depth = MAX(entry->max_depth, get_loop_depth(loop));
+}
+
+void callgraph_note_removed_call(ir_graph *caller, ir_node *call,
+                                 ir_graph *callee)
+{
+	if (get_irp_callgraph_state() == irp_callgraph_none
+	    || caller->callees == NULL)
+		return;
+
+	cg_callee_entry *const entry = find_callee_entry(caller, callee);
+	if (entry == NULL)
+		return;
+	for (size_t i = 0, n = ARR_LEN(entry->call_list); i < n; ++i) {
+		if (entry->call_list[i] == call) {
+			entry->call_list[i] = entry->call_list[n - 1];
+			ARR_SHRINKLEN(entry->call_list, n - 1);
+			break;
+		}
+	}
+	/* The edge itself is kept even if its last call site disappeared:
+	 * removing it would shift the positions the backedge bitsets are
+	 * indexed with.  The callgraph stays an over-approximation. */
+}
+
 /**
  * Returns non-zero if a graph was already visited.
  */
@@ -19,6 +19,7 @@
 #include "cgana.h"
 
 #include "array.h"
+#include "bitset.h"
 #include "dbginfo_t.h"
 #include "ircons.h"
 #include "irdump.h"
@@ -31,6 +32,7 @@
 #include "iropt_dbg.h"
 #include "irprog_t.h"
 #include "irtools.h"
+#include "obst.h"
 #include "panic.h"
 #include "pmap.h"
 #include "xmalloc.h"
@@ -85,31 +87,49 @@ void cg_remove_call_callee_arr(ir_node *node)
 /* call target computations.                                                */
 /*--------------------------------------------------------------------------*/
 
-/** Collect the entity representing the implementation of this
- *  method (not the same if inherited) and all entities for overwriting
- *  implementations in parameter set.
+/** Class hierarchy index.
+ *
+ *  For every method entity we keep a bitset of all implementations that
+ *  may be selected for it: its own graph (if any) plus the graphs of all
+ *  methods that transitively overwrite it.  Bit positions are graph
+ *  indices (see get_irg_idx()), impl_ents maps them back to entities.
+ *  The sets are memoized, so shared parts of the hierarchy are descended
+ *  into only once per analysis run.  The index only lives from
+ *  sel_methods_init() to sel_methods_dispose() and is rebuilt from the
+ *  current type graph each time, so removed types or methods (e.g. after
+ *  garbage collection) cannot leave stale entries behind. */
+static struct obstack impl_obst;
+static pmap          *impl_sets;
+static ir_entity    **impl_ents;
+
+/** Compute (or look up) the descendant implementation set of a method.
  *  A recursive descend in the overwritten relation.
  *  Cycle-free, therefore must terminate.
  *
  * @param method   the overwritten method
- * @param set      A set of entities.
- *
- * @return Number of entities in set.
  */
-static size_t collect_impls(ir_entity *method, pset *set)
+static bitset_t *get_impl_set(ir_entity *method)
 {
-	size_t size = 0;
-	if (get_entity_irg(method) != NULL) {
+	bitset_t *set = pmap_get(bitset_t, impl_sets, method);
+	if (set != NULL)
+		return set;
+
+	set = bitset_obstack_alloc(&impl_obst, get_irp_last_idx());
+	pmap_insert(impl_sets, method, set);
+
+	ir_graph *const irg = get_entity_irg(method);
+	if (irg != NULL) {
 		/* has an implementation */
-		pset_insert_ptr(set, method);
-		++size;
+		size_t const idx = get_irg_idx(irg);
+		bitset_set(set, idx);
+		impl_ents[idx] = method;
 	}
 
 	/*- recursive descent -*/
 	for (size_t i = get_entity_n_overwrittenby(method); i-- > 0;) {
-		size += collect_impls(get_entity_overwrittenby(method, i), set);
+		bitset_or(set, get_impl_set(get_entity_overwrittenby(method, i)));
 	}
-	return size;
+	return set;
 }
 
 /**
@@ -123,16 +143,16 @@ static ir_entity **get_impl_methods(ir_entity *method)
 {
 	assert(is_method_entity(method));
 	/* Collect all method entities that can be called here */
-	ir_entity  **arr = NULL;
-	pset       *set  = pset_new_ptr_default();
-	size_t      size = collect_impls(method, set);
-	if (size > 0) {
-		arr = NEW_ARR_F(ir_entity *, size);
-		foreach_pset(set, ir_entity, ent) {
-			arr[--size] = ent;
-		}
+	bitset_t *const set  = get_impl_set(method);
+	size_t    const size = bitset_popcount(set);
+	if (size == 0)
+		return NULL;
+
+	ir_entity **arr = NEW_ARR_F(ir_entity*, size);
+	size_t      pos = 0;
+	bitset_foreach(set, idx) {
+		arr[pos++] = impl_ents[idx];
 	}
-	del_pset(set);
 	return arr;
 }
 
@@ -187,6 +207,9 @@ static void sel_methods_init(void)
 {
 	assert(entities == NULL);
 	entities = pset_new_ptr_default();
+	obstack_init(&impl_obst);
+	impl_sets = pmap_create();
+	impl_ents = OALLOCNZ(&impl_obst, ir_entity*, get_irp_last_idx());
 	all_irg_walk(sel_methods_walker, NULL, NULL);
 }
 
@@ -664,6 +687,10 @@ static void sel_methods_dispose(void)
 	}
 	del_pset(entities);
 	entities = NULL;
+	pmap_destroy(impl_sets);
+	impl_sets = NULL;
+	impl_ents = NULL;
+	obstack_free(&impl_obst, NULL);
 }
 
 static void destruct_walker(ir_node *node, void *env)
@@ -16,6 +16,7 @@
 #include "irnode_t.h"
 #include "irnodemap.h"
 #include "iropt.h"
+#include "pdeq.h"
 #include <assert.h>
 
 #ifndef VERIFY_CONSTBITS
@@ -760,6 +761,12 @@ set_info:;
 	return changed;
 }
 
+/** Worklist of nodes that became unstable, drained in constbits_analyze().
+ * The VALID -> UNSTABLE transition in trigger() deduplicates the entries:
+ * a node is queued at most once until it is re-evaluated. */
+static deq_t worklist;
+static bool  worklist_active;
+
 static void trigger_users(ir_node const *irn);
 
 static void trigger(ir_node const *const irn, ir_node const *const operand)
@@ -770,6 +777,8 @@ static void trigger(ir_node const *const irn, ir_node const *const operand)
 	if (b && b->state == BITINFO_VALID) {
 		DB((dbg, LEVEL_5, "%+F triggers %+F\n", operand, irn));
 		b->state = BITINFO_UNSTABLE;
+		if (worklist_active)
+			deq_push_pointer_right(&worklist, (ir_node*)irn);
 		trigger_users(irn);
 	} else {
 		DB((dbg, LEVEL_5, "%+F does not trigger %+F\n", operand, irn));
@@ -879,9 +888,21 @@ void constbits_analyze(ir_graph *const irg)
 
 	obstack_init(&irg->bitinfo.obst);
 	ir_nodemap_init(&irg->bitinfo.map, irg);
+	deq_init(&worklist);
+	worklist_active  = true;
 	get_bitinfo_func = &get_bitinfo_recursive;
 	irg_walk_graph(irg, NULL, calc_bitinfo_walker, NULL);
+	/* Re-evaluate the nodes that became unstable after they had already
+	 * been visited until the fixpoint is reached. */
+	while (!deq_empty(&worklist)) {
+		ir_node *const n = deq_pop_pointer_left(ir_node, &worklist);
+		bitinfo *const b = get_bitinfo_direct(n);
+		if (b != NULL && b->state == BITINFO_UNSTABLE)
+			calc_bitinfo(n, b);
+	}
 	get_bitinfo_func = &get_bitinfo_direct;
+	worklist_active  = false;
+	deq_free(&worklist);
 
 #if VERIFY_CONSTBITS
 	verify_constbits(irg);
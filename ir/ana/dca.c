@@ -22,12 +22,15 @@
 #include "debug.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
+#include "irnodeset.h"
 #include "pdeq.h"
 #include "tv.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
 static deq_t worklist;
+/** Nodes currently on the worklist, to avoid queueing duplicates. */
+static ir_nodeset_t queued;
 
 /**
  * Set cared for bits in irn, possibly putting it on the worklist.
@@ -52,7 +55,8 @@ static void care_for(ir_node *irn, ir_tarval *care)
 		DBG((dbg, LEVEL_3, "queueing %+F: %T->%T\n", irn, old_care, care));
 		assert(old_care != tarval_b_true || care == tarval_b_true);
 		set_irn_link(irn, (void *)care);
-		deq_push_pointer_right(&worklist, irn);
+		if (ir_nodeset_insert(&queued, irn))
+			deq_push_pointer_right(&worklist, irn);
 	} else {
 		DBG((dbg, LEVEL_3, "no change on %+F: %T\n", irn, old_care, care));
 	}
@@ -419,12 +423,15 @@ void dca_analyze(ir_graph *irg)
 	irg_walk_graph(irg, dca_init_node, NULL, 0);
 
 	deq_init(&worklist);
+	ir_nodeset_init(&queued);
 
 	care_for(get_irg_end(irg), 0);
 
 	while (!deq_empty(&worklist)) {
 		ir_node *n = deq_pop_pointer_left(ir_node, &worklist);
+		ir_nodeset_remove(&queued, n);
 		dca_transfer(n);
 	}
+	ir_nodeset_destroy(&queued);
 	deq_free(&worklist);
 }
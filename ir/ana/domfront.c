@@ -10,10 +10,12 @@
  * @date        04.05.2005
  */
 #include "array.h"
-#include "irdom.h"
+#include "irdom_t.h"
 #include "iredges_t.h"
+#include "irnode_t.h"
 #include "obst.h"
 #include "pmap.h"
+#include "util.h"
 
 /**
  * A wrapper for get_Block_idom.
@@ -29,6 +31,13 @@ static inline ir_node *get_idom(ir_node *bl)
 	return idom == NULL ? bl : idom;
 }
 
+static int cmp_block_idx(const void *a, const void *b)
+{
+	unsigned const idx_a = get_irn_idx(*(ir_node const *const *)a);
+	unsigned const idx_b = get_irn_idx(*(ir_node const *const *)b);
+	return QSORT_CMP(idx_a, idx_b);
+}
+
 /**
  * Compute the dominance frontier for a given block.
  *
@@ -65,6 +74,18 @@ static ir_node **compute_df(ir_node *blk, ir_dom_front_info_t *info)
 		}
 	}
 
+	/* keep the frontiers sorted by block index: consumers get a
+	 * deterministic iteration order and sets can be merged/searched
+	 * without hashing.  A block can enter the list once per child whose
+	 * frontier contains it, so drop the duplicates after sorting. */
+	QSORT_ARR(df_list, cmp_block_idx);
+	size_t len = 0;
+	for (size_t i = 0, n = ARR_LEN(df_list); i < n; ++i) {
+		if (len == 0 || df_list[len - 1] != df_list[i])
+			df_list[len++] = df_list[i];
+	}
+	ARR_SHRINKLEN(df_list, len);
+
 	/* now copy the flexible array to the obstack */
 	ir_node **const df = DUP_ARR_D(ir_node*, &info->obst, df_list);
 	DEL_ARR_F(df_list);
@@ -106,3 +127,23 @@ ir_node **ir_get_dominance_frontier(const ir_node *block)
 	ir_dom_front_info_t *info = &irg->domfront;
 	return pmap_get(ir_node*, info->df_map, block);
 }
+
+void ir_mark_iterated_dominance_frontiers(ir_graph *irg, deq_t *worklist)
+{
+	assert(irg_has_properties(irg,
+	                          IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE_FRONTIERS));
+	while (!deq_empty(worklist)) {
+		ir_node  *block    = deq_pop_pointer_left(ir_node, worklist);
+		ir_node **domfront = ir_get_dominance_frontier(block);
+		for (size_t i = 0, len = ARR_LEN(domfront); i < len; ++i) {
+			ir_node *y = domfront[i];
+			if (Block_block_visited(y))
+				continue;
+
+			if (!irn_visited(y))
+				deq_push_pointer_right(worklist, y);
+
+			mark_Block_block_visited(y);
+		}
+	}
+}
@@ -28,7 +28,7 @@
 #include "execfreq_t.h"
 
 #include "dfs_t.h"
-#include "gaussjordan.h"
+#include "gaussseidel.h"
 #include "hashptr.h"
 #include "iredges_t.h"
 #include "irgraph_t.h"
@@ -38,11 +38,11 @@
 #include "irnode_t.h"
 #include "irnodehashmap.h"
 #include "irouts.h"
+#include "irprofile.h"
 #include "irprog_t.h"
-#include "panic.h"
 #include "set.h"
+#include "statev_t.h"
 #include "util.h"
-#include "xmalloc.h"
 #include <math.h>
 #include <stdio.h>
 #include <string.h>
@@ -53,123 +53,19 @@
 
 #define MAX_INT_FREQ 1000000
 
-static hook_entry_t hook;
-
-typedef struct {
-	unsigned size;
-	double   entries[];
-} square_matrix;
-
-static square_matrix *mat_create(int n)
-{
-	square_matrix *result = xmalloc(sizeof(square_matrix) + n * n * sizeof(double));
-	result->size = n;
-	return result;
-}
-
-/*
- * Algorithm for QR decomposition taken from JAMA/C++ Linear Algebra
- * Library.
- * See http://math.nist.gov/tnt/jama_doxygen/jama_qr_h-source.html.
- * License: Public domain (U.S. government work).
- */
-static inline void setm(square_matrix *a, unsigned row, unsigned col, double val)
-{
-	a->entries[row * a->size + col] = val;
-}
+/** Maximum number of Gauss-Seidel sweeps over the equation system. */
+#define MAX_SOLVER_ITERATIONS 256
 
-static inline double getm(const square_matrix *a, unsigned row, unsigned col)
-{
-	return a->entries[row * a->size + col];
-}
+static hook_entry_t hook;
 
 /**
- * Use QR decomposition to find the nullspace of a (size n * n). This
- * function assumes that rank(a) = n-1.
+ * Adds val to the matrix entry at (row, col). Needed because a block may
+ * have several control flow edges from the same predecessor.
  */
-static void nullspace(square_matrix *a, double *result)
+static void matrix_add(gs_matrix_t *mat, unsigned row, unsigned col,
+                       double val)
 {
-	// The nullspace of a is the n-th column of q, where q * r is
-	// the QR decomposition of transpose(a).
-
-	unsigned       n  = a->size;
-	square_matrix *qr = mat_create(n);
-
-	// Transpose a
-	for (unsigned x = 0; x < n; x++) {
-		for (unsigned y = 0; y < n; y++) {
-			double val = getm(a, y, x);
-			setm(qr, x, y, val);
-		}
-	}
-
-	// In-place computation of qr.
-	for (unsigned k = 0; k < n; k++) {
-		// Compute 2-norm of k-th column without under/overflow.
-		double nrm = 0;
-		for (unsigned i = k; i < n; i++) {
-			nrm = hypot(nrm, getm(qr, i, k));
-		}
-
-		if (nrm == 0.0)
-			continue;
-		// Form k-th Householder vector.
-		if (getm(qr, k, k) < 0)
-			nrm = -nrm;
-		for (unsigned i = k; i < n; i++) {
-			double val = getm(qr, i, k);
-			val /= nrm;
-			setm(qr, i, k, val);
-		}
-		double val = getm(qr, k, k);
-		val += 1.0;
-		setm(qr, k, k, val);
-
-		// Apply transformation to remaining columns.
-		for (unsigned j = k+1; j < n; j++) {
-			double s = 0.0;
-			for (unsigned i = k; i < n; i++) {
-				s += getm(qr, i, k) * getm(qr, i, j);
-			}
-			s = -s / getm(qr, k, k);
-			for (unsigned i = k; i < n; i++) {
-				double val = getm(qr, i, j);
-				val += s * getm(qr, i, k);
-				setm(qr, i, j, val);
-			}
-		}
-	}
-
-	square_matrix *q = mat_create(n);
-
-	// Computation of Q from QR.
-	for (unsigned k = n; k-- > 0; ) {
-		for (unsigned i = 0; i < n; i++) {
-			setm(q, i, k, 0.0);
-		}
-		setm(q, k, k, 1.0);
-		for (unsigned j = k; j < n; j++) {
-			if (getm(qr, k, k) == 0)
-				continue;
-			double s = 0.0;
-			for (unsigned i = k; i < n; i++) {
-				s += getm(qr, i, k) * getm(q, i, j);
-			}
-			s = -s / getm(qr, k, k);
-			for (unsigned i = k; i < n; i++) {
-				double val = getm(q, i, j);
-				val += s * getm(qr, i, k);
-				setm(q, i, j, val);
-			}
-		}
-	}
-
-	// Fill nullspace with required information
-	for (unsigned i = 0; i < n; i++) {
-		result[i] = getm(q, i, n-1);
-	}
-	free(qr);
-	free(q);
+	gs_matrix_set(mat, row, col, gs_matrix_get(mat, row, col) + val);
 }
 
 double get_block_execfreq(const ir_node *block)
@@ -358,38 +254,6 @@ static void block_walk_no_keeps(ir_node *block)
 	}
 }
 
-/**
- * Computes (matrix row r_acc) += (matrix row r_x) * weight.
- */
-static void add_weighted(square_matrix *mat, unsigned r_acc, unsigned r_x,
-                         double weight)
-{
-	for (unsigned c = 0; c < mat->size; c++) {
-		double val = getm(mat, r_acc, c);
-		val += getm(mat, r_x, c) * weight;
-		setm(mat, r_acc, c, val);
-	}
-}
-
-/**
- * Computes the row-th entry of mat . vec.
- *
- * The elements in vec must be finite unless mat has a 0 at the
- * corresponding position.
- */
-static double mat_dot_vec_entry(square_matrix *mat, double *vec, int row)
-{
-	double acc = 0.0;
-	for (unsigned i = 0; i < mat->size; i++) {
-		double val = getm(mat, row, i);
-		if (val == 0)
-			continue;
-		assert(isfinite(vec[i]));
-		acc += val * vec[i];
-	}
-	return acc;
-}
-
 /**
  * Fallback solution 1: Use loop weight.
  *
@@ -451,29 +315,11 @@ void ir_estimate_execfreq(ir_graph *irg)
 	 * => they can "flow" from start to end. */
 	dfs_t *const dfs = dfs_new(irg);
 
-	unsigned       size   = dfs_get_n_nodes(dfs);
-
-	/* It is undesirable to allocate more than 2GB for the matrix */
-	if (size*size*sizeof(double) > 1 << 30) {
-		if (!fallback_loop_weight(dfs, loop_weight)) {
-			fallback_all_ones(dfs);
-		}
-		dfs_free(dfs);
-		return;
-	}
-
-
-	square_matrix *in_fac = mat_create(size);
-	for (unsigned r = 0; r < size; r++) {
-		for (unsigned c = 0; c < size; c++) {
-			setm(in_fac, r, c, 0.0);
-		}
-	}
-
+	unsigned const size = dfs_get_n_nodes(dfs);
 
 	ir_node *const start_block = get_irg_start_block(irg);
 	ir_node *const end_block   = get_irg_end_block(irg);
-	const int      end_idx     = size - dfs_get_post_num(dfs, end_block) - 1;
+	unsigned const end_idx     = size - dfs_get_post_num(dfs, end_block) - 1;
 
 	ir_reserve_resources(irg, IR_RESOURCE_BLOCK_VISITED
 	                          | IR_RESOURCE_IRN_VISITED
@@ -496,42 +342,30 @@ void ir_estimate_execfreq(ir_graph *irg)
 	}
 
 	double const inv_loop_weight = 1.0 / loop_weight;
-	/* lgs_to_mat[i] is the index of the block represented by the
-	 * i-th row/column in the LGS matrix. */
-	int *lgs_to_mat = NEW_ARR_F(int, 0);
 
+	/* Build the equation system x = P x in sparse form: the row of a block
+	 * holds the probabilities of its incoming control flow edges and -1 on
+	 * the diagonal. One sparse row per block keeps the memory linear in the
+	 * number of control flow edges instead of quadratic in the number of
+	 * blocks. */
+	gs_matrix_t *mat = gs_new_matrix(size, 0);
 	for (unsigned idx = 0; idx < size; ++idx) {
 		ir_node const *const bb = dfs_get_post_num_node(dfs, size-idx-1);
-		/* The end block is handled properly later, when all the kept blocks
-		 * are done. */
-		if (bb == end_block)
-			continue;
+		gs_matrix_set(mat, idx, idx, -1.0);
 
 		for (int i = get_Block_n_cfgpreds(bb) - 1; i >= 0; --i) {
 			ir_node *const pred           = get_Block_cfgpred_block(bb, i);
-			unsigned const pred_idx       = size - dfs_get_post_num(dfs, pred) - 1;
 			double   const cf_probability = get_cf_probability(bb, i, inv_loop_weight);
-			bool     const pred_visited   = pred_idx < idx;
-
-			if (pred_visited) {
-				add_weighted(in_fac, idx, pred_idx, cf_probability);
-			} else {
-				ARR_APP1(int, lgs_to_mat, pred_idx);
-				setm(in_fac, idx, pred_idx, cf_probability);
-			}
+			if (cf_probability == 0.0)
+				continue;
+			unsigned const pred_idx = size - dfs_get_post_num(dfs, pred) - 1;
+			matrix_add(mat, idx, pred_idx, cf_probability);
 		}
 
+		/* close the cycle with a virtual edge from end to start, so the
+		 * system has a non-trivial solution */
 		if (bb == start_block)
-			setm(in_fac, idx, end_idx, 1.0);
-	}
-
-	/* handle end block */
-	ARR_APP1(int, lgs_to_mat, end_idx);
-	for (int i = get_Block_n_cfgpreds(end_block) - 1; i >= 0; --i) {
-		ir_node *const pred           = get_Block_cfgpred_block(end_block, i);
-		int      const pred_idx       = size - dfs_get_post_num(dfs, pred) - 1;
-		double   const cf_probability = get_cf_probability(end_block, i, inv_loop_weight);
-		add_weighted(in_fac, end_idx, pred_idx, cf_probability);
+			matrix_add(mat, idx, end_idx, 1.0);
 	}
 
 	/* add artifical edges from "kept blocks without a path to end"
@@ -544,100 +378,79 @@ void ir_estimate_execfreq(ir_graph *irg)
 		double sum      = get_sum_succ_factors(keep, inv_loop_weight);
 		double fac      = KEEP_FAC/sum;
 		int    keep_idx = size - dfs_get_post_num(dfs, keep)-1;
-		add_weighted(in_fac, end_idx, keep_idx, fac);
-	}
-
-	/* mat_to_lgs[i] is the index of node i in the LGS matrix, or
-	 * -1 if the node can be solved by simple substitution. */
-	int *mat_to_lgs = NEW_ARR_F(int, size);
-	for (unsigned x = 0; x < size; x++) {
-		mat_to_lgs[x] = -1;
-	}
-	for (unsigned b = 0; b < ARR_LEN(lgs_to_mat); b++) {
-		mat_to_lgs[lgs_to_mat[b]] = b;
+		matrix_add(mat, end_idx, keep_idx, fac);
 	}
 
-#ifdef DEBUG
-	/* Check that all values in in_fac are only given in terms of nodes with backedges */
-	for (int y = 0; y < size; y++) {
-		if (mat_to_lgs[y] == -1)
-			continue;
-		for (int x = 0; x < size; x++) {
-			if (getm(in_fac, x, y) != 0)
-				panic("expect entry at (%d, %d) to be 0", x, y);
-		}
-	}
-#endif
-
-	/* Build the LGS matrix with only the indices in lgs_to_mat. */
-	unsigned lgs_size = ARR_LEN(lgs_to_mat);
-	square_matrix *lgs_matrix = mat_create(lgs_size);
-	double *lgs_x = NEW_ARR_F(double, size);
-
-	for (unsigned x = 0; x < lgs_size; x++) {
-		int bx = lgs_to_mat[x];
-		for (unsigned y = 0; y < lgs_size; y++) {
-			int by = lgs_to_mat[y];
-			double val = getm(in_fac, bx, by);
-			setm(lgs_matrix, x, y, val);
+	/* Initial solution: seed from profiled basic block counts when real
+	 * profile data is loaded, otherwise start flat. The Gauss-Seidel sweeps
+	 * then smooth the seed into a flow-consistent solution. */
+	double    *x           = NEW_ARR_F(double, size);
+	bool const use_profile = ir_profile_is_loaded()
+	                      && ir_profile_get_block_execcount(start_block) > 0;
+	for (unsigned idx = 0; idx < size; ++idx) {
+		double seed = 1.0;
+		if (use_profile) {
+			ir_node const *const bb    = dfs_get_post_num_node(dfs, size-idx-1);
+			uint32_t       const count = ir_profile_get_block_execcount(bb);
+			if (count > 0)
+				seed = (double)count;
 		}
-		/* RHS of the equation */
-		double val = getm(lgs_matrix, x, x);
-		val -= 1.0;
-		setm(lgs_matrix, x, x, val);
+		x[idx] = seed;
 	}
 
-	if (lgs_size == 1) {
-		lgs_x[0] = 1.0;
-	} else {
-		nullspace(lgs_matrix, lgs_x);
-	}
-
-	/* compute the normalization factor.
-	 * 1.0 / exec freq of end block.
-	 */
-	double  end_freq   = lgs_x[mat_to_lgs[end_idx]];
-	double  norm       = end_freq != 0.0 ? 1.0 / end_freq : 1.0;
-	double *freqs      = NEW_ARR_F(double, size);
-	bool    valid_freq = true;
-
-	/* First get the frequency for the nodes which were
-	 * explicitly computed. */
-	for (unsigned idx = size; idx-- > 0; ) {
-		ir_node *const bb = dfs_get_post_num_node(dfs, size - idx - 1);
-
-		if (mat_to_lgs[idx] != -1) {
-			double freq = lgs_x[mat_to_lgs[idx]] * norm;
-			/* Check for inf, nan and negative values. */
-			if (isinf(freq) || !(freq >= 0)) {
-				valid_freq = false;
-				break;
+	gs_matrix_compact(mat);
+
+	/* Iterate in reverse post order so the values flow from start to end.
+	 * The solution is only determined up to a scale factor; pin the end
+	 * block to 1.0 after each sweep to keep the iteration from drifting.
+	 * The relaxation factor is adapted from the observed convergence rate:
+	 * a ratio of successive residuals close to 1 means a stiff system,
+	 * which over-relaxation speeds up considerably; if the residual grows
+	 * fall back to the plain Gauss-Seidel update. */
+	double   omega    = 1.0;
+	double   prev_res = 0.0;
+	double   res      = 0.0;
+	unsigned iter     = 0;
+	for ( ; iter < MAX_SOLVER_ITERATIONS; ++iter) {
+		res = gs_matrix_gauss_seidel(mat, x, omega);
+		double const end_freq = x[end_idx];
+		if (end_freq != 0.0 && end_freq != 1.0) {
+			double const norm = 1.0 / end_freq;
+			for (unsigned i = 0; i < size; ++i) {
+				x[i] *= norm;
 			}
-			set_block_execfreq(bb, freq);
-			freqs[idx] = freq;
-		} else {
-			freqs[idx] = nan("");
+			res *= fabs(norm);
 		}
-	}
+		if (res < EPSILON * size)
+			break;
 
-	if (valid_freq) {
-		/* Now get the rest of the frequencies using the factors in in_fac */
-		for (unsigned idx = size; idx-- > 0; ) {
-			ir_node *const bb = dfs_get_post_num_node(dfs, size - idx - 1);
-
-			if (mat_to_lgs[idx] == -1) {
-				double freq = mat_dot_vec_entry(in_fac, freqs, idx);
-				/* Check for inf, nan and negative values. */
-				if (isinf(freq) || freq < 0) {
-					valid_freq = false;
-					break;
-				}
-				set_block_execfreq(bb, freq);
+		if (prev_res > 0.0) {
+			double const ratio = res / prev_res;
+			if (ratio >= 1.0) {
+				omega = 1.0;
+			} else {
+				/* classical SOR estimate from the contraction rate */
+				omega = 2.0 / (1.0 + sqrt(1.0 - ratio));
+				omega = MIN(omega, 1.9);
 			}
 		}
+		prev_res = res;
 	}
+	stat_ev_dbl("execfreq_iterations", iter);
+	stat_ev_dbl("execfreq_residual", res);
 
-	DEL_ARR_F(freqs);
+	bool valid_freq = true;
+	for (unsigned idx = size; idx-- > 0; ) {
+		ir_node *const bb   = dfs_get_post_num_node(dfs, size - idx - 1);
+		double   const freq = x[idx];
+
+		/* Check for inf, nan and negative values. */
+		if (isinf(freq) || !(freq >= 0)) {
+			valid_freq = false;
+			break;
+		}
+		set_block_execfreq(bb, freq);
+	}
 
 	/* Fallbacks in case some frequencies were invalid */
 	if (!valid_freq && !fallback_loop_weight(dfs, loop_weight)) {
@@ -645,9 +458,6 @@ void ir_estimate_execfreq(ir_graph *irg)
 	}
 
 	free_properties_and_dfs(irg, dfs);
-	DEL_ARR_F(lgs_to_mat);
-	DEL_ARR_F(mat_to_lgs);
-	free(in_fac);
-	free(lgs_matrix);
-	DEL_ARR_F(lgs_x);
+	DEL_ARR_F(x);
+	gs_delete_matrix(mat);
 }
@@ -15,6 +15,7 @@
 #include "iredges_t.h"
 #include "irgwalk.h"
 #include "irnodemap.h"
+#include "irnodeset.h"
 #include "list.h"
 #include "util.h"
 #include <stdbool.h>
@@ -25,6 +26,8 @@ struct ir_heights_t {
 	ir_nodemap      data;
 	unsigned        visited;
 	hook_entry_t   *dump_handle;
+	/** blocks whose contents changed since their heights were computed */
+	ir_nodeset_t    dirty_blocks;
 	struct obstack  obst;
 };
 
@@ -102,11 +105,15 @@ static bool search(ir_heights_t *h, const ir_node *curr, const ir_node *tgt)
 int heights_reachable_in_block(ir_heights_t *h, const ir_node *n,
                                const ir_node *m)
 {
+	ir_node *block = get_nodes_block(n);
+	assert(get_nodes_block(m) == block);
+	if (ir_nodeset_contains(&h->dirty_blocks, block))
+		heights_recompute_block(h, block);
+
 	int           res = 0;
 	irn_height_t *hn  = maybe_get_height_data(h, n);
 	irn_height_t *hm  = maybe_get_height_data(h, m);
 
-	assert(get_nodes_block(n) == get_nodes_block(m));
 	assert(hn != NULL && hm != NULL);
 
 	if (hn->height <= hm->height) {
@@ -158,6 +165,11 @@ static unsigned compute_heights_in_block(ir_node *bl, ir_heights_t *h)
 		max_height = MAX(curh, max_height);
 	}
 
+	/* remember the block maximum, so clean blocks can answer
+	 * heights_recompute_block() without another walk */
+	get_height_data(h, bl)->height = (unsigned) max_height;
+	ir_nodeset_remove(&h->dirty_blocks, bl);
+
 	return max_height;
 }
 
@@ -174,8 +186,18 @@ unsigned get_irn_height(const ir_heights_t *heights, const ir_node *irn)
 	return height->height;
 }
 
+void heights_dirty_block(ir_heights_t *h, ir_node *block)
+{
+	ir_nodeset_insert(&h->dirty_blocks, block);
+}
+
 unsigned heights_recompute_block(ir_heights_t *h, ir_node *block)
 {
+	/* nothing to do for blocks whose contents did not change */
+	irn_height_t *bh = maybe_get_height_data(h, block);
+	if (bh != NULL && !ir_nodeset_contains(&h->dirty_blocks, block))
+		return bh->height;
+
 	ir_graph *irg = get_irn_irg(block);
 	assure_edges(irg);
 
@@ -194,6 +216,7 @@ ir_heights_t *heights_new(ir_graph *irg)
 {
 	ir_heights_t *res = XMALLOCZ(ir_heights_t);
 	ir_nodemap_init(&res->data, irg);
+	ir_nodeset_init(&res->dirty_blocks);
 	obstack_init(&res->obst);
 	res->dump_handle = dump_add_node_info_callback(height_dump_cb, res);
 
@@ -206,6 +229,7 @@ ir_heights_t *heights_new(ir_graph *irg)
 void heights_free(ir_heights_t *h)
 {
 	dump_remove_node_info_callback(h->dump_handle);
+	ir_nodeset_destroy(&h->dirty_blocks);
 	obstack_free(&h->obst, NULL);
 	ir_nodemap_destroy(&h->data);
 	free(h);
@@ -85,13 +85,22 @@ void fix_backedges(struct obstack *obst, ir_node *n)
 
 	int arity = get_irn_arity(n);
 	if (bitset_size(arr) != (unsigned) arity) {
-		arr = new_backedge_arr(obst, arity);
-
-		unsigned opc = get_irn_opcode(n);
-		if (opc == iro_Phi) {
-			n->attr.phi.u.backedge = arr;
-		} else if (opc == iro_Block) {
-			n->attr.block.backedge = arr;
+		if (BITSET_SIZE_ELEMS((unsigned) arity)
+		    <= BITSET_SIZE_ELEMS(bitset_size(arr))) {
+			/* The new size fits into the words already allocated for the
+			 * old one: recycle them in place instead of leaking the old
+			 * array into the obstack.  Backedge state is reset on arity
+			 * changes either way. */
+			bitset_init(arr, arity);
+		} else {
+			arr = new_backedge_arr(obst, arity);
+
+			unsigned opc = get_irn_opcode(n);
+			if (opc == iro_Phi) {
+				n->attr.phi.u.backedge = arr;
+			} else if (opc == iro_Block) {
+				n->attr.block.backedge = arr;
+			}
 		}
 	}
 
@@ -244,15 +244,17 @@ static ir_loop *new_loop(void)
 /* Initialization steps. **********************************************/
 
 /**
- * Allocates a scc_info for every Block node n.
- * Clear the backedges for all nodes.
- * Called from a walker.
+ * Allocates a scc_info for the block n and clears its backedges.
+ * Called from a block walker.
+ *
+ * Backedges of Phi nodes are not touched here: only the loop
+ * optimizations set them and they clean up after themselves, so a
+ * cheap walk over the blocks suffices instead of a full graph walk.
  */
 static inline void init_node(ir_node *n, void *env)
 {
 	struct obstack *obst = (struct obstack*) env;
-	if (is_Block(n))
-		set_irn_link(n, new_scc_info(obst));
+	set_irn_link(n, new_scc_info(obst));
 	clear_backedges(n);
 }
 
@@ -273,7 +275,7 @@ static inline void init_scc_common(void)
 static inline void init_scc(ir_graph *irg, struct obstack *obst)
 {
 	init_scc_common();
-	irg_walk_graph(irg, init_node, NULL, obst);
+	irg_block_walk_graph(irg, init_node, NULL, obst);
 }
 
 static inline void finish_scc(void)
@@ -579,6 +581,9 @@ static void loop_reset_node(ir_node *n, void *env)
 void free_loop_information(ir_graph *irg)
 {
 	irg_walk_graph(irg, loop_reset_node, NULL, NULL);
+	ir_loop *loop = get_irg_loop(irg);
+	if (loop != NULL)
+		free_loop_children(loop);
 	set_irg_loop(irg, NULL);
 	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
 	/* We cannot free the loop nodes, they are on the obstack. */
@@ -588,6 +593,12 @@ void construct_cf_backedges(ir_graph *irg)
 {
 	outermost_ir_graph = irg;
 
+	/* drop the children arrays of a previous loop tree; the ir_loop
+	 * structures themselves rest on the obstack */
+	ir_loop *old_loop = get_irg_loop(irg);
+	if (old_loop != NULL)
+		free_loop_children(old_loop);
+
 	struct obstack temp;
 	obstack_init(&temp);
 
@@ -616,7 +627,9 @@ void construct_cf_backedges(ir_graph *irg)
 	obstack_free(&temp, NULL);
 
 	assert(head_rem == current_loop);
-	mature_loops(current_loop, get_irg_obstack(irg));
+	/* The tree is not matured: the children stay in flexible arrays so
+	 * that the repair operations in irgmod.c and the loop transformations
+	 * can register new blocks with their loops after construction. */
 	set_irg_loop(irg, current_loop);
 	add_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
 }
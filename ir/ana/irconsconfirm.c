@@ -21,8 +21,11 @@
 #include "irgraph_t.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
+#include "irnodehashmap.h"
 #include "iropt_dbg.h"
 #include "irtools.h"
+#include "obst.h"
+#include "xmalloc.h"
 
 /**
  * Walker environment.
@@ -569,6 +572,168 @@ void construct_confirms_only(ir_graph *irg)
 	do_construct_confirms(irg, false);
 }
 
+/*
+ * Out-of-band variant: instead of materializing Confirm nodes on all use
+ * edges (and ripping them out again with remove_confirms()), record the
+ * same facts in a dominance-scoped side table that interested passes can
+ * query on demand.  The graph itself stays untouched.
+ */
+
+typedef struct range_entry_t {
+	struct range_entry_t *next;
+	ir_node              *block;    /**< fact holds in blocks dominated by
+	                                     this block */
+	ir_node              *bound;
+	ir_relation           relation;
+} range_entry_t;
+
+struct ir_confirm_table_t {
+	ir_nodehashmap_t map;           /**< value -> list of range entries */
+	struct obstack   obst;
+};
+
+static void add_range(ir_confirm_table_t *table, ir_node *value,
+                      ir_node *block, ir_relation relation, ir_node *bound)
+{
+	range_entry_t *head = ir_nodehashmap_get(range_entry_t, &table->map,
+	                                         value);
+	/* dereferences of the same pointer pile up quickly; skip exact
+	 * duplicates (the lists stay short, so a linear scan is fine) */
+	for (range_entry_t *entry = head; entry != NULL; entry = entry->next) {
+		if (entry->block == block && entry->bound == bound
+		 && entry->relation == relation)
+			return;
+	}
+
+	range_entry_t *entry = OALLOC(&table->obst, range_entry_t);
+	entry->block    = block;
+	entry->bound    = bound;
+	entry->relation = relation;
+	entry->next     = head;
+	ir_nodehashmap_insert(&table->map, value, entry);
+}
+
+/**
+ * Block walker: record the facts established by the branch entering
+ * @p block.  This mirrors insert_Confirm_in_block(), but writes table
+ * entries instead of rewriting use edges.
+ */
+static void collect_ranges_in_block(ir_node *block, void *data)
+{
+	/* as in the node-based mode only blocks with exactly one control flow
+	 * predecessor are handled */
+	if (get_Block_n_cfgpreds(block) != 1)
+		return;
+
+	ir_node *proj = get_Block_cfgpred(block, 0);
+	if (!is_Proj(proj))
+		return;
+
+	ir_confirm_table_t *table = (ir_confirm_table_t*)data;
+	ir_node            *cond  = get_Proj_pred(proj);
+	if (is_Switch(cond)) {
+		unsigned pn = get_Proj_num(proj);
+		if (pn == pn_Switch_default)
+			return;
+		ir_node *c = get_case_value(cond, pn);
+		if (c == NULL)
+			return;
+		add_range(table, get_Switch_selector(cond), block,
+		          ir_relation_equal, c);
+	} else if (is_Cond(cond)) {
+		ir_node *selector = get_Cond_selector(cond);
+		if (!is_Cmp(selector))
+			return;
+
+		ir_node *left  = get_Cmp_left(selector);
+		ir_node *right = get_Cmp_right(selector);
+		if (is_Bad(left) || is_Bad(right))
+			return;
+
+		ir_relation rel = get_Cmp_relation(selector);
+		/* it's the false branch */
+		if (get_Proj_num(proj) != pn_Cond_true)
+			rel = get_negated_relation(rel);
+
+		if (!is_Const(left))
+			add_range(table, left, block, rel, right);
+		if (!is_Const(right))
+			add_range(table, right, block, get_inversed_relation(rel),
+			          left);
+	}
+}
+
+/**
+ * Walker: record non-null facts implied by Load/Store dereferences in
+ * addition to the per-block branch facts.
+ */
+static void collect_ranges(ir_node *node, void *data)
+{
+	ir_node *ptr;
+	switch (get_irn_opcode(node)) {
+	case iro_Block:
+		collect_ranges_in_block(node, data);
+		return;
+	case iro_Load:
+		ptr = get_Load_ptr(node);
+		break;
+	case iro_Store:
+		ptr = get_Store_ptr(node);
+		break;
+	default:
+		return;
+	}
+
+	/* Addresses are non-null anyway */
+	if (is_Address(ptr))
+		return;
+
+	ir_confirm_table_t *table = (ir_confirm_table_t*)data;
+	ir_graph           *irg   = get_irn_irg(node);
+	ir_node            *null  = new_r_Const_null(irg, get_irn_mode(ptr));
+	add_range(table, ptr, get_nodes_block(node), ir_relation_less_greater,
+	          null);
+}
+
+ir_confirm_table_t *ir_confirm_table_compute(ir_graph *irg)
+{
+	assure_irg_properties(irg,
+		IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+		| IR_GRAPH_PROPERTY_NO_BADS
+		| IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES);
+
+	ir_confirm_table_t *table = XMALLOC(ir_confirm_table_t);
+	obstack_init(&table->obst);
+	ir_nodehashmap_init(&table->map);
+
+	if (get_opt_global_null_ptr_elimination()) {
+		/* also collect non-null facts from dereferences */
+		irg_walk_graph(irg, collect_ranges, NULL, table);
+	} else {
+		irg_block_walk_graph(irg, collect_ranges_in_block, NULL, table);
+	}
+	return table;
+}
+
+void ir_confirm_table_free(ir_confirm_table_t *table)
+{
+	ir_nodehashmap_destroy(&table->map);
+	obstack_free(&table->obst, NULL);
+	free(table);
+}
+
+void ir_confirm_table_foreach(const ir_confirm_table_t *table,
+                              const ir_node *value, const ir_node *block,
+                              ir_confirm_range_cb cb, void *env)
+{
+	for (range_entry_t *entry
+	     = ir_nodehashmap_get(range_entry_t, &table->map, value);
+	     entry != NULL; entry = entry->next) {
+		if (block_dominates(entry->block, block))
+			cb(env, entry->relation, entry->bound);
+	}
+}
+
 static void remove_confirm(ir_node *n, void *env)
 {
 	(void)env;
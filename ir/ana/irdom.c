@@ -17,6 +17,7 @@
 #include "irgraph_t.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
+#include "irnodeset.h"
 #include "irouts_t.h"
 #include "util.h"
 #include "xmalloc.h"
@@ -605,6 +606,174 @@ void compute_doms(ir_graph *irg)
 	              assign_tree_dom_pre_order_max, &tree_pre_order);
 }
 
+/**
+ * Removes @p block from the list of blocks dominated by its current idom.
+ */
+static void unlink_from_idom(ir_node *block)
+{
+	ir_dom_info *bi = get_dom_info(block);
+	ir_dom_info *pi = get_dom_info(bi->idom);
+	if (pi->first == block) {
+		pi->first = bi->next;
+	} else {
+		ir_node *prev = pi->first;
+		while (get_dom_info(prev)->next != block)
+			prev = get_dom_info(prev)->next;
+		get_dom_info(prev)->next = bi->next;
+	}
+	bi->next = NULL;
+}
+
+/**
+ * Moves the dominator subtree of @p block one level down.
+ */
+static void inc_subtree_dom_depth(ir_node *block)
+{
+	int depth = get_Block_dom_depth(block);
+	if (depth > 0)
+		set_Block_dom_depth(block, depth + 1);
+	dominates_for_each(block, p) {
+		inc_subtree_dom_depth(p);
+	}
+}
+
+int ir_dominance_block_inserted(ir_node *block, ir_node *succ)
+{
+	ir_graph *irg = get_irn_irg(block);
+	assert(!irg_is_constrained(irg, IR_GRAPH_CONSTRAINT_CONSTRUCTION));
+	if (!irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE))
+		return 0;
+
+	assert(get_Block_n_cfgpreds(block) == 1);
+	ir_node *pred = get_Block_cfgpred_block(block, 0);
+
+	memset(get_dom_info(block), 0, sizeof(ir_dom_info));
+	set_Block_dom_pre_num(block, -1);
+
+	/* Blocks not reachable from Start stay out of the tree, as in
+	 * compute_doms(). */
+	if (pred == NULL || get_Block_dom_depth(pred) == -1) {
+		set_Block_idom(block, NULL);
+		set_Block_dom_depth(block, -1);
+		return 1;
+	}
+
+	/* Rerouting one edge through the new block changes no path between the
+	 * old blocks, so their dominance relation is untouched; only the new
+	 * block and possibly succ move.  The new block dominates succ iff every
+	 * other reachable entry of succ is a back edge, i.e. dominated by succ
+	 * itself.  The end block gets extra entries from keep-alive edges which
+	 * are not visible here, so treat it conservatively. */
+	bool dominates_succ = succ != get_irg_end_block(irg);
+	if (dominates_succ) {
+		foreach_irn_in(succ, i, succ_pred) {
+			if (is_Bad(succ_pred))
+				continue;
+			ir_node *succ_pred_block = get_nodes_block(succ_pred);
+			if (succ_pred_block == block
+			 || get_Block_dom_depth(succ_pred_block) == -1)
+				continue;
+			if (!block_dominates(succ, succ_pred_block)) {
+				dominates_succ = false;
+				break;
+			}
+		}
+	}
+
+	set_Block_idom(block, pred);
+	set_Block_dom_depth(block, get_Block_dom_depth(pred) + 1);
+
+	if (dominates_succ) {
+		/* The new block takes succ's place in the tree: succ's subtree
+		 * moves down one level. */
+		unlink_from_idom(succ);
+		set_Block_idom(succ, block);
+		inc_subtree_dom_depth(succ);
+	}
+
+	/* The pre order intervals used by block_dominates() have no room for
+	 * new entries, so renumber the tree.  This costs one walk over the
+	 * blocks, while a full recompute also rebuilds the outs of all nodes
+	 * and reruns the Lengauer-Tarjan construction. */
+	unsigned tree_pre_order = 0;
+	dom_tree_walk(get_irg_start_block(irg), assign_tree_dom_pre_order,
+	              assign_tree_dom_pre_order_max, &tree_pre_order);
+	return 1;
+}
+
+/** Nearest common ancestor in the (possibly stale) dominator tree.
+ *  Works on the raw dom info because the property bit is cleared. */
+static ir_node *repair_common_dominator(ir_node *block0, ir_node *block1)
+{
+	while (block0 != block1) {
+		if (get_Block_dom_depth(block0) >= get_Block_dom_depth(block1)) {
+			block0 = get_dom_info(block0)->idom;
+		} else {
+			block1 = get_dom_info(block1)->idom;
+		}
+	}
+	return block0;
+}
+
+bool irg_try_repair_dominance(ir_graph *irg)
+{
+	if (!(irg->locally_dirty & IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE))
+		return false;
+	irg->locally_dirty &= ~IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE;
+
+	ir_nodeset_t *const dirty = (ir_nodeset_t*)irg->dirty_blocks;
+	assert(dirty != NULL);
+
+	/* The old tree was exact for the old graph.  If at every block whose
+	 * predecessors changed the old immediate dominator still equals the
+	 * common dominator of the current predecessors, the old tree
+	 * satisfies the dominance equations of the new graph as well:
+	 * everywhere else neither the predecessors nor the claimed
+	 * dominators changed.  For added or redirected entries this makes
+	 * the old tree the exact new tree.  Removing entries can only make
+	 * dominators grow, so a surviving old tree errs towards reporting
+	 * fewer dominators, which users of block_dominates() tolerate. */
+	bool ok = true;
+	ir_node *const end_block = get_irg_end_block(irg);
+	foreach_ir_nodeset(dirty, block, iter) {
+		/* blocks killed since being recorded cannot affect the rest */
+		if (!is_Block(block))
+			continue;
+		/* the end block has invisible keep-alive entries */
+		if (block == end_block) {
+			ok = false;
+			break;
+		}
+		ir_node *nca = NULL;
+		foreach_irn_in(block, i, pred) {
+			if (is_Bad(pred))
+				continue;
+			ir_node *const pred_block = get_nodes_block(pred);
+			if (get_Block_dom_depth(pred_block) == -1)
+				continue;
+			nca = nca == NULL ? pred_block
+			    : repair_common_dominator(nca, pred_block);
+		}
+		if (nca == NULL) {
+			/* all entries gone: fine if the block was unreachable before */
+			if (get_Block_dom_depth(block) != -1)
+				ok = false;
+		} else if (get_Block_dom_depth(block) == -1
+		        || get_dom_info(block)->idom != nca) {
+			ok = false;
+		}
+		if (!ok)
+			break;
+	}
+
+	ir_nodeset_destroy(dirty);
+	ir_nodeset_init(dirty);
+
+	if (ok)
+		add_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+	return ok;
+}
+
 static void update_pdom_semi(tmp_dom_info *tdi_list, tmp_dom_info *w,
                              ir_node *succ_block)
 {
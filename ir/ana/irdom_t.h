@@ -13,8 +13,10 @@
 #define FIRM_ANA_IRDOM_T_H
 
 #include "irdom.h"
+#include "pdeq.h"
 #include "pmap.h"
 #include "obst.h"
+#include <stdbool.h>
 
 /** For dominator information */
 typedef struct ir_dom_info {
@@ -57,6 +59,28 @@ unsigned get_Block_pdom_max_subtree_pre_num(const ir_node *bl);
 
 void ir_free_dominance_frontiers(ir_graph *irg);
 
+/**
+ * Marks the iterated dominance frontier of a set of blocks, i.e. the blocks
+ * where phi placement is needed when the seed blocks contain definitions.
+ *
+ * The seed blocks are passed in @p worklist, which is consumed.  Every
+ * frontier block found is marked with the block-visited flag and pushed
+ * onto the worklist in turn, unless its (node-)visited flag is set — a
+ * caller uses that flag to mark blocks that already carry a definition
+ * and are part of the seed set.  Requires consistent dominance frontiers;
+ * the caller owns the visited flags.
+ */
+void ir_mark_iterated_dominance_frontiers(ir_graph *irg, deq_t *worklist);
+
+/**
+ * Tries to revalidate the dominance information of @p irg from the
+ * blocks declared dirty via clear_irg_properties_local().  Returns true
+ * and re-sets IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE if the old tree is
+ * still valid, false if a full recompute is needed.  Consumes the
+ * declared region either way.
+ */
+bool irg_try_repair_dominance(ir_graph *irg);
+
 /**
  * Iterate over all nodes which are immediately dominated by a given
  * node.
@@ -21,6 +21,11 @@
  * - data obtained from a depth-first-search
  *
  * The precomputation remains valid as long as the CFG is not altered.
+ *
+ * Query results are memoized per block in lazily allocated bitsets, since
+ * clients like the register allocator ask the same questions over and over
+ * again. The memoized answers reflect the uses at query time; after the
+ * program was modified, lv_chk_flush() drops them.
  */
 #include "irlivechk.h"
 
@@ -53,6 +58,15 @@ typedef struct bl_info_t {
 	bitset_t *be_tgt_reach;    /**< Target blocks of back edges whose
 	                                sources are reachable from this block
 	                                in the reduced graph. */
+
+	bitset_t *chk_cached;      /**< Values (by node idx) whose liveness
+	                                at this block is memoized. NULL until
+	                                the block is queried for the first
+	                                time; the following three bitsets are
+	                                only valid if this one is present. */
+	bitset_t *chk_in;          /**< Memoized live in answers. */
+	bitset_t *chk_end;         /**< Memoized live end answers. */
+	bitset_t *chk_out;         /**< Memoized live out answers. */
 } bl_info_t;
 
 struct lv_chk_t {
@@ -60,6 +74,9 @@ struct lv_chk_t {
 	struct obstack obst;
 	dfs_t         *dfs;
 	int            n_blocks;
+	unsigned       n_idx;      /**< Number of node indices when the
+	                                environment was built. Younger nodes
+	                                bypass the memoization. */
 	bitset_t      *back_edge_src;
 	bitset_t      *back_edge_tgt;
 	bl_info_t    **map;
@@ -76,11 +93,40 @@ static bl_info_t *get_block_info(lv_chk_t *lv, const ir_node *block)
 		info->red_reachable = bitset_obstack_alloc(&lv->obst, lv->n_blocks);
 		info->be_tgt_reach  = bitset_obstack_alloc(&lv->obst, lv->n_blocks);
 		info->be_tgt_calc   = 0;
+		info->chk_cached    = NULL;
 		ir_nodemap_insert(&lv->block_infos, block, info);
 	}
 	return info;
 }
 
+static void ensure_query_cache(lv_chk_t *lv, bl_info_t *bi)
+{
+	if (bi->chk_cached != NULL)
+		return;
+	bi->chk_cached = bitset_obstack_alloc(&lv->obst, lv->n_idx);
+	bi->chk_in     = bitset_obstack_alloc(&lv->obst, lv->n_idx);
+	bi->chk_end    = bitset_obstack_alloc(&lv->obst, lv->n_idx);
+	bi->chk_out    = bitset_obstack_alloc(&lv->obst, lv->n_idx);
+}
+
+static unsigned get_cached_state(const bl_info_t *bi, unsigned idx)
+{
+	return (bitset_is_set(bi->chk_in,  idx) ? lv_chk_state_in  : 0)
+	     | (bitset_is_set(bi->chk_end, idx) ? lv_chk_state_end : 0)
+	     | (bitset_is_set(bi->chk_out, idx) ? lv_chk_state_out : 0);
+}
+
+static void set_cached_state(bl_info_t *bi, unsigned idx, unsigned state)
+{
+	bitset_set(bi->chk_cached, idx);
+	if (state & lv_chk_state_in)
+		bitset_set(bi->chk_in, idx);
+	if (state & lv_chk_state_end)
+		bitset_set(bi->chk_end, idx);
+	if (state & lv_chk_state_out)
+		bitset_set(bi->chk_out, idx);
+}
+
 /**
  * Compute the transitive closure on the reduced graph.
  * The reduced graph is the original graph without back edges.
@@ -199,6 +245,7 @@ lv_chk_t *lv_chk_new(ir_graph *irg)
 	obstack_init(&res->obst);
 	res->dfs           = dfs_new(irg);
 	res->n_blocks      = dfs_get_n_nodes(res->dfs);
+	res->n_idx         = get_irg_last_idx(irg);
 	res->back_edge_src = bitset_obstack_alloc(&res->obst, res->n_blocks);
 	res->back_edge_tgt = bitset_obstack_alloc(&res->obst, res->n_blocks);
 	res->map           = OALLOCNZ(&res->obst, bl_info_t*, res->n_blocks);
@@ -244,7 +291,24 @@ void lv_chk_free(lv_chk_t *lv)
 	free(lv);
 }
 
-unsigned lv_chk_bl_xxx(lv_chk_t *lv, const ir_node *bl, const ir_node *var)
+void lv_chk_flush(lv_chk_t *lv)
+{
+	for (int i = 0; i < lv->n_blocks; ++i) {
+		bl_info_t *bi = lv->map[i];
+		if (bi == NULL || bi->chk_cached == NULL)
+			continue;
+		bitset_clear_all(bi->chk_cached);
+		bitset_clear_all(bi->chk_in);
+		bitset_clear_all(bi->chk_end);
+		bitset_clear_all(bi->chk_out);
+	}
+}
+
+/**
+ * Performs the actual liveness check, see lv_chk_bl_xxx().
+ */
+static unsigned lv_chk_bl_compute(lv_chk_t *lv, const ir_node *bl,
+                                  const ir_node *var)
 {
 	assert(is_Block(bl));
 	assert(is_liveness_node(var));
@@ -424,3 +488,42 @@ end:
 
 	return res;
 }
+
+unsigned lv_chk_bl_xxx(lv_chk_t *lv, const ir_node *bl, const ir_node *var)
+{
+	/* nodes created after the environment was built bypass the cache */
+	unsigned const idx = get_irn_idx(var);
+	if (idx >= lv->n_idx)
+		return lv_chk_bl_compute(lv, bl, var);
+
+	bl_info_t *bi = get_block_info(lv, bl);
+	ensure_query_cache(lv, bi);
+	if (bitset_is_set(bi->chk_cached, idx))
+		return get_cached_state(bi, idx);
+
+	unsigned const res = lv_chk_bl_compute(lv, bl, var);
+	set_cached_state(bi, idx, res);
+	return res;
+}
+
+void lv_chk_bl_many(lv_chk_t *lv, const ir_node *bl, ir_node *const *vars,
+                    size_t n_vars, unsigned *states)
+{
+	bl_info_t *bi = get_block_info(lv, bl);
+	ensure_query_cache(lv, bi);
+
+	for (size_t i = 0; i < n_vars; ++i) {
+		ir_node *const var = vars[i];
+		unsigned const idx = get_irn_idx(var);
+
+		if (idx < lv->n_idx && bitset_is_set(bi->chk_cached, idx)) {
+			states[i] = get_cached_state(bi, idx);
+			continue;
+		}
+
+		unsigned const res = lv_chk_bl_compute(lv, bl, var);
+		if (idx < lv->n_idx)
+			set_cached_state(bi, idx, res);
+		states[i] = res;
+	}
+}
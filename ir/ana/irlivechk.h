@@ -64,6 +64,7 @@ extern void lv_chk_free(lv_chk_t *lv);
 
 /**
  * Return liveness information for a node concerning a block.
+ * The answer is memoized, repeated queries for the same pair are cheap.
  * @param lv   The liveness environment.
  * @param bl   The block to investigate.
  * @param irn  The node to check for.
@@ -71,6 +72,29 @@ extern void lv_chk_free(lv_chk_t *lv);
  */
 extern unsigned lv_chk_bl_xxx(lv_chk_t *lv, const ir_node *bl, const ir_node *irn);
 
+/**
+ * Return liveness information for a whole set of values concerning one
+ * block, sharing the per-block setup and filling the memoization cache
+ * in a single pass.
+ * @param lv      The liveness environment.
+ * @param bl      The block to investigate.
+ * @param vars    The values to check for.
+ * @param n_vars  Number of values in @p vars.
+ * @param states  Filled with a bitmask of <code>lv_chk_state_t</code>
+ *                per value.
+ */
+extern void lv_chk_bl_many(lv_chk_t *lv, const ir_node *bl,
+                           ir_node *const *vars, size_t n_vars,
+                           unsigned *states);
+
+/**
+ * Drop all memoized query results. Call this after the program was
+ * modified; the CFG-based precomputation itself stays valid as long as
+ * the CFG is untouched.
+ * @param lv The liveness environment.
+ */
+extern void lv_chk_flush(lv_chk_t *lv);
+
 #define lv_chk_bl_in(lv, bl, irn)  ((lv_chk_bl_xxx((lv), (bl), (irn)) & lv_chk_state_in)  != 0)
 #define lv_chk_bl_end(lv, bl, irn) ((lv_chk_bl_xxx((lv), (bl), (irn)) & lv_chk_state_end) != 0)
 #define lv_chk_bl_out(lv, bl, irn) ((lv_chk_bl_xxx((lv), (bl), (irn)) & lv_chk_state_out) != 0)
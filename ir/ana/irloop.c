@@ -55,6 +55,20 @@ void mature_loops(ir_loop *loop, struct obstack *obst)
 	}
 }
 
+void free_loop_children(ir_loop *loop)
+{
+	if (loop->children == NULL)
+		return;
+
+	for (size_t i = 0, n_elems = ARR_LEN(loop->children); i < n_elems; ++i) {
+		loop_element child = loop->children[i];
+		if (*child.kind == k_ir_loop)
+			free_loop_children(child.son);
+	}
+	DEL_ARR_F(loop->children);
+	loop->children = NULL;
+}
+
 ir_loop *(get_loop_outer_loop)(const ir_loop *loop)
 {
 	return _get_loop_outer_loop(loop);
@@ -73,6 +73,15 @@ void set_irn_loop(ir_node *n, ir_loop *loop);
  */
 void mature_loops(ir_loop *loop, struct obstack *obst);
 
+/**
+ * Recursively frees the children arrays of a loop tree.  The ir_loop
+ * structures themselves live on an obstack and stay behind.  The control
+ * flow loop trees keep their children in flexible arrays so that repair
+ * operations can insert new blocks after construction; these arrays must
+ * be freed before the tree is dropped or rebuilt.
+ */
+void free_loop_children(ir_loop *loop);
+
 /* -------- inline functions -------- */
 
 static inline int _is_ir_loop(const void *thing)
@@ -12,6 +12,7 @@
 #include "irmemory_t.h"
 
 #include "adt/pmap.h"
+#include "adt/set.h"
 #include "debug.h"
 #include "hashptr.h"
 #include "irflag.h"
@@ -19,6 +20,8 @@
 #include "irgraph_t.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
+#include "irnodemap.h"
+#include "obst.h"
 #include "irouts_t.h"
 #include "irprintf.h"
 #include "irprog_t.h"
@@ -474,12 +477,464 @@ leave_type_based_alias:;
 	return ir_may_alias;
 }
 
+/**
+ * A memoized alias query.  The node indices are part of the key: node
+ * memory can be recycled within a pass, but a recycled node gets a
+ * fresh index, so a stale entry can never match it.
+ */
+typedef struct alias_cache_entry_t {
+	const ir_node     *addr1;
+	const ir_node     *addr2;
+	const ir_type     *type1;
+	const ir_type     *type2;
+	unsigned           idx1;
+	unsigned           idx2;
+	unsigned           size1;
+	unsigned           size2;
+	ir_alias_relation  rel;
+} alias_cache_entry_t;
+
+static int cmp_alias_cache_entry(const void *elt, const void *key, size_t size)
+{
+	(void)size;
+	const alias_cache_entry_t *e1 = (const alias_cache_entry_t*)elt;
+	const alias_cache_entry_t *e2 = (const alias_cache_entry_t*)key;
+	return e1->addr1 != e2->addr1 || e1->addr2 != e2->addr2
+	    || e1->type1 != e2->type1 || e1->type2 != e2->type2
+	    || e1->idx1  != e2->idx1  || e1->idx2  != e2->idx2
+	    || e1->size1 != e2->size1 || e1->size2 != e2->size2;
+}
+
+/**
+ * The partition an address belongs to: its canonical base, the storage
+ * class of that base and, where the class implies one, the accessed
+ * entity. Two addresses in provably non-interfering partitions cannot
+ * alias, which lets whole query families short-circuit without a
+ * pairwise cache entry each.
+ */
+typedef struct alias_partition_entry_t {
+	const ir_node            *addr;
+	unsigned                  idx;
+	const ir_node            *base;   /**< result of find_base_addr() */
+	ir_entity                *entity; /**< entity for global/local variables */
+	ir_storage_class_class_t  mod;    /**< classify_pointer() of the base */
+} alias_partition_entry_t;
+
+static int cmp_alias_partition_entry(const void *elt, const void *key,
+                                     size_t size)
+{
+	(void)size;
+	const alias_partition_entry_t *e1 = (const alias_partition_entry_t*)elt;
+	const alias_partition_entry_t *e2 = (const alias_partition_entry_t*)key;
+	return e1->addr != e2->addr || e1->idx != e2->idx;
+}
+
+static alias_partition_entry_t *get_address_partition(set *cache,
+                                                      const ir_node *addr)
+{
+	alias_partition_entry_t query = {
+		.addr = addr, .idx = get_irn_idx(addr),
+	};
+	unsigned const hash = hash_ptr(addr);
+	alias_partition_entry_t *found
+		= set_find(alias_partition_entry_t, cache, &query, sizeof(query), hash);
+	if (found != NULL)
+		return found;
+
+	address_info const info = get_address_info(addr);
+	ir_entity         *ent  = NULL;
+	const ir_node     *base = find_base_addr(info.base, &ent);
+	query.base = base;
+	query.mod  = classify_pointer(info.base, base);
+
+	ir_storage_class_class_t const class = query.mod & ~ir_sc_modifiers;
+	if (class == ir_sc_globalvar) {
+		query.entity = get_Address_entity(base);
+	} else if (class == ir_sc_localvar) {
+		query.entity = get_Member_entity(base);
+	} else {
+		query.entity = NULL;
+	}
+	return set_insert(alias_partition_entry_t, cache, &query, sizeof(query),
+	                  hash);
+}
+
+/**
+ * Checks whether two address partitions can interfere. Returning false
+ * is only allowed where _get_alias_relation() would conclude ir_no_alias
+ * as well; the caller guarantees that the bases differ, which rules out
+ * all of its ir_sure_alias answers.
+ */
+static bool partitions_interfere(const alias_partition_entry_t *p1,
+                                 const alias_partition_entry_t *p2)
+{
+	/* no alias if 1 is a primitive object and the other a compound object */
+	ir_storage_class_class_t const mod1 = p1->mod;
+	ir_storage_class_class_t const mod2 = p2->mod;
+	if (((mod1 | mod2) & (ir_sc_modifier_obj_comp | ir_sc_modifier_obj_prim))
+	    == (ir_sc_modifier_obj_comp | ir_sc_modifier_obj_prim))
+		return false;
+
+	ir_storage_class_class_t const class1 = mod1 & ~ir_sc_modifiers;
+	ir_storage_class_class_t const class2 = mod2 & ~ir_sc_modifiers;
+	if (class1 == ir_sc_pointer || class2 == ir_sc_pointer) {
+		ir_storage_class_class_t const other_class
+			= class1 == ir_sc_pointer ? class2 : class1;
+		ir_storage_class_class_t const other_mod
+			= class1 == ir_sc_pointer ? mod2 : mod1;
+		/* a pointer and an object whose address was never taken */
+		if (other_mod & ir_sc_modifier_nottaken)
+			return false;
+		/* the null pointer aliases nothing */
+		if (other_class == ir_sc_null)
+			return false;
+		return true;
+	}
+	/* objects from different memory spaces cannot alias */
+	if (class1 != class2)
+		return false;
+	/* distinct variables cannot alias */
+	if ((class1 == ir_sc_globalvar || class1 == ir_sc_localvar)
+	    && p1->entity != p2->entity)
+		return false;
+	return true;
+}
+
+/*
+ * Flow-insensitive unification-based points-to analysis.
+ *
+ * Every pointer value of the graph is put into a union-find class
+ * (Steensgaard's scheme, all classes live on one obstack). Copies,
+ * Phis and address arithmetic unify the classes of their operands;
+ * loading and storing a pointer unifies through the pointed-to class;
+ * and every value that leaves the analysis' sight - call arguments,
+ * returned pointers, int/pointer conversion, incoming arguments and
+ * the contents of global variables - is unified with one distinguished
+ * unknown class whose edges are self-loops.
+ *
+ * Afterwards two addresses in different classes cannot reference the
+ * same object: any value flow that could let them meet would have
+ * unified the classes. This decides queries the pairwise base-address
+ * check cannot, most notably pointers loaded behind distinct
+ * allocation sites or distinct non-escaping variables.
+ */
+typedef struct pts_class_t pts_class_t;
+struct pts_class_t {
+	pts_class_t *parent;  /**< union-find parent, the root points to itself */
+	pts_class_t *pts;     /**< class of the objects values here point into */
+	bool         unknown; /**< true for the class of escaped values */
+};
+
+typedef struct pts_env_t {
+	struct obstack obst;
+	ir_nodemap     node_class;   /**< pointer value -> its class */
+	pmap          *entity_class; /**< shared class per addressed entity */
+	pts_class_t   *unknown;
+} pts_env_t;
+
+static pts_class_t *pts_new_class(pts_env_t *env)
+{
+	pts_class_t *cls = OALLOCZ(&env->obst, pts_class_t);
+	cls->parent = cls;
+	return cls;
+}
+
+static pts_class_t *pts_find(pts_class_t *cls)
+{
+	/* path halving */
+	while (cls->parent != cls) {
+		cls->parent = cls->parent->parent;
+		cls         = cls->parent;
+	}
+	return cls;
+}
+
+static pts_class_t *pts_node_class(pts_env_t *env, const ir_node *node)
+{
+	pts_class_t *cls = ir_nodemap_get(pts_class_t, &env->node_class, node);
+	if (cls == NULL) {
+		cls = pts_new_class(env);
+		ir_nodemap_insert(&env->node_class, node, cls);
+	}
+	return pts_find(cls);
+}
+
+/** Returns the class of objects that values in @p cls point into,
+ * creating it on first demand. */
+static pts_class_t *pts_get_pts(pts_env_t *env, pts_class_t *cls)
+{
+	cls = pts_find(cls);
+	if (cls->pts == NULL)
+		cls->pts = pts_new_class(env);
+	return pts_find(cls->pts);
+}
+
+static void pts_unify(pts_class_t *c1, pts_class_t *c2)
+{
+	for (;;) {
+		c1 = pts_find(c1);
+		c2 = pts_find(c2);
+		if (c1 == c2)
+			return;
+		/* keep the unknown class a root so its self-loops survive */
+		if (c2->unknown) {
+			pts_class_t *const t = c1;
+			c1 = c2;
+			c2 = t;
+		}
+		c2->parent   = c1;
+		c1->unknown |= c2->unknown;
+		pts_class_t *const p2 = c2->pts;
+		if (p2 == NULL)
+			return;
+		if (c1->pts == NULL) {
+			c1->pts = p2;
+			return;
+		}
+		/* the pointed-to classes must collapse as well */
+		pts_class_t *const p1 = c1->pts;
+		c1 = p1;
+		c2 = p2;
+	}
+}
+
+/** Walker: apply the unification rules of one node. */
+static void pts_collect(ir_node *node, void *data)
+{
+	pts_env_t *env = (pts_env_t*)data;
+
+	if (is_Call(node) || is_Builtin(node) || is_ASM(node)
+	    || is_Return(node) || is_Raise(node)) {
+		/* pointer arguments escape into the callee (respectively the
+		 * caller), anything may happen to them there */
+		foreach_irn_in(node, i, pred) {
+			if (mode_is_reference(get_irn_mode(pred)))
+				pts_unify(pts_node_class(env, pred), env->unknown);
+		}
+		return;
+	}
+	if (is_Store(node)) {
+		ir_node *const value = get_Store_value(node);
+		if (mode_is_reference(get_irn_mode(value))) {
+			pts_class_t *const obj = pts_get_pts(env,
+				pts_node_class(env, get_Store_ptr(node)));
+			pts_unify(pts_node_class(env, value), pts_get_pts(env, obj));
+		}
+		return;
+	}
+	if (is_CopyB(node)) {
+		/* the copy may transfer pointers stored inside the object */
+		pts_class_t *const src = pts_get_pts(env,
+			pts_node_class(env, get_CopyB_src(node)));
+		pts_class_t *const dst = pts_get_pts(env,
+			pts_node_class(env, get_CopyB_dst(node)));
+		pts_unify(pts_get_pts(env, src), pts_get_pts(env, dst));
+		return;
+	}
+	if (is_Conv(node) || is_Bitcast(node)) {
+		/* int<->pointer laundering is out of sight */
+		ir_node *const op = get_irn_n(node, 0);
+		if (mode_is_reference(get_irn_mode(node)))
+			pts_unify(pts_node_class(env, node), env->unknown);
+		if (mode_is_reference(get_irn_mode(op)))
+			pts_unify(pts_node_class(env, op), env->unknown);
+		return;
+	}
+
+	if (!mode_is_reference(get_irn_mode(node)))
+		return;
+
+	switch (get_irn_opcode(node)) {
+	case iro_Address: {
+		/* all addresses of one entity are pointers to the same object;
+		 * its contents may be set up by an initializer or another
+		 * module, so pointers read from it are out of sight */
+		ir_entity   *const entity = get_Address_entity(node);
+		pts_class_t *const cls    = pts_node_class(env, node);
+		pts_class_t *const shared
+			= pmap_get(pts_class_t, env->entity_class, entity);
+		if (shared == NULL) {
+			pmap_insert(env->entity_class, entity, cls);
+			pts_class_t *const obj = pts_get_pts(env, cls);
+			pts_unify(pts_get_pts(env, obj), env->unknown);
+		} else {
+			pts_unify(cls, shared);
+		}
+		return;
+	}
+
+	case iro_Member:
+	case iro_Sel:
+	case iro_Add:
+	case iro_Sub:
+	case iro_Phi:
+	case iro_Mux:
+	case iro_Confirm:
+	case iro_Id:
+		/* offsets stay within the object, the rest are copies: the
+		 * result may hold any address a pointer operand holds */
+		foreach_irn_in(node, i, pred) {
+			if (mode_is_reference(get_irn_mode(pred)))
+				pts_unify(pts_node_class(env, node),
+				          pts_node_class(env, pred));
+		}
+		return;
+
+	case iro_Proj: {
+		ir_node *const pred = get_Proj_pred(node);
+		if (is_Load(pred)) {
+			pts_class_t *const obj = pts_get_pts(env,
+				pts_node_class(env, get_Load_ptr(pred)));
+			pts_unify(pts_node_class(env, node), pts_get_pts(env, obj));
+		} else if (is_Alloc(pred)) {
+			/* each allocation site is an object of its own */
+			pts_unify(pts_node_class(env, node),
+			          pts_node_class(env, pred));
+		} else if (is_Start(pred)
+		           && node == get_irg_frame(get_irn_irg(node))) {
+			/* the frame is an object of its own (all locals fold into
+			 * it, which only costs precision among themselves) */
+		} else {
+			/* call results, incoming arguments, ... */
+			pts_unify(pts_node_class(env, node), env->unknown);
+		}
+		return;
+	}
+
+	case iro_Const:
+		/* the null pointer references no object at all */
+		return;
+
+	default:
+		pts_unify(pts_node_class(env, node), env->unknown);
+		return;
+	}
+}
+
+static pts_env_t *pts_compute(ir_graph *irg)
+{
+	pts_env_t *env = XMALLOCZ(pts_env_t);
+	obstack_init(&env->obst);
+	ir_nodemap_init(&env->node_class, irg);
+	env->entity_class = pmap_create();
+	env->unknown          = pts_new_class(env);
+	env->unknown->pts     = env->unknown;
+	env->unknown->unknown = true;
+	irg_walk_graph(irg, NULL, pts_collect, env);
+	return env;
+}
+
+static void pts_free(pts_env_t *env)
+{
+	pmap_destroy(env->entity_class);
+	ir_nodemap_destroy(&env->node_class);
+	obstack_free(&env->obst, NULL);
+	free(env);
+}
+
+/**
+ * Checks whether the points-to partition proves that two addresses
+ * cannot reference the same object.
+ */
+static bool pts_no_alias(pts_env_t *env, const ir_node *addr1,
+                         const ir_node *addr2)
+{
+	pts_class_t *const c1
+		= ir_nodemap_get(pts_class_t, &env->node_class, addr1);
+	pts_class_t *const c2
+		= ir_nodemap_get(pts_class_t, &env->node_class, addr2);
+	/* nodes created after the analysis walk are unknown to it. All
+	 * escaped values share the one unknown class, so mere class
+	 * inequality already implies at most one side is out of sight and
+	 * the other provably never meets it. */
+	if (c1 == NULL || c2 == NULL)
+		return false;
+	return pts_find(c1) != pts_find(c2);
+}
+
+void ir_alias_cache_begin(ir_graph *irg)
+{
+	assert(irg->alias_cache == NULL);
+	irg->alias_cache       = new_set(cmp_alias_cache_entry, 512);
+	irg->alias_class_cache = new_set(cmp_alias_partition_entry, 512);
+	irg->pointsto          = pts_compute(irg);
+}
+
+void ir_alias_cache_end(ir_graph *irg)
+{
+	assert(irg->alias_cache != NULL);
+	del_set(irg->alias_cache);
+	del_set(irg->alias_class_cache);
+	pts_free((pts_env_t*)irg->pointsto);
+	irg->alias_cache       = NULL;
+	irg->alias_class_cache = NULL;
+	irg->pointsto          = NULL;
+}
+
 ir_alias_relation get_alias_relation(const ir_node *const addr1, const ir_type *const type1, unsigned size1,
                                      const ir_node *const addr2, const ir_type *const type2, unsigned size2)
 {
+	ir_graph *const irg   = get_irn_irg(addr1);
+	set      *const cache = irg->alias_cache;
+
+	/* Try to decide the query from the address partitions alone: whole
+	 * families of addresses with non-interfering bases short-circuit here
+	 * without a pairwise cache entry each. */
+	if (cache != NULL && addr1 != addr2
+	    && !(get_irg_memory_disambiguator_options(irg) & aa_opt_always_alias)) {
+		alias_partition_entry_t const *const p1
+			= get_address_partition(irg->alias_class_cache, addr1);
+		alias_partition_entry_t const *const p2
+			= get_address_partition(irg->alias_class_cache, addr2);
+		if (p1->base != p2->base && !partitions_interfere(p1, p2)) {
+			DB((dbg, LEVEL_1, "alias(%+F, %+F) = %s (partition)\n", addr1,
+			    addr2, get_ir_alias_relation_name(ir_no_alias)));
+			return ir_no_alias;
+		}
+		/* the base check cannot decide pointer-class addresses, the
+		 * points-to partition often can */
+		if (pts_no_alias((pts_env_t*)irg->pointsto, addr1, addr2)) {
+			DB((dbg, LEVEL_1, "alias(%+F, %+F) = %s (points-to)\n", addr1,
+			    addr2, get_ir_alias_relation_name(ir_no_alias)));
+			return ir_no_alias;
+		}
+	}
+
+	alias_cache_entry_t query;
+	unsigned hash = 0;
+	if (cache != NULL) {
+		/* the relation is symmetric, normalize the pair */
+		query = (alias_cache_entry_t) {
+			.addr1 = addr1, .addr2 = addr2,
+			.type1 = type1, .type2 = type2,
+			.idx1  = get_irn_idx(addr1), .idx2 = get_irn_idx(addr2),
+			.size1 = size1, .size2 = size2,
+		};
+		if (addr2 < addr1) {
+			query = (alias_cache_entry_t) {
+				.addr1 = addr2, .addr2 = addr1,
+				.type1 = type2, .type2 = type1,
+				.idx1  = query.idx2, .idx2 = query.idx1,
+				.size1 = size2, .size2 = size1,
+			};
+		}
+		hash = hash_ptr(query.addr1) * 31 + hash_ptr(query.addr2)
+		     + query.size1 * 7 + query.size2;
+		alias_cache_entry_t *found
+			= set_find(alias_cache_entry_t, cache, &query, sizeof(query), hash);
+		if (found != NULL)
+			return found->rel;
+	}
+
 	ir_alias_relation rel = _get_alias_relation(addr1, type1, size1, addr2, type2, size2);
 	DB((dbg, LEVEL_1, "alias(%+F, %+F) = %s\n", addr1, addr2,
 	    get_ir_alias_relation_name(rel)));
+
+	if (cache != NULL) {
+		query.rel = rel;
+		(void)set_insert(alias_cache_entry_t, cache, &query, sizeof(query),
+		                 hash);
+	}
 	return rel;
 }
 
@@ -22,6 +22,25 @@ void firm_init_memory_disambiguator(void);
 
 bool is_partly_volatile(ir_node *ptr);
 
+/**
+ * Starts memoizing get_alias_relation() answers for @p irg.
+ *
+ * The load/store passes chase the memory def-use chains and ask the
+ * disambiguator about the same address pairs over and over; with the
+ * cache active every pair is analyzed once.  The cache holds bare node
+ * pointers, so it must be dropped with ir_alias_cache_end() before the
+ * pass frees nodes it queried about.
+ *
+ * This also computes a flow-insensitive unification-based points-to
+ * partition of the graph's pointer values, which answers queries about
+ * addresses whose bases the pairwise check cannot relate (pointers
+ * behind distinct allocation sites or non-escaping variables).
+ */
+void ir_alias_cache_begin(ir_graph *irg);
+
+/** Stops memoizing alias queries for @p irg and frees the cache. */
+void ir_alias_cache_end(ir_graph *irg);
+
 /**
  * Classify storage locations.
  * Except ir_sc_pointer they are all disjoint.
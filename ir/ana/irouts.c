@@ -16,6 +16,7 @@
 #include "irgwalk.h"
 #include "irnode_t.h"
 #include "irprog_t.h"
+#include "util.h"
 #include "xmalloc.h"
 
 unsigned get_irn_n_outs(const ir_node *node)
@@ -265,8 +266,9 @@ static void set_out_edges_node(ir_node *node, struct obstack *obst)
 
 	/* Allocate my array */
 	unsigned n_outs = node->o.n_outs;
-	node->o.out          = OALLOCF(obst, ir_def_use_edges, edges, n_outs);
-	node->o.out->n_edges = 0;
+	node->o.out           = OALLOCF(obst, ir_def_use_edges, edges, n_outs);
+	node->o.out->n_edges  = 0;
+	node->o.out->capacity = n_outs;
 
 	/* add def->use edges from my predecessors to me */
 	int start = is_Block(node) ? 0 : -1;
@@ -294,8 +296,9 @@ static void set_out_edges(ir_graph *irg)
 	foreach_irn_in(get_irg_anchor(irg), i, n) {
 		if (irn_visited_else_mark(n))
 			continue;
-		n->o.out          = OALLOCF(obst, ir_def_use_edges, edges, 0);
-		n->o.out->n_edges = 0;
+		n->o.out           = OALLOCF(obst, ir_def_use_edges, edges, 0);
+		n->o.out->n_edges  = 0;
+		n->o.out->capacity = 0;
 	}
 }
 
@@ -311,9 +314,143 @@ void compute_irg_outs(ir_graph *irg)
 	   for each node and writes the back edges into this array. */
 	set_out_edges(irg);
 
+	/* Nodes not reachable from End got no array above.  The incremental
+	   maintenance may encounter them later, e.g. when CSE revives a node,
+	   so give every allocated node at least an empty array. */
+	for (unsigned idx = 0, last = get_irg_last_idx(irg); idx < last; ++idx) {
+		ir_node *node = get_idx_irn(irg, idx);
+		if (node == NULL || irn_visited(node))
+			continue;
+		ir_def_use_edges *out = OALLOCF(&irg->out_obst, ir_def_use_edges,
+		                                edges, 0);
+		out->n_edges  = 0;
+		out->capacity = 0;
+		node->o.out   = out;
+	}
+
 	add_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
 }
 
+/**
+ * Returns whether the outs of @p irg are incrementally maintained, i.e.
+ * whether they are present and consistent.
+ */
+static bool outs_maintained(const ir_graph *irg)
+{
+	return irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
+}
+
+/** Appends the def-use edge (@p use, @p pos) to the out array of @p def. */
+static void add_out_edge(ir_graph *irg, ir_node *def, ir_node *use, int pos)
+{
+	ir_def_use_edges *out = def->o.out;
+	if (out->n_edges == out->capacity) {
+		/* The arrays live back to back on the out obstack and cannot grow
+		 * in place.  Allocate a bigger copy and leak the old one; the
+		 * waste is reclaimed by the next full rebuild. */
+		unsigned capacity = out->capacity * 2 + 2;
+		ir_def_use_edges *new_out
+			= OALLOCF(&irg->out_obst, ir_def_use_edges, edges, capacity);
+		new_out->n_edges  = out->n_edges;
+		new_out->capacity = capacity;
+		MEMCPY(new_out->edges, out->edges, out->n_edges);
+		out        = new_out;
+		def->o.out = out;
+	}
+	unsigned idx = out->n_edges++;
+	out->edges[idx].use = use;
+	out->edges[idx].pos = pos;
+}
+
+/** Removes the def-use edge (@p use, @p pos) from the out array of @p def. */
+static void del_out_edge(ir_graph *irg, ir_node *def, const ir_node *use,
+                         int pos)
+{
+	ir_def_use_edges *out = def->o.out;
+	for (unsigned i = 0, n = out->n_edges; i < n; ++i) {
+		if (out->edges[i].use == use && out->edges[i].pos == pos) {
+			out->edges[i] = out->edges[n - 1];
+			out->n_edges  = n - 1;
+			return;
+		}
+	}
+	/* The edge can be missing when its array was lost, e.g. because the
+	 * node was recycled in between.  Give up on incremental maintenance
+	 * then; the next user rebuilds from scratch. */
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
+}
+
+/** Returns whether the out array of @p def contains (@p use, @p pos). */
+static bool has_out_edge(const ir_node *def, const ir_node *use, int pos)
+{
+	const ir_def_use_edges *out = def->o.out;
+	for (unsigned i = 0, n = out->n_edges; i < n; ++i) {
+		if (out->edges[i].use == use && out->edges[i].pos == pos)
+			return true;
+	}
+	return false;
+}
+
+void irouts_notify_edge(ir_node *src, int pos, ir_node *tgt, ir_node *old_tgt,
+                        ir_graph *irg)
+{
+	if (!outs_maintained(irg))
+		return;
+	if (old_tgt == NULL) {
+		if (tgt != NULL)
+			add_out_edge(irg, tgt, src, pos);
+	} else if (tgt == NULL) {
+		del_out_edge(irg, old_tgt, src, pos);
+	} else if (tgt != old_tgt) {
+		del_out_edge(irg, old_tgt, src, pos);
+		if (outs_maintained(irg))
+			add_out_edge(irg, tgt, src, pos);
+	}
+}
+
+void irouts_node_created(ir_node *node)
+{
+	ir_graph *irg = get_irn_irg(node);
+	if (!outs_maintained(irg))
+		return;
+	ir_def_use_edges *out = OALLOCF(&irg->out_obst, ir_def_use_edges,
+	                                edges, 0);
+	out->n_edges  = 0;
+	out->capacity = 0;
+	node->o.out   = out;
+}
+
+void irouts_node_deleted(ir_node *node)
+{
+	ir_graph *irg = get_irn_irg(node);
+	if (!outs_maintained(irg))
+		return;
+	int start = is_Block(node) ? 0 : -1;
+	for (int i = start, arity = get_irn_arity(node); i < arity; ++i) {
+		ir_node *def = get_irn_n(node, i);
+		if (def == NULL)
+			continue;
+		del_out_edge(irg, def, node, i);
+		if (!outs_maintained(irg))
+			return;
+	}
+}
+
+void irouts_node_revival(ir_node *node)
+{
+	ir_graph *irg = get_irn_irg(node);
+	if (!outs_maintained(irg))
+		return;
+	int start = is_Block(node) ? 0 : -1;
+	for (int i = start, arity = get_irn_arity(node); i < arity; ++i) {
+		ir_node *def = get_irn_n(node, i);
+		if (def == NULL)
+			continue;
+		if (!has_out_edge(def, node, i))
+			add_out_edge(irg, def, node, i);
+	}
+}
+
 void assure_irg_outs(ir_graph *irg)
 {
 	if (!irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS))
@@ -8,6 +8,29 @@
 
 #include "irouts.h"
 
+/**
+ * Incremental maintenance of the out information, mirroring the
+ * edges_notify_edge() scheme of iredges: while a graph has consistent
+ * outs, the in-edge mutators patch the out arrays instead of
+ * invalidating them.  Passes that iterate the out arrays while rewiring
+ * edges must drop IR_GRAPH_PROPERTY_CONSISTENT_OUTS up front to freeze
+ * the arrays into the snapshot they were written against.
+ */
+
+/** Notifies the outs that the edge src[pos], previously pointing to
+ * old_tgt, now points to tgt.  NULL means no edge. */
+void irouts_notify_edge(ir_node *src, int pos, ir_node *tgt, ir_node *old_tgt,
+                        ir_graph *irg);
+
+/** Gives a freshly allocated node an empty out array. */
+void irouts_node_created(ir_node *node);
+
+/** Removes all out entries the in edges of @p node produced. */
+void irouts_node_deleted(ir_node *node);
+
+/** Re-adds the out entries for the in edges of a node revived by CSE. */
+void irouts_node_revival(ir_node *node);
+
 #define foreach_irn_out(irn, idx, succ) \
 	for (bool succ##__b = true; succ##__b;) \
 		for (ir_node const *const succ##__irn = (irn); succ##__b; succ##__b = false) \
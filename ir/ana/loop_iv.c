@@ -0,0 +1,230 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2018 Karlsruhe Institute of Technology
+ */
+
+/**
+ * @file
+ * @brief   Induction variable analysis on the loop tree
+ */
+#include "loop_iv.h"
+
+#include "array.h"
+#include "irdom.h"
+#include "irloop_t.h"
+#include "irnode_t.h"
+#include "irouts.h"
+#include "tv.h"
+#include "util.h"
+#include "xmalloc.h"
+
+/** Follows the trivial Phis LCSSA construction inserts. */
+static ir_node *skip_trivial_phis(ir_node *node)
+{
+	while (is_Phi(node) && get_Phi_n_preds(node) == 1) {
+		node = get_Phi_pred(node, 0);
+	}
+	return node;
+}
+
+/** Returns true if @p node chains back to @p phi through trivial Phis. */
+static bool chains_to_phi(ir_node *node, const ir_node *phi)
+{
+	while (is_Phi(node) && node != phi && get_Phi_n_preds(node) == 1) {
+		node = get_Phi_pred(node, 0);
+	}
+	return node == phi;
+}
+
+bool get_phi_iv(ir_node *phi, loop_iv_t *iv)
+{
+	if (!is_Phi(phi))
+		return false;
+
+	ir_node   *incr = NULL;
+	ir_tarval *init = NULL;
+	ir_tarval *step = NULL;
+	foreach_irn_in(phi, i, pred) {
+		if (is_Const(pred)) {
+			/* a candidate for the initial value; all constant inputs
+			 * must agree */
+			ir_tarval *const tv = get_Const_tarval(pred);
+			if (init != NULL && tarval_cmp(init, tv) != ir_relation_equal)
+				return false;
+			init = tv;
+			continue;
+		}
+
+		ir_node *const value = skip_trivial_phis(pred);
+		if (value == incr) {
+			/* another use of the same increment */
+			continue;
+		}
+		if (incr == NULL && (is_Add(value) || is_Sub(value))) {
+			ir_node *const right = get_binop_right(value);
+			if (!is_Const(right))
+				return false;
+			if (!chains_to_phi(get_binop_left(value), phi))
+				return false;
+			incr = value;
+			step = get_Const_tarval(right);
+			if (is_Sub(value))
+				step = tarval_neg(step);
+			continue;
+		}
+		return false;
+	}
+	if (incr == NULL)
+		return false;
+
+	iv->phi  = phi;
+	iv->incr = incr;
+	iv->init = init;
+	iv->step = step;
+	return true;
+}
+
+static bool is_inner_loop(ir_loop *const outer_loop, ir_loop *inner_loop)
+{
+	ir_loop *old_inner_loop;
+	do {
+		old_inner_loop = inner_loop;
+		inner_loop = get_loop_outer_loop(inner_loop);
+	} while (inner_loop != old_inner_loop && inner_loop != outer_loop);
+	return inner_loop != old_inner_loop;
+}
+
+static bool block_is_inside_loop(ir_node *const block, ir_loop *const loop)
+{
+	ir_loop *const block_loop = get_irn_loop(block);
+	if (block_loop == NULL)
+		return false;
+	return block_loop == loop || is_inner_loop(loop, block_loop);
+}
+
+/** Returns true if @p block dominates all blocks of @p loop. */
+static bool block_dominates_loop(ir_node *const block, ir_loop *const loop)
+{
+	size_t const n_elements = get_loop_n_elements(loop);
+	for (size_t i = 0; i < n_elements; ++i) {
+		loop_element const element = get_loop_element(loop, i);
+		if (*element.kind == k_ir_node) {
+			assert(is_Block(element.node));
+			if (!block_dominates(block, element.node))
+				return false;
+		} else if (*element.kind == k_ir_loop) {
+			if (!block_dominates_loop(block, element.son))
+				return false;
+		}
+	}
+	return true;
+}
+
+ir_node *get_loop_header(ir_loop *const loop)
+{
+	/* pick a random block */
+	ir_node *header = NULL;
+	size_t const n_elements = get_loop_n_elements(loop);
+	for (size_t i = 0; i < n_elements; ++i) {
+		loop_element const element = get_loop_element(loop, i);
+		if (*element.kind == k_ir_node) {
+			header = element.node;
+			break;
+		}
+	}
+	assert(header && is_Block(header));
+
+	/* walk up the dominance tree */
+	ir_node *idom = get_Block_idom(header);
+	while (idom && block_is_inside_loop(idom, loop)) {
+		header = idom;
+		idom   = get_Block_idom(header);
+	}
+
+	return block_dominates_loop(header, loop) ? header : NULL;
+}
+
+/** The induction variables of a loop, cached on its link field. */
+typedef struct loop_iv_info_t {
+	size_t    n_ivs;
+	loop_iv_t ivs[];
+} loop_iv_info_t;
+
+loop_iv_t const *get_loop_ivs(ir_loop *const loop, size_t *const n_ivs)
+{
+	loop_iv_info_t *info = (loop_iv_info_t*)get_loop_link(loop);
+	if (info == NULL) {
+		loop_iv_t *ivs     = NEW_ARR_F(loop_iv_t, 0);
+		ir_node   *header = get_loop_header(loop);
+		if (header != NULL) {
+			unsigned const n_outs = get_irn_n_outs(header);
+			for (unsigned i = 0; i < n_outs; ++i) {
+				ir_node *const node = get_irn_out(header, i);
+				if (!is_Phi(node) || get_nodes_block(node) != header)
+					continue;
+				loop_iv_t iv;
+				if (get_phi_iv(node, &iv))
+					ARR_APP1(loop_iv_t, ivs, iv);
+			}
+		}
+		size_t const n = ARR_LEN(ivs);
+		info = (loop_iv_info_t*)xmalloc(sizeof(*info) + n * sizeof(info->ivs[0]));
+		info->n_ivs = n;
+		MEMCPY(info->ivs, ivs, n);
+		DEL_ARR_F(ivs);
+		set_loop_link(loop, info);
+	}
+	*n_ivs = info->n_ivs;
+	return info->ivs;
+}
+
+void free_loop_ivs(ir_loop *const loop)
+{
+	free(get_loop_link(loop));
+	set_loop_link(loop, NULL);
+	size_t const n_elements = get_loop_n_elements(loop);
+	for (size_t i = 0; i < n_elements; ++i) {
+		loop_element const element = get_loop_element(loop, i);
+		if (*element.kind == k_ir_loop)
+			free_loop_ivs(element.son);
+	}
+}
+
+ir_tarval *get_iv_trip_count(const loop_iv_t *const iv, ir_relation rel,
+                             ir_tarval *limit)
+{
+	if (iv->init == NULL || iv->step == NULL)
+		return NULL;
+	/* only counted exit tests are evaluated */
+	if (rel == ir_relation_less_greater || rel == ir_relation_equal
+	 || (rel & ir_relation_unordered))
+		return NULL;
+
+	ir_tarval *init = iv->init;
+	ir_tarval *step = iv->step;
+	/* normalize: use less or less_equal as relation */
+	if (rel & ir_relation_greater) {
+		ir_tarval *const tmp = init;
+		init  = limit;
+		limit = tmp;
+		step  = tarval_neg(step);
+		rel   = get_inversed_relation(rel);
+	}
+
+	ir_tarval *interval = tarval_sub(limit, init);
+	if (interval == tarval_bad || tarval_is_negative(interval)
+	 || tarval_is_negative(step) || tarval_is_null(step))
+		return NULL;
+
+	ir_tarval *const one = new_tarval_from_long(1, get_tarval_mode(interval));
+	/* normalize: use less_equal as relation */
+	if (!(rel & ir_relation_equal)) {
+		interval = tarval_sub(interval, one);
+		if (tarval_is_negative(interval))
+			return NULL;
+	}
+
+	/* count the first iteration as well */
+	ir_tarval *const count = tarval_add(tarval_div(interval, step), one);
+	return count == tarval_bad ? NULL : count;
+}
@@ -0,0 +1,64 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2018 Karlsruhe Institute of Technology
+ */
+
+/**
+ * @file
+ * @brief   Induction variable analysis on the loop tree
+ *
+ * Discovers affine recurrences (Phi + Add/Sub with constant step) so
+ * strength reduction, loop unrolling and trip count evaluation share
+ * one analysis instead of pattern matching separately.
+ */
+#ifndef FIRM_ANA_LOOP_IV_H
+#define FIRM_ANA_LOOP_IV_H
+
+#include "firm_types.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/** An affine induction variable: phi' = phi + step, starting at init. */
+typedef struct loop_iv_t {
+	ir_node   *phi;  /**< the header Phi carrying the variable */
+	ir_node   *incr; /**< the Add or Sub computing the next value */
+	ir_tarval *init; /**< constant initial value, or NULL if unknown */
+	ir_tarval *step; /**< constant step per iteration; negated for a Sub */
+} loop_iv_t;
+
+/**
+ * Checks whether @p phi is the header Phi of an affine recurrence and
+ * fills @p iv if so.  The increment must be a single Add or Sub with a
+ * constant right-hand side whose other operand chains back to @p phi,
+ * possibly through the trivial Phis LCSSA construction inserts.
+ */
+bool get_phi_iv(ir_node *phi, loop_iv_t *iv);
+
+/**
+ * Returns the header block of @p loop: the unique loop block dominating
+ * all others, or NULL if there is none.
+ * Requires consistent dominance.
+ */
+ir_node *get_loop_header(ir_loop *loop);
+
+/**
+ * Returns the induction variables of @p loop, computing and caching
+ * them on the loop on first use.  @p n_ivs receives their number.
+ * Requires consistent dominance and outs; drop the cache with
+ * free_loop_ivs() before the loop tree or the graph changes.
+ */
+loop_iv_t const *get_loop_ivs(ir_loop *loop, size_t *n_ivs);
+
+/** Frees all induction variable caches in the tree rooted at @p loop. */
+void free_loop_ivs(ir_loop *loop);
+
+/**
+ * Evaluates the trip count of a counted loop running @p iv against the
+ * constant @p limit under the relation @p rel (induction variable on
+ * the left).  Returns the number of executions of the loop body or
+ * NULL if it cannot be determined.
+ */
+ir_tarval *get_iv_trip_count(const loop_iv_t *iv, ir_relation rel,
+                             ir_tarval *limit);
+
+#endif
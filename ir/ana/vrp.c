@@ -32,6 +32,17 @@ typedef struct vrp_env_t {
 	ir_vrp_info *info;
 } vrp_env_t;
 
+/**
+ * A vrp_attr extended with the bookkeeping of the demand-driven engine.
+ * The attribute must stay the first member: the node map hands out
+ * pointers to it.
+ */
+typedef struct vrp_attr_ext {
+	vrp_attr attr;
+	bool     valid;       /**< range information has been computed */
+	bool     in_progress; /**< on the demand-driven recursion stack */
+} vrp_attr_ext;
+
 static vrp_attr *vrp_get_or_set_info(ir_vrp_info *info, const ir_node *node)
 {
 	vrp_attr *attr = ir_nodemap_get(vrp_attr, &info->infos, node);
@@ -39,7 +50,8 @@ static vrp_attr *vrp_get_or_set_info(ir_vrp_info *info, const ir_node *node)
 		ir_mode *mode = get_irn_mode(node);
 		assert(mode_is_int(mode));
 
-		attr = OALLOCZ(&info->obst, vrp_attr);
+		vrp_attr_ext *ext = OALLOCZ(&info->obst, vrp_attr_ext);
+		attr = &ext->attr;
 		attr->range_type   = VRP_UNDEFINED;
 		attr->bits_set     = get_mode_null(mode);
 		attr->bits_not_set = get_mode_all_one(mode);
@@ -468,6 +480,10 @@ static void vrp_first_pass(ir_node *n, void *e)
 	bitset_set(env->visited, get_irn_idx(n));
 
 	vrp_update_node(env->info, n);
+	if (mode_is_int(get_irn_mode(n))) {
+		/* mark the info as memoized for the demand-driven queries */
+		((vrp_attr_ext*)vrp_get_or_set_info(env->info, n))->valid = true;
+	}
 
 	foreach_irn_out_r(n, i, succ) {
 		if (bitset_is_set(env->visited, get_irn_idx(succ))) {
@@ -477,6 +493,30 @@ static void vrp_first_pass(ir_node *n, void *e)
 	}
 }
 
+/**
+ * Demand-driven computation of the vrp information of a node: computes
+ * the operands along the SSA def chain first, then evaluates the node
+ * once. Cycles through Phi nodes are cut off; the nodes on the cycle
+ * keep their conservative information.
+ */
+static void vrp_compute_rec(ir_vrp_info *info, ir_node *node)
+{
+	if (!mode_is_int(get_irn_mode(node)))
+		return;
+
+	vrp_attr_ext *ext = (vrp_attr_ext*)vrp_get_or_set_info(info, node);
+	if (ext->valid || ext->in_progress)
+		return;
+
+	ext->in_progress = true;
+	foreach_irn_in(node, i, pred) {
+		vrp_compute_rec(info, pred);
+	}
+	(void)vrp_update_node(info, node);
+	ext->in_progress = false;
+	ext->valid       = true;
+}
+
 static void dump_vrp_info(void *ctx, FILE *F, const ir_node *node)
 {
 	(void)ctx;
@@ -498,22 +538,48 @@ static void dump_vrp_info(void *ctx, FILE *F, const ir_node *node)
 
 static hook_entry_t dump_hook;
 
-void set_vrp_data(ir_graph *irg)
+/**
+ * Sets up an empty vrp info store on the graph.
+ */
+static void vrp_init_infos(ir_graph *irg)
 {
-	if (irg->vrp.infos.data != NULL)
-		free_vrp_data(irg);
-
 	FIRM_DBG_REGISTER(dbg, "ir.ana.vrp");
 
-	assure_irg_outs(irg); /* ensure that out edges are consistent*/
 	ir_nodemap_init(&irg->vrp.infos, irg);
 	obstack_init(&irg->vrp.obst);
-	ir_vrp_info *info = &irg->vrp;
 
 	if (dump_hook.hook._hook_node_info == NULL) {
 		dump_hook.hook._hook_node_info = dump_vrp_info;
 		register_hook(hook_node_info, &dump_hook);
 	}
+}
+
+void vrp_init_data(ir_graph *irg)
+{
+	if (irg->vrp.infos.data != NULL)
+		free_vrp_data(irg);
+	vrp_init_infos(irg);
+}
+
+vrp_attr *vrp_get_or_compute_info(const ir_node *node)
+{
+	ir_graph *irg = get_irn_irg(node);
+	if (irg->vrp.infos.data == NULL)
+		return NULL;
+	if (!mode_is_int(get_irn_mode(node)))
+		return NULL;
+	vrp_compute_rec(&irg->vrp, (ir_node*)node);
+	return ir_nodemap_get(vrp_attr, &irg->vrp.infos, node);
+}
+
+void set_vrp_data(ir_graph *irg)
+{
+	if (irg->vrp.infos.data != NULL)
+		free_vrp_data(irg);
+
+	assure_irg_outs(irg); /* ensure that out edges are consistent*/
+	vrp_init_infos(irg);
+	ir_vrp_info *info = &irg->vrp;
 
 	vrp_env_t *env = OALLOCZ(&irg->vrp.obst, vrp_env_t);
 	env->info      = info;
@@ -550,8 +616,8 @@ ir_relation vrp_cmp(const ir_node *left, const ir_node *right)
 	if (!mode_is_int(get_irn_mode(left)))
 		return ir_relation_true;
 
-	vrp_attr *vrp_left  = vrp_get_info(left);
-	vrp_attr *vrp_right = vrp_get_info(right);
+	vrp_attr *vrp_left  = vrp_get_or_compute_info(left);
+	vrp_attr *vrp_right = vrp_get_or_compute_info(right);
 	if (vrp_left == NULL || vrp_right == NULL)
 		return ir_relation_true;
 
@@ -11,6 +11,7 @@
 #include "amd64_bearch_t.h"
 
 #include "amd64_emitter.h"
+#include "amd64_encode.h"
 #include "amd64_finish.h"
 #include "amd64_new_nodes.h"
 #include "amd64_optimize.h"
@@ -600,7 +601,7 @@ int amd64_get_sp_change(ir_node *const node)
 /**
  * Called immediately before emit phase.
  */
-static void amd64_finish_and_emit(ir_graph *irg)
+static void amd64_before_emit(ir_graph *irg)
 {
 	amd64_irg_data_t const *const irg_data = amd64_get_irg_data(irg);
 	bool                    const omit_fp  = irg_data->omit_fp;
@@ -633,11 +634,6 @@ static void amd64_finish_and_emit(ir_graph *irg)
 	amd64_simulate_graph_x87(irg);
 
 	amd64_peephole_optimization(irg);
-
-	/* emit code */
-	be_timer_push(T_EMIT);
-	amd64_emit_function(irg);
-	be_timer_pop(T_EMIT);
 }
 
 static void amd64_finish(void)
@@ -652,6 +648,30 @@ static const regalloc_if_t amd64_regalloc_if = {
 	.new_reload  = amd64_new_reload,
 };
 
+static bool lower_for_emit(ir_graph *const irg, const unsigned *const sp_is_non_ssa)
+{
+	if (!be_step_first(irg))
+		return false;
+
+	struct obstack *obst = be_get_be_obst(irg);
+	be_birg_from_irg(irg)->isa_link = OALLOCZ(obst, amd64_irg_data_t);
+
+	be_birg_from_irg(irg)->non_ssa_regs = sp_is_non_ssa;
+	amd64_select_instructions(irg);
+
+	be_step_schedule(irg);
+
+	be_timer_push(T_RA_PREPARATION);
+	be_sched_fix_flags(irg, &amd64_reg_classes[CLASS_amd64_flags], NULL,
+	                   NULL, NULL);
+	be_timer_pop(T_RA_PREPARATION);
+
+	be_step_regalloc(irg, &amd64_regalloc_if);
+
+	amd64_before_emit(irg);
+	return true;
+}
+
 static void amd64_generate_code(FILE *output, const char *cup_name)
 {
 	amd64_constants = pmap_create();
@@ -660,31 +680,38 @@ static void amd64_generate_code(FILE *output, const char *cup_name)
 	rbitset_set(sp_is_non_ssa, REG_RSP);
 
 	foreach_irp_irg(i, irg) {
-		if (!be_step_first(irg))
+		if (!lower_for_emit(irg, sp_is_non_ssa))
 			continue;
 
-		struct obstack *obst = be_get_be_obst(irg);
-		be_birg_from_irg(irg)->isa_link = OALLOCZ(obst, amd64_irg_data_t);
+		be_timer_push(T_EMIT);
+		amd64_emit_function(irg);
+		be_timer_pop(T_EMIT);
 
-		be_birg_from_irg(irg)->non_ssa_regs = sp_is_non_ssa;
-		amd64_select_instructions(irg);
+		be_step_last(irg);
+	}
 
-		be_step_schedule(irg);
+	be_finish();
+	pmap_destroy(amd64_constants);
+}
 
-		be_timer_push(T_RA_PREPARATION);
-		be_sched_fix_flags(irg, &amd64_reg_classes[CLASS_amd64_flags], NULL,
-		                   NULL, NULL);
-		be_timer_pop(T_RA_PREPARATION);
+static ir_jit_function_t *amd64_jit_compile(ir_jit_segment_t *const segment,
+                                            ir_graph *const irg)
+{
+	if (amd64_constants == NULL)
+		amd64_constants = pmap_create();
 
-		be_step_regalloc(irg, &amd64_regalloc_if);
+	unsigned *const sp_is_non_ssa = rbitset_alloca(N_AMD64_REGISTERS);
+	rbitset_set(sp_is_non_ssa, REG_RSP);
 
-		amd64_finish_and_emit(irg);
+	if (!lower_for_emit(irg, sp_is_non_ssa))
+		return NULL;
 
-		be_step_last(irg);
-	}
+	be_timer_push(T_EMIT);
+	ir_jit_function_t *const res = amd64_emit_jit(segment, irg);
+	be_timer_pop(T_EMIT);
 
-	be_finish();
-	pmap_destroy(amd64_constants);
+	be_step_last(irg);
+	return res;
 }
 
 static const ir_settings_arch_dep_t amd64_arch_dep = {
@@ -740,7 +767,9 @@ static void amd64_lower_for_target(void)
 		 * CopyBs into memcpy calls, because we cannot handle CopyB nodes
 		 * during code generation yet.
 		 * TODO:  Adapt this once custom CopyB handling is implemented. */
-		lower_CopyB(irg, 64, 65, true);
+		lower_CopyB(irg, ir_target.copyb_max_small_size,
+		            ir_target.copyb_min_large_size,
+		            ir_target.fast_unaligned_memaccess);
 		be_after_transform(irg, "lower-copyb");
 	}
 
@@ -779,6 +808,16 @@ static void amd64_init(void)
 	ir_target.experimental = "the amd64 backend is experimental and unfinished (consider the ia32 backend)";
 	ir_target.fast_unaligned_memaccess = true;
 	ir_target.float_int_overflow       = ir_overflow_indefinite;
+	/* deep out-of-order pipelines pay more for a mispredicted branch */
+	ir_target.branch_mispredict_penalty = 15;
+	/* reg-reg xchg exists but is microcoded on modern cores */
+	ir_target.register_swap_cost       = 2;
+	/* expand block copies with 16byte movdqu instead of scalar moves */
+	ir_target.mode_vector_copy         = amd64_mode_xmm;
+	ir_target.copyb_max_small_size     = 64;
+	ir_target.copyb_min_large_size     = 65;
+	/* prefer an inline copy loop over a memcpy call for moderate sizes */
+	ir_target.copyb_loop_max_size      = 512;
 }
 
 static unsigned amd64_get_op_estimated_cost(const ir_node *node)
@@ -823,14 +862,18 @@ arch_isa_if_t const amd64_isa_if = {
 	.init                  = amd64_init,
 	.finish                = amd64_finish,
 	.generate_code         = amd64_generate_code,
+	.jit_compile           = amd64_jit_compile,
+	.emit_function         = amd64_emit_jit_function,
+	.elf_machine           = 62, /* EM_X86_64 */
+	.get_elf_reloc_type    = amd64_get_elf_reloc_type,
+	.emit_nops             = amd64_emit_nops,
 	.lower_for_target      = amd64_lower_for_target,
 	.additional_reg_names  = amd64_additional_reg_names,
 	.handle_intrinsics     = amd64_handle_intrinsics,
 	.get_op_estimated_cost = amd64_get_op_estimated_cost,
 };
 
-BE_REGISTER_MODULE_CONSTRUCTOR(be_init_arch_amd64)
-void be_init_arch_amd64(void)
+static void register_amd64_options(void)
 {
 	static const lc_opt_table_entry_t options[] = {
 		LC_OPT_ENT_BOOL("no-red-zone", "gcc compatibility",                &amd64_use_red_zone),
@@ -839,6 +882,12 @@ void be_init_arch_amd64(void)
 	lc_opt_entry_t *be_grp    = lc_opt_get_grp(firm_opt_get_root(), "be");
 	lc_opt_entry_t *amd64_grp = lc_opt_get_grp(be_grp, "amd64");
 	lc_opt_add_table(amd64_grp, options);
+}
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_arch_amd64)
+void be_init_arch_amd64(void)
+{
+	be_register_module_options(register_amd64_options);
 
 	amd64_init_transform();
 }
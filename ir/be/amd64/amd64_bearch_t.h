@@ -46,6 +46,10 @@ x86_cconv_t *amd64_decide_calling_convention(ir_type *function_type,
 
 int amd64_get_sp_change(ir_node *const node);
 
+/** Returns true if @p reg is preserved across calls by the calling
+ * convention. */
+bool amd64_register_is_callee_save(const arch_register_t *reg);
+
 void amd64_cconv_init(void);
 
 void amd64_adjust_pic(ir_graph *irg);
@@ -70,6 +70,11 @@ static const arch_register_t* const x87_result_regs[] = {
 static unsigned default_caller_saves[BITSET_SIZE_ELEMS(N_AMD64_REGISTERS)];
 static unsigned default_callee_saves[BITSET_SIZE_ELEMS(N_AMD64_REGISTERS)];
 
+bool amd64_register_is_callee_save(const arch_register_t *reg)
+{
+	return rbitset_is_set(default_callee_saves, reg->global_index);
+}
+
 static void check_omit_fp(ir_node *node, void *env)
 {
 	/* omit-fp is not possible if:
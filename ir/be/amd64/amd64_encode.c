@@ -0,0 +1,784 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2016 Matthias Braun
+ */
+
+/**
+ * @file
+ * @brief       amd64 binary encoding/emission
+ *
+ * Direct machine code output for the be_jit infrastructure. So far only the
+ * core instruction set needed for jitting simple functions has hand written
+ * encoders; everything else falls through to the missing-emitter panic in
+ * be_emit_node(). Full coverage needs encode annotations in amd64_spec.pl
+ * and generator support like the ia32 backend has.
+ */
+#include "amd64_encode.h"
+
+#include "amd64_bearch_t.h"
+#include "amd64_new_nodes.h"
+#include "bearch.h"
+#include "beblocksched.h"
+#include "beemithlp.h"
+#include "bejit.h"
+#include "benode.h"
+#include "besched.h"
+#include "execfreq.h"
+#include "gen_amd64_regalloc_if.h"
+#include "irnodehashmap.h"
+#include "panic.h"
+#include "x86_node.h"
+#include <stdint.h>
+#include <string.h>
+
+static ir_nodehashmap_t block_fragmentnum;
+
+/** Returns the encoding for a pnc field. */
+static unsigned char pnc2cc(x86_condition_code_t cc)
+{
+	return cc & 0xf;
+}
+
+/** The mod encoding of the ModR/M */
+enum Mod {
+	MOD_IND          = 0x00, /**< [reg1] */
+	MOD_IND_BYTE_OFS = 0x40, /**< [reg1 + byte ofs] */
+	MOD_IND_WORD_OFS = 0x80, /**< [reg1 + word ofs] */
+	MOD_REG          = 0xC0  /**< reg1 */
+};
+
+/** create R/M encoding for ModR/M */
+static uint8_t ENC_RM(unsigned const regnum)
+{
+	return regnum;
+}
+
+/** create REG encoding for ModR/M */
+static uint8_t ENC_REG(unsigned const regnum)
+{
+	return regnum << 3;
+}
+
+/** create encoding for a SIB byte */
+static uint8_t ENC_SIB(uint8_t scale, uint8_t index, uint8_t base)
+{
+	return scale << 6 | index << 3 | base;
+}
+
+static bool is_8bit_val(int32_t const v)
+{
+	return -128 <= v && v <= 127;
+}
+
+/**
+ * Emit a REX prefix. @p w selects 64bit operand size, the other arguments
+ * are the full 4bit encodings of the registers in the ModR/M reg and r/m
+ * field and the SIB index. The prefix is omitted if no bit is set.
+ */
+static void enc_rex(unsigned const w, unsigned const reg, unsigned const rm,
+                    unsigned const index)
+{
+	unsigned const rex
+		= w << 3 | (reg >> 3) << 2 | (index >> 3) << 1 | rm >> 3;
+	if (rex != 0)
+		be_emit8(0x40 | rex);
+}
+
+/** Emit a 32bit immediate, possibly as a relocation to an entity. */
+static void enc_relocation(x86_imm32_t const *const imm)
+{
+	ir_entity *entity = imm->entity;
+	int32_t    offset = imm->offset;
+	if (entity == NULL) {
+		be_emit32(offset);
+		return;
+	}
+
+	be_emit_reloc_entity(4, imm->kind, entity, offset);
+}
+
+static void enc_jmp_destination(ir_node const *const cfop)
+{
+	assert(get_irn_mode(cfop) == mode_X);
+	ir_node const *const dest_block = be_emit_get_cfop_target(cfop);
+	unsigned const fragment_num
+		= PTR_TO_INT(ir_nodehashmap_get(void, &block_fragmentnum, dest_block));
+	be_emit_reloc_fragment(4, AMD64_RELOCATION_RELJUMP, fragment_num, -4);
+}
+
+/* end emit routines, all emitters following here should only use the
+   functions above. */
+
+/** Create a ModR/M byte for src1,src2 registers */
+static void enc_modrr(const arch_register_t *src1,
+                      const arch_register_t *src2)
+{
+	unsigned char modrm = MOD_REG;
+	modrm |= ENC_RM(src1->encoding & 0x07);
+	modrm |= ENC_REG(src2->encoding & 0x07);
+	be_emit8(modrm);
+}
+
+/** Create a ModR/M byte for one register and extension */
+static void enc_modru(const arch_register_t *reg, unsigned ext)
+{
+	unsigned char modrm = MOD_REG;
+	assert(ext <= 7);
+	modrm |= ENC_RM(reg->encoding & 0x07);
+	modrm |= ENC_REG(ext);
+	be_emit8(modrm);
+}
+
+static void enc_segment_prefix(x86_addr_t const *const addr)
+{
+	switch ((x86_segment_selector_t)addr->segment) {
+	case X86_SEGMENT_DEFAULT:
+		return;
+	case X86_SEGMENT_FS: be_emit8(0x64); return;
+	case X86_SEGMENT_GS: be_emit8(0x65); return;
+	case X86_SEGMENT_CS:
+	case X86_SEGMENT_SS:
+	case X86_SEGMENT_DS:
+	case X86_SEGMENT_ES:
+		break;
+	}
+	panic("unexpected segment prefix");
+}
+
+/**
+ * Emit the REX prefix of an instruction whose r/m operand is described by
+ * @p addr. @p force emits the prefix even if no bit is set, which is
+ * needed to access sil/dil/bpl/spl in 8bit operations.
+ */
+static void enc_rex_rm(unsigned const w, unsigned const reg, bool const force,
+                       ir_node const *const node, x86_addr_t const *const addr)
+{
+	unsigned rm    = 0;
+	unsigned index = 0;
+	if (addr->variant == X86_ADDR_REG) {
+		rm = arch_get_irn_register_in(node, addr->base_input)->encoding;
+	} else {
+		if (x86_addr_variant_has_base(addr->variant))
+			rm = arch_get_irn_register_in(node, addr->base_input)->encoding;
+		if (x86_addr_variant_has_index(addr->variant))
+			index = arch_get_irn_register_in(node, addr->index_input)->encoding;
+	}
+	unsigned const rex
+		= w << 3 | (reg >> 3) << 2 | (index >> 3) << 1 | rm >> 3;
+	if (rex != 0 || force)
+		be_emit8(0x40 | rex);
+}
+
+/**
+ * Emit a memory address mode.
+ *
+ * @param reg   content of the reg field: either a register index or an
+ *              opcode extension
+ * @param node  the node
+ * @param addr  the address
+ */
+static void enc_mod_am(unsigned const reg, ir_node const *const node,
+                       x86_addr_t const *const addr)
+{
+	x86_addr_variant_t const variant = addr->variant;
+	ir_entity const   *const entity  = addr->immediate.entity;
+	int32_t            const offset  = addr->immediate.offset;
+	assert(variant != X86_ADDR_INVALID && variant != X86_ADDR_REG);
+
+	if (variant == X86_ADDR_RIP) {
+		/* mod=00 with r/m=101 selects RIP relative addressing in 64bit
+		 * mode. The displacement is relative to the end of the
+		 * instruction, which the encoders arrange to be the end of the
+		 * displacement itself. */
+		be_emit8(MOD_IND | ENC_RM(0x05) | ENC_REG(reg & 0x07));
+		be_emit_reloc_entity(4, X86_IMM_PCREL, (ir_entity*)entity, offset - 4);
+		return;
+	}
+
+	/* set the mod part depending on displacement */
+	unsigned modrm    = 0;
+	unsigned emitoffs = 0;
+	if (entity) {
+		modrm |= MOD_IND_WORD_OFS;
+		emitoffs = 32;
+	} else if (offset == 0) {
+		modrm |= MOD_IND;
+		emitoffs = 0;
+	} else if (is_8bit_val(offset)) {
+		modrm |= MOD_IND_BYTE_OFS;
+		emitoffs = 8;
+	} else {
+		modrm |= MOD_IND_WORD_OFS;
+		emitoffs = 32;
+	}
+
+	unsigned base_enc;
+	if (x86_addr_variant_has_base(variant)) {
+		arch_register_t const *const base_reg
+			= arch_get_irn_register_in(node, addr->base_input);
+		base_enc = base_reg->encoding;
+	} else {
+		/* Use the RBP encoding + MOD_IND if NO base register. There is
+		 * always a 32bit offset present in this case. */
+		modrm    = MOD_IND;
+		base_enc = 0x05;
+		emitoffs = 32;
+	}
+
+	/* Determine if we need a SIB byte. */
+	bool     emitsib = false;
+	unsigned sib     = 0;
+	if (x86_addr_variant_has_index(variant)) {
+		arch_register_t const *const reg_index
+			= arch_get_irn_register_in(node, addr->index_input);
+		unsigned const index_enc = reg_index->encoding;
+		/* R/M set to RSP means SIB in 64bit mode. */
+		modrm  |= ENC_RM(0x04);
+		sib     = ENC_SIB(addr->log_scale, index_enc & 0x07, base_enc & 0x07);
+		emitsib = true;
+	} else if ((base_enc & 0x07) == 0x04) {
+		/* for the above reason we are forced to emit a SIB when base is
+		 * RSP/R12. Only the base is used, index must be RSP too, which
+		 * means no index. */
+		modrm  |= ENC_RM(0x04);
+		sib     = ENC_SIB(0, 0x04, base_enc & 0x07);
+		emitsib = true;
+	} else if (!x86_addr_variant_has_base(variant)) {
+		/* Plain disp32 needs a SIB byte in 64bit mode, as mod=00 with
+		 * r/m=101 selects RIP relative addressing instead. */
+		modrm  |= ENC_RM(0x04);
+		sib     = ENC_SIB(0, 0x04, 0x05);
+		emitsib = true;
+	} else {
+		modrm |= ENC_RM(base_enc & 0x07);
+	}
+
+	/* We are forced to emit an 8bit offset as RBP/R13 base without offset
+	 * is a special case (no base register resp. RIP relative). */
+	if (x86_addr_variant_has_base(variant) && (base_enc & 0x07) == 0x05
+	 && emitoffs == 0) {
+		modrm    |= MOD_IND_BYTE_OFS;
+		emitoffs  = 8;
+	}
+
+	modrm |= ENC_REG(reg & 0x07);
+
+	be_emit8(modrm);
+	if (emitsib)
+		be_emit8(sib);
+
+	/* emit displacement */
+	if (emitoffs == 8) {
+		be_emit8((unsigned)offset);
+	} else if (emitoffs == 32) {
+		enc_relocation(&addr->immediate);
+	}
+}
+
+/** Emit the r/m operand of @p node: a plain register or a memory operand. */
+static void enc_rm(unsigned const reg, ir_node const *const node,
+                   x86_addr_t const *const addr)
+{
+	if (addr->variant == X86_ADDR_REG) {
+		arch_register_t const *const rm_reg
+			= arch_get_irn_register_in(node, addr->base_input);
+		be_emit8(MOD_REG | ENC_RM(rm_reg->encoding & 0x07)
+		         | ENC_REG(reg & 0x07));
+	} else {
+		enc_mod_am(reg, node, addr);
+	}
+}
+
+static void enc_copy(const ir_node *copy)
+{
+	arch_register_t       const *const in  = arch_get_irn_register_in(copy, 0);
+	arch_register_t       const *const out = arch_get_irn_register_out(copy, 0);
+	arch_register_class_t const *const cls = out->cls;
+
+	if (in == out)
+		return;
+
+	if (cls == &amd64_reg_classes[CLASS_amd64_gp]) {
+		enc_rex(1, out->encoding, in->encoding, 0);
+		be_emit8(0x8B); // mov %in, %out
+		enc_modrr(in, out);
+	} else if (cls == &amd64_reg_classes[CLASS_amd64_xmm]) {
+		be_emit8(0x66); // movapd %in, %out
+		enc_rex(0, out->encoding, in->encoding, 0);
+		be_emit8(0x0F);
+		be_emit8(0x28);
+		enc_modrr(in, out);
+	} else if (cls == &amd64_reg_classes[CLASS_amd64_x87]) {
+		/* nothing to do */
+	} else {
+		panic("move not supported for this register class");
+	}
+}
+
+static void enc_xmm_pxor(arch_register_t const *const dst,
+                         arch_register_t const *const src)
+{
+	be_emit8(0x66);
+	enc_rex(0, dst->encoding, src->encoding, 0);
+	be_emit8(0x0F);
+	be_emit8(0xEF);
+	enc_modrr(src, dst);
+}
+
+static void enc_perm(const ir_node *node)
+{
+	arch_register_t       const *const reg0 = arch_get_irn_register_out(node, 0);
+	arch_register_t       const *const reg1 = arch_get_irn_register_out(node, 1);
+	arch_register_class_t const *const cls  = reg0->cls;
+
+	assert(cls == reg1->cls && "Register class mismatch at Perm");
+
+	if (cls == &amd64_reg_classes[CLASS_amd64_gp]) {
+		enc_rex(1, reg0->encoding, reg1->encoding, 0);
+		be_emit8(0x87); // xchg %reg0, %reg1
+		enc_modrr(reg1, reg0);
+	} else if (cls == &amd64_reg_classes[CLASS_amd64_xmm]) {
+		enc_xmm_pxor(reg0, reg1);
+		enc_xmm_pxor(reg1, reg0);
+		enc_xmm_pxor(reg0, reg1);
+	} else {
+		panic("unexpected register class in be_Perm (%+F)", node);
+	}
+}
+
+static void enc_incsp(const ir_node *node)
+{
+	int offs = be_get_IncSP_offset(node);
+	if (offs == 0)
+		return;
+
+	unsigned ext;
+	if (offs > 0) {
+		ext = 5; /* sub */
+	} else {
+		ext = 0; /* add */
+		offs = -offs;
+	}
+
+	const arch_register_t *reg = arch_get_irn_register_out(node, 0);
+	enc_rex(1, ext, reg->encoding, 0);
+
+	bool const imm8b = is_8bit_val(offs);
+	be_emit8(imm8b ? 0x83 : 0x81);
+	enc_modru(reg, ext);
+
+	if (imm8b) {
+		be_emit8(offs);
+	} else {
+		be_emit32(offs);
+	}
+}
+
+static void enc_mov_imm(const ir_node *node)
+{
+	amd64_movimm_attr_t const *const attr = get_amd64_movimm_attr_const(node);
+	arch_register_t     const *const out  = arch_get_irn_register_out(node, 0);
+	amd64_imm64_t       const *const imm  = &attr->immediate;
+	unsigned            const out_enc     = out->encoding;
+
+	if (attr->base.size == X86_SIZE_64) {
+		enc_rex(1, 0, out_enc, 0);
+		be_emit8(0xB8 + (out_enc & 0x07)); // movabs $imm, %out
+		if (imm->entity != NULL) {
+			assert(imm->offset == (int32_t)imm->offset);
+			be_emit_reloc_entity(8, AMD64_RELOCATION_ABS64, imm->entity,
+			                     imm->offset);
+		} else {
+			be_emit64((uint64_t)imm->offset);
+		}
+	} else {
+		assert(attr->base.size == X86_SIZE_32);
+		enc_rex(0, 0, out_enc, 0);
+		be_emit8(0xB8 + (out_enc & 0x07)); // mov $imm, %out
+		if (imm->entity != NULL) {
+			assert(imm->offset == (int32_t)imm->offset);
+			be_emit_reloc_entity(4, imm->kind, imm->entity, imm->offset);
+		} else {
+			be_emit32((uint32_t)imm->offset);
+		}
+	}
+}
+
+static void enc_lea(const ir_node *node)
+{
+	amd64_addr_attr_t const *const attr = get_amd64_addr_attr_const(node);
+	arch_register_t   const *const out  = arch_get_irn_register_out(node, 0);
+	x86_addr_t        const *const addr = &attr->addr;
+
+	enc_rex_rm(attr->base.size == X86_SIZE_64, out->encoding, false, node,
+	           addr);
+	be_emit8(0x8D); // lea addr, %out
+	enc_mod_am(out->encoding, node, addr);
+}
+
+static void enc_mov_gp(const ir_node *node)
+{
+	amd64_addr_attr_t const *const attr = get_amd64_addr_attr_const(node);
+	arch_register_t   const *const out  = arch_get_irn_register_out(node, 0);
+	x86_addr_t        const *const addr = &attr->addr;
+	unsigned          const out_enc     = out->encoding;
+
+	enc_segment_prefix(addr);
+	switch (attr->base.size) {
+	case X86_SIZE_8: // movzb
+		enc_rex_rm(0, out_enc, false, node, addr);
+		be_emit8(0x0F);
+		be_emit8(0xB6);
+		break;
+	case X86_SIZE_16: // movzw
+		enc_rex_rm(0, out_enc, false, node, addr);
+		be_emit8(0x0F);
+		be_emit8(0xB7);
+		break;
+	case X86_SIZE_32: // movl
+		enc_rex_rm(0, out_enc, false, node, addr);
+		be_emit8(0x8B);
+		break;
+	case X86_SIZE_64: // movq
+		enc_rex_rm(1, out_enc, false, node, addr);
+		be_emit8(0x8B);
+		break;
+	case X86_SIZE_80:
+	case X86_SIZE_128:
+		panic("invalid insn size");
+	}
+	enc_rm(out_enc, node, addr);
+}
+
+static void enc_mov_store(const ir_node *node)
+{
+	amd64_binop_addr_attr_t const *const attr
+		= get_amd64_binop_addr_attr_const(node);
+	x86_addr_t      const *const addr = &attr->base.addr;
+	x86_insn_size_t const        size = attr->base.base.size;
+
+	enc_segment_prefix(addr);
+	if (attr->base.base.op_mode == AMD64_OP_ADDR_REG) {
+		arch_register_t const *const val
+			= arch_get_irn_register_in(node, attr->u.reg_input);
+		unsigned const val_enc = val->encoding;
+		if (size == X86_SIZE_16)
+			be_emit8(0x66);
+		enc_rex_rm(size == X86_SIZE_64, val_enc,
+		           size == X86_SIZE_8 && val_enc >= 4, node, addr);
+		be_emit8(size == X86_SIZE_8 ? 0x88 : 0x89); // mov %val, addr
+		enc_rm(val_enc, node, addr);
+	} else {
+		assert(attr->base.base.op_mode == AMD64_OP_ADDR_IMM);
+		/* The pcrel displacement would have to account for the trailing
+		 * immediate. */
+		if (addr->variant == X86_ADDR_RIP)
+			panic("RIP relative store with immediate not supported");
+		if (size == X86_SIZE_16)
+			be_emit8(0x66);
+		enc_rex_rm(size == X86_SIZE_64, 0, false, node, addr);
+		be_emit8(size == X86_SIZE_8 ? 0xC6 : 0xC7); // mov $imm, addr
+		enc_rm(0, node, addr);
+		switch (size) {
+		case X86_SIZE_8:  be_emit8(attr->u.immediate.offset);  break;
+		case X86_SIZE_16: be_emit16(attr->u.immediate.offset); break;
+		default:          enc_relocation(&attr->u.immediate);  break;
+		}
+	}
+}
+
+static void enc_call(ir_node const *const node)
+{
+	amd64_addr_attr_t const *const attr = get_amd64_addr_attr_const(node);
+	switch ((amd64_op_mode_t)attr->base.op_mode) {
+	case AMD64_OP_IMM32: {
+		x86_imm32_t const *const imm = &attr->addr.immediate;
+		assert(imm->kind == X86_IMM_PCREL);
+		be_emit8(0xE8);
+		x86_imm32_t const call_imm = {
+			.kind   = X86_IMM_PCREL,
+			.entity = imm->entity,
+			.offset = imm->offset - 4,
+		};
+		enc_relocation(&call_imm);
+		return;
+	}
+	case AMD64_OP_REG:
+	case AMD64_OP_ADDR:
+		enc_segment_prefix(&attr->addr);
+		enc_rex_rm(0, 2, false, node, &attr->addr);
+		be_emit8(0xFF); // call *addr
+		enc_rm(2, node, &attr->addr);
+		return;
+	default:
+		break;
+	}
+	panic("invalid op_mode for call");
+}
+
+static void enc_jmp(ir_node const *const cfop)
+{
+	be_emit8(0xE9);
+	enc_jmp_destination(cfop);
+}
+
+static void enc_jump(const ir_node *node)
+{
+	if (!be_is_fallthrough(node))
+		enc_jmp(node);
+}
+
+static void enc_jcc(x86_condition_code_t pnc, ir_node const *const cfop)
+{
+	unsigned char cc = pnc2cc(pnc);
+	be_emit8(0x0F);
+	be_emit8(0x80 + cc);
+	enc_jmp_destination(cfop);
+}
+
+static void enc_jp(bool odd, ir_node const *const cfop)
+{
+	be_emit8(0x0F);
+	be_emit8(0x8A + odd);
+	enc_jmp_destination(cfop);
+}
+
+static x86_condition_code_t determine_final_cc(ir_node const *const flags,
+                                               x86_condition_code_t cc)
+{
+	if (is_amd64_fucomi(flags)) {
+		amd64_x87_attr_t const *const attr = get_amd64_x87_attr_const(flags);
+		if (attr->x87.reverse)
+			cc = x86_invert_condition_code(cc);
+	}
+	return cc;
+}
+
+static void enc_amd64_jcc(const ir_node *node)
+{
+	ir_node         const *const flags = get_irn_n(node, n_amd64_jcc_flags);
+	amd64_cc_attr_t const *const attr  = get_amd64_cc_attr_const(node);
+	x86_condition_code_t cc = determine_final_cc(flags, attr->cc);
+
+	be_cond_branch_projs_t projs = be_get_cond_branch_projs(node);
+
+	if (be_is_fallthrough(projs.t)) {
+		/* exchange both proj's so the second one can be omitted */
+		ir_node *const t = projs.t;
+		projs.t = projs.f;
+		projs.f = t;
+		cc      = x86_negate_condition_code(cc);
+	}
+
+	bool const fallthrough = be_is_fallthrough(projs.f);
+	/* if we can't have a fallthrough anyway, put the more likely case first */
+	if (!fallthrough) {
+		/* We would need execfreq for the concrete edge, but don't have it
+		 * available here, so we use the block execfreq :-( */
+		ir_node const *const target_true  = be_emit_get_cfop_target(projs.t);
+		double         const freq_true    = get_block_execfreq(target_true);
+		ir_node const *const target_false = be_emit_get_cfop_target(projs.f);
+		double         const freq_false   = get_block_execfreq(target_false);
+		if (freq_false > freq_true) {
+			ir_node *const t = projs.t;
+			projs.t = projs.f;
+			projs.f = t;
+			cc      = x86_negate_condition_code(cc);
+		}
+	}
+
+	if (cc & x86_cc_float_parity_cases) {
+		/* Some floating point comparisons require a test of the parity flag,
+		 * which indicates that the result is unordered */
+		if (cc & x86_cc_negated) {
+			enc_jp(false, projs.t);
+		} else {
+			/* we need a local label if the false proj is a fallthrough
+			 * as the falseblock might have no label emitted then */
+			if (fallthrough) {
+				be_emit8(0x7A);
+				be_emit8(0x06);  // jp + 6
+			} else {
+				enc_jp(false, projs.f);
+			}
+		}
+	}
+	enc_jcc(cc, projs.t);
+
+	/* the second Proj might be a fallthrough */
+	if (fallthrough) {
+		/* it's a fallthrough */
+	} else {
+		enc_jmp(projs.f);
+	}
+}
+
+static void enc_return(const ir_node *node)
+{
+	(void)node;
+	be_emit8(0xC3); // ret
+}
+
+static void amd64_register_binary_emitters(void)
+{
+	be_init_emitters();
+
+	/* benode emitters */
+	be_set_emitter(op_be_Copy,       enc_copy);
+	be_set_emitter(op_be_CopyKeep,   enc_copy);
+	be_set_emitter(op_be_IncSP,      enc_incsp);
+	be_set_emitter(op_be_Perm,       enc_perm);
+
+	be_set_emitter(op_amd64_call,      enc_call);
+	be_set_emitter(op_amd64_jcc,       enc_amd64_jcc);
+	be_set_emitter(op_amd64_jmp,       enc_jump);
+	be_set_emitter(op_amd64_lea,       enc_lea);
+	be_set_emitter(op_amd64_mov_gp,    enc_mov_gp);
+	be_set_emitter(op_amd64_mov_imm,   enc_mov_imm);
+	be_set_emitter(op_amd64_mov_store, enc_mov_store);
+	be_set_emitter(op_amd64_ret,       enc_return);
+}
+
+static void assign_block_fragment_num(ir_node *const block, unsigned const num)
+{
+	assert(ir_nodehashmap_get(void, &block_fragmentnum, block) == NULL);
+	ir_nodehashmap_insert(&block_fragmentnum, block, INT_TO_PTR(num));
+}
+
+static void gen_binary_block(ir_node *const block)
+{
+	unsigned fragment_num = be_begin_fragment(0, 0);
+	assert(fragment_num
+	       == (unsigned)PTR_TO_INT(ir_nodehashmap_get(void, &block_fragmentnum, block)));
+	(void)fragment_num;
+
+	/* emit the contents of the block */
+	sched_foreach(block, node) {
+		be_emit_node(node);
+	}
+
+	be_finish_fragment();
+}
+
+ir_jit_function_t *amd64_emit_jit(ir_jit_segment_t *const segment,
+                                  ir_graph *const irg)
+{
+	amd64_register_binary_emitters();
+
+	ir_node **const blk_sched = be_create_block_schedule(irg);
+
+	be_jit_begin_function(segment);
+
+	/* we use links to point to target blocks */
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
+
+	be_emit_init_cf_links(blk_sched);
+
+	ir_nodehashmap_init(&block_fragmentnum);
+	size_t n = ARR_LEN(blk_sched);
+	for (size_t i = 0; i < n; ++i) {
+		ir_node *block = blk_sched[i];
+		assign_block_fragment_num(block, (unsigned)i);
+	}
+	for (size_t i = 0; i < n; ++i) {
+		ir_node *block = blk_sched[i];
+		gen_binary_block(block);
+	}
+	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+	ir_nodehashmap_destroy(&block_fragmentnum);
+
+	return be_jit_finish_function();
+}
+
+static void enc_nop_callback(char *buffer, unsigned size)
+{
+	memset(buffer, 0, size);
+	while (size > 0) {
+		switch (size) {
+		case 1: buffer[0] = 0x90; return;
+		case 2:
+			buffer[0] = 0x66;
+			++buffer;
+			--size;
+			continue;
+		case 3:
+		sequence_0f1f:
+			buffer[0] = 0x0F;
+			buffer[1] = 0x1F;
+			return;
+		case 4: buffer[2] = 0x40; goto sequence_0f1f;
+		case 5: buffer[2] = 0x44; goto sequence_0f1f;
+		case 6:
+			buffer[0] = 0x66;
+			++buffer;
+			--size;
+			continue;
+		case 7: buffer[2] = 0x80; goto sequence_0f1f;
+		case 8: buffer[2] = 0x84; goto sequence_0f1f;
+		default:
+			buffer[0] = 0x66;
+			buffer[1] = 0x0F;
+			buffer[2] = 0x1F;
+			buffer[3] = 0x84;
+			buffer += 9;
+			size   -= 9;
+			continue;
+		}
+	}
+}
+
+static unsigned enc_relocation_callback(char *const buffer,
+                                        uint8_t const be_kind,
+                                        ir_entity *const entity,
+                                        int32_t const offset)
+{
+	if (entity == NULL) {
+		assert(be_kind == AMD64_RELOCATION_RELJUMP);
+		uint32_t const value = (uint32_t)offset;
+		memcpy(buffer, &value, 4);
+		return 4;
+	}
+
+	intptr_t const entity_addr = (intptr_t)be_jit_get_entity_addr(entity);
+	if (entity_addr == (intptr_t)-1)
+		panic("Could not resolve address of entity %+F", entity);
+	intptr_t addr = entity_addr + offset;
+	if (be_kind == AMD64_RELOCATION_ABS64) {
+		uint64_t const value = (uint64_t)addr;
+		memcpy(buffer, &value, 8);
+		return 8;
+	}
+	if (be_kind == X86_IMM_PCREL)
+		addr -= (intptr_t)buffer;
+	uint32_t const value = (uint32_t)addr;
+	if ((intptr_t)(int32_t)value != addr)
+		panic("Overflow in relocation");
+
+	memcpy(buffer, &value, 4);
+	return 4;
+}
+
+void amd64_emit_jit_function(char *buffer, ir_jit_function_t *const function)
+{
+	static const be_jit_emit_interface_t jit_emit_interface = {
+		.nops       = enc_nop_callback,
+		.relocation = enc_relocation_callback,
+	};
+	be_jit_emit_memory(buffer, function, &jit_emit_interface);
+}
+
+void amd64_emit_nops(char *const buffer, unsigned const size)
+{
+	enc_nop_callback(buffer, size);
+}
+
+uint32_t amd64_get_elf_reloc_type(uint8_t const be_kind)
+{
+	switch (be_kind) {
+	case X86_IMM_ADDR:           return 11; /* R_X86_64_32S */
+	case X86_IMM_PCREL:          return  2; /* R_X86_64_PC32 */
+	case X86_IMM_GOTPCREL:       return  9; /* R_X86_64_GOTPCREL */
+	case AMD64_RELOCATION_ABS64: return  1; /* R_X86_64_64 */
+	}
+	panic("unsupported relocation kind %u for ELF output", be_kind);
+}
@@ -0,0 +1,32 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2016 Matthias Braun
+ */
+
+/**
+ * @file
+ * @brief       amd64 binary encoding/emission
+ */
+#ifndef FIRM_BE_AMD64_AMD64_ENCODE_H
+#define FIRM_BE_AMD64_AMD64_ENCODE_H
+
+#include <stdint.h>
+
+#include "firm_types.h"
+#include "jit.h"
+
+enum {
+	AMD64_RELOCATION_RELJUMP = 128,
+	/** 64bit absolute address, used for movabs with a symbolic immediate. */
+	AMD64_RELOCATION_ABS64   = 129,
+};
+
+ir_jit_function_t *amd64_emit_jit(ir_jit_segment_t *segment, ir_graph *irg);
+
+void amd64_emit_jit_function(char *buffer, ir_jit_function_t *function);
+
+void amd64_emit_nops(char *buffer, unsigned size);
+
+uint32_t amd64_get_elf_reloc_type(uint8_t be_kind);
+
+#endif
@@ -9,13 +9,18 @@
  */
 #include "amd64_optimize.h"
 
+#include "amd64_bearch_t.h"
 #include "amd64_new_nodes.h"
 #include "amd64_transform.h"
 #include "benode.h"
 #include "bepeephole.h"
 #include "besched.h"
 #include "gen_amd64_regalloc_if.h"
+#include "iredges_t.h"
+#include "irgmod.h"
+#include "irgwalk.h"
 #include "util.h"
+#include "xmalloc.h"
 
 static void peephole_amd64_cmp(ir_node *const node)
 {
@@ -138,6 +143,108 @@ static void peephole_be_IncSP(ir_node *const node)
 	be_peephole_IncSP_IncSP(node);
 }
 
+/** Whether the stack pointer provably stays at its value from function
+ * entry throughout the whole graph. */
+static bool sp_is_entry_sp;
+
+/**
+ * Turning a call directly in front of a ret into a sibling call jmp is
+ * only sound if the stack pointer still points at our return address
+ * when the call executes; the callee then returns to our caller
+ * directly.  This holds exactly when nothing in the graph moves the
+ * stack pointer: no frame, no stack arguments, no pushes or pops.
+ */
+static void check_sp_change(ir_node *const block, void *const env)
+{
+	(void)env;
+	sched_foreach(block, node) {
+		if (be_is_IncSP(node)) {
+			if (be_get_IncSP_offset(node) != 0)
+				sp_is_entry_sp = false;
+		} else if (is_amd64_push_am(node) || is_amd64_push_reg(node)
+		        || is_amd64_pop_am(node)  || is_amd64_sub_sp(node)
+		        || is_amd64_leave(node)) {
+			sp_is_entry_sp = false;
+		}
+	}
+}
+
+static void peephole_amd64_ret(ir_node *const node)
+{
+	if (!sp_is_entry_sp)
+		return;
+
+	/* Find a call directly in front of the ret; no-op stack adjustments
+	 * and Keeps do not separate the two. */
+	ir_node *skipped[4];
+	unsigned n_skipped = 0;
+	ir_node *call      = sched_prev(node);
+	while (be_is_IncSP(call) || be_is_Keep(call)) {
+		if (n_skipped == ARRAY_SIZE(skipped))
+			return;
+		skipped[n_skipped++] = call;
+		call = sched_prev(call);
+	}
+	if (!is_amd64_call(call))
+		return;
+
+	/* All results of the call must flow into the ret (or be unused):
+	 * after the jmp it is the callee that produces them. */
+	foreach_out_edge(call, edge) {
+		ir_node *const proj = get_edge_src_irn(edge);
+		foreach_out_edge(proj, proj_edge) {
+			ir_node *const user = get_edge_src_irn(proj_edge);
+			if (user == node)
+				continue;
+			for (unsigned i = 0; i < n_skipped; ++i) {
+				if (user == skipped[i])
+					goto next_user;
+			}
+			return;
+next_user:;
+		}
+	}
+
+	/* Conversely everything the ret returns must be a result of the
+	 * call or survive it in a callee saved register. */
+	foreach_irn_in(node, i, in) {
+		if (i == n_amd64_ret_mem || i == n_amd64_ret_stack)
+			continue;
+		if (is_Proj(in) && get_Proj_pred(in) == call)
+			continue;
+		arch_register_t const *const reg = arch_get_irn_register(in);
+		if (reg == NULL || !amd64_register_is_callee_save(reg))
+			return;
+	}
+
+	/* Turn the call into a jmp reusing our frame and return address. */
+	dbg_info                     *const dbgi  = get_irn_dbg_info(call);
+	ir_node                      *const block = get_nodes_block(node);
+	int                           const arity = get_irn_arity(call);
+	ir_node                     **const in    = ALLOCAN(ir_node*, arity);
+	foreach_irn_in(call, i, pred) {
+		in[i] = pred;
+	}
+	arch_register_req_t    const **const in_reqs
+		= arch_get_irn_register_reqs_in(call);
+	amd64_call_addr_attr_t const  *const attr
+		= get_amd64_call_addr_attr_const(call);
+	ir_node *const jmp
+		= new_bd_amd64_tail_call(dbgi, block, arity, in, in_reqs, attr);
+	be_peephole_replace(node, jmp);
+
+	/* The call and its Projs are dead now. */
+	for (unsigned i = 0; i < n_skipped; ++i) {
+		sched_remove(skipped[i]);
+		kill_node(skipped[i]);
+	}
+	foreach_out_edge_safe(call, edge) {
+		kill_node(get_edge_src_irn(edge));
+	}
+	sched_remove(call);
+	kill_node(call);
+}
+
 void amd64_peephole_optimization(ir_graph *const irg)
 {
 	ir_clear_opcodes_generic_func();
@@ -145,5 +252,9 @@ void amd64_peephole_optimization(ir_graph *const irg)
 	register_peephole_optimization(op_amd64_lea,     peephole_amd64_lea);
 	register_peephole_optimization(op_amd64_mov_imm, peephole_amd64_mov_imm);
 	register_peephole_optimization(op_be_IncSP,      peephole_be_IncSP);
+	sp_is_entry_sp = true;
+	irg_block_walk_graph(irg, check_sp_change, NULL, NULL);
+	if (sp_is_entry_sp)
+		register_peephole_optimization(op_amd64_ret, peephole_amd64_ret);
 	be_peephole_opt(irg);
 }
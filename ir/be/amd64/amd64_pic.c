@@ -8,6 +8,7 @@
  * @brief       position independent code adjustments
  * @author      Matthias Braun
  */
+#include "adt/pmap.h"
 #include "amd64_bearch_t.h"
 #include "amd64_new_nodes.h"
 #include "beutil.h"
@@ -34,8 +35,16 @@ static bool is_externally_visible(ir_entity const *const entity)
 	panic("invalid visibility in %+F", entity);
 }
 
-static ir_node *create_gotpcrel_load(dbg_info *const dbgi, ir_graph *const irg, ir_entity *const entity)
+/* Per-function cache of GOT slot loads: repeated uses of the same entity
+ * share one load in the start block instead of reloading the slot per use.
+ * The start block dominates everything, so the shared load in particular
+ * stays outside of all loops. */
+static ir_node *create_gotpcrel_load(pmap *const got_loads, dbg_info *const dbgi, ir_graph *const irg, ir_entity *const entity)
 {
+	ir_node *cached = pmap_get(ir_node, got_loads, entity);
+	if (cached != NULL)
+		return cached;
+
 	ir_node *const addr
 		= be_new_Relocation(dbgi, irg, X86_IMM_GOTPCREL, entity, mode_P);
 	ir_type *const type  = get_entity_type(entity);
@@ -43,12 +52,14 @@ static ir_node *create_gotpcrel_load(dbg_info *const dbgi, ir_graph *const irg,
 	ir_node *const block = get_irg_start_block(irg);
 	ir_node *const load  = new_rd_Load(dbgi, block, nomem, addr, mode_P,
 	                                   type, cons_floats);
-	return new_r_Proj(load, mode_P, pn_Load_res);
+	ir_node *const res   = new_r_Proj(load, mode_P, pn_Load_res);
+	pmap_insert(got_loads, entity, res);
+	return res;
 }
 
 static void fix_address_pic_mach_o(ir_node *const node, void *const data)
 {
-	(void)data;
+	pmap *const got_loads = (pmap*)data;
 	foreach_irn_in(node, i, pred) {
 		if (!is_Address(pred))
 			continue;
@@ -67,7 +78,7 @@ static void fix_address_pic_mach_o(ir_node *const node, void *const data)
 		        && !(get_entity_linkage(entity) & IR_LINKAGE_MERGE)) {
 			res = be_new_Relocation(dbgi, irg, X86_IMM_PCREL, entity, mode_P);
 		} else {
-			res = create_gotpcrel_load(dbgi, irg, entity);
+			res = create_gotpcrel_load(got_loads, dbgi, irg, entity);
 		}
 		set_irn_n(node, i, res);
 	}
@@ -75,7 +86,7 @@ static void fix_address_pic_mach_o(ir_node *const node, void *const data)
 
 static void fix_address_pic_elf(ir_node *const node, void *const data)
 {
-	(void)data;
+	pmap *const got_loads = (pmap*)data;
 	foreach_irn_in(node, i, pred) {
 		if (!is_Address(pred))
 			continue;
@@ -96,7 +107,7 @@ static void fix_address_pic_elf(ir_node *const node, void *const data)
 		} else if (!ext_visible) {
 			res = be_new_Relocation(dbgi, irg, X86_IMM_PCREL, entity, mode_P);
 		} else {
-			res = create_gotpcrel_load(dbgi, irg, entity);
+			res = create_gotpcrel_load(got_loads, dbgi, irg, entity);
 		}
 		set_irn_n(node, i, res);
 	}
@@ -104,17 +115,22 @@ static void fix_address_pic_elf(ir_node *const node, void *const data)
 
 void amd64_adjust_pic(ir_graph *irg)
 {
+	if (ir_platform.pic_style == BE_PIC_NONE)
+		return;
+
+	pmap *const got_loads = pmap_create();
 	switch (ir_platform.pic_style) {
 	case BE_PIC_NONE:
-		return;
+		break;
 	case BE_PIC_ELF_PLT:
-		irg_walk_graph(irg, fix_address_pic_elf, NULL, NULL);
+		irg_walk_graph(irg, fix_address_pic_elf, NULL, got_loads);
 		break;
 	case BE_PIC_ELF_NO_PLT:
 		panic("amd64 elf/no-plt not implemented yet");
 	case BE_PIC_MACH_O:
-		irg_walk_graph(irg, fix_address_pic_mach_o, NULL, NULL);
+		irg_walk_graph(irg, fix_address_pic_mach_o, NULL, got_loads);
 		break;
 	}
+	pmap_destroy(got_loads);
 	be_dump(DUMP_BE, irg, "pic");
 }
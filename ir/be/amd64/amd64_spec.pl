@@ -9,14 +9,14 @@ $mode_x87   = "x86_mode_E";
 	gp => {
 		mode => $mode_gp,
 		registers => [
-			{ name => "rax", dwarf =>  0 },
-			{ name => "rcx", dwarf =>  2 },
-			{ name => "rdx", dwarf =>  1 },
-			{ name => "rsi", dwarf =>  4 },
-			{ name => "rdi", dwarf =>  5 },
-			{ name => "rbx", dwarf =>  3 },
-			{ name => "rbp", dwarf =>  6 },
-			{ name => "rsp", dwarf =>  7 },
+			{ name => "rax", encoding =>  0, dwarf =>  0 },
+			{ name => "rcx", encoding =>  1, dwarf =>  2 },
+			{ name => "rdx", encoding =>  2, dwarf =>  1 },
+			{ name => "rsi", encoding =>  6, dwarf =>  4 },
+			{ name => "rdi", encoding =>  7, dwarf =>  5 },
+			{ name => "rbx", encoding =>  3, dwarf =>  3 },
+			{ name => "rbp", encoding =>  5, dwarf =>  6 },
+			{ name => "rsp", encoding =>  4, dwarf =>  7 },
 			{ name => "r8",  dwarf =>  8 },
 			{ name => "r9",  dwarf =>  9 },
 			{ name => "r10", dwarf => 10 },
@@ -562,6 +562,19 @@ ret => {
 	emit     => "ret",
 },
 
+# A sibling call: a call in tail position that reuses the caller's frame
+# and return address.  Created by the peephole optimizer from call+ret.
+tail_call => {
+	op_flags  => [ "cfopcode" ],
+	irn_flags => [ "modify_flags" ],
+	state     => "pinned",
+	in_reqs   => "...",
+	out_reqs  => [ "exec" ],
+	attr_type => "amd64_call_addr_attr_t",
+	attr      => "const amd64_call_addr_attr_t *attr_init",
+	emit      => "jmp %*AM",
+},
+
 bsf => { template => $unop_out },
 
 bsr => { template => $unop_out },
@@ -1747,7 +1747,10 @@ static ir_node *make_store_for_mode(ir_mode *const mode, dbg_info *const dbgi, i
 {
 	construct_binop_func               cons;
 	arch_register_req_t const **const *reqs;
-	if (!mode_is_float(mode)) {
+	if (mode == amd64_mode_xmm) {
+		cons = &new_bd_amd64_movdqu_store;
+		reqs = xmm_am_reqs;
+	} else if (!mode_is_float(mode)) {
 		cons = &new_bd_amd64_mov_store;
 		reqs = gp_am_reqs;
 	} else if (mode == x86_mode_E) {
@@ -2345,11 +2348,21 @@ static ir_node *conv_x87_to_sse(dbg_info *dbgi, ir_node *block, ir_node *op,
 
 static ir_node *conv_int_to_x87(dbg_info *dbgi, ir_node *block, ir_node *val)
 {
-	ir_mode        *const mode    = get_irn_mode(val);
-	ir_node        *const new_val = extend_if_necessary(dbgi, block, val);
-	x86_insn_size_t const size    = get_size_32_64_from_mode(mode);
-	if (!mode_is_signed(mode))
-		panic("unsigned int -> x87 NIY");
+	ir_mode        *const mode = get_irn_mode(val);
+	ir_node        *new_val;
+	x86_insn_size_t size;
+	if (mode_is_signed(mode)) {
+		new_val = extend_if_necessary(dbgi, block, val);
+		size    = get_size_32_64_from_mode(mode);
+	} else if (get_mode_size_bits(mode) <= 32) {
+		/* there is no unsigned fild; zero-extend to 64 bit and use the signed
+		 * 64 bit load which covers the whole unsigned range */
+		new_val = be_upper_bits_clean(val, mode)
+		        ? be_transform_node(val) : gen_extend(dbgi, block, val, mode);
+		size    = X86_SIZE_64;
+	} else {
+		panic("unsigned 64bit int -> x87 NIY");
+	}
 
 	ir_node *in[5];
 	int      n_in = 0;
@@ -2669,7 +2682,7 @@ ir_node *amd64_new_spill(ir_node *const value, ir_node *const after)
 	return store;
 }
 
-static ir_node *create_sse_spill(dbg_info *const dbgi, ir_node *const block,
+static ir_node *create_movdqu(dbg_info *const dbgi, ir_node *const block,
                                  int const arity, ir_node *const *const in,
                                  arch_register_req_t const **const in_reqs,
                                  x86_insn_size_t const size, amd64_op_mode_t const op_mode,
@@ -2707,7 +2720,7 @@ ir_node *amd64_new_reload(ir_node *value, ir_node *spill, ir_node *before)
 		pn_res = pn_amd64_fld_res;
 	} else {
 		size   = X86_SIZE_128;
-		cons   = &create_sse_spill;
+		cons   = &create_movdqu;
 		pn_res = pn_amd64_movdqu_res;
 	}
 	ir_node *const load = cons(NULL, block, ARRAY_SIZE(in), in, reg_mem_reqs,
@@ -2742,6 +2755,7 @@ static ir_node *gen_Load(ir_node *const node)
 	assert((size_t)arity <= ARRAY_SIZE(in));
 
 	create_mov_func   const cons      =
+		mode == amd64_mode_xmm                                ? &create_movdqu         :
 		mode_is_float(mode)                                   ?
 			(mode == x86_mode_E ? new_bd_amd64_fld : &new_bd_amd64_movs_xmm) :
 		get_mode_size_bits(mode) < 64 && mode_is_signed(mode) ? &new_bd_amd64_movs     :
@@ -2796,6 +2810,13 @@ static ir_node *gen_Proj_Load(ir_node *const node)
 			return be_new_Proj(new_load, pn_amd64_movs_xmm_M);
 		}
 		break;
+	case iro_amd64_movdqu:
+		if (pn == pn_Load_res) {
+			return be_new_Proj(new_load, pn_amd64_movdqu_res);
+		} else if (pn == pn_Load_M) {
+			return be_new_Proj(new_load, pn_amd64_movdqu_M);
+		}
+		break;
 	case iro_amd64_movs:
 	case iro_amd64_mov_gp:
 		assert((unsigned)pn_amd64_movs_res == (unsigned)pn_amd64_mov_gp_res);
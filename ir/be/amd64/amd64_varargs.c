@@ -20,7 +20,7 @@
 #include "betranshlp.h"
 #include "bitfiddle.h"
 #include "gen_amd64_regalloc_if.h"
-#include "ident.h"
+#include "ident_t.h"
 #include "ircons.h"
 #include "iredges_t.h"
 #include "irgmod.h"
@@ -62,12 +62,12 @@ ir_type *amd64_build_va_list_type(void)
 {
 	ir_type *const int_type     = get_type_for_mode(mode_Is);
 	ir_type *const ptr_type     = new_type_pointer(get_type_for_mode(mode_ANY));
-	ir_type *const va_list_type = new_type_struct(new_id_from_str("builtin:va_list"));
+	ir_type *const va_list_type = new_type_struct(id_builtin_va_list);
 
-	va_list_members.gp_offset      = new_entity(va_list_type, new_id_from_str("gp_offset"),      int_type);
-	va_list_members.xmm_offset     = new_entity(va_list_type, new_id_from_str("xmm_offset"),     int_type);
-	va_list_members.stack_args_ptr = new_entity(va_list_type, new_id_from_str("stack_args_ptr"), ptr_type);
-	va_list_members.reg_save_ptr   = new_entity(va_list_type, new_id_from_str("reg_save_ptr"),   ptr_type);
+	va_list_members.gp_offset      = new_entity(va_list_type, id_gp_offset,      int_type);
+	va_list_members.xmm_offset     = new_entity(va_list_type, id_xmm_offset,     int_type);
+	va_list_members.stack_args_ptr = new_entity(va_list_type, id_stack_args_ptr, ptr_type);
+	va_list_members.reg_save_ptr   = new_entity(va_list_type, id_reg_save_ptr,   ptr_type);
 
 	default_layout_compound_type(va_list_type);
 	return va_list_type;
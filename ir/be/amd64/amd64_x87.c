@@ -2,6 +2,7 @@
 #include "amd64_bearch_t.h"
 #include "amd64_new_nodes.h"
 #include "gen_amd64_regalloc_if.h"
+#include "irgwalk.h"
 #include "panic.h"
 
 static void sim_amd64_fst(x87_state *const state, ir_node *const node)
@@ -101,8 +102,28 @@ static void prepare_callbacks(void)
 	x86_register_x87_sim(op_amd64_ret,    x86_sim_x87_ret);
 }
 
+static void find_x87_value(ir_node *node, void *env)
+{
+	bool *const found = (bool*)env;
+	be_foreach_out(node, o) {
+		arch_register_req_t const *const req
+			= arch_get_irn_register_req_out(node, o);
+		if (req->cls == &amd64_reg_classes[CLASS_amd64_x87]) {
+			*found = true;
+			return;
+		}
+	}
+}
+
 void amd64_simulate_graph_x87(ir_graph *irg)
 {
+	/* The x87 unit is only used for 80 bit arithmetic; the usual SSE-only
+	 * graphs do not need the stack simulation (and its liveness analysis). */
+	bool has_x87_value = false;
+	irg_walk_graph(irg, find_x87_value, NULL, &has_x87_value);
+	if (!has_x87_value)
+		return;
+
 	prepare_callbacks();
 	const x87_simulator_config_t config = {
 		.regclass     = &amd64_reg_classes[CLASS_amd64_x87],
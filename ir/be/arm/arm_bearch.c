@@ -234,7 +234,9 @@ static void arm_lower_for_target(void)
 	foreach_irp_irg(i, irg) {
 		/* Turn all small CopyBs into loads/stores and all bigger CopyBs into
 		 * memcpy calls. */
-		lower_CopyB(irg, 31, 32, false);
+		lower_CopyB(irg, ir_target.copyb_max_small_size,
+		            ir_target.copyb_min_large_size,
+		            ir_target.fast_unaligned_memaccess);
 		be_after_transform(irg, "lower-copyb");
 	}
 	if (arm_cg_config.fpu == ARM_FPU_SOFTFLOAT) {
@@ -290,6 +292,9 @@ static void arm_init(void)
 	ir_target.fast_unaligned_memaccess = false;
 	ir_target.allow_ifconv             = arm_ifconv;
 	ir_target.float_int_overflow       = ir_overflow_min_max;
+	ir_target.copyb_max_small_size     = 31;
+	ir_target.copyb_min_large_size     = 32;
+	ir_target.copyb_loop_max_size      = 256;
 }
 
 static void arm_finish(void)
@@ -349,15 +354,20 @@ static const lc_opt_table_entry_t arm_options[] = {
 	LC_OPT_LAST
 };
 
+static void register_arm_options(void)
+{
+	lc_opt_entry_t *be_grp  = lc_opt_get_grp(firm_opt_get_root(), "be");
+	lc_opt_entry_t *arm_grp = lc_opt_get_grp(be_grp, "arm");
+	lc_opt_add_table(arm_grp, arm_options);
+}
+
 static void arm_init_architecture(void)
 {
 	memset(&arm_cg_config, 0, sizeof(arm_cg_config));
 	arm_cg_config.variant    = ARM_VARIANT_6T2;
 	arm_cg_config.fpu        = ARM_FPU_SOFTFLOAT;
 
-	lc_opt_entry_t *be_grp  = lc_opt_get_grp(firm_opt_get_root(), "be");
-	lc_opt_entry_t *arm_grp = lc_opt_get_grp(be_grp, "arm");
-	lc_opt_add_table(arm_grp, arm_options);
+	be_register_module_options(register_arm_options);
 }
 
 BE_REGISTER_MODULE_CONSTRUCTOR(be_init_arch_arm)
@@ -10,6 +10,7 @@
  */
 #include "arm_optimize.h"
 
+#include "arm_bearch_t.h"
 #include "arm_new_nodes.h"
 #include "arm_nodes_attr.h"
 #include "bediagnostic.h"
@@ -18,9 +19,14 @@
 #include "besched.h"
 #include "gen_arm_new_nodes.h"
 #include "gen_arm_regalloc_if.h"
+#include "heights.h"
 #include "ircons.h"
 #include "iredges_t.h"
 #include "irgmod.h"
+#include "irnode_t.h"
+#include "util.h"
+
+static ir_heights_t *heights;
 
 static uint32_t arm_ror(uint32_t v, uint32_t ror)
 {
@@ -123,7 +129,7 @@ static void peephole_arm_FrameAddr(ir_node *node)
 /**
  * Fix stackpointer relative stores if the offset gets too big
  */
-static void peephole_arm_Str_Ldr(ir_node *node)
+static void fix_invalid_ls_offset(ir_node *node)
 {
 	arm_load_store_attr_t *attr    = get_arm_load_store_attr(node);
 	const int              offset  = attr->offset;
@@ -162,6 +168,194 @@ static void peephole_arm_Str_Ldr(ir_node *node)
 	attr->offset = 0;
 }
 
+static inline bool arm_is_offset8(int32_t const v)
+{
+	/* Symmetrical, because ARM uses sign+magnitude for offset. */
+	return -255 <= v && v <= 255;
+}
+
+static ir_entity *arm_get_frame_entity(const ir_node *node)
+{
+	if (!is_arm_irn(node))
+		return NULL;
+	if (get_arm_attr_const(node)->is_load_store) {
+		arm_load_store_attr_t const *const attr
+			= get_arm_load_store_attr_const(node);
+		if (attr->is_frame_entity)
+			return attr->entity;
+	}
+	return NULL;
+}
+
+/**
+ * Checks whether the registers satisfy the even/odd register pair constraint
+ * of the doubleword load/store instructions.
+ */
+static bool is_ldst_reg_pair(arch_register_t const *const low,
+                             arch_register_t const *const high)
+{
+	return low->encoding % 2 == 0 && high->encoding == low->encoding + 1;
+}
+
+/**
+ * Checks whether two word accesses at @p offset and @p pred_offset can be
+ * combined into a doubleword access. Besides the encodeable offset range we
+ * must be able to prove 8-byte alignment of the lower address, which we can
+ * only do for stack pointer based accesses (the stack is 8-byte aligned).
+ */
+static bool is_pairable_address(ir_node *const ptr, long const offset,
+                                long const pred_offset)
+{
+	if (offset != pred_offset - 4 && offset != pred_offset + 4)
+		return false;
+	long const low_offset = MIN(offset, pred_offset);
+	if (low_offset % 8 != 0 || !arm_is_offset8(low_offset))
+		return false;
+	return arch_get_irn_register(ptr) == &arm_registers[REG_SP];
+}
+
+/**
+ * Merge a word store with its memory predecessor into one strd if both store
+ * to neighbouring addresses.
+ */
+static void peephole_arm_Str_pair(ir_node *node)
+{
+	arm_load_store_attr_t const *const attr = get_arm_load_store_attr_const(node);
+	if (get_mode_size_bits(attr->load_store_mode) != 32)
+		return;
+
+	ir_node *const pred = get_irn_n(node, n_arm_Str_mem);
+	if (!is_arm_Str(pred) || !be_has_only_one_user(pred)
+	 || get_nodes_block(pred) != get_nodes_block(node))
+		return;
+	arm_load_store_attr_t const *const pred_attr
+		= get_arm_load_store_attr_const(pred);
+	if (get_mode_size_bits(pred_attr->load_store_mode) != 32)
+		return;
+
+	ir_node *const ptr = get_irn_n(node, n_arm_Str_ptr);
+	if (get_irn_n(pred, n_arm_Str_ptr) != ptr)
+		return;
+	long const offset      = attr->offset;
+	long const pred_offset = pred_attr->offset;
+	if (!is_pairable_address(ptr, offset, pred_offset))
+		return;
+
+	bool     const node_is_low = offset < pred_offset;
+	ir_node *const low_val     = get_irn_n(node_is_low ? node : pred, n_arm_Str_val);
+	ir_node *const high_val    = get_irn_n(node_is_low ? pred : node, n_arm_Str_val);
+	if (!is_ldst_reg_pair(arch_get_irn_register(low_val),
+	                      arch_get_irn_register(high_val)))
+		return;
+
+	/* the earlier store is delayed until the merge point */
+	if (!be_can_move_down(heights, pred, node, arm_get_frame_entity))
+		return;
+
+	dbg_info *const dbgi  = get_irn_dbg_info(node);
+	ir_node  *const block = get_nodes_block(node);
+	ir_node  *const mem   = get_irn_n(pred, n_arm_Str_mem);
+	ir_node  *const strd  = new_bd_arm_Strd(dbgi, block, ptr, low_val,
+	                                        high_val, mem, mode_Lu, NULL, 0,
+	                                        MIN(offset, pred_offset), false);
+	sched_add_before(node, strd);
+	be_peephole_exchange(node, strd);
+	be_peephole_exchange(pred, strd);
+}
+
+/**
+ * Merge a word load with a neighbouring load from the same base and memory
+ * state into one ldrd.
+ */
+static void peephole_arm_Ldr_pair(ir_node *node)
+{
+	arm_load_store_attr_t const *const attr = get_arm_load_store_attr_const(node);
+	if (get_mode_size_bits(attr->load_store_mode) != 32)
+		return;
+	ir_node *const ptr = get_irn_n(node, n_arm_Ldr_ptr);
+	ir_node *const mem = get_irn_n(node, n_arm_Ldr_mem);
+	ir_node *const res = get_Proj_for_pn(node, pn_arm_Ldr_res);
+	if (res == NULL)
+		return;
+
+	/* look for the partner load a few schedule steps upwards */
+	ir_node *pred    = NULL;
+	int      n_tries = 5;
+	for (ir_node *candidate = sched_prev(node); !sched_is_begin(candidate);
+	     candidate = sched_prev(candidate)) {
+		if (--n_tries < 0)
+			return;
+		if (!is_arm_Ldr(candidate)
+		 || get_irn_n(candidate, n_arm_Ldr_ptr) != ptr
+		 || get_irn_n(candidate, n_arm_Ldr_mem) != mem)
+			continue;
+		arm_load_store_attr_t const *const cand_attr
+			= get_arm_load_store_attr_const(candidate);
+		if (get_mode_size_bits(cand_attr->load_store_mode) != 32)
+			continue;
+		if (is_pairable_address(ptr, attr->offset, cand_attr->offset)) {
+			pred = candidate;
+			break;
+		}
+	}
+	if (pred == NULL)
+		return;
+	ir_node *const pred_res = get_Proj_for_pn(pred, pn_arm_Ldr_res);
+	if (pred_res == NULL)
+		return;
+
+	long const offset      = attr->offset;
+	long const pred_offset = get_arm_load_store_attr_const(pred)->offset;
+	bool const node_is_low = offset < pred_offset;
+	ir_node *const low_res  = node_is_low ? res : pred_res;
+	ir_node *const high_res = node_is_low ? pred_res : res;
+	arch_register_t const *const low_reg  = arch_get_irn_register(low_res);
+	arch_register_t const *const high_reg = arch_get_irn_register(high_res);
+	if (!is_ldst_reg_pair(low_reg, high_reg))
+		return;
+
+	/* the earlier load is delayed until the merge point */
+	if (!be_can_move_down(heights, pred, node, arm_get_frame_entity))
+		return;
+
+	dbg_info *const dbgi  = get_irn_dbg_info(node);
+	ir_node  *const block = get_nodes_block(node);
+	ir_node  *const ldrd  = new_bd_arm_Ldrd(dbgi, block, ptr, mem, mode_Lu,
+	                                        NULL, 0, MIN(offset, pred_offset),
+	                                        false);
+	sched_add_before(node, ldrd);
+	ir_node *const new_low  = be_new_Proj_reg(ldrd, pn_arm_Ldrd_res0, low_reg);
+	ir_node *const new_high = be_new_Proj_reg(ldrd, pn_arm_Ldrd_res1, high_reg);
+
+	ir_node *const pred_m = get_Proj_for_pn(pred, pn_arm_Ldr_M);
+	ir_node *const m      = get_Proj_for_pn(node, pn_arm_Ldr_M);
+	if (pred_m != NULL || m != NULL) {
+		ir_node *const new_m = be_new_Proj(ldrd, pn_arm_Ldrd_M);
+		if (pred_m != NULL)
+			be_peephole_exchange(pred_m, new_m);
+		if (m != NULL)
+			be_peephole_exchange(m, new_m);
+	}
+	be_peephole_exchange(low_res,  new_low);
+	be_peephole_exchange(high_res, new_high);
+	be_peephole_exchange(node, ldrd);
+	be_peephole_exchange(pred, ldrd);
+}
+
+static void peephole_arm_Str_Ldr(ir_node *node)
+{
+	fix_invalid_ls_offset(node);
+
+	/* try to pair neighbouring accesses into doubleword transfers */
+	if (arm_cg_config.variant >= ARM_VARIANT_6) {
+		if (is_arm_Str(node)) {
+			peephole_arm_Str_pair(node);
+		} else {
+			peephole_arm_Ldr_pair(node);
+		}
+	}
+}
+
 /* Perform peephole-optimizations. */
 void arm_peephole_optimization(ir_graph *irg)
 {
@@ -172,13 +366,9 @@ void arm_peephole_optimization(ir_graph *irg)
 	register_peephole_optimization(op_arm_Ldr,       peephole_arm_Str_Ldr);
 	register_peephole_optimization(op_arm_FrameAddr, peephole_arm_FrameAddr);
 
+	heights = heights_new(irg);
 	be_peephole_opt(irg);
-}
-
-static inline bool arm_is_offset8(int32_t const v)
-{
-	/* Symmetrical, because ARM uses sign+magnitude for offset. */
-	return -255 <= v && v <= 255;
+	heights_free(heights);
 }
 
 static inline bool arm_is_offset12(int32_t const v)
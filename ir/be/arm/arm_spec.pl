@@ -474,6 +474,31 @@ Str => {
 	attr      => "ir_mode *ls_mode, ir_entity *entity, int entity_sign, long offset, bool is_frame_entity",
 },
 
+# Doubleword load/store (ARMv5TE+). Only created by the load/store pairing
+# peephole after register allocation, which guarantees the even/odd register
+# pair constraint.
+Ldrd => {
+	state     => "exc_pinned",
+	ins       => [ "ptr", "mem" ],
+	outs      => [ "res0", "res1", "M" ],
+	in_reqs   => [ "gp", "mem" ],
+	out_reqs  => [ "gp", "gp", "mem" ],
+	emit      => 'ldrd %D0, %D1, %A',
+	attr_type => "arm_load_store_attr_t",
+	attr      => "ir_mode *ls_mode, ir_entity *entity, int entity_sign, long offset, bool is_frame_entity",
+},
+
+Strd => {
+	state     => "exc_pinned",
+	ins       => [ "ptr", "val0", "val1", "mem" ],
+	outs      => [ "M" ],
+	in_reqs   => [ "gp", "gp", "gp", "mem" ],
+	out_reqs  => [ "mem" ],
+	emit      => 'strd %S1, %S2, %A',
+	attr_type => "arm_load_store_attr_t",
+	attr      => "ir_mode *ls_mode, ir_entity *entity, int entity_sign, long offset, bool is_frame_entity",
+},
+
 
 Adf => { template => $binopf },
 
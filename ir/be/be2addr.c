@@ -39,6 +39,26 @@ static bool is_irn_writing_reg(ir_node *const node, arch_register_t const *const
 	return false;
 }
 
+/**
+ * Returns true if the value @p value has no use after @p node, i.e. its
+ * register is free once @p node has executed. Phi uses count as uses at the
+ * end of the predecessor block and block-external uses are conservatively
+ * treated as later uses.
+ */
+static bool is_last_use(ir_node *const value, ir_node *const node)
+{
+	ir_node *const block = get_nodes_block(node);
+	foreach_out_edge(value, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		if (user == node)
+			continue;
+		if (is_Phi(user) || get_nodes_block(user) != block
+		 || !sched_comes_before(user, node))
+			return false;
+	}
+	return true;
+}
+
 static ir_node *get_result_node(ir_node *const node, unsigned const pos)
 {
 	return
@@ -69,10 +89,13 @@ static void be_handle_2addr_node(ir_node *const node, be_handle_2addr_callback_t
 			ir_node *const copy = be_new_Copy_before_reg(in_node, node, out_reg);
 			set_irn_n(node, same_as, copy);
 			DBG((dbg, LEVEL_1, "created %+F for should_be_same constraint at input %u of %+F\n", copy, same_as, node));
-		} else if (arch_get_irn_register_req_in(node, same_as)->kills_value && !is_irn_writing_reg(node, in_reg)) {
+		} else if ((arch_get_irn_register_req_in(node, same_as)->kills_value
+		            || is_last_use(in_node, node))
+		           && !is_irn_writing_reg(node, in_reg)) {
 			/* The output register is read by some other input, so a Copy to the right
 			 * output register before the instruction is not possible.  But the input
-			 * register is killed and no output is writing to the input register.
+			 * register is killed or its value dies here and no output is writing to
+			 * the input register.
 			 * Resolve this by changing the register of the output to the one of the
 			 * input (fulfilling the same-as constraint) and inserting a Copy from the
 			 * new to the old output register after the instruction. */
@@ -18,6 +18,7 @@
 #include "be_types.h"
 #include "firm_types.h"
 #include "pmap.h"
+#include "timereg.h"
 #include "timing.h"
 #include "irdump.h"
 
@@ -39,8 +40,12 @@ struct be_options_t {
 	bool opt_profile_use;      /**< use existing profile data */
 	bool omit_fp;              /**< try to omit the frame pointer */
 	bool do_verify;            /**< backend verify option */
+	int  verify_every;         /**< only verify every nth function (1: all) */
 	char ilp_solver[128];      /**< the ilp solver name */
+	char timereg_file[256];    /**< JSON pass-timing output file */
 	bool verbose_asm;          /**< dump verbose assembler */
+	bool free_graphs;          /**< free each graph right after its code
+	                                generation finished */
 };
 extern be_options_t be_options;
 
@@ -104,9 +109,13 @@ typedef enum {
 ENUM_COUNTABLE(be_timer_id_t)
 extern ir_timer_t *be_timers[T_LAST+1];
 
+const char *be_get_timer_name(be_timer_id_t id);
+
 static inline void be_timer_push(be_timer_id_t id)
 {
 	assert(id <= T_LAST);
+	if (ir_timereg_enabled)
+		ir_timereg_push(be_get_timer_name(id), NULL);
 	if (!be_timing)
 		return;
 	ir_timer_push(be_timers[id]);
@@ -115,6 +124,8 @@ static inline void be_timer_push(be_timer_id_t id)
 static inline void be_timer_pop(be_timer_id_t id)
 {
 	assert(id <= T_LAST);
+	if (ir_timereg_enabled)
+		ir_timereg_pop();
 	if (!be_timing)
 		return;
 	ir_timer_pop(be_timers[id]);
@@ -136,6 +147,12 @@ static inline void be_dump(be_dump_flags_t const mask, ir_graph *const irg,
 
 void be_initialize(void);
 
+/**
+ * Frees the resources of the currently initialized isa so another target may
+ * be selected without reinitializing the whole library.
+ */
+void be_finish_isa(void);
+
 bool be_set_arch(char const *arch);
 
 /**
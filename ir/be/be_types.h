@@ -49,6 +49,7 @@ typedef enum arch_irn_flags_t {
 } arch_irn_flags_t;
 ENUM_BITSET(arch_irn_flags_t)
 
+typedef struct be_loopana_t    be_loopana_t;
 typedef struct be_lv_t         be_lv_t;
 typedef struct be_lv_info_t    be_lv_info_t;
 typedef struct backend_info_t  backend_info_t;
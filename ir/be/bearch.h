@@ -295,6 +295,22 @@ struct arch_isa_if_t {
 
 	void (*emit_function)(char *buffer, ir_jit_function_t *function);
 
+	/** ELF machine number (EM_xxx) used when emitting relocatable objects
+	 * directly. 0 if the backend does not support direct object emission. */
+	uint16_t elf_machine;
+
+	/**
+	 * Map a backend relocation kind (as passed to be_emit_reloc_entity()) to
+	 * the matching ELF relocation type for direct object emission.
+	 */
+	uint32_t (*get_elf_reloc_type)(uint8_t be_kind);
+
+	/**
+	 * Fill @p buffer with @p size bytes of NOP instructions. Used to pad
+	 * alignment gaps when emitting code to memory or object files.
+	 */
+	void (*emit_nops)(char *buffer, unsigned size);
+
 	/**
 	 * lowers current program for target. See the documentation for
 	 * be_lower_for_target() for details.
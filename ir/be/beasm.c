@@ -12,8 +12,10 @@
 #include "beirg.h"
 #include "benode.h"
 #include "betranshlp.h"
+#include "hashptr.h"
 #include "ident_t.h"
 #include "panic.h"
+#include "set.h"
 #include "target_t.h"
 #include "util.h"
 #include "xmalloc.h"
@@ -41,7 +43,30 @@ arch_register_req_t const *be_make_register_req(struct obstack *obst, be_asm_con
 	return req;
 }
 
-void be_parse_asm_constraints_internal(be_asm_constraint_t *const constraint, ident *const constraint_text, parse_constraint_letter_func_t *const parse_constraint_letter, void const *const env)
+/**
+ * A parsed constraint descriptor.  Constraint texts are idents and macro
+ * expanded asm statements repeat the same few texts over and over, so the
+ * parse result is interned under the ident (plus parser and its
+ * environment, which differ per backend).
+ */
+typedef struct parsed_constraint_entry_t {
+	ident                          *text;
+	parse_constraint_letter_func_t *parse;
+	void const                     *env;
+	be_asm_constraint_t             constraint;
+} parsed_constraint_entry_t;
+
+static set *parsed_constraints;
+
+static int cmp_parsed_constraint(const void *a, const void *b, size_t size)
+{
+	(void)size;
+	const parsed_constraint_entry_t *p = (const parsed_constraint_entry_t*)a;
+	const parsed_constraint_entry_t *q = (const parsed_constraint_entry_t*)b;
+	return p->text != q->text || p->parse != q->parse || p->env != q->env;
+}
+
+static void parse_asm_constraints_uncached(be_asm_constraint_t *const constraint, ident *const constraint_text, parse_constraint_letter_func_t *const parse_constraint_letter, void const *const env)
 {
 	memset(constraint, 0, sizeof(*constraint));
 	constraint->same_as = -1;
@@ -150,6 +175,36 @@ void be_parse_asm_constraints_internal(be_asm_constraint_t *const constraint, id
 	constraint->immediate_type        = immediate_type;
 }
 
+void be_parse_asm_constraints_internal(be_asm_constraint_t *const constraint, ident *const constraint_text, parse_constraint_letter_func_t *const parse_constraint_letter, void const *const env)
+{
+	if (parsed_constraints == NULL)
+		parsed_constraints = new_set(cmp_parsed_constraint, 64);
+
+	parsed_constraint_entry_t key;
+	memset(&key, 0, sizeof(key));
+	key.text  = constraint_text;
+	key.parse = parse_constraint_letter;
+	key.env   = env;
+
+	unsigned hash = hash_combine(hash_ptr(constraint_text),
+	                             hash_ptr((void const*)parse_constraint_letter));
+	hash = hash_combine(hash, hash_ptr(env));
+
+	parsed_constraint_entry_t *entry
+		= set_find(parsed_constraint_entry_t, parsed_constraints, &key,
+		           sizeof(key), hash);
+	if (entry == NULL) {
+		/* diagnostics for a malformed constraint are only emitted on the
+		 * first occurrence */
+		parse_asm_constraints_uncached(&key.constraint, constraint_text,
+		                               parse_constraint_letter, env);
+		entry = set_insert(parsed_constraint_entry_t, parsed_constraints,
+		                   &key, sizeof(key), hash);
+	}
+
+	*constraint = entry->constraint;
+}
+
 /* Determine number of output operands. */
 static unsigned be_count_asm_outputs(ir_node const *const node)
 {
@@ -400,7 +455,7 @@ ir_node *be_emit_asm(ir_node const *const asmn, be_emit_asm_operand_func *const
 			 * compilation.  This is useful for making local labels that are
 			 * referred to more than once in a given insn. */
 			++s; /* Skip '='. */
-			be_emit_irprintf("%ld", get_irn_node_nr(asmn));
+			be_emit_long(get_irn_node_nr(asmn));
 			break;
 
 		default: {
@@ -18,6 +18,11 @@
  * to change as many edges to fallthroughs as possible, this is done by setting
  * a next and prev pointers on blocks. The greedy algorithm sorts the edges by
  * execution frequencies and tries to transform them to fallthroughs in this order
+ *
+ * The resulting fallthrough chains are then concatenated by decreasing
+ * execution frequency, so hot chains cluster near the function entry and
+ * rarely executed code sinks to the end. This keeps hot paths dense in the
+ * instruction cache and shortens the distance of hot branches.
  */
 #include "beblocksched.h"
 
@@ -33,6 +38,7 @@
 #include "irnode_t.h"
 #include "pdeq.h"
 #include "util.h"
+#include "xmalloc.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
 
@@ -137,6 +143,335 @@ static void remove_empty_blocks(ir_graph *irg)
 		clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
 }
 
+static bool blocks_merged;
+
+/**
+ * Returns the block that control flow value @p cf jumps to or NULL if the
+ * value has no or more than one user or is kept alive.
+ */
+static ir_node *get_cf_target(const ir_node *cf)
+{
+	ir_node *target = NULL;
+	foreach_out_edge(cf, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		if (!is_Block(user) || target != NULL)
+			return NULL;
+		target = user;
+	}
+	return target;
+}
+
+static bool block_has_phis(const ir_node *block)
+{
+	foreach_out_edge(block, edge) {
+		if (is_Phi(get_edge_src_irn(edge)))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Checks whether all results produced by @p node are only used inside
+ * @p block (control flow values may additionally have their target block
+ * as user). Code of a block with purely local results computes nothing
+ * that the rest of the graph could miss.
+ */
+static bool value_uses_are_local(const ir_node *node, const ir_node *block)
+{
+	foreach_out_edge(node, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		if (is_Proj(user) && get_nodes_block(user) == block) {
+			if (!value_uses_are_local(user, block))
+				return false;
+		} else if (is_Block(user)) {
+			if (get_irn_mode(node) != mode_X)
+				return false;
+		} else if (get_nodes_block(user) != block) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Checks whether two operands are interchangeable after register
+ * allocation. Operands computed inside the compared blocks must stem from
+ * already paired nodes (the pairing is recorded in the link fields of the
+ * second block's nodes), memory operands only encode the schedule here and
+ * any other operand must either be the very same value - so its definition
+ * dominates the merged block, too - or a register-less constant with equal
+ * attributes.
+ */
+static bool operands_equivalent(const ir_node *in1, const ir_node *in2,
+                                const ir_node *block2)
+{
+	if (in1 == in2)
+		return true;
+	if (get_irn_mode(in1) == mode_M)
+		return get_irn_mode(in2) == mode_M;
+	if (get_irn_mode(in1) != get_irn_mode(in2))
+		return false;
+	if (is_Proj(in2)) {
+		if (!is_Proj(in1) || get_Proj_num(in1) != get_Proj_num(in2))
+			return false;
+		in1 = get_Proj_pred(in1);
+		in2 = get_Proj_pred(in2);
+		if (in1 == in2)
+			return true;
+	}
+	if (get_nodes_block(in2) == block2)
+		return get_irn_link(in2) == in1;
+	if (get_irn_op(in1) != get_irn_op(in2) || get_irn_arity(in1) != 0
+	 || get_irn_arity(in2) != 0)
+		return false;
+	if (arch_get_irn_register(in1) != NULL
+	 || arch_get_irn_register(in2) != NULL)
+		return false;
+	return in1->op->ops.attrs_equal(in1, in2);
+}
+
+/**
+ * Checks whether @p n1 and @p n2 denote the same instruction: same
+ * operation with equal attributes, equal result registers and equivalent
+ * operands.
+ */
+static bool nodes_equivalent(const ir_node *n1, const ir_node *n2,
+                             const ir_node *block2)
+{
+	if (get_irn_op(n1) != get_irn_op(n2)
+	 || get_irn_mode(n1) != get_irn_mode(n2)
+	 || get_irn_arity(n1) != get_irn_arity(n2))
+		return false;
+	if (!n1->op->ops.attrs_equal(n1, n2))
+		return false;
+	unsigned const n_outs = arch_get_irn_n_outs(n1);
+	if (arch_get_irn_n_outs(n2) != n_outs)
+		return false;
+	for (unsigned o = 0; o < n_outs; ++o) {
+		if (arch_get_irn_register_out(n1, o)
+		    != arch_get_irn_register_out(n2, o))
+			return false;
+	}
+	foreach_irn_in(n1, i, in1) {
+		if (!operands_equivalent(in1, get_irn_n(n2, i), block2))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Checks whether the control flow results of @p n1 and @p n2 jump to the
+ * same blocks. Jumps back into one of the compared blocks are rejected.
+ */
+static bool succs_equivalent(const ir_node *n1, const ir_node *n2,
+                             const ir_node *block1, const ir_node *block2)
+{
+	ir_mode *const mode = get_irn_mode(n1);
+	if (mode == mode_X) {
+		ir_node *const target = get_cf_target(n1);
+		return target != NULL && target != block1 && target != block2
+		    && target == get_cf_target(n2);
+	}
+	if (mode != mode_T)
+		return true;
+
+	foreach_out_edge(n1, edge) {
+		ir_node *const proj1 = get_edge_src_irn(edge);
+		if (!is_Proj(proj1) || get_irn_mode(proj1) != mode_X)
+			continue;
+		ir_node *const proj2 = get_Proj_for_pn(n2, get_Proj_num(proj1));
+		if (proj2 == NULL)
+			return false;
+		ir_node *const target = get_cf_target(proj1);
+		if (target == NULL || target == block1 || target == block2
+		 || target != get_cf_target(proj2))
+			return false;
+	}
+	/* the second node must not have additional control flow exits */
+	foreach_out_edge(n2, edge) {
+		ir_node *const proj2 = get_edge_src_irn(edge);
+		if (is_Proj(proj2) && get_irn_mode(proj2) == mode_X
+		 && get_Proj_for_pn(n1, get_Proj_num(proj2)) == NULL)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Checks whether the schedules of @p block1 and @p block2 denote the same
+ * instruction sequence with the same control flow successors. Pairs of
+ * matching nodes are linked so operand checks of later nodes can refer to
+ * them.
+ */
+static bool blocks_equivalent(ir_node *block1, ir_node *block2)
+{
+	ir_node *n1 = sched_first(block1);
+	ir_node *n2 = sched_first(block2);
+	while (!sched_is_end(n1) && !sched_is_end(n2)) {
+		if (!nodes_equivalent(n1, n2, block2)
+		 || !succs_equivalent(n1, n2, block1, block2))
+			return false;
+		set_irn_link(n2, n1);
+		n1 = sched_next(n1);
+		n2 = sched_next(n2);
+	}
+	return sched_is_end(n1) && sched_is_end(n2);
+}
+
+/**
+ * Block-walker: Collect blocks which may be replaced by an identical
+ * duplicate. Such a block must compute nothing the rest of the graph uses,
+ * must not carry a label or keep-alive edges and removing one of its
+ * successors' predecessors must not disturb Phis.
+ */
+static void collect_merge_candidates(ir_node *block, void *data)
+{
+	ir_node ***const blocks = (ir_node***)data;
+	ir_graph  *const irg    = get_irn_irg(block);
+	if (block == get_irg_start_block(irg)
+	 || block == get_irg_end_block(irg))
+		return;
+	if (get_Block_entity(block) != NULL)
+		return;
+	/* blocks containing only a jump are handled by remove_empty_blocks() */
+	if (sched_is_end(sched_first(block)))
+		return;
+	if (block_has_phis(block))
+		return;
+	foreach_block_succ(block, edge) {
+		if (block_has_phis(get_edge_src_irn(edge)))
+			return;
+	}
+	/* no keep-alive edges and no leftover Pin or Sync nodes */
+	foreach_out_edge(block, edge) {
+		ir_node *const node = get_edge_src_irn(edge);
+		if (!is_Proj(node)
+		 && (get_nodes_block(node) != block || !sched_is_scheduled(node)))
+			return;
+	}
+	sched_foreach(block, node) {
+		if (!value_uses_are_local(node, block))
+			return;
+	}
+	ARR_APP1(ir_node*, *blocks, block);
+}
+
+/**
+ * Computes a hash over the instruction sequence of @p block for cheap
+ * pre-filtering of merge candidates.
+ */
+static unsigned block_content_hash(ir_node *block)
+{
+	unsigned hash = 0;
+	sched_foreach(block, node) {
+		hash = hash * 31 + (unsigned)get_irn_opcode(node);
+		hash = hash * 31 + (unsigned)get_irn_arity(node);
+		for (unsigned o = 0, n_outs = arch_get_irn_n_outs(node);
+		     o < n_outs; ++o) {
+			arch_register_t const *const reg
+				= arch_get_irn_register_out(node, o);
+			hash = hash * 31 + (reg != NULL ? reg->global_index + 1u : 0u);
+		}
+	}
+	return hash;
+}
+
+/**
+ * Removes the predecessor entry of control flow value @p cf from its
+ * target block.
+ */
+static void detach_cf_value(ir_node *cf)
+{
+	ir_node  *const succ      = get_cf_target(cf);
+	int       const arity     = get_Block_n_cfgpreds(succ);
+	ir_node **const in        = ALLOCAN(ir_node*, arity);
+	int             new_arity = 0;
+	for (int i = 0; i < arity; ++i) {
+		ir_node *const pred = get_Block_cfgpred(succ, i);
+		if (pred != cf)
+			in[new_arity++] = pred;
+	}
+	set_irn_in(succ, new_arity, in);
+}
+
+/**
+ * Redirects all jumps to @p block2 to the identical @p block1; block2
+ * becomes unreachable. The instruction sequences are the same machine
+ * code, so entering block1 instead has the same effect on every register.
+ * block2's memory operands stay behind in the unreachable code - after
+ * register allocation memory edges only encode instruction order.
+ */
+static void merge_blocks(ir_node *block1, ir_node *block2)
+{
+	DB((dbg, LEVEL_1, "Merge duplicated %+F into %+F\n", block2, block1));
+
+	int const arity1 = get_Block_n_cfgpreds(block1);
+	int const arity2 = get_Block_n_cfgpreds(block2);
+	ir_node **const in = ALLOCAN(ir_node*, arity1 + arity2);
+	for (int i = 0; i < arity1; ++i)
+		in[i] = get_Block_cfgpred(block1, i);
+	for (int i = 0; i < arity2; ++i)
+		in[arity1 + i] = get_Block_cfgpred(block2, i);
+	set_irn_in(block1, arity1 + arity2, in);
+
+	/* detach block2 from its successors */
+	sched_foreach(block2, node) {
+		ir_mode *const mode = get_irn_mode(node);
+		if (mode == mode_X) {
+			detach_cf_value(node);
+		} else if (mode == mode_T) {
+			foreach_out_edge_safe(node, edge) {
+				ir_node *const proj = get_edge_src_irn(edge);
+				if (is_Proj(proj) && get_irn_mode(proj) == mode_X)
+					detach_cf_value(proj);
+			}
+		}
+	}
+	set_irn_in(block2, 0, NULL);
+	blocks_merged = true;
+}
+
+/* replaces blocks that are an exact duplicate of another block by a jump
+ * to that block, typically collapsing replicated error handling and
+ * return sequences into a single copy */
+static void merge_duplicated_blocks(ir_graph *irg)
+{
+	blocks_merged = false;
+
+	ir_node **blocks = NEW_ARR_F(ir_node*, 0);
+	irg_block_walk_graph(irg, collect_merge_candidates, NULL, &blocks);
+
+	size_t    const n_blocks = ARR_LEN(blocks);
+	unsigned *const hashes   = XMALLOCN(unsigned, n_blocks);
+	for (size_t i = 0; i < n_blocks; ++i)
+		hashes[i] = block_content_hash(blocks[i]);
+
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
+	for (size_t i = 0; i < n_blocks; ++i) {
+		ir_node *const block1 = blocks[i];
+		if (block1 == NULL)
+			continue;
+		for (size_t j = i + 1; j < n_blocks; ++j) {
+			ir_node *const block2 = blocks[j];
+			if (block2 == NULL || hashes[j] != hashes[i])
+				continue;
+			if (!blocks_equivalent(block1, block2))
+				continue;
+			merge_blocks(block1, block2);
+			blocks[j] = NULL;
+		}
+	}
+	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+
+	free(hashes);
+	DEL_ARR_F(blocks);
+
+	if (blocks_merged) {
+		clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+		                        | IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+	}
+}
+
 typedef struct blocksched_entry_t blocksched_entry_t;
 struct blocksched_entry_t {
 	ir_node            *block;
@@ -408,88 +743,46 @@ static void coalesce_blocks(blocksched_env_t *env)
 	}
 }
 
-static void pick_block_successor(blocksched_entry_t *entry, blocksched_env_t *env)
-{
-	ir_node *const block = entry->block;
-	if (irn_visited_else_mark(block))
-		return;
-
-	env->blockcount++;
-
-	DB((dbg, LEVEL_1, "Pick succ of %+F\n", block));
-
-	/* put all successors into the worklist */
-	foreach_block_succ(block, edge) {
-		ir_node *succ_block = get_edge_src_irn(edge);
-
-		if (irn_visited(succ_block))
-			continue;
-
-		/* we only need to put the first of a series of already connected
-		 * blocks into the worklist */
-		blocksched_entry_t *succ_entry = get_blocksched_entry(succ_block);
-		while (succ_entry->prev != NULL) {
-			/* break cycles... */
-			if (succ_entry->prev->block == succ_block) {
-				succ_entry->prev->next = NULL;
-				succ_entry->prev       = NULL;
-				break;
-			}
-			succ_entry = succ_entry->prev;
-		}
-
-		if (irn_visited(succ_entry->block))
-			continue;
+typedef struct chain_t {
+	blocksched_entry_t *first; /**< head of the fallthrough chain */
+	blocksched_entry_t *last;  /**< tail of the fallthrough chain */
+	double              freq;  /**< accumulated execution frequency */
+} chain_t;
 
-		DB((dbg, LEVEL_1, "Put %+F into worklist\n", succ_entry->block));
-		deq_push_pointer_right(&env->worklist, succ_entry->block);
-	}
-
-	if (entry->next != NULL) {
-		pick_block_successor(entry->next, env);
-		return;
+static int cmp_chains(const void *d1, const void *d2)
+{
+	const chain_t *c1 = (const chain_t*)d1;
+	const chain_t *c2 = (const chain_t*)d2;
+	if (c1->freq < c2->freq) {
+		return 1;
+	} else if (c1->freq > c2->freq) {
+		return -1;
+	} else {
+		/* be deterministic */
+		long nr1 = get_irn_node_nr(c1->first->block);
+		long nr2 = get_irn_node_nr(c2->first->block);
+		return (nr1 < nr2) - (nr1 > nr2);
 	}
+}
 
-	DB((dbg, LEVEL_1, "deciding...\n"));
-	double best_succ_execfreq = -1;
-
-	/* no successor yet: pick the successor block with the highest execution
-	 * frequency which has no predecessor yet */
-
-	ir_node *succ = NULL;
-	foreach_block_succ(block, edge) {
-		ir_node *const succ_block = get_edge_src_irn(edge);
-		if (irn_visited(succ_block))
-			continue;
-
-		blocksched_entry_t *const succ_entry = get_blocksched_entry(succ_block);
-		if (succ_entry->prev != NULL)
-			continue;
-
-		double execfreq = get_block_execfreq(succ_block);
-		if (best_succ_execfreq < execfreq) {
-			best_succ_execfreq = execfreq;
-			succ               = succ_block;
+/**
+ * Returns the head of the fallthrough chain containing @p entry. The
+ * coalescing may have formed a closed cycle of blocks; in this case the
+ * chain is cut open behind @p entry.
+ */
+static blocksched_entry_t *get_chain_head(blocksched_entry_t *entry)
+{
+	blocksched_entry_t *head = entry;
+	while (head->prev != NULL) {
+		/* break cycles... */
+		if (head->prev == entry) {
+			entry->next = NULL;
+			head->prev  = NULL;
+			break;
 		}
+		head = head->prev;
 	}
-
-	if (succ == NULL) {
-		DB((dbg, LEVEL_1, "pick from worklist\n"));
-
-		do {
-			if (deq_empty(&env->worklist)) {
-				DB((dbg, LEVEL_1, "worklist empty\n"));
-				return;
-			}
-			succ = deq_pop_pointer_left(ir_node, &env->worklist);
-		} while (irn_visited(succ));
-	}
-
-	blocksched_entry_t *const succ_entry = get_blocksched_entry(succ);
-	entry->next      = succ_entry;
-	succ_entry->prev = entry;
-
-	pick_block_successor(succ_entry, env);
+	return head;
 }
 
 static blocksched_entry_t *finish_block_schedule(blocksched_env_t *env)
@@ -501,16 +794,57 @@ static blocksched_entry_t *finish_block_schedule(blocksched_env_t *env)
 	/* Exclude the end block from the block schedule. */
 	mark_irn_visited(get_irg_end_block(irg));
 
+	/* collect all reachable fallthrough chains and their frequencies */
+	chain_t *chains = NEW_ARR_F(chain_t, 0);
 	deq_init(&env->worklist);
-	ir_node            *const startblock = get_irg_start_block(irg);
-	blocksched_entry_t *const entry      = get_blocksched_entry(startblock);
-	pick_block_successor(entry, env);
-	assert(deq_empty(&env->worklist));
-	deq_free(&env->worklist);
+	deq_push_pointer_right(&env->worklist, get_irg_start_block(irg));
+	while (!deq_empty(&env->worklist)) {
+		ir_node *const block = deq_pop_pointer_left(ir_node, &env->worklist);
+		if (irn_visited(block))
+			continue;
 
+		/* chains are visited as a whole, so an unvisited block means an
+		 * entirely unvisited chain */
+		chain_t chain = { .first = get_chain_head(get_blocksched_entry(block)) };
+		for (blocksched_entry_t *entry = chain.first; entry != NULL;
+		     entry = entry->next) {
+			ir_node *const chain_block = entry->block;
+			mark_irn_visited(chain_block);
+			env->blockcount++;
+			chain.freq += get_block_execfreq(chain_block);
+			chain.last  = entry;
+
+			foreach_block_succ(chain_block, edge) {
+				ir_node *const succ_block = get_edge_src_irn(edge);
+				if (!irn_visited(succ_block)) {
+					DB((dbg, LEVEL_1, "Put %+F into worklist\n", succ_block));
+					deq_push_pointer_right(&env->worklist, succ_block);
+				}
+			}
+		}
+		DB((dbg, LEVEL_1, "Chain %+F..%+F (%.3g)\n", chain.first->block,
+		    chain.last->block, chain.freq));
+		ARR_APP1(chain_t, chains, chain);
+	}
+	deq_free(&env->worklist);
 	ir_free_resources(irg, IR_RESOURCE_IRN_VISITED);
 
-	return entry;
+	/* concatenate the chains by decreasing frequency; the chain of the start
+	 * block must stay first */
+	size_t const n_chains = ARR_LEN(chains);
+	QSORT(&chains[1], n_chains - 1, cmp_chains);
+
+	blocksched_entry_t *const first = chains[0].first;
+	blocksched_entry_t *last        = chains[0].last;
+	for (size_t i = 1; i < n_chains; ++i) {
+		chain_t *const chain = &chains[i];
+		last->next         = chain->first;
+		chain->first->prev = last;
+		last               = chain->last;
+	}
+	DEL_ARR_F(chains);
+
+	return first;
 }
 
 static ir_node **create_blocksched_array(blocksched_env_t *const env)
@@ -541,6 +875,8 @@ ir_node **be_create_block_schedule(ir_graph *irg)
 	};
 	obstack_init(&env.obst);
 
+	merge_duplicated_blocks(irg);
+
 	assure_loopinfo(irg);
 
 	// collect edge execution frequencies
@@ -307,16 +307,20 @@ static void be_ra_chordal_main(ir_graph *irg, const regalloc_if_t *regif)
 	be_timer_pop(T_RA_OTHER);
 }
 
-BE_REGISTER_MODULE_CONSTRUCTOR(be_init_chordal_main)
-void be_init_chordal_main(void)
+static void register_chordal_main_options(void)
 {
 	lc_opt_entry_t *be_grp      = lc_opt_get_grp(firm_opt_get_root(), "be");
 	lc_opt_entry_t *ra_grp      = lc_opt_get_grp(be_grp, "ra");
 	lc_opt_entry_t *chordal_grp = lc_opt_get_grp(ra_grp, "chordal");
 
-	be_register_allocator("chordal", be_ra_chordal_main);
-
 	lc_opt_add_table(chordal_grp, be_chordal_options);
 	be_add_module_list_opt(chordal_grp, "coloring", "select coloring method",
 	                       &colorings, (void**) &selected_coloring);
 }
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_chordal_main)
+void be_init_chordal_main(void)
+{
+	be_register_module_options(register_chordal_main_options);
+	be_register_allocator("chordal", be_ra_chordal_main);
+}
@@ -58,6 +58,7 @@ typedef float real_t;
 
 static unsigned last_chunk_id;
 static int      recolor_limit     = 7;
+static int      visit_budget      = 0;
 static double   dislike_influence = REAL(0.1);
 
 typedef struct col_cost_t {
@@ -103,6 +104,8 @@ typedef struct co_mst_env_t {
 	col_cost_t     **single_cols;
 	unsigned         n_regs;           /**< number of regs in class */
 	unsigned         chunk_visited;
+	long             visits_left;      /**< remaining node-visit budget for
+	                                        recoloring, < 0 means unlimited */
 } co_mst_env_t;
 
 /* stores coalescing related information for a node */
@@ -900,6 +903,15 @@ static bool recolor_nodes(co_mst_env_t *env, co_mst_irn_t *node,
 	if (depth > *max_depth)
 		*max_depth = depth;
 
+	/* respect the node-visit budget: once it is used up all further
+	 * recoloring attempts fail and the nodes keep their current colors */
+	if (env->visits_left == 0) {
+		DBG((dbg, LEVEL_4, "\tNode-visit budget exhausted\n"));
+		return false;
+	}
+	if (env->visits_left > 0)
+		--env->visits_left;
+
 	DBG((dbg, LEVEL_4, "\tRecoloring %+F with color-costs", node->irn));
 	DBG_COL_COST(env, LEVEL_4, costs);
 	DB((dbg, LEVEL_4, "\n"));
@@ -1233,7 +1245,7 @@ static void color_aff_chunk(co_mst_env_t *env, aff_chunk_t *c)
 /**
  * Main driver for mst safe coalescing algorithm.
  */
-static int co_solve_heuristic_mst(copy_opt_t *co)
+int co_solve_heuristic_mst(copy_opt_t *co)
 {
 	last_chunk_id = 0;
 
@@ -1253,6 +1265,7 @@ static int co_solve_heuristic_mst(copy_opt_t *co)
 	mst_env.ifg              = co->cenv->ifg;
 	INIT_LIST_HEAD(&mst_env.chunklist);
 	mst_env.chunk_visited    = 0;
+	mst_env.visits_left      = visit_budget > 0 ? visit_budget : -1;
 	mst_env.single_cols      = OALLOCN(&mst_env.obst, col_cost_t*, n_regs);
 
 	for (unsigned i = 0; i < n_regs; ++i) {
@@ -1275,11 +1288,14 @@ static int co_solve_heuristic_mst(copy_opt_t *co)
 	build_affinity_chunks(&mst_env);
 	stat_ev_tim_pop("heur4_initial_chunk");
 
-	/* color chunks as long as there are some */
+	/* color chunks as long as there are some; the heaviest chunks are
+	 * popped first, so an exhausted visit budget degrades gracefully by
+	 * leaving only the lightest chunks at their initial coloring */
 	while (!pqueue_empty(mst_env.chunks)) {
 		aff_chunk_t *chunk = (aff_chunk_t*)pqueue_pop_front(mst_env.chunks);
 
-		color_aff_chunk(&mst_env, chunk);
+		if (mst_env.visits_left != 0)
+			color_aff_chunk(&mst_env, chunk);
 		DB((dbg, LEVEL_4, "<<<====== Coloring chunk (%u) done\n", chunk->id));
 		delete_aff_chunk(chunk);
 	}
@@ -1310,24 +1326,31 @@ static int co_solve_heuristic_mst(copy_opt_t *co)
 
 static const lc_opt_table_entry_t options[] = {
 	LC_OPT_ENT_INT("limit", "limit recoloring",  &recolor_limit),
+	LC_OPT_ENT_INT("budget",
+	               "node visit budget for recoloring (0: unlimited)",
+	               &visit_budget),
 	LC_OPT_ENT_DBL("di",    "dislike influence", &dislike_influence),
 	LC_OPT_LAST
 };
 
-BE_REGISTER_MODULE_CONSTRUCTOR(be_init_copyheur4)
-void be_init_copyheur4(void)
+static void register_copyheur4_options(void)
 {
 	lc_opt_entry_t *be_grp      = lc_opt_get_grp(firm_opt_get_root(), "be");
 	lc_opt_entry_t *ra_grp      = lc_opt_get_grp(be_grp, "ra");
 	lc_opt_entry_t *chordal_grp = lc_opt_get_grp(ra_grp, "chordal");
 	lc_opt_entry_t *co_grp      = lc_opt_get_grp(chordal_grp, "co");
 	lc_opt_entry_t *heur4_grp   = lc_opt_get_grp(co_grp, "heur4");
+	lc_opt_add_table(heur4_grp, options);
+}
 
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_copyheur4)
+void be_init_copyheur4(void)
+{
 	static co_algo_info copyheur = {
 		co_solve_heuristic_mst
 	};
 
-	lc_opt_add_table(heur4_grp, options);
+	be_register_module_options(register_copyheur4_options);
 	be_register_copyopt("heur4", &copyheur);
 
 	FIRM_DBG_REGISTER(dbg, "firm.be.co.heur4");
@@ -46,8 +46,7 @@ static const lc_opt_table_entry_t options[] = {
 	LC_OPT_LAST
 };
 
-BE_REGISTER_MODULE_CONSTRUCTOR(be_init_copyilp)
-void be_init_copyilp(void)
+static void register_copyilp_options(void)
 {
 	lc_opt_entry_t *be_grp = lc_opt_get_grp(firm_opt_get_root(), "be");
 	lc_opt_entry_t *ra_grp = lc_opt_get_grp(be_grp, "ra");
@@ -58,6 +57,12 @@ void be_init_copyilp(void)
 	lc_opt_add_table(ilp_grp, options);
 }
 
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_copyilp)
+void be_init_copyilp(void)
+{
+	be_register_module_options(register_copyilp_options);
+}
+
 /******************************************************************************
     _____ _                        _            _   _
    / ____(_)                      | |          | | (_)
@@ -84,7 +89,7 @@ static inline bool sr_is_simplicial(ilp_env_t *const ienv, ir_node const *const
 
 		/* Check whether the current node forms a clique with all previous nodes. */
 		for (size_t i = ARR_LEN(all); i-- != 0;) {
-			if (!be_values_interfere(curr, all[i])) {
+			if (!be_ifg_interfere(ienv->co->cenv->ifg, curr, all[i])) {
 				res = false;
 				goto end;
 			}
@@ -32,10 +32,13 @@
 #include "bearch.h"
 #include "becopyilp_t.h"
 #include "becopyopt_t.h"
+#include "beifg.h"
 #include "belive.h"
 #include "bemodule.h"
 #include "debug.h"
 #include "irprintf.h"
+#include "irtools.h"
+#include "lc_opts.h"
 #include "panic.h"
 #include "pdeq.h"
 
@@ -321,7 +324,7 @@ static void build_clique_star_cstr(ilp_env_t *ienv)
 		size_t n_edges = 0;
 		for (int i = 0; i < n_nodes; ++i) {
 			for (int o = 0; o < i; ++o) {
-				if (be_values_interfere(nodes[i], nodes[o]))
+				if (be_ifg_interfere(ienv->co->cenv->ifg, nodes[i], nodes[o]))
 					add_edge(edges, nodes[i], nodes[o], &n_edges);
 			}
 		}
@@ -437,12 +440,12 @@ static void extend_path(ilp_env_t *ienv, deq_t *path, const ir_node *irn)
 	}
 
 	for (int i = 1; i < len; ++i) {
-		if (be_values_interfere(irn, curr_path[i]))
+		if (be_ifg_interfere(ienv->co->cenv->ifg, irn, curr_path[i]))
 			goto end;
 	}
 
 	/* check for terminating interference */
-	if (be_values_interfere(irn, curr_path[0])) {
+	if (be_ifg_interfere(ienv->co->cenv->ifg, irn, curr_path[0])) {
 		/* One node is not a path. */
 		/* And a path of length 2 is covered by a clique star constraint. */
 		if (len > 2) {
@@ -547,6 +550,8 @@ static void ilp2_apply(ilp_env_t *const ienv)
  * Uses the OU and the GRAPH data structure
  * Dependency of the OU structure can be removed
  */
+static bool warm_start = true;
+
 static int co_solve_ilp2(copy_opt_t *const co)
 {
 	ASSERT_OU_AVAIL(co); //See build_clique_st
@@ -554,6 +559,12 @@ static int co_solve_ilp2(copy_opt_t *const co)
 
 	FIRM_DBG_REGISTER(dbg, "firm.be.coilp2");
 
+	/* run the clustering heuristic first: its coloring becomes the start
+	 * solution of the solver and the result we keep when the time limit
+	 * expires before an optimal solution is found */
+	if (warm_start)
+		co_solve_heuristic_mst(co);
+
 	local_env_t my;
 	my.first_x_var = -1;
 	my.last_x_var  = -1;
@@ -565,6 +576,23 @@ static int co_solve_ilp2(copy_opt_t *const co)
 	return sol_state == lpp_optimal;
 }
 
+static const lc_opt_table_entry_t options[] = {
+	LC_OPT_ENT_BOOL("warmstart",
+	                "warm-start the solver from the heur4 coloring",
+	                &warm_start),
+	LC_OPT_LAST
+};
+
+static void register_copyilp2_options(void)
+{
+	lc_opt_entry_t *be_grp      = lc_opt_get_grp(firm_opt_get_root(), "be");
+	lc_opt_entry_t *ra_grp      = lc_opt_get_grp(be_grp, "ra");
+	lc_opt_entry_t *chordal_grp = lc_opt_get_grp(ra_grp, "chordal");
+	lc_opt_entry_t *co_grp      = lc_opt_get_grp(chordal_grp, "co");
+	lc_opt_entry_t *ilp_grp     = lc_opt_get_grp(co_grp, "ilp");
+	lc_opt_add_table(ilp_grp, options);
+}
+
 BE_REGISTER_MODULE_CONSTRUCTOR(be_init_copyilp2)
 void be_init_copyilp2(void)
 {
@@ -573,4 +601,5 @@ void be_init_copyilp2(void)
 	};
 
 	be_register_copyopt("ilp", &copyheur);
+	be_register_module_options(register_copyilp2_options);
 }
@@ -36,6 +36,7 @@
 
 enum {
 	LEVEL_NONE,
+	LEVEL_LINES, /**< only line information (.file/.loc), no DIEs */
 	LEVEL_BASIC,
 	LEVEL_LOCATIONS,
 	LEVEL_FRAMEINFO
@@ -305,7 +306,9 @@ static void emit_pubnames(void)
 
 void be_dwarf_location(dbg_info *dbgi)
 {
-	if (debug_level < LEVEL_LOCATIONS)
+	/* the lines-only level emits just the line table; LEVEL_BASIC keeps
+	 * its old meaning of DIEs without line information */
+	if (debug_level < LEVEL_LOCATIONS && debug_level != LEVEL_LINES)
 		return;
 	src_loc_t loc = ir_retrieve_dbg_info(dbgi);
 	if (!loc.file)
@@ -927,7 +930,7 @@ void be_dwarf_unit_end(void)
 
 void be_dwarf_close(void)
 {
-	if (debug_level < LEVEL_BASIC)
+	if (debug_level < LEVEL_LINES)
 		return;
 	pmap_destroy(env.file_map);
 	DEL_ARR_F(env.file_list);
@@ -938,7 +941,7 @@ void be_dwarf_close(void)
 /* Opens a dwarf handler */
 void be_dwarf_open(void)
 {
-	if (debug_level < LEVEL_BASIC)
+	if (debug_level < LEVEL_LINES)
 		return;
 	env.file_map      = pmap_create();
 	env.file_list     = NEW_ARR_F(const char*, 0);
@@ -957,11 +960,11 @@ void be_dwarf_set_compilation_directory(const char *new_comp_dir)
 	comp_dir = xstrdup(new_comp_dir);
 }
 
-BE_REGISTER_MODULE_CONSTRUCTOR(be_init_dwarf)
-void be_init_dwarf(void)
+static void register_dwarf_options(void)
 {
 	static const lc_opt_enum_int_items_t level_items[] = {
 		{ "none",      LEVEL_NONE },
+		{ "lines",     LEVEL_LINES },
 		{ "basic",     LEVEL_BASIC },
 		{ "locations", LEVEL_LOCATIONS },
 		{ "frameinfo", LEVEL_FRAMEINFO },
@@ -987,3 +990,9 @@ void be_init_dwarf(void)
 	lc_opt_entry_t *dwarf_grp = lc_opt_get_grp(be_grp, "dwarf");
 	lc_opt_add_table(dwarf_grp, dwarf_options);
 }
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_dwarf)
+void be_init_dwarf(void)
+{
+	be_register_module_options(register_dwarf_options);
+}
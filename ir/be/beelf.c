@@ -0,0 +1,460 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Write jit compiled functions as relocatable ELF object files
+ *
+ * This is the integrated alternative to routing machine code through the
+ * assembler: the bytes produced by the backend encoders are packed into a
+ * .text section, jump targets inside a function are resolved directly and
+ * references to entities become ELF relocations against (undefined) symbols.
+ * Only little endian targets are supported, which covers both backends with
+ * binary encoders (ia32 and amd64).
+ */
+#include "array.h"
+#include "bearch.h"
+#include "bejit.h"
+#include "bitfiddle.h"
+#include "entity_t.h"
+#include "panic.h"
+#include "pmap.h"
+#include "target_t.h"
+#include "util.h"
+#include "xmalloc.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+typedef struct object_function_t {
+	ir_entity         *entity;
+	ir_jit_function_t *function;
+} object_function_t;
+
+struct ir_jit_object_t {
+	object_function_t *functions; /**< flexible array of added functions */
+};
+
+/** Architecture independent form of an ELF symbol table entry. */
+typedef struct elf_symbol_t {
+	uint32_t name;  /**< Offset into .strtab */
+	uint64_t value;
+	uint64_t size;
+	uint8_t  info;  /**< Binding and type */
+	uint16_t shndx; /**< Defining section or SHN_UNDEF */
+} elf_symbol_t;
+
+/** Architecture independent form of an ELF relocation entry. */
+typedef struct elf_reloc_t {
+	uint64_t offset; /**< Offset of the relocation slot in .text */
+	uint32_t type;   /**< ELF relocation type */
+	uint32_t symbol; /**< Symbol table index */
+	int64_t  addend;
+} elf_reloc_t;
+
+typedef struct elf_writer_t {
+	struct obstack strtab;
+	elf_symbol_t  *symbols;        /**< flexible array */
+	elf_reloc_t   *relocs;         /**< flexible array */
+	pmap          *symbol_indices; /**< ir_entity* -> symbol table index */
+	bool           is64;
+} elf_writer_t;
+
+enum {
+	ELF_SHT_PROGBITS = 1,
+	ELF_SHT_SYMTAB   = 2,
+	ELF_SHT_STRTAB   = 3,
+	ELF_SHT_RELA     = 4,
+	ELF_SHT_REL      = 9,
+};
+
+enum {
+	ELF_SHF_ALLOC     = 0x2,
+	ELF_SHF_EXECINSTR = 0x4,
+	ELF_SHF_INFO_LINK = 0x40,
+};
+
+enum {
+	ELF_STB_GLOBAL = 1,
+	ELF_STT_FUNC   = 2,
+	ELF_STT_SECTION = 3,
+};
+
+/** Section header table layout of the produced files. */
+enum {
+	SECTION_NULL,
+	SECTION_TEXT,
+	SECTION_RELOC,
+	SECTION_SYMTAB,
+	SECTION_STRTAB,
+	SECTION_NOTE_GNUSTACK, /**< empty, marks the stack as not executable */
+	SECTION_SHSTRTAB,
+	N_SECTIONS
+};
+
+/** Index of the first global symbol (0 is the null symbol, 1 the .text
+ * section symbol). */
+#define FIRST_GLOBAL_SYMBOL 2
+
+/** Alignment of each function in the .text section. */
+#define FUNCTION_P2ALIGN 4
+
+ir_jit_object_t *be_new_jit_object(void)
+{
+	ir_jit_object_t *const object = XMALLOCZ(ir_jit_object_t);
+	object->functions = NEW_ARR_F(object_function_t, 0);
+	return object;
+}
+
+void be_destroy_jit_object(ir_jit_object_t *const object)
+{
+	DEL_ARR_F(object->functions);
+	free(object);
+}
+
+void be_jit_object_add_function(ir_jit_object_t *const object,
+                                ir_entity *const entity,
+                                ir_jit_function_t *const function)
+{
+	object_function_t const f = { .entity = entity, .function = function };
+	ARR_APP1(object_function_t, object->functions, f);
+}
+
+static uint32_t put_string(struct obstack *const obst, char const *const str)
+{
+	uint32_t const res = obstack_object_size(obst);
+	obstack_grow(obst, str, strlen(str) + 1);
+	return res;
+}
+
+static uint32_t get_entity_symbol(elf_writer_t *const env,
+                                  ir_entity *const entity)
+{
+	void *const in_map = pmap_get(void, env->symbol_indices, entity);
+	if (in_map != NULL)
+		return (uint32_t)PTR_TO_INT(in_map);
+
+	uint32_t     const index = ARR_LEN(env->symbols);
+	elf_symbol_t const sym = {
+		.name  = put_string(&env->strtab, get_entity_ld_name(entity)),
+		.info  = ELF_STB_GLOBAL << 4, /* undefined, STT_NOTYPE */
+		.shndx = 0,                   /* SHN_UNDEF */
+	};
+	ARR_APP1(elf_symbol_t, env->symbols, sym);
+	pmap_insert(env->symbol_indices, entity, INT_TO_PTR(index));
+	return index;
+}
+
+static void write_le32(char *const buffer, uint32_t const value)
+{
+	buffer[0] = (char)(value      );
+	buffer[1] = (char)(value >>  8);
+	buffer[2] = (char)(value >> 16);
+	buffer[3] = (char)(value >> 24);
+}
+
+/**
+ * Copy the code of @p function to @p buffer (a slice of the .text contents
+ * beginning at @p function_offset), resolve fragment internal relocations
+ * and turn entity references into ELF relocations.
+ */
+static void emit_function_code(elf_writer_t *const env,
+                               ir_jit_function_t const *const function,
+                               unsigned const function_offset,
+                               char *const buffer)
+{
+	char const *const code         = function->code;
+	unsigned          orig_address = 0;
+	unsigned          last_address = 0;
+	for (size_t i = 0, n = function->n_fragments; i < n; ++i) {
+		fragment_info_t const *const fragment  = function->fragment_infos[i];
+		unsigned               const address   = fragment->address;
+		unsigned               const nop_bytes = address - last_address;
+		assert(address >= last_address);
+		if (nop_bytes > 0)
+			ir_target.isa->emit_nops(buffer + last_address, nop_bytes);
+
+		memcpy(buffer + address, code + orig_address, fragment->len);
+
+		for (unsigned r = 0, m = fragment->n_relocations; r < m; ++r) {
+			relocation_t const *const reloc = &fragment->relocations[r];
+			char *const slot = buffer + address + reloc->offset;
+
+			switch (reloc->dest_kind) {
+			case RELOC_DEST_CODE_FRAGMENT: {
+				fragment_info_t const *const dest
+					= function->fragment_infos[reloc->dest.fragment_num];
+				int32_t const value
+					= (int32_t)(dest->address + reloc->dest_offset)
+					- (int32_t)(address + reloc->offset);
+				assert(reloc->len == 4);
+				write_le32(slot, (uint32_t)value);
+				continue;
+			}
+			case RELOC_DEST_ENTITY: {
+				elf_reloc_t const elf_reloc = {
+					.offset = function_offset + address + reloc->offset,
+					.type   = ir_target.isa->get_elf_reloc_type(reloc->be_kind),
+					.symbol = get_entity_symbol(env, reloc->dest.entity),
+					.addend = reloc->dest_offset,
+				};
+				ARR_APP1(elf_reloc_t, env->relocs, elf_reloc);
+				if (env->is64) {
+					/* SHT_RELA, the addend lives in the relocation entry */
+					memset(slot, 0, reloc->len);
+				} else {
+					/* SHT_REL, the addend lives in the relocation slot */
+					assert(reloc->len == 4);
+					write_le32(slot, (uint32_t)reloc->dest_offset);
+				}
+				continue;
+			}
+			}
+			panic("Invalid relocation");
+		}
+
+		orig_address += fragment->len;
+		last_address  = address + fragment->len;
+	}
+}
+
+static void wr8(FILE *const out, uint8_t const value)
+{
+	fputc(value, out);
+}
+
+static void wr16(FILE *const out, uint16_t const value)
+{
+	wr8(out, (uint8_t)value);
+	wr8(out, (uint8_t)(value >> 8));
+}
+
+static void wr32(FILE *const out, uint32_t const value)
+{
+	wr16(out, (uint16_t)value);
+	wr16(out, (uint16_t)(value >> 16));
+}
+
+static void wr64(FILE *const out, uint64_t const value)
+{
+	wr32(out, (uint32_t)value);
+	wr32(out, (uint32_t)(value >> 32));
+}
+
+/** Write an address/offset/size sized field (4 or 8 bytes). */
+static void wrword(FILE *const out, bool const is64, uint64_t const value)
+{
+	if (is64) {
+		wr64(out, value);
+	} else {
+		assert(value <= UINT32_MAX);
+		wr32(out, (uint32_t)value);
+	}
+}
+
+static void wrpad(FILE *const out, unsigned count)
+{
+	while (count-- > 0)
+		fputc(0, out);
+}
+
+static void write_section_header(FILE *const out, bool const is64,
+                                 uint32_t const name, uint32_t const type,
+                                 uint64_t const flags, uint64_t const offset,
+                                 uint64_t const size, uint32_t const link,
+                                 uint32_t const info, uint64_t const addralign,
+                                 uint64_t const entsize)
+{
+	wr32(out, name);
+	wr32(out, type);
+	wrword(out, is64, flags);
+	wrword(out, is64, 0); /* sh_addr */
+	wrword(out, is64, offset);
+	wrword(out, is64, size);
+	wr32(out, link);
+	wr32(out, info);
+	wrword(out, is64, addralign);
+	wrword(out, is64, entsize);
+}
+
+int be_jit_object_write_elf(ir_jit_object_t *const object, FILE *const out)
+{
+	arch_isa_if_t const *const isa = ir_target.isa;
+	if (isa->elf_machine == 0 || isa->get_elf_reloc_type == NULL
+	    || isa->big_endian)
+		return -1;
+
+	bool     const is64      = isa->pointer_size == 8;
+	unsigned const ehdr_size = is64 ? 64 : 52;
+	unsigned const shdr_size = is64 ? 64 : 40;
+	unsigned const sym_size  = is64 ? 24 : 16;
+	unsigned const rel_size  = is64 ? 24 : 8; /* Elf64_Rela / Elf32_Rel */
+
+	elf_writer_t env = {
+		.symbols        = NEW_ARR_F(elf_symbol_t, 0),
+		.relocs         = NEW_ARR_F(elf_reloc_t, 0),
+		.symbol_indices = pmap_create(),
+		.is64           = is64,
+	};
+	obstack_init(&env.strtab);
+	put_string(&env.strtab, "");
+
+	elf_symbol_t const null_sym = { .name = 0 };
+	ARR_APP1(elf_symbol_t, env.symbols, null_sym);
+	elf_symbol_t const text_sym = {
+		.info  = ELF_STT_SECTION, /* STB_LOCAL */
+		.shndx = SECTION_TEXT,
+	};
+	ARR_APP1(elf_symbol_t, env.symbols, text_sym);
+	assert(ARR_LEN(env.symbols) == FIRST_GLOBAL_SYMBOL);
+
+	/* Lay out the functions in .text and define their symbols first, so
+	 * references between the added functions resolve to the definitions. */
+	size_t    const n_functions      = ARR_LEN(object->functions);
+	unsigned *const function_offsets = XMALLOCN(unsigned, n_functions);
+	unsigned        text_size        = 0;
+	for (size_t i = 0; i < n_functions; ++i) {
+		object_function_t const *const f = &object->functions[i];
+		text_size = round_up2(text_size, 1u << FUNCTION_P2ALIGN);
+		function_offsets[i] = text_size;
+		text_size += f->function->size;
+
+		uint32_t     const index = ARR_LEN(env.symbols);
+		elf_symbol_t const sym = {
+			.name  = put_string(&env.strtab, get_entity_ld_name(f->entity)),
+			.value = function_offsets[i],
+			.size  = f->function->size,
+			.info  = (ELF_STB_GLOBAL << 4) | ELF_STT_FUNC,
+			.shndx = SECTION_TEXT,
+		};
+		ARR_APP1(elf_symbol_t, env.symbols, sym);
+		pmap_insert(env.symbol_indices, f->entity, INT_TO_PTR(index));
+	}
+
+	char *const text = XMALLOCN(char, text_size);
+	unsigned    end  = 0;
+	for (size_t i = 0; i < n_functions; ++i) {
+		object_function_t const *const f      = &object->functions[i];
+		unsigned                 const offset = function_offsets[i];
+		if (offset > end)
+			isa->emit_nops(text + end, offset - end);
+		emit_function_code(&env, f->function, offset, text + offset);
+		end = offset + f->function->size;
+	}
+	assert(end == text_size);
+	free(function_offsets);
+
+	/* The section name string table is fixed. */
+	struct obstack shstrtab;
+	obstack_init(&shstrtab);
+	put_string(&shstrtab, "");
+	uint32_t const name_text     = put_string(&shstrtab, ".text");
+	uint32_t const name_reloc    = put_string(&shstrtab,
+	                                          is64 ? ".rela.text" : ".rel.text");
+	uint32_t const name_symtab   = put_string(&shstrtab, ".symtab");
+	uint32_t const name_strtab   = put_string(&shstrtab, ".strtab");
+	uint32_t const name_note     = put_string(&shstrtab, ".note.GNU-stack");
+	uint32_t const name_shstrtab = put_string(&shstrtab, ".shstrtab");
+
+	unsigned const n_symbols     = ARR_LEN(env.symbols);
+	unsigned const n_relocs      = ARR_LEN(env.relocs);
+	unsigned const strtab_size   = obstack_object_size(&env.strtab);
+	unsigned const shstrtab_size = obstack_object_size(&shstrtab);
+
+	unsigned const off_text     = round_up2(ehdr_size, 1u << FUNCTION_P2ALIGN);
+	unsigned const off_reloc    = round_up2(off_text + text_size, 8);
+	unsigned const off_symtab   = off_reloc + n_relocs * rel_size;
+	unsigned const off_strtab   = off_symtab + n_symbols * sym_size;
+	unsigned const off_shstrtab = off_strtab + strtab_size;
+	unsigned const off_shdr     = round_up2(off_shstrtab + shstrtab_size, 8);
+
+	/* ELF header */
+	wr8(out, 0x7F);
+	wr8(out, 'E');
+	wr8(out, 'L');
+	wr8(out, 'F');
+	wr8(out, is64 ? 2 : 1); /* EI_CLASS */
+	wr8(out, 1);            /* EI_DATA: little endian */
+	wr8(out, 1);            /* EI_VERSION */
+	wrpad(out, 9);
+	wr16(out, 1);           /* e_type: ET_REL */
+	wr16(out, isa->elf_machine);
+	wr32(out, 1);           /* e_version */
+	wrword(out, is64, 0);   /* e_entry */
+	wrword(out, is64, 0);   /* e_phoff */
+	wrword(out, is64, off_shdr);
+	wr32(out, 0);           /* e_flags */
+	wr16(out, ehdr_size);
+	wr16(out, 0);           /* e_phentsize */
+	wr16(out, 0);           /* e_phnum */
+	wr16(out, shdr_size);
+	wr16(out, N_SECTIONS);
+	wr16(out, SECTION_SHSTRTAB);
+
+	wrpad(out, off_text - ehdr_size);
+	fwrite(text, 1, text_size, out);
+	free(text);
+
+	wrpad(out, off_reloc - (off_text + text_size));
+	for (unsigned i = 0; i < n_relocs; ++i) {
+		elf_reloc_t const *const reloc = &env.relocs[i];
+		if (is64) {
+			wr64(out, reloc->offset);
+			wr64(out, ((uint64_t)reloc->symbol << 32) | reloc->type);
+			wr64(out, (uint64_t)reloc->addend);
+		} else {
+			wr32(out, (uint32_t)reloc->offset);
+			wr32(out, (reloc->symbol << 8) | (reloc->type & 0xFF));
+		}
+	}
+
+	for (unsigned i = 0; i < n_symbols; ++i) {
+		elf_symbol_t const *const sym = &env.symbols[i];
+		wr32(out, sym->name);
+		if (is64) {
+			wr8(out, sym->info);
+			wr8(out, 0); /* st_other */
+			wr16(out, sym->shndx);
+			wr64(out, sym->value);
+			wr64(out, sym->size);
+		} else {
+			wr32(out, (uint32_t)sym->value);
+			wr32(out, (uint32_t)sym->size);
+			wr8(out, sym->info);
+			wr8(out, 0); /* st_other */
+			wr16(out, sym->shndx);
+		}
+	}
+
+	fwrite(obstack_base(&env.strtab), 1, strtab_size, out);
+	fwrite(obstack_base(&shstrtab), 1, shstrtab_size, out);
+
+	wrpad(out, off_shdr - (off_shstrtab + shstrtab_size));
+	write_section_header(out, is64, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+	write_section_header(out, is64, name_text, ELF_SHT_PROGBITS,
+	                     ELF_SHF_ALLOC | ELF_SHF_EXECINSTR, off_text,
+	                     text_size, 0, 0, 1u << FUNCTION_P2ALIGN, 0);
+	write_section_header(out, is64, name_reloc,
+	                     is64 ? ELF_SHT_RELA : ELF_SHT_REL, ELF_SHF_INFO_LINK,
+	                     off_reloc, n_relocs * rel_size, SECTION_SYMTAB,
+	                     SECTION_TEXT, is64 ? 8 : 4, rel_size);
+	write_section_header(out, is64, name_symtab, ELF_SHT_SYMTAB, 0, off_symtab,
+	                     n_symbols * sym_size, SECTION_STRTAB,
+	                     FIRST_GLOBAL_SYMBOL, is64 ? 8 : 4, sym_size);
+	write_section_header(out, is64, name_strtab, ELF_SHT_STRTAB, 0, off_strtab,
+	                     strtab_size, 0, 0, 1, 0);
+	write_section_header(out, is64, name_note, ELF_SHT_PROGBITS, 0,
+	                     off_shstrtab, 0, 0, 0, 1, 0);
+	write_section_header(out, is64, name_shstrtab, ELF_SHT_STRTAB, 0,
+	                     off_shstrtab, shstrtab_size, 0, 0, 1, 0);
+
+	obstack_free(&shstrtab, NULL);
+	obstack_free(&env.strtab, NULL);
+	pmap_destroy(env.symbol_indices);
+	DEL_ARR_F(env.relocs);
+	DEL_ARR_F(env.symbols);
+
+	return ferror(out) ? -1 : 0;
+}
@@ -120,7 +120,7 @@ bool be_is_fallthrough(ir_node const *jmp);
 		} else if (*fmt == 'd') { \
 			++fmt; \
 			int const num = va_arg(ap, int); \
-			be_emit_irprintf("%d", num); \
+			be_emit_long(num); \
 		} else if (*fmt == 's') { \
 			++fmt; \
 			char const *const string = va_arg(ap, char const*); \
@@ -128,7 +128,7 @@ bool be_is_fallthrough(ir_node const *jmp);
 		} else if (*fmt == 'u') { \
 			++fmt; \
 			unsigned const num = va_arg(ap, unsigned); \
-			be_emit_irprintf("%u", num); \
+			be_emit_ulong(num); \
 		} else
 
 #define BE_EMIT_JMP(arch, node, name, jmp) \
@@ -13,21 +13,61 @@
 
 #include "irprintf.h"
 #include "panic.h"
+#include <string.h>
+
+/** Size of the buffer collecting finished lines. Lines are handed to stdio
+ * in chunks of this size, so the per-line cost is just a memcpy. */
+#define EMIT_BUF_SIZE (64 * 1024)
 
 static FILE    *emit_file;
 struct obstack  emit_obst;
+static char     emit_buf[EMIT_BUF_SIZE];
+static size_t   emit_buf_fill;
+
+static void be_emit_flush(void)
+{
+	if (emit_buf_fill > 0) {
+		fwrite(emit_buf, 1, emit_buf_fill, emit_file);
+		emit_buf_fill = 0;
+	}
+}
 
 void be_emit_init(FILE *file)
 {
-	emit_file = file;
+	emit_file     = file;
+	emit_buf_fill = 0;
 	obstack_init(&emit_obst);
 }
 
 void be_emit_exit(void)
 {
+	be_emit_flush();
 	obstack_free(&emit_obst, NULL);
 }
 
+void be_emit_ulong(unsigned long value)
+{
+	/* convert backwards into a local buffer, this beats routing the
+	 * number through the printf machinery */
+	char  buf[sizeof(value) * 3 + 1];
+	char *p = buf + sizeof(buf);
+	do {
+		*--p = '0' + (char)(value % 10);
+		value /= 10;
+	} while (value != 0);
+	be_emit_string_len(p, buf + sizeof(buf) - p);
+}
+
+void be_emit_long(long value)
+{
+	unsigned long v = (unsigned long)value;
+	if (value < 0) {
+		be_emit_char('-');
+		v = -v;
+	}
+	be_emit_ulong(v);
+}
+
 void be_emit_irvprintf(const char *fmt, va_list args)
 {
 	ir_obst_vprintf(&emit_obst, fmt, args);
@@ -45,6 +85,14 @@ void be_emit_write_line(void)
 {
 	size_t const len  = obstack_object_size(&emit_obst);
 	char  *const line = (char*)obstack_finish(&emit_obst);
-	fwrite(line, 1, len, emit_file);
+	if (len > EMIT_BUF_SIZE - emit_buf_fill)
+		be_emit_flush();
+	if (len >= EMIT_BUF_SIZE) {
+		/* line does not fit into the buffer at all, write it directly */
+		fwrite(line, 1, len, emit_file);
+	} else {
+		memcpy(&emit_buf[emit_buf_fill], line, len);
+		emit_buf_fill += len;
+	}
 	obstack_free(&emit_obst, line);
 }
@@ -16,6 +16,7 @@
 #define FIRM_BE_BEEMITTER_H
 
 #include <stdio.h>
+#include "ident.h"
 #include "obst.h"
 
 /* don't use the following vars directly, they're only here for the inlines */
@@ -59,6 +60,24 @@ static inline void be_emit_string(const char *str)
 #define be_emit_cstring(str) \
 	be_emit_string_len(str, sizeof(str) - 1)
 
+/**
+ * Emit an ident to the (assembler) output.
+ */
+static inline void be_emit_ident(ident *id)
+{
+	be_emit_string(get_id_str(id));
+}
+
+/**
+ * Emit an unsigned number in decimal to the (assembler) output.
+ */
+void be_emit_ulong(unsigned long value);
+
+/**
+ * Emit a signed number in decimal to the (assembler) output.
+ */
+void be_emit_long(long value);
+
 /**
  * Initializes an emitter environment.
  *
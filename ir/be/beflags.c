@@ -22,6 +22,7 @@
  */
 #include "beflags.h"
 
+#include "array.h"
 #include "bearch.h"
 #include "beirg.h"
 #include "belive.h"
@@ -30,6 +31,7 @@
 #include "beutil.h"
 #include "ircons.h"
 #include "iredges_t.h"
+#include "irgmod.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
 #include "irouts_t.h"
@@ -43,6 +45,19 @@ static check_modifies_flags       check_modify;
 static try_replace_flags          try_replace;
 static bool                       changed;
 
+/** A flag producer rematerialized at the begin of a block because its
+ * flags come from another block.  If the flags turn out to survive all
+ * predecessors in the final schedule, the copy is removed again. */
+typedef struct cross_remat_t {
+	ir_node *block;    /**< block whose begin got the copy */
+	ir_node *producer; /**< original flag producer in another block */
+	ir_node *copy;     /**< the rematerialized copy */
+	ir_node *value;    /**< flag value of the copy used by the consumers */
+	unsigned pn;       /**< Proj number of the flag result */
+} cross_remat_t;
+
+static cross_remat_t *cross_remats;
+
 static ir_node *default_remat(ir_node *node, ir_node *after)
 {
 	ir_node *const block = get_block(after);
@@ -126,6 +141,41 @@ static void move_other_uses(ir_node *node, ir_node *copy)
 	}
 }
 
+/**
+ * Rematerializes @p flags_needed behind @p node and rewires all
+ * @p flag_consumers to the copy's flag value.
+ *
+ * @return the rematerialized copy; its flag value is stored in
+ *         @p value_out if non-NULL.
+ */
+static ir_node *rematerialize_flags(ir_node *flags_needed, ir_node *node,
+                                    ir_node *flag_consumers, unsigned pn,
+                                    ir_node **value_out)
+{
+	changed = true;
+	ir_node *copy = remat(flags_needed, node);
+	ir_node *value;
+	if (get_irn_mode(copy) == mode_T) {
+		move_other_uses(flags_needed, copy);
+		value = be_new_Proj(copy, pn);
+	} else {
+		value = copy;
+	}
+
+	ir_node *n = flag_consumers;
+	do {
+		/* Assume that each node has at most one flag input. */
+		int const pos = be_get_input_pos_for_req(n, flags_req);
+		assert(pos >= 0);
+		set_irn_n(n, pos, value);
+		n = (ir_node*)get_irn_link(n);
+	} while (n != NULL);
+
+	if (value_out != NULL)
+		*value_out = value;
+	return copy;
+}
+
 /**
  * Tries the following solutions in order:
  * 1. Move flags_needed behind node
@@ -152,25 +202,7 @@ static bool rematerialize_or_move(ir_node *flags_needed, ir_node *node,
 	if (available_flags && try_replace(flag_consumers, flags_needed, available_flags))
 		return true;
 
-	changed = true;
-	ir_node *copy = remat(flags_needed, node);
-	ir_node *value;
-	if (get_irn_mode(copy) == mode_T) {
-		move_other_uses(flags_needed, copy);
-		value = be_new_Proj(copy, pn);
-	} else {
-		value = copy;
-	}
-
-	ir_node *n = flag_consumers;
-	do {
-		/* Assume that each node has at most one flag input. */
-		int const pos = be_get_input_pos_for_req(n, flags_req);
-		assert(pos >= 0);
-		set_irn_n(n, pos, value);
-		n = (ir_node*)get_irn_link(n);
-	} while (n != NULL);
-
+	rematerialize_flags(flags_needed, node, flag_consumers, pn, NULL);
 	return false;
 }
 
@@ -244,9 +276,17 @@ static void fix_flags_walker(ir_node *block, void *env)
 	}
 
 	if (flags_needed != NULL) {
+		/* The flags come from another block.  Rematerialize at the block
+		 * begin for now, but remember the site: if the final schedule
+		 * shows that the flags survive all predecessors, the copy is
+		 * removed again by fix_flags_cross_block(). */
 		assert(get_nodes_block(flags_needed) != block);
 		ir_node *const place = be_move_after_schedule_first(block);
-		rematerialize_or_move(flags_needed, place, flag_consumers, pn, NULL);
+		ir_node       *value;
+		ir_node *const copy  = rematerialize_flags(flags_needed, place,
+		                                           flag_consumers, pn, &value);
+		cross_remat_t const site = { block, flags_needed, copy, value, pn };
+		ARR_APP1(cross_remat_t, cross_remats, site);
 		flags_needed   = NULL;
 		flag_consumers = NULL;
 	}
@@ -255,6 +295,97 @@ static void fix_flags_walker(ir_node *block, void *env)
 	assert(flag_consumers == NULL);
 }
 
+/**
+ * Returns the flag value of @p producer with Proj number @p pn, reusing
+ * an existing Proj if possible.
+ */
+static ir_node *get_flag_value(ir_node *const producer, unsigned const pn)
+{
+	if (get_irn_mode(producer) != mode_T)
+		return producer;
+	foreach_out_edge(producer, edge) {
+		ir_node *const proj = get_edge_src_irn(edge);
+		if (is_Proj(proj) && get_Proj_num(proj) == pn)
+			return proj;
+	}
+	ir_node *const proj = be_new_Proj(producer, pn);
+	arch_set_irn_register(proj, flags_reg);
+	return proj;
+}
+
+/**
+ * Checks in the final schedule whether the flags of @p producer are
+ * still valid at the begin of @p block, i.e. every predecessor block is
+ * the producer's block and no node between the producer and the block
+ * end modifies the flags (the target's check_modify callback decides
+ * what clobbers them, so e.g. plain branches do not).  The segment from
+ * the block begin up to @p copy must be clean as well.
+ */
+static bool flags_survive_to(ir_node *const block, ir_node *const producer,
+                             ir_node *const copy)
+{
+	ir_node *const producer_block = get_nodes_block(producer);
+	foreach_irn_in(block, i, cfgpred) {
+		if (is_Bad(cfgpred))
+			return false;
+		if (get_nodes_block(cfgpred) != producer_block)
+			return false;
+		for (ir_node *node = sched_next(producer); !sched_is_end(node);
+		     node = sched_next(node)) {
+			if (check_modify(node))
+				return false;
+		}
+	}
+
+	sched_foreach(block, node) {
+		if (node == copy)
+			break;
+		if (check_modify(node))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Second pass over the sites recorded by fix_flags_walker(): removes
+ * block-begin rematerializations whose flags provably survive all
+ * predecessors, so tight loops do not repeat identical compares.  This
+ * runs on the final schedule, after all moves and rematerializations,
+ * which makes the predecessor scan sound.
+ */
+static void fix_flags_cross_block(void)
+{
+	for (size_t i = 0, n = ARR_LEN(cross_remats); i < n; ++i) {
+		cross_remat_t *const site = &cross_remats[i];
+		if (!flags_survive_to(site->block, site->producer, site->copy))
+			continue;
+
+		/* move_other_uses() may have attached non-flag users to the
+		 * copy; then it has to stay */
+		if (site->value != site->copy) {
+			bool has_other_uses = false;
+			foreach_out_edge(site->copy, edge) {
+				if (get_edge_src_irn(edge) != site->value) {
+					has_other_uses = true;
+					break;
+				}
+			}
+			if (has_other_uses)
+				continue;
+		}
+
+		ir_node *const orig = get_flag_value(site->producer, site->pn);
+		foreach_out_edge_safe(site->value, edge) {
+			ir_node *const succ = get_edge_src_irn(edge);
+			set_irn_n(succ, get_edge_src_pos(edge), orig);
+		}
+		sched_remove(site->copy);
+		if (site->value != site->copy)
+			kill_node(site->value);
+		kill_node(site->copy);
+	}
+}
+
 void be_sched_fix_flags(ir_graph *irg, const arch_register_class_t *flag_cls,
                         func_rematerialize remat_func,
                         check_modifies_flags check_modifies_flags_func,
@@ -277,7 +408,11 @@ void be_sched_fix_flags(ir_graph *irg, const arch_register_class_t *flag_cls,
 	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK |
 	                          IR_RESOURCE_IRN_VISITED);
 	inc_irg_visited(irg);
+	cross_remats = NEW_ARR_F(cross_remat_t, 0);
 	irg_block_walk_graph(irg, fix_flags_walker, NULL, NULL);
+	fix_flags_cross_block();
+	DEL_ARR_F(cross_remats);
+	cross_remats = NULL;
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK |
 		               IR_RESOURCE_IRN_VISITED);
 
@@ -73,6 +73,7 @@ static void emit_section_macho(be_gas_section_t const section)
 
 	static const macho_sectioninfo_t macho_sectioninfos[] = {
 		[GAS_SECTION_TEXT]            = { "__TEXT,__text",            "regular,pure_instructions" },
+		[GAS_SECTION_TEXT_UNLIKELY]   = { "__TEXT,__text",            "regular,pure_instructions" },
 		[GAS_SECTION_DATA]            = { "__DATA,__data",            NULL },
 		[GAS_SECTION_RODATA]          = { "__TEXT,__const",           NULL },
 		[GAS_SECTION_REL_RO]          = { "__DATA,__const",           NULL },
@@ -124,6 +125,7 @@ typedef struct {
 
 static const elf_sectioninfo_t elf_sectioninfos[] = {
 	[GAS_SECTION_TEXT]           = { "text",              "progbits", "ax" },
+	[GAS_SECTION_TEXT_UNLIKELY]  = { "text.unlikely",     "progbits", "ax" },
 	[GAS_SECTION_DATA]           = { "data",              "progbits", "aw" },
 	[GAS_SECTION_RODATA]         = { "rodata",            "progbits", "a"  },
 	[GAS_SECTION_REL_RO_LOCAL]   = { "data.rel.ro.local", "progbits", "aw" },
@@ -166,11 +168,12 @@ static void emit_section_sparc(be_gas_section_t section,
 	be_emit_char('"');
 
 	/* for the simple sections we're done here */
-	if (flags != 0) {
+	if (flags != 0 || base == GAS_SECTION_TEXT_UNLIKELY) {
 		be_emit_cstring(",#alloc");
 
 		switch (base) {
-		case GAS_SECTION_TEXT: be_emit_cstring(",#execinstr"); break;
+		case GAS_SECTION_TEXT:
+		case GAS_SECTION_TEXT_UNLIKELY: be_emit_cstring(",#execinstr"); break;
 		case GAS_SECTION_DATA:
 		case GAS_SECTION_BSS:  be_emit_cstring(",#write"); break;
 		default:               /* nothing */ break;
@@ -453,8 +456,13 @@ static reloc_class_t classify_initializer_relocs(
 
 static be_gas_section_t determine_basic_section(const ir_entity *entity)
 {
-	if (is_method_entity(entity) || is_alias_entity(entity))
+	if (is_method_entity(entity) || is_alias_entity(entity)) {
+		/* mach-o has no convention for an unlikely text section */
+		if (!is_macho() && is_method_entity(entity)
+		 && (get_entity_additional_properties(entity) & mtp_property_cold))
+			return GAS_SECTION_TEXT_UNLIKELY;
 		return GAS_SECTION_TEXT;
+	}
 
 	if (get_entity_linkage(entity) & IR_LINKAGE_CONSTANT) {
 		/* mach-o is the only one with a cstring section */
@@ -680,9 +688,12 @@ void be_gas_emit_function_epilog(ir_entity const *const entity)
  */
 static void emit_tv(ir_tarval *const tv, unsigned const offset, unsigned const n)
 {
+	static char const hexchar[] = "0123456789abcdef";
 	be_emit_cstring("0x");
 	for (unsigned i = n; i-- != 0;) {
-		be_emit_irprintf("%02x", get_tarval_sub_bits(tv, offset + i));
+		unsigned char const byte = get_tarval_sub_bits(tv, offset + i);
+		be_emit_char(hexchar[byte >> 4]);
+		be_emit_char(hexchar[byte & 0xf]);
 	}
 }
 
@@ -721,15 +732,15 @@ static void emit_init_expression(ir_node *const init)
 		return;
 
 	case iro_Offset:
-		be_emit_irprintf("%d", get_entity_offset(get_Offset_entity(init)));
+		be_emit_long(get_entity_offset(get_Offset_entity(init)));
 		return;
 
 	case iro_Align:
-		be_emit_irprintf("%u", get_type_alignment(get_Align_type(init)));
+		be_emit_ulong(get_type_alignment(get_Align_type(init)));
 		return;
 
 	case iro_Size:
-		be_emit_irprintf("%u", get_type_size(get_Size_type(init)));
+		be_emit_ulong(get_type_size(get_Size_type(init)));
 		return;
 
 	case iro_Add:
@@ -1117,6 +1128,32 @@ static void emit_node_data(ir_node *const init, ir_type *const type)
 	be_emit_write_line();
 }
 
+/**
+ * Emits a run of byte-sized tarvals starting at @p k as comma-separated
+ * .byte directives instead of one directive per byte. Returns the length
+ * of the run.
+ */
+static size_t emit_byte_run(normal_or_bitfield const *const vals,
+                            size_t const k, size_t const size)
+{
+	size_t end = k;
+	while (end < size && vals[end].kind == TARVAL
+	    && get_type_size(vals[end].type) == 1) {
+		++end;
+	}
+	for (size_t i = k; i < end;) {
+		be_emit_cstring("\t.byte\t");
+		for (size_t const n = MIN(end, i + 16); i < n;) {
+			emit_tv(vals[i].v.tarval, 0, 1);
+			if (++i < n)
+				be_emit_cstring(", ");
+		}
+		be_emit_char('\n');
+		be_emit_write_line();
+	}
+	return end - k;
+}
+
 static void emit_initializer(ir_entity const *const entity,
                              unsigned long const size)
 {
@@ -1153,8 +1190,12 @@ static void emit_initializer(ir_entity const *const entity,
 			}
 			break;
 		case TARVAL:
-			emit_tarval_data(vals[k].type, vals[k].v.tarval);
-			elem_size = get_type_size(vals[k].type);
+			if (get_type_size(vals[k].type) == 1) {
+				elem_size = emit_byte_run(vals, k, size);
+			} else {
+				emit_tarval_data(vals[k].type, vals[k].v.tarval);
+				elem_size = get_type_size(vals[k].type);
+			}
 			break;
 		case STRING:
 			elem_size = emit_string_initializer(vals[k].v.string);
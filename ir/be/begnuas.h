@@ -19,6 +19,7 @@
 
 typedef enum {
 	GAS_SECTION_TEXT,            /**< text section - program code */
+	GAS_SECTION_TEXT_UNLIKELY,   /**< text section for rarely executed code */
 	GAS_SECTION_DATA,            /**< data section - arbitrary data */
 	GAS_SECTION_RODATA,          /**< read only data no relocations */
 	GAS_SECTION_REL_RO,          /**< read only data containing relocations */
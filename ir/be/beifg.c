@@ -26,9 +26,81 @@
 
 void be_ifg_free(be_ifg_t *self)
 {
+	if (self->adj != NULL)
+		obstack_free(&self->adj_obst, NULL);
 	free(self);
 }
 
+/**
+ * Returns the adjacency bitset of a node, allocating it on first use.
+ */
+static bitset_t *get_adjacency(be_ifg_t *ifg, const ir_node *node)
+{
+	unsigned  const idx = get_irn_idx(node);
+	bitset_t       *bs  = ifg->adj[idx];
+	if (bs == NULL) {
+		bs = bitset_obstack_alloc(&ifg->adj_obst, ifg->n_idx);
+		ifg->adj[idx] = bs;
+	}
+	return bs;
+}
+
+/**
+ * Block walker: walks the border list once, maintaining the set of
+ * living values. A value being defined interferes with everything
+ * living at its definition; for the chordal graphs built here this
+ * enumerates all interference edges.
+ */
+static void materialize_walker(ir_node *bl, void *data)
+{
+	be_ifg_t         *ifg  = (be_ifg_t*)data;
+	struct list_head *head = get_block_border_head(ifg->env, bl);
+	ir_nodeset_t      living;
+	ir_nodeset_init(&living);
+
+	foreach_border_head(head, b) {
+		ir_node *const irn = b->irn;
+		if (b->is_def) {
+			bitset_t *const adj = get_adjacency(ifg, irn);
+			foreach_ir_nodeset(&living, live, iter) {
+				bitset_set(adj, get_irn_idx(live));
+				bitset_set(get_adjacency(ifg, live), get_irn_idx(irn));
+			}
+			ir_nodeset_insert(&living, irn);
+		} else {
+			ir_nodeset_remove(&living, irn);
+		}
+	}
+
+	assert(ir_nodeset_size(&living) == 0);
+	ir_nodeset_destroy(&living);
+}
+
+void be_ifg_materialize(be_ifg_t *ifg)
+{
+	if (ifg->adj != NULL)
+		return;
+
+	ir_graph *const irg = ifg->env->irg;
+	ifg->n_idx = get_irg_last_idx(irg);
+	obstack_init(&ifg->adj_obst);
+	ifg->adj = OALLOCNZ(&ifg->adj_obst, bitset_t*, ifg->n_idx);
+	irg_block_walk_graph(irg, materialize_walker, NULL, ifg);
+}
+
+bool be_ifg_interfere(const be_ifg_t *ifg, const ir_node *a, const ir_node *b)
+{
+	if (ifg->adj != NULL) {
+		unsigned const idx_a = get_irn_idx(a);
+		unsigned const idx_b = get_irn_idx(b);
+		if (idx_a < ifg->n_idx && idx_b < ifg->n_idx) {
+			bitset_t const *const adj = ifg->adj[idx_a];
+			return adj != NULL && bitset_is_set(adj, idx_b);
+		}
+	}
+	return be_values_interfere(a, b);
+}
+
 static void nodes_walker(ir_node *bl, void *data)
 {
 	nodes_iter_t     *it   = (nodes_iter_t*)data;
@@ -103,7 +175,18 @@ static void find_neighbours(const be_ifg_t *ifg, neighbours_iter_t *it, const ir
 	it->valid       = 1;
 	ir_nodeset_init(&it->neighbours);
 
-	dom_tree_walk(get_nodes_block(irn), find_neighbour_walker, NULL, it);
+	if (ifg->adj != NULL && get_irn_idx(irn) < ifg->n_idx) {
+		/* answer from the materialized adjacency */
+		bitset_t const *const adj = ifg->adj[get_irn_idx(irn)];
+		if (adj != NULL) {
+			ir_graph *const irg = ifg->env->irg;
+			bitset_foreach(adj, idx) {
+				ir_nodeset_insert(&it->neighbours, get_idx_irn(irg, idx));
+			}
+		}
+	} else {
+		dom_tree_walk(get_nodes_block(irn), find_neighbour_walker, NULL, it);
+	}
 
 	ir_nodeset_iterator_init(&it->iter, &it->neighbours);
 }
@@ -254,6 +337,7 @@ be_ifg_t *be_create_ifg(const be_chordal_env_t *env)
 {
 	be_ifg_t *ifg = XMALLOC(be_ifg_t);
 	ifg->env = env;
+	ifg->adj = NULL;
 
 	return ifg;
 }
@@ -14,12 +14,21 @@
 
 #include "be_types.h"
 #include "bechordal.h"
+#include "bitset.h"
 #include "irnodeset.h"
 #include "obstack.h"
 #include "pset.h"
 
 struct be_ifg_t {
 	const be_chordal_env_t *env;
+	/** Materialized adjacency bitsets, indexed by node idx. Only
+	 *  allocated after be_ifg_materialize(); NULL while queries walk
+	 *  the liveness on demand. */
+	bitset_t              **adj;
+	/** Number of node indices when the adjacency was materialized.
+	 *  Younger nodes fall back to the on-demand check. */
+	unsigned                n_idx;
+	struct obstack          adj_obst;
 };
 
 typedef struct nodes_iter_t {
@@ -84,4 +93,20 @@ void be_ifg_stat(ir_graph *irg, be_ifg_t *ifg, be_ifg_stat_t *stat);
 
 be_ifg_t *be_create_ifg(const be_chordal_env_t *env);
 
+/**
+ * Materializes the interference graph as adjacency bitsets per node,
+ * built in a single pass over the border lists. Afterwards
+ * be_ifg_interfere() answers in O(1) and neighbour iteration no longer
+ * walks the dominance tree. No-op if already materialized.
+ */
+void be_ifg_materialize(be_ifg_t *ifg);
+
+/**
+ * Checks whether two values of the interference graph's register class
+ * interfere. Answers from the materialized adjacency if present,
+ * otherwise falls back to the on-demand liveness check.
+ */
+bool be_ifg_interfere(const be_ifg_t *ifg, const ir_node *a,
+                      const ir_node *b);
+
 #endif
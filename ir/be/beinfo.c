@@ -9,6 +9,7 @@
  */
 #include "beinfo.h"
 
+#include "array.h"
 #include "bedump.h"
 #include "beirg.h"
 #include "belive.h"
@@ -24,14 +25,55 @@
 
 static copy_attr_func old_phi_copy_attr;
 
+/** Number of out entries embedded directly in the backend_info_t
+ * allocation. Two cover the typical result plus flags/memory output;
+ * wider nodes fall back to a separately allocated array. */
+#define BE_INFO_N_INLINE_OUTS 2
+
+/**
+ * Allocates a backend_info_t together with a small out_infos array
+ * (including its array descriptor) as a single block, so the inner loops
+ * walking from a node to its register requirements touch one allocation
+ * instead of two.
+ */
+static backend_info_t *new_backend_info(struct obstack *const obst)
+{
+	size_t const descr_offs
+		= (sizeof(backend_info_t) + sizeof(aligned_type) - 1)
+		/ sizeof(aligned_type) * sizeof(aligned_type);
+	size_t const size = descr_offs + ARR_ELTS_OFFS
+	                  + BE_INFO_N_INLINE_OUTS * sizeof(reg_out_info_t);
+	char *const block = (char*)obstack_alloc(obst, size);
+	memset(block, 0, size);
+	backend_info_t *const info  = (backend_info_t*)block;
+	ir_arr_descr   *const descr = (ir_arr_descr*)(block + descr_offs);
+	info->out_infos
+		= (reg_out_info_t*)ir_arr_init_s(descr, BE_INFO_N_INLINE_OUTS);
+	return info;
+}
+
+reg_out_info_t *be_info_reset_out_infos(ir_node *const node, unsigned const n_res)
+{
+	backend_info_t *const info  = be_get_info(node);
+	ir_arr_descr   *const descr = ARR_DESCR(info->out_infos);
+	if (n_res != 0 && n_res <= descr->allocated) {
+		/* reuse the storage embedded in the info allocation */
+		descr->nelts = n_res;
+		memset(info->out_infos, 0, n_res * sizeof(*info->out_infos));
+	} else {
+		ir_graph *const irg = get_irn_irg(node);
+		info->out_infos = NEW_ARR_DZ(reg_out_info_t, be_get_be_obst(irg),
+		                             n_res);
+	}
+	return info->out_infos;
+}
+
 void be_info_init_irn(ir_node *const node, arch_irn_flags_t const flags, arch_register_req_t const **const in_reqs, unsigned const n_res)
 {
-	ir_graph       *const irg  = get_irn_irg(node);
-	struct obstack *const obst = get_irg_obstack(irg);
 	backend_info_t *const info = be_get_info(node);
-	info->flags     = flags;
-	info->in_reqs   = in_reqs;
-	info->out_infos = NEW_ARR_DZ(reg_out_info_t, obst, n_res);
+	info->flags   = flags;
+	info->in_reqs = in_reqs;
+	be_info_reset_out_infos(node, n_res);
 }
 
 void be_info_new_node(ir_graph *irg, ir_node *node)
@@ -41,7 +83,7 @@ void be_info_new_node(ir_graph *irg, ir_node *node)
 		return;
 
 	struct obstack *obst = be_get_be_obst(irg);
-	backend_info_t *info = OALLOCZ(obst, backend_info_t);
+	backend_info_t *info = new_backend_info(obst);
 
 	assert(node->backend_info == NULL);
 	node->backend_info = info;
@@ -72,9 +114,9 @@ void be_info_new_node(ir_graph *irg, ir_node *node)
 		return;
 	}
 
-	info->flags     = flags;
-	info->out_infos = NEW_ARR_DZ(reg_out_info_t, obst, 1);
-	info->out_infos[0].req = req;
+	info->flags = flags;
+	reg_out_info_t *const out_infos = be_info_reset_out_infos(node, 1);
+	out_infos[0].req = req;
 }
 
 static void new_phi_copy_attr(ir_graph *irg, const ir_node *old_node,
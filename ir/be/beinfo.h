@@ -56,6 +56,13 @@ void be_info_new_node(ir_graph *irg, ir_node *node);
 
 void be_info_init_irn(ir_node *node, arch_irn_flags_t flags, arch_register_req_t const **in_reqs, unsigned n_res);
 
+/**
+ * (Re)initializes the out info array of @p node for @p n_res results,
+ * reusing the storage embedded in the backend_info_t allocation when it
+ * is large enough. The returned array is zero initialized.
+ */
+reg_out_info_t *be_info_reset_out_infos(ir_node *node, unsigned n_res);
+
 int attrs_equal_be_node(const ir_node *node1, const ir_node *node2);
 
 #endif
@@ -12,6 +12,7 @@
 #include "beirg.h"
 
 #include "belive.h"
+#include "beloopana.h"
 #include "execfreq.h"
 
 void be_invalidate_live_sets(ir_graph *irg)
@@ -44,6 +45,11 @@ void be_free_birg(ir_graph *irg)
 	be_liveness_free(birg->lv);
 	birg->lv = NULL;
 
+	if (birg->loop_ana != NULL) {
+		be_free_loop_pressure(birg->loop_ana);
+		birg->loop_ana = NULL;
+	}
+
 	obstack_free(&birg->obst, NULL);
 	irg->be_data = NULL;
 }
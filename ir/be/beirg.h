@@ -43,6 +43,8 @@ void be_free_birg(ir_graph *irg);
 typedef struct be_irg_t {
 	be_main_env_t    *main_env;
 	be_lv_t          *lv;
+	/** loop register pressure cache, created on first use (see beloopana.h) */
+	be_loopana_t     *loop_ana;
 	/** bitset of registers available for the allocator */
 	unsigned         *allocatable_regs;
 	/** bitset of registers for which verification errors are not reported.
@@ -19,47 +19,10 @@
 #include "entity_t.h"
 #include "obst.h"
 #include "panic.h"
+#include "util.h"
 #include <assert.h>
 #include <limits.h>
 
-typedef enum reloc_dest_kind_t {
-	RELOC_DEST_CODE_FRAGMENT,
-	RELOC_DEST_ENTITY,
-} reloc_dest_kind_t;
-
-typedef struct relocation_t {
-	uint8_t                   be_kind;
-	ENUMBF(reloc_dest_kind_t) dest_kind : 8;
-	uint16_t                  offset;
-	int32_t                   dest_offset;
-	union dest {
-		uint16_t   fragment_num;
-		ir_entity *entity;
-	} dest;
-} relocation_t;
-
-typedef struct fragment_info_t {
-	unsigned     address;  /**< Address from begin of code segment */
-	unsigned     len;      /**< size of the fragments data */
-	uint8_t      p2align;  /**< power 2 of two we should align */
-	uint8_t      max_skip; /**< Maximum number of bytes to skip for alignment */
-	uint16_t     n_relocations;
-	relocation_t relocations[];
-} fragment_info_t;
-
-struct ir_jit_segment_t {
-	struct obstack code_obst;
-	struct obstack fragment_info_obst;
-	struct obstack fragment_info_arr_obst;
-};
-
-struct ir_jit_function_t {
-	unsigned          size;
-	unsigned          n_fragments;
-	char const       *code;
-	fragment_info_t **fragment_infos;
-};
-
 struct obstack        *code_obst;
 static struct obstack *fragment_info_obst;
 static struct obstack *fragment_info_arr_obst;
@@ -209,6 +172,7 @@ static void be_emit_relocation(unsigned const len, relocation_t *const relocatio
 	unsigned         const begin    = fragment->address;
 	unsigned         const now      = obstack_object_size(code_obst);
 	relocation->offset = now - begin;
+	relocation->len    = len;
 
 	assert(obstack_object_size(fragment_info_obst) >= sizeof(fragment_info_t));
 	obstack_grow(fragment_info_obst, relocation, sizeof(*relocation));
@@ -274,8 +238,14 @@ static unsigned emit_relocation(ir_jit_function_t const *const function,
 static void emit_bytes_as_asm(char const *const begin, char const *const end)
 {
 	assert(begin <= end);
-	for (char const *b = begin; b < end; ++b) {
-		be_emit_irprintf("\t.byte 0x%02X\n", (uint8_t)*b);
+	for (char const *b = begin; b != end;) {
+		be_emit_cstring("\t.byte ");
+		for (char const *const n = MIN(end, b + 16); b != n;) {
+			be_emit_irprintf("0x%02X", (uint8_t)*b);
+			if (++b != n)
+				be_emit_cstring(", ");
+		}
+		be_emit_char('\n');
 		be_emit_write_line();
 	}
 }
@@ -14,10 +14,50 @@
 
 #include <stdint.h>
 
+#include "compiler.h"
 #include "firm_types.h"
 #include "jit.h"
 #include "obst.h"
 
+typedef enum reloc_dest_kind_t {
+	RELOC_DEST_CODE_FRAGMENT,
+	RELOC_DEST_ENTITY,
+} reloc_dest_kind_t;
+
+typedef struct relocation_t {
+	uint8_t                   be_kind;
+	ENUMBF(reloc_dest_kind_t) dest_kind : 8;
+	uint8_t                   len;     /**< Size of the relocation slot */
+	uint16_t                  offset;
+	int32_t                   dest_offset;
+	union dest {
+		uint16_t   fragment_num;
+		ir_entity *entity;
+	} dest;
+} relocation_t;
+
+typedef struct fragment_info_t {
+	unsigned     address;  /**< Address from begin of code segment */
+	unsigned     len;      /**< size of the fragments data */
+	uint8_t      p2align;  /**< power 2 of two we should align */
+	uint8_t      max_skip; /**< Maximum number of bytes to skip for alignment */
+	uint16_t     n_relocations;
+	relocation_t relocations[];
+} fragment_info_t;
+
+struct ir_jit_segment_t {
+	struct obstack code_obst;
+	struct obstack fragment_info_obst;
+	struct obstack fragment_info_arr_obst;
+};
+
+struct ir_jit_function_t {
+	unsigned          size;
+	unsigned          n_fragments;
+	char const       *code;
+	fragment_info_t **fragment_infos;
+};
+
 typedef unsigned (*emit_relocation_func) (char *buffer, uint8_t be_kind,
                                           ir_entity *entity, int32_t offset);
 
@@ -61,6 +101,12 @@ static inline void be_emit32(uint32_t const u32)
 	obstack_grow(code_obst, &u32, 4);
 }
 
+/** Append a qword (64bits) to the current fragment */
+static inline void be_emit64(uint64_t const u64)
+{
+	obstack_grow(code_obst, &u64, 8);
+}
+
 void be_emit_reloc_fragment(unsigned len, uint8_t be_kind,
                             unsigned fragment_num, int32_t offset);
 
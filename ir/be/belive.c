@@ -297,6 +297,10 @@ void be_liveness_compute_chk(be_lv_t *lv)
 
 void be_liveness_invalidate_sets(be_lv_t *lv)
 {
+	/* the graph changed, so memoized check answers are stale, too */
+	if (lv->lvc != NULL)
+		lv_chk_flush(lv->lvc);
+
 	if (!lv->sets_valid)
 		return;
 	obstack_free(&lv->obst, NULL);
@@ -24,16 +24,27 @@
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
 
-#define HASH_LOOP_INFO(info) (hash_ptr((info)->loop) ^ hash_ptr((info)->cls))
+#define HASH_LOOP_INFO(info)  (hash_ptr((info)->loop) ^ hash_ptr((info)->cls))
+#define HASH_BLOCK_INFO(info) (hash_ptr((info)->block) ^ hash_ptr((info)->cls))
 
 typedef struct be_loop_info_t {
 	ir_loop                     *loop;
 	const arch_register_class_t *cls;
 	unsigned                     max_pressure;
+	bool                         valid;
 } be_loop_info_t;
 
+typedef struct be_block_info_t {
+	ir_node                     *block;
+	const arch_register_class_t *cls;
+	unsigned                     max_pressure;
+	bool                         valid;
+} be_block_info_t;
+
 struct be_loopana_t {
-	set *data;
+	ir_graph *irg;
+	set      *loop_data;
+	set      *block_data;
 };
 
 static int cmp_loop_info(const void *a, const void *b, size_t size)
@@ -44,14 +55,37 @@ static int cmp_loop_info(const void *a, const void *b, size_t size)
 	return i1->loop != i2->loop || i1->cls != i2->cls;
 }
 
+static int cmp_block_info(const void *a, const void *b, size_t size)
+{
+	(void)size;
+	const be_block_info_t *i1 = (const be_block_info_t*)a;
+	const be_block_info_t *i2 = (const be_block_info_t*)b;
+	return i1->block != i2->block || i1->cls != i2->cls;
+}
+
 /**
  * Compute the highest register pressure in a block.
+ * The result is memoized per block and class; a stale entry (after spill
+ * code was inserted) is recomputed, valid entries are returned directly.
+ * @param loop_ana  The loop ana object.
  * @param block     The block to compute pressure for.
  * @param cls       The register class to compute pressure for.
  * @return The highest register pressure in the given block.
  */
-static unsigned be_compute_block_pressure(ir_node *const block, arch_register_class_t const *const cls)
+static unsigned be_compute_block_pressure(be_loopana_t *loop_ana,
+                                          ir_node *const block,
+                                          arch_register_class_t const *const cls)
 {
+	be_block_info_t key;
+	key.block        = block;
+	key.cls          = cls;
+	key.max_pressure = 0;
+	key.valid        = false;
+	be_block_info_t *entry
+		= set_insert(be_block_info_t, loop_ana->block_data, &key, sizeof(key),
+		             HASH_BLOCK_INFO(&key));
+	if (entry->valid)
+		return entry->max_pressure;
 
 	DBG((dbg, LEVEL_1, "Processing Block %+F\n", block));
 
@@ -72,6 +106,9 @@ static unsigned be_compute_block_pressure(ir_node *const block, arch_register_cl
 	     max_live));
 
 	ir_nodeset_destroy(&live_nodes);
+
+	entry->max_pressure = max_live;
+	entry->valid        = true;
 	return max_live;
 }
 
@@ -94,7 +131,7 @@ static unsigned be_compute_loop_pressure(be_loopana_t *loop_ana, ir_loop *loop,
 		loop_element elem = get_loop_element(loop, i);
 
 		if (*elem.kind == k_ir_node) {
-			son_pressure = be_compute_block_pressure(elem.node, cls);
+			son_pressure = be_compute_block_pressure(loop_ana, elem.node, cls);
 		} else {
 			assert(*elem.kind == k_ir_loop);
 			son_pressure = be_compute_loop_pressure(loop_ana, elem.son, cls);
@@ -109,25 +146,29 @@ static unsigned be_compute_loop_pressure(be_loopana_t *loop_ana, ir_loop *loop,
 	key.loop            = loop;
 	key.cls             = cls;
 	key.max_pressure    = 0;
+	key.valid           = false;
 	be_loop_info_t *entry
-		= set_insert(be_loop_info_t, loop_ana->data, &key, sizeof(key), HASH_LOOP_INFO(&key));
-	entry->max_pressure = MAX(entry->max_pressure, pressure);
+		= set_insert(be_loop_info_t, loop_ana->loop_data, &key, sizeof(key), HASH_LOOP_INFO(&key));
+	entry->max_pressure = pressure;
+	entry->valid        = true;
 
 	return pressure;
 }
 
-be_loopana_t *be_new_loop_pressure(ir_graph *const irg, arch_register_class_t const *const cls)
+be_loopana_t *be_get_loop_pressure_ana(ir_graph *const irg)
 {
-	be_loopana_t *loop_ana = XMALLOC(be_loopana_t);
-	loop_ana->data = new_set(cmp_loop_info, 16);
+	be_irg_t *const birg = be_birg_from_irg(irg);
+	if (birg->loop_ana != NULL)
+		return birg->loop_ana;
 
-	DBG((dbg, LEVEL_1, "Computing loop register pressure for class %s:\n",
-	     cls->name));
+	be_loopana_t *loop_ana = XMALLOC(be_loopana_t);
+	loop_ana->irg        = irg;
+	loop_ana->loop_data  = new_set(cmp_loop_info, 16);
+	loop_ana->block_data = new_set(cmp_block_info, 64);
 
 	assure_loopinfo(irg);
 
-	be_compute_loop_pressure(loop_ana, get_irg_loop(irg), cls);
-
+	birg->loop_ana = loop_ana;
 	return loop_ana;
 }
 
@@ -137,14 +178,50 @@ unsigned be_get_loop_pressure(be_loopana_t *loop_ana, const arch_register_class_
 	key.loop = loop;
 	key.cls  = cls;
 	be_loop_info_t *entry
-		= set_find(be_loop_info_t, loop_ana->data, &key, sizeof(key), HASH_LOOP_INFO(&key));
+		= set_find(be_loop_info_t, loop_ana->loop_data, &key, sizeof(key), HASH_LOOP_INFO(&key));
+	if (entry != NULL && entry->valid)
+		return entry->max_pressure;
+
+	/* (re)compute the whole loop tree for this class bottom-up; untouched
+	 * blocks are served from the memoized per-block maxima */
+	DBG((dbg, LEVEL_1, "Computing loop register pressure for class %s:\n",
+	     cls->name));
+	be_compute_loop_pressure(loop_ana, get_irg_loop(loop_ana->irg), cls);
 
+	entry = set_find(be_loop_info_t, loop_ana->loop_data, &key, sizeof(key),
+	                 HASH_LOOP_INFO(&key));
+	assert(entry != NULL && entry->valid);
 	return entry->max_pressure;
 }
 
+unsigned be_get_block_pressure(be_loopana_t *loop_ana,
+                               const arch_register_class_t *cls,
+                               ir_node *block)
+{
+	return be_compute_block_pressure(loop_ana, block, cls);
+}
+
+void be_invalidate_block_pressure(ir_graph *irg, ir_node *block)
+{
+	be_loopana_t *const loop_ana = be_birg_from_irg(irg)->loop_ana;
+	if (loop_ana == NULL)
+		return;
+
+	foreach_set(loop_ana->block_data, be_block_info_t, info) {
+		if (info->block == block)
+			info->valid = false;
+	}
+	/* the block's pressure may dominate any of the enclosing loop maxima,
+	 * so recompute them all lazily on the next query */
+	foreach_set(loop_ana->loop_data, be_loop_info_t, info) {
+		info->valid = false;
+	}
+}
+
 void be_free_loop_pressure(be_loopana_t *loop_ana)
 {
-	del_set(loop_ana->data);
+	del_set(loop_ana->loop_data);
+	del_set(loop_ana->block_data);
 	free(loop_ana);
 }
 
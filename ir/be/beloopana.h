@@ -15,23 +15,38 @@
 #include "be_types.h"
 #include "irloop.h"
 
-typedef struct be_loopana_t be_loopana_t;
-
 /**
- * Compute the register pressure for a class of all loops in the irg.
- * @param irg   The graph
- * @param cls   The register class to compute the pressure for
- * @return The loop analysis object.
+ * Returns the loop pressure analysis object of the graph, creating it on
+ * first use. The object is shared between all register classes and cached
+ * in the be_irg_t; it is freed together with the other birg structures.
  */
-be_loopana_t *be_new_loop_pressure(ir_graph *irg, arch_register_class_t const *cls);
+be_loopana_t *be_get_loop_pressure_ana(ir_graph *irg);
 
 /**
- * Returns the computed register pressure for the given class and loop.
- * @return The pressure or INT_MAX if not found
+ * Returns the maximal register pressure of the given class in the loop and
+ * its sub-loops. Pressure is computed lazily in a bottom-up pass over the
+ * loop tree, once per class, with memoized per-block maxima.
  */
 unsigned be_get_loop_pressure(be_loopana_t *loop_ana,
                               const arch_register_class_t *cls, ir_loop *loop);
 
+/**
+ * Returns the maximal register pressure of the given class in a single
+ * block, computed from the current liveness and memoized like the loop
+ * maxima.
+ */
+unsigned be_get_block_pressure(be_loopana_t *loop_ana,
+                               const arch_register_class_t *cls,
+                               ir_node *block);
+
+/**
+ * Marks the cached pressure of @p block stale for all register classes.
+ * Call after inserting or removing instructions in the block (e.g. spill
+ * code); the affected loop maxima are recomputed on the next query from
+ * the still valid maxima of the untouched blocks.
+ */
+void be_invalidate_block_pressure(ir_graph *irg, ir_node *block);
+
 /**
  * Frees loop analysis object.
  */
@@ -22,6 +22,7 @@
 #include "bessaconstr.h"
 #include "bestat.h"
 #include "debug.h"
+#include "execfreq.h"
 #include "ircons.h"
 #include "iredges_t.h"
 #include "irgmod.h"
@@ -136,6 +137,25 @@ static arch_register_t const *get_free_register(ir_node *const perm, lower_env_t
 	return NULL;
 }
 
+/**
+ * Decides whether a register cycle of the given length is better
+ * implemented with copies through a free register or with pairwise
+ * swaps.  Copies need length+1 instructions, swaps length-1, but a swap
+ * may cost more than a copy (see register_swap_cost; e.g. xchg is
+ * microcoded on modern x86).  On a cost tie the block frequency
+ * decides: in hot blocks the independent copies schedule better, in
+ * cold blocks the swaps need fewer instructions.
+ */
+static bool prefer_copies_for_cycle(ir_node const *const perm,
+                                    unsigned const length)
+{
+	unsigned const copy_cost = length + 1;
+	unsigned const swap_cost = (length - 1) * ir_target.register_swap_cost;
+	if (copy_cost != swap_cost)
+		return copy_cost < swap_cost;
+	return get_block_execfreq(get_nodes_block(perm)) > 1.0;
+}
+
 /**
  * Lowers a perm node.  Resolves cycles and creates a bunch of
  * copy and swap operations to permute registers.
@@ -227,15 +247,28 @@ static void lower_perm_node(ir_node *const perm, arch_register_class_t const *co
 		free_reg = get_free_register(perm, env);
 	}
 
-	if (use_copies && free_reg != NULL) {
-		/* Implement cycles using copies and the free register. */
-		for (unsigned i = 0; i != n_regs; /* empty */) {
-			if (!rbitset_is_set(inregs, i)) {
-				++i;
-				continue;
-			}
-			reg_pair_t *start = oregmap[i];
+	/* Implement the remaining cycles one by one, choosing move-chain or
+	 * swap decomposition per cycle by target cost. */
+	ir_node *const block = get_nodes_block(perm);
+	for (unsigned i = 0; i != n_regs;) {
+		if (!rbitset_is_set(inregs, i)) {
+			++i;
+			continue;
+		}
+		reg_pair_t *const start = oregmap[i];
+
+		/* Measure the cycle length. */
+		unsigned length = 0;
+		for (reg_pair_t const *scan = start;;) {
+			++length;
+			scan = oregmap[scan->in_reg->index];
+			if (scan == start)
+				break;
+		}
 
+		if (use_copies && free_reg != NULL
+		    && prefer_copies_for_cycle(perm, length)) {
+			/* Implement the cycle using copies and the free register. */
 			ir_node *const save_copy = be_new_Copy_before_reg(start->in_node, perm, free_reg);
 
 			reg_pair_t *p = oregmap[start->in_reg->index];
@@ -250,41 +283,33 @@ static void lower_perm_node(ir_node *const perm, arch_register_class_t const *co
 			rbitset_clear(inregs, start->in_reg->index);
 			ir_node *const restore_copy = be_new_Copy_before_reg(save_copy, perm, start->out_reg);
 			exchange(start->out_node, restore_copy);
-		}
-	} else {
-		if (arity == 2) {
-			DBG((dbg, LEVEL_1, "%+F is transposition\n", perm));
-			return;
-		}
-
-		/* Decompose cycles into transpositions.
-		 *
-		 * Use as many independent transpositions as possible and do not thread
-		 * one value through all transpositions.
-		 * I.e., for the first level of decomposition of a n-Perm do floor(n/2)
-		 * transpositions. This puts floor(n/2) values into the right registers.
-		 * Repeat this for all remaining values until all have the right
-		 * register.
-		 * This way no value is threaded through more than ceil(ld(n/2))
-		 * transpositions (compared to one value being threaded through all
-		 * transpositions using a naive decomposition).
-		 *
-		 * good:            bad:
-		 * r1 r2 r3 r4 r5   r1 r2 r3 r4 r5
-		 * +---+ +---+      +---+
-		 *    +------+         +---+
-		 *          +---+         +---+
-		 * r2 r3 r4 r5 r1            +---+
-		 *                  r2 r3 r4 r5 r1
-		 */
-		ir_node *const block = get_nodes_block(perm);
-		for (unsigned i = 0; i != n_regs;) {
-			if (!rbitset_is_set(inregs, i)) {
-				++i;
-				continue;
+		} else {
+			if (arity == 2) {
+				DBG((dbg, LEVEL_1, "%+F is transposition\n", perm));
+				return;
 			}
-			reg_pair_t             *p     = oregmap[i];
-			reg_pair_t const *const start = p;
+
+			/* Decompose the cycle into transpositions.
+			 *
+			 * Use as many independent transpositions as possible and do not thread
+			 * one value through all transpositions.
+			 * I.e., for the first level of decomposition of a n-Perm do floor(n/2)
+			 * transpositions. This puts floor(n/2) values into the right registers.
+			 * Repeat this for all remaining values until all have the right
+			 * register.
+			 * This way no value is threaded through more than ceil(ld(n/2))
+			 * transpositions (compared to one value being threaded through all
+			 * transpositions using a naive decomposition).
+			 *
+			 * good:            bad:
+			 * r1 r2 r3 r4 r5   r1 r2 r3 r4 r5
+			 * +---+ +---+      +---+
+			 *    +------+         +---+
+			 *          +---+         +---+
+			 * r2 r3 r4 r5 r1            +---+
+			 *                  r2 r3 r4 r5 r1
+			 */
+			reg_pair_t *p = start;
 			for (;;) {
 				reg_pair_t const *const q = oregmap[p->in_reg->index];
 				if (q == start)
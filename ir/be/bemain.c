@@ -37,10 +37,11 @@
 #include "irdump.h"
 #include "iredges_t.h"
 #include "irgopt.h"
+#include "irgwalk.h"
 #include "irloop_t.h"
 #include "iroptimize.h"
 #include "irprofile.h"
-#include "irprog.h"
+#include "irprog_t.h"
 #include "irtools.h"
 #include "irverify.h"
 #include "lc_opts.h"
@@ -49,6 +50,7 @@
 #include "statev.h"
 #include "target_t.h"
 #include "util.h"
+#include "xmalloc.h"
 #include <stdio.h>
 
 static struct obstack obst;
@@ -62,8 +64,11 @@ be_options_t be_options = {
 	.opt_profile_use      = false,
 	.omit_fp              = false,
 	.do_verify            = true,
+	.verify_every         = 1,
 	.ilp_solver           = "",
+	.timereg_file         = "",
 	.verbose_asm          = true,
+	.free_graphs          = false,
 };
 
 /* possible dumping options */
@@ -87,12 +92,15 @@ static const lc_opt_table_entry_t be_main_options[] = {
 	LC_OPT_ENT_ENUM_MASK("dump",       "dump irg on several occasions",                       &dump_var),
 	LC_OPT_ENT_BOOL     ("omitfp",     "omit frame pointer",                                  &be_options.omit_fp),
 	LC_OPT_ENT_BOOL     ("verify",     "verify the backend irg",                              &be_options.do_verify),
+	LC_OPT_ENT_INT      ("verifyevery", "only verify every nth function (sampling)",          &be_options.verify_every),
 	LC_OPT_ENT_BOOL     ("time",       "get backend timing statistics",                       &be_options.timing),
 	LC_OPT_ENT_BOOL     ("profilegenerate", "instrument the code for execution count profiling", &be_options.opt_profile_generate),
 	LC_OPT_ENT_BOOL     ("profileuse",      "use existing profile data",                         &be_options.opt_profile_use),
 	LC_OPT_ENT_BOOL     ("verboseasm", "enable verbose assembler output",                        &be_options.verbose_asm),
+	LC_OPT_ENT_BOOL     ("freegraphs", "free each graph's node memory after its code generation", &be_options.free_graphs),
 
 	LC_OPT_ENT_STR("ilp.solver", "the ilp solver name", &be_options.ilp_solver),
+	LC_OPT_ENT_STR("timeregions", "write hierarchical pass timings as JSON to this file ('-': stderr)", &be_options.timereg_file),
 	LC_OPT_LAST
 };
 
@@ -146,11 +154,12 @@ void be_initialize(void)
 	obstack_init(&obst);
 }
 
-static void finish_isa(void)
+void be_finish_isa(void)
 {
 	assert(ir_target.isa_initialized);
 	ir_target.isa->finish();
 	obstack_free(&obst, NULL);
+	ir_target.isa_initialized = false;
 }
 
 asm_constraint_flags_t be_parse_asm_constraints(const char *constraint)
@@ -200,11 +209,6 @@ int be_is_valid_clobber(const char *clobber)
 
 static void be_opt_register(void)
 {
-	static bool run_once = false;
-	if (run_once)
-		return;
-	run_once = true;
-
 	lc_opt_entry_t *be_grp = lc_opt_get_grp(firm_opt_get_root(), "be");
 	lc_opt_add_table(be_grp, be_main_options);
 }
@@ -218,10 +222,25 @@ void be_check_verify_result(bool fine, ir_graph *irg)
 	}
 }
 
+/**
+ * Returns true if the graph should be verified. With the sampling option
+ * only every nth function is verified, so verification can stay enabled in
+ * runs where full verification after every phase would be too slow.
+ */
+static bool be_should_verify(ir_graph *const irg)
+{
+	if (!be_options.do_verify)
+		return false;
+	if (be_options.verify_every > 1
+	 && get_irg_graph_nr(irg) % be_options.verify_every != 0)
+		return false;
+	return true;
+}
+
 /* Perform schedule verification if requested. */
 static void be_sched_verify(ir_graph *irg)
 {
-	if (be_options.do_verify) {
+	if (be_should_verify(irg)) {
 		be_timer_push(T_VERIFY);
 		bool fine = be_verify_schedule(irg);
 		be_check_verify_result(fine, irg);
@@ -231,7 +250,7 @@ static void be_sched_verify(ir_graph *irg)
 
 static void be_regalloc_verify(ir_graph *const irg)
 {
-	if (be_options.do_verify) {
+	if (be_should_verify(irg)) {
 		be_timer_push(T_VERIFY);
 		bool const fine = be_verify_register_allocation(irg);
 		be_check_verify_result(fine, irg);
@@ -239,10 +258,16 @@ static void be_regalloc_verify(ir_graph *const irg)
 	}
 }
 
-/* Initialize the Firm backend. Must be run first in init_firm()! */
+/* Initialize the Firm backend. Called lazily on the first target
+ * selection; may be called more than once without problems. */
 void firm_be_init(void)
 {
-	be_opt_register();
+	static bool run_once = false;
+	if (run_once)
+		return;
+	run_once = true;
+
+	be_register_module_options(be_opt_register);
 	be_init_modules();
 }
 
@@ -273,7 +298,7 @@ static void initialize_birg(be_irg_t *birg, ir_graph *irg, be_main_env_t *env)
 	birg->lv = be_liveness_new(irg);
 
 	/* Verify the initial graph */
-	if (be_options.do_verify) {
+	if (be_should_verify(irg)) {
 		be_timer_push(T_VERIFY);
 		bool fine = irg_verify(irg);
 		be_check_verify_result(fine, irg);
@@ -281,6 +306,21 @@ static void initialize_birg(be_irg_t *birg, ir_graph *irg, be_main_env_t *env)
 	}
 }
 
+/**
+ * Marks all functions whose entry block was never executed in the
+ * profile run as cold, so the emitter places them into the unlikely
+ * text section away from the hot code.
+ */
+static void mark_unexecuted_irgs_cold(void)
+{
+	foreach_irp_irg(i, irg) {
+		if (ir_profile_get_block_execcount(get_irg_start_block(irg)) > 0)
+			continue;
+		ir_entity *const entity = get_irg_entity(irg);
+		add_entity_additional_properties(entity, mtp_property_cold);
+	}
+}
+
 static ir_graph *be_prepare_profile(const char *const cup_name)
 {
 	obstack_printf(&obst, "%s.prof", cup_name);
@@ -294,6 +334,7 @@ static ir_graph *be_prepare_profile(const char *const cup_name)
 			be_warningf(NULL, "could not read profile data '%s'", prof_filename);
 		} else {
 			ir_create_execfreqs_from_profile();
+			mark_unexecuted_irgs_cold();
 			ir_profile_free();
 			have_profile = true;
 		}
@@ -313,10 +354,70 @@ static ir_graph *be_prepare_profile(const char *const cup_name)
 	return prof_init_irg;
 }
 
+static void collect_direct_callees(ir_node *node, void *data)
+{
+	ir_graph ***const callees = (ir_graph***)data;
+	if (!is_Call(node))
+		return;
+	ir_entity *const callee = get_Call_callee(node);
+	if (callee == NULL || !is_method_entity(callee))
+		return;
+	ir_graph *const callee_irg = get_entity_irg(callee);
+	if (callee_irg != NULL)
+		ARR_APP1(ir_graph*, *callees, callee_irg);
+}
+
+static void order_irgs_walk(ir_graph *irg, ir_graph ***postorder)
+{
+	if (get_irg_link(irg) != NULL)
+		return;
+	set_irg_link(irg, irg);
+
+	ir_graph **callees = NEW_ARR_F(ir_graph*, 0);
+	irg_walk_graph(irg, collect_direct_callees, NULL, &callees);
+	for (size_t i = 0, n = ARR_LEN(callees); i < n; ++i) {
+		order_irgs_walk(callees[i], postorder);
+	}
+	DEL_ARR_F(callees);
+
+	ARR_APP1(ir_graph*, *postorder, irg);
+}
+
+/**
+ * Reorders the graphs of the program into callgraph postorder so the
+ * backend processes leaves before their callers.  Recursion cycles are
+ * broken at the first graph reached.  The order only depends on the
+ * previous graph order, keeping the emitted assembly deterministic.
+ */
+static void be_order_irgs_bottom_up(void)
+{
+	size_t const n_irgs = get_irp_n_irgs();
+	if (n_irgs == 0)
+		return;
+
+	foreach_irp_irg(i, irg) {
+		set_irg_link(irg, NULL);
+	}
+	ir_graph **postorder = NEW_ARR_F(ir_graph*, 0);
+	foreach_irp_irg(i, irg) {
+		order_irgs_walk(irg, &postorder);
+	}
+	assert(ARR_LEN(postorder) == n_irgs);
+	for (size_t i = 0; i < n_irgs; ++i) {
+		irp->graphs[i] = postorder[i];
+	}
+	DEL_ARR_F(postorder);
+}
+
 void be_begin(FILE *file_handle, const char *cup_name)
 {
 	memset(be_asm_constraint_flags, 0, sizeof(be_asm_constraint_flags));
 
+	if (be_options.timereg_file[0] != '\0' && !ir_timereg_enabled)
+		ir_timereg_begin(be_options.timereg_file);
+	ir_timereg_unit_begin(cup_name);
+	ir_timereg_push("backend", NULL);
+
 	bemain_timer = NULL;
 	if (be_options.timing) {
 		bemain_timer = ir_timer_new();
@@ -335,6 +436,7 @@ void be_begin(FILE *file_handle, const char *cup_name)
 		buf[pos - cup_name] = '\0';
 
 		stat_ev_ctx_push_str("bemain_compilation_unit", cup_name);
+		xmalloc_account_begin();
 	}
 
 	be_timing = be_options.timing;
@@ -343,6 +445,11 @@ void be_begin(FILE *file_handle, const char *cup_name)
 	if (get_irp_n_irgs() > 0 && !irg_is_constrained(get_irp_irg(0), IR_GRAPH_CONSTRAINT_TARGET_LOWERED))
 		be_lower_for_target();
 
+	/* generate code for callees before their callers; this keeps the
+	 * output order deterministic and lets later per-function passes rely
+	 * on results computed for the functions they call */
+	be_order_irgs_bottom_up();
+
 	if (be_timing) {
 		for (be_timer_id_t t = T_FIRST; t < T_LAST+1; ++t) {
 			be_timers[t] = ir_timer_new();
@@ -387,13 +494,15 @@ void be_begin(FILE *file_handle, const char *cup_name)
 
 void firm_be_finish(void)
 {
-	finish_isa();
+	if (ir_target.isa_initialized)
+		be_finish_isa();
 	be_quit_modules();
+	ir_timereg_end();
 }
 
 int be_timing;
 
-static const char *get_timer_name(be_timer_id_t id)
+const char *be_get_timer_name(be_timer_id_t id)
 {
 	switch (id) {
 	case T_ABI:            return "abi";
@@ -449,7 +558,9 @@ void be_after_irp_transform(const char *name)
 void be_lower_for_target(void)
 {
 	assert(ir_target.isa_initialized);
+	ir_timereg_push("lower_for_target", NULL);
 	ir_target.isa->lower_for_target();
+	ir_timereg_pop();
 	/* set the phase to low */
 	foreach_irp_irg_r(i, irg) {
 		assert(!irg_is_constrained(irg, IR_GRAPH_CONSTRAINT_TARGET_LOWERED));
@@ -465,12 +576,14 @@ bool be_step_first(ir_graph *irg)
 	if (get_entity_linkage(entity) & IR_LINKAGE_NO_CODEGEN)
 		return false;
 
+	ir_timereg_push("irg", irg);
 	be_timer_push(T_OTHER);
 	if (stat_ev_enabled) {
 		stat_ev_ctx_push_fmt("bemain_irg", "%+F", irg);
 		stat_ev_ull("bemain_insns_start", be_count_insns(irg));
 		stat_ev_ull("bemain_blocks_start", be_count_blocks(irg));
 	}
+	xmalloc_account_push(get_entity_name(entity));
 	cse_setting = get_opt_cse();
 	return true;
 }
@@ -498,7 +611,12 @@ void be_step_regalloc(ir_graph *irg, const regalloc_if_t *regif)
 		be_stat_values(irg);
 	}
 
-	/* Do register allocation */
+	/* Do register allocation.
+	 * Note that although allocation is purely graph-local, running it for
+	 * independent graphs on worker threads is currently not possible: the
+	 * ir core (irp, node index allocation, the static pass state in most
+	 * analyses and in beprefalloc itself) is shared mutable state. Making
+	 * the allocator concurrent first requires making those per-thread. */
 	be_allocate_registers(irg, regif);
 	be_regalloc_verify(irg);
 
@@ -522,20 +640,21 @@ void be_step_last(ir_graph *irg)
 	be_regalloc_verify(irg);
 
 	be_timer_pop(T_OTHER);
+	ir_timereg_pop();
 
 	if (be_timing) {
 		if (stat_ev_enabled) {
 			for (be_timer_id_t t = T_FIRST; t < T_LAST+1; ++t) {
 				char buf[128];
 				snprintf(buf, sizeof(buf), "bemain_time_%s",
-				         get_timer_name(t));
+				         be_get_timer_name(t));
 				stat_ev_dbl(buf, ir_timer_elapsed_usec(be_timers[t]));
 			}
 		} else {
 			printf("==>> IRG %s <<==\n", get_entity_name(get_irg_entity(irg)));
 			for (be_timer_id_t t = T_FIRST; t < T_LAST+1; ++t) {
 				double val = ir_timer_elapsed_usec(be_timers[t]) / 1000.0;
-				printf("%-20s: %10.3f msec\n", get_timer_name(t), val);
+				printf("%-20s: %10.3f msec\n", be_get_timer_name(t), val);
 			}
 		}
 		for (be_timer_id_t t = T_FIRST; t < T_LAST+1; ++t) {
@@ -544,11 +663,30 @@ void be_step_last(ir_graph *irg)
 	}
 
 	be_free_birg(irg);
+	/* in low memory mode the graph streamed through the backend and is
+	 * not needed anymore: drop its node storage while the remaining
+	 * graphs are still waiting for code generation */
+	if (be_options.free_graphs)
+		free_ir_graph_content(irg);
+	xmalloc_account_pop();
 	stat_ev_ctx_pop("bemain_irg");
 
 	set_opt_cse(cse_setting);
 }
 
+/** Emit one xmalloc accounting tag as statistic events. */
+static void report_memory_tag(const char *tag, unsigned long long bytes,
+                              unsigned long long calls,
+                              unsigned long long peak, void *env)
+{
+	(void)env;
+	stat_ev_ctx_push_str("xmalloc_tag", tag);
+	stat_ev_ull("xmalloc_bytes", bytes);
+	stat_ev_ull("xmalloc_calls", calls);
+	stat_ev_ull("xmalloc_peak", peak);
+	stat_ev_ctx_pop("xmalloc_tag");
+}
+
 void be_finish(void)
 {
 	be_gas_end_compilation_unit(&env);
@@ -564,10 +702,18 @@ void be_finish(void)
 		}
 	}
 
+	if (xmalloc_account_enabled) {
+		xmalloc_account_report(report_memory_tag, NULL);
+		xmalloc_account_end();
+	}
+
 	if (stat_ev_enabled) {
 		stat_ev_ctx_pop("bemain_compilation_unit");
 	}
 
+	ir_timereg_pop();
+	ir_timereg_unit_end();
+
 	be_emit_exit();
 	be_info_free();
 
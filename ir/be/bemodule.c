@@ -12,8 +12,9 @@
 #include "bemodule.h"
 
 #include "isas.h"
+#include "obst.h"
 #include "util.h"
-#include "xmalloc.h"
+#include <assert.h>
 #include <stdbool.h>
 #include <stdlib.h>
 
@@ -61,9 +62,60 @@ void be_init_state(void);
 void be_quit_pbqp(void);
 
 /**
- * Driver for module initialization.
- * Call your module initialization function here.
+ * Driver table for module initialization.
+ * Add your module initialization function here.
  */
+static void (*const be_module_constructors[])(void) = {
+	be_init_2addr,
+	be_init_arch,
+	be_init_blocksched,
+	be_init_chordal_common,
+	be_init_copyopt,
+	be_init_dwarf,
+	be_init_live,
+	be_init_loopana,
+	be_init_peephole,
+	be_init_ra,
+	be_init_sched,
+	be_init_spill,
+	be_init_spilloptions,
+	be_init_spillslots,
+	be_init_ssaconstr,
+	be_init_state,
+
+	/* in the following groups the first one is the default */
+	be_init_arch_ia32,
+	be_init_arch_arm,
+	be_init_arch_mips,
+	be_init_arch_sparc,
+	be_init_arch_amd64,
+	be_init_arch_riscv32,
+	be_init_arch_TEMPLATE,
+
+	be_init_listsched,
+	be_init_sched_normal,
+	be_init_sched_rand,
+	be_init_sched_trivial,
+
+	be_init_chordal_main,
+	be_init_pref_alloc,
+
+	be_init_chordal,
+	be_init_pbqp_coloring,
+
+	be_init_spillbelady,
+	be_init_daemelspill,
+
+	be_init_copyheur4,
+	be_init_copyilp2,
+	be_init_copynone,
+	be_init_copyilp,
+
+#ifdef FIRM_GRGEN_BE
+	be_init_pbqp,
+#endif
+};
+
 void be_init_modules(void)
 {
 	static bool run_once = false;
@@ -71,54 +123,31 @@ void be_init_modules(void)
 		return;
 	run_once = true;
 
-	be_init_2addr();
-	be_init_arch();
-	be_init_blocksched();
-	be_init_chordal_common();
-	be_init_copyopt();
-	be_init_dwarf();
-	be_init_live();
-	be_init_loopana();
-	be_init_peephole();
-	be_init_ra();
-	be_init_sched();
-	be_init_spill();
-	be_init_spilloptions();
-	be_init_spillslots();
-	be_init_ssaconstr();
-	be_init_state();
-
-	/* in the following groups the first one is the default */
-	be_init_arch_ia32();
-	be_init_arch_arm();
-	be_init_arch_mips();
-	be_init_arch_sparc();
-	be_init_arch_amd64();
-	be_init_arch_riscv32();
-	be_init_arch_TEMPLATE();
-
-	be_init_listsched();
-	be_init_sched_normal();
-	be_init_sched_rand();
-	be_init_sched_trivial();
-
-	be_init_chordal_main();
-	be_init_pref_alloc();
+	for (size_t i = 0; i < ARRAY_SIZE(be_module_constructors); ++i) {
+		be_module_constructors[i]();
+	}
+}
 
-	be_init_chordal();
-	be_init_pbqp_coloring();
+/** Deferred option constructors, filled by the module constructors. */
+static void (*option_constructors[64])(void);
+static unsigned n_option_constructors;
 
-	be_init_spillbelady();
-	be_init_daemelspill();
+void be_register_module_options(void (*func)(void))
+{
+	assert(n_option_constructors < ARRAY_SIZE(option_constructors));
+	option_constructors[n_option_constructors++] = func;
+}
 
-	be_init_copyheur4();
-	be_init_copyilp2();
-	be_init_copynone();
-	be_init_copyilp();
+void be_init_module_options(void)
+{
+	static bool run_once = false;
+	if (run_once)
+		return;
+	run_once = true;
 
-#ifdef FIRM_GRGEN_BE
-	be_init_pbqp();
-#endif
+	for (unsigned i = 0; i < n_option_constructors; ++i) {
+		option_constructors[i]();
+	}
 }
 
 void be_quit_modules(void)
@@ -202,19 +231,45 @@ static int dump_opt_module_vals(char *buf, size_t buflen, void *data)
 	return strlen(buf);
 }
 
+/** Backing store for module list entries and option data; the lists live
+ * for the whole process, so one obstack replaces per-entry allocations. */
+static struct obstack module_obst;
+static bool           module_obst_inited;
+
+static struct obstack *get_module_obst(void)
+{
+	if (!module_obst_inited) {
+		obstack_init(&module_obst);
+		module_obst_inited = true;
+	}
+	return &module_obst;
+}
+
 /**
  * Add a new module to list.
  */
 void be_add_module_to_list(be_module_list_entry_t **list_head, const char *name,
                            void *module)
 {
-	be_module_list_entry_t *entry = XMALLOC(be_module_list_entry_t);
+	be_module_list_entry_t *entry = OALLOC(get_module_obst(),
+	                                       be_module_list_entry_t);
 	entry->name = name;
 	entry->data = module;
 	entry->next = *list_head;
 	*list_head  = entry;
 }
 
+void *be_module_list_find(be_module_list_entry_t const *list,
+                          const char *name)
+{
+	for (be_module_list_entry_t const *entry = list; entry != NULL;
+	     entry = entry->next) {
+		if (strcmp(entry->name, name) == 0)
+			return entry->data;
+	}
+	return NULL;
+}
+
 /**
  * Add an option for a module.
  */
@@ -223,7 +278,7 @@ void be_add_module_list_opt(lc_opt_entry_t *grp, const char *name,
                             be_module_list_entry_t * const * list_head,
                             void **var)
 {
-	module_opt_data_t *moddata = XMALLOC(module_opt_data_t);
+	module_opt_data_t *moddata = OALLOC(get_module_obst(), module_opt_data_t);
 	moddata->var       = var;
 	moddata->list_head = list_head;
 
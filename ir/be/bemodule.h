@@ -34,6 +34,20 @@
  */
 void be_init_modules(void);
 
+/**
+ * Registers a callback that constructs the module's lc_opt groups and
+ * option tables. The callbacks run once, on the first option access
+ * (be_init_module_options()), so startup does not pay for building the
+ * option tree when no options are used.
+ */
+void be_register_module_options(void (*func)(void));
+
+/**
+ * Runs all registered option constructors. Called before the option tree
+ * is accessed; may be called more than once without problems.
+ */
+void be_init_module_options(void);
+
 /**
  * Call all module destructors
  */
@@ -48,6 +62,11 @@ typedef struct be_module_list_entry_t be_module_list_entry_t;
 void be_add_module_to_list(be_module_list_entry_t **list_head, const char *name,
                            void *module);
 
+/** Looks up the module called @p name in @p list, returns NULL if there
+ * is no such module. */
+void *be_module_list_find(be_module_list_entry_t const *list,
+                          const char *name);
+
 void be_add_module_list_opt(lc_opt_entry_t *grp, const char *name,
                             const char *description,
                             be_module_list_entry_t * const * first,
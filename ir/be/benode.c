@@ -133,10 +133,9 @@ static void init_node_attr(ir_node *const node, unsigned const n_outputs, arch_i
 	}
 	info->in_reqs = in_reqs;
 
-	struct obstack *const obst = be_get_be_obst(irg);
-	info->out_infos = NEW_ARR_DZ(reg_out_info_t, obst, n_outputs);
+	reg_out_info_t *const out_infos = be_info_reset_out_infos(node, n_outputs);
 	for (unsigned i = 0; i < n_outputs; ++i) {
-		info->out_infos[i].req = arch_no_register_req;
+		out_infos[i].req = arch_no_register_req;
 	}
 	info->flags = flags;
 }
@@ -374,12 +373,11 @@ ir_node *be_new_Phi(ir_node *block, int n_ins, ir_node **ins, arch_register_req_
 	ir_graph *irg  = get_irn_irg(block);
 	ir_node  *phi = new_ir_node(NULL, irg, block, op_Phi, req->cls->mode, n_ins, ins);
 	phi->attr.phi.u.backedge = new_backedge_arr(get_irg_obstack(irg), n_ins);
-	struct obstack *obst = be_get_be_obst(irg);
 	backend_info_t *info = be_get_info(phi);
-	info->out_infos = NEW_ARR_DZ(reg_out_info_t, obst, 1);
-	info->in_reqs   = be_allocate_in_reqs(irg, n_ins);
+	reg_out_info_t *const out_infos = be_info_reset_out_infos(phi, 1);
+	info->in_reqs = be_allocate_in_reqs(irg, n_ins);
 
-	info->out_infos[0].req = req;
+	out_infos[0].req = req;
 	for (int i = 0; i < n_ins; ++i) {
 		info->in_reqs[i] = req;
 	}
@@ -391,10 +389,8 @@ ir_node *be_new_Phi0(ir_node *const block, arch_register_req_t const *const req)
 {
 	ir_graph *const irg = get_irn_irg(block);
 	ir_node  *const phi = new_ir_node(NULL, irg, block, op_Phi, req->cls->mode, 0, NULL);
-	struct obstack *const obst = be_get_be_obst(irg);
-	backend_info_t *const info = be_get_info(phi);
-	info->out_infos = NEW_ARR_DZ(reg_out_info_t, obst, 1);
-	info->out_infos[0].req = req;
+	reg_out_info_t *const out_infos = be_info_reset_out_infos(phi, 1);
+	out_infos[0].req = req;
 	return phi;
 }
 
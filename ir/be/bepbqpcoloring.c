@@ -681,19 +681,23 @@ static void be_pbqp_coloring(be_chordal_env_t *env)
 /**
  * Initializes this module.
  */
-BE_REGISTER_MODULE_CONSTRUCTOR(be_init_pbqp_coloring)
-void be_init_pbqp_coloring(void)
+static void register_pbqp_coloring_options(void)
 {
 	lc_opt_entry_t *be_grp       = lc_opt_get_grp(firm_opt_get_root(), "be");
 	lc_opt_entry_t *ra_grp       = lc_opt_get_grp(be_grp, "ra");
 	lc_opt_entry_t *chordal_grp  = lc_opt_get_grp(ra_grp, "chordal");
 	lc_opt_entry_t *coloring_grp = lc_opt_get_grp(chordal_grp, "coloring");
 	lc_opt_entry_t *pbqp_grp     = lc_opt_get_grp(coloring_grp, "pbqp");
+	lc_opt_add_table(pbqp_grp, options);
+}
 
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_pbqp_coloring)
+void be_init_pbqp_coloring(void)
+{
 	static be_ra_chordal_coloring_t coloring = {
 		be_pbqp_coloring
 	};
 
-	lc_opt_add_table(pbqp_grp, options);
+	be_register_module_options(register_pbqp_coloring_options);
 	be_register_chordal_coloring("pbqp", &coloring);
 }
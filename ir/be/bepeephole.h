@@ -91,6 +91,14 @@ static inline void register_peephole_optimization(ir_op *const op, peephole_opt_
  * The generic op handler is called for each node if it exists. That's where
  * backend specific optimizations should be performed based on the
  * register-liveness information.
+ *
+ * Note that this is already a multi-pattern matcher: all rules registered
+ * for the walk are dispatched through the per-op handler table, so adding
+ * a rule never adds another schedule traversal. Patterns for the same op
+ * are combined in the op's handler, which can discriminate on operand
+ * shape more directly than a generated decision automaton could. Backends
+ * only run several walks where rule ordering demands it (e.g. ia32 wants
+ * Lea->Add conversion finished before the Test rules run).
  */
 void be_peephole_opt(ir_graph *irg);
 
@@ -51,7 +51,7 @@
 #include "panic.h"
 #include "pdeq.h"
 #include "raw_bitset.h"
-#include "statev.h"
+#include "statev_t.h"
 #include "target_t.h"
 #include "unionfind.h"
 #include "util.h"
@@ -69,15 +69,25 @@
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
 
+stat_ev_cnt_register(pref_assignments, STAT_EV_CAT_RA, "prefalloc_assignments");
+stat_ev_cnt_register(pref_splits,      STAT_EV_CAT_RA, "prefalloc_optimistic_splits");
+stat_ev_cnt_register(pref_copies,      STAT_EV_CAT_RA, "prefalloc_perm_copies");
+stat_ev_cnt_register(pref_exchanges,   STAT_EV_CAT_RA, "prefalloc_perm_exchanges");
+
 static struct obstack               obst;
 static ir_graph                    *irg;
 static const arch_register_class_t *cls;
 static be_lv_t                     *lv;
 static unsigned                     n_regs;
 static unsigned                    *normal_regs;
+static float                       *static_prefs;
 static int                         *congruence_classes;
 static ir_node                    **block_order;
 static size_t                       n_block_order;
+/** Fast mode: skip the preference analysis, congruence classes and
+ * optimistic live-range splits and just assign greedily.  Gives much
+ * faster allocation at the price of more copies, for throwaway code. */
+static bool                         fast_mode;
 
 /** currently active assignments (while processing a basic block)
  * maps registers to values(their current copies) */
@@ -530,6 +540,8 @@ static void fill_sort_candidates(reg_pref_t *regprefs,
 {
 	for (unsigned r = 0; r < n_regs; ++r) {
 		float pref = info->prefs[r];
+		if (static_prefs != NULL)
+			pref += static_prefs[r];
 		regprefs[r].num  = r;
 		regprefs[r].pref = pref;
 	}
@@ -542,6 +554,8 @@ static bool try_optimistic_split(ir_node *to_split, ir_node *before,
                                  unsigned *forbidden_regs, int recursion)
 {
 	(void) pref;
+	if (fast_mode)
+		return false;
 	unsigned           r = 0;
 	allocation_info_t *info = get_allocation_info(to_split);
 	float              delta = 0;
@@ -718,8 +732,10 @@ static void assign_reg(ir_node const *const block, ir_node *const node, arch_reg
 		bool     res
 			= try_optimistic_split(assignments[final_reg_index], before, pref,
 			                       delta, forbidden_regs, 0);
-		if (res)
+		if (res) {
+			stat_ev_cnt_bump(pref_splits);
 			break;
+		}
 	}
 	if (r >= n_regs) {
 		/* the common reason to hit this panic is when 1 of your nodes is not
@@ -728,6 +744,7 @@ static void assign_reg(ir_node const *const block, ir_node *const node, arch_reg
 	}
 
 	use_reg_idx(node, final_reg_index, width);
+	stat_ev_cnt_bump(pref_assignments);
 	DB((dbg, LEVEL_2, "Assign %+F -> %s\n", node, arch_get_irn_register(node)->name));
 }
 
@@ -806,6 +823,7 @@ static void permute_values(ir_nodeset_t *live_nodes, ir_node *before,
 		mark_as_copy_of(copy, src);
 		unsigned width = 1; /* TODO */
 		use_reg_idx(copy, r, width);
+		stat_ev_cnt_bump(pref_copies);
 		DB((dbg, LEVEL_2, "Copy %+F (from %+F, before %+F) -> %s\n", copy, src, before, arch_get_irn_register(copy)->name));
 
 		if (live_nodes != NULL) {
@@ -858,6 +876,7 @@ static void permute_values(ir_nodeset_t *live_nodes, ir_node *before,
 		ir_node *const in[] = { assignments[r2], assignments[old_r] };
 		ir_node *const perm = be_new_Perm(block, ARRAY_SIZE(in), in);
 		sched_add_before(before, perm);
+		stat_ev_cnt_bump(pref_exchanges);
 		DB((dbg, LEVEL_2, "Perm %+F (perm %+F,%+F, before %+F)\n",
 		    perm, in[0], in[1], before));
 
@@ -1743,8 +1762,10 @@ static void be_pref_alloc_cls(void)
 
 	irg_walk_graph(irg, firm_clear_link, NULL, NULL);
 
-	irg_block_walk_graph(irg, NULL, analyze_block, NULL);
-	combine_congruence_classes();
+	if (!fast_mode) {
+		irg_block_walk_graph(irg, NULL, analyze_block, NULL);
+		combine_congruence_classes();
+	}
 
 	for (size_t i = 0; i < n_block_order; ++i) {
 		ir_node *block = block_order[i];
@@ -1802,6 +1823,14 @@ static void be_pref_alloc(ir_graph *new_irg, const regalloc_if_t *regif)
 		normal_regs = rbitset_malloc(n_regs);
 		be_get_allocatable_regs(irg, cls, normal_regs);
 
+		if (regif->register_prefs != NULL) {
+			static_prefs = XMALLOCN(float, n_regs);
+			for (unsigned r = 0; r < n_regs; ++r) {
+				arch_register_t const *const reg = arch_register_for_index(cls, r);
+				static_prefs[r] = regif->register_prefs[reg->global_index];
+			}
+		}
+
 		spill(regif);
 
 		/* verify schedule and register pressure */
@@ -1822,6 +1851,13 @@ static void be_pref_alloc(ir_graph *new_irg, const regalloc_if_t *regif)
 		 * now */
 		be_invalidate_live_sets(irg);
 		free(normal_regs);
+		free(static_prefs);
+		static_prefs = NULL;
+
+		stat_ev_cnt_flush(pref_assignments);
+		stat_ev_cnt_flush(pref_splits);
+		stat_ev_cnt_flush(pref_copies);
+		stat_ev_cnt_flush(pref_exchanges);
 
 		stat_ev_ctx_pop("regcls");
 	}
@@ -1832,9 +1868,26 @@ static void be_pref_alloc(ir_graph *new_irg, const regalloc_if_t *regif)
 	set_optimize(last_opt_state);
 }
 
+/**
+ * Fast variant of the pref allocator: one greedy pass over the blocks
+ * in schedule order without the preference analysis.  All values keep
+ * zeroed preferences, so assign_reg() simply takes the first admissible
+ * register; live-range splits and congruence classes are disabled.
+ * Intended for cold or debug functions where allocation speed matters
+ * more than copy quality.  The spill algorithm stays the selected
+ * spiller module (use -bspill-algo=daemel for the trivial one).
+ */
+static void be_fast_alloc(ir_graph *new_irg, const regalloc_if_t *regif)
+{
+	fast_mode = true;
+	be_pref_alloc(new_irg, regif);
+	fast_mode = false;
+}
+
 BE_REGISTER_MODULE_CONSTRUCTOR(be_init_pref_alloc)
 void be_init_pref_alloc(void)
 {
 	be_register_allocator("pref", be_pref_alloc);
+	be_register_allocator("fast", be_fast_alloc);
 	FIRM_DBG_REGISTER(dbg, "firm.be.prefalloc");
 }
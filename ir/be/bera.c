@@ -17,6 +17,7 @@
 /** The list of register allocators */
 static be_module_list_entry_t *register_allocators;
 static allocate_func           selected_allocator;
+static be_ra_chooser_func      allocator_chooser;
 
 void be_register_allocator(const char *name, allocate_func allocator)
 {
@@ -25,16 +26,36 @@ void be_register_allocator(const char *name, allocate_func allocator)
 	be_add_module_to_list(&register_allocators, name, allocator);
 }
 
+void be_set_allocator_chooser(be_ra_chooser_func func)
+{
+	allocator_chooser = func;
+}
+
 void be_allocate_registers(ir_graph *irg, const regalloc_if_t *regif)
 {
-	selected_allocator(irg, regif);
+	allocate_func allocator = selected_allocator;
+	if (allocator_chooser != NULL) {
+		const char *const name = allocator_chooser(irg);
+		if (name != NULL) {
+			allocate_func const chosen = (allocate_func)
+				be_module_list_find(register_allocators, name);
+			if (chosen != NULL)
+				allocator = chosen;
+		}
+	}
+	allocator(irg, regif);
 }
 
-BE_REGISTER_MODULE_CONSTRUCTOR(be_init_ra)
-void be_init_ra(void)
+static void register_ra_options(void)
 {
 	lc_opt_entry_t *be_grp = lc_opt_get_grp(firm_opt_get_root(), "be");
 
 	be_add_module_list_opt(be_grp, "regalloc", "register allocator",
 	                       &register_allocators, (void**) &selected_allocator);
 }
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_ra)
+void be_init_ra(void)
+{
+	be_register_module_options(register_ra_options);
+}
@@ -19,6 +19,11 @@ struct regalloc_if_t {
 	unsigned spill_cost;  /**< cost for a spill node */
 	unsigned reload_cost; /**< cost for a reload node */
 
+	/** Optional static preference for every register, indexed by global
+	 * register index, may be NULL. Registers with a higher value are chosen
+	 * when the dynamic preferences do not decide. */
+	float const *register_prefs;
+
 	/** mark node as rematerialized */
 	void (*mark_remat)(ir_node *node);
 
@@ -58,4 +63,13 @@ typedef void (*allocate_func)(ir_graph *irg, const regalloc_if_t *regif);
 
 void be_register_allocator(const char *name, allocate_func allocator);
 
+/**
+ * Callback deciding the allocator for a single graph.  Returns the name
+ * of a registered allocator module (e.g. "fast" for cold or debug
+ * functions) or NULL to use the globally selected one.
+ */
+typedef const char *(*be_ra_chooser_func)(ir_graph *irg);
+
+void be_set_allocator_chooser(be_ra_chooser_func func);
+
 #endif
@@ -156,14 +156,19 @@ void be_schedule_graph(ir_graph *irg)
 	scheduler(irg);
 }
 
-BE_REGISTER_MODULE_CONSTRUCTOR(be_init_sched)
-void be_init_sched(void)
+static void register_sched_options(void)
 {
 	lc_opt_entry_t *be_grp = lc_opt_get_grp(firm_opt_get_root(), "be");
 	be_add_module_list_opt(be_grp, "scheduler", "scheduling algorithm",
 	                       &schedulers, (void**)&scheduler);
 }
 
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_sched)
+void be_init_sched(void)
+{
+	be_register_module_options(register_sched_options);
+}
+
 ir_node *be_move_after_schedule_first(ir_node *node)
 {
 	for (;;) {
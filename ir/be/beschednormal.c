@@ -15,17 +15,28 @@
 #include "benode.h"
 #include "besched.h"
 #include "debug.h"
-#include "heights.h"
 #include "irgwalk.h"
 #include "irprintf.h"
 #include "irtools.h"
+#include "obstack_pool.h"
+#include "target_t.h"
 #include "util.h"
+#include <limits.h>
 #include <stdlib.h>
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
 
-static struct obstack obst;
-static ir_node       *curr_list;
+static struct obstack *obst;
+/** Scheduling priority per node index: 1 + the node's position in the
+ * precomputed schedule of its block, 0 for nodes without a position.
+ * Node indices are unique per graph, so the array needs no clearing
+ * between blocks. */
+static unsigned      *sched_position;
+/** Latency-weighted critical path length per node index: the longest
+ * chain of block-local dependencies ending in the node, with every
+ * instruction weighted by its estimated cycle count.  Stored off by one
+ * so 0 means "not yet computed". */
+static unsigned      *path_cost;
 
 typedef struct irn_cost_pair {
 	ir_node *irn;
@@ -49,20 +60,51 @@ static void set_irn_flag_and_cost(ir_node *node, flag_and_cost *fc)
 
 static ir_node *normal_select(ir_nodeset_t *ready_set)
 {
-	for (ir_node *irn = curr_list, *last = NULL, *next; irn != NULL;
-	     last = irn, irn = next) {
-		next = (ir_node*)get_irn_link(irn);
-		if (ir_nodeset_contains(ready_set, irn)) {
-			DB((dbg, LEVEL_1, "Scheduling %+F\n", irn));
-			if (last == NULL)
-				curr_list = next;
-			else
-				set_irn_link(last, next);
-			return irn;
+	/* pick the ready node which comes first in the precomputed schedule */
+	ir_node *best     = NULL;
+	unsigned best_pos = 0;
+	foreach_ir_nodeset(ready_set, irn, iter) {
+		unsigned pos = sched_position[get_irn_idx(irn)];
+		if (pos == 0)
+			pos = UINT_MAX; /* no position: take it last */
+		if (best == NULL || pos < best_pos) {
+			best     = irn;
+			best_pos = pos;
 		}
 	}
+	DB((dbg, LEVEL_1, "Scheduling %+F\n", best));
+	return best;
+}
+
+/**
+ * Computes the latency-weighted critical path ending in @p irn: the
+ * maximum over all block-local dependency chains of the summed
+ * per-instruction cycle estimates supplied by the backend.  Phis start
+ * fresh chains, their values arrive from predecessor blocks.
+ */
+static unsigned latency_path_cost(ir_node *irn)
+{
+	while (is_Proj(irn))
+		irn = get_Proj_pred(irn);
 
-	return ir_nodeset_first(ready_set);
+	unsigned const idx = get_irn_idx(irn);
+	if (path_cost[idx] != 0)
+		return path_cost[idx] - 1;
+
+	unsigned max_pred = 0;
+	if (!is_Phi(irn)) {
+		ir_node *const block = get_nodes_block(irn);
+		foreach_irn_in(irn, i, pred) {
+			if (get_nodes_block(pred) != block)
+				continue;
+			unsigned const pred_cost = latency_path_cost(pred);
+			max_pred = MAX(max_pred, pred_cost);
+		}
+	}
+	unsigned const cost
+		= max_pred + ir_target.isa->get_op_estimated_cost(irn);
+	path_cost[idx] = cost + 1;
+	return cost;
 }
 
 static int cost_cmp(const void *a, const void *b)
@@ -70,6 +112,12 @@ static int cost_cmp(const void *a, const void *b)
 	const irn_cost_pair *const a1 = (const irn_cost_pair*)a;
 	const irn_cost_pair *const b1 = (const irn_cost_pair*)b;
 	int ret = (int)b1->cost - (int)a1->cost;
+	if (ret == 0) {
+		/* equal register demand: start the operand with the longer
+		 * latency chain first */
+		ret = (int)latency_path_cost(b1->irn)
+		    - (int)latency_path_cost(a1->irn);
+	}
 	if (ret == 0)
 		ret = (int)get_irn_idx(a1->irn) - (int)get_irn_idx(b1->irn);
 	return ret;
@@ -100,7 +148,7 @@ static unsigned normal_tree_cost(ir_node *irn)
 	if (fc == NULL) {
 		ir_node *block = get_nodes_block(irn);
 
-		fc = OALLOCF(&obst, flag_and_cost, costs, arity);
+		fc = OALLOCF(obst, flag_and_cost, costs, arity);
 		fc->no_root = false;
 		irn_cost_pair *costs = fc->costs;
 
@@ -233,8 +281,8 @@ static int root_cmp(const void *a, const void *b)
 
 static void normal_sched_block(ir_node *block, void *env)
 {
-	ir_node     **roots   = (ir_node**)get_irn_link(block);
-	ir_heights_t *heights = (ir_heights_t*)env;
+	ir_node **roots = (ir_node**)get_irn_link(block);
+	(void)env;
 
 	DB((dbg, LEVEL_1, "sched walking block %+F\n", block));
 
@@ -247,8 +295,8 @@ static void normal_sched_block(ir_node *block, void *env)
 	irn_cost_pair *root_costs = ALLOCAN(irn_cost_pair, root_count);
 	for (int i = 0; i < root_count; ++i) {
 		root_costs[i].irn  = roots[i];
-		root_costs[i].cost = get_irn_height(heights, roots[i]);
-		DB((dbg, LEVEL_1, "height of %+F is %u\n", roots[i],
+		root_costs[i].cost = latency_path_cost(roots[i]);
+		DB((dbg, LEVEL_1, "latency path of %+F is %u\n", roots[i],
 		    root_costs[i].cost));
 	}
 	QSORT(root_costs, root_count, root_cmp);
@@ -282,20 +330,15 @@ static void real_sched_block(ir_node *block, void *data)
 {
 	(void)data;
 	ir_node **sched = (ir_node**)get_irn_link(block);
-	ir_node  *first = NULL;
-
-	/* turn into a list, so we can easily remove nodes. The link field is used
-	 * anyway. */
-	for (int i = ARR_LEN(sched); i-- > 0; ) {
-		ir_node *irn = sched[i];
-		set_irn_link(irn, first);
-		first = irn;
+
+	/* record the positions, so the selector can pick the ready node which
+	 * comes first without rescanning the whole remaining schedule */
+	for (int i = 0, n = ARR_LEN(sched); i < n; ++i) {
+		sched_position[get_irn_idx(sched[i])] = i + 1;
 	}
 	/* note: we can free sched here, there should be no attempt to schedule
 	 * a block twice */
 	DEL_ARR_F(sched);
-	set_irn_link(block, sched);
-	curr_list = first;
 
 	ir_nodeset_t *cands = be_list_sched_begin_block(block);
 	while (ir_nodeset_size(cands) > 0) {
@@ -310,24 +353,26 @@ static void sched_normal(ir_graph *irg)
 	/* block uses the link field to store the schedule */
 	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
 
-	obstack_init(&obst);
+	obst = firm_temp_obst_grab();
 
+	path_cost = XMALLOCNZ(unsigned, get_irg_last_idx(irg));
 	irg_walk_graph(irg, firm_clear_link, NULL, NULL);
 	irg_walk_graph(irg, normal_cost_walker,  NULL, NULL);
 	irg_walk_graph(irg, collect_roots, NULL, NULL);
-	ir_heights_t *heights = heights_new(irg);
 	ir_reserve_resources(irg, IR_RESOURCE_IRN_VISITED);
 	inc_irg_visited(irg);
-	irg_block_walk_graph(irg, normal_sched_block, NULL, heights);
+	irg_block_walk_graph(irg, normal_sched_block, NULL, NULL);
 	ir_free_resources(irg, IR_RESOURCE_IRN_VISITED);
-	heights_free(heights);
+	free(path_cost);
 
+	sched_position = XMALLOCNZ(unsigned, get_irg_last_idx(irg));
 	be_list_sched_begin(irg);
 	irg_block_walk_graph(irg, real_sched_block, NULL, NULL);
 	be_list_sched_finish();
+	free(sched_position);
 
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
-	obstack_free(&obst, NULL);
+	firm_temp_obst_release(obst);
 }
 
 BE_REGISTER_MODULE_CONSTRUCTOR(be_init_sched_normal)
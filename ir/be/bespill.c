@@ -50,8 +50,7 @@ void be_do_spill(ir_graph *irg, const arch_register_class_t *cls,
 	selected_spiller(irg, cls, regif);
 }
 
-BE_REGISTER_MODULE_CONSTRUCTOR(be_init_spilloptions)
-void be_init_spilloptions(void)
+static void register_spill_options(void)
 {
 	lc_opt_entry_t *be_grp = lc_opt_get_grp(firm_opt_get_root(), "be");
 	lc_opt_entry_t *spill_grp = lc_opt_get_grp(be_grp, "spill");
@@ -59,3 +58,9 @@ void be_init_spilloptions(void)
 	lc_opt_add_table(spill_grp, be_spill_options);
 	be_add_module_list_opt(spill_grp, "algo", "spill algorithm", &spillers, (void**)&selected_spiller);
 }
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_spilloptions)
+void be_init_spilloptions(void)
+{
+	be_register_module_options(register_spill_options);
+}
@@ -30,6 +30,7 @@
 #include "irnode_t.h"
 #include "irtools.h"
 #include "obst.h"
+#include "obstack_pool.h"
 #include "statev_t.h"
 #include "util.h"
 #include <stdbool.h>
@@ -60,7 +61,7 @@ typedef struct workset_t {
 	loc_t    vals[];  /**< array of the values/distances in this working set */
 } workset_t;
 
-static struct obstack               obst;
+static struct obstack              *obst;
 static const arch_register_class_t *cls;
 static const be_lv_t               *lv;
 static be_loopana_t                *loop_ana;
@@ -92,7 +93,7 @@ static const lc_opt_table_entry_t options[] = {
  */
 static workset_t *new_workset(void)
 {
-	return OALLOCFZ(&obst, workset_t, vals, n_regs);
+	return OALLOCFZ(obst, workset_t, vals, n_regs);
 }
 
 /**
@@ -109,7 +110,7 @@ static void workset_copy(workset_t *dest, const workset_t *src)
  */
 static workset_t *workset_clone(workset_t *workset)
 {
-	workset_t *res = OALLOCF(&obst, workset_t, vals, n_regs);
+	workset_t *res = OALLOCF(obst, workset_t, vals, n_regs);
 	workset_copy(res, workset);
 	return res;
 }
@@ -242,7 +243,7 @@ typedef struct block_info_t {
 
 static block_info_t *new_block_info(ir_node *block)
 {
-	block_info_t *info = OALLOCZ(&obst, block_info_t);
+	block_info_t *info = OALLOCZ(obst, block_info_t);
 	set_irn_link(block, info);
 	return info;
 }
@@ -253,15 +254,14 @@ static inline block_info_t *get_block_info(const ir_node *block)
 }
 
 /**
+ * Turn a next-use answer into the distance used for workset ranking.
  * @return The distance to the next use or 0 if irn has dont_spill flag set
  */
-static unsigned get_distance(ir_node *from, const ir_node *def,
-                             bool skip_from_uses)
+static unsigned use_to_distance(const ir_node *def, be_next_use_t use)
 {
 	assert(!arch_irn_is_ignore(def));
 
-	be_next_use_t use  = be_get_next_use(uses, from, def, skip_from_uses);
-	unsigned      time = use.time;
+	unsigned time = use.time;
 	if (USES_IS_INFINITE(time))
 		return USES_INFINITY;
 
@@ -279,6 +279,16 @@ static unsigned get_distance(ir_node *from, const ir_node *def,
 	return time;
 }
 
+/**
+ * @return The distance to the next use or 0 if irn has dont_spill flag set
+ */
+static unsigned get_distance(ir_node *from, const ir_node *def,
+                             bool skip_from_uses)
+{
+	be_next_use_t use = be_get_next_use(uses, from, def, skip_from_uses);
+	return use_to_distance(def, use);
+}
+
 /**
  * Performs the actions necessary to grant the request that:
  * - new_vals can be held in registers
@@ -329,11 +339,16 @@ static void displace(workset_t *const new_vals, bool const is_usage,
 	if (spills_needed > 0) {
 		DB((dbg, DBG_DECIDE, "    disposing %d values\n", spills_needed));
 
-		/* calculate current next-use distance for live values */
+		/* calculate current next-use distance for live values, batching the
+		 * queries so they share one search through the use tables */
+		const ir_node **live  = ALLOCAN(const ir_node*, len);
+		be_next_use_t  *nexts = ALLOCAN(be_next_use_t, len);
+		for (unsigned i = 0; i < len; ++i) {
+			live[i] = workset_get_val(ws, i);
+		}
+		be_get_next_uses(uses, instr, !is_usage, len, live, nexts);
 		for (unsigned i = 0; i < len; ++i) {
-			ir_node  *val  = workset_get_val(ws, i);
-			unsigned  dist = get_distance(instr, val, !is_usage);
-			workset_set_time(ws, i, dist);
+			workset_set_time(ws, i, use_to_distance(live[i], nexts[i]));
 		}
 
 		/* sort entries by increasing nextuse-distance*/
@@ -805,13 +820,13 @@ static void be_spill_belady(ir_graph *irg, const arch_register_class_t *rcls,
 
 	/* init belady env */
 	stat_ev_tim_push();
-	obstack_init(&obst);
+	obst = firm_temp_obst_grab();
 	cls          = rcls;
 	lv           = be_get_irg_liveness(irg);
 	n_regs       = be_get_n_allocatable_regs(irg, cls);
 	ws           = new_workset();
 	uses         = be_begin_uses(irg, lv);
-	loop_ana     = be_new_loop_pressure(irg, cls);
+	loop_ana     = be_get_loop_pressure_ana(irg);
 	senv         = be_new_spill_env(irg, regif);
 	blocklist    = be_get_cfgpostorder(irg);
 	temp_workset = new_workset();
@@ -839,17 +854,20 @@ static void be_spill_belady(ir_graph *irg, const arch_register_class_t *rcls,
 	/* clean up */
 	be_delete_spill_env(senv);
 	be_end_uses(uses);
-	be_free_loop_pressure(loop_ana);
-	obstack_free(&obst, NULL);
+	firm_temp_obst_release(obst);
 }
 
-BE_REGISTER_MODULE_CONSTRUCTOR(be_init_spillbelady)
-void be_init_spillbelady(void)
+static void register_belady_options(void)
 {
 	lc_opt_entry_t *be_grp       = lc_opt_get_grp(firm_opt_get_root(), "be");
 	lc_opt_entry_t *belady_group = lc_opt_get_grp(be_grp, "belady");
 	lc_opt_add_table(belady_group, options);
+}
 
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_spillbelady)
+void be_init_spillbelady(void)
+{
+	be_register_module_options(register_belady_options);
 	be_register_spiller("belady", be_spill_belady);
 	FIRM_DBG_REGISTER(dbg, "firm.be.spill.belady");
 }
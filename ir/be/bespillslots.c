@@ -358,6 +358,7 @@ typedef struct spill_slot_t {
 	ir_entity *entity;
 	unsigned   size;
 	unsigned   po2align;
+	double     freq;     /**< summed execfreq of all spills and reloads */
 } spill_slot_t;
 
 typedef struct memperm_entry_t memperm_entry_t;
@@ -417,6 +418,25 @@ static void assign_spill_entity(be_fec_env_t *env, ir_node *node,
 	env->set_frame_entity(node, entity, size, po2align);
 }
 
+/**
+ * Estimated execution frequency of a spill: the block frequency of the
+ * store, for Syncs the sum over all joined stores. PhiMs and NoMems do not
+ * access memory themselves.
+ */
+static double spill_access_freq(ir_node *node)
+{
+	if (is_NoMem(node) || is_Phi(node))
+		return 0.0;
+	if (is_Sync(node)) {
+		double freq = 0.0;
+		foreach_irn_in(node, i, in) {
+			freq += spill_access_freq(in);
+		}
+		return freq;
+	}
+	return get_block_execfreq(get_nodes_block(skip_Proj(node)));
+}
+
 /**
  * Create stack entities for the spillslots and assign them to the spill and
  * reload nodes.
@@ -436,6 +456,16 @@ static void assign_spillslots(be_fec_env_t *env)
 
 		slot->size     = MAX(slot->size, web->slot_size);
 		slot->po2align = MAX(slot->po2align, web->slot_po2align);
+		slot->freq    += spill_access_freq(spill->spill);
+	}
+
+	/* Account the reloads as well, so the access frequency of a slot is
+	 * known before its entity is created below. */
+	for (size_t s = 0; s < ARR_LEN(env->reloads); ++s) {
+		ir_node *const reload = env->reloads[s];
+		spill_t *const spill  = get_spill(env, get_memory_edge(reload));
+		spillslots[spill->spillslot].freq
+			+= get_block_execfreq(get_nodes_block(reload));
 	}
 
 	ir_type *const frame = get_irg_frame_type(env->irg);
@@ -445,8 +475,10 @@ static void assign_spillslots(be_fec_env_t *env)
 		int            slotid = spill->spillslot;
 		spill_slot_t  *slot   = &spillslots[slotid];
 
-		if (slot->entity == NULL)
+		if (slot->entity == NULL) {
 			slot->entity = new_spillslot(frame, slot->size, slot->po2align);
+			slot->entity->attr.spillslot.freq = slot->freq;
+		}
 
 		if (is_Phi(node)) {
 			ir_node *block = get_nodes_block(node);
@@ -461,9 +493,11 @@ static void assign_spillslots(be_fec_env_t *env)
 
 				if (slotid != argslotid) {
 					spill_slot_t *argslot = &spillslots[argslotid];
-					if (argslot->entity == NULL)
+					if (argslot->entity == NULL) {
 						argslot->entity = new_spillslot(frame, argslot->size,
 						                                argslot->po2align);
+						argslot->entity->attr.spillslot.freq = argslot->freq;
+					}
 
 					memperm_t *const memperm = get_memperm(env, predblock);
 					memperm_entry_t *const entry
@@ -16,6 +16,8 @@
 #include "bearch.h"
 #include "bechordal_t.h"
 #include "beirg.h"
+#include "belive.h"
+#include "beloopana.h"
 #include "bemodule.h"
 #include "benode.h"
 #include "besched.h"
@@ -27,11 +29,15 @@
 #include "ident_t.h"
 #include "irbackedge_t.h"
 #include "ircons_t.h"
+#include "irdom.h"
 #include "iredges_t.h"
 #include "irgmod.h"
 #include "irgwalk.h"
+#include "irloop.h"
 #include "irnode_t.h"
 #include "irnodehashmap.h"
+#include "irnodeset.h"
+#include "pdeq.h"
 #include "statev_t.h"
 #include "target_t.h"
 #include "type_t.h"
@@ -237,6 +243,40 @@ void be_spill_phi(spill_env_t *const env, ir_node *const phi)
 
 static void determine_spill_costs(spill_env_t *env, spill_info_t *spillinfo);
 
+/**
+ * Looks for a cheaper position for a spill on the dominator path between
+ * the definition and the requested position.  The value sits in a register
+ * from its definition down to the requested position anyway, so executing
+ * the store in a colder dominating block (typically in front of the loop
+ * containing the requested position) changes neither register pressure nor
+ * which reloads are dominated; the store just runs less often.
+ */
+static ir_node *cheaper_spill_position(ir_node *to_spill, ir_node *after)
+{
+	ir_node *const insn      = skip_Proj(to_spill);
+	ir_node *const def_block = get_nodes_block(insn);
+	ir_node *const block     = get_block(after);
+	if (block == def_block)
+		return after;
+
+	ir_node *best      = after;
+	double   best_freq = get_block_execfreq(block);
+	for (ir_node *dom = get_Block_idom(block);
+	     dom != NULL && dom != def_block; dom = get_Block_idom(dom)) {
+		double const freq = get_block_execfreq(dom);
+		if (freq >= best_freq)
+			continue;
+		/* place the store in front of the control flow op ending the
+		 * block; a block holding nothing else offers no such position */
+		ir_node *const prev = sched_prev(be_get_end_of_block_insertion_point(dom));
+		if (sched_is_begin(prev))
+			continue;
+		best      = prev;
+		best_freq = freq;
+	}
+	return best;
+}
+
 /**
  * Creates a spill.
  *
@@ -254,9 +294,20 @@ static void spill_irn(spill_env_t *env, spill_info_t *spillinfo)
 	DBG((dbg, LEVEL_1, "spilling %+F ... \n", to_spill));
 	for (spill_t *spill = spillinfo->spills; spill != NULL;
 	     spill = spill->next) {
-		ir_node *const after = be_move_after_schedule_first(spill->after);
-		spill->spill = env->regif.new_spill(to_spill, after);
-		DB((dbg, LEVEL_1, "\t%+F after %+F\n", spill->spill, after));
+		ir_node *after = be_move_after_schedule_first(spill->after);
+		ir_node *hoisted = cheaper_spill_position(to_spill, after);
+		/* never create two stores at the very same position */
+		for (spill_t *other = spillinfo->spills; other != spill;
+		     other = other->next) {
+			if (other->after == hoisted) {
+				hoisted = after;
+				break;
+			}
+		}
+		spill->after = hoisted;
+		spill->spill = env->regif.new_spill(to_spill, hoisted);
+		DB((dbg, LEVEL_1, "\t%+F after %+F\n", spill->spill, hoisted));
+		be_invalidate_block_pressure(env->irg, get_block(hoisted));
 		env->spill_count++;
 	}
 	DBG((dbg, LEVEL_1, "\n"));
@@ -536,10 +587,145 @@ static void determine_spill_costs(spill_env_t *env, spill_info_t *spillinfo)
 	DB((dbg, LEVEL_1, "spill %+F after definition\n", to_spill));
 }
 
+/**
+ * Tests whether the loops around @p block are strictly inside the loops
+ * around @p dom, i.e. whether placing code at the end of @p dom moves it
+ * out of at least one loop without entering an unrelated one.
+ */
+static bool is_hoisting_position(const ir_node *dom, const ir_node *block)
+{
+	ir_loop  *const outer       = get_irn_loop(dom);
+	unsigned  const outer_depth = outer != NULL ? get_loop_depth(outer) : 0;
+	ir_loop        *inner       = get_irn_loop(block);
+	unsigned  const inner_depth = inner != NULL ? get_loop_depth(inner) : 0;
+	if (inner_depth <= outer_depth)
+		return false;
+	if (outer_depth == 0)
+		return true;
+	while (inner != NULL && get_loop_depth(inner) > outer_depth)
+		inner = get_loop_outer_loop(inner);
+	return inner == outer;
+}
+
+/**
+ * Tests whether every block that a value live from the end of @p from to
+ * the entry of @p to would span still has a register of @p cls left.
+ * The blocks in question are found by a backward walk from @p to; they
+ * are all dominated by @p from.  On success their cached pressure is
+ * invalidated since the caller is about to extend a live range across
+ * them.
+ */
+static bool region_has_free_reg(spill_env_t *env, be_loopana_t *loop_ana,
+                                const arch_register_class_t *cls,
+                                unsigned n_regs, ir_node *from, ir_node *to)
+{
+	bool result = true;
+	if (be_get_block_pressure(loop_ana, cls, from) + 1 > n_regs)
+		return false;
+
+	ir_nodeset_t visited;
+	ir_nodeset_init(&visited);
+	deq_t worklist;
+	deq_init(&worklist);
+	ir_nodeset_insert(&visited, to);
+	deq_push_pointer_right(&worklist, to);
+	while (!deq_empty(&worklist)) {
+		ir_node *const block = deq_pop_pointer_left(ir_node, &worklist);
+		if (be_get_block_pressure(loop_ana, cls, block) + 1 > n_regs) {
+			result = false;
+			break;
+		}
+		for (int i = 0, n = get_Block_n_cfgpreds(block); i < n; ++i) {
+			ir_node *const pred = get_Block_cfgpred_block(block, i);
+			if (pred == NULL || pred == from
+			 || ir_nodeset_contains(&visited, pred))
+				continue;
+			ir_nodeset_insert(&visited, pred);
+			deq_push_pointer_right(&worklist, pred);
+		}
+	}
+	deq_free(&worklist);
+
+	if (result) {
+		be_invalidate_block_pressure(env->irg, from);
+		foreach_ir_nodeset(&visited, block, iter) {
+			be_invalidate_block_pressure(env->irg, block);
+		}
+	}
+	ir_nodeset_destroy(&visited);
+	return result;
+}
+
+/**
+ * Looks for a reload position in front of the loops around @p before.
+ * A reload is a value of its own, so moving it out of a hot loop splits
+ * the live range of the spilled value: the subrange through the loop
+ * stays in a register while the rest of the range remains in memory.
+ * Hoisting is only done into strictly colder blocks that all spill
+ * stores dominate, and only when every block the new subrange spans
+ * keeps a free register, so the pressure bound established by the
+ * spiller still holds.  Returns the node to place the reload before.
+ */
+static ir_node *hoisted_reload_position(spill_env_t *env, spill_info_t *si,
+                                        ir_node *before)
+{
+	ir_node *const block = get_block(before);
+	ir_loop *const loop  = get_irn_loop(block);
+	if (loop == NULL || get_loop_depth(loop) == 0)
+		return before;
+	be_lv_t *const lv = be_get_irg_liveness(env->irg);
+	if (!lv->sets_valid)
+		return before;
+
+	/* pick the coldest dominating position outside the use's loops */
+	ir_node *best      = NULL;
+	double   best_freq = get_block_execfreq(block);
+	for (ir_node *dom = get_Block_idom(block); dom != NULL;
+	     dom = get_Block_idom(dom)) {
+		if (!is_hoisting_position(dom, block))
+			continue;
+		double const freq = get_block_execfreq(dom);
+		if (freq >= best_freq)
+			continue;
+		/* the slot must be written on every path to the reload */
+		bool spills_dominate = true;
+		for (spill_t *spill = si->spills; spill != NULL;
+		     spill = spill->next) {
+			ir_node *const spill_block = get_block(spill->spill);
+			if (spill_block == dom
+			 || !block_dominates(spill_block, dom)) {
+				spills_dominate = false;
+				break;
+			}
+		}
+		if (!spills_dominate)
+			continue;
+		best      = dom;
+		best_freq = freq;
+	}
+	if (best == NULL)
+		return before;
+
+	const arch_register_class_t *const cls
+		= arch_get_irn_register_req(si->to_spill)->cls;
+	unsigned      const n_regs   = be_get_n_allocatable_regs(env->irg, cls);
+	be_loopana_t *const loop_ana = be_get_loop_pressure_ana(env->irg);
+	if (!region_has_free_reg(env, loop_ana, cls, n_regs, best, block))
+		return before;
+
+	DBG((dbg, LEVEL_1, "\thoisting reload of %+F from %+F to %+F\n",
+	     si->to_spill, block, best));
+	return be_get_end_of_block_insertion_point(best);
+}
+
 void be_insert_spills_reloads(spill_env_t *env)
 {
 	be_timer_push(T_RA_SPILL_APPLY);
 
+	/* needed to walk up the dominator tree when hoisting spill stores;
+	 * spilling only changes schedules, never the CFG */
+	assure_irg_properties(env->irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+
 	/* create all phi-ms first, this is needed so, that phis, hanging on
 	   spilled phis work correctly */
 	for (spill_info_t *info = env->mem_phis; info != NULL;
@@ -607,6 +793,7 @@ void be_insert_spills_reloads(spill_env_t *env)
 		}
 
 		/* go through all reloads for this spill */
+		bool hoisted = false;
 		for (reloader_t *rld = si->reloaders; rld != NULL; rld = rld->next) {
 			ir_node *copy; /* a reload is a "copy" of the original value */
 			if (be_do_remats && (force_remat || rld->remat_cost_delta < 0)) {
@@ -616,16 +803,27 @@ void be_insert_spills_reloads(spill_env_t *env)
 				/* make sure we have a spill */
 				spill_node(env, si);
 
+				/* try to split the live range at the loops around the
+				 * use; at most once per value, since the pressure data
+				 * only becomes valid again after the SSA reconstruction
+				 * below */
+				ir_node *before = rld->reloader;
+				if (!hoisted) {
+					before  = hoisted_reload_position(env, si, before);
+					hoisted = before != rld->reloader;
+				}
+
 				/* create a reload, use the first spill for now SSA
 				 * reconstruction for memory comes below */
 				assert(si->spills != NULL);
 				copy = env->regif.new_reload(si->to_spill, si->spills->spill,
-				                             rld->reloader);
+				                             before);
 				env->reload_count++;
 			}
 
 			DBG((dbg, LEVEL_1, " %+F of %+F before %+F\n",
 			     copy, to_spill, rld->reloader));
+			be_invalidate_block_pressure(env->irg, get_block(rld->reloader));
 			ARR_APP1(ir_node*, copies, copy);
 		}
 
@@ -637,6 +835,17 @@ void be_insert_spills_reloads(spill_env_t *env)
 			be_ssa_construction_add_copy(&senv, to_spill);
 			be_ssa_construction_add_copies(&senv, copies, ARR_LEN(copies));
 			be_ssa_construction_fix_users(&senv, to_spill);
+
+			/* only the spilled value and its copies changed their
+			 * liveness; repair exactly those instead of invalidating
+			 * the whole analysis */
+			be_lv_t *const lv = be_get_irg_liveness(env->irg);
+			if (lv->sets_valid) {
+				be_liveness_update(lv, to_spill);
+				for (size_t i = 0, n = ARR_LEN(copies); i < n; ++i)
+					be_liveness_introduce(lv, copies[i]);
+				be_ssa_construction_update_liveness_phis(&senv, lv);
+			}
 			be_ssa_construction_destroy(&senv);
 		}
 		/* need to reconstruct SSA form if we had multiple spills */
@@ -669,10 +878,9 @@ void be_insert_spills_reloads(spill_env_t *env)
 	stat_ev_dbl("spill_remats", env->remat_count);
 	stat_ev_dbl("spill_spilled_phis", env->spilled_phi_count);
 
-	/* Matze: In theory be_ssa_construction should take care of the liveness...
-	 * try to disable this again in the future */
-	be_invalidate_live_sets(env->irg);
-
+	/* Liveness was repaired per spilled value above and
+	 * be_remove_dead_nodes_from_schedule() drops killed values from the
+	 * sets itself, so no full invalidation is needed here. */
 	be_remove_dead_nodes_from_schedule(env->irg);
 
 	be_timer_pop(T_RA_SPILL_APPLY);
@@ -45,7 +45,7 @@
 
 #include "debug.h"
 #include "array.h"
-#include "irdom.h"
+#include "irdom_t.h"
 #include "ircons.h"
 #include "iredges_t.h"
 #include "statev_t.h"
@@ -82,10 +82,10 @@ static bool has_definition(const ir_node *block)
 static constr_info *get_or_set_info(be_ssa_construction_env_t *env,
                                     const ir_node *node)
 {
-	constr_info *info = ir_nodemap_get(constr_info, &env->infos, node);
+	constr_info *info = ir_nodehashmap_get(constr_info, &env->infos, node);
 	if (info == NULL) {
 		info = OALLOCZ(&env->obst, constr_info);
-		ir_nodemap_insert(&env->infos, node, info);
+		ir_nodehashmap_insert(&env->infos, (ir_node*)node, info);
 	}
 	return info;
 }
@@ -93,7 +93,7 @@ static constr_info *get_or_set_info(be_ssa_construction_env_t *env,
 static constr_info *get_info(const be_ssa_construction_env_t *env,
                              const ir_node *node)
 {
-	return ir_nodemap_get(constr_info, &env->infos, node);
+	return ir_nodehashmap_get(constr_info, &env->infos, node);
 }
 
 /**
@@ -164,28 +164,10 @@ static void introduce_use(be_ssa_construction_env_t *env, ir_node *use)
  */
 static void mark_iterated_dominance_frontiers(be_ssa_construction_env_t *env)
 {
-	stat_ev_cnt_decl(blocks);
-	DBG((dbg, LEVEL_3, "Dominance Frontier:"));
+	DBG((dbg, LEVEL_3, "Dominance Frontier:\n"));
 	stat_ev_tim_push();
-	while (!deq_empty(&env->worklist)) {
-		ir_node  *block    = deq_pop_pointer_left(ir_node, &env->worklist);
-		ir_node **domfront = ir_get_dominance_frontier(block);
-		for (size_t i = 0, len = ARR_LEN(domfront); i < len; ++i) {
-			ir_node *y = domfront[i];
-			if (Block_block_visited(y))
-				continue;
-
-			if (!irn_visited(y))
-				deq_push_pointer_right(&env->worklist, y);
-
-			DBG((dbg, LEVEL_3, " %+F", y));
-			mark_Block_block_visited(y);
-			stat_ev_cnt_inc(blocks);
-		}
-	}
+	ir_mark_iterated_dominance_frontiers(env->irg, &env->worklist);
 	stat_ev_tim_pop("bessaconstr_idf_time");
-	stat_ev_cnt_done(blocks, "bessaconstr_idf_blocks");
-	DBG((dbg, LEVEL_3, "\n"));
 }
 
 /**
@@ -361,7 +343,7 @@ void be_ssa_construction_init(be_ssa_construction_env_t *env, ir_graph *irg)
 	env->irg       = irg;
 	env->new_phis  = NEW_ARR_F(ir_node*, 0);
 	deq_init(&env->worklist);
-	ir_nodemap_init(&env->infos, irg);
+	ir_nodehashmap_init(&env->infos);
 	obstack_init(&env->obst);
 
 	assure_irg_properties(env->irg,
@@ -382,7 +364,7 @@ void be_ssa_construction_destroy(be_ssa_construction_env_t *env)
 {
 	stat_ev_int("bessaconstr_phis", ARR_LEN(env->new_phis));
 	obstack_free(&env->obst, NULL);
-	ir_nodemap_destroy(&env->infos);
+	ir_nodehashmap_destroy(&env->infos);
 	deq_free(&env->worklist);
 	DEL_ARR_F(env->new_phis);
 
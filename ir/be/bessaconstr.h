@@ -38,7 +38,7 @@
 #include "firm_types.h"
 #include "belive.h"
 #include "pdeq.h"
-#include "irnodemap.h"
+#include "irnodehashmap.h"
 #include "obst.h"
 
 typedef struct be_ssa_construction_env_t {
@@ -47,7 +47,9 @@ typedef struct be_ssa_construction_env_t {
 	deq_t                        worklist;
 	ir_node                    **new_phis;
 	bool                         iterated_domfront_calculated;
-	ir_nodemap                   infos;
+	/** Sparse map, so setting up an environment stays cheap even when a
+	 * pass runs one SSA reconstruction per value on a big graph. */
+	ir_nodehashmap_t             infos;
 	struct obstack               obst;
 } be_ssa_construction_env_t;
 
@@ -37,6 +37,24 @@ DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
  * - Additionally, we maintain a second array n_used where n_used[n] gives us
  *   the number of *outgoing* edges of node n.
  */
+/**
+ * Returns true if the register transfer graph edge from_reg -> to_reg lies
+ * on a cycle, i.e. if the value written to to_reg flows back into from_reg.
+ * Because every node has at most one incoming edge, it suffices to follow
+ * the unique source chain of from_reg.
+ */
+static bool edge_closes_cycle(const unsigned *parcopy, unsigned n_regs,
+                              unsigned from_reg, unsigned to_reg)
+{
+	unsigned src = parcopy[from_reg];
+	for (unsigned steps = 0; src < n_regs && steps < n_regs; ++steps) {
+		if (src == to_reg)
+			return true;
+		src = parcopy[src];
+	}
+	return false;
+}
+
 static void impl_parcopy(const arch_register_class_t *cls,
                          ir_node *before, unsigned *parcopy, unsigned *n_used,
                          ir_node **phis, ir_node **phi_args, unsigned pred_nr)
@@ -60,10 +78,15 @@ static void impl_parcopy(const arch_register_class_t *cls,
 			continue;
 
 		/* Decide if the current edge should be kept or not.
-		 * We keep an edge if it is a self-loop or if it is the last outgoing
-		 * edge of a node with multiple outgoing edges.
-		 * TODO: More clever heuristics which edge to keep? */
-		if (from_reg == to_reg || from_n_used == 1) {
+		 * A self-loop is always kept, it does not go into the Perm at all.
+		 * Otherwise prefer an edge that does not close a cycle: this way the
+		 * Perm decomposes into plain copy chains instead of cycles, which
+		 * need an extra temporary copy or register swaps when lowered.
+		 * Since every node has at most one incoming edge, at most one
+		 * outgoing edge of from_reg can close a cycle; if we defer it here,
+		 * it is cut as soon as one of its siblings is kept. */
+		if (from_reg == to_reg || from_n_used == 1
+		 || !edge_closes_cycle(parcopy, n_regs, from_reg, to_reg)) {
 			/* Keep from_reg -> to_reg and cut every other edge. */
 
 			for (unsigned dst = 0; dst < n_regs; ++dst) {
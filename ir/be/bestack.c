@@ -184,6 +184,12 @@ static int cmp_slots_last(void const *const p0, void const *const p1)
 	if (e0->kind == IR_ENTITY_SPILLSLOT) {
 		if (e1->kind != IR_ENTITY_SPILLSLOT)
 			return -1;
+		/* Frequently accessed slots go towards the frame base register,
+		 * where they get the short displacement encodings. */
+		double const f0 = e0->attr.spillslot.freq;
+		double const f1 = e1->attr.spillslot.freq;
+		if (f0 != f1)
+			return f0 < f1 ? 1 : -1;
 	} else if (e1->kind == IR_ENTITY_SPILLSLOT)
 		return 1;
 
@@ -197,6 +203,13 @@ static int cmp_slots_first(void const *const p0, void const *const p1)
 	if (e0->kind == IR_ENTITY_SPILLSLOT) {
 		if (e1->kind != IR_ENTITY_SPILLSLOT)
 			return 1;
+		/* The end of the member list is laid out nearest to the stack
+		 * pointer here, so sort frequently accessed slots towards it to
+		 * get the short displacement encodings. */
+		double const f0 = e0->attr.spillslot.freq;
+		double const f1 = e1->attr.spillslot.freq;
+		if (f0 != f1)
+			return f0 < f1 ? -1 : 1;
 	} else if (e1->kind == IR_ENTITY_SPILLSLOT)
 		return -1;
 
@@ -24,6 +24,7 @@
 #include "beutil.h"
 #include "cpset.h"
 #include "debug.h"
+#include "execfreq.h"
 #include "ircons_t.h"
 #include "iredges_t.h"
 #include "irgmod.h"
@@ -51,6 +52,8 @@ typedef struct minibelady_env_t {
 	create_reload_func     create_reload;
 	create_spill_func      create_spill;
 	spill_info_t          *spills;
+	ir_node              **last_states;    /**< states that got an additional
+	                                            use from a reload sequence */
 	ir_nodehashmap_t       spill_infos;
 
 	be_uses_t             *uses;           /**< env for the next-use magic */
@@ -127,6 +130,10 @@ static void create_reload(minibelady_env_t *env, ir_node *state,
 	ir_node *reload = env->create_reload(env->func_env, state, spill, before,
 	                                     last_state);
 	ARR_APP1(ir_node*, spill_info->reloads, reload);
+	/* the callback may have used last_state as input of a state store,
+	 * remember it so its liveness can be refreshed at the end */
+	if (last_state != NULL)
+		ARR_APP1(ir_node*, env->last_states, last_state);
 }
 
 static void spill_phi(minibelady_env_t *env, ir_node *phi)
@@ -166,6 +173,29 @@ static void spill_phi(minibelady_env_t *env, ir_node *phi)
 
 static void belady(minibelady_env_t *env, ir_node *block);
 
+/**
+ * Sums up the execution frequencies of all predecessors of @p block whose
+ * already computed end state does not match @p value at the block border,
+ * i.e. the frequency with which reloads on the incoming edges would execute
+ * if @p value were chosen as start state.  Predecessors that are not
+ * processed yet have an unknown end state and are charged as mismatches.
+ */
+static double border_mismatch_freq(ir_node *block, ir_node *value)
+{
+	double freq = 0.0;
+	for (int i = 0, arity = get_Block_n_cfgpreds(block); i < arity; ++i) {
+		ir_node *pred = get_Block_cfgpred_block(block, i);
+		ir_node *need = value;
+
+		if (is_Phi(need) && get_nodes_block(need) == block)
+			need = get_irn_n(need, i);
+
+		if (!irn_visited(pred) || get_block_info(pred)->end_state != need)
+			freq += get_block_execfreq(pred);
+	}
+	return freq;
+}
+
 /**
  * Collects all values live-in at block @p block and all phi results in this
  * block.
@@ -296,6 +326,57 @@ static block_info_t *compute_block_start_state(minibelady_env_t *env,
 		}
 	}
 
+	/* The choice above minimizes the next-use distance, but every
+	 * predecessor whose end state differs from the start state receives a
+	 * reload on its incoming edge.  On merge points of hot paths it is often
+	 * cheaper to continue with the state the frequent predecessors already
+	 * have and pay a single reload before the next use instead, so re-weigh
+	 * the candidates with the frequencies of the borders they would dirty. */
+	if (best_starter != NULL) {
+		double   block_freq = get_block_execfreq(block);
+		double   best_cost  = border_mismatch_freq(block, best_starter);
+		ir_node *refined    = NULL;
+
+		sched_foreach_phi(block, node) {
+			if (arch_get_irn_register(node) != env->reg
+			 || node == best_starter)
+				continue;
+			be_next_use_t next_use = be_get_next_use(env->uses, first, node, 0);
+			if (USES_IS_INFINITE(next_use.time))
+				continue;
+			/* a reload before the first use at most executes as often as
+			 * the block itself */
+			double cost = border_mismatch_freq(block, node) + block_freq;
+			if (cost < best_cost) {
+				best_cost = cost;
+				refined   = node;
+			}
+		}
+		be_lv_foreach_cls(env->lv, block, be_lv_state_in, env->reg->cls, node) {
+			if (arch_get_irn_register(node) != env->reg
+			 || node == best_starter)
+				continue;
+			be_next_use_t next_use = be_get_next_use(env->uses, first, node, 0);
+			if (USES_IS_INFINITE(next_use.time))
+				continue;
+			double cost = border_mismatch_freq(block, node) + block_freq;
+			if (cost < best_cost) {
+				best_cost = cost;
+				refined   = node;
+			}
+		}
+
+		if (refined != NULL) {
+			DBG((dbg, LEVEL_2, "\texecfreq overrides %+F with %+F\n",
+			     best_starter, refined));
+			if (is_Phi(best_starter)) {
+				/* spill the phi as it is not used */
+				spill_phi(env, best_starter);
+			}
+			best_starter = refined;
+		}
+	}
+
 	block_info->start_state = best_starter;
 
 	return block_info;
@@ -422,6 +503,7 @@ void be_assure_state(ir_graph *irg, const arch_register_t *reg, void *func_env,
 	env.lv            = be_get_irg_liveness(irg);
 	env.uses          = be_begin_uses(irg, env.lv);
 	env.spills        = NULL;
+	env.last_states   = NEW_ARR_F(ir_node*, 0);
 	ir_nodehashmap_init(&env.spill_infos);
 
 	inc_irg_visited(irg);
@@ -435,6 +517,7 @@ void be_assure_state(ir_graph *irg, const arch_register_t *reg, void *func_env,
 	ir_free_resources(irg, IR_RESOURCE_IRN_VISITED | IR_RESOURCE_IRN_LINK);
 
 	/* reconstruct ssa-form */
+	be_lv_t      *lv   = be_get_irg_liveness(irg);
 	spill_info_t *info = env.spills;
 	while (info != NULL) {
 		be_ssa_construction_env_t senv;
@@ -452,18 +535,38 @@ void be_assure_state(ir_graph *irg, const arch_register_t *reg, void *func_env,
 			ir_node *phi = phis[i];
 			arch_set_irn_register(phi, env.reg);
 		}
+
+		/* keep the live sets valid: everything inserted outside the webs is
+		 * block local and does not show up at block borders */
+		if (lv->sets_valid) {
+			be_liveness_update(lv, info->value);
+			if (info->spill != NULL)
+				be_liveness_update(lv, info->spill);
+			for (size_t i = 0, len = ARR_LEN(info->reloads); i < len; ++i) {
+				be_liveness_update(lv, info->reloads[i]);
+			}
+			be_ssa_construction_update_liveness_phis(&senv, lv);
+		}
 		be_ssa_construction_destroy(&senv);
 
 		info = info->next;
 	}
 
+	/* reload sequences may read an old state to save it, which extends its
+	 * live range; refresh those values after all users are rewired */
+	if (lv->sets_valid) {
+		for (size_t i = 0, len = ARR_LEN(env.last_states); i < len; ++i) {
+			be_liveness_update(lv, env.last_states[i]);
+		}
+	}
+
 	/* some nodes might be dead now. */
 	be_remove_dead_nodes_from_schedule(irg);
 
 	ir_nodehashmap_destroy(&env.spill_infos);
 	be_end_uses(env.uses);
+	DEL_ARR_F(env.last_states);
 	obstack_free(&env.obst, NULL);
-	be_invalidate_live_sets(irg);
 }
 
 BE_REGISTER_MODULE_CONSTRUCTOR(be_init_state)
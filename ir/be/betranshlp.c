@@ -231,8 +231,10 @@ ir_node *be_transform_nodes_block(ir_node const *const node)
 
 void be_enqueue_operands(ir_node *node)
 {
-	/* put the preds in the worklist */
+	/* put the untransformed preds in the worklist */
 	foreach_irn_in(node, i, pred) {
+		if (be_is_transformed(pred))
+			continue;
 		deq_push_pointer_right(&env.worklist, pred);
 	}
 }
@@ -279,6 +281,15 @@ static void fix_loops(ir_node *node)
 
 /**
  * Transforms all nodes. Deletes the old obstack and creates a new one.
+ *
+ * Note that partitioning the work by block and selecting instructions on
+ * several threads does not work with this design: transform callbacks
+ * recurse into operands across block boundaries via be_transform_node(),
+ * all new nodes are CSE'd through the one identities table of the graph
+ * and allocated on the one graph obstack, and progress is tracked with the
+ * graph-global visited counter and link fields. Sharding any of this per
+ * worker would need per-thread node arenas and a concurrent value table in
+ * ircons first; until then the transformation stays serial.
  */
 static void transform_nodes(ir_graph *irg, arch_pretrans_nodes *pre_transform)
 {
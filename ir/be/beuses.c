@@ -25,7 +25,6 @@
 #include "obst.h"
 #include "pmap.h"
 #include "util.h"
-#include <limits.h>
 #include <stdlib.h>
 
 #define UNKNOWN_OUTERMOST_LOOP  ((unsigned)-1)
@@ -40,11 +39,37 @@ typedef struct be_use_t {
 	ir_visited_t   visited;
 } be_use_t;
 
+/**
+ * A single use of a value inside one block.
+ */
+typedef struct block_use_t {
+	unsigned step; /**< schedule step of the using node */
+	ir_node *node; /**< the using node */
+} block_use_t;
+
+/**
+ * All uses of a value inside one block, ordered by schedule step.
+ * Computed once per (block, value) pair, so repeated queries from
+ * different points in the block degrade to a binary search instead of
+ * rescanning all uses of the value. This is safe because the schedule
+ * steps are fixed in be_begin_uses() and the spiller materializes its
+ * spills and reloads only after all queries.
+ */
+typedef struct block_uses_t {
+	const ir_node *block;
+	const ir_node *def;
+	unsigned       n_uses;
+	block_use_t   *uses;
+} block_uses_t;
+
 /**
  * The "uses" environment.
  */
 struct be_uses_t {
+	ir_graph      *irg;  /**< the graph. */
 	set           *uses; /**< cache: contains all computed uses so far. */
+	set           *block_uses; /**< cache: in-block uses per value. */
+	struct obstack obst; /**< holds the sorted in-block use arrays. */
 	const be_lv_t *lv;   /**< the liveness for the graph. */
 	ir_visited_t   visited_counter; /**< current search counter. */
 };
@@ -60,6 +85,27 @@ static int cmp_use(const void *a, const void *b, size_t n)
 	return p->block != q->block || p->node != q->node;
 }
 
+/**
+ * Set-compare two in-block use lists.
+ */
+static int cmp_block_uses(const void *a, const void *b, size_t n)
+{
+	(void)n;
+	const block_uses_t *p = (const block_uses_t*)a;
+	const block_uses_t *q = (const block_uses_t*)b;
+	return p->block != q->block || p->def != q->def;
+}
+
+/**
+ * Order in-block uses by their schedule step.
+ */
+static int cmp_block_use_step(const void *a, const void *b)
+{
+	const block_use_t *p = (const block_use_t*)a;
+	const block_use_t *q = (const block_use_t*)b;
+	return QSORT_CMP(p->step, q->step);
+}
+
 static be_next_use_t get_next_use(be_uses_t *env, ir_node *from,
                                   const ir_node *def, bool skip_from_uses);
 
@@ -158,6 +204,61 @@ static inline void set_step(ir_node *node, unsigned step)
 	set_irn_link(node, INT_TO_PTR(step));
 }
 
+/**
+ * Return the uses of the given value in the given block, ordered by
+ * schedule step. Computes and caches the list on the first request.
+ *
+ * @param env    the uses environment
+ * @param block  the block whose uses are of interest
+ * @param def    the definition of the value
+ */
+static const block_uses_t *get_block_uses(be_uses_t *env,
+                                          const ir_node *block,
+                                          const ir_node *def)
+{
+	block_uses_t temp;
+	temp.block = block;
+	temp.def   = def;
+
+	unsigned      hash   = hash_combine(hash_irn(block), hash_irn(def));
+	block_uses_t *result = set_find(block_uses_t, env->block_uses, &temp,
+	                                sizeof(temp), hash);
+	if (result != NULL)
+		return result;
+
+	unsigned n_uses = 0;
+	foreach_out_edge(def, edge) {
+		ir_node *node = get_edge_src_irn(edge);
+		if (is_Anchor(node) || is_Phi(node))
+			continue;
+		if (get_nodes_block(node) != block)
+			continue;
+		++n_uses;
+	}
+
+	block_use_t *uses = NULL;
+	if (n_uses > 0) {
+		uses = OALLOCN(&env->obst, block_use_t, n_uses);
+		unsigned i = 0;
+		foreach_out_edge(def, edge) {
+			ir_node *node = get_edge_src_irn(edge);
+			if (is_Anchor(node) || is_Phi(node))
+				continue;
+			if (get_nodes_block(node) != block)
+				continue;
+			uses[i].step = get_step(node);
+			uses[i].node = node;
+			++i;
+		}
+		qsort(uses, n_uses, sizeof(uses[0]), cmp_block_use_step);
+	}
+
+	temp.n_uses = n_uses;
+	temp.uses   = uses;
+	return set_insert(block_uses_t, env->block_uses, &temp, sizeof(temp),
+	                  hash);
+}
+
 /**
  * Find the next use of a value defined by def, starting at node from.
  *
@@ -169,33 +270,28 @@ static inline void set_step(ir_node *node, unsigned step)
 static be_next_use_t get_next_use(be_uses_t *const env, ir_node *const from,
                                   const ir_node *def, bool skip_from_uses)
 {
-	ir_node *next_use_node = NULL;
-	unsigned next_use_step = INT_MAX;
-	unsigned timestep      = get_step(from);
-	ir_node *block         = get_nodes_block(from);
-	foreach_out_edge(def, edge) {
-		ir_node *node = get_edge_src_irn(edge);
-		if (is_Anchor(node))
-			continue;
-		if (get_nodes_block(node) != block)
-			continue;
-		if (is_Phi(node))
-			continue;
-
-		unsigned node_step = get_step(node);
-		if (node_step < timestep + skip_from_uses)
-			continue;
-		if (node_step < next_use_step) {
-			next_use_node = node;
-			next_use_step = node_step;
+	unsigned timestep = get_step(from);
+	ir_node *block    = get_nodes_block(from);
+
+	/* binary search for the first in-block use at or after the time step */
+	const block_uses_t *block_uses = get_block_uses(env, block, def);
+	unsigned            limit      = timestep + skip_from_uses;
+	unsigned            lo         = 0;
+	unsigned            hi         = block_uses->n_uses;
+	while (lo < hi) {
+		unsigned mid = lo + (hi - lo) / 2;
+		if (block_uses->uses[mid].step < limit) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
 		}
 	}
 
-	if (next_use_node != NULL) {
+	if (lo < block_uses->n_uses) {
 		be_next_use_t result;
-		result.time           = next_use_step - timestep;
+		result.time           = block_uses->uses[lo].step - timestep;
 		result.outermost_loop = get_loop_depth(get_irn_loop(block));
-		result.before         = next_use_node;
+		result.before         = block_uses->uses[lo].node;
 		return result;
 	}
 
@@ -285,6 +381,17 @@ be_next_use_t be_get_next_use(be_uses_t *env, ir_node *from,
 	return get_next_use(env, from, def, skip_from_uses);
 }
 
+void be_get_next_uses(be_uses_t *env, ir_node *from, bool skip_from_uses,
+                      unsigned n, const ir_node **defs, be_next_use_t *result)
+{
+	/* one search counter for the whole batch: interblock distances computed
+	 * for one value stay valid for the rest of the batch */
+	++env->visited_counter;
+	for (unsigned i = 0; i < n; ++i) {
+		result[i] = get_next_use(env, from, defs[i], skip_from_uses);
+	}
+}
+
 /**
  * Pre-block walker, set the step number for every scheduled node
  * in increasing order.
@@ -315,14 +422,34 @@ be_uses_t *be_begin_uses(ir_graph *irg, const be_lv_t *lv)
 	irg_block_walk_graph(irg, set_sched_step_walker, NULL, NULL);
 
 	be_uses_t *env = XMALLOCZ(be_uses_t);
-	env->uses = new_set(cmp_use, 512);
-	env->lv   = lv;
+	env->irg        = irg;
+	env->uses       = new_set(cmp_use, 512);
+	env->block_uses = new_set(cmp_block_uses, 512);
+	obstack_init(&env->obst);
+	env->lv = lv;
 
 	return env;
 }
 
+void be_uses_invalidate(be_uses_t *env)
+{
+	del_set(env->uses);
+	del_set(env->block_uses);
+	obstack_free(&env->obst, NULL);
+
+	env->uses            = new_set(cmp_use, 512);
+	env->block_uses      = new_set(cmp_block_uses, 512);
+	obstack_init(&env->obst);
+	env->visited_counter = 0;
+
+	/* the steps of already scheduled nodes may have changed as well */
+	irg_block_walk_graph(env->irg, set_sched_step_walker, NULL, NULL);
+}
+
 void be_end_uses(be_uses_t *env)
 {
+	obstack_free(&env->obst, NULL);
+	del_set(env->block_uses);
 	del_set(env->uses);
 	free(env);
 }
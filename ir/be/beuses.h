@@ -44,6 +44,22 @@ typedef struct be_uses_t be_uses_t;
 be_next_use_t be_get_next_use(be_uses_t *uses, ir_node *from,
                               const ir_node *def, bool skip_from_uses);
 
+/**
+ * Computes the next uses of @p n values at once, starting at node @p from.
+ * Equivalent to be_get_next_use() per value, but the queries share one
+ * search through the cached per-block use tables, which matches the
+ * spiller's pattern of ranking a whole live set at an instruction.
+ */
+void be_get_next_uses(be_uses_t *uses, ir_node *from, bool skip_from_uses,
+                      unsigned n, const ir_node **defs, be_next_use_t *result);
+
+/**
+ * Throws away all cached next-use information and recomputes the schedule
+ * steps. Call after inserting or removing scheduled nodes when the
+ * environment is to be queried again.
+ */
+void be_uses_invalidate(be_uses_t *uses);
+
 /**
  * Creates a new uses environment for a graph.
  *
@@ -13,6 +13,7 @@
 
 #include "be_t.h"
 #include "bitfiddle.h"
+#include "ident_t.h"
 #include "ircons.h"
 #include "irgmod.h"
 #include "irnode_t.h"
@@ -59,7 +60,7 @@ load:;
 
 ir_entity *be_make_va_start_entity(ir_type *const frame_type, int const offset)
 {
-	ident     *const id       = new_id_from_str("$va_start");
+	ident     *const id       = id_va_start;
 	ir_type   *const unknown  = get_unknown_type();
 	ir_entity *const va_start = new_entity(frame_type, id, unknown);
 	set_entity_offset(va_start, offset);
@@ -13,6 +13,7 @@
 #include <stdbool.h>
 #include <string.h>
 
+#include "bemodule.h"
 #include "irmode_t.h"
 #include "lc_opts.h"
 #include "lc_opts_enum.h"
@@ -263,183 +264,194 @@ static const lc_opt_table_entry_t ia32_architecture_options[] = {
 	LC_OPT_LAST
 };
 
+/**
+ * Costs of a single instruction on the selected microarchitecture.
+ * The latency is what a dependent instruction has to wait for, the
+ * (reciprocal) throughput is what an independent instruction pays; both in
+ * clock cycles, the throughput in tenths to express superscalar execution.
+ */
+typedef struct insn_cost {
+	unsigned latency;    /**< result latency in cycles */
+	unsigned throughput; /**< reciprocal throughput in tenths of a cycle */
+} insn_cost;
+
 typedef struct insn_const {
-	int      add_cost;                 /**< cost of an add instruction */
-	int      lea_cost;                 /**< cost of a lea instruction */
-	int      const_shf_cost;           /**< cost of a constant shift instruction */
-	int      cost_mul_start;           /**< starting cost of a multiply instruction */
-	int      cost_mul_bit;             /**< cost of multiply for every set bit */
-	unsigned function_alignment;       /**< logarithm for alignment of function labels */
-	unsigned label_alignment;          /**< logarithm for alignment of loops labels */
-	unsigned label_alignment_max_skip; /**< maximum skip for alignment of loops labels */
+	insn_cost add;                      /**< add instruction */
+	insn_cost lea;                      /**< lea instruction */
+	insn_cost const_shf;                /**< shift instruction with constant amount */
+	insn_cost mul;                      /**< multiply instruction (starting costs) */
+	unsigned  cost_mul_bit;             /**< additional mul latency for every set bit */
+	unsigned  function_alignment;       /**< logarithm for alignment of function labels */
+	unsigned  label_alignment;          /**< logarithm for alignment of loops labels */
+	unsigned  label_alignment_max_skip; /**< maximum skip for alignment of loops labels */
 } insn_const;
 
-/* costs for optimizing for size */
+/* costs for optimizing for size (in bytes instead of cycles) */
 static const insn_const size_cost = {
-	2,   /* cost of an add instruction */
-	3,   /* cost of a lea instruction */
-	3,   /* cost of a constant shift instruction */
-	4,   /* starting cost of a multiply instruction */
-	0,   /* cost of multiply for every set bit */
-	0,   /* logarithm for alignment of function labels */
-	0,   /* logarithm for alignment of loops labels */
-	0,   /* maximum skip for alignment of loops labels */
+	.add                      = {  2,  20 },
+	.lea                      = {  3,  30 },
+	.const_shf                = {  3,  30 },
+	.mul                      = {  4,  40 },
+	.cost_mul_bit             = 0,
+	.function_alignment       = 0,
+	.label_alignment          = 0,
+	.label_alignment_max_skip = 0,
 };
 
 /* costs for the i386 */
 static const insn_const i386_cost = {
-	1,   /* cost of an add instruction */
-	1,   /* cost of a lea instruction */
-	3,   /* cost of a constant shift instruction */
-	9,   /* starting cost of a multiply instruction */
-	1,   /* cost of multiply for every set bit */
-	2,   /* logarithm for alignment of function labels */
-	2,   /* logarithm for alignment of loops labels */
-	3,   /* maximum skip for alignment of loops labels */
+	.add                      = {  1,  10 },
+	.lea                      = {  1,  10 },
+	.const_shf                = {  3,  30 },
+	.mul                      = {  9,  90 },
+	.cost_mul_bit             = 1,
+	.function_alignment       = 2,
+	.label_alignment          = 2,
+	.label_alignment_max_skip = 3,
 };
 
 /* costs for the i486 */
 static const insn_const i486_cost = {
-	1,   /* cost of an add instruction */
-	1,   /* cost of a lea instruction */
-	2,   /* cost of a constant shift instruction */
-	12,  /* starting cost of a multiply instruction */
-	1,   /* cost of multiply for every set bit */
-	4,   /* logarithm for alignment of function labels */
-	4,   /* logarithm for alignment of loops labels */
-	15,  /* maximum skip for alignment of loops labels */
+	.add                      = {  1,  10 },
+	.lea                      = {  1,  10 },
+	.const_shf                = {  2,  20 },
+	.mul                      = { 12, 120 },
+	.cost_mul_bit             = 1,
+	.function_alignment       = 4,
+	.label_alignment          = 4,
+	.label_alignment_max_skip = 15,
 };
 
 /* costs for the Pentium */
 static const insn_const pentium_cost = {
-	1,   /* cost of an add instruction */
-	1,   /* cost of a lea instruction */
-	1,   /* cost of a constant shift instruction */
-	11,  /* starting cost of a multiply instruction */
-	0,   /* cost of multiply for every set bit */
-	4,   /* logarithm for alignment of function labels */
-	4,   /* logarithm for alignment of loops labels */
-	7,   /* maximum skip for alignment of loops labels */
+	.add                      = {  1,   5 },
+	.lea                      = {  1,   5 },
+	.const_shf                = {  1,  10 },
+	.mul                      = { 11, 110 },
+	.cost_mul_bit             = 0,
+	.function_alignment       = 4,
+	.label_alignment          = 4,
+	.label_alignment_max_skip = 7,
 };
 
 /* costs for the Pentium Pro */
 static const insn_const pentiumpro_cost = {
-	1,   /* cost of an add instruction */
-	1,   /* cost of a lea instruction */
-	1,   /* cost of a constant shift instruction */
-	4,   /* starting cost of a multiply instruction */
-	0,   /* cost of multiply for every set bit */
-	4,   /* logarithm for alignment of function labels */
-	4,   /* logarithm for alignment of loops labels */
-	10,  /* maximum skip for alignment of loops labels */
+	.add                      = {  1,   3 },
+	.lea                      = {  1,  10 },
+	.const_shf                = {  1,  10 },
+	.mul                      = {  4,  10 },
+	.cost_mul_bit             = 0,
+	.function_alignment       = 4,
+	.label_alignment          = 4,
+	.label_alignment_max_skip = 10,
 };
 
 /* costs for the K6 */
 static const insn_const k6_cost = {
-	1,   /* cost of an add instruction */
-	2,   /* cost of a lea instruction */
-	1,   /* cost of a constant shift instruction */
-	3,   /* starting cost of a multiply instruction */
-	0,   /* cost of multiply for every set bit */
-	5,   /* logarithm for alignment of function labels */
-	5,   /* logarithm for alignment of loops labels */
-	7,   /* maximum skip for alignment of loops labels */
+	.add                      = {  1,   5 },
+	.lea                      = {  2,  10 },
+	.const_shf                = {  1,  10 },
+	.mul                      = {  3,  20 },
+	.cost_mul_bit             = 0,
+	.function_alignment       = 5,
+	.label_alignment          = 5,
+	.label_alignment_max_skip = 7,
 };
 
 /* costs for the Geode */
 static const insn_const geode_cost = {
-	1,   /* cost of an add instruction */
-	1,   /* cost of a lea instruction */
-	1,   /* cost of a constant shift instruction */
-	7,   /* starting cost of a multiply instruction */
-	0,   /* cost of multiply for every set bit */
-	0,   /* logarithm for alignment of function labels */
-	0,   /* logarithm for alignment of loops labels */
-	0,   /* maximum skip for alignment of loops labels */
+	.add                      = {  1,  10 },
+	.lea                      = {  1,  10 },
+	.const_shf                = {  1,  10 },
+	.mul                      = {  7,  50 },
+	.cost_mul_bit             = 0,
+	.function_alignment       = 0,
+	.label_alignment          = 0,
+	.label_alignment_max_skip = 0,
 };
 
 /* costs for the Athlon */
 static const insn_const athlon_cost = {
-	1,   /* cost of an add instruction */
-	2,   /* cost of a lea instruction */
-	1,   /* cost of a constant shift instruction */
-	5,   /* starting cost of a multiply instruction */
-	0,   /* cost of multiply for every set bit */
-	4,   /* logarithm for alignment of function labels */
-	4,   /* logarithm for alignment of loops labels */
-	7,   /* maximum skip for alignment of loops labels */
+	.add                      = {  1,   3 },
+	.lea                      = {  2,   3 },
+	.const_shf                = {  1,   3 },
+	.mul                      = {  5,  20 },
+	.cost_mul_bit             = 0,
+	.function_alignment       = 4,
+	.label_alignment          = 4,
+	.label_alignment_max_skip = 7,
 };
 
 /* costs for the Opteron/K8 */
 static const insn_const k8_cost = {
-	1,   /* cost of an add instruction */
-	2,   /* cost of a lea instruction */
-	1,   /* cost of a constant shift instruction */
-	3,   /* starting cost of a multiply instruction */
-	0,   /* cost of multiply for every set bit */
-	4,   /* logarithm for alignment of function labels */
-	4,   /* logarithm for alignment of loops labels */
-	7,   /* maximum skip for alignment of loops labels */
+	.add                      = {  1,   3 },
+	.lea                      = {  2,   3 },
+	.const_shf                = {  1,   3 },
+	.mul                      = {  3,  10 },
+	.cost_mul_bit             = 0,
+	.function_alignment       = 4,
+	.label_alignment          = 4,
+	.label_alignment_max_skip = 7,
 };
 
 /* costs for the K10 */
 static const insn_const k10_cost = {
-	1,   /* cost of an add instruction */
-	2,   /* cost of a lea instruction */
-	1,   /* cost of a constant shift instruction */
-	3,   /* starting cost of a multiply instruction */
-	0,   /* cost of multiply for every set bit */
-	5,   /* logarithm for alignment of function labels */
-	5,   /* logarithm for alignment of loops labels */
-	7,   /* maximum skip for alignment of loops labels */
+	.add                      = {  1,   3 },
+	.lea                      = {  2,   3 },
+	.const_shf                = {  1,   3 },
+	.mul                      = {  3,  10 },
+	.cost_mul_bit             = 0,
+	.function_alignment       = 5,
+	.label_alignment          = 5,
+	.label_alignment_max_skip = 7,
 };
 
 /* costs for the Pentium 4 */
 static const insn_const netburst_cost = {
-	1,   /* cost of an add instruction */
-	3,   /* cost of a lea instruction */
-	4,   /* cost of a constant shift instruction */
-	15,  /* starting cost of a multiply instruction */
-	0,   /* cost of multiply for every set bit */
-	4,   /* logarithm for alignment of function labels */
-	4,   /* logarithm for alignment of loops labels */
-	7,   /* maximum skip for alignment of loops labels */
+	.add                      = {  1,   3 },
+	.lea                      = {  3,  10 },
+	.const_shf                = {  4,  10 },
+	.mul                      = { 15,  50 },
+	.cost_mul_bit             = 0,
+	.function_alignment       = 4,
+	.label_alignment          = 4,
+	.label_alignment_max_skip = 7,
 };
 
 /* costs for the Nocona and Core */
 static const insn_const nocona_cost = {
-	1,   /* cost of an add instruction */
-	1,   /* cost of a lea instruction */
-	1,   /* cost of a constant shift instruction */
-	10,  /* starting cost of a multiply instruction */
-	0,   /* cost of multiply for every set bit */
-	4,   /* logarithm for alignment of function labels */
-	4,   /* logarithm for alignment of loops labels */
-	7,   /* maximum skip for alignment of loops labels */
+	.add                      = {  1,   3 },
+	.lea                      = {  1,   5 },
+	.const_shf                = {  1,  10 },
+	.mul                      = { 10,  25 },
+	.cost_mul_bit             = 0,
+	.function_alignment       = 4,
+	.label_alignment          = 4,
+	.label_alignment_max_skip = 7,
 };
 
 /* costs for the Core2 */
 static const insn_const core2_cost = {
-	1,   /* cost of an add instruction */
-	1,   /* cost of a lea instruction */
-	1,   /* cost of a constant shift instruction */
-	3,   /* starting cost of a multiply instruction */
-	0,   /* cost of multiply for every set bit */
-	4,   /* logarithm for alignment of function labels */
-	4,   /* logarithm for alignment of loops labels */
-	10,  /* maximum skip for alignment of loops labels */
+	.add                      = {  1,   3 },
+	.lea                      = {  1,  10 },
+	.const_shf                = {  1,   5 },
+	.mul                      = {  3,  10 },
+	.cost_mul_bit             = 0,
+	.function_alignment       = 4,
+	.label_alignment          = 4,
+	.label_alignment_max_skip = 10,
 };
 
 /* costs for the generic32 */
 static const insn_const generic32_cost = {
-	1,   /* cost of an add instruction */
-	2,   /* cost of a lea instruction */
-	1,   /* cost of a constant shift instruction */
-	4,   /* starting cost of a multiply instruction */
-	0,   /* cost of multiply for every set bit */
-	4,   /* logarithm for alignment of function labels */
-	4,   /* logarithm for alignment of loops labels */
-	7,   /* maximum skip for alignment of loops labels */
+	.add                      = {  1,   3 },
+	.lea                      = {  2,   5 },
+	.const_shf                = {  1,   5 },
+	.mul                      = {  4,  15 },
+	.cost_mul_bit             = 0,
+	.function_alignment       = 4,
+	.label_alignment          = 4,
+	.label_alignment_max_skip = 7,
 };
 
 static const insn_const *arch_costs = &generic32_cost;
@@ -475,32 +487,36 @@ int ia32_evaluate_insn(insn_kind kind, const ir_mode *mode, ir_tarval *tv)
 
 	switch (kind) {
 	case MUL:
-		cost = arch_costs->cost_mul_start;
+		cost = arch_costs->mul.latency;
 		if (arch_costs->cost_mul_bit > 0)
 			cost += get_tarval_popcount(tv) * arch_costs->cost_mul_bit;
 		if (get_mode_size_bits(mode) <= 32)
 			return cost;
-		/* 64bit mul supported, approx 4times of a 32bit mul*/
-		return 4 * cost;
+		/* 64bit mul needs 3 muls and 2 adds; the extra muls overlap with the
+		 * first one, so they only pay their issue costs */
+		return cost + (2 * arch_costs->mul.throughput + 9) / 10
+		     + 2 * arch_costs->add.latency;
 	case LEA:
 		/* lea is only supported for 32 bit */
 		if (get_mode_size_bits(mode) <= 32)
-			return arch_costs->lea_cost;
+			return arch_costs->lea.latency;
 		/* in 64bit mode, the Lea cost are at worst 2 shifts and one add */
-		return 2 * arch_costs->add_cost + 2 * (2 * arch_costs->const_shf_cost);
+		return 2 * arch_costs->add.latency
+		     + 2 * (2 * arch_costs->const_shf.latency);
 	case ADD:
 	case SUB:
 		if (get_mode_size_bits(mode) <= 32)
-			return arch_costs->add_cost;
+			return arch_costs->add.latency;
 		/* 64bit add/sub supported, double the cost */
-		return 2 * arch_costs->add_cost;
+		return 2 * arch_costs->add.latency;
 	case SHIFT:
 		if (get_mode_size_bits(mode) <= 32)
-			return arch_costs->const_shf_cost;
+			return arch_costs->const_shf.latency;
 		/* 64bit shift supported, double the cost */
-		return 2 * arch_costs->const_shf_cost;
+		return 2 * arch_costs->const_shf.latency;
 	case ZERO:
-		return arch_costs->add_cost;
+		/* xor reg, reg starts a fresh dependency chain: issue costs only */
+		return (arch_costs->add.throughput + 9) / 10;
 	default:
 		return 1;
 	}
@@ -894,6 +910,12 @@ void ia32_setup_cg_config(void)
 	/* P4s don't like inc/decs because they only partially write the flags
 	 * register which produces false dependencies */
 	c->use_incdec           = !flags(opt_arch, arch_netburst | arch_nocona | arch_core2 | arch_geode) || opt_size;
+	/* a lea that only scales gives a shorter opcode than the shl, but e.g. the
+	 * netburst shifter is slower than its lea unit */
+	c->use_shl_for_lea      = arch_costs->const_shf.latency <= arch_costs->lea.latency || opt_size;
+	/* lea frees us from the 2-address constraint of shl, but pays an extra
+	 * cycle on some cores */
+	c->use_lea_for_shl      = arch_costs->lea.latency <= arch_costs->const_shf.latency && !opt_size;
 	c->use_softfloat        = (fpu_arch & IA32_FPU_SOFTFLOAT) != 0;
 	c->use_sse2             = (fpu_arch & IA32_FPU_SSE2) != 0 && flags(arch, arch_feature_sse2);
 	c->use_ffreep           = flags(opt_arch, arch_athlon_plus);
@@ -931,11 +953,16 @@ void ia32_setup_cg_config(void)
 		2;
 }
 
-void ia32_init_architecture(void)
+static void register_architecture_options(void)
 {
-	memset(&ia32_cg_config, 0, sizeof(ia32_cg_config));
-
 	lc_opt_entry_t *be_grp   = lc_opt_get_grp(firm_opt_get_root(), "be");
 	lc_opt_entry_t *ia32_grp = lc_opt_get_grp(be_grp, "ia32");
 	lc_opt_add_table(ia32_grp, ia32_architecture_options);
 }
+
+void ia32_init_architecture(void)
+{
+	memset(&ia32_cg_config, 0, sizeof(ia32_cg_config));
+
+	be_register_module_options(register_architecture_options);
+}
@@ -23,6 +23,10 @@ typedef struct {
 	bool use_leave:1;
 	/** use inc, dec instead of add $1, reg and add $-1, reg */
 	bool use_incdec:1;
+	/** replace a lea that only scales its operand by a shl */
+	bool use_shl_for_lea:1;
+	/** implement x << 1 as lea (x,x) to get a 3-address operation */
+	bool use_lea_for_shl:1;
 	/** use soft float library */
 	bool use_softfloat:1;
 	/** use sse2 instructions (instead of x87) */
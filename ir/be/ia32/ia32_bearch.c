@@ -1128,7 +1128,7 @@ static void ia32_select_instructions(ir_graph *irg)
 		static ir_entity *mcount = NULL;
 		if (mcount == NULL) {
 			ir_type *tp = new_type_method(0, 0, false, cc_cdecl_set, mtp_no_property);
-			ident   *id = new_id_from_str("mcount");
+			ident   *id = id_mcount;
 			mcount = new_global_entity(get_glob_type(), id, tp,
 			                           ir_visibility_external,
 			                           IR_LINKAGE_DEFAULT);
@@ -1351,6 +1351,13 @@ static void ia32_init(void)
 
 	ir_target.fast_unaligned_memaccess = true;
 	ir_target.allow_ifconv             = ia32_is_mux_allowed;
+	/* medium-sized copies stay CopyB nodes and become rep movs */
+	ir_target.copyb_max_small_size     = 64;
+	ir_target.copyb_min_large_size     = 8193;
+	/* deep out-of-order pipelines pay more for a mispredicted branch */
+	ir_target.branch_mispredict_penalty = 15;
+	/* reg-reg xchg exists but is microcoded on modern cores */
+	ir_target.register_swap_cost       = 2;
 	ir_target.float_int_overflow       = ir_overflow_indefinite;
 	ir_platform_set_va_list_type_pointer();
 
@@ -1632,7 +1639,9 @@ static void ia32_lower_for_target(void)
 		/* Turn all small CopyBs into loads/stores, keep medium-sized CopyBs,
 		 * so we can generate rep movs later, and turn all big CopyBs into
 		 * memcpy calls. */
-		lower_CopyB(irg, 64, 8193, true);
+		lower_CopyB(irg, ir_target.copyb_max_small_size,
+		            ir_target.copyb_min_large_size,
+		            ir_target.fast_unaligned_memaccess);
 		be_after_transform(irg, "lower-copyb");
 	}
 }
@@ -1669,18 +1678,26 @@ arch_isa_if_t const ia32_isa_if = {
 	.generate_code         = ia32_generate_code,
 	.jit_compile           = ia32_jit_compile,
 	.emit_function         = ia32_emit_jit_function,
+	.elf_machine           = 3, /* EM_386 */
+	.get_elf_reloc_type    = ia32_get_elf_reloc_type,
+	.emit_nops             = ia32_emit_nops,
 	.lower_for_target      = ia32_lower_for_target,
 	.additional_reg_names  = ia32_additional_reg_names,
 	.get_op_estimated_cost = ia32_get_op_estimated_cost,
 };
 
-BE_REGISTER_MODULE_CONSTRUCTOR(be_init_arch_ia32)
-void be_init_arch_ia32(void)
+static void register_ia32_options(void)
 {
 	lc_opt_entry_t *be_grp   = lc_opt_get_grp(firm_opt_get_root(), "be");
 	lc_opt_entry_t *ia32_grp = lc_opt_get_grp(be_grp, "ia32");
 
 	lc_opt_add_table(ia32_grp, ia32_options);
+}
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_arch_ia32)
+void be_init_arch_ia32(void)
+{
+	be_register_module_options(register_ia32_options);
 
 	ia32_init_emitter();
 	ia32_init_optimize();
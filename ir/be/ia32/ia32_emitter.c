@@ -35,6 +35,7 @@
 #include "beemitter.h"
 #include "begnuas.h"
 #include "bejit.h"
+#include "bemodule.h"
 #include "besched.h"
 #include "bestack.h"
 #include "beutil.h"
@@ -59,6 +60,10 @@ DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
 
 static char       pic_base_label[128];
 static ir_label_t exc_label_id;
+/** Exception label ids, indexed by node index.  Only throwing
+ * instructions get one and only the emitter reads it, so the ids live
+ * in this side table instead of fattening ia32_attr_t for every node. */
+static ir_label_t *exc_label_ids;
 static bool       mark_spill_reload;
 
 static bool       omit_fp;
@@ -581,13 +586,19 @@ x86_condition_code_t ia32_determine_final_cc(ir_node const *const node,
 	return cc;
 }
 
+static ir_label_t get_ia32_exc_label_id(const ir_node *node)
+{
+	assert(get_ia32_exc_label(node));
+	return exc_label_ids[get_irn_idx(node)];
+}
+
 /**
  * Emits an exception label for a given node.
  */
 static void ia32_emit_exc_label(const ir_node *node)
 {
 	be_emit_string(be_gas_insn_label_prefix());
-	be_emit_irprintf("%lu", get_ia32_exc_label_id(node));
+	be_emit_ulong(get_ia32_exc_label_id(node));
 }
 
 static void emit_jmp(ir_node const *const node, ir_node const *const target)
@@ -1156,7 +1167,8 @@ static void ia32_register_emitters(void)
 static void ia32_assign_exc_label(ir_node *node)
 {
 	/* assign a new ID to the instruction */
-	set_ia32_exc_label_id(node, ++exc_label_id);
+	assert(get_ia32_exc_label(node));
+	exc_label_ids[get_irn_idx(node)] = ++exc_label_id;
 	/* print it */
 	ia32_emit_exc_label(node);
 	be_emit_char(':');
@@ -1448,6 +1460,7 @@ static unsigned emit_jit_entity_relocation_asm(char *const buffer,
 void ia32_emit_function(ir_graph *const irg)
 {
 	exc_entry *exc_list = NEW_ARR_F(exc_entry, 0);
+	exc_label_ids = XMALLOCNZ(ir_label_t, get_irg_last_idx(irg));
 	be_gas_elf_type_char = '@';
 
 	ir_entity *const entity = get_irg_entity(irg);
@@ -1497,6 +1510,8 @@ void ia32_emit_function(ir_graph *const irg)
 		be_emit_char('\n');
 	}
 	DEL_ARR_F(exc_list);
+	free(exc_label_ids);
+	exc_label_ids = NULL;
 }
 
 void ia32_emit_thunks(void)
@@ -1515,12 +1530,17 @@ void ia32_emit_thunks(void)
 	}
 }
 
-void ia32_init_emitter(void)
+static void register_emitter_options(void)
 {
 	lc_opt_entry_t *be_grp   = lc_opt_get_grp(firm_opt_get_root(), "be");
 	lc_opt_entry_t *ia32_grp = lc_opt_get_grp(be_grp, "ia32");
 
 	lc_opt_add_table(ia32_grp, ia32_emitter_options);
+}
+
+void ia32_init_emitter(void)
+{
+	be_register_module_options(register_emitter_options);
 
 	FIRM_DBG_REGISTER(dbg, "firm.be.ia32.emitter");
 }
@@ -1454,3 +1454,18 @@ void ia32_emit_jit_function(char *buffer, ir_jit_function_t *const function)
 	};
 	be_jit_emit_memory(buffer, function, &jit_emit_interface);
 }
+
+void ia32_emit_nops(char *const buffer, unsigned const size)
+{
+	enc_nop_callback(buffer, size);
+}
+
+uint32_t ia32_get_elf_reloc_type(uint8_t const be_kind)
+{
+	switch (be_kind) {
+	case X86_IMM_ADDR:   return 1; /* R_386_32 */
+	case X86_IMM_PCREL:  return 2; /* R_386_PC32 */
+	case X86_IMM_GOTOFF: return 9; /* R_386_GOTOFF */
+	}
+	panic("unsupported relocation kind %u for ELF output", be_kind);
+}
@@ -23,6 +23,10 @@ ir_jit_function_t *ia32_emit_jit(ir_jit_segment_t *segment, ir_graph *irg);
 
 void ia32_emit_jit_function(char *buffer, ir_jit_function_t *function);
 
+void ia32_emit_nops(char *buffer, unsigned size);
+
+uint32_t ia32_get_elf_reloc_type(uint8_t be_kind);
+
 void ia32_enc_simple(uint8_t opcode);
 
 void ia32_enc_binop(ir_node const *node, unsigned code);
@@ -15,6 +15,8 @@
  */
 #include "array.h"
 #include "bearch.h"
+#include "beirg.h"
+#include "belive.h"
 #include "benode.h"
 #include "besched.h"
 #include "bessaconstr.h"
@@ -203,10 +205,19 @@ static void rewire_fpu_mode_nodes(ir_graph *irg)
 		ir_node *phi = phis[i];
 		arch_set_irn_register(phi, reg);
 	}
+
+	/* update liveness instead of invalidating it, so the following state
+	 * assignment does not have to recompute it for the whole graph */
+	be_lv_t *const lv = be_get_irg_liveness(irg);
+	if (lv->sets_valid) {
+		be_liveness_update(lv, initial_value);
+		for (size_t i = 0, len = ARR_LEN(env.state_nodes); i < len; ++i) {
+			be_liveness_update(lv, env.state_nodes[i]);
+		}
+		be_ssa_construction_update_liveness_phis(&senv, lv);
+	}
 	be_ssa_construction_destroy(&senv);
 	DEL_ARR_F(env.state_nodes);
-
-	be_invalidate_live_sets(irg);
 }
 
 void ia32_setup_fpu_mode(ir_graph *irg)
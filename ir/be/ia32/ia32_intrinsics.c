@@ -14,6 +14,7 @@
 #include "constbits.h"
 #include "gen_ia32_regalloc_if.h"
 #include "ia32_bearch_t.h"
+#include "ident_t.h"
 #include "ia32_new_nodes.h"
 #include "ircons_t.h"
 #include "iredges_t.h"
@@ -484,10 +485,10 @@ static void ia32_lower_ASM(ir_node *const asmn)
 	ir_asm_constraint *const hi = &new_constraints[n_constraints];
 	hi->in_pos     = -1;
 	hi->out_pos    = lo->out_pos + 1;
-	hi->constraint = new_id_from_str("=d");
+	hi->constraint = id_constraint_edx;
 	hi->mode       = get_high_mode(lo->mode);
 
-	lo->constraint = new_id_from_str("=a");
+	lo->constraint = id_constraint_eax;
 	lo->mode       = lo_mode;
 
 	ir_cons_flags flags = cons_none;
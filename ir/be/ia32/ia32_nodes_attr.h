@@ -105,8 +105,6 @@ struct ia32_attr_t {
 	unsigned sign_extend:1;
 	unsigned use_8bit_high:1;
 
-	ir_label_t        exc_label;       /**< the exception label iff this instruction can throw an exception */
-
 	x86_addr_t        addr; /**< address mode specification */
 
 #ifndef NDEBUG
@@ -949,7 +949,7 @@ static void peephole_ia32_Lea(ir_node *node)
 	if (!be_peephole_get_value(REG_EFLAGS)) {
 		ir_node *res;
 		if (is_disp_const(node, 0)) {
-			if (!breg && ireg == oreg) {
+			if (!breg && ireg == oreg && ia32_cg_config.use_shl_for_lea) {
 				/* lea (, %i, 1 << s), %i -> shl $s, %i */
 				dbg_info *const dbgi  = get_irn_dbg_info(node);
 				ir_node  *const block = get_nodes_block(node);
@@ -78,8 +78,24 @@ static ir_entity *get_nonlazyptr(be_main_env_t *env, ir_entity *entity)
 	return result;
 }
 
-static ir_node *get_eip_relative(dbg_info *const dbgi, ir_graph *const irg, x86_immediate_kind_t const kind, ir_entity *const entity)
+/**
+ * Per-function caches for the PIC address chains.  Repeated uses of the same
+ * entity would otherwise each construct a fresh EIP-relative add and GOT
+ * slot load; sharing them keeps one address computation per referenced
+ * symbol.  All chains live in the start block, so the shared nodes dominate
+ * every use (and in particular sit outside of all loops).
+ */
+typedef struct pic_cache_t {
+	pmap *eip_relative; /**< entity -> EIP-relative address node */
+	pmap *table_load;   /**< entity -> result of the GOT slot load */
+} pic_cache_t;
+
+static ir_node *get_eip_relative(pic_cache_t *const cache, dbg_info *const dbgi, ir_graph *const irg, x86_immediate_kind_t const kind, ir_entity *const entity)
 {
+	ir_node *cached = pmap_get(ir_node, cache->eip_relative, entity);
+	if (cached != NULL)
+		return cached;
+
 	/* Everything else is accessed relative to EIP. */
 	ir_node *const pic_base = ia32_get_pic_base(irg);
 	/* cheat a bit and set pic_base node to mode_P for now */
@@ -91,23 +107,30 @@ static ir_node *get_eip_relative(dbg_info *const dbgi, ir_graph *const irg, x86_
 	ir_node *const add         = new_rd_Add(dbgi, block, pic_base, reloc);
 	/* Make sure the walker doesn't visit this add again. */
 	mark_irn_visited(add);
+	pmap_insert(cache->eip_relative, entity, add);
 	return add;
 }
 
-static ir_node *get_table_load(dbg_info *const dbgi, ir_graph *const irg, x86_immediate_kind_t const kind, ir_entity *const entity)
+static ir_node *get_table_load(pic_cache_t *const cache, dbg_info *const dbgi, ir_graph *const irg, x86_immediate_kind_t const kind, ir_entity *const entity)
 {
-	ir_node *const addr  = get_eip_relative(dbgi, irg, kind, entity);
+	ir_node *cached = pmap_get(ir_node, cache->table_load, entity);
+	if (cached != NULL)
+		return cached;
+
+	ir_node *const addr  = get_eip_relative(cache, dbgi, irg, kind, entity);
 	ir_type *const type  = get_entity_type(entity);
 	ir_node *const nomem = get_irg_no_mem(irg);
 	ir_node *const block = get_irg_start_block(irg);
 	ir_node *const load  = new_rd_Load(dbgi, block, nomem, addr, mode_P, type,
 	                                   cons_floats);
-	return new_r_Proj(load, mode_P, pn_Load_res);
+	ir_node *const res   = new_r_Proj(load, mode_P, pn_Load_res);
+	pmap_insert(cache->table_load, entity, res);
+	return res;
 }
 
 static void fix_address_elf(ir_node *const node, void *const data)
 {
-	(void)data;
+	pic_cache_t *const cache = (pic_cache_t*)data;
 	foreach_irn_in(node, i, pred) {
 		if (!is_Address(pred))
 			continue;
@@ -129,7 +152,7 @@ static void fix_address_elf(ir_node *const node, void *const data)
 				res = be_new_Relocation(dbgi, irg, X86_IMM_PLT, entity, mode_P);
 			} else {
 				assert(ir_platform.pic_style == BE_PIC_ELF_NO_PLT);
-				res = get_table_load(dbgi, irg, X86_IMM_GOT, entity);
+				res = get_table_load(cache, dbgi, irg, X86_IMM_GOT, entity);
 			}
 		} else {
 			ir_visibility const visibility = get_entity_visibility(entity);
@@ -137,9 +160,9 @@ static void fix_address_elf(ir_node *const node, void *const data)
 			 && visibility != ir_visibility_external_private) {
 				assert(visibility == ir_visibility_local
 				    || visibility == ir_visibility_private);
-				res = get_eip_relative(dbgi, irg, X86_IMM_GOTOFF, entity);
+				res = get_eip_relative(cache, dbgi, irg, X86_IMM_GOTOFF, entity);
 			} else {
-				res = get_table_load(dbgi, irg, X86_IMM_GOT, entity);
+				res = get_table_load(cache, dbgi, irg, X86_IMM_GOT, entity);
 			}
 		}
 		set_irn_n(node, i, res);
@@ -149,7 +172,7 @@ static void fix_address_elf(ir_node *const node, void *const data)
 /** patches Addresses to work in position independent code */
 static void fix_address_macho(ir_node *const node, void *const data)
 {
-	(void)data;
+	pic_cache_t *const cache = (pic_cache_t*)data;
 
 	foreach_irn_in(node, i, pred) {
 		if (!is_Address(pred))
@@ -175,10 +198,10 @@ static void fix_address_macho(ir_node *const node, void *const data)
 			/* Everything else is accessed relative to EIP. */
 			if (entity_has_definition(entity)
 			 && !(get_entity_linkage(entity) & IR_LINKAGE_MERGE)) {
-				res = get_eip_relative(dbgi, irg, X86_IMM_PICBASE_REL, entity);
+				res = get_eip_relative(cache, dbgi, irg, X86_IMM_PICBASE_REL, entity);
 			} else {
 				ir_entity *const nonlazyptr = get_nonlazyptr(be, entity);
-				res = get_table_load(dbgi, irg, X86_IMM_PICBASE_REL, nonlazyptr);
+				res = get_table_load(cache, dbgi, irg, X86_IMM_PICBASE_REL, nonlazyptr);
 			}
 		}
 		set_irn_n(node, i, res);
@@ -187,15 +210,25 @@ static void fix_address_macho(ir_node *const node, void *const data)
 
 void ia32_adjust_pic(ir_graph *irg)
 {
+	if (ir_platform.pic_style == BE_PIC_NONE)
+		return;
+
+	pic_cache_t cache;
+	cache.eip_relative = pmap_create();
+	cache.table_load   = pmap_create();
+
 	switch (ir_platform.pic_style) {
 	case BE_PIC_NONE:
-		return;
+		break;
 	case BE_PIC_ELF_PLT:
 	case BE_PIC_ELF_NO_PLT:
-		irg_walk_graph(irg, fix_address_elf, NULL, NULL);
-		return;
+		irg_walk_graph(irg, fix_address_elf, NULL, &cache);
+		break;
 	case BE_PIC_MACH_O:
-		irg_walk_graph(irg, fix_address_macho, NULL, NULL);
-		return;
+		irg_walk_graph(irg, fix_address_macho, NULL, &cache);
+		break;
 	}
+
+	pmap_destroy(cache.table_load);
+	pmap_destroy(cache.eip_relative);
 }
@@ -1810,8 +1810,8 @@ static ir_node *gen_Shl(ir_node *node)
 	ir_node *right = get_Shl_right(node);
 
 	/* special case Shl x,1 => Lea x,x because Lea has fewer register
-	 * constraints */
-	if (is_irn_one(right)) {
+	 * constraints (if a lea is not slower than a shift here) */
+	if (is_irn_one(right) && ia32_cg_config.use_lea_for_shl) {
 		dbg_info *dbgi      = get_irn_dbg_info(node);
 		ir_node  *new_block = be_transform_nodes_block(node);
 		ir_node  *new_left  = be_transform_node(left);
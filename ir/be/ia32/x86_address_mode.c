@@ -22,11 +22,20 @@
 #include "iredges_t.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
+#include "irnodehashmap.h"
 #include "irprintf.h"
+#include "obst.h"
 #include <inttypes.h>
 
 static bitset_t *non_address_mode_nodes;
 
+/** Match results for the default flags, memoized per root node. Shared
+ * address subtrees are matched once instead of being re-walked for every
+ * load/store/lea candidate. */
+static ir_nodehashmap_t am_cache;
+static struct obstack   am_cache_obst;
+static bool             am_cache_valid;
+
 static bool tarval_possible(ir_tarval *tv)
 {
 	ir_mode *mode = get_tarval_mode(tv);
@@ -233,8 +242,8 @@ static void add_addr_operand(x86_address_t *const addr, ir_node *const op)
 	}
 }
 
-void x86_create_address_mode(x86_address_t *addr, ir_node *node,
-                             x86_create_am_flags_t flags)
+static void create_address_mode(x86_address_t *addr, ir_node *node,
+                                x86_create_am_flags_t flags)
 {
 	memset(addr, 0, sizeof(*addr));
 
@@ -346,6 +355,31 @@ tryit:
 	addr->base    = node;
 }
 
+void x86_create_address_mode(x86_address_t *addr, ir_node *node,
+                             x86_create_am_flags_t flags)
+{
+	/* Only matches with the default flags are memoized: with the force or
+	 * double use flags the result additionally depends on the caller and on
+	 * the use count of the root node. */
+	bool const cacheable = flags == x86_create_am_normal && am_cache_valid;
+	if (cacheable) {
+		x86_address_t const *const cached
+			= ir_nodehashmap_get(x86_address_t, &am_cache, node);
+		if (cached != NULL) {
+			*addr = *cached;
+			return;
+		}
+	}
+
+	create_address_mode(addr, node, flags);
+
+	if (cacheable) {
+		x86_address_t *const copy = OALLOC(&am_cache_obst, x86_address_t);
+		*copy = *addr;
+		ir_nodehashmap_insert(&am_cache, node, copy);
+	}
+}
+
 void x86_mark_non_am(ir_node *node)
 {
 	bitset_set(non_address_mode_nodes, get_irn_idx(node));
@@ -460,10 +494,19 @@ void x86_calculate_non_address_mode_nodes(ir_graph *irg)
 	non_address_mode_nodes = bitset_malloc(get_irg_last_idx(irg));
 
 	irg_walk_graph(irg, NULL, mark_non_address_nodes, lv);
+
+	/* The match results only depend on the graph and the bitset computed
+	 * above, so they stay valid until the non address mode info is freed. */
+	ir_nodehashmap_init(&am_cache);
+	obstack_init(&am_cache_obst);
+	am_cache_valid = true;
 }
 
 void x86_free_non_address_mode_nodes(void)
 {
+	am_cache_valid = false;
+	obstack_free(&am_cache_obst, NULL);
+	ir_nodehashmap_destroy(&am_cache);
 	free(non_address_mode_nodes);
 }
 
@@ -70,6 +70,7 @@ static void mips_init(void)
 		= "the MIPS backend is highly experimental and unfinished";
 	ir_target.allow_ifconv       = mips_ifconv;
 	ir_target.float_int_overflow = ir_overflow_indefinite;
+	ir_target.copyb_loop_max_size = 256;
 }
 
 static void mips_finish(void)
@@ -276,7 +277,9 @@ static void mips_lower_for_target(void)
 	be_after_irp_transform("lower-calls");
 
 	foreach_irp_irg(i, irg) {
-		lower_CopyB(irg, 16, 17, false);
+		lower_CopyB(irg, ir_target.copyb_max_small_size,
+		            ir_target.copyb_min_large_size,
+		            ir_target.fast_unaligned_memaccess);
 		be_after_transform(irg, "lower-copyb");
 	}
 
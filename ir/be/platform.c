@@ -7,6 +7,7 @@
 #include "be_t.h"
 #include "bearch.h"
 #include "bediagnostic.h"
+#include "bemodule.h"
 #include "ident_t.h"
 #include "irtools.h"
 #include "lc_opts.h"
@@ -275,7 +276,13 @@ BSD:
 
 	option_pic       = ir_platform.pic_is_default;
 	option_pic_noplt = false;
-	init_lc_opts();
+
+	/* register once; built lazily together with the backend options */
+	static bool registered = false;
+	if (!registered) {
+		registered = true;
+		be_register_module_options(init_lc_opts);
+	}
 }
 
 void ir_platform_init(void)
@@ -468,13 +475,33 @@ ir_mode *ir_platform_type_mode(ir_platform_type_t type, int is_signed)
 
 void ir_platform_finish(void)
 {
+	/* the define suffix of a cached configuration is owned by the target
+	 * cache and freed together with it */
 	for (ir_platform_define_t *next, *define = ir_platform.defines;
-	     define != NULL; define = next) {
+	     define != ir_platform.shared_defines; define = next) {
 	    next = define->next;
 	    free(define);
 	}
 }
 
+void ir_platform_restore(platform_t const *const cached)
+{
+	ir_platform = *cached;
+	/* same option defaults as at the end of ir_platform_set(); the option
+	 * table is already registered */
+	option_pic       = ir_platform.pic_is_default;
+	option_pic_noplt = false;
+}
+
+void ir_platform_free_defines(ir_platform_define_t *defines)
+{
+	for (ir_platform_define_t *next, *define = defines;
+	     define != NULL; define = next) {
+		next = define->next;
+		free(define);
+	}
+}
+
 void ir_platform_set_va_list_type_pointer(void)
 {
 	ir_platform.va_list_type = new_type_pointer(get_type_for_mode(mode_ANY));
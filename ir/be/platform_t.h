@@ -26,6 +26,9 @@ typedef enum be_pic_style_t {
 
 typedef struct platform_t {
 	ir_platform_define_t *defines;
+	/** Suffix of @p defines owned by the target configuration cache;
+	 * ir_platform_finish() stops freeing when it reaches this node. */
+	ir_platform_define_t *shared_defines;
 	char const           *default_exe_name;
 	ir_type               *va_list_type;
 	char                  user_label_prefix;
@@ -63,6 +66,13 @@ void ir_platform_init(void);
 
 void ir_platform_finish(void);
 
+/** Swaps in a cached platform configuration built by an earlier
+ * ir_platform_set() with the same triple. */
+void ir_platform_restore(platform_t const *cached);
+
+/** Frees a complete define list, including any cache-owned suffix. */
+void ir_platform_free_defines(ir_platform_define_t *defines);
+
 void ir_platform_set_va_list_type_pointer(void);
 
 #endif
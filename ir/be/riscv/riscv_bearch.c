@@ -7,6 +7,7 @@
 
 #include "be2addr.h"
 #include "be_t.h"
+#include "beemitter.h"
 #include "beirg.h"
 #include "bemodule.h"
 #include "benode.h"
@@ -57,12 +58,17 @@ static lc_opt_enum_int_var_t abi_var = {
 typedef enum {
 	rv32imafd,
 	rv32ima,
+	rv32imafdc,
+	rv32imac,
 } riscv_isa_t;
 static const lc_opt_enum_int_items_t isa_items[] = {
-		{ "rv32g",     rv32imafd },
-		{ "rv32imafd", rv32imafd },
-		{ "rv32ima",   rv32ima   },
-		{ NULL,        0         },
+		{ "rv32g",      rv32imafd  },
+		{ "rv32imafd",  rv32imafd  },
+		{ "rv32ima",    rv32ima    },
+		{ "rv32gc",     rv32imafdc },
+		{ "rv32imafdc", rv32imafdc },
+		{ "rv32imac",   rv32imac   },
+		{ NULL,         0          },
 };
 
 static int isa;
@@ -77,6 +83,7 @@ static const lc_opt_table_entry_t riscv_options[] = {
 };
 
 static bool use_softfloat;
+static bool use_rvc;
 
 static ir_settings_arch_dep_t const riscv_arch_dep = {
 	.replace_muls         = true,
@@ -130,9 +137,11 @@ static void riscv_init(void)
 
 	ir_target.allow_ifconv       = riscv_ifconv;
 	ir_target.float_int_overflow = ir_overflow_min_max;
+	ir_target.copyb_loop_max_size = 256;
 	ir_platform_set_va_list_type_pointer();
 
-	use_softfloat = ((riscv_isa_t)isa == rv32ima);
+	use_softfloat = ((riscv_isa_t)isa == rv32ima || (riscv_isa_t)isa == rv32imac);
+	use_rvc       = ((riscv_isa_t)isa == rv32imac || (riscv_isa_t)isa == rv32imafdc);
 	if (use_softfloat && (riscv_abi_t)abi == ilp32d) {
 		panic("requested ABI requires -march to subsume the 'D' extension");
 	} else if (!use_softfloat && (riscv_abi_t)abi == ilp32) {
@@ -185,7 +194,22 @@ static ir_node *riscv_new_reload(ir_node *const value, ir_node *const spill, ir_
 	TODO(value);
 }
 
-static regalloc_if_t const riscv_regalloc_if = {
+/* The RVC compressed instruction formats can only address x8-x15; biasing
+ * allocation towards these registers lets the assembler choose the short
+ * encodings more often. The value is small enough not to override any real
+ * preference. */
+static float const riscv_register_prefs[N_RISCV_REGISTERS] = {
+	[REG_FP] = 0.01f,
+	[REG_S1] = 0.01f,
+	[REG_A0] = 0.01f,
+	[REG_A1] = 0.01f,
+	[REG_A2] = 0.01f,
+	[REG_A3] = 0.01f,
+	[REG_A4] = 0.01f,
+	[REG_A5] = 0.01f,
+};
+
+static regalloc_if_t riscv_regalloc_if = {
 	.spill_cost  = 7,
 	.reload_cost = 5,
 	.new_spill   = riscv_new_spill,
@@ -412,6 +436,14 @@ static void riscv_generate_code(FILE *const output, char const *const cup_name)
 {
 	be_begin(output, cup_name);
 
+	if (use_rvc) {
+		/* the assembler selects the compressed 16 bit encodings itself once
+		 * the C extension is enabled */
+		be_emit_cstring("\t.option rvc\n");
+		be_emit_write_line();
+		riscv_regalloc_if.register_prefs = riscv_register_prefs;
+	}
+
 	unsigned *const sp_is_non_ssa = rbitset_alloca(N_RISCV_REGISTERS);
 	rbitset_set(sp_is_non_ssa, REG_SP);
 
@@ -528,7 +560,9 @@ static void riscv_lower_for_target(void)
 	be_after_irp_transform("lower-calls");
 
 	foreach_irp_irg(i, irg) {
-		lower_CopyB(irg, 16, 17, false);
+		lower_CopyB(irg, ir_target.copyb_max_small_size,
+		            ir_target.copyb_min_large_size,
+		            ir_target.fast_unaligned_memaccess);
 		be_after_transform(irg, "lower-copyb");
 	}
 
@@ -585,10 +619,15 @@ arch_isa_if_t const riscv32_isa_if = {
 	.get_op_estimated_cost = riscv_get_op_estimated_cost,
 };
 
-BE_REGISTER_MODULE_CONSTRUCTOR(be_init_arch_riscv32)
-void be_init_arch_riscv32(void)
+static void register_riscv_options(void)
 {
 	lc_opt_entry_t *be_grp = lc_opt_get_grp(firm_opt_get_root(), "be");
 	lc_opt_entry_t *riscv_grp = lc_opt_get_grp(be_grp, "riscv32");
 	lc_opt_add_table(riscv_grp, riscv_options);
 }
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_arch_riscv32)
+void be_init_arch_riscv32(void)
+{
+	be_register_module_options(register_riscv_options);
+}
@@ -376,6 +376,9 @@ static void sparc_init(void)
 		= new_float_mode("Q", irma_ieee754, 15, 112, ir_overflow_min_max);
 
 	ir_target.float_int_overflow = ir_overflow_min_max;
+	ir_target.copyb_max_small_size = 31;
+	ir_target.copyb_min_large_size = 32;
+	ir_target.copyb_loop_max_size  = 256;
 	ir_platform_set_va_list_type_pointer();
 }
 
@@ -503,7 +506,9 @@ static void sparc_lower_for_target(void)
 	foreach_irp_irg(i, irg) {
 		/* Turn all small CopyBs into loads/stores and all bigger CopyBs into
 		 * memcpy calls. */
-		lower_CopyB(irg, 31, 32, false);
+		lower_CopyB(irg, ir_target.copyb_max_small_size,
+		            ir_target.copyb_min_large_size,
+		            ir_target.fast_unaligned_memaccess);
 		be_after_transform(irg, "lower-copyb");
 	}
 
@@ -566,13 +571,18 @@ arch_isa_if_t const sparc_isa_if = {
 	.get_op_estimated_cost = sparc_get_op_estimated_cost,
 };
 
-BE_REGISTER_MODULE_CONSTRUCTOR(be_init_arch_sparc)
-void be_init_arch_sparc(void)
+static void register_sparc_options(void)
 {
 	lc_opt_entry_t *be_grp = lc_opt_get_grp(firm_opt_get_root(), "be");
 	lc_opt_entry_t *sparc_grp = lc_opt_get_grp(be_grp, "sparc");
 
 	lc_opt_add_table(sparc_grp, sparc_options);
+}
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_arch_sparc)
+void be_init_arch_sparc(void)
+{
+	be_register_module_options(register_sparc_options);
 
 	sparc_init_transform();
 	sparc_init_emitter();
@@ -404,6 +404,19 @@ static void optimize_fallthrough(ir_node *node)
 	}
 }
 
+static int cmp_block_execfreqs(const void *d1, const void *d2)
+{
+	ir_node **p1 = (ir_node**)d1;
+	ir_node **p2 = (ir_node**)d2;
+	double freq1 = get_block_execfreq(*p1);
+	double freq2 = get_block_execfreq(*p2);
+	if (freq1 < freq2)
+		return -1;
+	if (freq1 > freq2)
+		return 1;
+	return get_irn_node_nr(*p2)-get_irn_node_nr(*p1);
+}
+
 /**
  * search for an instruction that can fill the delay slot of @p node
  */
@@ -445,11 +458,25 @@ static ir_node *pick_delay_slot_for(ir_node *node)
 		return schedpoint;
 	}
 
-	/* look in successor blocks */
-	ir_node *block = get_nodes_block(node);
-	/* TODO: sort succs by execution frequency */
+	/* look in successor blocks, try the most frequently executed ones first */
+	ir_node  *block   = get_nodes_block(node);
+	unsigned  n_succs = 0;
+	foreach_block_succ(block, edge) {
+		(void)edge;
+		++n_succs;
+	}
+	ir_node **succs = ALLOCAN(ir_node*, n_succs);
+	n_succs = 0;
 	foreach_block_succ(block, edge) {
-		ir_node *succ = get_edge_src_irn(edge);
+		succs[n_succs++] = get_edge_src_irn(edge);
+	}
+	QSORT(succs, n_succs, cmp_block_execfreqs);
+	/* the delay slot of an unconditional branch is executed exactly when its
+	 * target is, so even pinned instructions and memory operations may be
+	 * hoisted into it */
+	bool const single_path = is_sparc_Ba(node);
+	for (unsigned s = n_succs; s-- > 0; ) {
+		ir_node *succ = succs[s];
 		/* we can't easily move up stuff from blocks with multiple predecessors
 		 * since the instruction is lacking for the other preds then.
 		 * (We also don't have to do any phi translation) */
@@ -468,7 +495,9 @@ static ir_node *pick_delay_slot_for(ir_node *node)
 				break;
 			if (!is_legal_delay_slot_filler(schedpoint))
 				continue;
-			if (!get_irn_pinned(schedpoint) && !is_memop(schedpoint) && can_move_up_into_delayslot(schedpoint, node)) {
+			if ((single_path
+			     || (!get_irn_pinned(schedpoint) && !is_memop(schedpoint)))
+			    && can_move_up_into_delayslot(schedpoint, node)) {
 				/* it's fine to move the insn across blocks */
 				return schedpoint;
 			} else if (is_sparc_cond_branch(node)) {
@@ -1264,19 +1293,6 @@ static void sparc_emit_func_epilog(ir_graph *irg)
 	be_gas_emit_function_epilog(entity);
 }
 
-static int cmp_block_execfreqs(const void *d1, const void *d2)
-{
-	ir_node **p1 = (ir_node**)d1;
-	ir_node **p2 = (ir_node**)d2;
-	double freq1 = get_block_execfreq(*p1);
-	double freq2 = get_block_execfreq(*p2);
-	if (freq1 < freq2)
-		return -1;
-	if (freq1 > freq2)
-		return 1;
-	return get_irn_node_nr(*p2)-get_irn_node_nr(*p1);
-}
-
 static void pick_delay_slots(size_t n_blocks, ir_node **blocks)
 {
 	/* create blocklist sorted by execution frequency */
@@ -5,23 +5,78 @@
 #include "target_t.h"
 
 #include "be_t.h"
+#include "bemodule.h"
+#include "ident_t.h"
 #include "iropt_t.h"
 #include "irtools.h"
 #include "isas.h"
 #include "lc_opts.h"
 #include "platform_t.h"
+#include "pmap.h"
 #include "util.h"
+#include "xmalloc.h"
 
 target_info_t ir_target;
 
+/** An immutable target configuration, built once per triple and swapped
+ * in on reselection. */
+typedef struct cached_target_t {
+	target_info_t target;   /**< ir_target right after configuration */
+	platform_t    platform; /**< ir_platform right after configuration */
+	char const   *arch;     /**< argument for be_set_arch(), if any */
+} cached_target_t;
+
+/** Maps triple idents to their finished configurations. */
+static pmap *target_cache;
+
 int ir_target_set_triple(ir_machine_triple_t const *machine)
 {
-	memset(&ir_target, 0, sizeof(ir_target));
-	ir_target.allow_ifconv = ir_is_optimizable_mux;
+	/* ir_init_library defers backend setup until a target is selected */
+	firm_be_init();
 
 	const char *const cpu          = ir_triple_get_cpu_type(machine);
 	const char *const manufacturer = ir_triple_get_manufacturer(machine);
-	char          const *arch      = NULL;
+
+	/* Target configurations are immutable once built, so reselecting a
+	 * triple (think of a compile server switching targets per request)
+	 * just swaps the cached structs back in. */
+	if (target_cache == NULL)
+		target_cache = pmap_create();
+	ident *const key = new_id_fmt("%s-%s-%s", cpu, manufacturer,
+	                              ir_triple_get_operating_system(machine));
+	cached_target_t *cached = pmap_get(cached_target_t, target_cache, key);
+	if (cached != NULL) {
+		if (ir_target.isa_initialized)
+			be_finish_isa();
+		if (ir_target.isa != NULL)
+			ir_platform_finish();
+		ir_target = cached->target;
+		if (cached->arch != NULL && !be_set_arch(cached->arch))
+			panic("Could not set backend arch");
+		ir_platform_restore(&cached->platform);
+		return true;
+	}
+
+	/* Support switching to another target within one process (think of a
+	 * compile server): tear down the state of a previously initialized
+	 * target first. Graphs and types built for the old target stay behind
+	 * and must not be used with the new one. */
+	if (ir_target.isa_initialized)
+		be_finish_isa();
+	if (ir_target.isa != NULL)
+		ir_platform_finish();
+
+	memset(&ir_target, 0, sizeof(ir_target));
+	ir_target.allow_ifconv              = ir_is_optimizable_mux;
+	ir_target.branch_mispredict_penalty = 10;
+	/* without a swap instruction a register exchange takes three ops */
+	ir_target.register_swap_cost        = 3;
+	/* conservative CopyB expansion defaults, backends override these */
+	ir_target.copyb_max_small_size      = 16;
+	ir_target.copyb_min_large_size      = 17;
+	ir_target.copyb_loop_max_size       = 0;
+
+	char const *arch = NULL;
 	arch_isa_if_t const *isa;
 	if (ir_is_cpu_x86_32(cpu)) {
 		isa  = &ia32_isa_if;
@@ -54,6 +109,15 @@ int ir_target_set_triple(ir_machine_triple_t const *machine)
 
 	ir_platform_set(machine, isa->pointer_size);
 
+	/* remember the finished configuration; its define list is shared with
+	 * the live platform state from now on */
+	ir_platform.shared_defines = ir_platform.defines;
+	cached           = XMALLOCZ(cached_target_t);
+	cached->target   = ir_target;
+	cached->platform = ir_platform;
+	cached->arch     = arch != NULL ? xstrdup(arch) : NULL;
+	pmap_insert(target_cache, key, cached);
+
 	return true;
 }
 
@@ -99,12 +163,25 @@ void ir_init(void)
 void finish_target(void)
 {
 	ir_platform_finish();
+	if (target_cache != NULL) {
+		foreach_pmap(target_cache, entry) {
+			cached_target_t *cached = (cached_target_t*)entry->value;
+			ir_platform_free_defines(cached->platform.defines);
+			free((char*)cached->arch);
+			free(cached);
+		}
+		pmap_destroy(target_cache);
+		target_cache = NULL;
+	}
 }
 
 int ir_target_option(const char *arg)
 {
 	assert(ir_target.isa != NULL && "Did not call ir_target_set yet");
 
+	/* the option tree is built lazily on the first access */
+	be_init_module_options();
+
 	lc_opt_entry_t *be_grp = lc_opt_get_grp(firm_opt_get_root(), "be");
 	if (streq(arg, "help") || streq(arg, "?")) {
 		lc_opt_print_help_for_entry(be_grp, '-', stdout);
@@ -20,7 +20,28 @@ typedef struct target_info_t {
 	arch_isa_if_t   const *isa;
 	char const            *experimental;
 	arch_allow_ifconv_func allow_ifconv;
+	/** Estimated cycle cost of a Mux with values of mode @p mode, consulted
+	 * by if-conversion. May be NULL, then a generic estimate is used. */
+	unsigned             (*mux_cost)(ir_mode const *mode);
+	/** Estimated cycle penalty of a mispredicted branch. If-conversion weighs
+	 * the cost of the created Muxes against it. */
+	unsigned               branch_mispredict_penalty;
+	/** Estimated cost of exchanging two registers relative to a single
+	 * register copy. Perm lowering weighs swap against copy decomposition
+	 * per cycle with it. */
+	unsigned               register_swap_cost;
 	ir_mode               *mode_float_arithmetic;
+	/** If set, block copies are expanded in chunks of this (vector) mode
+	 * instead of the native word size. */
+	ir_mode               *mode_vector_copy;
+	/** CopyB lowering thresholds, see lower_CopyB(): copies of at most
+	 * copyb_max_small_size bytes are fully unrolled into loads/stores,
+	 * copies of at least copyb_min_large_size bytes become memcpy calls.
+	 * Large copies of at most copyb_loop_max_size bytes are expanded into
+	 * an inline copy loop instead; 0 disables loop expansion. */
+	unsigned               copyb_max_small_size;
+	unsigned               copyb_min_large_size;
+	unsigned               copyb_loop_max_size;
 	bool isa_initialized          : 1;
 	bool fast_unaligned_memaccess : 1;
 	ENUMBF(float_int_conversion_overflow_style_t) float_int_overflow : 2;
@@ -15,7 +15,9 @@
 #endif
 
 #include "be_t.h"
+#include "dbginfo_t.h"
 #include "debugger.h"
+#include "deq.h"
 #include "entity_t.h"
 #include "execfreq_t.h"
 #include "firm.h"
@@ -28,9 +30,11 @@
 #include "irmemory_t.h"
 #include "irmode_t.h"
 #include "irnode_t.h"
+#include "iropt_t.h"
 #include "irprog_t.h"
 #include "irtools.h"
 #include "lc_opts.h"
+#include "obstack_pool.h"
 #include "opt_init.h"
 #include "target_t.h"
 #include "tv_t.h"
@@ -76,7 +80,9 @@ void ir_init_library(void)
 	firm_init_loop_opt();
 
 	init_execfreq();
-	firm_be_init();
+	/* The backend (module registration and option tables) is initialized
+	 * lazily on the first ir_target_set(); a library user who never
+	 * selects a target does not pay for it. */
 
 #ifdef DEBUG_libfirm
 	firm_init_debugger();
@@ -92,10 +98,14 @@ void ir_finish(void)
 	firm_be_finish();
 
 	free_ir_prog();
+	firm_finish_localopt();
 	firm_finish_op();
 	finish_tarval();
 	finish_mode();
+	finish_dbginfo();
 	finish_ident();
+	deq_pool_finish();
+	firm_obstack_pool_finish();
 	finish_target();
 	initialized = false;
 }
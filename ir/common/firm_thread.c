@@ -0,0 +1,135 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Minimal threading support for parallel graph processing.
+ */
+#include "firm_thread.h"
+
+#ifndef _WIN32
+
+#include <pthread.h>
+#include <unistd.h>
+
+static pthread_mutex_t intern_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t alloc_mutex  = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t shard_mutexes[FIRM_INTERN_N_LOCKS];
+static bool            shards_initialized;
+static bool            parallel_active;
+
+bool firm_parallel_is_active(void)
+{
+	return parallel_active;
+}
+
+void firm_parallel_begin(void)
+{
+	/* the driver calls this before any worker runs, so plain
+	 * initialization is fine here */
+	if (!shards_initialized) {
+		for (unsigned i = 0; i < FIRM_INTERN_N_LOCKS; ++i)
+			pthread_mutex_init(&shard_mutexes[i], NULL);
+		shards_initialized = true;
+	}
+	parallel_active = true;
+}
+
+void firm_parallel_end(void)
+{
+	parallel_active = false;
+}
+
+void firm_intern_lock(void)
+{
+	if (parallel_active)
+		pthread_mutex_lock(&intern_mutex);
+}
+
+void firm_intern_unlock(void)
+{
+	if (parallel_active)
+		pthread_mutex_unlock(&intern_mutex);
+}
+
+void firm_alloc_lock(void)
+{
+	if (parallel_active)
+		pthread_mutex_lock(&alloc_mutex);
+}
+
+void firm_alloc_unlock(void)
+{
+	if (parallel_active)
+		pthread_mutex_unlock(&alloc_mutex);
+}
+
+void firm_intern_lock_shard(unsigned shard)
+{
+	if (parallel_active)
+		pthread_mutex_lock(&shard_mutexes[shard % FIRM_INTERN_N_LOCKS]);
+}
+
+void firm_intern_unlock_shard(unsigned shard)
+{
+	if (parallel_active)
+		pthread_mutex_unlock(&shard_mutexes[shard % FIRM_INTERN_N_LOCKS]);
+}
+
+unsigned firm_parallel_default_threads(void)
+{
+	long const n = sysconf(_SC_NPROCESSORS_ONLN);
+	return n > 0 ? (unsigned)n : 1;
+}
+
+#else
+
+/* No parallel driver on this platform, everything runs serially. */
+
+bool firm_parallel_is_active(void)
+{
+	return false;
+}
+
+void firm_parallel_begin(void)
+{
+}
+
+void firm_parallel_end(void)
+{
+}
+
+void firm_intern_lock(void)
+{
+}
+
+void firm_intern_unlock(void)
+{
+}
+
+void firm_alloc_lock(void)
+{
+}
+
+void firm_alloc_unlock(void)
+{
+}
+
+void firm_intern_lock_shard(unsigned shard)
+{
+	(void)shard;
+}
+
+void firm_intern_unlock_shard(unsigned shard)
+{
+	(void)shard;
+}
+
+unsigned firm_parallel_default_threads(void)
+{
+	return 1;
+}
+
+#endif
@@ -0,0 +1,58 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Minimal threading support for parallel graph processing.
+ *
+ * libFirm keeps a few process-global interning tables (idents, tarvals).
+ * When graph-local passes are run concurrently over several ir_graphs these
+ * tables must be protected.  This module provides the single lock used for
+ * that purpose plus a flag telling whether parallel execution is currently
+ * active, so the serial compilation path pays no locking overhead.
+ */
+#ifndef FIRM_COMMON_FIRM_THREAD_H
+#define FIRM_COMMON_FIRM_THREAD_H
+
+#include <stdbool.h>
+
+/** Returns true if a parallel graph driver is currently running. */
+bool firm_parallel_is_active(void);
+
+/** Returns a sensible default worker count for parallel graph drivers,
+ * currently the number of online processors (at least 1). */
+unsigned firm_parallel_default_threads(void);
+
+/** Marks begin/end of a parallel region. Only the driver may call this. */
+void firm_parallel_begin(void);
+void firm_parallel_end(void);
+
+/**
+ * Locks/unlocks the global interning tables (idents, tarvals).
+ * No-ops unless a parallel region is active.
+ */
+void firm_intern_lock(void);
+void firm_intern_unlock(void);
+
+/**
+ * Locks/unlocks the global allocator free lists (recycled obstack chunks,
+ * temporary obstacks, deq blocks).
+ * No-ops unless a parallel region is active.
+ */
+void firm_alloc_lock(void);
+void firm_alloc_unlock(void);
+
+/** Number of independent locks available for sharded interning tables. */
+#define FIRM_INTERN_N_LOCKS 16
+
+/**
+ * Locks/unlocks one shard of a sharded interning table, so lookups for
+ * different shards do not serialize on a single lock.
+ * No-ops unless a parallel region is active.
+ */
+void firm_intern_lock_shard(unsigned shard);
+void firm_intern_unlock_shard(unsigned shard);
+
+#endif
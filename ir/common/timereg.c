@@ -0,0 +1,342 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Hierarchical timing regions with JSON output.
+ */
+#include "timereg.h"
+
+#include "entity_t.h"
+#include "firm_thread.h"
+#include "irgraph_t.h"
+#include "irprog_t.h"
+#include "obst.h"
+#include "panic.h"
+#include "stat_timing.h"
+#include "statev_t.h"
+#include "util.h"
+#include "xmalloc.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * A node of the region tree.  Repeated activations of the same region
+ * below the same parent share one node, so the tree stays bounded no
+ * matter how often a pass runs.
+ */
+typedef struct tr_node_t {
+	const char         *name;     /**< region name (not copied) */
+	const char         *irg_name; /**< entity name of the graph or NULL */
+	unsigned long long  ticks;    /**< accumulated ticks */
+	unsigned long long  enter;    /**< tick count at the last push */
+	unsigned long long  calls;    /**< number of activations */
+	long long           irg_bytes;   /**< retained obstack bytes delta */
+	unsigned long long  enter_bytes; /**< obstack size at the last push */
+	ir_graph           *irg;         /**< graph of the last activation */
+	struct tr_node_t   *parent;
+	struct tr_node_t   *child;    /**< first child */
+	struct tr_node_t   *sibling;  /**< next child of the parent */
+} tr_node_t;
+
+/** Per-thread recording state. The states of all threads are kept in a
+ * list so the driver thread can emit them at a unit boundary. */
+typedef struct tr_thread_t {
+	struct obstack      obst;    /**< holds the nodes of this thread */
+	tr_node_t          *root;    /**< synthetic root of the tree */
+	tr_node_t          *current; /**< innermost active region */
+	struct tr_thread_t *next;
+} tr_thread_t;
+
+bool ir_timereg_enabled;
+
+/** Number of graphs kept in the peak memory snapshot. */
+#define TR_PEAK_TOP_N 8
+
+typedef struct tr_peak_irg_t {
+	char   name[64]; /**< truncated entity name of the graph */
+	size_t bytes;    /**< retained obstack bytes at the peak */
+} tr_peak_irg_t;
+
+/** Sampled obstack bytes of all live graphs.  Samples are taken at
+ * region exits, so the total lags behind allocations made inside the
+ * currently running pass. */
+static size_t        tr_total_bytes;
+/** Largest tr_total_bytes seen so far. */
+static size_t        tr_peak_bytes;
+static tr_peak_irg_t tr_peak_top[TR_PEAK_TOP_N];
+static unsigned      tr_peak_n_top;
+
+static FILE               *tr_file;
+static tr_thread_t        *tr_threads;
+static const char         *tr_unit_name;
+static unsigned long long  tr_unit_start;
+
+#ifdef __GNUC__
+static __thread tr_thread_t *tr_thread;
+#else
+static tr_thread_t *tr_thread;
+#endif
+
+static tr_node_t *tr_new_node(tr_thread_t *thread, const char *name,
+                              const char *irg_name, tr_node_t *parent)
+{
+	tr_node_t *const node = OALLOCZ(&thread->obst, tr_node_t);
+	node->name     = name;
+	node->irg_name = irg_name;
+	node->parent   = parent;
+	if (parent != NULL) {
+		node->sibling = parent->child;
+		parent->child = node;
+	}
+	return node;
+}
+
+static tr_thread_t *tr_get_thread(void)
+{
+	tr_thread_t *thread = tr_thread;
+	if (thread == NULL) {
+		thread = XMALLOCZ(tr_thread_t);
+		obstack_init(&thread->obst);
+		thread->root    = tr_new_node(thread, "", NULL, NULL);
+		thread->current = thread->root;
+		tr_thread = thread;
+
+		firm_intern_lock();
+		thread->next = tr_threads;
+		tr_threads   = thread;
+		firm_intern_unlock();
+	}
+	return thread;
+}
+
+void ir_timereg_push_(const char *name, ir_graph *irg)
+{
+	tr_thread_t *const thread  = tr_get_thread();
+	tr_node_t   *const current = thread->current;
+	const char  *const irg_name
+		= irg != NULL ? get_entity_name(get_irg_entity(irg)) : NULL;
+
+	/* reuse the node of an earlier activation below the same parent */
+	tr_node_t *node = current->child;
+	for (; node != NULL; node = node->sibling) {
+		if (node->name == name && node->irg_name == irg_name)
+			break;
+		if (node->irg_name == irg_name && streq(node->name, name)) {
+			node->name = name;
+			break;
+		}
+	}
+	if (node == NULL)
+		node = tr_new_node(thread, name, irg_name, current);
+
+	node->calls += 1;
+	node->enter  = timing_ticks();
+	node->irg    = irg;
+	node->enter_bytes
+		= irg != NULL ? obstack_memory_used(get_irg_obstack(irg)) : 0;
+	thread->current = node;
+}
+
+/**
+ * Records the top graphs by retained obstack bytes for the new peak.
+ * Uses the sizes sampled at the last region exit of each graph, so the
+ * entries of graphs not currently being worked on may be slightly stale.
+ */
+static void tr_record_peak(void)
+{
+	tr_peak_n_top = 0;
+	foreach_irp_irg(i, irg) {
+		size_t const bytes = irg->obst_sampled_bytes;
+		if (bytes == 0)
+			continue;
+		unsigned pos = tr_peak_n_top;
+		while (pos > 0 && tr_peak_top[pos - 1].bytes < bytes)
+			--pos;
+		if (pos >= TR_PEAK_TOP_N)
+			continue;
+		unsigned const end = tr_peak_n_top < TR_PEAK_TOP_N
+		                   ? tr_peak_n_top : TR_PEAK_TOP_N - 1;
+		for (unsigned j = end; j > pos; --j)
+			tr_peak_top[j] = tr_peak_top[j - 1];
+		snprintf(tr_peak_top[pos].name, sizeof(tr_peak_top[pos].name), "%s",
+		         get_entity_name(get_irg_entity(irg)));
+		tr_peak_top[pos].bytes = bytes;
+		if (tr_peak_n_top < TR_PEAK_TOP_N)
+			++tr_peak_n_top;
+	}
+}
+
+void ir_timereg_pop_(void)
+{
+	tr_thread_t *const thread = tr_get_thread();
+	tr_node_t   *const node   = thread->current;
+	if (node == thread->root)
+		panic("timing region pop without push");
+	node->ticks    += timing_ticks() - node->enter;
+
+	ir_graph *const irg = node->irg;
+	if (irg != NULL) {
+		size_t const now = obstack_memory_used(get_irg_obstack(irg));
+		node->irg_bytes += (long long)now - (long long)node->enter_bytes;
+
+		firm_intern_lock();
+		tr_total_bytes += now - irg->obst_sampled_bytes;
+		irg->obst_sampled_bytes = now;
+		if (tr_total_bytes > tr_peak_bytes) {
+			tr_peak_bytes = tr_total_bytes;
+			tr_record_peak();
+		}
+		firm_intern_unlock();
+	}
+
+	thread->current = node->parent;
+}
+
+void ir_timereg_forget_irg(ir_graph *irg)
+{
+	if (irg->obst_sampled_bytes == 0)
+		return;
+	firm_intern_lock();
+	tr_total_bytes -= irg->obst_sampled_bytes;
+	firm_intern_unlock();
+	irg->obst_sampled_bytes = 0;
+}
+
+static void tr_emit_json_string(const char *s)
+{
+	fputc('"', tr_file);
+	for (; *s != '\0'; ++s) {
+		char const c = *s;
+		if (c == '"' || c == '\\') {
+			fputc('\\', tr_file);
+			fputc(c, tr_file);
+		} else if ((unsigned char)c < 0x20) {
+			fprintf(tr_file, "\\u%04x", (unsigned char)c);
+		} else {
+			fputc(c, tr_file);
+		}
+	}
+	fputc('"', tr_file);
+}
+
+static void tr_emit_node(const tr_node_t *node)
+{
+	fputs("{\"name\":", tr_file);
+	tr_emit_json_string(node->name);
+	if (node->irg_name != NULL) {
+		fputs(",\"irg\":", tr_file);
+		tr_emit_json_string(node->irg_name);
+	}
+	fprintf(tr_file, ",\"calls\":%llu,\"ticks\":%llu", node->calls,
+	        node->ticks);
+	if (node->irg_bytes != 0)
+		fprintf(tr_file, ",\"irg_bytes\":%lld", node->irg_bytes);
+	if (node->child != NULL) {
+		fputs(",\"children\":[", tr_file);
+		for (const tr_node_t *child = node->child; child != NULL;
+		     child = child->sibling) {
+			if (child != node->child)
+				fputc(',', tr_file);
+			tr_emit_node(child);
+		}
+		fputc(']', tr_file);
+	}
+	fputc('}', tr_file);
+}
+
+void ir_timereg_begin(const char *filename)
+{
+	assert(tr_file == NULL);
+	if (streq(filename, "-")) {
+		tr_file = stderr;
+	} else {
+		tr_file = fopen(filename, "w");
+		if (tr_file == NULL)
+			panic("could not open timing region file '%s'", filename);
+	}
+	ir_timereg_enabled = true;
+}
+
+void ir_timereg_end(void)
+{
+	if (tr_file == NULL)
+		return;
+	if (tr_file != stderr)
+		fclose(tr_file);
+	tr_file            = NULL;
+	ir_timereg_enabled = false;
+}
+
+void ir_timereg_unit_begin(const char *cup_name)
+{
+	if (!ir_timereg_enabled)
+		return;
+	tr_unit_name  = cup_name;
+	tr_unit_start = timing_ticks();
+}
+
+void ir_timereg_unit_end(void)
+{
+	if (!ir_timereg_enabled)
+		return;
+
+	fputs("{\"unit\":", tr_file);
+	tr_emit_json_string(tr_unit_name != NULL ? tr_unit_name : "");
+	fprintf(tr_file, ",\"ticks\":%llu", timing_ticks() - tr_unit_start);
+	if (tr_peak_bytes != 0) {
+		fprintf(tr_file, ",\"peak_obst_bytes\":%zu,\"peak_irgs\":[",
+		        tr_peak_bytes);
+		for (unsigned i = 0; i < tr_peak_n_top; ++i) {
+			if (i != 0)
+				fputc(',', tr_file);
+			fputs("{\"name\":", tr_file);
+			tr_emit_json_string(tr_peak_top[i].name);
+			fprintf(tr_file, ",\"bytes\":%zu}", tr_peak_top[i].bytes);
+		}
+		fputc(']', tr_file);
+
+		/* also report the program wide peak as statistic events, so the
+		 * statev tooling can size build fleets from the event stream */
+		stat_ev_ull("irp_peak_obst_bytes", tr_peak_bytes);
+		for (unsigned i = 0; i < tr_peak_n_top; ++i) {
+			stat_ev_ctx_push_fmt("irp_peak_irg", "%s", tr_peak_top[i].name);
+			stat_ev_ull("irp_peak_irg_bytes", tr_peak_top[i].bytes);
+			stat_ev_ctx_pop("irp_peak_irg");
+		}
+	}
+	fputs(",\"threads\":[", tr_file);
+	bool first = true;
+	for (tr_thread_t *thread = tr_threads; thread != NULL;
+	     thread = thread->next) {
+		if (!first)
+			fputc(',', tr_file);
+		first = false;
+		fputs("{\"regions\":[", tr_file);
+		for (const tr_node_t *node = thread->root->child; node != NULL;
+		     node = node->sibling) {
+			if (node != thread->root->child)
+				fputc(',', tr_file);
+			tr_emit_node(node);
+		}
+		fputs("]}", tr_file);
+	}
+	fputs("]}\n", tr_file);
+	fflush(tr_file);
+
+	/* start the next unit with empty trees; threads with regions still
+	 * open keep their recordings */
+	for (tr_thread_t *thread = tr_threads; thread != NULL;
+	     thread = thread->next) {
+		if (thread->current != thread->root)
+			continue;
+		obstack_free(&thread->obst, NULL);
+		obstack_init(&thread->obst);
+		thread->root    = tr_new_node(thread, "", NULL, NULL);
+		thread->current = thread->root;
+	}
+	tr_unit_name = NULL;
+}
@@ -0,0 +1,72 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Hierarchical timing regions with JSON output.
+ *
+ * Unlike the flat timers in timing.h, timing regions form a tree: a region
+ * pushed while another one is active becomes its child, so the time of a
+ * pass is automatically attributed to whatever drove it.  Regions are
+ * per-thread and use the cheap tick counter from stat_timing.h.  At the end
+ * of a compilation unit the accumulated tree is written as one JSON object,
+ * suitable for machine consumption.
+ *
+ * Regions tied to a graph additionally account the graph's node obstack:
+ * each region records the bytes it left behind, and a program-wide peak
+ * with the top graphs by retained bytes is tracked and exported both in
+ * the JSON output and as statistic events.
+ */
+#ifndef FIRM_COMMON_TIMEREG_H
+#define FIRM_COMMON_TIMEREG_H
+
+#include <stdbool.h>
+#include "firm_types.h"
+
+/** Set if timing regions are recorded; checked inline to keep the
+ * disabled case free of call overhead. */
+extern bool ir_timereg_enabled;
+
+/**
+ * Enables timing regions and directs the JSON output to @p filename
+ * ("-" for stderr).
+ */
+void ir_timereg_begin(const char *filename);
+
+/** Disables timing regions and closes the output file. */
+void ir_timereg_end(void);
+
+/** Starts a new compilation unit named @p cup_name. */
+void ir_timereg_unit_begin(const char *cup_name);
+
+/** Finishes the current compilation unit and writes its JSON object. */
+void ir_timereg_unit_end(void);
+
+void ir_timereg_push_(const char *name, ir_graph *irg);
+void ir_timereg_pop_(void);
+
+/** Removes a graph about to be freed from the memory accounting. */
+void ir_timereg_forget_irg(ir_graph *irg);
+
+/**
+ * Enters the region @p name as a child of the currently active region.
+ * @p irg may be NULL for regions not tied to a graph.
+ */
+static inline void ir_timereg_push(const char *name, ir_graph *irg)
+{
+	if (!ir_timereg_enabled)
+		return;
+	ir_timereg_push_(name, irg);
+}
+
+/** Leaves the most recently entered region. */
+static inline void ir_timereg_pop(void)
+{
+	if (!ir_timereg_enabled)
+		return;
+	ir_timereg_pop_();
+}
+
+#endif
@@ -10,28 +10,74 @@
  */
 #include "ident_t.h"
 
+#include "firm_thread.h"
 #include "hashptr.h"
 #include "obst.h"
 #include "set.h"
+#include "util.h"
+#include "xmalloc.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
-static set *id_set;
+/** Number of independently locked interning stripes (power of two).
+ * Idents are distributed over the stripes by their hash, so concurrent
+ * creation only contends when two threads hit the same stripe. */
+#define N_ID_STRIPES 16
+
+static set *id_sets[N_ID_STRIPES];
+
+#ifndef _WIN32
+#include <pthread.h>
+static pthread_mutex_t id_locks[N_ID_STRIPES];
+#endif
 
 /** An obstack used for temporary space */
 static struct obstack id_obst;
 
+#define X(name, string) ident *name;
+FOREACH_KNOWN_IDENT(X)
+#undef X
+
 void init_ident(void)
 {
-	/* it's ok to use memcmp here, we check only strings */
-	id_set = new_set(memcmp, 128);
+	for (unsigned i = 0; i < N_ID_STRIPES; ++i) {
+		/* it's ok to use memcmp here, we check only strings */
+		id_sets[i] = new_set(memcmp, 128 / N_ID_STRIPES);
+#ifndef _WIN32
+		pthread_mutex_init(&id_locks[i], NULL);
+#endif
+	}
 	obstack_init(&id_obst);
+
+	/* resolve the known idents with a single bulk pass */
+	static char const *const known_strings[] = {
+#define X(name, string) string,
+		FOREACH_KNOWN_IDENT(X)
+#undef X
+	};
+	ident *known[ARRAY_SIZE(known_strings)];
+	new_ids_from_strs(known_strings, ARRAY_SIZE(known_strings), known);
+	size_t n = 0;
+#define X(name, string) name = known[n++];
+	FOREACH_KNOWN_IDENT(X)
+#undef X
 }
 
 ident *new_id_from_chars(const char *str, size_t len)
 {
-	unsigned   hash   = hash_data((const unsigned char*)str, len);
-	set_entry *result = set_hinsert0(id_set, str, len, hash);
+	unsigned const hash   = hash_data((const unsigned char*)str, len);
+	unsigned const stripe = hash & (N_ID_STRIPES - 1);
+#ifndef _WIN32
+	bool const lock = firm_parallel_is_active();
+	if (lock)
+		pthread_mutex_lock(&id_locks[stripe]);
+#endif
+	set_entry *result = set_hinsert0(id_sets[stripe], str, len, hash);
+#ifndef _WIN32
+	if (lock)
+		pthread_mutex_unlock(&id_locks[stripe]);
+#endif
 	return (ident*)result->dptr;
 }
 
@@ -40,6 +86,36 @@ ident *new_id_from_str(const char *str)
 	return new_id_from_chars(str, strlen(str));
 }
 
+void new_ids_from_strs(char const *const *strs, size_t n, ident **result)
+{
+	unsigned *const hashes = XMALLOCN(unsigned, n);
+	for (size_t i = 0; i < n; ++i)
+		hashes[i] = hash_data((const unsigned char*)strs[i], strlen(strs[i]));
+
+#ifndef _WIN32
+	bool const lock = firm_parallel_is_active();
+#endif
+	for (unsigned stripe = 0; stripe < N_ID_STRIPES; ++stripe) {
+#ifndef _WIN32
+		if (lock)
+			pthread_mutex_lock(&id_locks[stripe]);
+#endif
+		for (size_t i = 0; i < n; ++i) {
+			unsigned const hash = hashes[i];
+			if ((hash & (N_ID_STRIPES - 1)) != stripe)
+				continue;
+			set_entry *entry = set_hinsert0(id_sets[stripe], strs[i],
+			                                strlen(strs[i]), hash);
+			result[i] = (ident*)entry->dptr;
+		}
+#ifndef _WIN32
+		if (lock)
+			pthread_mutex_unlock(&id_locks[stripe]);
+#endif
+	}
+	free(hashes);
+}
+
 static ident *new_ident_from_obst(struct obstack *const obst)
 {
 	size_t const len    = obstack_object_size(obst);
@@ -51,11 +127,15 @@ static ident *new_ident_from_obst(struct obstack *const obst)
 
 ident *new_id_fmt(char const *const fmt, ...)
 {
+	/* the scratch obstack is shared, so formatting must be serialized */
+	firm_intern_lock();
 	va_list ap;
 	va_start(ap, fmt);
 	obstack_vprintf(&id_obst, fmt, ap);
 	va_end(ap);
-	return new_ident_from_obst(&id_obst);
+	ident *const res = new_ident_from_obst(&id_obst);
+	firm_intern_unlock();
+	return res;
 }
 
 const char *(get_id_str)(ident *id)
@@ -66,12 +146,17 @@ const char *(get_id_str)(ident *id)
 void finish_ident(void)
 {
 	obstack_free(&id_obst, NULL);
-	del_set(id_set);
-	id_set = NULL;
+	for (unsigned i = 0; i < N_ID_STRIPES; ++i) {
+		del_set(id_sets[i]);
+		id_sets[i] = NULL;
+	}
 }
 
 ident *id_unique(const char *tag)
 {
 	static unsigned unique_id = 0;
-	return new_id_fmt("%s.%u", tag, unique_id++);
+	firm_intern_lock();
+	unsigned const id = unique_id++;
+	firm_intern_unlock();
+	return new_id_fmt("%s.%u", tag, id);
 }
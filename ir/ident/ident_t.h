@@ -20,6 +20,39 @@ static inline const char *get_id_str_(ident *ident)
 	return ident;
 }
 
+/**
+ * Interns @p n strings in one pass and stores the resulting idents in
+ * @p result.  Cheaper than individual new_id_from_str() calls because
+ * every interning stripe is visited (and locked) at most once.
+ */
+void new_ids_from_strs(char const *const *strs, size_t n, ident **result);
+
+/**
+ * Idents for fixed strings used throughout the library.  They are
+ * resolved in bulk by init_ident() so later users just read the handle
+ * instead of re-interning the string.
+ */
+#define FOREACH_KNOWN_IDENT(X) \
+	X(id_empty,                "") \
+	X(id_mcount,               "mcount") \
+	X(id_constraint_eax,       "=a") \
+	X(id_constraint_edx,       "=d") \
+	X(id_va_start,             "$va_start") \
+	X(id_builtin_va_list,      "builtin:va_list") \
+	X(id_gp_offset,            "gp_offset") \
+	X(id_xmm_offset,           "xmm_offset") \
+	X(id_stack_args_ptr,       "stack_args_ptr") \
+	X(id_reg_save_ptr,         "reg_save_ptr") \
+	X(id_error,                "error") \
+	X(id_init_firmprof2,       "__init_firmprof2") \
+	X(id_firmprof_initializer, "__firmprof_initializer") \
+	X(id_dummy_owner,          "$dummy_owner$") \
+	X(id_frame_type,           "<frame_type>")
+
+#define X(name, string) extern ident *name;
+FOREACH_KNOWN_IDENT(X)
+#undef X
+
 /**
  * Initialize the ident module.
  */
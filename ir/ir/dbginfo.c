@@ -11,10 +11,18 @@
  */
 #include "dbginfo_t.h"
 
+#include "array.h"
 #include "entity_t.h"
+#include "firm_thread.h"
+#include "hashptr.h"
+#include "ident_t.h"
 #include "irnode_t.h"
 #include "panic.h"
+#include "pmap.h"
+#include "set.h"
 #include "type_t.h"
+#include <stdint.h>
+#include <string.h>
 
 merge_pair_func *__dbg_info_merge_pair = default_dbg_info_merge_pair;
 merge_sets_func *__dbg_info_merge_sets = default_dbg_info_merge_sets;
@@ -84,6 +92,81 @@ void default_dbg_info_merge_sets(ir_node *const *new_nodes, int n_new_nodes,
 	}
 }
 
+/**
+ * A pooled source location.  The fields are ordered so the struct is
+ * 8 bytes without padding, which lets the deduplication table compare
+ * entries with memcmp.
+ */
+typedef struct pooled_dbg_info_t {
+	uint16_t file_id; /**< index into pool_files */
+	uint16_t column;  /**< column number, saturated at UINT16_MAX */
+	uint32_t line;    /**< line number */
+} pooled_dbg_info_t;
+
+static set    *location_pool;  /**< deduplication table of pooled_dbg_info_t */
+static ident **pool_files;     /**< maps file ids to interned file names */
+static pmap   *pool_file_ids;  /**< maps interned file names to file id+1 */
+
+static src_loc_t pool_retrieve_dbg(dbg_info const *const dbg)
+{
+	if (dbg == NULL) {
+		src_loc_t const loc = { NULL, 0, 0 };
+		return loc;
+	}
+	pooled_dbg_info_t const *const pooled = (pooled_dbg_info_t const*)dbg;
+	src_loc_t const loc = {
+		get_id_str(pool_files[pooled->file_id]), pooled->line, pooled->column
+	};
+	return loc;
+}
+
+dbg_info *ir_dbg_info_intern(const char *file, unsigned line, unsigned column)
+{
+	firm_intern_lock();
+	if (location_pool == NULL) {
+		/* entries have no padding, so memcmp is fine */
+		location_pool = new_set(memcmp, 128);
+		pool_files    = NEW_ARR_F(ident*, 0);
+		pool_file_ids = pmap_create();
+		/* pooled infos carry their location themselves */
+		ir_set_debug_retrieve(pool_retrieve_dbg);
+	}
+
+	ident *file_ident = new_id_from_str(file != NULL ? file : "");
+	size_t file_id    = (size_t)(intptr_t)pmap_get(void, pool_file_ids,
+	                                               file_ident);
+	if (file_id == 0) {
+		ARR_APP1(ident*, pool_files, file_ident);
+		file_id = ARR_LEN(pool_files);
+		assert(file_id <= UINT16_MAX);
+		pmap_insert(pool_file_ids, file_ident, (void*)(intptr_t)file_id);
+	}
+
+	pooled_dbg_info_t const key = {
+		.file_id = (uint16_t)(file_id - 1),
+		.column  = column > UINT16_MAX ? UINT16_MAX : (uint16_t)column,
+		.line    = (uint32_t)line,
+	};
+	unsigned const hash = hash_data((const unsigned char*)&key, sizeof(key));
+	pooled_dbg_info_t *const res
+		= set_insert(pooled_dbg_info_t, location_pool, &key, sizeof(key), hash);
+	firm_intern_unlock();
+	return (dbg_info*)res;
+}
+
+void finish_dbginfo(void)
+{
+	if (location_pool == NULL)
+		return;
+	del_set(location_pool);
+	DEL_ARR_F(pool_files);
+	pmap_destroy(pool_file_ids);
+	location_pool = NULL;
+	pool_files    = NULL;
+	pool_file_ids = NULL;
+	ir_set_debug_retrieve(NULL);
+}
+
 static src_loc_t default_retrieve_dbg(dbg_info const *const dbg)
 {
 	(void)dbg;
@@ -56,4 +56,7 @@ extern merge_sets_func *__dbg_info_merge_sets;
 
 void ir_dbg_info_snprint(char *buf, size_t buf_size, const dbg_info *dbg);
 
+/** Frees the interned location pool of ir_dbg_info_intern(). */
+void finish_dbginfo(void);
+
 #endif
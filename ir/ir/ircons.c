@@ -22,6 +22,7 @@
 #include "irgraph_t.h"
 #include "irhooks.h"
 #include "irmode_t.h"
+#include "irnode_new_t.h"
 #include "irnode_t.h"
 #include "irop_t.h"
 #include "iropt_t.h"
@@ -50,7 +51,7 @@ static inline ir_node *new_rd_Phi0(dbg_info *dbgi, ir_node *block,
                                    ir_mode *mode, int pos)
 {
 	ir_graph *irg = get_irn_irg(block);
-	ir_node  *res = new_ir_node(dbgi, irg, block, op_Phi, mode, 0, NULL);
+	ir_node  *res = new_ir_node_(dbgi, irg, block, op_Phi, mode, 0, NULL);
 	res->attr.phi.u.pos = pos;
 	verify_new_node(res);
 	return res;
@@ -143,6 +144,22 @@ static ir_node *set_phi_arguments(ir_node *phi, int pos)
 	return phi;
 }
 
+/**
+ * Returns the Phi construction array of a block, allocating it on
+ * demand.  Blocks prepared for a restarted SSA construction carry no
+ * array up front (see irssacons.c), so only blocks that actually hold
+ * values pay for one.
+ */
+static ir_node **get_graph_arr(ir_node *block)
+{
+	if (block->attr.block.graph_arr == NULL) {
+		ir_graph *const irg = get_irn_irg(block);
+		block->attr.block.graph_arr
+			= NEW_ARR_DZ(ir_node*, get_irg_obstack(irg), irg->n_loc);
+	}
+	return block->attr.block.graph_arr;
+}
+
 /**
  * This function returns the last definition of a value.  In case
  * this value was last defined in a previous block, Phi nodes are
@@ -155,7 +172,8 @@ static ir_node *set_phi_arguments(ir_node *phi, int pos)
  */
 static ir_node *get_r_value_internal(ir_node *block, int pos, ir_mode *mode)
 {
-	ir_node *res = block->attr.block.graph_arr[pos];
+	ir_node **const graph_arr = get_graph_arr(block);
+	ir_node        *res       = graph_arr[pos];
 	if (res != NULL)
 		return res;
 
@@ -192,7 +210,7 @@ bad:
 			res = new_rd_Phi0(NULL, block, mode, pos);
 			/* enter phi0 into our variable value table to break cycles
 			 * arising from set_phi_arguments */
-			block->attr.block.graph_arr[pos] = res;
+			graph_arr[pos] = res;
 			res = set_phi_arguments(res, pos);
 		}
 	} else {
@@ -202,7 +220,7 @@ bad:
 		res->attr.phi.next     = block->attr.block.phis;
 		block->attr.block.phis = res;
 	}
-	block->attr.block.graph_arr[pos] = res;
+	graph_arr[pos] = res;
 	return res;
 }
 
@@ -242,8 +260,8 @@ void mature_immBlock(ir_node *block)
 		ir_node *const next      = phi->attr.phi.next;
 		int      const pos       = phi->attr.phi.u.pos;
 		ir_node *const new_value = set_phi_arguments(phi, pos);
-		if (block->attr.block.graph_arr[pos] == phi)
-			block->attr.block.graph_arr[pos] = new_value;
+		if (get_graph_arr(block)[pos] == phi)
+			get_graph_arr(block)[pos] = new_value;
 		phi = next;
 	}
 
@@ -419,7 +437,8 @@ static ir_mode *guess_recursively(ir_node *block, int pos)
 		return NULL;
 
 	/* already have a definition -> we can simply look at its mode */
-	ir_node *const value = block->attr.block.graph_arr[pos];
+	ir_node **const graph_arr = block->attr.block.graph_arr;
+	ir_node  *const value     = graph_arr != NULL ? graph_arr[pos] : NULL;
 	if (value != NULL)
 		return get_irn_mode(value);
 
@@ -440,8 +459,9 @@ static ir_mode *guess_recursively(ir_node *block, int pos)
 ir_mode *ir_r_guess_mode(ir_graph *irg, int pos)
 {
 	/* already have a definition -> we can simply look at its mode */
-	ir_node *const block = irg->current_block;
-	ir_node *const value = block->attr.block.graph_arr[pos+1];
+	ir_node  *const block     = irg->current_block;
+	ir_node **const graph_arr = block->attr.block.graph_arr;
+	ir_node  *const value     = graph_arr != NULL ? graph_arr[pos+1] : NULL;
 	if (value != NULL)
 		return get_irn_mode(value);
 
@@ -464,7 +484,7 @@ void set_r_value(ir_graph *irg, int pos, ir_node *value)
 	assert(pos >= 0);
 	assert(pos + 1 < irg->n_loc);
 	assert(value->kind == k_ir_node);
-	irg->current_block->attr.block.graph_arr[pos + 1] = value;
+	get_graph_arr(irg->current_block)[pos + 1] = value;
 }
 
 void set_value(int pos, ir_node *value)
@@ -487,7 +507,7 @@ void set_r_store(ir_graph *const irg, ir_node *store)
 {
 	assert(irg_is_constrained(irg, IR_GRAPH_CONSTRAINT_CONSTRUCTION));
 	assert(get_irn_mode(store) == mode_M && "storing non-memory node");
-	irg->current_block->attr.block.graph_arr[0] = store;
+	get_graph_arr(irg->current_block)[0] = store;
 }
 
 void set_store(ir_node *store)
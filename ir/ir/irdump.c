@@ -1688,8 +1688,27 @@ void dump_blocks_as_subgraphs(FILE *out, ir_graph *irg)
 	DEL_ARR_F(arr);
 }
 
+/** Node count above which full graph dumps degrade to a CFG summary. */
+static size_t dump_node_limit;
+
+void ir_set_dump_node_limit(size_t limit)
+{
+	dump_node_limit = limit;
+}
+
 void dump_ir_graph_file(FILE *out, ir_graph *irg)
 {
+	/* Huge machine-generated graphs take minutes to dump and fill disks;
+	 * above the configured limit emit only the block-level summary. */
+	if (dump_node_limit != 0 && get_irg_last_idx(irg) > dump_node_limit) {
+		fprintf(out, "// graph %s elided: about %u nodes exceed the dump "
+		        "limit of %u, showing CFG only\n",
+		        get_irg_dump_name(irg), (unsigned)get_irg_last_idx(irg),
+		        (unsigned)dump_node_limit);
+		dump_cfg(out, irg);
+		return;
+	}
+
 	dump_vcg_header(out, get_irg_dump_name(irg), NULL, NULL);
 
 	ir_entity *ent = get_irg_entity(irg);
@@ -1998,6 +2017,31 @@ static void collect_nodeloop_external_nodes(ir_loop *loop, pset *loopnodes,
 	}
 }
 
+static int cmp_node_nr(const void *a, const void *b)
+{
+	long const na = get_irn_node_nr(*(ir_node const *const *)a);
+	long const nb = get_irn_node_nr(*(ir_node const *const *)b);
+	return QSORT_CMP(na, nb);
+}
+
+/**
+ * pset iterates in hash order, which depends on the pointer values of the
+ * inserted nodes and hence changes from run to run.  Dump output must not,
+ * so loop dumping walks the collected nodes sorted by node number instead.
+ */
+static ir_node **pset_to_sorted_nodes(pset *set, size_t *n_res)
+{
+	size_t const n     = pset_count(set);
+	ir_node    **nodes = XMALLOCN(ir_node*, n);
+	size_t       i     = 0;
+	foreach_pset(set, ir_node, node) {
+		nodes[i++] = node;
+	}
+	QSORT(nodes, n, cmp_node_nr);
+	*n_res = n;
+	return nodes;
+}
+
 void dump_loop(FILE *F, ir_loop *l)
 {
 	pset *loopnodes = pset_new_ptr_default();
@@ -2011,21 +2055,30 @@ void dump_loop(FILE *F, ir_loop *l)
 	collect_nodeloop(F, l, loopnodes);
 	collect_nodeloop_external_nodes(l, loopnodes, extnodes);
 
+	size_t          n_loopnodes;
+	size_t          n_extnodes;
+	ir_node **const sorted_loopnodes
+		= pset_to_sorted_nodes(loopnodes, &n_loopnodes);
+	ir_node **const sorted_extnodes
+		= pset_to_sorted_nodes(extnodes, &n_extnodes);
+
 	/* build block lists */
-	foreach_pset(loopnodes, ir_node, n) {
-		set_irn_link(n, NULL);
+	for (size_t i = 0; i < n_loopnodes; ++i) {
+		set_irn_link(sorted_loopnodes[i], NULL);
 	}
-	foreach_pset(extnodes, ir_node, n) {
-		set_irn_link(n, NULL);
+	for (size_t i = 0; i < n_extnodes; ++i) {
+		set_irn_link(sorted_extnodes[i], NULL);
 	}
-	foreach_pset(loopnodes, ir_node, n) {
+	for (size_t i = n_loopnodes; i-- > 0; ) {
+		ir_node *const n = sorted_loopnodes[i];
 		if (!is_Block(n)) {
 			ir_node *const b = get_nodes_block(n);
 			set_irn_link(n, get_irn_link(b));
 			set_irn_link(b, n);
 		}
 	}
-	foreach_pset(extnodes, ir_node, n) {
+	for (size_t i = n_extnodes; i-- > 0; ) {
+		ir_node *const n = sorted_extnodes[i];
 		if (!is_Block(n)) {
 			ir_node *const b = get_nodes_block(n);
 			set_irn_link(n, get_irn_link(b));
@@ -2033,7 +2086,8 @@ void dump_loop(FILE *F, ir_loop *l)
 		}
 	}
 
-	foreach_pset(loopnodes, ir_node, b) {
+	for (size_t i = 0; i < n_loopnodes; ++i) {
+		ir_node *const b = sorted_loopnodes[i];
 		if (is_Block(b)) {
 			fprintf(F, "graph: { title: ");
 			print_nodeid(F, b);
@@ -2060,7 +2114,8 @@ void dump_loop(FILE *F, ir_loop *l)
 			fprintf(F, "\n");
 		}
 	}
-	foreach_pset(extnodes, ir_node, b) {
+	for (size_t i = 0; i < n_extnodes; ++i) {
+		ir_node *const b = sorted_extnodes[i];
 		if (is_Block(b)) {
 			fprintf(F, "graph: { title: ");
 			print_nodeid(F, b);
@@ -2084,6 +2139,8 @@ void dump_loop(FILE *F, ir_loop *l)
 			fprintf(F, "\n");
 		}
 	}
+	free(sorted_loopnodes);
+	free(sorted_extnodes);
 	del_pset(loopnodes);
 	del_pset(extnodes);
 
@@ -2159,6 +2216,8 @@ void dump_ir_graph_ext(ir_graph_dump_func func, ir_graph *graph,
 		fprintf(stderr, "Couldn't open '%s': %s\n", file_name, strerror(errno));
 		return;
 	}
+	/* dumpers emit lots of tiny writes, stream them through a big buffer */
+	setvbuf(out, NULL, _IOFBF, 1 << 20);
 
 	func(out, graph);
 	fclose(out);
@@ -2184,6 +2243,7 @@ void dump_ir_prog_ext(ir_prog_dump_func func, const char *suffix)
 		fprintf(stderr, "Couldn't open '%s': %s\n", file_name, strerror(errno));
 		return;
 	}
+	setvbuf(out, NULL, _IOFBF, 1 << 20);
 	func(out);
 	fclose(out);
 }
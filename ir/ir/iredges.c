@@ -127,6 +127,14 @@ DEBUG_ONLY(static firm_dbg_module_t *dbg;)
  */
 static int edges_dbg = 0;
 
+/** If set, edge sets survive edges_deactivate()/edges_activate() cycles. */
+static bool edges_incremental = false;
+
+void edges_set_incremental(int enable)
+{
+	edges_incremental = enable;
+}
+
 /**
  * Returns an ID for the given edge.
  */
@@ -478,7 +486,12 @@ void edges_activate_kind(ir_graph *irg, ir_edge_kind_t kind)
 	struct build_walker  w    = { .kind = kind };
 	irg_edge_info_t     *info = get_irg_edge_info(irg, kind);
 
-	assert(!info->activated);
+	/* In incremental mode a surviving edge set is kept consistent by the
+	 * edges_notify_edge() hooks, so there is nothing to rebuild. */
+	if (info->activated) {
+		assert(edges_incremental);
+		return;
+	}
 
 	info->activated = 1;
 	edges_init_graph_kind(irg, kind);
@@ -491,7 +504,7 @@ void edges_activate_kind(ir_graph *irg, ir_edge_kind_t kind)
 	}
 }
 
-void edges_deactivate_kind(ir_graph *irg, ir_edge_kind_t kind)
+void edges_free_kind(ir_graph *irg, ir_edge_kind_t kind)
 {
 	irg_edge_info_t *info = get_irg_edge_info(irg, kind);
 
@@ -504,6 +517,19 @@ void edges_deactivate_kind(ir_graph *irg, ir_edge_kind_t kind)
 	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
 }
 
+void edges_deactivate_kind(ir_graph *irg, ir_edge_kind_t kind)
+{
+	irg_edge_info_t *info = get_irg_edge_info(irg, kind);
+
+	/* In incremental mode the edge set survives deactivation: it stays
+	 * active so the notify hooks continue to patch it and the next
+	 * edges_activate_kind() is free. */
+	if (edges_incremental && info->activated)
+		return;
+
+	edges_free_kind(irg, kind);
+}
+
 int (edges_activated_kind)(const ir_graph *irg, ir_edge_kind_t kind)
 {
 	return edges_activated_kind_(irg, kind);
@@ -715,6 +741,18 @@ static void verify_edge_counter(ir_node *irn, void *env)
 	free(bs);
 }
 
+int edges_verify_cheap(ir_graph *irg)
+{
+	/* Only checks that the out lists match the in arrays; skips the
+	 * expensive edge-set and counter cross checks of edges_verify().
+	 * Intended as a sanity check after incremental maintenance. */
+	struct build_walker w = { .kind      = EDGE_KIND_NORMAL,
+	                          .reachable = bitset_alloca(get_irg_last_idx(irg)),
+	                          .fine      = true };
+	irg_walk_graph(irg, NULL, verify_list_presence, &w);
+	return w.fine;
+}
+
 int edges_verify(ir_graph *irg)
 {
 	/* verify normal edges only */
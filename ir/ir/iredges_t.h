@@ -133,6 +133,12 @@ static inline void edges_assure_kind_(ir_graph *irg, ir_edge_kind_t kind)
 
 void edges_init_graph_kind(ir_graph *irg, ir_edge_kind_t kind);
 
+/**
+ * Really tears down the edge set of @p irg, even in incremental mode.
+ * Needed when the nodes themselves go away (graph freeing, obstack swap).
+ */
+void edges_free_kind(ir_graph *irg, ir_edge_kind_t kind);
+
 void edges_node_deleted(ir_node *irn);
 
 /**
@@ -17,7 +17,9 @@
 #include "irgraph_t.h"
 #include "irgwalk.h"
 #include "irhooks.h"
+#include "irloop_t.h"
 #include "irnode_t.h"
+#include "irouts_t.h"
 #include "irtools.h"
 #include "panic.h"
 
@@ -31,8 +33,10 @@ void turn_into_tuple(ir_node *const node, int const arity,
 	set_irn_in(node, arity, in);
 	set_irn_op(node, op_Tuple);
 
-	/* update irg flags */
-	clear_irg_properties(get_irn_irg(node), IR_GRAPH_PROPERTY_NO_TUPLES);
+	/* update irg flags; the Tuple may forward control flow Projs, which
+	 * reroutes the CFG behind the loop tree's back */
+	clear_irg_properties(get_irn_irg(node), IR_GRAPH_PROPERTY_NO_TUPLES
+	                     | IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
 }
 
 void exchange(ir_node *old, ir_node *nw)
@@ -57,6 +61,13 @@ void exchange(ir_node *old, ir_node *nw)
 
 	hook_replace(old, nw);
 
+	/* Rerouting the users of a Block or of a node producing control flow
+	 * changes the CFG; exchanging a plain data node leaves the loop tree
+	 * intact.  mode_T is handled conservatively, it may have X Projs. */
+	ir_mode *const old_mode = get_irn_mode(old);
+	bool const affects_cfg
+		= is_Block(old) || old_mode == mode_X || old_mode == mode_T;
+
 	/* If new outs are on, we can skip the id node creation and reroute
 	 * the edges from the old node to the new directly. */
 	if (edges_activated(irg)) {
@@ -84,8 +95,10 @@ void exchange(ir_node *old, ir_node *nw)
 	}
 
 	/* update irg flags */
-	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS
-	                        | IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+	ir_graph_properties_t cleared = IR_GRAPH_PROPERTY_CONSISTENT_OUTS;
+	if (affects_cfg)
+		cleared |= IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO;
+	clear_irg_properties(irg, cleared);
 }
 
 static void collect_new_start_block_node_(ir_node *node)
@@ -248,6 +261,19 @@ void part_block(ir_node *node)
 	/* Transform the control flow */
 	ir_node  *old_block = get_nodes_block(node);
 	ir_graph *irg       = get_irn_irg(node);
+
+	/* Splitting a block does not change the loop structure, so the loop
+	 * tree can be repaired instead of rebuilt.  If the old block carries
+	 * backedge flags they would have to move to the upper block; fall
+	 * back to a rebuild in that rare case. */
+	bool keep_loopinfo
+		= irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+	for (int i = 0, n = get_Block_n_cfgpreds(old_block);
+	     keep_loopinfo && i < n; ++i) {
+		if (is_backedge(old_block, i))
+			keep_loopinfo = false;
+	}
+
 	ir_node  *new_block = new_r_Block(irg, get_Block_n_cfgpreds(old_block),
 	                                  get_Block_cfgpred_arr(old_block));
 
@@ -270,6 +296,15 @@ void part_block(ir_node *node)
 	if (old_block == get_irg_start_block(irg))
 		update_startblock(old_block, new_block);
 
+	if (keep_loopinfo) {
+		ir_loop *loop = get_irn_loop(old_block);
+		if (loop != NULL) {
+			set_irn_loop(new_block, loop);
+			add_loop_node(loop, new_block);
+			add_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+		}
+	}
+
 	set_optimize(rem_opt);
 }
 
@@ -309,6 +344,11 @@ void kill_node(ir_node *node)
 	if (edges_activated(irg)) {
 		edges_node_deleted(node);
 	}
+	irouts_node_deleted(node);
+	/* thread the memory onto the free list before the op changes,
+	 * irn_recycle() derives the size class from it */
+	if (irg->recycle_nodes)
+		irn_recycle(node);
 	/* noone is allowed to reference this node anymore */
 	set_irn_op(node, op_Deleted);
 }
@@ -13,19 +13,25 @@
 #include "array.h"
 #include "irbackedge_t.h"
 #include "ircons_t.h"
+#include "irdom_t.h"
 #include "iredges_t.h"
 #include "irflag_t.h"
 #include "irgmod.h"
 #include "irgopt.h"
 #include "irgwalk.h"
 #include "irhooks.h"
+#include "irloop_t.h"
 #include "irmemory.h"
 #include "irnode_t.h"
+#include "irnodeset.h"
 #include "iropt_t.h"
 #include "iroptimize.h"
 #include "irouts.h"
 #include "irprog_t.h"
 #include "irtools.h"
+#include "obstack_pool.h"
+#include "timereg.h"
+#include "set.h"
 #include "type_t.h"
 #include "util.h"
 #include "xmalloc.h"
@@ -59,9 +65,10 @@ static ir_graph *alloc_graph(void)
 	res->kind = k_ir_graph;
 
 	/* initialize the idx->node map. */
-	res->idx_irn_map = NEW_ARR_FZ(ir_node*, INITIAL_IDX_IRN_MAP_SIZE);
+	res->idx_irn_map    = NEW_ARR_FZ(ir_node*, INITIAL_IDX_IRN_MAP_SIZE);
+	res->visited_stamps = NEW_ARR_FZ(ir_visited_t, INITIAL_IDX_IRN_MAP_SIZE);
 
-	obstack_init(&res->obst);
+	firm_obstack_init_large(&res->obst);
 
 	/* value table for global value numbering for optimizing use in iropt.c */
 	new_identities(res);
@@ -75,7 +82,13 @@ static ir_graph *alloc_graph(void)
 static void free_graph(ir_graph *irg)
 {
 	for (ir_edge_kind_t i = EDGE_KIND_FIRST; i <= EDGE_KIND_LAST; ++i)
-		edges_deactivate_kind(irg, i);
+		edges_free_kind(irg, i);
+	if (irg->walk_frames != NULL)
+		DEL_ARR_F((char*)irg->walk_frames);
+	free(irg->inline_summary);
+	if (irg->alias_cache != NULL)
+		del_set(irg->alias_cache);
+	DEL_ARR_F(irg->visited_stamps);
 	DEL_ARR_F(irg->idx_irn_map);
 	free(irg);
 }
@@ -267,27 +280,78 @@ ir_graph *create_irg_copy(ir_graph *irg)
 	return res;
 }
 
-void free_ir_graph(ir_graph *irg)
+/**
+ * Frees everything of a graph that scales with its number of nodes:
+ * the node obstack, edges, outs, CSE table and the index based side
+ * arrays.  The ir_graph structure itself stays intact.
+ */
+static void free_graph_content(ir_graph *irg)
 {
-	assert(irg->kind == k_ir_graph);
-
-	remove_irp_irg(irg);
 	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_NONE);
 
 	free_irg_outs(irg);
 	del_identities(irg);
+	irg->value_table = NULL;
 	if (irg->ent) {
 		set_entity_irg(irg->ent, NULL);  /* not set in const code irg */
 	}
 
+	if (irg->dirty_blocks != NULL) {
+		ir_nodeset_destroy((ir_nodeset_t*)irg->dirty_blocks);
+		free(irg->dirty_blocks);
+		irg->dirty_blocks = NULL;
+	}
 	free_End(get_irg_end(irg));
+	ir_timereg_forget_irg(irg);
+	/* the loop tree keeps its children in flexible arrays which do not
+	 * die with the obstack */
+	if (irg->loop != NULL) {
+		free_loop_children(irg->loop);
+		irg->loop = NULL;
+	}
+	for (ir_edge_kind_t i = EDGE_KIND_FIRST; i <= EDGE_KIND_LAST; ++i)
+		edges_free_kind(irg, i);
+	if (irg->walk_frames != NULL) {
+		DEL_ARR_F((char*)irg->walk_frames);
+		irg->walk_frames = NULL;
+	}
 	obstack_free(&irg->obst, NULL);
-	if (irg->loc_descriptions)
+	memset(irg->free_nodes, 0, sizeof(irg->free_nodes));
+	free(irg->inline_summary);
+	irg->inline_summary = NULL;
+	if (irg->loc_descriptions) {
 		free(irg->loc_descriptions);
+		irg->loc_descriptions = NULL;
+	}
+}
+
+void free_ir_graph(ir_graph *irg)
+{
+	assert(irg->kind == k_ir_graph);
+
+	remove_irp_irg(irg);
+	if (!irg->content_freed)
+		free_graph_content(irg);
 	irg->kind = k_BAD;
 	free_graph(irg);
 }
 
+void free_ir_graph_content(ir_graph *irg)
+{
+	assert(irg->kind == k_ir_graph);
+	if (irg->content_freed)
+		return;
+	free_graph_content(irg);
+	/* replace the index based side arrays with empty ones, so the final
+	 * free_ir_graph() still finds valid arrays */
+	DEL_ARR_F(irg->idx_irn_map);
+	DEL_ARR_F(irg->visited_stamps);
+	irg->idx_irn_map    = NEW_ARR_F(ir_node*, 0);
+	irg->visited_stamps = NEW_ARR_F(ir_visited_t, 0);
+	irg->last_node_idx  = 0;
+	irg->content_freed  = true;
+}
+
 long get_irg_graph_nr(const ir_graph *irg)
 {
 #ifdef DEBUG_libfirm
@@ -439,6 +503,13 @@ void (set_irg_callee_info_state)(ir_graph *irg, irg_callee_info_state s)
 	set_irg_callee_info_state_(irg, s);
 }
 
+void set_irg_node_recycling(ir_graph *irg, int enable)
+{
+	irg->recycle_nodes = enable;
+	if (!enable)
+		memset(irg->free_nodes, 0, sizeof(irg->free_nodes));
+}
+
 void (set_irg_link)(ir_graph *irg, void *thing)
 {
 	set_irg_link_(irg, thing);
@@ -544,6 +615,19 @@ unsigned get_irg_last_idx(const ir_graph *irg)
 	return irg->last_node_idx;
 }
 
+size_t get_irg_obstack_memory(const ir_graph *irg, unsigned *const n_chunks)
+{
+	if (n_chunks != NULL) {
+		unsigned count = 0;
+		for (struct _obstack_chunk const *chunk = irg->obst.chunk;
+		     chunk != NULL; chunk = chunk->prev) {
+			++count;
+		}
+		*n_chunks = count;
+	}
+	return obstack_memory_used((struct obstack*)&irg->obst);
+}
+
 void add_irg_constraints(ir_graph *irg, ir_graph_constraints_t constraints)
 {
 	irg->constraints |= constraints;
@@ -569,6 +653,36 @@ void (clear_irg_properties)(ir_graph *irg, ir_graph_properties_t props)
 	clear_irg_properties_(irg, props);
 }
 
+void clear_irg_properties_local(ir_graph *irg, ir_graph_properties_t props,
+                                ir_node *block)
+{
+	/* a known region is only of use for properties we know how to repair;
+	 * it stays known only while every clear of the property declares it */
+	ir_graph_properties_t const repairable
+		= props & IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+		& (irg->properties | irg->locally_dirty);
+	bool const fresh
+		= (irg->locally_dirty & repairable) == IR_GRAPH_PROPERTIES_NONE;
+
+	irg->properties    &= ~props;
+	irg->locally_dirty &= ~props;
+	irg->locally_dirty |= repairable;
+
+	if (repairable == IR_GRAPH_PROPERTIES_NONE)
+		return;
+	ir_nodeset_t *dirty = (ir_nodeset_t*)irg->dirty_blocks;
+	if (dirty == NULL) {
+		dirty = XMALLOC(ir_nodeset_t);
+		ir_nodeset_init(dirty);
+		irg->dirty_blocks = dirty;
+	} else if (fresh) {
+		/* the recorded blocks belong to an already consumed region */
+		ir_nodeset_destroy(dirty);
+		ir_nodeset_init(dirty);
+	}
+	ir_nodeset_insert(dirty, block);
+}
+
 int (irg_has_properties)(const ir_graph *irg, ir_graph_properties_t props)
 {
 	return irg_has_properties_(irg, props);
@@ -598,8 +712,14 @@ void assure_irg_properties(ir_graph *irg, ir_graph_properties_t props)
 	};
 	for (size_t i = 0; i < ARRAY_SIZE(property_functions); ++i) {
 		ir_graph_properties_t missing = props & ~irg->properties;
-		if (missing & property_functions[i].property)
+		if (missing & property_functions[i].property) {
+			/* a declared local change may leave the old analysis intact */
+			if (property_functions[i].property
+			    == IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+			 && irg_try_repair_dominance(irg))
+				continue;
 			property_functions[i].func(irg);
+		}
 	}
 	assert((props & ~irg->properties) == IR_GRAPH_PROPERTIES_NONE);
 }
@@ -99,12 +99,19 @@ typedef struct ir_vrp_info {
 	struct obstack    obst;
 } ir_vrp_info;
 
+/** Number of node recycling size classes; one class per pointer word of
+ * node size.  Nodes bigger than that are never recycled. */
+#define IRG_NODE_RECYCLE_CLASSES 48
+
 /**
  * An ir_graph represents the code of a function as a graph of nodes.
  */
 struct ir_graph {
 	firm_kind              kind;          /**< Always set to k_ir_graph. */
 	unsigned               last_node_idx; /**< Last node index for graph. */
+	unsigned               last_verified_idx; /**< Node index watermark of the
+	                            last successful verification, used by
+	                            irg_verify_incremental(). */
 	/** The entity of this procedure, i.e., the type of the procedure and the
 	 * class it belongs to. */
 	ir_entity             *ent;
@@ -112,8 +119,24 @@ struct ir_graph {
 	ir_type               *frame_type;
 	ir_node               *anchor;        /**< Pointer to the anchor node. */
 	struct obstack         obst;          /**< obstack allocator for nodes. */
+	/** Obstack size at the last region exit; maintained by the memory
+	 * accounting in timereg.c. */
+	size_t                 obst_sampled_bytes;
+
+	/** Free lists of recycled node memory, indexed by size in pointer
+	 * words.  Only used while node recycling is enabled. */
+	void                  *free_nodes[IRG_NODE_RECYCLE_CLASSES];
+	bool                   recycle_nodes; /**< reuse storage of killed nodes */
 
 	ir_graph_properties_t  properties;
+	/** Properties cleared by clear_irg_properties_local() whose invalid
+	 * region is covered by dirty_blocks.  assure_irg_properties() may
+	 * repair such a property instead of recomputing it. */
+	ir_graph_properties_t  locally_dirty;
+	/** Blocks whose predecessors changed, declared through
+	 * clear_irg_properties_local().  A malloc'd ir_nodeset_t, managed by
+	 * irgraph.c; only meaningful for the properties in locally_dirty. */
+	void                  *dirty_blocks;
 	ir_graph_constraints_t constraints;
 	op_pin_state           irg_pinned_state;  /**< Flag for status of nodes. */
 	irg_callee_info_state  callee_info_state; /**< Validity of callee info. */
@@ -124,6 +147,29 @@ struct ir_graph {
 	ir_visited_t     block_visited; /**< Visited flag for block nodes. */
 	ir_visited_t     self_visited;  /**< Visited flag of the irg */
 	ir_node        **idx_irn_map;   /**< Map of node indexes to nodes. */
+	/** Visited stamps of all nodes, indexed by node index.  Kept outside
+	 * the nodes so the walkers touch a dense array instead of dragging
+	 * the full node records through the cache. */
+	ir_visited_t    *visited_stamps;
+	/** Pooled frame stack of the iterative graph walker (flexible array
+	 * of walk_frame_t), reused across walks. */
+	void            *walk_frames;
+	bool             walk_frames_busy; /**< pooled stack currently in use */
+	/** Node storage was released by free_ir_graph_content(); only
+	 * free_ir_graph() may still be called on this graph. */
+	bool             content_freed;
+	/** Cached inline cost summary, owned by opt_inline.c.  A single
+	 * malloc block so it can be freed here without knowing the layout. */
+	void            *inline_summary;
+	/** Memoized alias queries (a set of alias_cache_entry_t), only
+	 * non-NULL between ir_alias_cache_begin()/_end(), see irmemory.c. */
+	struct set      *alias_cache;
+	/** Memoized per-address memory partitions (a set of
+	 * alias_partition_entry_t), managed together with alias_cache. */
+	struct set      *alias_class_cache;
+	/** Flow-insensitive points-to partition (a pts_env_t, owned by
+	 * irmemory.c), managed together with alias_cache. */
+	void            *pointsto;
 	size_t           index;         /**< a unique number for each graph */
 	/** A void* field to link any information to the graph. */
 	void            *link;
@@ -132,6 +178,13 @@ struct ir_graph {
 
 	unsigned char    mem_disambig_opt;
 
+	/** Bitwise or of the size bits of every two's complement integer mode
+	 * that was ever attached to a node of this graph (and of Call result
+	 * types).  Accumulated at construction time and never cleared, so it
+	 * is conservative: nodes removed later keep their bit set.  Used by
+	 * the doubleword lowering to skip untouched graphs. */
+	unsigned         mode_size_mask;
+
 	/** Number of local variables in this function during construction. */
 	int      n_loc;
 	void   **loc_descriptions; /**< Descriptions for variables. */
@@ -395,6 +448,8 @@ static inline void clear_irg_properties_(ir_graph *irg,
                                     ir_graph_properties_t props)
 {
 	irg->properties &= ~props;
+	/* an unscoped clear means the invalid region is unknown */
+	irg->locally_dirty &= ~props;
 }
 
 static inline int irg_has_properties_(const ir_graph *irg,
@@ -449,13 +504,27 @@ static inline ir_resources_t ir_resources_reserved_(const ir_graph *irg)
 static inline unsigned irg_register_node_idx(ir_graph *irg, ir_node *irn)
 {
 	unsigned idx = irg->last_node_idx++;
-	if (idx >= (unsigned)ARR_LEN(irg->idx_irn_map))
+	if (idx >= (unsigned)ARR_LEN(irg->idx_irn_map)) {
 		ARR_RESIZE(ir_node *, irg->idx_irn_map, idx + 1);
+		ARR_RESIZE(ir_visited_t, irg->visited_stamps, idx + 1);
+	}
 
-	irg->idx_irn_map[idx] = irn;
+	irg->idx_irn_map[idx]    = irn;
+	irg->visited_stamps[idx] = 0;
 	return idx;
 }
 
+/**
+ * Accumulates the size of @p mode into the graph's mode size mask.
+ * Called for every constructed node (and for Call result types whose
+ * value may never materialize as a node).
+ */
+static inline void irg_note_mode_size(ir_graph *irg, ir_mode const *mode)
+{
+	if (get_mode_arithmetic(mode) == irma_twos_complement)
+		irg->mode_size_mask |= get_mode_size_bits(mode);
+}
+
 /**
  * Kill a node from the irg. BEWARE: this kills
  * all later created nodes.
@@ -26,87 +26,178 @@
 #include "pset_new.h"
 #include <stdlib.h>
 
+/** A suspended node visit on the explicit walker stack. */
+typedef struct walk_frame_t {
+	ir_node *node;
+	int      pred; /**< next predecessor to visit, arity means the block */
+} walk_frame_t;
+
 /**
- * specialized version of irg_walk_2, called if only pre callback exists
+ * Returns the pooled frame stack of @p irg, allocating it on first use.
+ * Nested walks fall back to a private stack.
  */
-static void irg_walk_2_pre(ir_node *node, irg_walk_func *pre, void *env)
+static walk_frame_t *claim_walk_frames(ir_graph *irg, bool *pooled)
 {
-	ir_graph    *irg     = get_irn_irg(node);
-	ir_visited_t visited = irg->visited;
-
-	set_irn_visited(node, visited);
-
-	pre(node, env);
-
-	if (!is_Block(node)) {
-		ir_node *pred = get_nodes_block(node);
-		if (pred->visited < visited)
-			irg_walk_2_pre(pred, pre, env);
-	}
-	foreach_irn_in_r(node, i, pred) {
-		if (pred->visited < visited)
-			irg_walk_2_pre(pred, pre, env);
+	if (irg->walk_frames_busy) {
+		*pooled = false;
+		return NEW_ARR_F(walk_frame_t, 0);
 	}
+	if (irg->walk_frames == NULL)
+		irg->walk_frames = NEW_ARR_F(walk_frame_t, 0);
+	irg->walk_frames_busy = true;
+	*pooled = true;
+	return (walk_frame_t*)irg->walk_frames;
 }
 
-/**
- * specialized version of irg_walk_2, called if only post callback exists
- */
-static void irg_walk_2_post(ir_node *node, irg_walk_func *post, void *env)
+static void release_walk_frames(ir_graph *irg, walk_frame_t *frames,
+                                bool pooled)
 {
-	ir_graph    *irg     = get_irn_irg(node);
-	ir_visited_t visited = irg->visited;
-
-	set_irn_visited(node, visited);
-
-	if (!is_Block(node)) {
-		ir_node *pred = get_nodes_block(node);
-		if (pred->visited < visited)
-			irg_walk_2_post(pred, post, env);
-	}
-	foreach_irn_in_r(node, i, pred) {
-		if (pred->visited < visited)
-			irg_walk_2_post(pred, post, env);
+	if (pooled) {
+		/* keep the grown buffer for the next walk */
+		ARR_SHRINKLEN(frames, 0);
+		irg->walk_frames      = frames;
+		irg->walk_frames_busy = false;
+	} else {
+		DEL_ARR_F(frames);
 	}
-
-	post(node, env);
 }
 
 /**
- * specialized version of irg_walk_2, called if pre and post callbacks exist
+ * Iterative implementation of the graph walk: same visit order as the old
+ * recursive version, but immune to C-stack overflow on deeply chained
+ * graphs and reusing a pooled frame stack across walks.
  */
-static void irg_walk_2_both(ir_node *node, irg_walk_func *pre,
-                                irg_walk_func *post, void *env)
+void irg_walk_2(ir_node *node, irg_walk_func *pre, irg_walk_func *post,
+                void *env)
 {
 	ir_graph    *irg     = get_irn_irg(node);
 	ir_visited_t visited = irg->visited;
 
-	set_irn_visited(node, visited);
+	if (irn_visited(node))
+		return;
 
-	pre(node, env);
+	bool          pooled;
+	walk_frame_t *frames = claim_walk_frames(irg, &pooled);
 
-	if (!is_Block(node)) {
-		ir_node *pred = get_nodes_block(node);
-		if (pred->visited < visited)
-			irg_walk_2_both(pred, pre, post, env);
-	}
-	foreach_irn_in_r(node, i, pred) {
-		if (pred->visited < visited)
-			irg_walk_2_both(pred, pre, post, env);
+	/* beware: the callbacks may create new nodes, which reallocates the
+	 * stamp table, so it must be re-read at every access */
+	irg->visited_stamps[get_irn_idx(node)] = visited;
+	if (pre != NULL)
+		pre(node, env);
+	walk_frame_t frame = { node, get_irn_arity(node) };
+	ARR_APP1(walk_frame_t, frames, frame);
+
+	while (ARR_LEN(frames) > 0) {
+		walk_frame_t *top  = &frames[ARR_LEN(frames) - 1];
+		ir_node      *n    = top->node;
+		ir_node      *pred = NULL;
+
+		if (top->pred < 0) {
+			if (post != NULL)
+				post(n, env);
+			ARR_SHRINKLEN(frames, ARR_LEN(frames) - 1);
+			continue;
+		}
+
+		/* the callbacks may change the arity of pending nodes, so clamp
+		 * instead of trusting the index captured at push time */
+		int const arity = get_irn_arity(n);
+		if (top->pred >= arity) {
+			if (!is_Block(n))
+				pred = get_nodes_block(n);
+			top->pred = arity - 1;
+		} else {
+			pred = get_irn_n(n, top->pred);
+			--top->pred;
+		}
+
+		if (pred != NULL
+		 && irg->visited_stamps[get_irn_idx(pred)] < visited) {
+			irg->visited_stamps[get_irn_idx(pred)] = visited;
+			if (pre != NULL)
+				pre(pred, env);
+			walk_frame_t pred_frame = { pred, get_irn_arity(pred) };
+			ARR_APP1(walk_frame_t, frames, pred_frame);
+		}
 	}
 
-	post(node, env);
+	release_walk_frames(irg, frames, pooled);
 }
 
-void irg_walk_2(ir_node *node, irg_walk_func *pre, irg_walk_func *post,
-                void *env)
+/** A private visited epoch, decoupled from the shared per-graph counter. */
+struct ir_visited_map_t {
+	ir_graph     *irg;
+	ir_visited_t *stamps; /**< indexed by node index */
+	ir_visited_t  trip;   /**< current epoch, bumped per walk */
+};
+
+ir_visited_map_t *new_visited_map(ir_graph *irg)
 {
-	if (irn_visited(node))
+	ir_visited_map_t *map = XMALLOC(ir_visited_map_t);
+	map->irg    = irg;
+	map->stamps = XMALLOCNZ(ir_visited_t, get_irg_last_idx(irg));
+	map->trip   = 0;
+	return map;
+}
+
+void free_visited_map(ir_visited_map_t *map)
+{
+	free(map->stamps);
+	free(map);
+}
+
+void visited_map_walk(ir_visited_map_t *map, ir_node *node,
+                      irg_walk_func *pre, irg_walk_func *post, void *env)
+{
+	ir_visited_t const visited = ++map->trip;
+	ir_visited_t *const stamps = map->stamps;
+
+	assert(get_irn_irg(node) == map->irg);
+	if (stamps[get_irn_idx(node)] >= visited)
 		return;
 
-	if      (post == NULL) irg_walk_2_pre (node, pre, env);
-	else if (pre  == NULL) irg_walk_2_post(node, post, env);
-	else                   irg_walk_2_both(node, pre, post, env);
+	/* always use a private frame stack: concurrent walks on one graph
+	 * must not fight over the pooled one */
+	walk_frame_t *frames = NEW_ARR_F(walk_frame_t, 0);
+
+	stamps[get_irn_idx(node)] = visited;
+	if (pre != NULL)
+		pre(node, env);
+	walk_frame_t frame = { node, get_irn_arity(node) };
+	ARR_APP1(walk_frame_t, frames, frame);
+
+	while (ARR_LEN(frames) > 0) {
+		walk_frame_t *top  = &frames[ARR_LEN(frames) - 1];
+		ir_node      *n    = top->node;
+		ir_node      *pred = NULL;
+
+		if (top->pred < 0) {
+			if (post != NULL)
+				post(n, env);
+			ARR_SHRINKLEN(frames, ARR_LEN(frames) - 1);
+			continue;
+		}
+
+		int const arity = get_irn_arity(n);
+		if (top->pred >= arity) {
+			if (!is_Block(n))
+				pred = get_nodes_block(n);
+			top->pred = arity - 1;
+		} else {
+			pred = get_irn_n(n, top->pred);
+			--top->pred;
+		}
+
+		if (pred != NULL && stamps[get_irn_idx(pred)] < visited) {
+			stamps[get_irn_idx(pred)] = visited;
+			if (pre != NULL)
+				pre(pred, env);
+			walk_frame_t pred_frame = { pred, get_irn_arity(pred) };
+			ARR_APP1(walk_frame_t, frames, pred_frame);
+		}
+	}
+
+	DEL_ARR_F(frames);
 }
 
 void irg_walk_core(ir_node *node, irg_walk_func *pre, irg_walk_func *post,
@@ -148,17 +239,19 @@ static void irg_walk_in_or_dep_2_pre(ir_node *node, irg_walk_func *pre,
 	ir_graph    *irg     = get_irn_irg(node);
 	ir_visited_t visited = irg->visited;
 
-	set_irn_visited(node, visited);
+	/* beware: the callbacks may create new nodes, which reallocates the
+	 * stamp table, so it must be re-read at every access */
+	irg->visited_stamps[get_irn_idx(node)] = visited;
 
 	pre(node, env);
 
 	if (!is_Block(node)) {
 		ir_node *pred = get_nodes_block(node);
-		if (pred->visited < visited)
+		if (irg->visited_stamps[get_irn_idx(pred)] < visited)
 			irg_walk_in_or_dep_2_pre(pred, pre, env);
 	}
 	foreach_irn_in_r(node, i, pred) {
-		if (pred->visited < visited)
+		if (irg->visited_stamps[get_irn_idx(pred)] < visited)
 			irg_walk_in_or_dep_2_pre(pred, pre, env);
 	}
 }
@@ -172,15 +265,17 @@ static void irg_walk_in_or_dep_2_post(ir_node *node, irg_walk_func *post,
 	ir_graph    *irg     = get_irn_irg(node);
 	ir_visited_t visited = irg->visited;
 
-	set_irn_visited(node, visited);
+	/* beware: the callbacks may create new nodes, which reallocates the
+	 * stamp table, so it must be re-read at every access */
+	irg->visited_stamps[get_irn_idx(node)] = visited;
 
 	if (!is_Block(node)) {
 		ir_node *pred = get_nodes_block(node);
-		if (pred->visited < visited)
+		if (irg->visited_stamps[get_irn_idx(pred)] < visited)
 			irg_walk_in_or_dep_2_post(pred, post, env);
 	}
 	foreach_irn_in_r(node, i, pred) {
-		if (pred->visited < visited)
+		if (irg->visited_stamps[get_irn_idx(pred)] < visited)
 			irg_walk_in_or_dep_2_post(pred, post, env);
 	}
 
@@ -196,17 +291,19 @@ static void irg_walk_in_or_dep_2_both(ir_node *node, irg_walk_func *pre,
 	ir_graph    *irg     = get_irn_irg(node);
 	ir_visited_t visited = irg->visited;
 
-	set_irn_visited(node, visited);
+	/* beware: the callbacks may create new nodes, which reallocates the
+	 * stamp table, so it must be re-read at every access */
+	irg->visited_stamps[get_irn_idx(node)] = visited;
 
 	pre(node, env);
 
 	if (!is_Block(node)) {
 		ir_node *pred = get_nodes_block(node);
-		if (pred->visited < visited)
+		if (irg->visited_stamps[get_irn_idx(pred)] < visited)
 			irg_walk_in_or_dep_2_both(pred, pre, post, env);
 	}
 	foreach_irn_in_r(node, i, pred) {
-		if (pred->visited < visited)
+		if (irg->visited_stamps[get_irn_idx(pred)] < visited)
 			irg_walk_in_or_dep_2_both(pred, pre, post, env);
 	}
 
@@ -11,9 +11,26 @@
 #include "irhooks.h"
 
 #include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
 
 hook_entry_t *hooks[hook_last];
 
+unsigned hooks_active_mask;
+
+/** A queued node event waiting for batched delivery. */
+typedef struct hook_event_t {
+	hook_type_t kind;   /**< hook_new_node or hook_replace */
+	ir_node    *node;   /**< the (old) node */
+	ir_node    *other;  /**< the replacement for hook_replace, else NULL */
+} hook_event_t;
+
+#define HOOK_EVENT_QUEUE_SIZE 256
+
+static hook_event_t hook_event_queue[HOOK_EVENT_QUEUE_SIZE];
+static size_t       n_queued_events;
+static bool         hook_batching;
+
 void register_hook(hook_type_t hook, hook_entry_t *entry)
 {
 	/* check if a hook function is specified. It's a union, so no matter which one */
@@ -25,10 +42,14 @@ void register_hook(hook_type_t hook, hook_entry_t *entry)
 
 	entry->next = hooks[hook];
 	hooks[hook] = entry;
+	hooks_active_mask |= 1u << hook;
 }
 
 void unregister_hook(hook_type_t hook, hook_entry_t *entry)
 {
+	/* events queued for this entry must still reach it */
+	hook_flush_events();
+
 	for (hook_entry_t **p = &hooks[hook]; *p; p = &(*p)->next) {
 		if (*p == entry) {
 			*p          = entry->next;
@@ -36,4 +57,50 @@ void unregister_hook(hook_type_t hook, hook_entry_t *entry)
 			break;
 		}
 	}
+	if (hooks[hook] == NULL)
+		hooks_active_mask &= ~(1u << hook);
+}
+
+static void dispatch_node_event(hook_type_t kind, ir_node *node,
+                                ir_node *other)
+{
+	for (hook_entry_t *p = hooks[kind]; p; p = p->next) {
+		void *context = p->context;
+		if (kind == hook_new_node) {
+			p->hook._hook_new_node(context, node);
+		} else {
+			p->hook._hook_replace(context, node, other);
+		}
+	}
+}
+
+void hook_flush_events(void)
+{
+	for (size_t i = 0; i < n_queued_events; ++i) {
+		hook_event_t *event = &hook_event_queue[i];
+		dispatch_node_event(event->kind, event->node, event->other);
+	}
+	n_queued_events = 0;
+}
+
+void hook_node_event(hook_type_t kind, ir_node *node, ir_node *other)
+{
+	assert(kind == hook_new_node || kind == hook_replace);
+	if (!hook_batching) {
+		dispatch_node_event(kind, node, other);
+		return;
+	}
+	if (n_queued_events == HOOK_EVENT_QUEUE_SIZE)
+		hook_flush_events();
+	hook_event_queue[n_queued_events].kind  = kind;
+	hook_event_queue[n_queued_events].node  = node;
+	hook_event_queue[n_queued_events].other = other;
+	++n_queued_events;
+}
+
+void hook_set_batching(int enable)
+{
+	if (!enable)
+		hook_flush_events();
+	hook_batching = enable != 0;
 }
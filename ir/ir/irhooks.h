@@ -92,22 +92,68 @@ void unregister_hook(hook_type_t hook, hook_entry_t *entry);
 /** Global list of registerd hooks. */
 extern hook_entry_t *hooks[hook_last];
 
+/** Bitmask with a bit set for every hook type that has registered
+ * entries.  Testing it costs a single load, so call sites on hot paths
+ * do not have to chase the hook lists when nothing is registered. */
+extern unsigned hooks_active_mask;
+
+/**
+ * Delivers a node event (hook_new_node or hook_replace), either
+ * immediately or via the batch queue when batching is enabled.
+ * Do not call this directly, use the hook_new_node()/hook_replace()
+ * macros.
+ */
+void hook_node_event(hook_type_t kind, ir_node *node, ir_node *other);
+
+/**
+ * Enables or disables batched hook dispatch for the node events.  While
+ * enabled, hook_new_node()/hook_replace() events are queued and replayed
+ * in order when the queue fills up or hook_flush_events() is called.
+ * Only enable this for consumers that tolerate deferred delivery (e.g.
+ * counting statistics); queued nodes must still be alive at flush time.
+ */
+void hook_set_batching(int enable);
+
+/** Delivers all queued node events now. */
+void hook_flush_events(void);
+
+#ifdef NO_LIBFIRM_HOOKS
+/*
+ * Instrumentation is compiled out: every hook_* macro expands to
+ * nothing and registered hooks never fire.
+ */
+#define hook_exec(what, args)             ((void)0)
+
+/** Called after a new node has been created */
+#define hook_new_node(node)               ((void)0)
+/** Called when a node is replaced */
+#define hook_replace(old, nw)             ((void)0)
+#else
 /**
  * Executes the hook @p what with the args @p args
  * Do not use this macro directly.
  */
-#define hook_exec(what, args) do {             \
-	hook_entry_t *_p;                          \
-	for (_p = hooks[what]; _p; _p = _p->next){ \
-		void *hook_ctx_ = _p->context;         \
-		_p->hook._##what args;                 \
-	}                                          \
+#define hook_exec(what, args) do {                 \
+	if (hooks_active_mask & (1u << (what))) {      \
+		hook_entry_t *_p;                          \
+		for (_p = hooks[what]; _p; _p = _p->next){ \
+			void *hook_ctx_ = _p->context;         \
+			_p->hook._##what args;                 \
+		}                                          \
+	}                                              \
 } while (0)
 
 /** Called after a new node has been created */
-#define hook_new_node(node)               hook_exec(hook_new_node, (hook_ctx_, node))
+#define hook_new_node(node) do {                   \
+	if (hooks_active_mask & (1u << hook_new_node)) \
+		hook_node_event(hook_new_node, (node), NULL); \
+} while (0)
 /** Called when a node is replaced */
-#define hook_replace(old, nw)             hook_exec(hook_replace, (hook_ctx_, old, nw))
+#define hook_replace(old, nw) do {                 \
+	if (hooks_active_mask & (1u << hook_replace))  \
+		hook_node_event(hook_replace, (old), (nw)); \
+} while (0)
+#endif
 /** Called after a new graph has been created */
 #define hook_new_graph(irg, ent)          hook_exec(hook_new_graph, (hook_ctx_, irg, ent))
 /** Called before a node gets lowered */
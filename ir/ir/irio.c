@@ -10,7 +10,10 @@
  */
 #include "irio_t.h"
 
+#include "analyze_irg_args_t.h"
 #include "array.h"
+#include "dbginfo.h"
+#include "ident_t.h"
 #include "ircons_t.h"
 #include "irflag_t.h"
 #include "irgmod.h"
@@ -28,6 +31,12 @@
 #include <stdbool.h>
 #include <string.h>
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #define SYMERROR ((unsigned) ~0)
 
 typedef enum typetag_t {
@@ -68,6 +77,7 @@ typedef enum keyword_t {
 	kw_type,
 	kw_typegraph,
 	kw_unknown,
+	kw_vector_mode,
 } keyword_t;
 
 typedef struct symbol_t {
@@ -219,6 +229,7 @@ static void symtbl_init(void)
 	INSERTKEYWORD(type);
 	INSERTKEYWORD(typegraph);
 	INSERTKEYWORD(unknown);
+	INSERTKEYWORD(vector_mode);
 
 	INSERTENUM(tt_align, align_non_aligned);
 	INSERTENUM(tt_align, align_is_aligned);
@@ -318,30 +329,70 @@ static unsigned symbol(const char *str, typetag_t typetag)
 	return entry ? entry->code : SYMERROR;
 }
 
+/** Size of the output buffer, flushed to the FILE when full. */
+#define OUT_BUFFER_SIZE (1u << 20)
+
+static void flush_output(write_env_t *env)
+{
+	if (env->out_used == 0)
+		return;
+	fwrite(env->out, 1, env->out_used, env->file);
+	env->out_used = 0;
+}
+
+static void write_raw(write_env_t *env, const char *data, size_t len)
+{
+	if (env->out_used + len > OUT_BUFFER_SIZE) {
+		flush_output(env);
+		if (len > OUT_BUFFER_SIZE) {
+			fwrite(data, 1, len, env->file);
+			return;
+		}
+	}
+	memcpy(env->out + env->out_used, data, len);
+	env->out_used += len;
+}
+
+static void write_raw_string(write_env_t *env, const char *string)
+{
+	write_raw(env, string, strlen(string));
+}
+
+static void write_raw_char(write_env_t *env, char c)
+{
+	if (env->out_used == OUT_BUFFER_SIZE)
+		flush_output(env);
+	env->out[env->out_used++] = c;
+}
+
 void write_long(write_env_t *env, long value)
 {
-	fprintf(env->file, "%ld ", value);
+	char buf[32];
+	write_raw(env, buf, snprintf(buf, sizeof(buf), "%ld ", value));
 }
 
 void write_int(write_env_t *env, int value)
 {
-	fprintf(env->file, "%d ", value);
+	char buf[32];
+	write_raw(env, buf, snprintf(buf, sizeof(buf), "%d ", value));
 }
 
 void write_unsigned(write_env_t *env, unsigned value)
 {
-	fprintf(env->file, "%u ", value);
+	char buf[32];
+	write_raw(env, buf, snprintf(buf, sizeof(buf), "%u ", value));
 }
 
 void write_size_t(write_env_t *env, size_t value)
 {
-	ir_fprintf(env->file, "%zu ", value);
+	char buf[32];
+	write_raw(env, buf, ir_snprintf(buf, sizeof(buf), "%zu ", value));
 }
 
 void write_symbol(write_env_t *env, const char *symbol)
 {
-	fputs(symbol, env->file);
-	fputc(' ', env->file);
+	write_raw_string(env, symbol);
+	write_raw_char(env, ' ');
 }
 
 void write_entity_ref(write_env_t *env, ir_entity *entity)
@@ -366,35 +417,62 @@ void write_type_ref(write_env_t *env, ir_type *type)
 
 void write_string(write_env_t *env, const char *string)
 {
-	fputc('"', env->file);
+	write_raw_char(env, '"');
 	for (const char *c = string; *c != '\0'; ++c) {
 		switch (*c) {
 		case '\n':
-			fputc('\\', env->file);
-			fputc('n', env->file);
+			write_raw_char(env, '\\');
+			write_raw_char(env, 'n');
 			break;
 		case '"':
 		case '\\':
-			fputc('\\', env->file);
+			write_raw_char(env, '\\');
 			/* FALLTHROUGH */
 		default:
-			fputc(*c, env->file);
+			write_raw_char(env, *c);
 			break;
 		}
 	}
-	fputc('"', env->file);
-	fputc(' ', env->file);
+	write_raw_char(env, '"');
+	write_raw_char(env, ' ');
 }
 
 void write_ident(write_env_t *env, ident *id)
 {
-	write_string(env, get_id_str(id));
+	/* Idents repeat a lot (mode references alone emit their name for
+	 * every tarval); escape each one only once and replay the quoted
+	 * form afterwards. */
+	char *escaped = pmap_get(char, env->escaped_idents, id);
+	if (escaped == NULL) {
+		obstack_1grow(&env->obst, '"');
+		for (const char *c = get_id_str(id); *c != '\0'; ++c) {
+			switch (*c) {
+			case '\n':
+				obstack_1grow(&env->obst, '\\');
+				obstack_1grow(&env->obst, 'n');
+				break;
+			case '"':
+			case '\\':
+				obstack_1grow(&env->obst, '\\');
+				/* FALLTHROUGH */
+			default:
+				obstack_1grow(&env->obst, *c);
+				break;
+			}
+		}
+		obstack_1grow(&env->obst, '"');
+		obstack_1grow(&env->obst, ' ');
+		obstack_1grow(&env->obst, '\0');
+		escaped = (char*)obstack_finish(&env->obst);
+		pmap_insert(env->escaped_idents, id, escaped);
+	}
+	write_raw_string(env, escaped);
 }
 
 void write_ident_null(write_env_t *env, ident *id)
 {
 	if (id == NULL) {
-		fputs("NULL ", env->file);
+		write_raw_string(env, "NULL ");
 	} else {
 		write_ident(env, id);
 	}
@@ -402,7 +480,7 @@ void write_ident_null(write_env_t *env, ident *id)
 
 void write_mode_ref(write_env_t *env, ir_mode *mode)
 {
-	write_string(env, get_mode_name(mode));
+	write_ident(env, get_mode_ident(mode));
 }
 
 void write_tarval_ref(write_env_t *env, ir_tarval *tv)
@@ -411,26 +489,22 @@ void write_tarval_ref(write_env_t *env, ir_tarval *tv)
 	write_mode_ref(env, mode);
 	char buf[128];
 	const char *ascii = ir_tarval_to_ascii(buf, sizeof(buf), tv);
-	fputs(ascii, env->file);
-	fputc(' ', env->file);
+	write_symbol(env, ascii);
 }
 
 void write_align(write_env_t *env, ir_align align)
 {
-	fputs(get_align_name(align), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_align_name(align));
 }
 
 void write_builtin_kind(write_env_t *env, ir_builtin_kind kind)
 {
-	fputs(get_builtin_kind_name(kind), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_builtin_kind_name(kind));
 }
 
 void write_cond_jmp_predicate(write_env_t *env, cond_jmp_predicate pred)
 {
-	fputs(get_cond_jmp_predicate_name(pred), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_cond_jmp_predicate_name(pred));
 }
 
 void write_relation(write_env_t *env, ir_relation relation)
@@ -450,22 +524,22 @@ void write_loop(write_env_t *env, bool loop)
 
 static void write_list_begin(write_env_t *env)
 {
-	fputs("[", env->file);
+	write_raw_char(env, '[');
 }
 
 static void write_list_end(write_env_t *env)
 {
-	fputs("] ", env->file);
+	write_raw_string(env, "] ");
 }
 
 static void write_scope_begin(write_env_t *env)
 {
-	fputs("{\n", env->file);
+	write_raw_string(env, "{\n");
 }
 
 static void write_scope_end(write_env_t *env)
 {
-	fputs("}\n\n", env->file);
+	write_raw_string(env, "}\n\n");
 }
 
 void write_node_ref(write_env_t *env, const ir_node *node)
@@ -476,11 +550,9 @@ void write_node_ref(write_env_t *env, const ir_node *node)
 void write_initializer(write_env_t *const env,
                        ir_initializer_t const *const ini)
 {
-	FILE *f = env->file;
 	ir_initializer_kind_t ini_kind = get_initializer_kind(ini);
 
-	fputs(get_initializer_kind_name(ini_kind), f);
-	fputc(' ', f);
+	write_symbol(env, get_initializer_kind_name(ini_kind));
 
 	switch (ini_kind) {
 	case IR_INITIALIZER_CONST:
@@ -507,37 +579,32 @@ void write_initializer(write_env_t *const env,
 
 void write_pin_state(write_env_t *env, op_pin_state state)
 {
-	fputs(get_op_pin_state_name(state), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_op_pin_state_name(state));
 }
 
 void write_volatility(write_env_t *env, ir_volatility vol)
 {
-	fputs(get_volatility_name(vol), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_volatility_name(vol));
 }
 
 static void write_type_state(write_env_t *env, ir_type_state state)
 {
-	fputs(get_type_state_name(state), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_type_state_name(state));
 }
 
 void write_visibility(write_env_t *env, ir_visibility visibility)
 {
-	fputs(get_visibility_name(visibility), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_visibility_name(visibility));
 }
 
 static void write_mode_arithmetic(write_env_t *env, ir_mode_arithmetic arithmetic)
 {
-	fputs(get_mode_arithmetic_name(arithmetic), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_mode_arithmetic_name(arithmetic));
 }
 
 static void write_type_common(write_env_t *env, ir_type *tp)
 {
-	fputc('\t', env->file);
+	write_raw_char(env, '\t');
 	write_symbol(env, "type");
 	write_long(env, get_type_nr(tp));
 	write_symbol(env, get_type_opcode_name(get_type_opcode(tp)));
@@ -552,7 +619,7 @@ static void write_type(write_env_t *env, ir_type *tp);
 static bool is_internal_mode(ir_mode *mode)
 {
 	return !mode_is_int(mode) && !mode_is_reference(mode)
-	    && !mode_is_float(mode);
+	    && !mode_is_float(mode) && !mode_is_vector(mode);
 }
 
 static bool is_default_mode(ir_mode *mode)
@@ -571,7 +638,7 @@ static void write_type_primitive(write_env_t *env, ir_type *tp)
 
 	write_type_common(env, tp);
 	write_mode_ref(env, mode);
-	fputc('\n', env->file);
+	write_raw_char(env, '\n');
 }
 
 static void write_type_compound(write_env_t *env, ir_type *tp)
@@ -585,7 +652,7 @@ static void write_type_compound(write_env_t *env, ir_type *tp)
 	}
 	write_type_common(env, tp);
 	write_ident_null(env, get_compound_ident(tp));
-	fputc('\n', env->file);
+	write_raw_char(env, '\n');
 
 	for (size_t i = 0, n = get_compound_n_members(tp); i < n; ++i) {
 		ir_entity *member = get_compound_member(tp, i);
@@ -601,7 +668,7 @@ static void write_type_array(write_env_t *env, ir_type *tp)
 	write_type_common(env, tp);
 	write_type_ref(env, element_type);
 	write_unsigned(env, get_array_size(tp));
-	fputc('\n', env->file);
+	write_raw_char(env, '\n');
 }
 
 static void write_type_method(write_env_t *env, ir_type *tp)
@@ -623,7 +690,7 @@ static void write_type_method(write_env_t *env, ir_type *tp)
 		write_type_ref(env, get_method_param_type(tp, i));
 	for (size_t i = 0; i < nresults; i++)
 		write_type_ref(env, get_method_res_type(tp, i));
-	fputc('\n', env->file);
+	write_raw_char(env, '\n');
 }
 
 static void write_type_pointer(write_env_t *env, ir_type *tp)
@@ -634,7 +701,7 @@ static void write_type_pointer(write_env_t *env, ir_type *tp)
 
 	write_type_common(env, tp);
 	write_type_ref(env, points_to);
-	fputc('\n', env->file);
+	write_raw_char(env, '\n');
 }
 
 static void write_type(write_env_t *env, ir_type *tp)
@@ -683,7 +750,7 @@ static void write_entity(write_env_t *env, ir_entity *ent)
 		write_entity(env, aliased);
 	}
 
-	fputc('\t', env->file);
+	write_raw_char(env, '\t');
 	switch ((ir_entity_kind)ent->kind) {
 	case IR_ENTITY_ALIAS:           write_symbol(env, "alias");           break;
 	case IR_ENTITY_NORMAL:          write_symbol(env, "entity");          break;
@@ -763,6 +830,27 @@ static void write_entity(write_env_t *env, ir_entity *ent)
 	}
 	case IR_ENTITY_METHOD:
 		write_long(env, (long)get_entity_additional_properties(ent));
+		/* Cached parameter summaries (see analyze_irg_args) are optional,
+		 * readers detect their presence by the leading '['. */
+		if (ent->attr.mtd_attr.param_access != NULL
+		 || ent->attr.mtd_attr.param_weight != NULL) {
+			ptr_access_kind const *const accesses
+				= ent->attr.mtd_attr.param_access;
+			unsigned        const *const weights
+				= ent->attr.mtd_attr.param_weight;
+			write_list_begin(env);
+			for (size_t i = 0,
+			     n = accesses != NULL ? ARR_LEN(accesses) : 0; i < n; ++i) {
+				write_unsigned(env, (unsigned)accesses[i]);
+			}
+			write_list_end(env);
+			write_list_begin(env);
+			for (size_t i = 0,
+			     n = weights != NULL ? ARR_LEN(weights) : 0; i < n; ++i) {
+				write_unsigned(env, weights[i]);
+			}
+			write_list_end(env);
+		}
 		break;
 	case IR_ENTITY_UNKNOWN:
 	case IR_ENTITY_LABEL:
@@ -771,7 +859,7 @@ static void write_entity(write_env_t *env, ir_entity *ent)
 	}
 
 end_line:
-	fputc('\n', env->file);
+	write_raw_char(env, '\n');
 }
 
 void write_switch_table_ref(write_env_t *env, const ir_switch_table *table)
@@ -890,11 +978,22 @@ static void write_node(const ir_node *node, write_env_t *env)
 	ir_op           *const op   = get_irn_op(node);
 	write_node_func *const func = get_generic_function_ptr(write_node_func, op);
 
-	fputc('\t', env->file);
+	write_raw_char(env, '\t');
+	/* an optional location directive precedes the node it belongs to */
+	dbg_info *const dbgi = get_irn_dbg_info(node);
+	if (dbgi != NULL) {
+		src_loc_t const loc = ir_retrieve_dbg_info(dbgi);
+		if (loc.file != NULL && *loc.file != '\0') {
+			write_symbol(env, "dbgloc");
+			write_unsigned(env, loc.line);
+			write_unsigned(env, loc.column);
+			write_string(env, loc.file);
+		}
+	}
 	if (func == NULL)
 		panic("no write_node_func for %+F", node);
 	func(env, node);
-	fputc('\n', env->file);
+	write_raw_char(env, '\n');
 }
 
 static void write_node_recursive(ir_node *node, write_env_t *env);
@@ -957,6 +1056,11 @@ static void write_mode(write_env_t *env, ir_mode *mode)
 		write_unsigned(env, get_mode_exponent_size(mode));
 		write_unsigned(env, get_mode_mantissa_size(mode));
 		write_unsigned(env, get_mode_float_int_overflow(mode));
+	} else if (mode_is_vector(mode)) {
+		/* the lane mode precedes the vector mode in the mode list */
+		write_symbol(env, "vector_mode");
+		write_mode_ref(env, get_mode_lane_mode(mode));
+		write_unsigned(env, get_mode_n_lanes(mode));
 	} else {
 		panic("cannot write internal modes");
 	}
@@ -965,18 +1069,18 @@ static void write_mode(write_env_t *env, ir_mode *mode)
 static void write_modes(write_env_t *env)
 {
 	write_symbol(env, "modes");
-	fputs("{\n", env->file);
+	write_raw_string(env, "{\n");
 
 	for (size_t i = 0, n_modes = ir_get_n_modes(); i < n_modes; i++) {
 		ir_mode *mode = ir_get_mode(i);
 		if (is_internal_mode(mode))
 			continue;
-		fputc('\t', env->file);
+		write_raw_char(env, '\t');
 		write_mode(env, mode);
-		fputc('\n', env->file);
+		write_raw_char(env, '\n');
 	}
 
-	fputs("}\n\n", env->file);
+	write_raw_string(env, "}\n\n");
 }
 
 static void write_program(write_env_t *env)
@@ -984,15 +1088,15 @@ static void write_program(write_env_t *env)
 	write_symbol(env, "program");
 	write_scope_begin(env);
 	if (irp_prog_name_is_set()) {
-		fputc('\t', env->file);
+		write_raw_char(env, '\t');
 		write_symbol(env, "name");
 		write_string(env, get_irp_name());
-		fputc('\n', env->file);
+		write_raw_char(env, '\n');
 	}
 
 	for (ir_segment_t s = IR_SEGMENT_FIRST; s <= IR_SEGMENT_LAST; ++s) {
 		ir_type *segment_type = get_segment_type(s);
-		fputc('\t', env->file);
+		write_raw_char(env, '\t');
 		write_symbol(env, "segment_type");
 		write_symbol(env, get_segment_name(s));
 		if (segment_type == NULL) {
@@ -1000,15 +1104,15 @@ static void write_program(write_env_t *env)
 		} else {
 			write_type_ref(env, segment_type);
 		}
-		fputc('\n', env->file);
+		write_raw_char(env, '\n');
 	}
 
 	for (size_t i = 0, n_asms = get_irp_n_asms(); i < n_asms; ++i) {
 		ident *asm_text = get_irp_asm(i);
-		fputc('\t', env->file);
+		write_raw_char(env, '\t');
 		write_symbol(env, "asm");
 		write_ident(env, asm_text);
-		fputc('\n', env->file);
+		write_raw_char(env, '\n');
 	}
 	write_scope_end(env);
 }
@@ -1021,7 +1125,6 @@ int ir_export(const char *filename)
 		perror(filename);
 		return 1;
 	}
-
 	ir_export_file(file);
 	res = ferror(file);
 	fclose(file);
@@ -1079,7 +1182,10 @@ void ir_export_file(FILE *file)
 	write_env_t *env = &my_env;
 
 	memset(env, 0, sizeof(*env));
-	env->file         = file;
+	env->file           = file;
+	env->out            = XMALLOCN(char, OUT_BUFFER_SIZE);
+	env->escaped_idents = pmap_create();
+	obstack_init(&env->obst);
 	deq_init(&env->write_queue);
 	deq_init(&env->entity_queue);
 
@@ -1100,20 +1206,84 @@ void ir_export_file(FILE *file)
 
 	write_program(env);
 
+	flush_output(env);
 	deq_free(&env->entity_queue);
 	deq_free(&env->write_queue);
+	obstack_free(&env->obst, NULL);
+	pmap_destroy(env->escaped_idents);
+	free(env->out);
 }
 
 
 
 static void read_c(read_env_t *env)
 {
-	int c = fgetc(env->file);
+	int c = env->pos < env->end ? (unsigned char)*env->pos++ : EOF;
 	env->c = c;
 	if (c == '\n')
 		env->line++;
 }
 
+/**
+ * Makes the whole input available in memory: maps the file if possible,
+ * otherwise reads it into a malloced buffer.  Lexing from memory avoids a
+ * libc call per character and any copying on the mmap path.
+ */
+static bool slurp_input(read_env_t *env, FILE *input)
+{
+	env->mapped = false;
+#ifndef _WIN32
+	struct stat st;
+	int const   fd = fileno(input);
+	if (fd >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode)
+	 && st.st_size > 0) {
+		void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE,
+		                 fd, 0);
+		if (map != MAP_FAILED) {
+			env->buf    = (const char*)map;
+			env->end    = env->buf + st.st_size;
+			env->mapped = true;
+			goto done;
+		}
+	}
+#endif
+	{
+		size_t capacity = 1 << 16;
+		size_t size     = 0;
+		char  *buf      = XMALLOCN(char, capacity);
+		for (;;) {
+			size_t got = fread(buf + size, 1, capacity - size, input);
+			size += got;
+			if (size < capacity)
+				break;
+			capacity *= 2;
+			buf = XREALLOC(buf, char, capacity);
+		}
+		if (ferror(input)) {
+			free(buf);
+			return false;
+		}
+		env->buf = buf;
+		env->end = buf + size;
+	}
+#ifndef _WIN32
+done:
+#endif
+	env->pos = env->buf;
+	return true;
+}
+
+static void release_input(read_env_t *env)
+{
+#ifndef _WIN32
+	if (env->mapped) {
+		munmap((void*)env->buf, (size_t)(env->end - env->buf));
+		return;
+	}
+#endif
+	free((void*)env->buf);
+}
+
 /** Returns the first non-whitespace character or EOF. **/
 static void skip_ws(read_env_t *env)
 {
@@ -1318,7 +1488,7 @@ static void expect_list_begin(read_env_t *env)
 
 static bool list_has_next(read_env_t *env)
 {
-	if (feof(env->file)) {
+	if (env->c == EOF) {
 		parse_error(env, "Unexpected EOF while reading list");
 		exit(1);
 	}
@@ -1392,7 +1562,7 @@ ir_type *read_type_ref(read_env_t *env)
 
 static ir_entity *create_error_entity(void)
 {
-	ir_entity *res = new_entity(get_glob_type(), new_id_from_str("error"),
+	ir_entity *res = new_entity(get_glob_type(), id_error,
 	                            get_unknown_type());
 	return res;
 }
@@ -1846,6 +2016,34 @@ skip_init:
 			set_entity_ld_ident(entity, ld_name);
 		add_entity_additional_properties(
 			entity, (mtp_additional_properties) read_long(env));
+		/* Older files lack the parameter summary lists, so peek for them. */
+		skip_ws(env);
+		if (env->c == '[') {
+			ptr_access_kind *accesses = NEW_ARR_F(ptr_access_kind, 0);
+			unsigned        *weights  = NEW_ARR_F(unsigned, 0);
+			expect_list_begin(env);
+			while (list_has_next(env)) {
+				ARR_APP1(ptr_access_kind, accesses,
+				         (ptr_access_kind)read_unsigned(env));
+			}
+			expect_list_begin(env);
+			while (list_has_next(env)) {
+				ARR_APP1(unsigned, weights, read_unsigned(env));
+			}
+			if (ARR_LEN(accesses) > 0) {
+				entity->attr.mtd_attr.param_access = accesses;
+			} else {
+				DEL_ARR_F(accesses);
+			}
+			if (ARR_LEN(weights) > 0) {
+				entity->attr.mtd_attr.param_weight = weights;
+			} else {
+				DEL_ARR_F(weights);
+			}
+			if (entity->attr.mtd_attr.param_access != NULL
+			 || entity->attr.mtd_attr.param_weight != NULL)
+				firm_register_arg_summary_invalidation();
+		}
 		break;
 	case IR_ENTITY_PARAMETER: {
 		char  *str = read_word(env);
@@ -2059,7 +2257,19 @@ void register_node_reader(char const *const name, read_node_func *const func)
 
 static ir_node *read_node(read_env_t *env)
 {
-	ident          *id   = read_symbol(env);
+	ident *id = read_symbol(env);
+
+	/* an optional location directive precedes the node it belongs to */
+	dbg_info *dbgi = NULL;
+	if (streq(get_id_str(id), "dbgloc")) {
+		unsigned const line   = read_unsigned(env);
+		unsigned const column = read_unsigned(env);
+		char          *file   = read_string(env);
+		dbgi = ir_dbg_info_intern(file, line, column);
+		obstack_free(&env->obst, file);
+		id = read_symbol(env);
+	}
+
 	read_node_func *func = pmap_get(read_node_func, node_readers, id);
 	long            nr   = read_long(env);
 	ir_node        *res;
@@ -2070,6 +2280,8 @@ static ir_node *read_node(read_env_t *env)
 	} else {
 		res = func(env);
 	}
+	if (dbgi != NULL)
+		set_irn_dbg_info(res, dbgi);
 	set_id(env, nr, res);
 	return res;
 }
@@ -2128,18 +2340,91 @@ next_delayed_pred: ;
 	env->delayed_preds = NULL;
 }
 
-static ir_graph *read_irg(read_env_t *env)
+/** A function body whose parsing was postponed by ir_import_lazy(). */
+typedef struct deferred_body_t {
+	lazy_import_t *import; /**< the import the body stems from */
+	ir_entity     *entity; /**< the method entity of the body */
+	ir_type       *frame;  /**< the already parsed frame type */
+	const char    *pos;    /**< reader position of the body */
+	int            c;      /**< current character at that position */
+	unsigned       line;   /**< line number at that position */
+} deferred_body_t;
+
+/** The reader state of a lazily imported file, retained until all of
+ * its deferred bodies have been materialized. */
+struct lazy_import_t {
+	read_env_t env;
+	size_t     n_deferred; /**< bodies not materialized yet */
+};
+
+/** Maps method entities to their not yet materialized body. */
+static pmap *deferred_bodies;
+
+/**
+ * Skips a braced graph body without interpreting it.  Strings are
+ * skipped as a whole so braces inside them do not count as structure.
+ */
+static void skip_graph_body(read_env_t *env)
+{
+	EXPECT('{');
+	unsigned depth = 1;
+	while (depth > 0) {
+		if (env->c == EOF) {
+			parse_error(env, "Unexpected EOF while skipping a graph\n");
+			exit(1);
+		}
+		if (env->c == '{') {
+			++depth;
+		} else if (env->c == '}') {
+			--depth;
+		} else if (env->c == '"') {
+			do {
+				read_c(env);
+				if (env->c == '\\')
+					read_c(env);
+			} while (env->c != '"' && env->c != EOF);
+		}
+		read_c(env);
+	}
+}
+
+/** Records the reader position of a graph body and skips over it. */
+static void defer_graph_body(read_env_t *env, ir_entity *entity,
+                             ir_type *frame)
 {
-	ir_entity *irgent    = get_entity(env, read_long(env));
-	ir_graph  *irg       = new_ir_graph(irgent, 0);
-	ir_type   *frame     = read_type_ref(env);
-	ir_type   *old_frame = get_irg_frame_type(irg);
+	skip_ws(env);
+
+	deferred_body_t *const body = XMALLOCZ(deferred_body_t);
+	body->import = env->lazy_import;
+	body->entity = entity;
+	body->frame  = frame;
+	body->pos    = env->pos;
+	body->c      = env->c;
+	body->line   = env->line;
+
+	if (deferred_bodies == NULL)
+		deferred_bodies = pmap_create();
+	pmap_insert(deferred_bodies, entity, body);
+	++env->lazy_import->n_deferred;
+
+	skip_graph_body(env);
+}
+
+static void read_irg(read_env_t *env)
+{
+	ir_entity *irgent = get_entity(env, read_long(env));
+	ir_type   *frame  = read_type_ref(env);
+	if (env->lazy_import != NULL) {
+		defer_graph_body(env, irgent, frame);
+		return;
+	}
+	ir_graph *irg       = new_ir_graph(irgent, 0);
+	ir_type  *old_frame = get_irg_frame_type(irg);
 	set_irg_frame_type(irg, frame);
 	// Free the old frame type in order to retain idempotency
 	free_type(old_frame);
 	read_graph(env, irg);
 	irg_finalize_cons(irg);
-	return irg;
 }
 
 static void read_modes(read_env_t *env)
@@ -2193,6 +2478,12 @@ static void read_modes(read_env_t *env)
 			               overflow);
 			break;
 		}
+		case kw_vector_mode: {
+			ir_mode *lane_mode = read_mode_ref(env);
+			unsigned n_lanes   = read_long(env);
+			new_vector_mode(lane_mode, n_lanes);
+			break;
+		}
 
 		default:
 			skip_to(env, '\n');
@@ -2245,23 +2536,23 @@ int ir_import(const char *filename)
 	return res;
 }
 
-int ir_import_file(FILE *input, const char *inputname)
+static int import_file(read_env_t *env, FILE *input, const char *inputname)
 {
-	read_env_t          myenv;
-	int                 oldoptimize = get_optimize();
-	read_env_t         *env         = &myenv;
+	int oldoptimize = get_optimize();
 
 	readers_init();
 	symtbl_init();
 
-	memset(env, 0, sizeof(*env));
 	obstack_init(&env->obst);
 	obstack_init(&env->preds_obst);
 	env->idset      = new_set(id_cmp, 128);
 	env->fixedtypes = NEW_ARR_F(ir_type *, 0);
 	env->inputname  = inputname;
-	env->file       = input;
 	env->line       = 1;
+	if (!slurp_input(env, input)) {
+		perror(inputname);
+		return 1;
+	}
 	env->delayed_initializers = NEW_ARR_F(delayed_initializer_t, 0);
 
 	/* read first character */
@@ -2336,15 +2627,120 @@ int ir_import_file(FILE *input, const char *inputname)
 	DEL_ARR_F(env->delayed_initializers);
 	env->delayed_initializers = NULL;
 
-	del_set(env->idset);
-
 	set_optimize(oldoptimize);
 
-	obstack_free(&env->preds_obst, NULL);
-	obstack_free(&env->obst, NULL);
-
 	pmap_destroy(node_readers);
 	node_readers = NULL;
 
+	/* a lazy import keeps its reader state alive for the deferred bodies */
+	if (env->lazy_import == NULL) {
+		del_set(env->idset);
+		obstack_free(&env->preds_obst, NULL);
+		obstack_free(&env->obst, NULL);
+		release_input(env);
+	}
+
 	return env->read_errors;
 }
+
+int ir_import_file(FILE *input, const char *inputname)
+{
+	read_env_t env;
+	memset(&env, 0, sizeof(env));
+	return import_file(&env, input, inputname);
+}
+
+/** Releases the retained reader state of a lazy import. */
+static void free_lazy_import(lazy_import_t *import)
+{
+	read_env_t *const env = &import->env;
+	del_set(env->idset);
+	obstack_free(&env->preds_obst, NULL);
+	obstack_free(&env->obst, NULL);
+	release_input(env);
+	free(import);
+}
+
+int ir_import_lazy(const char *filename)
+{
+	FILE *file = fopen(filename, "rt");
+	if (file == NULL) {
+		perror(filename);
+		return 1;
+	}
+
+	lazy_import_t *import = XMALLOCZ(lazy_import_t);
+	import->env.lazy_import = import;
+
+	int res = import_file(&import->env, file, filename);
+	fclose(file);
+
+	if (import->n_deferred == 0)
+		free_lazy_import(import);
+	return res;
+}
+
+/** Materializes a deferred body by resuming the reader at its position. */
+static ir_graph *load_deferred_body(deferred_body_t *body)
+{
+	lazy_import_t *const import = body->import;
+	read_env_t    *const env    = &import->env;
+
+	bool const own_readers = node_readers == NULL;
+	if (own_readers)
+		readers_init();
+
+	env->pos  = body->pos;
+	env->c    = body->c;
+	env->line = body->line;
+
+	int oldoptimize = get_optimize();
+	set_optimize(0);
+
+	ir_entity *const entity    = body->entity;
+	ir_graph  *const irg       = new_ir_graph(entity, 0);
+	ir_type   *const old_frame = get_irg_frame_type(irg);
+	set_irg_frame_type(irg, body->frame);
+	free_type(old_frame);
+	read_graph(env, irg);
+	irg_finalize_cons(irg);
+
+	set_optimize(oldoptimize);
+	if (own_readers) {
+		pmap_destroy(node_readers);
+		node_readers = NULL;
+	}
+
+	pmap_insert(deferred_bodies, entity, NULL);
+	free(body);
+	if (--import->n_deferred == 0)
+		free_lazy_import(import);
+	return irg;
+}
+
+ir_graph *ir_load_deferred_irg(ir_entity *entity)
+{
+	if (get_entity_kind(entity) != IR_ENTITY_METHOD)
+		return NULL;
+	ir_graph *const irg = get_entity_irg(entity);
+	if (irg != NULL)
+		return irg;
+	if (deferred_bodies == NULL)
+		return NULL;
+	deferred_body_t *const body
+		= pmap_get(deferred_body_t, deferred_bodies, entity);
+	if (body == NULL)
+		return NULL;
+	return load_deferred_body(body);
+}
+
+void ir_load_all_deferred_irgs(void)
+{
+	if (deferred_bodies == NULL)
+		return;
+	foreach_pmap(deferred_bodies, entry) {
+		deferred_body_t *const body = (deferred_body_t*)entry->value;
+		if (body != NULL)
+			load_deferred_body(body);
+	}
+}
@@ -6,11 +6,14 @@
 #include "irnode_t.h"
 #include "obst.h"
 #include "pdeq.h"
+#include "pmap.h"
 #include "set.h"
 #include "type_t.h"
 #include "typerep.h"
 #include <stdio.h>
 
+typedef struct lazy_import_t lazy_import_t;
+
 typedef struct delayed_initializer_t {
 	ir_initializer_t *initializer;
 	long              node_nr;
@@ -24,7 +27,12 @@ typedef struct delayed_pred_t {
 
 typedef struct read_env_t {
 	int            c;           /**< currently read char */
-	FILE          *file;
+	/* The whole input lives in memory: either an mmap of the file or a
+	 * slurped copy.  Lexing works on the buffer, not on the FILE. */
+	const char    *buf;         /**< start of the input buffer */
+	const char    *pos;         /**< next character to read */
+	const char    *end;         /**< one past the last character */
+	bool           mapped;      /**< buf stems from mmap, not malloc */
 	const char    *inputname;
 	unsigned       line;
 
@@ -37,10 +45,18 @@ typedef struct read_env_t {
 	struct obstack preds_obst;
 	delayed_initializer_t *delayed_initializers;
 	const delayed_pred_t **delayed_preds;
+	lazy_import_t *lazy_import; /**< non-NULL while importing lazily */
 } read_env_t;
 
 typedef struct write_env_t {
 	FILE *file;
+	/* The writers emit millions of tiny tokens; they are collected here
+	 * and flushed to the FILE in large chunks instead of going through
+	 * stdio one token at a time. */
+	char  *out;       /**< output buffer */
+	size_t out_used;  /**< bytes used in the output buffer */
+	pmap  *escaped_idents; /**< ident -> quoted and escaped form */
+	struct obstack obst;   /**< holds the escaped ident strings */
 	deq_t write_queue;
 	deq_t entity_queue;
 } write_env_t;
@@ -0,0 +1,184 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2018 Karlsruhe Institute of Technology
+ */
+
+/**
+ * @file
+ * @brief   Combine separately imported modules into one program.
+ *
+ * ir_import() keeps the entities of every module it reads, so after
+ * importing several files the program contains one entity per module
+ * for each global symbol.  The linking step performed here resolves
+ * them the way a linker would: all references to a linker ident are
+ * redirected to the defining entity, superseded declarations are
+ * removed and local entities whose linker idents collide are renamed.
+ * Afterwards interprocedural optimizations see the whole program.
+ */
+#include "irio.h"
+
+#include "ident_t.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irnode_t.h"
+#include "irprog_t.h"
+#include "panic.h"
+#include "pmap.h"
+#include "typerep.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+typedef struct link_env_t {
+	pmap *symbols;      /**< maps linker idents to their surviving entity */
+	pmap *locals;       /**< linker idents already taken by local entities */
+	pmap *replacements; /**< maps superseded entities to their replacement */
+	bool  errors;       /**< multiply defined symbols were found */
+} link_env_t;
+
+/** Returns true if @p entity takes part in cross-module symbol resolution. */
+static bool is_linker_visible(const ir_entity *entity)
+{
+	switch (get_entity_visibility(entity)) {
+	case ir_visibility_external:
+	case ir_visibility_external_private:
+	case ir_visibility_external_protected:
+		return true;
+	case ir_visibility_local:
+	case ir_visibility_private:
+		return false;
+	}
+	panic("invalid visibility");
+}
+
+/** Decides which of two entities with the same linker ident survives. */
+static ir_entity *choose_winner(link_env_t *env, ir_entity *first,
+                                ir_entity *second)
+{
+	bool const first_def  = entity_has_definition(first);
+	bool const second_def = entity_has_definition(second);
+	if (first_def && second_def) {
+		bool const first_weak
+			= (get_entity_linkage(first) & IR_LINKAGE_WEAK) != 0;
+		bool const second_weak
+			= (get_entity_linkage(second) & IR_LINKAGE_WEAK) != 0;
+		if (first_weak)
+			return second_weak ? first : second;
+		if (!second_weak) {
+			fprintf(stderr, "link error: multiple definitions of '%s'\n",
+			        get_id_str(get_entity_ld_ident(first)));
+			env->errors = true;
+		}
+		return first;
+	}
+	return second_def ? second : first;
+}
+
+static void resolve_segment_symbols(link_env_t *env, ir_type *segment)
+{
+	for (size_t i = 0, n = get_compound_n_members(segment); i < n; ++i) {
+		ir_entity *const entity = get_compound_member(segment, i);
+		if (!is_linker_visible(entity))
+			continue;
+		ident     *const ld_ident = get_entity_ld_ident(entity);
+		ir_entity *const prev     = pmap_get(ir_entity, env->symbols, ld_ident);
+		if (prev == NULL || prev == entity) {
+			pmap_insert(env->symbols, ld_ident, entity);
+			continue;
+		}
+		ir_entity *const winner = choose_winner(env, prev, entity);
+		ir_entity *const loser  = winner == prev ? entity : prev;
+		pmap_insert(env->symbols, ld_ident, winner);
+		pmap_insert(env->replacements, loser, winner);
+	}
+}
+
+static void rename_colliding_locals(link_env_t *env, ir_type *segment)
+{
+	for (size_t i = 0, n = get_compound_n_members(segment); i < n; ++i) {
+		ir_entity *const entity = get_compound_member(segment, i);
+		if (is_linker_visible(entity))
+			continue;
+		ident *const ld_ident = get_entity_ld_ident(entity);
+		if (pmap_get(ir_entity, env->symbols, ld_ident) == NULL
+		 && !pmap_contains(env->locals, ld_ident)) {
+			pmap_insert(env->locals, ld_ident, entity);
+			continue;
+		}
+		/* several modules emit a symbol of this name; keep them apart */
+		set_entity_ld_ident(entity, id_unique(get_id_str(ld_ident)));
+	}
+}
+
+/** Follows the replacement map to the surviving entity. */
+static ir_entity *get_replacement(link_env_t *env, ir_entity *entity)
+{
+	ir_entity *next;
+	while ((next = pmap_get(ir_entity, env->replacements, entity)) != NULL)
+		entity = next;
+	return entity;
+}
+
+static void update_node(ir_node *node, void *data)
+{
+	link_env_t *const env = (link_env_t*)data;
+	if (is_Address(node)) {
+		ir_entity *const entity      = get_Address_entity(node);
+		ir_entity *const replacement = get_replacement(env, entity);
+		if (replacement != entity)
+			set_Address_entity(node, replacement);
+	} else if (is_Offset(node)) {
+		ir_entity *const entity      = get_Offset_entity(node);
+		ir_entity *const replacement = get_replacement(env, entity);
+		if (replacement != entity)
+			set_Offset_entity(node, replacement);
+	}
+}
+
+static void update_aliases(link_env_t *env, ir_type *segment)
+{
+	for (size_t i = 0, n = get_compound_n_members(segment); i < n; ++i) {
+		ir_entity *const entity = get_compound_member(segment, i);
+		if (get_entity_kind(entity) != IR_ENTITY_ALIAS)
+			continue;
+		ir_entity *const aliased     = get_entity_alias(entity);
+		ir_entity *const replacement = get_replacement(env, aliased);
+		if (replacement != aliased)
+			set_entity_alias(entity, replacement);
+	}
+}
+
+int ir_link_program(void)
+{
+	link_env_t env = { pmap_create(), pmap_create(), pmap_create(), false };
+
+	for (ir_segment_t s = IR_SEGMENT_FIRST; s <= IR_SEGMENT_LAST; ++s)
+		resolve_segment_symbols(&env, get_segment_type(s));
+	for (ir_segment_t s = IR_SEGMENT_FIRST; s <= IR_SEGMENT_LAST; ++s)
+		rename_colliding_locals(&env, get_segment_type(s));
+
+	if (pmap_count(env.replacements) > 0) {
+		/* redirect all references to the surviving entities */
+		foreach_irp_irg(i, irg) {
+			irg_walk_graph(irg, update_node, NULL, &env);
+		}
+		walk_const_code(update_node, NULL, &env);
+		for (ir_segment_t s = IR_SEGMENT_FIRST; s <= IR_SEGMENT_LAST; ++s)
+			update_aliases(&env, get_segment_type(s));
+
+		foreach_pmap(env.replacements, entry) {
+			ir_entity *const loser = (ir_entity*)entry->key;
+			if (get_entity_kind(loser) == IR_ENTITY_METHOD) {
+				/* a weak definition superseded by a strong one */
+				ir_graph *const irg = get_entity_irg(loser);
+				if (irg != NULL)
+					free_ir_graph(irg);
+			}
+			free_entity(loser);
+		}
+	}
+
+	pmap_destroy(env.symbols);
+	pmap_destroy(env.locals);
+	pmap_destroy(env.replacements);
+	return env.errors ? 1 : 0;
+}
@@ -19,6 +19,7 @@
 #include "strcalc.h"
 #include "tv_t.h"
 #include "util.h"
+#include "xmalloc.h"
 #include <stdbool.h>
 #include <stdlib.h>
 
@@ -28,10 +29,45 @@ static struct obstack modes;
 /** The list of all currently existing modes. */
 static ir_mode **mode_list;
 
+/** Bits packed into mode_rel_cache entries. */
+enum mode_rel_bits {
+	MODE_REL_SMALLER_KNOWN = 1 << 0, /**< smaller_mode() result cached */
+	MODE_REL_SMALLER       = 1 << 1, /**< cached smaller_mode() result */
+	MODE_REL_VALUES_KNOWN  = 1 << 2, /**< values_in_mode() result cached */
+	MODE_REL_VALUES        = 1 << 3, /**< cached values_in_mode() result */
+};
+
+/** Memoized results of the pairwise mode predicates, indexed by the dense
+ * mode indices as [sm_index * mode_rel_stride + lm_index].  The predicates
+ * are asked over and over for the same few mode pairs on optimization hot
+ * paths; a flat table turns them into one indexed load.  Registering a new
+ * mode drops the table. */
+static unsigned char *mode_rel_cache;
+static size_t         mode_rel_stride;
+
+static unsigned char *get_mode_rel(const ir_mode *sm, const ir_mode *lm)
+{
+	if (mode_rel_cache == NULL) {
+		mode_rel_stride = ARR_LEN(mode_list);
+		mode_rel_cache  = XMALLOCNZ(unsigned char,
+		                            mode_rel_stride * mode_rel_stride);
+	}
+	assert(sm->index < mode_rel_stride && lm->index < mode_rel_stride);
+	return &mode_rel_cache[sm->index * mode_rel_stride + lm->index];
+}
+
+static void invalidate_mode_rel_cache(void)
+{
+	free(mode_rel_cache);
+	mode_rel_cache = NULL;
+}
+
 static bool modes_are_equal(const ir_mode *m, const ir_mode *n)
 {
 	if (m->sort != n->sort)
 		return false;
+	if (m->lane_mode != n->lane_mode || m->n_lanes != n->n_lanes)
+		return false;
 	if (m->sort == irms_auxiliary || m->sort == irms_data)
 		return streq(m->name, n->name);
 	return m->arithmetic        == n->arithmetic
@@ -131,9 +167,11 @@ static ir_mode *register_mode(ir_mode *mode)
 		return old;
 	}
 
-	mode->kind = k_ir_mode;
-	mode->type = new_type_primitive(mode);
+	mode->kind  = k_ir_mode;
+	mode->type  = new_type_primitive(mode);
+	mode->index = (unsigned)ARR_LEN(mode_list);
 	ARR_APP1(ir_mode*, mode_list, mode);
+	invalidate_mode_rel_cache();
 	init_mode_values(mode);
 	hook_new_mode(mode);
 	return mode;
@@ -206,6 +244,37 @@ ir_mode *new_non_arithmetic_mode(const char *name, unsigned bit_size)
 	return register_mode(result);
 }
 
+ir_mode *new_vector_mode(ir_mode *lane_mode, unsigned n_lanes)
+{
+	assert(mode_is_int(lane_mode) || mode_is_float(lane_mode));
+	assert(n_lanes > 1);
+
+	char name[32];
+	snprintf(name, sizeof(name), "%sx%u", get_mode_name(lane_mode), n_lanes);
+	ir_mode *result = alloc_mode(name, irms_data, irma_none,
+	                             get_mode_size_bits(lane_mode) * n_lanes, 0, 0);
+	result->lane_mode = lane_mode;
+	result->n_lanes   = n_lanes;
+	return register_mode(result);
+}
+
+int mode_is_vector(const ir_mode *mode)
+{
+	return mode->lane_mode != NULL;
+}
+
+ir_mode *get_mode_lane_mode(const ir_mode *mode)
+{
+	assert(mode_is_vector(mode));
+	return mode->lane_mode;
+}
+
+unsigned get_mode_n_lanes(const ir_mode *mode)
+{
+	assert(mode_is_vector(mode));
+	return mode->n_lanes;
+}
+
 static ir_mode *new_non_data_mode(const char *name)
 {
 	ir_mode *result = alloc_mode(name, irms_auxiliary, irma_none, 0, 0, 0);
@@ -326,12 +395,8 @@ float_int_conversion_overflow_style_t get_mode_float_int_overflow(
 	return mode->int_conv_overflow;
 }
 
-int smaller_mode(const ir_mode *sm, const ir_mode *lm)
+static bool compute_smaller_mode(const ir_mode *sm, const ir_mode *lm)
 {
-	assert(sm != NULL);
-	assert(lm != NULL);
-	if (sm == lm) return true;
-
 	switch (get_mode_sort(sm)) {
 	case irms_int_number:
 		switch (get_mode_sort(lm)) {
@@ -382,13 +447,23 @@ int smaller_mode(const ir_mode *sm, const ir_mode *lm)
 	panic("invalid mode_sort");
 }
 
-int values_in_mode(const ir_mode *sm, const ir_mode *lm)
+int smaller_mode(const ir_mode *sm, const ir_mode *lm)
 {
 	assert(sm != NULL);
 	assert(lm != NULL);
 	if (sm == lm)
 		return true;
 
+	unsigned char *const rel = get_mode_rel(sm, lm);
+	if (*rel & MODE_REL_SMALLER_KNOWN)
+		return (*rel & MODE_REL_SMALLER) != 0;
+	bool const res = compute_smaller_mode(sm, lm);
+	*rel |= MODE_REL_SMALLER_KNOWN | (res ? MODE_REL_SMALLER : 0);
+	return res;
+}
+
+static bool compute_values_in_mode(const ir_mode *sm, const ir_mode *lm)
+{
 	if (sm == mode_b)
 		return mode_is_int(lm) || mode_is_float(lm);
 
@@ -416,6 +491,21 @@ int values_in_mode(const ir_mode *sm, const ir_mode *lm)
 	return false;
 }
 
+int values_in_mode(const ir_mode *sm, const ir_mode *lm)
+{
+	assert(sm != NULL);
+	assert(lm != NULL);
+	if (sm == lm)
+		return true;
+
+	unsigned char *const rel = get_mode_rel(sm, lm);
+	if (*rel & MODE_REL_VALUES_KNOWN)
+		return (*rel & MODE_REL_VALUES) != 0;
+	bool const res = compute_values_in_mode(sm, lm);
+	*rel |= MODE_REL_VALUES_KNOWN | (res ? MODE_REL_VALUES : 0);
+	return res;
+}
+
 ir_mode *get_reference_offset_mode(const ir_mode *mode)
 {
 	assert(mode_is_reference(mode));
@@ -551,6 +641,11 @@ size_t ir_get_n_modes(void)
 	return ARR_LEN(mode_list);
 }
 
+unsigned (get_mode_idx)(const ir_mode *mode)
+{
+	return get_mode_idx_(mode);
+}
+
 ir_mode *ir_get_mode(size_t num)
 {
 	assert(num < ARR_LEN(mode_list));
@@ -559,6 +654,7 @@ ir_mode *ir_get_mode(size_t num)
 
 void finish_mode(void)
 {
+	invalidate_mode_rel_cache();
 	obstack_free(&modes, 0);
 	DEL_ARR_F(mode_list);
 
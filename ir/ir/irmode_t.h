@@ -19,6 +19,7 @@
 #include "firm_common.h"
 
 #define get_mode_ident(mode)           get_mode_ident_(mode)
+#define get_mode_idx(mode)             get_mode_idx_(mode)
 #define get_mode_sort(mode)            get_mode_sort_(mode)
 #define get_mode_size_bits(mode)       get_mode_size_bits_(mode)
 #define get_mode_size_bytes(mode)      get_mode_size_bytes_(mode)
@@ -61,6 +62,9 @@ typedef struct float_descriptor_t {
 	bool          explicit_one;     /**< set if the leading one is explicit */
 } float_descriptor_t;
 
+/** Number of small integer constants interned per mode. */
+#define IR_MODE_INT_CACHE_SIZE 16
+
 /**
  * Contains relevant information about a mode.
  *
@@ -74,6 +78,9 @@ struct ir_mode {
 	ir_type           *type;       /**< Corresponding primitive type */
 	ir_mode_sort       sort;       /**< Coarse classification of this mode */
 	ir_mode_arithmetic arithmetic; /**< Class of possible arithmetic ops */
+	/** Dense index of this mode in the global mode list.  Indices count
+	 * modes in creation order and allow table-indexed per-mode data. */
+	unsigned           index;
 	unsigned           size;       /**< Size of the mode in Bits. */
 	bool               sign:1;     /**< Whether mode has a sign bit. */
 	ENUMBF(float_int_conversion_overflow_style_t)
@@ -89,9 +96,18 @@ struct ir_mode {
 	ir_tarval          *one;       /**< The value 1 */
 	ir_tarval          *all_one;   /**< The value where all bits are set */
 	ir_tarval          *infinity;  /**< The (positive) infinity value */
+	/** Interned tarvals of the small constants 0..IR_MODE_INT_CACHE_SIZE-1.
+	 * Filled by init_mode_values() for integer and reference modes so the
+	 * most frequent constants are found by array indexing instead of a
+	 * hash table lookup.  Unused entries are NULL. */
+	ir_tarval          *int_cache[IR_MODE_INT_CACHE_SIZE];
 	/** For reference modes, a signed integer mode used to add/subtract
 	 * offsets. */
 	ir_mode            *offset_mode;
+	/** For vector modes, the mode of a single lane, else NULL. */
+	ir_mode            *lane_mode;
+	/** For vector modes, the number of lanes. */
+	unsigned            n_lanes;
 };
 
 static inline ident *get_mode_ident_(const ir_mode *mode)
@@ -99,6 +115,11 @@ static inline ident *get_mode_ident_(const ir_mode *mode)
 	return mode->name;
 }
 
+static inline unsigned get_mode_idx_(const ir_mode *mode)
+{
+	return mode->index;
+}
+
 static inline ir_mode_sort get_mode_sort_(const ir_mode *mode)
 {
 	return mode->sort;
@@ -20,7 +20,9 @@
 #include "irgraph_t.h"
 #include "irhooks.h"
 #include "irmode_t.h"
+#include "irnode_new_t.h"
 #include "irop_t.h"
+#include "irouts_t.h"
 #include "irprintf.h"
 #include "irprog_t.h"
 #include "irverify.h"
@@ -76,50 +78,25 @@ ir_relation get_inversed_relation(ir_relation relation)
 ir_node *new_ir_node(dbg_info *db, ir_graph *irg, ir_node *block, ir_op *op,
                      ir_mode *mode, int arity, ir_node *const *in)
 {
-	assert(mode != NULL);
-
-	size_t   const node_size = offsetof(ir_node, attr) + op->attr_size;
-	ir_node *const res       = (ir_node*)OALLOCNZ(get_irg_obstack(irg), char, node_size);
-
-	res->kind     = k_ir_node;
-	res->op       = op;
-	res->mode     = mode;
-	res->irg      = irg;
-	res->node_idx = irg_register_node_idx(irg, res);
-
-	if (arity < 0) {
-		res->in = NEW_ARR_F(ir_node *, 1);  /* 1: space for block */
-	} else {
-		/* Nodes with dynamic arity must always have a flexible array. */
-		if (op->opar == oparity_dynamic)
-			res->in = NEW_ARR_F(ir_node *, (arity+1));
-		else
-			res->in = NEW_ARR_D(ir_node*, get_irg_obstack(irg), arity + 1);
-		MEMCPY(&res->in[1], in, arity);
-	}
-
-	res->in[0]   = block;
-	set_irn_dbg_info(res, db);
-	res->node_nr = get_irp_new_node_nr();
-
-	for (ir_edge_kind_t i = EDGE_KIND_FIRST; i <= EDGE_KIND_LAST; ++i) {
-		INIT_LIST_HEAD(&res->edge_info[i].outs_head);
-		/* Edges will be built immediately. */
-		res->edge_info[i].edges_built = 1;
-		res->edge_info[i].out_count = 0;
-	}
+	return new_ir_node_(db, irg, block, op, mode, arity, in);
+}
 
-	/* don't put this into the for loop, arity is -1 for some nodes! */
-	if (block != NULL)
-		edges_notify_edge(res, -1, block, NULL, irg);
-	for (int i = 0; i < arity; ++i)
-		edges_notify_edge(res, i, res->in[i+1], NULL, irg);
+void irn_recycle(ir_node *node)
+{
+	ir_graph *const irg        = get_irn_irg(node);
+	ir_op    *const op         = get_irn_op(node);
+	size_t    const node_size  = offsetof(ir_node, attr) + op->attr_size;
+	size_t    const size_class = (node_size + sizeof(void*) - 1)
+	                           / sizeof(void*);
 
-	hook_new_node(res);
-	if (irg_is_constrained(irg, IR_GRAPH_CONSTRAINT_BACKEND))
-		be_info_new_node(irg, res);
+	if (op->opar == oparity_dynamic)
+		DEL_ARR_F(node->in);
+	irg->idx_irn_map[get_irn_idx(node)] = NULL;
 
-	return res;
+	if (size_class >= IRG_NODE_RECYCLE_CLASSES)
+		return;
+	*(void**)node = irg->free_nodes[size_class];
+	irg->free_nodes[size_class] = node;
 }
 
 ir_node *new_similar_node(ir_node *const old, ir_node *const block, ir_node **const in)
@@ -174,13 +151,17 @@ void set_irn_in(ir_node *const node, int const arity, ir_node *const *const in)
 	ir_node ***pOld_in = &node->in;
 	int        i;
 	for (i = 0; i < arity; i++) {
-		if (i < (int)ARR_LEN(*pOld_in)-1)
+		if (i < (int)ARR_LEN(*pOld_in)-1) {
 			edges_notify_edge(node, i, in[i], (*pOld_in)[i+1], irg);
-		else
+			irouts_notify_edge(node, i, in[i], (*pOld_in)[i+1], irg);
+		} else {
 			edges_notify_edge(node, i, in[i], NULL,            irg);
+			irouts_notify_edge(node, i, in[i], NULL,            irg);
+		}
 	}
 	for (;i < (int)ARR_LEN(*pOld_in)-1; i++) {
 		edges_notify_edge(node, i, NULL, (*pOld_in)[i+1], irg);
+		irouts_notify_edge(node, i, NULL, (*pOld_in)[i+1], irg);
 	}
 
 	if (arity != (int)ARR_LEN(*pOld_in) - 1) {
@@ -192,8 +173,11 @@ void set_irn_in(ir_node *const node, int const arity, ir_node *const *const in)
 
 	MEMCPY(*pOld_in + 1, in, arity);
 
-	/* update irg flags */
-	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS | IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+	/* update irg flags; the outs were patched above.  Only control flow
+	 * edits can render the loop tree stale: changing the inputs of a data
+	 * node leaves the CFG untouched. */
+	if (is_Block(node) || get_irn_mode(node) == mode_X)
+		clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
 }
 
 ir_node *(get_irn_n)(const ir_node *node, int n)
@@ -212,11 +196,15 @@ void set_irn_n(ir_node *node, int n, ir_node *in)
 
 	/* Here, we rely on src and tgt being in the current ir graph */
 	edges_notify_edge(node, n, in, node->in[n + 1], irg);
+	irouts_notify_edge(node, n, in, node->in[n + 1], irg);
 
 	node->in[n + 1] = in;
 
-	/* update irg flags */
-	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS | IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+	/* update irg flags; the outs were patched above.  Only control flow
+	 * edits can render the loop tree stale: changing the inputs of a data
+	 * node leaves the CFG untouched. */
+	if (is_Block(node) || get_irn_mode(node) == mode_X)
+		clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
 }
 
 int add_irn_n(ir_node *node, ir_node *in)
@@ -227,9 +215,7 @@ int add_irn_n(ir_node *node, ir_node *in)
 	int pos = ARR_LEN(node->in) - 1;
 	ARR_APP1(ir_node *, node->in, in);
 	edges_notify_edge(node, pos, node->in[pos + 1], NULL, irg);
-
-	/* update irg flags */
-	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
+	irouts_notify_edge(node, pos, node->in[pos + 1], NULL, irg);
 
 	return pos;
 }
@@ -245,13 +231,12 @@ static void remove_irn_n(ir_node *node, int n)
 		ir_node  *const pred = *slot;
 		*slot = last;
 		edges_notify_edge(node, n, last, pred, irg);
+		irouts_notify_edge(node, n, last, pred, irg);
 	}
 	/* Remove last edge. */
 	edges_notify_edge(node, arity - 1, NULL, last, irg);
+	irouts_notify_edge(node, arity - 1, NULL, last, irg);
 	ARR_SHRINKLEN(node->in, arity);
-
-	/* update irg flags */
-	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
 }
 
 void remove_Sync_n(ir_node *n, int i)
@@ -291,6 +276,27 @@ ident *get_irn_opident(const ir_node *node)
 	return node->op->name;
 }
 
+ir_visited_t get_irn_visited_(const ir_node *node)
+{
+	return node->irg->visited_stamps[node->node_idx];
+}
+
+void set_irn_visited_(ir_node *node, ir_visited_t visited)
+{
+	node->irg->visited_stamps[node->node_idx] = visited;
+}
+
+void mark_irn_visited_(ir_node *node)
+{
+	node->irg->visited_stamps[node->node_idx] = get_irg_visited(node->irg);
+}
+
+int irn_visited_(const ir_node *node)
+{
+	ir_graph *irg = node->irg;
+	return irg->visited_stamps[node->node_idx] >= get_irg_visited(irg);
+}
+
 ir_visited_t (get_irn_visited)(const ir_node *node)
 {
 	return get_irn_visited_(node);
@@ -463,16 +469,15 @@ void set_End_keepalives(ir_node *end, int n, ir_node *in[])
 	ir_graph *irg = get_irn_irg(end);
 	for (size_t e = END_KEEPALIVE_OFFSET; e < ARR_LEN(end->in) - 1; ++e) {
 		edges_notify_edge(end, e, NULL, end->in[e + 1], irg);
+		irouts_notify_edge(end, e, NULL, end->in[e + 1], irg);
 	}
 	ARR_RESIZE(ir_node *, end->in, n + 1 + END_KEEPALIVE_OFFSET);
 
 	for (int i = 0; i < n; ++i) {
 		end->in[1 + END_KEEPALIVE_OFFSET + i] = in[i];
 		edges_notify_edge(end, END_KEEPALIVE_OFFSET + i, end->in[1 + END_KEEPALIVE_OFFSET + i], NULL, irg);
+		irouts_notify_edge(end, END_KEEPALIVE_OFFSET + i, end->in[1 + END_KEEPALIVE_OFFSET + i], NULL, irg);
 	}
-
-	/* update irg flags */
-	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
 }
 
 void remove_End_n(ir_node *n, int idx)
@@ -517,23 +522,16 @@ void remove_End_Bads_and_doublets(ir_node *end)
 	pset_new_t keeps;
 	pset_new_init(&keeps);
 
-	bool changed = false;
 	for (int idx = n; idx-- > 0; ) {
 		ir_node *ka = get_End_keepalive(end, idx);
 
 		if (is_Bad(ka) || is_NoMem(ka) || pset_new_contains(&keeps, ka)) {
-			changed = true;
 			remove_irn_n(end, idx - END_KEEPALIVE_OFFSET);
 		} else {
 			pset_new_insert(&keeps, ka);
 		}
 	}
 	pset_new_destroy(&keeps);
-
-	if (changed) {
-		ir_graph *const irg = get_irn_irg(end);
-		clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
-	}
 }
 
 void free_End(ir_node *end)
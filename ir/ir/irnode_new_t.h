@@ -0,0 +1,100 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Inline core of node allocation.
+ *
+ * The body of new_ir_node() lives here so that the generated per-op
+ * constructors can inline it with a compile-time known arity: the in
+ * array copy and the edge notification loops then unroll and the
+ * oparity checks fold away.  Everybody else calls the out-of-line
+ * new_ir_node() wrapper in irnode.c, which is the only other user of
+ * this header besides the constructors.
+ */
+#ifndef FIRM_IR_IRNODE_NEW_T_H
+#define FIRM_IR_IRNODE_NEW_T_H
+
+#include "array.h"
+#include "beinfo.h"
+#include "iredges_t.h"
+#include "irgraph_t.h"
+#include "irhooks.h"
+#include "irnode_t.h"
+#include "irop_t.h"
+#include "irouts_t.h"
+#include "irprog_t.h"
+#include "util.h"
+
+static inline ir_node *new_ir_node_(dbg_info *const db, ir_graph *const irg,
+                                    ir_node *const block, ir_op *const op,
+                                    ir_mode *const mode, int const arity,
+                                    ir_node *const *const in)
+{
+	assert(mode != NULL);
+
+	size_t const node_size  = offsetof(ir_node, attr) + op->attr_size;
+	size_t const size_class = (node_size + sizeof(void*) - 1) / sizeof(void*);
+
+	/* Prefer recycled node memory of the right size class if available. */
+	ir_node *res;
+	if (size_class < IRG_NODE_RECYCLE_CLASSES
+	 && irg->free_nodes[size_class] != NULL) {
+		res = (ir_node*)irg->free_nodes[size_class];
+		irg->free_nodes[size_class] = *(void**)res;
+		memset(res, 0, size_class * sizeof(void*));
+	} else {
+		res = (ir_node*)OALLOCNZ(get_irg_obstack(irg), char, node_size);
+	}
+
+	res->kind     = k_ir_node;
+	res->op       = op;
+	res->mode     = mode;
+	res->irg      = irg;
+	res->node_idx = irg_register_node_idx(irg, res);
+	irg_note_mode_size(irg, mode);
+
+	if (arity < 0) {
+		res->in = NEW_ARR_F(ir_node *, 1);  /* 1: space for block */
+	} else {
+		/* Nodes with dynamic arity must always have a flexible array. */
+		if (op->opar == oparity_dynamic)
+			res->in = NEW_ARR_F(ir_node *, (arity+1));
+		else
+			res->in = NEW_ARR_D(ir_node*, get_irg_obstack(irg), arity + 1);
+		MEMCPY(&res->in[1], in, arity);
+	}
+
+	res->in[0]   = block;
+	set_irn_dbg_info(res, db);
+	res->node_nr = get_irp_new_node_nr();
+
+	for (ir_edge_kind_t i = EDGE_KIND_FIRST; i <= EDGE_KIND_LAST; ++i) {
+		INIT_LIST_HEAD(&res->edge_info[i].outs_head);
+		/* Edges will be built immediately. */
+		res->edge_info[i].edges_built = 1;
+		res->edge_info[i].out_count = 0;
+	}
+
+	irouts_node_created(res);
+
+	/* don't put this into the for loop, arity is -1 for some nodes! */
+	if (block != NULL) {
+		edges_notify_edge(res, -1, block, NULL, irg);
+		irouts_notify_edge(res, -1, block, NULL, irg);
+	}
+	for (int i = 0; i < arity; ++i) {
+		edges_notify_edge(res, i, res->in[i+1], NULL, irg);
+		irouts_notify_edge(res, i, res->in[i+1], NULL, irg);
+	}
+
+	hook_new_node(res);
+	if (irg_is_constrained(irg, IR_GRAPH_CONSTRAINT_BACKEND))
+		be_info_new_node(irg, res);
+
+	return res;
+}
+
+#endif
@@ -283,6 +283,8 @@ typedef struct ir_def_use_edge {
 
 typedef struct ir_def_use_edges {
 	unsigned        n_edges;
+	unsigned        capacity; /**< Allocated size of edges[], for incremental
+	                               maintenance of the out information. */
 	ir_def_use_edge edges[];
 } ir_def_use_edges;
 
@@ -296,7 +298,6 @@ struct ir_node {
 	ir_mode         *mode;     /**< The Mode of this node. */
 	struct ir_node **in;       /**< The array of predecessors / operands. */
 	ir_graph        *irg;
-	ir_visited_t     visited;  /**< Visited counter for walks of the graph. */
 	void            *link;     /**< To attach additional information to the
 	                                node, e.g. used during optimization to link
 	                                to nodes that shall replace a node. */
@@ -438,42 +439,33 @@ static inline ir_graph *get_irn_irg_(const ir_node *node)
 	return node->irg;
 }
 
+/* The visited stamps of the nodes live in a per-graph side table indexed
+ * by node index (see ir_graph), so these accessors need the complete
+ * ir_graph and are defined out of line in irnode.c. */
+
 /**
  * Gets the visited counter of a node.
  * Intern version for libFirm.
  */
-static inline ir_visited_t get_irn_visited_(const ir_node *node)
-{
-	return node->visited;
-}
+ir_visited_t get_irn_visited_(const ir_node *node);
 
 /**
  * Sets the visited counter of a node.
  * Intern version for libFirm.
  */
-static inline void set_irn_visited_(ir_node *node, ir_visited_t visited)
-{
-	node->visited = visited;
-}
+void set_irn_visited_(ir_node *node, ir_visited_t visited);
 
 /**
  * Mark a node as visited in a graph.
  * Intern version for libFirm.
  */
-static inline void mark_irn_visited_(ir_node *node)
-{
-	node->visited = get_irg_visited(get_irn_irg(node));
-}
+void mark_irn_visited_(ir_node *node);
 
 /**
  * Returns non-zero if a node of was visited.
  * Intern version for libFirm.
  */
-static inline int irn_visited_(const ir_node *node)
-{
-	ir_graph *irg = get_irn_irg(node);
-	return node->visited >= get_irg_visited(irg);
-}
+int irn_visited_(const ir_node *node);
 
 static inline int irn_visited_else_mark_(ir_node *node)
 {
@@ -732,6 +724,13 @@ void remove_keep_alive(const ir_node *kept_node);
  */
 ir_node *new_similar_node(ir_node *old, ir_node *block, ir_node **in);
 
+/**
+ * Returns the storage of a dead node to the free lists of its graph so
+ * new_ir_node() can reuse it.  The caller must guarantee that no reference
+ * to @p node remains.
+ */
+void irn_recycle(ir_node *node);
+
 /**
  * Gets the Proj with number pn from irn.
  * Returns a null pointer, if no such Proj exists.
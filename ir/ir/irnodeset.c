@@ -26,6 +26,16 @@
 #define KeysEqual(this,key1,key2) (key1) == (key2)
 #define SetRangeEmpty(ptr,size)   memset(ptr, 0, (size) * sizeof((ptr)[0]))
 
+/* Small-set optimization: a table of exactly IR_NODESET_SMALL_SIZE buckets
+ * lives in the inline buffer, everything else on the heap.  Using the
+ * buffer for one size only guarantees a rehash never copies inline to
+ * inline. */
+#define HT_MIN_BUCKETS IR_NODESET_SMALL_SIZE
+#define Alloc(size) \
+	((size) == IR_NODESET_SMALL_SIZE + IR_NODESET_SMALL_EXTRA \
+	 ? self->small : XMALLOCN(ir_node*, (size)))
+#define Free(ptr)   do { if ((ptr) != self->small) free(ptr); } while (0)
+
 void ir_nodeset_init_(ir_nodeset_t *self);
 #define hashset_init            ir_nodeset_init_
 #define hashset_init_size       ir_nodeset_init_size
@@ -42,5 +52,7 @@ void ir_nodeset_init_(ir_nodeset_t *self);
 
 void ir_nodeset_init(ir_nodeset_t *nodeset)
 {
-	ir_nodeset_init_size(nodeset, 16);
+	/* start in the inline buffer; the typical pass-local set holds only
+	 * a handful of nodes and never pays for a heap allocation */
+	ir_nodeset_init_size(nodeset, IR_NODESET_SMALL_SIZE / 2);
 }
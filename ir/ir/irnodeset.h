@@ -19,13 +19,24 @@
 #include "firm_types.h"
 #include "xmalloc.h"
 
+/** Number of entries stored inline in the set itself.  Sets with at most
+ * half that many elements (see occupancy factor) never touch the heap. */
+#define IR_NODESET_SMALL_SIZE 8
+
 #define HashSet          ir_nodeset_t
 #define HashSetIterator  ir_nodeset_iterator_t
 #define ValueType        ir_node*
 #define DO_REHASH
+/** Extra slots holding the control bytes of the inline table. */
+#define IR_NODESET_SMALL_EXTRA \
+	((IR_NODESET_SMALL_SIZE + sizeof(ir_node*) - 1) / sizeof(ir_node*))
+
+#define ADDITIONAL_DATA \
+	ir_node *small[IR_NODESET_SMALL_SIZE + IR_NODESET_SMALL_EXTRA];
 
 #include "hashset.h"
 
+#undef ADDITIONAL_DATA
 #undef DO_REHASH
 #undef ValueType
 #undef HashSetIterator
@@ -26,10 +26,20 @@
 #include "util.h"
 #include "xmalloc.h"
 
+/** Number of per-thread counter shards in instrumented code. Must match
+ * FIRMPROF_N_SHARDS in libfirmprof. */
+#define IR_PROFILE_N_SHARDS 8
+
+/** Start value of the staleness hash over the block ids (FNV offset). */
+#define PROFILE_HASH_INIT 2166136261u
+
 /* Instrument blocks walker. */
 typedef struct block_id_walker_data_t {
 	unsigned int  id;       /**< current block id number */
+	unsigned int  n_blocks; /**< total number of blocks (shard stride) */
+	unsigned int  hash;     /**< hash over the visited block ids */
 	ir_node      *counters; /**< the node representing the counter array */
+	ir_node      *shard;    /**< the node representing the shard variable */
 } block_id_walker_data_t;
 
 /* Associate counters with blocks. */
@@ -71,6 +81,21 @@ static int cmp_execcount(const void *a, const void *b, size_t size)
 	return ea->block != eb->block;
 }
 
+/**
+ * Combines the id of one block into the staleness hash (FNV-1a). Both the
+ * instrumenter and the reader fold the block ids in walk order, so a
+ * profile recorded for different code is recognized and rejected.
+ */
+static unsigned profile_hash_block(unsigned hash, unsigned long block_nr)
+{
+	return (hash ^ (unsigned)block_nr) * 16777619u;
+}
+
+bool ir_profile_is_loaded(void)
+{
+	return profile != NULL;
+}
+
 uint32_t ir_profile_get_block_execcount(const ir_node *block)
 {
 	execcount_t  const query = { .block = get_irn_node_nr(block), .count = 0 };
@@ -136,7 +161,7 @@ static void add_constructor(ir_entity *method)
 	ir_type   *const constructors = get_segment_type(IR_SEGMENT_CONSTRUCTORS);
 	ident     *const ide          = id_unique("constructor_ptr");
 	ir_entity *const ptr          = new_global_entity(constructors, ide, ptr_type, ir_visibility_private, IR_LINKAGE_CONSTANT | IR_LINKAGE_HIDDEN_USER);
-	set_entity_ld_ident(ptr, NEW_IDENT(""));
+	set_entity_ld_ident(ptr, id_empty);
 
 	ir_graph         *const irg  = get_const_code_irg();
 	ir_node          *const val  = new_r_Address(irg, method);
@@ -145,14 +170,15 @@ static void add_constructor(ir_entity *method)
 }
 
 /**
- * Returns an entity representing the __init_firmprof function from libfirmprof
- * This is the equivalent of:
- * extern void __init_firmprof(char *filename, uint *counters, uint size)
+ * Returns an entity representing the __init_firmprof2 function from
+ * libfirmprof. This is the equivalent of:
+ * extern void __init_firmprof2(char *filename, uint *counters, uint size,
+ *                              uint n_shards, uint block_hash)
  */
 static ir_entity *get_init_firmprof_ref(void)
 {
-	ident   *const init_name = new_id_from_str("__init_firmprof");
-	ir_type *const init_type = new_type_method(3, 0, false, cc_cdecl_set, mtp_no_property);
+	ident   *const init_name = id_init_firmprof2;
+	ir_type *const init_type = new_type_method(5, 0, false, cc_cdecl_set, mtp_no_property);
 	ir_type *const uint      = get_type_for_mode(mode_Iu);
 	ir_type *const uintptr   = new_type_pointer(uint);
 	ir_type *const string    = new_type_pointer(get_type_for_mode(mode_Bs));
@@ -160,6 +186,8 @@ static ir_entity *get_init_firmprof_ref(void)
 	set_method_param_type(init_type, 0, string);
 	set_method_param_type(init_type, 1, uintptr);
 	set_method_param_type(init_type, 2, uint);
+	set_method_param_type(init_type, 3, uint);
+	set_method_param_type(init_type, 4, uint);
 
 	return new_entity(get_glob_type(), init_name, init_type);
 }
@@ -170,12 +198,13 @@ static ir_entity *get_init_firmprof_ref(void)
  * Pseudocode:
  *    static void __firmprof_initializer(void) __attribute__ ((constructor))
  *    {
- *        __init_firmprof(ent_filename, bblock_counts, n_blocks);
+ *        __init_firmprof2(ent_filename, bblock_counts, n_blocks,
+ *                         IR_PROFILE_N_SHARDS, block_hash);
  *    }
  */
-static ir_graph *gen_initializer_irg(ir_entity *ent_filename, ir_entity *bblock_counts, int n_blocks)
+static ir_graph *gen_initializer_irg(ir_entity *ent_filename, ir_entity *bblock_counts, int n_blocks, unsigned block_hash)
 {
-	ident     *const name  = new_id_from_str("__firmprof_initializer");
+	ident     *const name  = id_firmprof_initializer;
 	ir_type   *const owner = get_glob_type();
 	ir_type   *const type  = new_type_method(0, 0, false, cc_cdecl_set, mtp_no_property);
 	ir_entity *const ent   = new_global_entity(owner, name, type, ir_visibility_local, IR_LINKAGE_DEFAULT);
@@ -188,7 +217,9 @@ static ir_graph *gen_initializer_irg(ir_entity *ent_filename, ir_entity *bblock_
 	ir_node   *const filename  = new_r_Address(irg, ent_filename);
 	ir_node   *const counters  = new_r_Address(irg, bblock_counts);
 	ir_node   *const size      = new_r_Const_long(irg, mode_Iu, n_blocks);
-	ir_node   *const ins[]     = { filename, counters, size };
+	ir_node   *const shards    = new_r_Const_long(irg, mode_Iu, IR_PROFILE_N_SHARDS);
+	ir_node   *const hash      = new_r_Const_long(irg, mode_Iu, block_hash);
+	ir_node   *const ins[]     = { filename, counters, size, shards, hash };
 	ir_type   *const call_type = get_entity_type(init_ent);
 	ir_node   *const call      = new_r_Call(bb, init_mem, callee, ARRAY_SIZE(ins), ins, call_type);
 	ir_node   *const call_mem  = new_r_Proj(call, mode_M, pn_Call_M);
@@ -206,7 +237,7 @@ static ir_graph *gen_initializer_irg(ir_entity *ent_filename, ir_entity *bblock_
  * This just inserts the instruction nodes, it doesn't connect the memory
  * nodes in a meaningful way.
  */
-static void instrument_block(ir_node *const bb, ir_node *const address, unsigned int const id)
+static void instrument_block(ir_node *const bb, block_id_walker_data_t *const wd)
 {
 	ir_graph *const irg = get_irn_irg(bb);
 
@@ -214,14 +245,30 @@ static void instrument_block(ir_node *const bb, ir_node *const address, unsigned
 	if (bb == get_irg_end_block(irg))
 		return;
 
+	ir_node *const address  = wd->counters;
 	ir_type *const type_arr = get_entity_type(get_irn_entity_attr(address));
 	ir_type *const type_ctr = get_array_element_type(type_arr);
 	ir_mode *const mode_ctr = get_type_mode(type_ctr);
 	ir_node *const unknown  = new_r_Unknown(irg, mode_M);
 	ir_mode *const mode_off = get_reference_offset_mode(get_irn_mode(address));
-	ir_node *const cnst     = new_r_Const_long(irg, mode_off, get_mode_size_bytes(mode_ctr) * id);
-	ir_node *const offset   = new_r_Add(bb, address, cnst);
-	ir_node *const load     = new_r_Load(bb, unknown, offset, mode_ctr, type_arr, cons_none);
+	unsigned const ctr_size = get_mode_size_bytes(mode_ctr);
+
+	/* select this thread's shard of the counter array:
+	 * counters + (__firmprof_shard & (N_SHARDS - 1)) * n_blocks */
+	ir_type *const type_shd = get_type_for_mode(mode_Iu);
+	ir_node *const sload    = new_r_Load(bb, unknown, wd->shard, mode_Iu, type_shd, cons_none);
+	ir_node *const smem0    = new_r_Proj(sload, mode_M, pn_Load_M);
+	ir_node *const shard    = new_r_Proj(sload, mode_Iu, pn_Load_res);
+	ir_node *const mask     = new_r_Const_long(irg, mode_Iu, IR_PROFILE_N_SHARDS - 1);
+	ir_node *const masked   = new_r_And(bb, shard, mask);
+	ir_node *const conv     = new_r_Conv(bb, masked, mode_off);
+	ir_node *const stride   = new_r_Const_long(irg, mode_off, (long)ctr_size * wd->n_blocks);
+	ir_node *const scaled   = new_r_Mul(bb, conv, stride);
+	ir_node *const sbase    = new_r_Add(bb, address, scaled);
+
+	ir_node *const cnst     = new_r_Const_long(irg, mode_off, ctr_size * wd->id);
+	ir_node *const offset   = new_r_Add(bb, sbase, cnst);
+	ir_node *const load     = new_r_Load(bb, smem0, offset, mode_ctr, type_arr, cons_none);
 	ir_node *const lmem     = new_r_Proj(load, mode_M, pn_Load_M);
 	ir_node *const proji    = new_r_Proj(load, mode_ctr, pn_Load_res);
 	ir_node *const one      = new_r_Const_one(irg, mode_ctr);
@@ -230,7 +277,7 @@ static void instrument_block(ir_node *const bb, ir_node *const address, unsigned
 	ir_node *const smem     = new_r_Proj(store, mode_M, pn_Store_M);
 
 	set_irn_link(bb, smem);
-	set_irn_link(smem, load);
+	set_irn_link(smem, sload);
 }
 
 /**
@@ -280,7 +327,8 @@ static void fix_ssa(ir_node *const bb, void *const data)
 static void block_instrument_walker(ir_node *bb, void *data)
 {
 	block_id_walker_data_t *wd = (block_id_walker_data_t*)data;
-	instrument_block(bb, wd->counters, wd->id);
+	wd->hash = profile_hash_block(wd->hash, get_irn_node_nr(bb));
+	instrument_block(bb, wd);
 	++wd->id;
 }
 
@@ -298,10 +346,11 @@ static ir_node *sync_mem(ir_node *bb, ir_node *mem)
  * Instrument a single ir_graph, counters should point to the bblock
  * counters array.
  */
-static void instrument_irg(ir_graph *irg, ir_entity *counters, block_id_walker_data_t *wd)
+static void instrument_irg(ir_graph *irg, ir_entity *counters, ir_entity *shard_var, block_id_walker_data_t *wd)
 {
-	/* generate a node pointing to the count array */
+	/* generate nodes pointing to the count array and the shard index */
 	wd->counters = new_r_Address(irg, counters);
+	wd->shard    = new_r_Address(irg, shard_var);
 
 	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
 
@@ -401,21 +450,37 @@ ir_graph *ir_profile_instrument(const char *filename)
 
 	/* create all the necessary types and entities. Note that the
 	 * types must have a fixed layout, because we are already running in the
-	 * backend */
-	ir_entity *const bblock_counts = new_array_entity("__FIRMPROF__BLOCK_COUNTS", mode_Iu, n_blocks, IR_LINKAGE_DEFAULT);
+	 * backend. The counter array has one shard of n_blocks counters per
+	 * thread shard, so concurrent threads do not serialize on the same
+	 * cache lines. */
+	ir_entity *const bblock_counts = new_array_entity("__FIRMPROF__BLOCK_COUNTS", mode_Iu, n_blocks * IR_PROFILE_N_SHARDS, IR_LINKAGE_DEFAULT);
 
 	ir_entity *const ent_filename = new_static_string_entity("__FIRMPROF__FILE_NAME", filename);
 
+	/* reference to the thread local shard index maintained by libfirmprof */
+	ir_type   *const uint_type = get_type_for_mode(mode_Iu);
+	ir_entity *const shard_var = new_global_entity(get_tls_type(), NEW_IDENT("__firmprof_shard"), uint_type, ir_visibility_external, IR_LINKAGE_DEFAULT);
+
 	/* initialize block id array and instrument blocks */
-	block_id_walker_data_t wd = { .id = 0 };
+	block_id_walker_data_t wd = {
+		.id       = 0,
+		.n_blocks = n_blocks,
+		.hash     = PROFILE_HASH_INIT,
+	};
 	foreach_irp_irg_r(i, irg) {
-		instrument_irg(irg, bblock_counts, &wd);
+		instrument_irg(irg, bblock_counts, shard_var, &wd);
 	}
 
-	return gen_initializer_irg(ent_filename, bblock_counts, n_blocks);
+	return gen_initializer_irg(ent_filename, bblock_counts, n_blocks, wd.hash);
 }
 
-static unsigned int *parse_profile(const char *filename, unsigned int num_blocks)
+static uint32_t get_le32(unsigned char const *const bytes)
+{
+	return ((uint32_t)bytes[0] <<  0) | ((uint32_t)bytes[1] <<  8)
+	     | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+static unsigned int *parse_profile(const char *filename, unsigned int num_blocks, unsigned int expected_hash)
 {
 	FILE *const f = fopen(filename, "rb");
 	if (!f) {
@@ -427,7 +492,26 @@ static unsigned int *parse_profile(const char *filename, unsigned int num_blocks
 	uint32_t *result = NULL;
 	char      buf[8];
 	size_t    ret = fread(buf, 8, 1, f);
-	if (ret == 0 || strncmp(buf, "firmprof", 8) != 0) {
+	if (ret == 0) {
+		DBG((dbg, LEVEL_2, "Broken fileheader in profile\n"));
+		goto end;
+	}
+	if (strncmp(buf, "firmprf2", 8) == 0) {
+		/* v2: block count and staleness hash follow the magic */
+		unsigned char header[8];
+		if (fread(header, 8, 1, f) == 0) {
+			DBG((dbg, LEVEL_2, "Truncated v2 profile header\n"));
+			goto end;
+		}
+		uint32_t const file_blocks = get_le32(&header[0]);
+		uint32_t const file_hash   = get_le32(&header[4]);
+		if (file_blocks != num_blocks || file_hash != expected_hash) {
+			DBG((dbg, LEVEL_2,
+			     "Stale profile ignored (blocks %u/%u, hash %08x/%08x)\n",
+			     file_blocks, num_blocks, file_hash, expected_hash));
+			goto end;
+		}
+	} else if (strncmp(buf, "firmprof", 8) != 0) {
 		DBG((dbg, LEVEL_2, "Broken fileheader in profile\n"));
 		goto end;
 	}
@@ -491,6 +575,28 @@ void ir_profile_free(void)
 	}
 }
 
+/**
+ * Block walker, fold the block id into the staleness hash.
+ */
+static void block_hash_walker(ir_node *bb, void *data)
+{
+	unsigned *const hash = (unsigned*)data;
+	*hash = profile_hash_block(*hash, get_irn_node_nr(bb));
+}
+
+/**
+ * Returns the staleness hash over all blocks of the current ir program,
+ * in the same order in which they were instrumented.
+ */
+static unsigned get_irp_block_hash(void)
+{
+	unsigned hash = PROFILE_HASH_INIT;
+	foreach_irp_irg_r(i, irg) {
+		irg_block_walk_graph(irg, block_hash_walker, NULL, &hash);
+	}
+	return hash;
+}
+
 bool ir_profile_read(const char *filename)
 {
 	FIRM_DBG_REGISTER(dbg, "firm.ir.profile");
@@ -498,7 +604,7 @@ bool ir_profile_read(const char *filename)
 	unsigned n_blocks = get_irp_n_blocks();
 	block_assoc_t env = {
 		.i        = 0,
-		.counters = parse_profile(filename, n_blocks)
+		.counters = parse_profile(filename, n_blocks, get_irp_block_hash())
 	};
 	if (!env.counters)
 		return false;
@@ -557,3 +663,103 @@ void ir_create_execfreqs_from_profile(void)
 		ir_set_execfreqs_from_profile(irg);
 	}
 }
+
+/**
+ * Reads a v2 profile. Returns the malloced counter array and stores block
+ * count and staleness hash, or returns NULL on failure.
+ */
+static uint32_t *read_v2_profile(const char *filename, uint32_t *n_blocks,
+                                 uint32_t *hash)
+{
+	FILE *const f = fopen(filename, "rb");
+	if (!f)
+		return NULL;
+
+	uint32_t *result = NULL;
+	char      magic[8];
+	if (fread(magic, 8, 1, f) == 0 || strncmp(magic, "firmprf2", 8) != 0)
+		goto end;
+
+	unsigned char header[8];
+	if (fread(header, 8, 1, f) == 0)
+		goto end;
+	*n_blocks = get_le32(&header[0]);
+	*hash     = get_le32(&header[4]);
+
+	result = XMALLOCN(uint32_t, *n_blocks);
+	for (uint32_t i = 0; i < *n_blocks; ++i) {
+		unsigned char bytes[4];
+		if (fread(bytes, 4, 1, f) == 0) {
+			free(result);
+			result = NULL;
+			goto end;
+		}
+		result[i] = get_le32(bytes);
+	}
+
+end:
+	fclose(f);
+	return result;
+}
+
+static bool write_v2_profile(const char *filename, const uint32_t *counters,
+                             uint32_t n_blocks, uint32_t hash)
+{
+	FILE *const f = fopen(filename, "wb");
+	if (!f)
+		return false;
+
+	bool ok = fwrite("firmprf2", 8, 1, f) == 1;
+	unsigned char header[8] = {
+		(n_blocks >>  0) & 0xff, (n_blocks >>  8) & 0xff,
+		(n_blocks >> 16) & 0xff, (n_blocks >> 24) & 0xff,
+		(hash     >>  0) & 0xff, (hash     >>  8) & 0xff,
+		(hash     >> 16) & 0xff, (hash     >> 24) & 0xff,
+	};
+	ok &= fwrite(header, 8, 1, f) == 1;
+	for (uint32_t i = 0; ok && i < n_blocks; ++i) {
+		unsigned char bytes[4] = {
+			(counters[i] >>  0) & 0xff, (counters[i] >>  8) & 0xff,
+			(counters[i] >> 16) & 0xff, (counters[i] >> 24) & 0xff,
+		};
+		ok &= fwrite(bytes, 4, 1, f) == 1;
+	}
+	fclose(f);
+	return ok;
+}
+
+bool ir_profile_merge_files(const char *dst_filename, const char *src_filename)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.ir.profile");
+
+	uint32_t  src_blocks;
+	uint32_t  src_hash;
+	uint32_t *src = read_v2_profile(src_filename, &src_blocks, &src_hash);
+	if (src == NULL) {
+		DBG((dbg, LEVEL_2, "Cannot read profile '%s'\n", src_filename));
+		return false;
+	}
+
+	uint32_t  dst_blocks;
+	uint32_t  dst_hash;
+	uint32_t *dst = read_v2_profile(dst_filename, &dst_blocks, &dst_hash);
+	if (dst != NULL) {
+		if (dst_blocks != src_blocks || dst_hash != src_hash) {
+			DBG((dbg, LEVEL_2, "Profiles '%s' and '%s' do not match\n",
+			     dst_filename, src_filename));
+			free(src);
+			free(dst);
+			return false;
+		}
+		/* sum saturating, long running services may wrap 32bit counts */
+		for (uint32_t i = 0; i < src_blocks; ++i) {
+			uint64_t const sum = (uint64_t)src[i] + (uint64_t)dst[i];
+			src[i] = sum > UINT32_MAX ? UINT32_MAX : (uint32_t)sum;
+		}
+		free(dst);
+	}
+
+	bool const ok = write_v2_profile(dst_filename, src, src_blocks, src_hash);
+	free(src);
+	return ok;
+}
@@ -37,6 +37,11 @@ bool ir_profile_read(const char *filename);
  */
 void ir_profile_free(void);
 
+/**
+ * Returns true if profile info has been read and is available.
+ */
+bool ir_profile_is_loaded(void);
+
 /**
  * Get block execution count as determined be profiling
  */
@@ -47,4 +52,12 @@ uint32_t ir_profile_get_block_execcount(const ir_node *block);
  */
 void ir_create_execfreqs_from_profile(void);
 
+/**
+ * Merges the v2 profile @p src_filename into @p dst_filename. Both files
+ * must stem from the same compilation (same block count and staleness
+ * hash); counters are summed with saturation. If @p dst_filename does not
+ * exist yet it becomes a copy of the source profile.
+ */
+bool ir_profile_merge_files(const char *dst_filename, const char *src_filename);
+
 #endif
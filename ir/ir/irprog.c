@@ -15,7 +15,9 @@
 #include "ident_t.h"
 #include "ircons.h"
 #include "irgraph_t.h"
+#include "irgwalk.h"
 #include "irmemory.h"
+#include "irnode_t.h"
 #include "irop_t.h"
 #include "obst.h"
 
@@ -303,6 +305,27 @@ ident *get_irp_asm(size_t pos)
 	return irp->global_asms[pos];
 }
 
+static void renumber_node(ir_node *node, void *env)
+{
+	(void)env;
+	node->node_nr = get_irp_new_node_nr();
+}
+
+void ir_normalize_node_nrs(void)
+{
+	/* The walk order only depends on the graph structure, so handing out
+	 * numbers along it makes them independent of how many nodes were
+	 * allocated (and possibly discarded again) while building the graphs. */
+	irp->max_node_nr = 0;
+	irg_walk_anchors(get_const_code_irg(), renumber_node, NULL, NULL);
+	foreach_irp_irg(i, irg) {
+#ifdef DEBUG_libfirm
+		irg->graph_nr = get_irp_new_node_nr();
+#endif
+		irg_walk_anchors(irg, renumber_node, NULL, NULL);
+	}
+}
+
 void (irp_reserve_resources)(ir_prog *irp, irp_resources_t resources)
 {
 	irp_reserve_resources_(irp, resources);
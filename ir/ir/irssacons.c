@@ -24,12 +24,14 @@ static void (*ssa_cons_walker)(ir_graph *, irg_walk_func *, irg_walk_func *, voi
 static void prepare_blocks(ir_node *block, void *env)
 {
 	(void)env;
-	ir_graph *const irg   = get_irn_irg(block);
-	unsigned  const n_loc = irg->n_loc;
+	ir_graph *const irg = get_irn_irg(block);
 	/* reset mature flag */
 	if (block != get_irg_start_block(irg))
 		set_Block_matured(block, 0);
-	block->attr.block.graph_arr = NEW_ARR_DZ(ir_node*, get_irg_obstack(irg), n_loc);
+	/* The value array is allocated on demand when a value is first
+	 * defined or searched in this block, so graphs with many values get
+	 * Phi bookkeeping only in the blocks that actually touch them. */
+	block->attr.block.graph_arr = NULL;
 	set_Block_phis(block, NULL);
 }
 
@@ -11,11 +11,13 @@
  */
 #include "irverify_t.h"
 
+#include "firm_thread.h"
 #include "ircons.h"
 #include "irdom_t.h"
 #include "irdump.h"
 #include "iredges_t.h"
 #include "irflag_t.h"
+#include "irgopt.h"
 #include "irgraph_t.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
@@ -1290,9 +1292,56 @@ int irg_verify(ir_graph *irg)
 		fine &= check_has_memory(irg);
 	}
 
+	/* remember up to which node index the graph is known good, so
+	 * irg_verify_incremental() only has to look at younger nodes */
+	if (fine)
+		irg->last_verified_idx = irg->last_node_idx;
+
+	return fine;
+}
+
+int irg_verify_incremental(ir_graph *irg)
+{
+	/* without the watermark of an earlier full check there is nothing to be
+	 * incremental about */
+	if (irg->last_verified_idx == 0)
+		return irg_verify(irg);
+
+	bool           fine = true;
+	unsigned const last = irg->last_node_idx;
+	for (unsigned idx = irg->last_verified_idx; idx < last; ++idx) {
+		ir_node *const node = get_idx_irn(irg, idx);
+		/* freed and exchanged nodes are of no interest */
+		if (node == NULL || is_Deleted(node) || is_Id(node))
+			continue;
+		fine &= irn_verify(node);
+	}
+	if (fine)
+		irg->last_verified_idx = last;
 	return fine;
 }
 
+/** Result accumulated by the parallel verification workers. */
+static bool irp_verify_fine;
+
+static void irp_verify_irg(ir_graph *irg)
+{
+	if (!irg_verify(irg)) {
+		firm_intern_lock();
+		irp_verify_fine = false;
+		firm_intern_unlock();
+	}
+}
+
+int irp_verify(unsigned n_threads)
+{
+	if (n_threads == 0)
+		n_threads = firm_parallel_default_threads();
+	irp_verify_fine = true;
+	run_irg_pipeline_parallel(irp_verify_irg, n_threads);
+	return irp_verify_fine;
+}
+
 void irg_assert_verify(ir_graph *irg)
 {
 	bool fine = irg_verify(irg);
@@ -13,6 +13,7 @@
 #include "hashptr.h"
 #include "irnode_t.h"
 #include "iropt_t.h"
+#include "raw_bitset.h"
 
 static ir_valueset_entry_t null_valueset_entry;
 
@@ -44,8 +45,8 @@ ir_valueset_entry_t *ir_valueset_find_(const ir_valueset_t *self,
 #define hashset_find            ir_valueset_find_
 #define hashset_size            ir_valueset_size
 
-#define ADDITIONAL_INIT         INIT_LIST_HEAD(&self->elem_list); INIT_LIST_HEAD(&self->all_iters);
-#define ADDITIONAL_TERM         INIT_LIST_HEAD(&self->elem_list); INIT_LIST_HEAD(&self->all_iters);
+#define ADDITIONAL_INIT         INIT_LIST_HEAD(&self->elem_list); INIT_LIST_HEAD(&self->all_iters); self->filter = NULL; self->filter_size = 0;
+#define ADDITIONAL_TERM         INIT_LIST_HEAD(&self->elem_list); INIT_LIST_HEAD(&self->all_iters); free(self->filter); self->filter = NULL; self->filter_size = 0;
 
 #define HAVE_OWN_RESIZE
 
@@ -63,7 +64,7 @@ static void resize(HashSet *self, size_t new_size)
 	int          res = 1;
 
 	/* allocate a new array with double size */
-	new_entries = Alloc(new_size);
+	new_entries = alloc_entries(self, new_size);
 	SetRangeEmpty(new_entries, new_size);
 
 	/* use the new array */
@@ -93,8 +94,45 @@ static void resize(HashSet *self, size_t new_size)
 	Free(old_entries);
 }
 
+/**
+ * Marks a value in the membership filter, a raw bitset indexed by the
+ * node index of the value.  The filter is one-sided: a clear bit proves
+ * the value is absent, a set bit may be stale after a remove.
+ * @internal
+ */
+static void filter_set(ir_valueset_t *valueset, const ir_node *value)
+{
+	size_t const pos = get_irn_idx(value);
+	if (pos >= valueset->filter_size) {
+		size_t new_size = valueset->filter_size ? valueset->filter_size : 256;
+		while (pos >= new_size)
+			new_size <<= 1;
+		valueset->filter = XREALLOC(valueset->filter, unsigned,
+		                            BITSET_SIZE_ELEMS(new_size));
+		memset(valueset->filter + BITSET_SIZE_ELEMS(valueset->filter_size), 0,
+		       (BITSET_SIZE_ELEMS(new_size)
+		        - BITSET_SIZE_ELEMS(valueset->filter_size)) * sizeof(unsigned));
+		valueset->filter_size = new_size;
+	}
+	rbitset_set(valueset->filter, pos);
+}
+
+/**
+ * Returns true if the value may be in the set.  A negative answer is
+ * exact and saves probing the hash.
+ * @internal
+ */
+static bool filter_maybe_contains(const ir_valueset_t *valueset,
+                                  const ir_node *value)
+{
+	size_t const pos = get_irn_idx(value);
+	return pos < valueset->filter_size
+	    && rbitset_is_set(valueset->filter, pos);
+}
+
 int ir_valueset_insert(ir_valueset_t *valueset, ir_node *value, ir_node *expr)
 {
+	filter_set(valueset, value);
 	ir_valueset_entry_t *entry = ir_valueset_insert_(valueset, value);
 
 	if (entry->list.next != NULL) {
@@ -111,6 +149,7 @@ int ir_valueset_insert(ir_valueset_t *valueset, ir_node *value, ir_node *expr)
 int ir_valueset_replace(ir_valueset_t *valueset, ir_node *value, ir_node *expr)
 {
 	int res = 0;
+	filter_set(valueset, value);
 	ir_valueset_entry_t *entry = ir_valueset_insert_(valueset, value);
 
 	if (entry->expr != expr) {
@@ -127,6 +166,10 @@ int ir_valueset_replace(ir_valueset_t *valueset, ir_node *value, ir_node *expr)
 
 void *ir_valueset_lookup(const ir_valueset_t *valueset, const ir_node *value)
 {
+	/* The hot callers of GVN-PRE probe many sets where the value is
+	 * absent; the filter answers those without touching the hash. */
+	if (!filter_maybe_contains(valueset, value))
+		return NULL;
 	ir_valueset_entry_t *entry = ir_valueset_find_(valueset, value);
 	if (entry != NULL)
 		return entry->expr;
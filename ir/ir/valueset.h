@@ -23,7 +23,7 @@ typedef struct ir_valueset_entry_t {
 
 #define HashSet          ir_valueset_t
 #define ValueType        ir_valueset_entry_t
-#define ADDITIONAL_DATA  list_head elem_list; list_head all_iters;
+#define ADDITIONAL_DATA  list_head elem_list; list_head all_iters; unsigned *filter; size_t filter_size;
 #undef DO_REHASH
 
 #include "hashset.h"
@@ -21,6 +21,7 @@
 #include "pbqp_node.h"
 #include "pbqp_node_t.h"
 #include "vector.h"
+#include "xmalloc.h"
 #include <assert.h>
 #include <stdbool.h>
 
@@ -52,6 +53,32 @@ static void apply_brute_force_reductions(pbqp_t *pbqp)
 	}
 }
 
+/**
+ * Selects the node to enumerate next: branching on the node where a
+ * decision fixes the most cost matrices weighs the vector length (the
+ * branching factor) by the degree.
+ */
+static pbqp_node_t *get_brute_force_node(void)
+{
+	pbqp_node_t **bucket     = node_buckets[3];
+	unsigned      bucket_len = node_bucket_get_length(bucket);
+	unsigned      max_weight = 0;
+	pbqp_node_t  *result     = NULL;
+
+	for (unsigned bucket_index = 0; bucket_index < bucket_len; ++bucket_index) {
+		pbqp_node_t *candidate = bucket[bucket_index];
+		unsigned     weight    = pbqp_node_get_degree(candidate)
+		                       * candidate->costs->len;
+
+		if (weight > max_weight) {
+			result     = candidate;
+			max_weight = weight;
+		}
+	}
+
+	return result;
+}
+
 static unsigned get_minimal_alternative(pbqp_t *pbqp, pbqp_node_t *node)
 {
 	vector_t *node_vec     = node->costs;
@@ -60,7 +87,33 @@ static unsigned get_minimal_alternative(pbqp_t *pbqp, pbqp_node_t *node)
 	num       min          = INF_COSTS;
 	unsigned  bucket_index = node->bucket_index;
 
-	for (unsigned node_index = 0; node_index < node_len; ++node_index) {
+	/* Try the alternatives in the order of their own cost: a cheap
+	 * alternative evaluated early yields a good bound for pruning the
+	 * remaining ones. */
+	unsigned *order = ALLOCAN(unsigned, node_len);
+	for (unsigned i = 0; i < node_len; ++i)
+		order[i] = i;
+	for (unsigned i = 1; i < node_len; ++i) {
+		unsigned index = order[i];
+		num      key   = node_vec->entries[index].data;
+		unsigned o     = i;
+		for ( ; o > 0 && node_vec->entries[order[o-1]].data > key; --o)
+			order[o] = order[o-1];
+		order[o] = index;
+	}
+
+	for (unsigned order_index = 0; order_index < node_len; ++order_index) {
+		unsigned node_index = order[order_index];
+
+#if KAPS_USE_UNSIGNED
+		/* Branch and bound: all costs are non-negative, so the node's own
+		 * cost of an alternative is a lower bound on the value of the whole
+		 * subproblem. Since the alternatives are sorted, all following ones
+		 * are pruned as well. */
+		if (node_vec->entries[node_index].data >= min)
+			break;
+#endif
+
 		pbqp_node_bucket_t bucket_deg3;
 		num                value;
 		unsigned           bucket_0_length;
@@ -122,8 +175,8 @@ static unsigned get_minimal_alternative(pbqp_t *pbqp, pbqp_node_t *node)
 
 static void apply_Brute_Force(pbqp_t *pbqp)
 {
-	/* We want to reduce a node with maximum degree. */
-	pbqp_node_t *node = get_node_with_max_degree();
+	/* We want to reduce the node with the biggest branching impact. */
+	pbqp_node_t *node = get_brute_force_node();
 	assert(pbqp_node_get_degree(node) > 2);
 
 #if KAPS_DUMP
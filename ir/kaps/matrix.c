@@ -16,6 +16,10 @@
 #include <assert.h>
 #include <string.h>
 
+#if defined(__SSE2__) && KAPS_USE_UNSIGNED
+#include <emmintrin.h>
+#endif
+
 pbqp_matrix_t *pbqp_matrix_alloc(pbqp_t *pbqp, unsigned rows, unsigned cols)
 {
 	assert(cols > 0);
@@ -76,9 +80,7 @@ void pbqp_matrix_add(pbqp_matrix_t *sum, pbqp_matrix_t *summand)
 
 	unsigned len = sum->rows * sum->cols;
 
-	for (unsigned i = 0; i < len; ++i) {
-		sum->entries[i] = pbqp_add(sum->entries[i], summand->entries[i]);
-	}
+	pbqp_add_array(sum->entries, summand->entries, len);
 }
 
 void pbqp_matrix_set_col_value(pbqp_matrix_t *mat, unsigned col, num value)
@@ -185,11 +187,44 @@ num pbqp_matrix_get_row_min(pbqp_matrix_t *matrix, unsigned row_index, vector_t
 
 	assert(matrix->cols == len);
 
-	for (unsigned col_index = 0; col_index < len; ++col_index) {
+	num const *row       = &matrix->entries[row_index * len];
+	unsigned   col_index = 0;
+
+#if defined(__SSE2__) && KAPS_USE_UNSIGNED && !KAPS_ENABLE_VECTOR_NAMES
+	/* Oring the flag comparison mask into the entry forces virtually
+	 * deleted columns to INF_COSTS (all bits set), which never wins the
+	 * minimum unless every column is deleted -- the same result the
+	 * scalar loop produces. SSE2 only compares signed integers, so both
+	 * operands are biased before comparing. */
+	if (len >= 4) {
+		num const    *flag_data = &flags->entries[0].data;
+		__m128i const inf       = _mm_set1_epi32((int)INF_COSTS);
+		__m128i const bias      = _mm_set1_epi32(INT_MIN);
+		__m128i       min4      = inf;
+		for (; col_index + 4 <= len; col_index += 4) {
+			__m128i const elem = _mm_loadu_si128((__m128i const*)&row[col_index]);
+			__m128i const flag = _mm_loadu_si128((__m128i const*)&flag_data[col_index]);
+			__m128i const cand = _mm_or_si128(elem, _mm_cmpeq_epi32(flag, inf));
+			__m128i const gt   = _mm_cmpgt_epi32(_mm_xor_si128(min4, bias),
+			                                     _mm_xor_si128(cand, bias));
+			min4 = _mm_or_si128(_mm_and_si128(gt, cand),
+			                    _mm_andnot_si128(gt, min4));
+		}
+
+		num lanes[4];
+		_mm_storeu_si128((__m128i*)lanes, min4);
+		for (unsigned lane = 0; lane < 4; ++lane) {
+			if (lanes[lane] < min) {
+				min = lanes[lane];
+			}
+		}
+	}
+#endif
+	for (; col_index < len; ++col_index) {
 		/* Ignore virtual deleted columns. */
 		if (flags->entries[col_index].data == INF_COSTS) continue;
 
-		num elem = matrix->entries[row_index * len + col_index];
+		num elem = row[col_index];
 
 		if (elem < min) {
 			min = elem;
@@ -277,9 +312,8 @@ void pbqp_matrix_add_to_all_cols(pbqp_matrix_t *mat, vector_t *vec)
 	for (unsigned row_index = 0; row_index < row_len; ++row_index) {
 		num value = vec->entries[row_index].data;
 
-		for (unsigned col_index = 0; col_index < col_len; ++col_index) {
-			mat->entries[row_index * col_len + col_index] = pbqp_add(mat->entries[row_index * col_len + col_index], value);
-		}
+		pbqp_add_array_value(&mat->entries[row_index * col_len], value,
+		                     col_len);
 	}
 }
 
@@ -291,10 +325,15 @@ void pbqp_matrix_add_to_all_rows(pbqp_matrix_t *mat, vector_t *vec)
 	assert(col_len == vec->len);
 
 	for (unsigned row_index = 0; row_index < row_len; ++row_index) {
+#if KAPS_ENABLE_VECTOR_NAMES
 		for (unsigned col_index = 0; col_index < col_len; ++col_index) {
 			num value = vec->entries[col_index].data;
 
 			mat->entries[row_index * col_len + col_index] = pbqp_add(mat->entries[row_index * col_len + col_index], value);
 		}
+#else
+		pbqp_add_array(&mat->entries[row_index * col_len],
+		               &vec->entries[0].data, col_len);
+#endif
 	}
 }
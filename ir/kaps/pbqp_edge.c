@@ -48,8 +48,10 @@ pbqp_edge_t *alloc_edge(pbqp_t *pbqp, unsigned src_index, unsigned tgt_index,
 	 * Connect edge with incident nodes. Since the edge is allocated, we know
 	 * that it don't appear in the edge lists of the nodes.
 	 */
+	edge->src_index = ARR_LEN(src_node->edges);
 	ARR_APP1(pbqp_edge_t *, src_node->edges, edge);
 	edge->src = src_node;
+	edge->tgt_index = ARR_LEN(tgt_node->edges);
 	ARR_APP1(pbqp_edge_t *, tgt_node->edges, edge);
 	edge->tgt = tgt_node;
 	edge->bucket_index = UINT_MAX;
@@ -19,6 +19,8 @@ struct pbqp_edge_t {
 	pbqp_node_t   *tgt;                  /* Target index. */
 	pbqp_matrix_t *costs;                /* Cost matrix. */
 	unsigned       bucket_index;         /* Index of edge bucket. */
+	unsigned       src_index;            /* Position in src->edges. */
+	unsigned       tgt_index;            /* Position in tgt->edges. */
 };
 
 #endif
@@ -40,34 +40,32 @@ int is_connected(pbqp_node_t *node, pbqp_edge_t *edge)
 	if (edge->src != node && edge->tgt != node)
 		return 0;
 
-	pbqp_edge_t **edges    = node->edges;
-	size_t        edge_len = ARR_LEN(edges);
+	unsigned edge_index = edge->src == node ? edge->src_index
+	                                        : edge->tgt_index;
 
-	for (size_t edge_index = 0; edge_index < edge_len; ++edge_index) {
-		pbqp_edge_t *edge_candidate = edges[edge_index];
-
-		if (edge_candidate == edge) {
-			return 1;
-		}
-	}
-
-	return 0;
+	return edge_index < ARR_LEN(node->edges)
+	       && node->edges[edge_index] == edge;
 }
 
 void disconnect_edge(pbqp_node_t *node, pbqp_edge_t *edge)
 {
-	pbqp_edge_t **edges    = node->edges;
-	size_t        edge_len = ARR_LEN(edges);
-
-	for (size_t edge_index = 0; edge_index < edge_len; ++edge_index) {
-		pbqp_edge_t *edge_candidate = edges[edge_index];
-
-		if (edge_candidate == edge) {
-			edges[edge_index] = edges[edge_len - 1];
-			ARR_SHRINKLEN(edges, (int)edge_len - 1);
-			break;
-		}
+	assert(is_connected(node, edge));
+
+	pbqp_edge_t **edges      = node->edges;
+	size_t        edge_len   = ARR_LEN(edges);
+	unsigned      edge_index = edge->src == node ? edge->src_index
+	                                             : edge->tgt_index;
+
+	/* Move the last edge into the vacated slot and update its position. */
+	pbqp_edge_t *other = edges[edge_len - 1];
+	if (other->src == node) {
+		other->src_index = edge_index;
+	} else {
+		other->tgt_index = edge_index;
 	}
+	edges[edge_index] = other;
+
+	ARR_SHRINKLEN(edges, (int)edge_len - 1);
 }
 
 unsigned pbqp_node_get_degree(pbqp_node_t *node)
@@ -127,6 +125,11 @@ pbqp_node_t *pbqp_node_deep_copy(pbqp_t *pbqp, pbqp_node_bucket_t new_bucket,
 			}
 		}
 
+		if (edge_copy->src == copy) {
+			edge_copy->src_index = edge_index;
+		} else {
+			edge_copy->tgt_index = edge_index;
+		}
 		ARR_APP1(pbqp_edge_t *, copy->edges, edge_copy);
 	}
 
@@ -14,6 +14,10 @@
 #include "adt/array.h"
 #include <string.h>
 
+#if defined(__SSE2__) && KAPS_USE_UNSIGNED
+#include <emmintrin.h>
+#endif
+
 num pbqp_add(num x, num y)
 {
 	if (x == INF_COSTS || y == INF_COSTS)
@@ -37,6 +41,49 @@ num pbqp_add(num x, num y)
 	return res;
 }
 
+void pbqp_add_array(num *dst, num const *src, unsigned len)
+{
+	unsigned i = 0;
+
+#if defined(__SSE2__) && KAPS_USE_UNSIGNED
+	/* INF_COSTS has all bits set, so saturation amounts to oring the
+	 * equality masks of both operands into the sum. Wrapping additions of
+	 * finite costs cannot occur (see the asserts in pbqp_add). */
+	__m128i const inf = _mm_set1_epi32((int)INF_COSTS);
+	for (; i + 4 <= len; i += 4) {
+		__m128i const x   = _mm_loadu_si128((__m128i const*)&dst[i]);
+		__m128i const y   = _mm_loadu_si128((__m128i const*)&src[i]);
+		__m128i const sum = _mm_add_epi32(x, y);
+		__m128i const sat = _mm_or_si128(_mm_cmpeq_epi32(x, inf),
+		                                 _mm_cmpeq_epi32(y, inf));
+		_mm_storeu_si128((__m128i*)&dst[i], _mm_or_si128(sum, sat));
+	}
+#endif
+	for (; i < len; ++i) {
+		dst[i] = pbqp_add(dst[i], src[i]);
+	}
+}
+
+void pbqp_add_array_value(num *dst, num value, unsigned len)
+{
+	unsigned i = 0;
+
+#if defined(__SSE2__) && KAPS_USE_UNSIGNED
+	__m128i const inf  = _mm_set1_epi32((int)INF_COSTS);
+	__m128i const val  = _mm_set1_epi32((int)value);
+	__m128i const vinf = _mm_cmpeq_epi32(val, inf);
+	for (; i + 4 <= len; i += 4) {
+		__m128i const x   = _mm_loadu_si128((__m128i const*)&dst[i]);
+		__m128i const sum = _mm_add_epi32(x, val);
+		__m128i const sat = _mm_or_si128(_mm_cmpeq_epi32(x, inf), vinf);
+		_mm_storeu_si128((__m128i*)&dst[i], _mm_or_si128(sum, sat));
+	}
+#endif
+	for (; i < len; ++i) {
+		dst[i] = pbqp_add(dst[i], value);
+	}
+}
+
 vector_t *vector_alloc(pbqp_t *pbqp, unsigned length)
 {
 	vector_t *vec = (vector_t *)obstack_alloc(&pbqp->obstack, sizeof(*vec) + sizeof(*vec->entries) * length);
@@ -63,9 +110,13 @@ void vector_add(vector_t *sum, vector_t *summand)
 
 	assert(len == summand->len);
 
+#if KAPS_ENABLE_VECTOR_NAMES
 	for (unsigned i = 0; i < len; ++i) {
 		sum->entries[i].data = pbqp_add(sum->entries[i].data, summand->entries[i].data);
 	}
+#else
+	pbqp_add_array(&sum->entries[0].data, &summand->entries[0].data, len);
+#endif
 }
 
 void vector_set(vector_t *vec, unsigned index, num value)
@@ -86,9 +137,13 @@ void vector_add_value(vector_t *vec, num value)
 {
 	unsigned len = vec->len;
 
+#if KAPS_ENABLE_VECTOR_NAMES
 	for (unsigned index = 0; index < len; ++index) {
 		vec->entries[index].data = pbqp_add(vec->entries[index].data, value);
 	}
+#else
+	pbqp_add_array_value(&vec->entries[0].data, value, len);
+#endif
 }
 
 void vector_add_matrix_col(vector_t *vec, pbqp_matrix_t *mat, unsigned col_index)
@@ -110,10 +165,14 @@ void vector_add_matrix_row(vector_t *vec, pbqp_matrix_t *mat, unsigned row_index
 	assert(len == mat->cols);
 	assert(row_index < mat->rows);
 
-
+#if KAPS_ENABLE_VECTOR_NAMES
 	for (unsigned index = 0; index < len; ++index) {
 		vec->entries[index].data = pbqp_add(vec->entries[index].data, mat->entries[row_index * mat->cols + index]);
 	}
+#else
+	pbqp_add_array(&vec->entries[0].data, &mat->entries[row_index * mat->cols],
+	               len);
+#endif
 }
 
 num vector_get_min(vector_t *vec)
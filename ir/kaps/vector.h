@@ -16,6 +16,12 @@
 
 num pbqp_add(num x, num y);
 
+/* dst[i] += src[i] with saturation at INF_COSTS */
+void pbqp_add_array(num *dst, num const *src, unsigned len);
+
+/* dst[i] += value with saturation at INF_COSTS */
+void pbqp_add_array_value(num *dst, num value, unsigned len);
+
 vector_t *vector_alloc(pbqp_t *pbqp, unsigned length);
 
 /* Copy the given vector. */
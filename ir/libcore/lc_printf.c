@@ -53,8 +53,11 @@ lc_arg_env_t *lc_arg_new_env(void)
 	return env;
 }
 
+static void lc_drop_compiled_fmts(const lc_arg_env_t *env);
+
 void lc_arg_free_env(lc_arg_env_t *env)
 {
+	lc_drop_compiled_fmts(env);
 	del_set(env->args);
 	free(env);
 }
@@ -308,27 +311,86 @@ static char *read_int(const char *s, int *value)
 	return endptr;
 }
 
-/* Generic printf() function. */
+/* Compiled formats.
+ *
+ * A format string is parsed once into a list of segments, each holding a
+ * literal run of text and an optional pre-parsed conversion occurrence.
+ * Repeated prints of the same format (the common case: the emitters and
+ * dumpers use string literals) then skip the character-by-character
+ * interpretation and the named-argument lookups. */
+
+typedef struct lc_fmt_seg_t {
+	const char     *text;     /**< literal text preceding the conversion */
+	size_t          text_len; /**< length of the literal text */
+	const lc_arg_t *arg;      /**< conversion to emit after the text or NULL */
+	lc_arg_occ_t    occ;      /**< pre-parsed occurrence for @p arg */
+} lc_fmt_seg_t;
+
+typedef struct lc_compiled_fmt_t {
+	char               *fmt;    /**< private copy of the format string */
+	const lc_arg_env_t *env;    /**< environment the format was compiled for */
+	unsigned            n_segs; /**< number of segments */
+	lc_fmt_seg_t       *segs;   /**< the segments */
+} lc_compiled_fmt_t;
+
+/** Compiled format cache, indexed by the hash of the format pointer. */
+#define LC_FMT_CACHE_SIZE   512
+#define LC_FMT_CACHE_PROBES 8
+
+static lc_compiled_fmt_t *lc_fmt_cache[LC_FMT_CACHE_SIZE];
+
+static void lc_free_compiled_fmt(lc_compiled_fmt_t *comp)
+{
+	free(comp->segs);
+	free(comp->fmt);
+	free(comp);
+}
 
-int lc_evpprintf(const lc_arg_env_t *env, lc_appendable_t *app, const char *fmt,
-                 va_list args)
+static void lc_drop_compiled_fmts(const lc_arg_env_t *env)
 {
-	(void)args;
+	for (unsigned i = 0; i < LC_FMT_CACHE_SIZE; ++i) {
+		lc_compiled_fmt_t *const entry = lc_fmt_cache[i];
+		if (entry != NULL && entry->env == env) {
+			lc_free_compiled_fmt(entry);
+			lc_fmt_cache[i] = NULL;
+		}
+	}
+}
 
-	int         res  = 0;
-	const char *last = fmt + strlen(fmt);
+static lc_fmt_seg_t *lc_add_seg(lc_compiled_fmt_t *comp, unsigned *capacity,
+                                const char *text, size_t text_len)
+{
+	if (comp->n_segs == *capacity) {
+		*capacity *= 2;
+		comp->segs = XREALLOC(comp->segs, lc_fmt_seg_t, *capacity);
+	}
+	lc_fmt_seg_t *const seg = &comp->segs[comp->n_segs++];
+	memset(seg, 0, sizeof(*seg));
+	seg->text     = text;
+	seg->text_len = text_len;
+	return seg;
+}
+
+static lc_compiled_fmt_t *lc_compile_fmt(const lc_arg_env_t *env,
+                                         const char *fmt_string)
+{
+	lc_compiled_fmt_t *const comp = XMALLOCZ(lc_compiled_fmt_t);
+	comp->fmt = xstrdup(fmt_string);
+	comp->env = env;
+	unsigned capacity = 8;
+	comp->segs = XMALLOCN(lc_fmt_seg_t, capacity);
+
+	const char *const fmt  = comp->fmt;
+	const char *const last = fmt + strlen(fmt);
 
 	/* Find the first % */
 	const char *s = strchr(fmt, '%');
 
-	/* Emit the text before the first % was found */
-	size_t addlen = (s ? s : last) - fmt;
-	lc_appendable_snadd(app, fmt, addlen);
-	res += addlen;
+	/* The text before the first % */
+	const char *text     = fmt;
+	size_t      text_len = (s ? s : last) - fmt;
 
 	while (s != NULL) {
-		lc_arg_value_t val;
-
 		/* We must be at a '%' */
 		assert(*s == '%');
 
@@ -382,9 +444,12 @@ int lc_evpprintf(const lc_arg_env_t *env, lc_appendable_t *app, const char *fmt,
 		const lc_arg_t *arg = NULL;
 		switch (ch) {
 			case '%':
+				/* flush the pending text and emit the '%' as the next
+				 * literal run */
+				lc_add_seg(comp, &capacity, text, text_len);
+				text     = s;
+				text_len = 1;
 				s++;
-				lc_appendable_chadd(app, '%');
-				++res;
 				break;
 			case '{': {
 				const char *named = ++s;
@@ -449,31 +514,86 @@ int lc_evpprintf(const lc_arg_env_t *env, lc_appendable_t *app, const char *fmt,
 			}
 		}
 
-		/* Call the handler if an argument was determined */
+		/* Record a segment if a conversion was determined */
 		if (arg != NULL && arg->handler != NULL) {
-			const lc_arg_handler_t *handler = arg->handler;
+			/* Let the handler determine the type of the argument based on
+			 * the information gathered. */
+			occ.lc_arg_type = arg->handler->get_lc_arg_type(&occ);
+
+			lc_fmt_seg_t *const seg = lc_add_seg(comp, &capacity, text,
+			                                     text_len);
+			seg->arg = arg;
+			seg->occ = occ;
+			text     = s;
+			text_len = 0;
+		}
 
-			/* Let the handler determine the type of the argument based on the
-			 * information gathered. */
-			occ.lc_arg_type = handler->get_lc_arg_type(&occ);
+		const char *old = s;
+		s = strchr(s, '%');
+		text_len += (s ? s : last) - old;
+	}
 
-			/* Store the value according to argument information */
-			switch (occ.lc_arg_type) {
+	/* trailing text */
+	if (text_len > 0)
+		lc_add_seg(comp, &capacity, text, text_len);
+
+	return comp;
+}
+
+static const lc_compiled_fmt_t *lc_get_compiled_fmt(const lc_arg_env_t *env,
+                                                    const char *fmt)
+{
+	/* The cache is keyed by the format pointer; since format strings are
+	 * almost always literals the pointer identifies the contents.  The
+	 * strcmp() below catches the rare reused buffer with new contents. */
+	unsigned const idx = hash_ptr(fmt) & (LC_FMT_CACHE_SIZE - 1);
+	unsigned       slot = idx;
+	for (unsigned i = 0; i < LC_FMT_CACHE_PROBES; ++i) {
+		slot = (idx + i) & (LC_FMT_CACHE_SIZE - 1);
+		lc_compiled_fmt_t *const entry = lc_fmt_cache[slot];
+		if (entry == NULL)
+			break;
+		if (entry->env == env && streq(entry->fmt, fmt))
+			return entry;
+	}
+
+	/* Compile the format, evicting whatever occupies the slot. */
+	if (lc_fmt_cache[slot] != NULL)
+		lc_free_compiled_fmt(lc_fmt_cache[slot]);
+	lc_compiled_fmt_t *const comp = lc_compile_fmt(env, fmt);
+	lc_fmt_cache[slot] = comp;
+	return comp;
+}
+
+/* Generic printf() function. */
+
+int lc_evpprintf(const lc_arg_env_t *env, lc_appendable_t *app, const char *fmt,
+                 va_list args)
+{
+	const lc_compiled_fmt_t *const comp = lc_get_compiled_fmt(env, fmt);
+
+	int res = 0;
+	for (unsigned i = 0, n = comp->n_segs; i < n; ++i) {
+		const lc_fmt_seg_t *const seg = &comp->segs[i];
+		if (seg->text_len > 0) {
+			lc_appendable_snadd(app, seg->text, seg->text_len);
+			res += seg->text_len;
+		}
+
+		const lc_arg_t *const arg = seg->arg;
+		if (arg == NULL)
+			continue;
+
+		/* Fetch the value according to the pre-computed argument type. */
+		lc_arg_value_t val;
+		switch (seg->occ.lc_arg_type) {
 #define LC_ARG_TYPE(type,name,va_type) \
-			case lc_arg_type_ ## name: val.v_ ## name = va_arg(args, va_type); break;
+		case lc_arg_type_ ## name: val.v_ ## name = va_arg(args, va_type); break;
 #include "lc_printf_arg_types.def"
 #undef LC_ARG_TYPE
-			}
-
-			/* Finally, call the handler. */
-			res += handler->emit(app, &occ, &val);
 		}
 
-		const char *old = s;
-		s = strchr(s, '%');
-		size_t addlen = (s ? s : last) - old;
-		lc_appendable_snadd(app, old, addlen);
-		res += addlen;
+		res += arg->handler->emit(app, &seg->occ, &val);
 	}
 
 	return res;
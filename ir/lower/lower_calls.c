@@ -700,12 +700,17 @@ static void get_dest_addrs(const cl_entry *entry, ir_node **ins,
 				continue;
 		}
 
-		ir_graph *irg   = get_irn_irg(dst);
-		ir_node  *frame = get_irg_frame(irg);
-		if (!is_Member(dst) || get_Member_ptr(dst) != frame)
+		/* The destination must be frame memory whose address never escapes:
+		 * then nobody can observe that the callee writes the result earlier
+		 * than the CopyB would have.  This covers plain locals as well as
+		 * fields and array elements of locals (and value parameter
+		 * entities), e.g. "s.field = f()". */
+		ir_graph  *irg     = get_irn_irg(dst);
+		ir_node   *frame   = get_irg_frame(irg);
+		ir_entity *dst_ent;
+		ir_node   *base    = find_base_adr(dst, &dst_ent);
+		if (base != frame || dst_ent == NULL)
 			continue;
-
-		ir_entity *dst_ent = get_Member_entity(dst);
 		if (get_entity_usage(dst_ent) & ir_usage_address_taken)
 			continue;
 
@@ -9,8 +9,10 @@
  * @author  Michael Beck, Matthias Braun, Manuel Mohr
  */
 #include "adt/list.h"
-#include "ircons.h"
+#include "ircons_t.h"
+#include "iredges_t.h"
 #include "irgmod.h"
+#include "irgraph_t.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
 #include "iroptimize.h"
@@ -20,6 +22,8 @@
 #include "target_t.h"
 #include "type_t.h"
 #include "util.h"
+#include "xmalloc.h"
+#include <stdint.h>
 
 static unsigned max_small_size; /**< The maximum size of a CopyB node
                                      so that it is regarded as 'small'. */
@@ -30,11 +34,20 @@ static bool allow_misalignments; /**< Whether backend can handle misaligned
                                       loads and stores. */
 
 typedef struct walk_env {
-	ir_node **copybs; /**< The list of CopyB nodes. */
+	ir_node **copybs;   /**< The list of CopyB nodes. */
+	ir_node **memcalls; /**< Small constant-size memset/memcpy/memcmp calls. */
 } walk_env_t;
 
+static ident *memset_id;
+static ident *memcpy_id;
+static ident *memcmp_id;
+
 static ir_mode *get_ir_mode(unsigned mode_bytes)
 {
+	ir_mode *const vector_mode = ir_target.mode_vector_copy;
+	if (vector_mode != NULL && mode_bytes == get_mode_size_bytes(vector_mode))
+		return vector_mode;
+
 	switch (mode_bytes) {
 	case 1:  return mode_Bu;
 	case 2:  return mode_Hu;
@@ -46,30 +59,45 @@ static ir_mode *get_ir_mode(unsigned mode_bytes)
 }
 
 /**
- * Turn a small CopyB node into a series of Load/Store nodes.
+ * Return the widest chunk size the target can legally use to expand a copy
+ * of type @p tp: the vector copy mode if its alignment constraints are met,
+ * otherwise the native word clamped to the type's alignment.
  */
-static void lower_small_copyb_node(ir_node *irn)
+static unsigned get_chunk_bytes(ir_type const *tp)
 {
-	ir_graph      *irg         = get_irn_irg(irn);
-	dbg_info      *dbgi        = get_irn_dbg_info(irn);
-	ir_node       *block       = get_nodes_block(irn);
-	ir_type       *tp          = get_CopyB_type(irn);
-	ir_node       *addr_src    = get_CopyB_src(irn);
-	ir_node       *addr_dst    = get_CopyB_dst(irn);
-	ir_node       *mem         = get_CopyB_mem(irn);
-	ir_mode       *mode_ref    = get_irn_mode(addr_src);
-	unsigned       mode_bytes  = allow_misalignments ? native_mode_bytes
-	                                                 : get_type_alignment(tp);
-	unsigned       size        = get_type_size(tp);
-	unsigned       offset      = 0;
-	bool           is_volatile = get_CopyB_volatility(irn) == volatility_is_volatile;
-	ir_cons_flags  flags       = is_volatile ? cons_volatile : cons_none;
+	unsigned const align = get_type_alignment(tp);
+	unsigned       bytes = allow_misalignments
+	                     ? native_mode_bytes : MIN(align, native_mode_bytes);
+
+	ir_mode *const vector_mode = ir_target.mode_vector_copy;
+	if (vector_mode != NULL) {
+		unsigned const vector_bytes = get_mode_size_bytes(vector_mode);
+		if (vector_bytes > bytes
+		 && (allow_misalignments || align >= vector_bytes))
+			bytes = vector_bytes;
+	}
+	return bytes;
+}
+
+/**
+ * Appends Load/Store pairs copying the bytes [offset, size) behind @p mem,
+ * halving the chunk size for the remainder.  Returns the resulting memory.
+ * With @p collect_consts the created offset constants are registered for
+ * later part_block() calls.
+ */
+static ir_node *copy_chunks(dbg_info *dbgi, ir_node *block, ir_node *addr_src,
+                            ir_node *addr_dst, ir_node *mem, ir_type *tp,
+                            ir_cons_flags flags, unsigned mode_bytes,
+                            unsigned offset, unsigned size,
+                            bool collect_consts)
+{
+	ir_graph *irg          = get_irn_irg(block);
+	ir_mode  *mode_ref     = get_irn_mode(addr_src);
+	ir_mode  *mode_ref_int = get_reference_offset_mode(mode_ref);
 
 	while (offset < size) {
 		ir_mode *mode = get_ir_mode(mode_bytes);
 		for (; offset + mode_bytes <= size; offset += mode_bytes) {
-			ir_mode *mode_ref_int = get_reference_offset_mode(mode_ref);
-
 			/* construct offset */
 			ir_node *addr_const = new_r_Const_long(irg, mode_ref_int, offset);
 			ir_node *add        = new_r_Add(block, addr_src, addr_const);
@@ -84,15 +112,135 @@ static void lower_small_copyb_node(ir_node *irn)
 			ir_node *store     = new_rd_Store(dbgi, block, load_mem, add2, load_res, tp, flags);
 			ir_node *store_mem = new_r_Proj(store, mode_M, pn_Store_M);
 
+			if (collect_consts) {
+				collect_new_start_block_node(addr_const);
+				collect_new_start_block_node(addr_const2);
+			}
+
 			mem = store_mem;
 		}
 
 		mode_bytes /= 2;
 	}
+	return mem;
+}
 
+/**
+ * Turn a small CopyB node into a series of Load/Store nodes.
+ */
+static void lower_small_copyb_node(ir_node *irn)
+{
+	dbg_info      *dbgi        = get_irn_dbg_info(irn);
+	ir_node       *block       = get_nodes_block(irn);
+	ir_type       *tp          = get_CopyB_type(irn);
+	ir_node       *addr_src    = get_CopyB_src(irn);
+	ir_node       *addr_dst    = get_CopyB_dst(irn);
+	ir_node       *mem         = get_CopyB_mem(irn);
+	unsigned       mode_bytes  = get_chunk_bytes(tp);
+	unsigned       size        = get_type_size(tp);
+	bool           is_volatile = get_CopyB_volatility(irn) == volatility_is_volatile;
+	ir_cons_flags  flags       = is_volatile ? cons_volatile : cons_none;
+
+	mem = copy_chunks(dbgi, block, addr_src, addr_dst, mem, tp, flags,
+	                  mode_bytes, 0, size, false);
 	exchange(irn, mem);
 }
 
+/**
+ * Turn a mid-sized CopyB node into an inline copy loop:
+ *
+ *     off = 0;
+ *     do {
+ *         *(dst + off) = *(src + off);   // one chunk per iteration
+ *         off += chunk;
+ *     } while (off < size - size % chunk);
+ *
+ * followed by an unrolled copy of the remainder.  The loop is cheaper than
+ * a memcpy call for moderate sizes and far smaller than full unrolling.
+ */
+static void lower_loop_copyb_node(ir_node *irn)
+{
+	ir_graph      *irg         = get_irn_irg(irn);
+	dbg_info      *dbgi        = get_irn_dbg_info(irn);
+	ir_type       *tp          = get_CopyB_type(irn);
+	ir_node       *addr_src    = get_CopyB_src(irn);
+	ir_node       *addr_dst    = get_CopyB_dst(irn);
+	ir_node       *mem         = get_CopyB_mem(irn);
+	ir_mode       *mode_ref    = get_irn_mode(addr_src);
+	ir_mode       *mode_off    = get_reference_offset_mode(mode_ref);
+	unsigned       chunk       = get_chunk_bytes(tp);
+	ir_mode       *mode        = get_ir_mode(chunk);
+	unsigned       size        = get_type_size(tp);
+	unsigned       looped      = size - size % chunk;
+	bool           is_volatile = get_CopyB_volatility(irn) == volatility_is_volatile;
+	ir_cons_flags  flags       = is_volatile ? cons_volatile : cons_none;
+
+	/* split the block; the CopyB's operands end up in the upper part */
+	ir_node *lower_block = get_nodes_block(irn);
+	part_block(irn);
+	ir_node *upper_block = get_nodes_block(irn);
+
+	/* the loop exit will feed lower_block instead of the jump */
+	assert(get_Block_n_cfgpreds(lower_block) == 1);
+	kill_node(get_Block_cfgpred(lower_block, 0));
+
+	/* Build the loop skeleton with preliminary single predecessors and close
+	 * the cycle afterwards; optimizations must be off so the intermediate
+	 * one-input Phis are not folded away. */
+	int rem_opt = get_optimize();
+	set_optimize(0);
+
+	ir_node *jmp_entry  = new_r_Jmp(upper_block);
+	ir_node *loop_block = new_r_Block(irg, 1, &jmp_entry);
+	ir_node *zero       = new_r_Const_null(irg, mode_off);
+	ir_node *phi_off    = new_r_Phi(loop_block, 1, &zero, mode_off);
+	ir_node *phi_mem    = new_r_Phi(loop_block, 1, &mem, mode_M);
+
+	ir_node *src_add    = new_rd_Add(dbgi, loop_block, addr_src, phi_off);
+	ir_node *load       = new_rd_Load(dbgi, loop_block, phi_mem, src_add, mode, tp, flags);
+	ir_node *load_res   = new_r_Proj(load, mode, pn_Load_res);
+	ir_node *load_mem   = new_r_Proj(load, mode_M, pn_Load_M);
+	ir_node *dst_add    = new_rd_Add(dbgi, loop_block, addr_dst, phi_off);
+	ir_node *store      = new_rd_Store(dbgi, loop_block, load_mem, dst_add, load_res, tp, flags);
+	ir_node *store_mem  = new_r_Proj(store, mode_M, pn_Store_M);
+
+	ir_node *chunk_cnst = new_r_Const_long(irg, mode_off, chunk);
+	ir_node *next_off   = new_rd_Add(dbgi, loop_block, phi_off, chunk_cnst);
+	ir_node *limit      = new_r_Const_long(irg, mode_off, looped);
+	ir_node *cmp        = new_rd_Cmp(dbgi, loop_block, next_off, limit,
+	                                 ir_relation_less);
+	ir_node *cond       = new_rd_Cond(dbgi, loop_block, cmp);
+	ir_node *proj_true  = new_r_Proj(cond, mode_X, pn_Cond_true);
+	ir_node *proj_false = new_r_Proj(cond, mode_X, pn_Cond_false);
+
+	/* close the loop */
+	ir_node *loop_in[] = { jmp_entry, proj_true };
+	set_irn_in(loop_block, ARRAY_SIZE(loop_in), loop_in);
+	ir_node *off_in[] = { zero, next_off };
+	set_irn_in(phi_off, ARRAY_SIZE(off_in), off_in);
+	ir_node *mem_in[] = { mem, store_mem };
+	set_irn_in(phi_mem, ARRAY_SIZE(mem_in), mem_in);
+
+	ir_node *lower_in[] = { proj_false };
+	set_irn_in(lower_block, ARRAY_SIZE(lower_in), lower_in);
+
+	set_optimize(rem_opt);
+
+	/* bookkeeping for further part_block() calls on this graph */
+	collect_new_start_block_node(zero);
+	collect_new_start_block_node(chunk_cnst);
+	collect_new_start_block_node(limit);
+	collect_new_phi_node(phi_off);
+	collect_new_phi_node(phi_mem);
+
+	/* copy the remainder behind the loop */
+	ir_node *res_mem = store_mem;
+	if (looped < size)
+		res_mem = copy_chunks(dbgi, lower_block, addr_src, addr_dst, store_mem,
+		                      tp, flags, chunk / 2, looped, size, true);
+	exchange(irn, res_mem);
+}
+
 static ir_type *get_memcpy_methodtype(void)
 {
 	ir_type *tp          = new_type_method(3, 1, false, cc_cdecl_set, mtp_no_property);
@@ -139,17 +287,261 @@ static void lower_large_copyb_node(ir_node *irn)
 	exchange(irn, call_mem);
 }
 
-static void lower_copyb_node(ir_node *irn)
+/**
+ * Reroutes the Projs of an expanded mem call: the memory users continue
+ * behind @p mem, the result users get @p value (may be NULL if the call has
+ * no value users).  The call itself is left dangling like an expanded Div.
+ */
+static void reroute_mem_call_projs(ir_node *call, ir_node *mem, ir_node *value)
+{
+	foreach_out_edge_safe(call, edge) {
+		ir_node *proj = get_edge_src_irn(edge);
+		if (!is_Proj(proj))
+			continue;
+
+		switch ((pn_Call)get_Proj_num(proj)) {
+		case pn_Call_M:
+			exchange(proj, mem);
+			continue;
+		case pn_Call_T_result:
+			foreach_out_edge_safe(proj, res_edge) {
+				ir_node *res = get_edge_src_irn(res_edge);
+				if (is_Proj(res))
+					exchange(res, value);
+			}
+			continue;
+		case pn_Call_X_regular:
+			exchange(proj, new_r_Jmp(get_nodes_block(call)));
+			continue;
+		case pn_Call_X_except:
+			break;
+		}
+		panic("unexpected Proj number");
+	}
+}
+
+/**
+ * Expands a small constant-size memset call into a series of Stores of a
+ * byte-splat constant, halving the chunk size for the remainder.
+ */
+static bool lower_small_memset_call(ir_node *call, unsigned size)
+{
+	dbg_info *dbgi         = get_irn_dbg_info(call);
+	ir_node  *block        = get_nodes_block(call);
+	ir_graph *irg          = get_irn_irg(call);
+	ir_node  *ptr          = get_Call_param(call, 0);
+	ir_node  *mem          = get_Call_mem(call);
+	ir_mode  *mode_ref_int = get_reference_offset_mode(get_irn_mode(ptr));
+	ir_type  *tp           = get_unknown_type();
+	long      value        = get_tarval_long(get_Const_tarval(get_Call_param(call, 1)));
+	uint64_t  byte         = (uint64_t)value & 0xff;
+
+	unsigned mode_bytes = native_mode_bytes;
+	unsigned offset     = 0;
+	while (offset < size) {
+		ir_mode *mode = get_ir_mode(mode_bytes);
+		uint64_t ones = UINT64_C(0x0101010101010101)
+		              >> ((8 - mode_bytes) * 8);
+		ir_node *splat = new_r_Const_long(irg, mode, (long)(byte * ones));
+		for (; offset + mode_bytes <= size; offset += mode_bytes) {
+			ir_node *addr_const = new_r_Const_long(irg, mode_ref_int, offset);
+			ir_node *add        = new_r_Add(block, ptr, addr_const);
+			ir_node *store      = new_rd_Store(dbgi, block, mem, add, splat,
+			                                   tp, cons_none);
+			mem = new_r_Proj(store, mode_M, pn_Store_M);
+		}
+		mode_bytes /= 2;
+	}
+
+	reroute_mem_call_projs(call, mem, ptr);
+	return true;
+}
+
+/**
+ * Expands a small constant-size memcpy call into Load/Store pairs.
+ */
+static bool lower_small_memcpy_call(ir_node *call, unsigned size)
+{
+	dbg_info *dbgi  = get_irn_dbg_info(call);
+	ir_node  *block = get_nodes_block(call);
+	ir_node  *dst   = get_Call_param(call, 0);
+	ir_node  *src   = get_Call_param(call, 1);
+	ir_node  *mem   = get_Call_mem(call);
+
+	unsigned chunk = native_mode_bytes;
+	ir_mode *const vector_mode = ir_target.mode_vector_copy;
+	if (vector_mode != NULL && get_mode_size_bytes(vector_mode) > chunk)
+		chunk = get_mode_size_bytes(vector_mode);
+
+	mem = copy_chunks(dbgi, block, src, dst, mem, get_unknown_type(),
+	                  cons_none, chunk, 0, size, false);
+	reroute_mem_call_projs(call, mem, dst);
+	return true;
+}
+
+/**
+ * Expands a small constant-size memcmp call whose result is only checked
+ * for (in)equality against zero into chunked Loads combined by Eor/Or.
+ * The users then compare the accumulated difference word against zero.
+ */
+static bool lower_small_memcmp_call(ir_node *call, unsigned size)
+{
+	/* find the result value and make sure all users just test for equality;
+	 * ordered comparisons need the position of the first difference and are
+	 * left to the library */
+	ir_node *res = NULL;
+	foreach_out_edge(call, edge) {
+		ir_node *proj = get_edge_src_irn(edge);
+		if (!is_Proj(proj) || get_Proj_num(proj) != pn_Call_T_result)
+			continue;
+		foreach_out_edge(proj, res_edge) {
+			ir_node *value = get_edge_src_irn(res_edge);
+			if (is_Proj(value))
+				res = value;
+		}
+	}
+	if (res != NULL) {
+		foreach_out_edge(res, edge) {
+			ir_node *user = get_edge_src_irn(edge);
+			if (!is_Cmp(user) || get_Cmp_left(user) != res)
+				return false;
+			ir_node *right = get_Cmp_right(user);
+			if (!is_Const(right) || !is_Const_null(right))
+				return false;
+			ir_relation relation = get_Cmp_relation(user);
+			if (relation != ir_relation_equal
+			 && relation != ir_relation_less_greater)
+				return false;
+		}
+	}
+
+	dbg_info *dbgi         = get_irn_dbg_info(call);
+	ir_node  *block        = get_nodes_block(call);
+	ir_graph *irg          = get_irn_irg(call);
+	ir_node  *ptr0         = get_Call_param(call, 0);
+	ir_node  *ptr1         = get_Call_param(call, 1);
+	ir_node  *mem          = get_Call_mem(call);
+	ir_mode  *mode_ref_int = get_reference_offset_mode(get_irn_mode(ptr0));
+	ir_mode  *acc_mode     = get_ir_mode(native_mode_bytes);
+	ir_type  *tp           = get_unknown_type();
+	ir_node  *acc          = NULL;
+
+	unsigned mode_bytes = native_mode_bytes;
+	unsigned offset     = 0;
+	while (offset < size && res != NULL) {
+		ir_mode *mode = get_ir_mode(mode_bytes);
+		for (; offset + mode_bytes <= size; offset += mode_bytes) {
+			ir_node *addr_const = new_r_Const_long(irg, mode_ref_int, offset);
+			ir_node *add0       = new_r_Add(block, ptr0, addr_const);
+			ir_node *load0      = new_rd_Load(dbgi, block, mem, add0, mode, tp,
+			                                  cons_none);
+			ir_node *res0       = new_r_Proj(load0, mode, pn_Load_res);
+			mem = new_r_Proj(load0, mode_M, pn_Load_M);
+
+			ir_node *addr_const1 = new_r_Const_long(irg, mode_ref_int, offset);
+			ir_node *add1        = new_r_Add(block, ptr1, addr_const1);
+			ir_node *load1       = new_rd_Load(dbgi, block, mem, add1, mode, tp,
+			                                   cons_none);
+			ir_node *res1        = new_r_Proj(load1, mode, pn_Load_res);
+			mem = new_r_Proj(load1, mode_M, pn_Load_M);
+
+			ir_node *diff = new_r_Eor(block, res0, res1);
+			if (mode != acc_mode)
+				diff = new_r_Conv(block, diff, acc_mode);
+			acc = acc == NULL ? diff : new_r_Or(block, acc, diff);
+		}
+		mode_bytes /= 2;
+	}
+
+	if (res != NULL) {
+		ir_node *zero = new_r_Const_null(irg, acc_mode);
+		foreach_out_edge_safe(res, edge) {
+			ir_node *user = get_edge_src_irn(edge);
+			ir_node *cmp  = new_r_Cmp(get_nodes_block(user), acc, zero,
+			                          get_Cmp_relation(user));
+			exchange(user, cmp);
+		}
+	}
+
+	reroute_mem_call_projs(call, mem, NULL);
+	return true;
+}
+
+/**
+ * Checks whether @p irn is a call to memset/memcpy/memcmp with a small
+ * constant size that is worth expanding inline.
+ */
+static bool is_small_mem_call(ir_node *irn)
+{
+	/* without the pointer alignment only wide misaligned accesses pay off */
+	if (!allow_misalignments || native_mode_bytes < 4)
+		return false;
+
+	ir_node *callee = get_Call_ptr(irn);
+	if (!is_Address(callee))
+		return false;
+	ident *name = get_entity_ld_ident(get_Address_entity(callee));
+	if (name != memset_id && name != memcpy_id && name != memcmp_id)
+		return false;
+	if (get_Call_n_params(irn) != 3 || ir_throws_exception(irn))
+		return false;
+
+	ir_node *size_arg = get_Call_param(irn, 2);
+	if (!is_Const(size_arg) || !tarval_is_long(get_Const_tarval(size_arg)))
+		return false;
+	long size = get_tarval_long(get_Const_tarval(size_arg));
+	if (size <= 0 || (unsigned long)size > max_small_size)
+		return false;
+
+	if (name == memset_id && !is_Const(get_Call_param(irn, 1)))
+		return false;
+	return true;
+}
+
+static bool lower_small_mem_call(ir_node *call)
+{
+	ir_node  *callee = get_Call_ptr(call);
+	ident    *name   = get_entity_ld_ident(get_Address_entity(callee));
+	unsigned  size
+		= get_tarval_long(get_Const_tarval(get_Call_param(call, 2)));
+
+	if (name == memset_id)
+		return lower_small_memset_call(call, size);
+	if (name == memcpy_id)
+		return lower_small_memcpy_call(call, size);
+	return lower_small_memcmp_call(call, size);
+}
+
+typedef enum copyb_strategy {
+	COPYB_SMALL,  /**< unrolled into Load/Store pairs */
+	COPYB_LOOP,   /**< expanded into an inline copy loop */
+	COPYB_MEMCPY, /**< turned into a memcpy call */
+} copyb_strategy;
+
+static copyb_strategy get_copyb_strategy(ir_node const *irn)
 {
 	ir_type *tp   = get_CopyB_type(irn);
 	unsigned size = get_type_size(tp);
 
 	if (size <= max_small_size)
-		lower_small_copyb_node(irn);
-	else if (size >= min_large_size)
-		lower_large_copyb_node(irn);
-	else
+		return COPYB_SMALL;
+	if (size < min_large_size)
 		panic("CopyB of invalid size");
+	/* A byte-wise loop is no match for memcpy; only expand a loop when the
+	 * chunks are reasonably wide. */
+	if (size <= ir_target.copyb_loop_max_size && get_chunk_bytes(tp) >= 4)
+		return COPYB_LOOP;
+	return COPYB_MEMCPY;
+}
+
+static void lower_copyb_node(ir_node *irn, copyb_strategy strategy)
+{
+	switch (strategy) {
+	case COPYB_SMALL:  lower_small_copyb_node(irn); return;
+	case COPYB_LOOP:   lower_loop_copyb_node(irn);  return;
+	case COPYB_MEMCPY: lower_large_copyb_node(irn); return;
+	}
+	panic("invalid copyb strategy");
 }
 
 /**
@@ -157,6 +549,13 @@ static void lower_copyb_node(ir_node *irn)
  */
 static void find_copyb_nodes(ir_node *irn, void *ctx)
 {
+	if (is_Call(irn)) {
+		walk_env_t *env = (walk_env_t*)ctx;
+		if (is_small_mem_call(irn))
+			ARR_APP1(ir_node*, env->memcalls, irn);
+		return;
+	}
+
 	if (!is_CopyB(irn))
 		return;
 
@@ -183,17 +582,61 @@ void lower_CopyB(ir_graph *irg, unsigned max_small_sz, unsigned min_large_sz,
 	min_large_size      = min_large_sz;
 	native_mode_bytes   = ir_target_pointer_size();
 	allow_misalignments = allow_misaligns;
-
-	walk_env_t env = { .copybs = NEW_ARR_F(ir_node*, 0) };
+	memset_id           = ir_platform_mangle_global("memset");
+	memcpy_id           = ir_platform_mangle_global("memcpy");
+	memcmp_id           = ir_platform_mangle_global("memcmp");
+
+	walk_env_t env = {
+		.copybs   = NEW_ARR_F(ir_node*, 0),
+		.memcalls = NEW_ARR_F(ir_node*, 0),
+	};
 	irg_walk_graph(irg, NULL, find_copyb_nodes, &env);
 
-	bool changed = false;
-	for (size_t i = 0, n = ARR_LEN(env.copybs); i != n; ++i) {
-		lower_copyb_node(env.copybs[i]);
+	size_t const    n          = ARR_LEN(env.copybs);
+	copyb_strategy *strategies = XMALLOCN(copyb_strategy, n);
+	bool            any_loop   = false;
+	for (size_t i = 0; i != n; ++i) {
+		strategies[i] = get_copyb_strategy(env.copybs[i]);
+		if (strategies[i] == COPYB_LOOP)
+			any_loop = true;
+	}
+
+	/* Loop expansion splits blocks, so handle those nodes first with the
+	 * bookkeeping part_block() needs in place. */
+	if (any_loop) {
+		ir_resources_t resources = IR_RESOURCE_IRN_LINK | IR_RESOURCE_PHI_LIST;
+		ir_reserve_resources(irg, resources);
+		collect_phiprojs_and_start_block_nodes(irg);
+		for (size_t i = 0; i != n; ++i) {
+			if (strategies[i] == COPYB_LOOP)
+				lower_copyb_node(env.copybs[i], COPYB_LOOP);
+		}
+		ir_free_resources(irg, resources);
+	}
+
+	bool changed = any_loop;
+	for (size_t i = 0; i != n; ++i) {
+		if (strategies[i] == COPYB_LOOP)
+			continue;
+		lower_copyb_node(env.copybs[i], strategies[i]);
 		changed = true;
 	}
-	confirm_irg_properties(irg, changed ? IR_GRAPH_PROPERTIES_CONTROL_FLOW
-	                                    : IR_GRAPH_PROPERTIES_ALL);
+	free(strategies);
+
+	/* expand small constant-size memset/memcpy/memcmp calls inline; the
+	 * Proj rerouting needs out edges */
+	if (ARR_LEN(env.memcalls) > 0) {
+		assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
+		for (size_t i = 0, n_calls = ARR_LEN(env.memcalls); i != n_calls;
+		     ++i) {
+			changed |= lower_small_mem_call(env.memcalls[i]);
+		}
+	}
+
+	confirm_irg_properties(irg, any_loop ? IR_GRAPH_PROPERTIES_NONE
+	                          : changed  ? IR_GRAPH_PROPERTIES_CONTROL_FLOW
+	                                     : IR_GRAPH_PROPERTIES_ALL);
 
+	DEL_ARR_F(env.memcalls);
 	DEL_ARR_F(env.copybs);
 }
@@ -2380,8 +2380,35 @@ static void clear_node_and_phi_links(ir_node *node, void *data)
 		set_Phi_next(node, NULL);
 }
 
+/**
+ * Cheap test whether a method type contains a parameter or result that
+ * will be split by the lowering.
+ */
+static bool mtp_needs_lowering(ir_type const *const mtp)
+{
+	for (size_t i = 0, n = get_method_n_params(mtp); i < n; ++i) {
+		if (type_needs_lowering(get_method_param_type(mtp, i)))
+			return true;
+	}
+	for (size_t i = 0, n = get_method_n_ress(mtp); i < n; ++i) {
+		if (type_needs_lowering(get_method_res_type(mtp, i)))
+			return true;
+	}
+	return false;
+}
+
 static void lower_irg(ir_graph *irg)
 {
+	/* Most graphs on 32bit targets contain no doubleword value at all.  The
+	 * mode size mask accumulated at node construction time (including Call
+	 * result types) lets us skip them without running the analyses or
+	 * allocating any lowering state. */
+	if (!(irg->mode_size_mask & env.p.doubleword_size)
+	    && !mtp_needs_lowering(get_entity_type(get_irg_entity(irg)))) {
+		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_ALL);
+		return;
+	}
+
 	constbits_analyze(irg);
 
 	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
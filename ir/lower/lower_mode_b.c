@@ -18,8 +18,8 @@
 #include "irgopt.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
+#include "irnodemap.h"
 #include "iropt_t.h"
-#include "irtools.h"
 #include "lowering.h"
 #include "panic.h"
 #include "tv.h"
@@ -34,6 +34,10 @@ typedef struct needs_lowering_t {
 
 static ir_mode          *lowered_mode;
 static needs_lowering_t *needs_lowering;
+/** maps mode_b nodes to their materialized lowered-mode value */
+static ir_nodemap        lowered_map;
+/** maps lowered-mode values to their mode_b reconversion (a Cmp != 0) */
+static ir_nodemap        modeb_map;
 
 static ir_node *create_not(dbg_info *dbgi, ir_node *node)
 {
@@ -47,10 +51,17 @@ static ir_node *create_not(dbg_info *dbgi, ir_node *node)
 
 static ir_node *convert_to_modeb(ir_node *node)
 {
+	/* several Cond/Mux roots may use the same condition value, share the
+	 * reconversion between them instead of building one Cmp per use */
+	ir_node *cmp = ir_nodemap_get(ir_node, &modeb_map, node);
+	if (cmp != NULL)
+		return cmp;
+
 	ir_node  *block = get_nodes_block(node);
 	ir_graph *irg   = get_irn_irg(node);
 	ir_node  *zero  = new_r_Const_null(irg, lowered_mode);
-	ir_node  *cmp   = new_r_Cmp(block, node, zero, ir_relation_less_greater);
+	cmp = new_r_Cmp(block, node, zero, ir_relation_less_greater);
+	ir_nodemap_insert(&modeb_map, node, cmp);
 	return cmp;
 }
 
@@ -66,7 +77,8 @@ static ir_node *create_cond_set(ir_node *cond_value, ir_mode *dest_mode)
 		/* The cached nodes might belong to the lower block, so we have
 		 * to clear the cache for moved nodes to avoid dominance problems. */
 		ir_node *node = get_edge_src_irn(edge);
-		set_irn_link(node, NULL);
+		ir_nodemap_insert(&lowered_map, node, NULL);
+		ir_nodemap_insert(&modeb_map, node, NULL);
 	}
 	ir_graph *irg         = get_irn_irg(cond_value);
 	ir_node  *cond        = new_r_Cond(upper_block, cond_value);
@@ -91,7 +103,7 @@ static ir_node *create_cond_set(ir_node *cond_value, ir_mode *dest_mode)
 
 static ir_node *lower_node(ir_node *node)
 {
-	ir_node *res = (ir_node *)get_irn_link(node);
+	ir_node *res = ir_nodemap_get(ir_node, &lowered_map, node);
 
 	if (res != NULL)
 		return res;
@@ -119,7 +131,7 @@ static ir_node *lower_node(ir_node *node)
 		 * first in the recursion, so the caller(s) are some yet un-lowered
 		 * nodes and this Phi might have them (indirectly) as operands, so they
 		 * would be replaced twice. */
-		set_irn_link(node, new_phi);
+		ir_nodemap_insert(&lowered_map, node, new_phi);
 
 		foreach_irn_in(node, i, in) {
 			ir_node *lowered_in = lower_node(in);
@@ -199,7 +211,7 @@ static ir_node *lower_node(ir_node *node)
 		panic("don't know how to lower mode_b node %+F", node);
 	}
 
-	set_irn_link(node, res);
+	ir_nodemap_insert(&lowered_map, node, res);
 	return res;
 }
 
@@ -246,11 +258,12 @@ void ir_lower_mode_b(ir_graph *const irg, ir_mode *const nlowered_mode)
 	                         | IR_GRAPH_PROPERTY_NO_TUPLES);
 
 	add_irg_constraints(irg, IR_GRAPH_CONSTRAINT_MODEB_LOWERED);
-	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
+	ir_nodemap_init(&lowered_map, irg);
+	ir_nodemap_init(&modeb_map, irg);
 
 	needs_lowering = NEW_ARR_F(needs_lowering_t, 0);
 
-	irg_walk_graph(irg, firm_clear_link, collect_needs_lowering, NULL);
+	irg_walk_graph(irg, NULL, collect_needs_lowering, NULL);
 
 	size_t n = ARR_LEN(needs_lowering);
 	for (size_t i = 0; i < n; ++i) {
@@ -265,7 +278,8 @@ void ir_lower_mode_b(ir_graph *const irg, ir_mode *const nlowered_mode)
 		set_irn_n(node, input, lowered);
 	}
 
-	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+	ir_nodemap_destroy(&modeb_map);
+	ir_nodemap_destroy(&lowered_map);
 
 	DEL_ARR_F(needs_lowering);
 
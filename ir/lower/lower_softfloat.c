@@ -12,10 +12,12 @@
 
 #include "dbginfo_t.h"
 #include "ircons_t.h"
+#include "irdom.h"
 #include "iredges_t.h"
 #include "irgmod.h"
 #include "irgwalk.h"
 #include "irmode_t.h"
+#include "irnodehashmap.h"
 #include "irnodeset.h"
 #include "irop_t.h"
 #include "iropt_dbg.h"
@@ -59,6 +61,19 @@ static ir_type *unop_tp_lu_f;
 /** A map from a method type to its lowered type. */
 static pmap *lowered_type;
 
+/** A map from the (interned) mangled name to the runtime function entity. */
+static pmap *entity_cache;
+
+typedef struct conv_cache_entry_t {
+	struct conv_cache_entry_t *next;
+	ir_mode                   *mode;   /**< destination mode of the Conv */
+	ir_node                   *result; /**< materialized lowered value */
+} conv_cache_entry_t;
+
+/** Maps a converted value to the conversion results already materialized
+ * for it in the current graph. */
+static ir_nodehashmap_t conv_cache;
+
 static ir_nodeset_t created_mux_nodes;
 
 /**
@@ -268,8 +283,15 @@ static ir_node *create_softfloat_address(const ir_node *n, const char *name)
 		new_id_fmt("__%s%s%s%s%u", name, first_param, second_param, result, float_types + double_types) :
 		new_id_fmt("__%s%s%s%s",   name, first_param, second_param, result);
 
-	ir_graph  *const irg = get_irn_irg(n);
-	ir_entity *const ent = create_compilerlib_entity(get_id_str(id), method);
+	/* idents are interned, so the id serves as cache key and saves the
+	 * repeated name mangling and global entity lookup */
+	ir_entity *ent = pmap_get(ir_entity, entity_cache, id);
+	if (ent == NULL) {
+		ent = create_compilerlib_entity(get_id_str(id), method);
+		pmap_insert(entity_cache, id, ent);
+	}
+
+	ir_graph *const irg = get_irn_irg(n);
 	return new_r_Address(irg, ent);
 }
 
@@ -580,6 +602,19 @@ static bool lower_Conv(ir_node *const n)
 			name = "extend";
 	}
 
+	/* repeated conversions of the same value are common, reuse an already
+	 * materialized result if it dominates us */
+	conv_cache_entry_t *const head
+		= ir_nodehashmap_get(conv_cache_entry_t, &conv_cache, op);
+	for (conv_cache_entry_t *entry = head; entry != NULL;
+	     entry = entry->next) {
+		if (entry->mode == mode
+		    && block_dominates(get_nodes_block(entry->result), block)) {
+			exchange(n, entry->result);
+			return true;
+		}
+	}
+
 	ir_node *const in[]   = { op };
 	ir_node       *result = make_softfloat_call(n, name, ARRAY_SIZE(in), in);
 
@@ -587,6 +622,12 @@ static bool lower_Conv(ir_node *const n)
 	if (get_irn_mode(result) != mode)
 		result = new_rd_Conv(dbgi, block, result, mode);
 
+	conv_cache_entry_t *const entry = XMALLOC(conv_cache_entry_t);
+	entry->next   = head;
+	entry->mode   = mode;
+	entry->result = result;
+	ir_nodehashmap_insert(&conv_cache, op, entry);
+
 	exchange(n, result);
 	return true;
 }
@@ -775,6 +816,8 @@ static void ir_prepare_softfloat_lowering(void)
 {
 	if (!lowered_type)
 		lowered_type = pmap_create();
+	if (!entity_cache)
+		entity_cache = pmap_create_ex(64);
 
 	ir_type *const type_D  = get_type_for_mode(mode_D);
 	ir_type *const type_F  = get_type_for_mode(mode_F);
@@ -834,14 +877,28 @@ void lower_floating_point(void)
 	bool *const changed_irgs = XMALLOCNZ(bool, get_irp_n_irgs());
 	foreach_irp_irg(i, irg) {
 		ir_nodeset_init(&created_mux_nodes);
+		ir_nodehashmap_init(&conv_cache);
 
-		assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
+		/* dominance is used to reuse already materialized conversions */
+		assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
+		                         | IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
 
 		irg_walk_graph(irg, NULL, lower_node, &changed_irgs[i]);
 
 		if (ir_nodeset_size(&created_mux_nodes) > 0)
 			lower_mux(irg, lower_mux_cb);
 
+		ir_nodehashmap_iterator_t iter;
+		ir_nodehashmap_entry_t    entry;
+		foreach_ir_nodehashmap(&conv_cache, entry, iter) {
+			for (conv_cache_entry_t *e = (conv_cache_entry_t*)entry.data;
+			     e != NULL;) {
+				conv_cache_entry_t *next = e->next;
+				free(e);
+				e = next;
+			}
+		}
+		ir_nodehashmap_destroy(&conv_cache);
 		ir_nodeset_destroy(&created_mux_nodes);
 	}
 
@@ -15,10 +15,20 @@
 #include "irnode_t.h"
 #include "irnodeset.h"
 #include "irouts_t.h"
+#include "irprofile.h"
 #include "lowering.h"
 #include "panic.h"
 #include "util.h"
 #include <stdbool.h>
+#include <stdint.h>
+
+/** Minimum number of cases for emitting a jump table for a dense cluster
+ * inside an if-cascade. */
+#define SWITCH_MIN_TABLE_SIZE 4
+
+/** Maximum number of hot cases peeled off in front of a switch when profile
+ * data is available. */
+#define SWITCH_MAX_PEEL 3
 
 typedef struct walk_env_t {
 	ir_nodeset_t  processed;
@@ -29,9 +39,8 @@ typedef struct walk_env_t {
 } walk_env_t;
 
 typedef struct target_t {
-	ir_node *block;     /**< block that is targetted */
-	uint16_t n_entries; /**< number of table entries targetting this block */
-	uint16_t i;
+	ir_node  *block; /**< block that is targetted */
+	ir_node **preds; /**< new control flow predecessors of the block */
 } target_t;
 
 typedef struct switch_info_t {
@@ -93,18 +102,6 @@ static void analyse_switch1(switch_info_t *info)
 		targets[(unsigned)pn].block = target;
 	}
 
-	const ir_switch_table *table = get_Switch_table(switchn);
-	for (size_t e = 0, n_entries = ir_switch_table_get_n_entries(table);
-	     e < n_entries; ++e) {
-		const ir_switch_table_entry *entry
-			= ir_switch_table_get_entry_const(table, e);
-		if (entry->pn == pn_Switch_default)
-			continue;
-
-		target_t *target = &targets[entry->pn];
-		++target->n_entries;
-	}
-
 	info->default_block = targets[pn_Switch_default].block;
 	info->targets       = targets;
 }
@@ -294,29 +291,124 @@ static ir_node *create_case_cond(const ir_switch_table_entry *entry,
 
 static void connect_to_target(target_t *target, ir_node *cf)
 {
-	ir_node *block     = target->block;
-	unsigned n_entries = target->n_entries;
-	if (get_Block_n_cfgpreds(block) != (int)n_entries) {
-		ir_node **new_in = ALLOCAN(ir_node*, n_entries);
-		ir_graph *irg    = get_irn_irg(block);
-		ir_node  *dummy  = new_r_Dummy(irg, mode_X);
-		for (unsigned i = 0; i < n_entries; ++i) {
-			new_in[i] = dummy;
+	if (target->preds == NULL)
+		target->preds = NEW_ARR_F(ir_node*, 0);
+	ARR_APP1(ir_node*, target->preds, cf);
+}
+
+/**
+ * Checks whether the cases curcases[0..numcases) are dense enough for a
+ * jump table.  Uses the same spare measure as the initial table/cascade
+ * decision.
+ */
+static bool is_dense_cluster(walk_env_t const *env,
+                             ir_switch_table_entry const *curcases,
+                             unsigned numcases)
+{
+	ir_mode   *mode  = get_tarval_mode(curcases[0].min);
+	ir_mode   *umode = find_unsigned_mode(mode);
+	ir_tarval *spare = tarval_sub(curcases[numcases-1].max, curcases[0].min);
+	spare = tarval_convert_to(spare, umode);
+	ir_tarval *num_cases_minus_one = new_tarval_from_long(numcases - 1, umode);
+	spare = tarval_sub(spare, num_cases_minus_one);
+	ir_tarval *spare_size = new_tarval_from_long(env->spare_size, umode);
+	return tarval_cmp(spare, spare_size) & ir_relation_less;
+}
+
+/**
+ * Creates a jump table covering the dense case cluster curcases[0..numcases),
+ * guarded by a range check that branches to the default case.
+ */
+static void create_cluster_switch(walk_env_t const *env, switch_info_t *info,
+                                  ir_node *block,
+                                  ir_switch_table_entry const *curcases,
+                                  unsigned numcases)
+{
+	ir_graph  *irg      = get_irn_irg(block);
+	dbg_info  *dbgi     = get_irn_dbg_info(info->switchn);
+	ir_node   *selector = get_Switch_selector(info->switchn);
+	ir_mode   *mode     = get_irn_mode(selector);
+	ir_tarval *base     = curcases[0].min;
+
+	/* rebase the cluster to zero and make the selector unsigned, so a
+	 * single comparison rules out all values outside of the cluster */
+	if (!tarval_is_null(base)) {
+		ir_node *base_const = new_r_Const(irg, base);
+		selector = new_rd_Sub(dbgi, block, selector, base_const);
+	}
+	if (mode_is_signed(mode)) {
+		mode     = find_unsigned_mode(mode);
+		selector = new_r_Conv(block, selector, mode);
+	}
+	ir_tarval *length = tarval_sub(curcases[numcases-1].max, base);
+	length = tarval_convert_to(length, mode);
+
+	ir_node *length_const = new_r_Const(irg, length);
+	ir_node *cmp          = new_rd_Cmp(dbgi, block, selector, length_const,
+	                                   ir_relation_less_equal);
+	ir_node *cond         = new_rd_Cond(dbgi, block, cmp);
+	ir_node *proj_true    = new_r_Proj(cond, mode_X, pn_Cond_true);
+	ir_node *proj_false   = new_r_Proj(cond, mode_X, pn_Cond_false);
+	ARR_APP1(ir_node*, info->defusers, proj_false);
+
+	ir_node *in[]     = { proj_true };
+	ir_node *sw_block = new_r_Block(irg, ARRAY_SIZE(in), in);
+
+	ir_mode *selector_mode = env->selector_mode;
+	if (mode != selector_mode)
+		selector = new_r_Conv(block, selector, selector_mode);
+
+	ir_switch_table *table = ir_new_switch_table(irg, numcases);
+	for (unsigned c = 0; c < numcases; ++c) {
+		ir_switch_table_entry const *entry = &curcases[c];
+		ir_tarval *min = tarval_convert_to(tarval_sub(entry->min, base),
+		                                   selector_mode);
+		ir_tarval *max = entry->min == entry->max
+			? min
+			: tarval_convert_to(tarval_sub(entry->max, base), selector_mode);
+		ir_switch_table_set(table, c, min, max, entry->pn);
+	}
+
+	/* values inside the range that hit a hole in the table take the new
+	 * switch's default Proj */
+	unsigned n_outs  = get_Switch_n_outs(info->switchn);
+	ir_node *switchn = new_rd_Switch(dbgi, sw_block, selector, n_outs, table);
+	ARR_APP1(ir_node*, info->defusers,
+	         new_r_Proj(switchn, mode_X, pn_Switch_default));
+
+	/* one Proj per distinct target; entries sharing a target share it */
+	for (unsigned c = 0; c < numcases; ++c) {
+		unsigned pn   = curcases[c].pn;
+		bool     seen = false;
+		for (unsigned p = 0; p < c; ++p) {
+			if (curcases[p].pn == pn) {
+				seen = true;
+				break;
+			}
 		}
-		set_irn_in(block, n_entries, new_in);
-		assert(target->i == 0);
+		if (seen)
+			continue;
+		connect_to_target(&info->targets[pn], new_r_Proj(switchn, mode_X, pn));
 	}
-	assert(target->i < n_entries);
-	set_Block_cfgpred(target->block, target->i++, cf);
 }
 
 /**
- * Creates an if cascade realizing binary search.
+ * Creates an if cascade realizing binary search.  Case clusters dense enough
+ * for a jump table are not decomposed further but become inner Switch nodes,
+ * so a sparse switch turns into a search tree over jump tables.
  */
-static void create_if_cascade(switch_info_t *info, ir_node *block,
+static void create_if_cascade(walk_env_t const *env, switch_info_t *info,
+                              ir_node *block,
                               ir_switch_table_entry *curcases,
                               unsigned numcases)
 {
+	if (env->selector_mode != NULL && numcases >= SWITCH_MIN_TABLE_SIZE
+	    && numcases > env->small_switch
+	    && is_dense_cluster(env, curcases, numcases)) {
+		create_cluster_switch(env, info, block, curcases, numcases);
+		return;
+	}
+
 	ir_graph      *irg      = get_irn_irg(block);
 	const ir_node *switchn  = info->switchn;
 	dbg_info      *dbgi     = get_irn_dbg_info(switchn);
@@ -366,8 +458,156 @@ static void create_if_cascade(switch_info_t *info, ir_node *block,
 		ir_node *gein[]  = { new_r_Proj(cond, mode_X, pn_Cond_false) };
 		ir_node *geblock = new_r_Block(irg, ARRAY_SIZE(gein), gein);
 
-		create_if_cascade(info, ltblock, curcases, midcase);
-		create_if_cascade(info, geblock, curcases + midcase, numcases - midcase);
+		create_if_cascade(env, info, ltblock, curcases, midcase);
+		create_if_cascade(env, info, geblock, curcases + midcase,
+		                  numcases - midcase);
+	}
+}
+
+/**
+ * Returns the table entry matching the given proj number.
+ */
+static ir_switch_table_entry *find_entry_for_pn(ir_switch_table *table,
+                                                unsigned pn)
+{
+	for (size_t e = 0, n_entries = table->n_entries; e < n_entries; ++e) {
+		ir_switch_table_entry *entry = &table->entries[e];
+		if (entry->pn == pn)
+			return entry;
+	}
+	panic("no table entry for hot switch case");
+}
+
+/**
+ * Uses profile data to find up to SWITCH_MAX_PEEL cases dominating the
+ * executions of the switch.  Their proj numbers are stored in hot_pns and
+ * their number is returned.  Only cases with a single table entry qualify,
+ * so peeling one off costs exactly one comparison.
+ */
+static unsigned find_hot_cases(switch_info_t *info,
+                               unsigned hot_pns[SWITCH_MAX_PEEL])
+{
+	const ir_node *switchn = info->switchn;
+	unsigned       n_outs  = get_Switch_n_outs(switchn);
+
+	uint64_t total = 0;
+	for (unsigned pn = 0; pn < n_outs; ++pn) {
+		ir_node *block = info->targets[pn].block;
+		if (block != NULL)
+			total += ir_profile_get_block_execcount(block);
+	}
+	if (total == 0)
+		return 0;
+
+	unsigned *n_entries = ALLOCANZ(unsigned, n_outs);
+	const ir_switch_table *table = get_Switch_table(switchn);
+	for (size_t e = 0, n = ir_switch_table_get_n_entries(table); e < n; ++e) {
+		const ir_switch_table_entry *entry
+			= ir_switch_table_get_entry_const(table, e);
+		if (entry->pn != pn_Switch_default)
+			++n_entries[entry->pn];
+	}
+
+	/* greedily peel the hottest case as long as it accounts for at least a
+	 * quarter of all executions of the switch */
+	unsigned n_hot = 0;
+	while (n_hot < SWITCH_MAX_PEEL) {
+		unsigned best       = 0;
+		uint64_t best_count = 0;
+		for (unsigned pn = 0; pn < n_outs; ++pn) {
+			if (pn == pn_Switch_default || n_entries[pn] != 1)
+				continue;
+			ir_node *block = info->targets[pn].block;
+			if (block == NULL)
+				continue;
+			uint64_t count = ir_profile_get_block_execcount(block);
+			if (count > best_count) {
+				best       = pn;
+				best_count = count;
+			}
+		}
+		if (best_count * 4 < total)
+			break;
+		hot_pns[n_hot++] = best;
+		n_entries[best]  = 0;
+	}
+	return n_hot;
+}
+
+/**
+ * Peels the given hot cases off as a sequence of conditional branches in
+ * front of @p block and removes their entries from the switch table.
+ * Returns the block the remaining cases have to be lowered in.
+ */
+static ir_node *peel_hot_cases(switch_info_t *info, ir_node *block,
+                               const unsigned *hot_pns, unsigned n_hot)
+{
+	ir_node         *switchn  = info->switchn;
+	ir_graph        *irg      = get_irn_irg(switchn);
+	dbg_info        *dbgi     = get_irn_dbg_info(switchn);
+	ir_node         *selector = get_Switch_selector(switchn);
+	ir_switch_table *table    = get_Switch_table(switchn);
+
+	for (unsigned h = 0; h < n_hot; ++h) {
+		unsigned               pn    = hot_pns[h];
+		ir_switch_table_entry *entry = find_entry_for_pn(table, pn);
+
+		ir_node *cond      = create_case_cond(entry, dbgi, block, selector);
+		ir_node *trueproj  = new_r_Proj(cond, mode_X, pn_Cond_true);
+		ir_node *falseproj = new_r_Proj(cond, mode_X, pn_Cond_false);
+		connect_to_target(&info->targets[pn], trueproj);
+
+		/* remove the entry, the cascade must not test it again */
+		for (size_t e = entry - table->entries + 1, n = table->n_entries;
+		     e < n; ++e) {
+			table->entries[e-1] = table->entries[e];
+		}
+		--table->n_entries;
+
+		ir_node *in[] = { falseproj };
+		block = new_r_Block(irg, ARRAY_SIZE(in), in);
+	}
+	return block;
+}
+
+/**
+ * Peels hot cases off in front of a switch that is kept as a jump table.
+ * The peeled entries stay in the table, their in-table edges just become
+ * unreachable.
+ */
+static void peel_hot_cases_keep_switch(switch_info_t *info,
+                                       const unsigned *hot_pns,
+                                       unsigned n_hot)
+{
+	ir_node         *switchn  = info->switchn;
+	ir_graph        *irg      = get_irn_irg(switchn);
+	dbg_info        *dbgi     = get_irn_dbg_info(switchn);
+	ir_node         *selector = get_Switch_selector(switchn);
+	ir_node         *block    = get_nodes_block(switchn);
+	ir_switch_table *table    = get_Switch_table(switchn);
+
+	for (unsigned h = 0; h < n_hot; ++h) {
+		unsigned pn = hot_pns[h];
+		const ir_switch_table_entry *entry = find_entry_for_pn(table, pn);
+
+		ir_node *cond      = create_case_cond(entry, dbgi, block, selector);
+		ir_node *trueproj  = new_r_Proj(cond, mode_X, pn_Cond_true);
+		ir_node *falseproj = new_r_Proj(cond, mode_X, pn_Cond_false);
+
+		/* the target keeps its switch Proj and gains the peeled edge */
+		ir_node *target = info->targets[pn].block;
+		assert(get_Block_n_cfgpreds(target) == 1);
+		ir_node *tin[]  = { get_Block_cfgpred(target, 0), trueproj };
+		set_irn_in(target, ARRAY_SIZE(tin), tin);
+
+		ir_node *bin[] = { falseproj };
+		block = new_r_Block(irg, ARRAY_SIZE(bin), bin);
+	}
+
+	/* move the switch and its Projs behind the peeled comparisons */
+	set_nodes_block(switchn, block);
+	foreach_irn_out_r(switchn, i, proj) {
+		set_nodes_block(proj, block);
 	}
 }
 
@@ -396,6 +636,7 @@ static void find_switch_nodes(ir_node *block, void *ctx)
 
 	switch_info_t info;
 	analyse_switch0(&info, switchn);
+	info.targets = NULL;
 
 	/*
 	 * Here we have: num_cases and [switch_min, switch_max] interval.
@@ -412,22 +653,50 @@ static void find_switch_nodes(ir_node *block, void *ctx)
 	bool lower_switch = info.num_cases <= env->small_switch
 		|| (tarval_cmp(spare, spare_size) & ir_relation_greater_equal);
 
+	/* with profile data available, cases dominating the executions are
+	 * peeled off in front of the switch, whatever the strategy for the
+	 * remaining cases is.  The static frequency estimation distributes
+	 * evenly over the switch targets, so only measured profiles are
+	 * interesting here. */
+	unsigned hot_pns[SWITCH_MAX_PEEL];
+	unsigned n_hot = 0;
+	if (ir_profile_is_loaded() && info.num_cases > 1) {
+		analyse_switch1(&info);
+		n_hot = find_hot_cases(&info, hot_pns);
+	}
+
 	if (!lower_switch) {
 		/* we won't decompose the switch. But we must add an out-of-bounds
 		 * check */
+		if (n_hot > 0)
+			peel_hot_cases_keep_switch(&info, hot_pns, n_hot);
 		env->changed |= normalize_switch(&info, env->selector_mode);
+		free(info.targets);
 		return;
 	}
 
 	normalize_table(switchn, selector_mode, NULL);
-	analyse_switch1(&info);
+	if (info.targets == NULL)
+		analyse_switch1(&info);
 
 	/* Now create the if cascade */
 	env->changed  = true;
 	info.defusers = NEW_ARR_F(ir_node*, 0);
 	block         = get_nodes_block(switchn);
+	if (n_hot > 0)
+		block = peel_hot_cases(&info, block, hot_pns, n_hot);
 	ir_switch_table *table = get_Switch_table(switchn);
-	create_if_cascade(&info, block, table->entries, table->n_entries);
+	create_if_cascade(env, &info, block, table->entries, table->n_entries);
+
+	/* Connect the new control flow to the case targets */
+	unsigned n_outs = get_Switch_n_outs(switchn);
+	for (unsigned pn = 0; pn < n_outs; ++pn) {
+		target_t *target = &info.targets[pn];
+		if (target->preds == NULL)
+			continue;
+		set_irn_in(target->block, ARR_LEN(target->preds), target->preds);
+		DEL_ARR_F(target->preds);
+	}
 
 	/* Connect new default case users */
 	set_irn_in(info.default_block, ARR_LEN(info.defusers), info.defusers);
@@ -20,6 +20,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
 #define HASH_NAME_T(n) hash_str((n)->name)
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
@@ -430,7 +434,104 @@ void lpp_dump_plain(lpp_t *lpp, FILE *f)
 void lpp_solve(lpp_t *lpp, const char* solver)
 {
 	lpp_solver_func_t* f = lpp_find_solver(solver);
-	if (f != NULL)
+	if (f != NULL) {
+		/* the problem is complete now, so the solvers can work on the
+		 * compressed form of the matrix */
+		matrix_freeze(lpp->m);
 		f(lpp);
+	}
+}
+
+#ifndef _WIN32
+
+struct lpp_async_t {
+	lpp_t             *lpp;
+	lpp_solver_func_t *func;
+	pthread_t          thread;
+	pthread_mutex_t    mutex;
+	bool               threaded;
+	bool               done;
+};
+
+static void *lpp_async_worker(void *data)
+{
+	lpp_async_t *async = (lpp_async_t*)data;
+	async->func(async->lpp);
+	pthread_mutex_lock(&async->mutex);
+	async->done = true;
+	pthread_mutex_unlock(&async->mutex);
+	return NULL;
+}
+
+lpp_async_t *lpp_solve_async(lpp_t *lpp, const char *solver)
+{
+	lpp_async_t *async = XMALLOCZ(lpp_async_t);
+	async->lpp  = lpp;
+	async->func = lpp_find_solver(solver);
+	if (async->func == NULL) {
+		async->done = true;
+		return async;
+	}
+
+	/* freeze on the submitting thread, the worker only reads the matrix */
+	matrix_freeze(lpp->m);
+
+	pthread_mutex_init(&async->mutex, NULL);
+	if (pthread_create(&async->thread, NULL, lpp_async_worker, async) == 0) {
+		async->threaded = true;
+	} else {
+		/* no worker available, solve synchronously */
+		async->func(lpp);
+		async->done = true;
+	}
+	return async;
+}
+
+bool lpp_async_done(lpp_async_t *async)
+{
+	if (!async->threaded)
+		return async->done;
+
+	pthread_mutex_lock(&async->mutex);
+	bool done = async->done;
+	pthread_mutex_unlock(&async->mutex);
+	return done;
 }
 
+void lpp_async_finish(lpp_async_t *async)
+{
+	if (async->threaded) {
+		pthread_join(async->thread, NULL);
+		pthread_mutex_destroy(&async->mutex);
+	}
+	free(async);
+}
+
+#else
+
+/* No thread support on this platform, solve synchronously on submit. */
+
+struct lpp_async_t {
+	bool done;
+};
+
+lpp_async_t *lpp_solve_async(lpp_t *lpp, const char *solver)
+{
+	lpp_async_t *async = XMALLOCZ(lpp_async_t);
+	lpp_solve(lpp, solver);
+	async->done = true;
+	return async;
+}
+
+bool lpp_async_done(lpp_async_t *async)
+{
+	return async->done;
+}
+
+void lpp_async_finish(lpp_async_t *async)
+{
+	free(async);
+}
+
+#endif
+
@@ -336,4 +336,32 @@ static inline void lpp_unset_bound(lpp_t *lpp)
  */
 void lpp_solve(lpp_t *lpp, const char* solver);
 
+/** Handle for an asynchronous solve, see lpp_solve_async(). */
+typedef struct lpp_async_t lpp_async_t;
+
+/**
+ * Start solving an ILP on a worker thread, so the caller can overlap the
+ * solve with other work. The problem must not be touched until
+ * lpp_async_finish() has returned. On platforms without thread support
+ * (or if no worker can be spawned) the problem is solved synchronously
+ * before this function returns.
+ * @param lpp    The problem.
+ * @param solver The solver to use.
+ * @return A handle to be passed to lpp_async_done()/lpp_async_finish().
+ */
+lpp_async_t *lpp_solve_async(lpp_t *lpp, const char *solver);
+
+/**
+ * Poll whether an asynchronous solve has completed. Does not block.
+ */
+bool lpp_async_done(lpp_async_t *async);
+
+/**
+ * Wait for an asynchronous solve to complete and release the handle.
+ * Afterwards the solution can be queried from the problem as usual;
+ * on a timeout the best solution found so far is available when the
+ * solution state is at least lpp_feasible.
+ */
+void lpp_async_finish(lpp_async_t *async);
+
 #endif
@@ -19,9 +19,48 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
 static char cpx_cst_encoding[4] = "?ELG";
 static char cpx_var_encoding[4] = "??CB";
 
+/* Opening a CPLEX environment is expensive, so one is kept and reused
+ * across the many small ILPs of a compilation. A concurrent solve (see
+ * lpp_solve_async()) gets a private environment instead. */
+static CPXENVptr cached_env;
+
+#ifndef _WIN32
+static pthread_mutex_t cached_env_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define LOCK_ENV_CACHE()   pthread_mutex_lock(&cached_env_mutex)
+#define UNLOCK_ENV_CACHE() pthread_mutex_unlock(&cached_env_mutex)
+#else
+#define LOCK_ENV_CACHE()   ((void)0)
+#define UNLOCK_ENV_CACHE() ((void)0)
+#endif
+
+static CPXENVptr acquire_env(void)
+{
+	LOCK_ENV_CACHE();
+	CPXENVptr env = cached_env;
+	cached_env = NULL;
+	UNLOCK_ENV_CACHE();
+	return env;
+}
+
+static void release_env(CPXENVptr env)
+{
+	LOCK_ENV_CACHE();
+	if (cached_env == NULL) {
+		cached_env = env;
+		env = NULL;
+	}
+	UNLOCK_ENV_CACHE();
+	if (env != NULL)
+		CPXcloseCPLEX(&env);
+}
+
 typedef struct _cpx_t {
 	lpp_t *lpp;
 	CPXENVptr env;
@@ -44,8 +83,11 @@ static cpx_t *new_cpx(lpp_t *lpp)
 {
 	cpx_t *cpx = XMALLOCZ(cpx_t);
 	cpx->lpp = lpp;
-	cpx->env = CPXopenCPLEX(&cpx->status);
-	chk_cpx_err(cpx);
+	cpx->env = acquire_env();
+	if (cpx->env == NULL) {
+		cpx->env = CPXopenCPLEX(&cpx->status);
+		chk_cpx_err(cpx);
+	}
 	cpx->prob = CPXcreateprob(cpx->env, &cpx->status, lpp->name);
 	chk_cpx_err(cpx);
 	CPXchgobjsen(cpx->env, cpx->prob, (lpp->opt_type == lpp_minimize)?1:-1);
@@ -58,7 +100,7 @@ static cpx_t *new_cpx(lpp_t *lpp)
 static void free_cpx(cpx_t *cpx)
 {
 	CPXfreeprob(cpx->env, &cpx->prob);
-	CPXcloseCPLEX(&cpx->env);
+	release_env(cpx->env);
 	free(cpx);
 }
 
@@ -177,17 +219,18 @@ static void cpx_solve(cpx_t *cpx)
 	// CPXsetintparam(cpx->env, CPX_PARAM_BRDIR, CPX_BRDIR_UP);
 
 
-	/* Set the time limit appropriately */
+	/* Set the time limit appropriately. The defaults are restored
+	 * explicitly since the environment is reused across solves. */
 	if(lpp->time_limit_secs > 0.0)
 		CPXsetdblparam(cpx->env, CPX_PARAM_TILIM, lpp->time_limit_secs);
+	else
+		CPXsetdblparam(cpx->env, CPX_PARAM_TILIM, 1e+75);
 
 	/*
 	 * If we have enough time, we instruct cplex to imply some
 	 * of its higher order magic to pursue the best solution
 	 */
-	if(lpp->emphasis) {
-	  CPXsetintparam(cpx->env, CPX_PARAM_MIPEMPHASIS, lpp->emphasis);
-	}
+	CPXsetintparam(cpx->env, CPX_PARAM_MIPEMPHASIS, lpp->emphasis);
 
 	/*
 	 * If a bound of the objective function is supplied,
@@ -196,6 +239,9 @@ static void cpx_solve(cpx_t *cpx)
 	if(lpp->set_bound) {
 		CPXsetdblparam(cpx->env, (lpp->opt_type == lpp_minimize
 		                          ? CPX_PARAM_OBJLLIM : CPX_PARAM_OBJULIM), lpp->bound);
+	} else {
+		CPXsetdblparam(cpx->env, CPX_PARAM_OBJLLIM, -1e+75);
+		CPXsetdblparam(cpx->env, CPX_PARAM_OBJULIM, 1e+75);
 	}
 
 	/* turn on the fancy messages :) */
@@ -19,9 +19,48 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
 static char gurobi_cst_encoding[4] = { 0, GRB_EQUAL, GRB_LESS_EQUAL, GRB_GREATER_EQUAL };
 static char gurobi_var_encoding[4] = { 0, 0, GRB_CONTINUOUS, GRB_BINARY };
 
+/* Creating a solver environment is expensive, so one is kept and reused
+ * across the many small ILPs of a compilation. A concurrent solve (see
+ * lpp_solve_async()) gets a private environment instead. */
+static GRBenv *cached_env;
+
+#ifndef _WIN32
+static pthread_mutex_t cached_env_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define LOCK_ENV_CACHE()   pthread_mutex_lock(&cached_env_mutex)
+#define UNLOCK_ENV_CACHE() pthread_mutex_unlock(&cached_env_mutex)
+#else
+#define LOCK_ENV_CACHE()   ((void)0)
+#define UNLOCK_ENV_CACHE() ((void)0)
+#endif
+
+static GRBenv *acquire_env(void)
+{
+	LOCK_ENV_CACHE();
+	GRBenv *env = cached_env;
+	cached_env = NULL;
+	UNLOCK_ENV_CACHE();
+	return env;
+}
+
+static void release_env(GRBenv *env)
+{
+	LOCK_ENV_CACHE();
+	if (cached_env == NULL) {
+		cached_env = env;
+		env = NULL;
+	}
+	UNLOCK_ENV_CACHE();
+	if (env != NULL)
+		GRBfreeenv(env);
+}
+
 typedef struct _gurobi_t {
 	lpp_t *lpp;
 	GRBenv *env;
@@ -42,9 +81,12 @@ static gurobi_t *new_gurobi(lpp_t *lpp)
 
 	gurobi_t *grb = XMALLOCZ(gurobi_t);
 	grb->lpp = lpp;
-	/* /tmp/firm_gurobi.log is a hack (see below) */
-	error = GRBloadenv(&grb->env, "/tmp/firm_gurobi.log");
-	check_gurobi_error(grb, error);
+	grb->env = acquire_env();
+	if (grb->env == NULL) {
+		/* /tmp/firm_gurobi.log is a hack (see below) */
+		error = GRBloadenv(&grb->env, "/tmp/firm_gurobi.log");
+		check_gurobi_error(grb, error);
+	}
 	/* Matze: do not set the FILE* for logging output. Because:
 	 *  a) the function is deprecated
 	 *  b) gurobi closes the FILE handle when it is done, which leads to
@@ -52,11 +94,10 @@ static gurobi_t *new_gurobi(lpp_t *lpp)
 	 *     output.
 	 * The only thing gurobi sanely supports is giving a string with a filename
 	 * :-( ...so we use /tmp/firm_gurobi.log as a temporary measure...
-	 */
-	if (lpp->log != stdout && lpp->log != stderr) {
-		error = GRBsetintparam(grb->env, GRB_INT_PAR_OUTPUTFLAG, 0);
-		check_gurobi_error(grb, error);
-	}
+	 * The flag is set both ways since the environment may be reused. */
+	error = GRBsetintparam(grb->env, GRB_INT_PAR_OUTPUTFLAG,
+	                       lpp->log == stdout || lpp->log == stderr);
+	check_gurobi_error(grb, error);
 
 	return grb;
 }
@@ -64,7 +105,7 @@ static gurobi_t *new_gurobi(lpp_t *lpp)
 static void free_gurobi(gurobi_t *grb)
 {
 	GRBfreemodel(grb->model);
-	GRBfreeenv(grb->env);
+	release_env(grb->env);
 	free(grb);
 }
 
@@ -65,6 +65,15 @@ struct sp_matrix_t {
 	sp_matrix_list_head_t **last_col_el;
 	/* for each row the last inserted element in row list */
 	sp_matrix_list_head_t **last_row_el;
+	/* compressed storage, created by matrix_freeze(). Once frozen the
+	 * matrix is immutable and all iteration is done by linear scans over
+	 * these arrays instead of chasing the list pointers above. */
+	int            frozen;
+	matrix_elem_t *csr;       /* entries sorted row-major */
+	matrix_elem_t *csc;       /* entries sorted column-major */
+	int           *row_start; /* maxrow+2 offsets into csr */
+	int           *col_start; /* maxcol+2 offsets into csc */
+	int            iter_pos, iter_end; /* iteration cursor when frozen */
 };
 
 #define SP_MATRIX_INIT_LIST_HEAD(ptr) do { (ptr)->next = NULL; } while (0)
@@ -279,7 +288,10 @@ sp_matrix_t *new_matrix(int row_init, int col_init)
 	return res;
 }
 
-void del_matrix(sp_matrix_t *m)
+/**
+ * Frees all list storage of @p m (entries and row/col heads).
+ */
+static void m_free_lists(sp_matrix_t *m)
 {
 	int i;
 
@@ -305,6 +317,57 @@ void del_matrix(sp_matrix_t *m)
 	free(m->last_row_el);
 	free(m->rows);
 	free(m->cols);
+	m->rows        = NULL;
+	m->cols        = NULL;
+	m->last_row_el = NULL;
+	m->last_col_el = NULL;
+	m->rowc        = 0;
+	m->colc        = 0;
+}
+
+void matrix_freeze(sp_matrix_t *m)
+{
+	sp_matrix_list_head_t *n;
+	int i, k;
+
+	if (m->frozen)
+		return;
+
+	m->csr       = XMALLOCN(matrix_elem_t, m->entries);
+	m->csc       = XMALLOCN(matrix_elem_t, m->entries);
+	m->row_start = XMALLOCN(int, m->maxrow + 2);
+	m->col_start = XMALLOCN(int, m->maxcol + 2);
+
+	k = 0;
+	for (i = 0; i <= m->maxrow; ++i) {
+		m->row_start[i] = k;
+		for (n = m->rows[i]->next; n != NULL; n = n->next)
+			m->csr[k++] = *list_entry_by_row(n);
+	}
+	m->row_start[m->maxrow + 1] = k;
+	assert(k == m->entries);
+
+	k = 0;
+	for (i = 0; i <= m->maxcol; ++i) {
+		m->col_start[i] = k;
+		for (n = m->cols[i]->next; n != NULL; n = n->next)
+			m->csc[k++] = *list_entry_by_col(n);
+	}
+	m->col_start[m->maxcol + 1] = k;
+	assert(k == m->entries);
+
+	/* the linked lists are no longer needed */
+	m_free_lists(m);
+	m->frozen = 1;
+}
+
+void del_matrix(sp_matrix_t *m)
+{
+	m_free_lists(m);
+	free(m->csr);
+	free(m->csc);
+	free(m->row_start);
+	free(m->col_start);
 	free(m);
 }
 
@@ -317,6 +380,8 @@ void matrix_set(sp_matrix_t *m, int row, int col, double val)
 	sp_matrix_list_head_t *prev_leftof = NULL;
 	sp_matrix_list_head_t *prev_above  = NULL;
 
+	assert(!m->frozen && "matrix was frozen, no more modifications allowed");
+
 	/* if necessary enlarge the matrix */
 	if (row > m->maxrow) {
 		m->maxrow = row;
@@ -410,6 +475,8 @@ void matrix_set_row_bulk(sp_matrix_t *m, int row, int *cols, int num_cols, doubl
 	sp_matrix_list_head_t *leftof, *above;
 	sp_matrix_list_head_t *prev_leftof, *prev_above;
 
+	assert(!m->frozen && "matrix was frozen, no more modifications allowed");
+
 	/* if necessary enlarge the matrix */
 	if (row > m->maxrow) {
 		m->maxrow = row;
@@ -502,6 +569,28 @@ double matrix_get(const sp_matrix_t *m, int row, int col)
 	sp_matrix_list_head_t *dummy, *dummy2;
 	matrix_elem_t *me;
 
+	if (m->frozen) {
+		/* binary search in the row, its entries are sorted by column */
+		int lo, hi;
+
+		if (row > m->maxrow || col > m->maxcol)
+			return 0.0;
+
+		lo = m->row_start[row];
+		hi = m->row_start[row + 1];
+		while (lo < hi) {
+			int mid = lo + (hi - lo) / 2;
+
+			if (m->csr[mid].col < col)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if (lo < m->row_start[row + 1] && m->csr[lo].col == col)
+			return m->csr[lo].val;
+		return 0.0;
+	}
+
 	if (is_empty_row(row) || is_empty_col(col))
 		return 0.0;
 
@@ -533,6 +622,16 @@ int matrix_get_colcount(const sp_matrix_t *m)
 
 const matrix_elem_t *matrix_row_first(sp_matrix_t *m, int row)
 {
+	if (m->frozen) {
+		if (row > m->maxrow || m->row_start[row] == m->row_start[row + 1])
+			return NULL;
+
+		m->dir      = right;
+		m->iter_pos = m->row_start[row];
+		m->iter_end = m->row_start[row + 1];
+		return &m->csr[m->iter_pos];
+	}
+
 	if (is_empty_row(row))
 		return NULL;
 
@@ -548,6 +647,16 @@ const matrix_elem_t *matrix_row_first(sp_matrix_t *m, int row)
 
 const matrix_elem_t *matrix_col_first(sp_matrix_t *m, int col)
 {
+	if (m->frozen) {
+		if (col > m->maxcol || m->col_start[col] == m->col_start[col + 1])
+			return NULL;
+
+		m->dir      = down;
+		m->iter_pos = m->col_start[col];
+		m->iter_end = m->col_start[col + 1];
+		return &m->csc[m->iter_pos];
+	}
+
 	if (is_empty_col(col))
 		return NULL;
 
@@ -580,11 +689,27 @@ static inline const matrix_elem_t *matrix_first_from(sp_matrix_t *m, int startro
 
 const matrix_elem_t *matrix_first(sp_matrix_t *m)
 {
+	if (m->frozen) {
+		if (m->entries == 0)
+			return NULL;
+
+		m->dir      = all;
+		m->iter_pos = 0;
+		m->iter_end = m->entries;
+		return &m->csr[0];
+	}
+
 	return matrix_first_from(m, 0);
 }
 
 const matrix_elem_t *matrix_next(sp_matrix_t *m)
 {
+	if (m->frozen) {
+		if (++m->iter_pos >= m->iter_end)
+			return NULL;
+		return m->dir == down ? &m->csc[m->iter_pos] : &m->csr[m->iter_pos];
+	}
+
 	assert(m->first && "Start iteration with matrix_???_first, before calling me!");
 
 	if (m->next == NULL) {
@@ -771,5 +896,24 @@ void matrix_self_test(int d)
 	matrix_set(m, 1,1,0);
 	if (matrix_get_entries(m) != 5)
 		panic("matrix get/set 3 failed");
+
+	matrix_freeze(m);
+	i = 1;
+	matrix_foreach(m, e) {
+		if (e->val != ++i)
+			panic("frozen matrix foreach failed");
+	}
+	if (i != 6)
+		panic("frozen matrix_foreach failed");
+	i = 0;
+	matrix_foreach_in_row(m, 3, e) {
+		++i;
+		if (e->row != 3)
+			panic("frozen matrix row iter failed");
+	}
+	if (i != 2)
+		panic("frozen matrix row iter failed");
+	if (matrix_get(m, 3, 5) != 4 || matrix_get(m, 1, 1) != 0)
+		panic("frozen matrix_get failed");
 	del_matrix(m);
 }
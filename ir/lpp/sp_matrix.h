@@ -49,6 +49,15 @@ void matrix_set(sp_matrix_t *m, int row, int col, double val);
  */
 void matrix_set_row_bulk(sp_matrix_t *m, int row, int *cols, int num_cols, double val);
 
+/**
+ * Finalize the matrix after construction. The linked list entries are
+ * copied into contiguous row-major and column-major arrays and freed, so
+ * all further iteration is a linear scan and matrix_get() a binary search
+ * in the row. After this call the matrix must not be modified anymore.
+ * Calling it again is a no-op.
+ */
+void matrix_freeze(sp_matrix_t *m);
+
 /**
  * Returns the value stored in m[row, col].
  */
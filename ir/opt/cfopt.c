@@ -26,6 +26,11 @@
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
+/** Set when a Cond was replaced by a Jmp.  Its block may have become empty,
+ * but the removable marks cannot be refreshed without a new analysis walk,
+ * so this is the one event forcing another pass. */
+static bool killed_cond;
+
 /** Set or reset the removable property of a block. */
 static void set_Block_removable(ir_node *block, bool removable)
 {
@@ -156,6 +161,7 @@ static unsigned optimize_pointless_forks(ir_node *block, unsigned n_cfgpreds,
 				new_cfgpreds[i] = jmp;
 				new_cfgpreds[j] = NULL;
 				--new_n_cfgpreds;
+				killed_cond     = true;
 				DB((dbg, LEVEL_1, "Pointless fork %+F to %+F => replace %+F with %+F\n",
 					predb1, block, cfop, jmp));
 				break;
@@ -495,11 +501,15 @@ again:;
 
 		/* make sure predecessor is optimized */
 		ir_node *predb = get_nodes_block(pred);
-		bool bail_out = optimize_block(predb, changed);
-		/* bail out if recursion changed our current block (may happen in
+		bool merged = optimize_block(predb, changed);
+		/* the recursion may have changed our current block (may happen in
 		 * endless loops only reachable by keep-alive edges) */
-		if (bail_out || is_Id(block) || is_Id(predb))
+		if (is_Id(block))
 			return false;
+		/* if the predecessor was merged away, recount with the new inputs
+		 * instead of deferring the block to another whole-graph pass */
+		if (merged || is_Id(predb))
+			goto again;
 
 		++real_preds;
 		single_pred_pos = i;
@@ -535,9 +545,11 @@ again:;
 		return false;
 	}
 
+	/* merging may expose further local opportunities (single Jmp
+	 * predecessor, pointless forks), so re-examine the block right away */
 	merge_empty_predecessors(block, new_n_cfgpreds);
 	*changed = true;
-	return false;
+	goto again;
 }
 
 void optimize_cf(ir_graph *irg)
@@ -556,7 +568,6 @@ void optimize_cf(ir_graph *irg)
 	ir_node *end            = get_irg_end(irg);
 	ir_node *end_block      = get_irg_end_block(irg);
 	bool     global_changed = false;
-	bool     changed;
 	do {
 		/* Analysis: Create basic block phi lists and marks blocks which only
 		 * contain Jmp and Phi nodes. */
@@ -564,8 +575,12 @@ void optimize_cf(ir_graph *irg)
 		               NULL);
 
 		/* Transformation. Calls recursive opt function starting from end block
-		 * and blocks which are kept alive. */
-		changed = false;
+		 * and blocks which are kept alive.  Local follow-up opportunities are
+		 * exhausted within this single pass; only a Cond killed as a
+		 * pointless fork leaves stale removable marks behind and forces
+		 * another analysis walk. */
+		killed_cond  = false;
+		bool changed = false;
 		ir_reserve_resources(irg, IR_RESOURCE_IRN_VISITED);
 		inc_irg_visited(irg);
 		optimize_block(end_block, &changed);
@@ -575,7 +590,7 @@ void optimize_cf(ir_graph *irg)
 		}
 		ir_free_resources(irg, IR_RESOURCE_IRN_VISITED);
 		global_changed |= changed;
-	} while(changed);
+	} while (killed_cond);
 
 	remove_End_Bads_and_doublets(end);
 
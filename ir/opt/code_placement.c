@@ -14,6 +14,7 @@
  * dependencies allow. After pushing them back up out of as many loops as
  * possible.
  */
+#include "execfreq.h"
 #include "iredges_t.h"
 #include "irgopt.h"
 #include "irnode_t.h"
@@ -162,33 +163,60 @@ static ir_node *consumer_dom_dca(ir_node *dca, ir_node *consumer,
 	return dca;
 }
 
-static inline int get_block_loop_depth(ir_node *block)
+/**
+ * Check whether recomputing n is about as cheap as keeping its result
+ * alive in a register. Hoisting such nodes out of loops saves next to
+ * nothing per iteration but stretches their live range across the whole
+ * loop body, so they are better left next to their users. (Const and
+ * Address do not show up here, they are pinned to the start block.)
+ */
+static bool is_cheap_rematerializable(const ir_node *n)
 {
-	return get_loop_depth(get_irn_loop(block));
+	switch (get_irn_opcode(n)) {
+	case iro_Conv:
+	case iro_Minus:
+	case iro_Not:
+		return true;
+	case iro_Add:
+	case iro_And:
+	case iro_Eor:
+	case iro_Or:
+	case iro_Shl:
+	case iro_Shr:
+	case iro_Shrs:
+	case iro_Sub:
+		/* only when one operand is constant, otherwise recomputation
+		 * keeps two values alive instead of one */
+		return is_Const(get_binop_right(n));
+	default:
+		return false;
+	}
 }
 
 /**
- * Move n to a block with less loop depth than its current block. The
+ * Move n to a block executed less often than its current block. The
  * new block must be dominated by early.
  *
  * @param n      the node that should be moved
  * @param early  the earliest block we can n move to
  */
-static void move_out_of_loops(ir_node *n, ir_node *early)
+static void move_to_cheapest_block(ir_node *n, ir_node *early)
 {
-	ir_node *block      = get_nodes_block(n);
-	ir_node *best       = block;
-	int      best_depth = get_block_loop_depth(best);
+	ir_node *block     = get_nodes_block(n);
+	ir_node *best      = block;
+	double   best_freq = get_block_execfreq(best);
 
 	/* Find the region deepest in the dominator tree dominating
-	   dca with the least loop nesting depth, but still dominated
-	   by our early placement. */
+	   dca with the smallest execution frequency, but still dominated
+	   by our early placement. Frequencies subsume the loop nesting
+	   depth and additionally keep nodes out of frequently executed
+	   straight-line dominators. */
 	while (block != early) {
-		ir_node *idom       = get_Block_idom(block);
-		int      idom_depth = get_block_loop_depth(idom);
-		if (idom_depth < best_depth) {
-			best       = idom;
-			best_depth = idom_depth;
+		ir_node *idom      = get_Block_idom(block);
+		double   idom_freq = get_block_execfreq(idom);
+		if (idom_freq < best_freq) {
+			best      = idom;
+			best_freq = idom_freq;
 		}
 		block = idom;
 	}
@@ -253,9 +281,11 @@ static void set_projs_block(ir_node *node, ir_node *block)
  * Find the latest legal block for N and place N into the
  * `optimal' Block between the latest and earliest legal block.
  * The `optimal' block is the dominance-deepest block of those
- * with the least loop-nesting-depth.  This places N out of as many
+ * with the smallest execution frequency.  This places N out of as many
  * loops as possible and then makes it as control dependent as
- * possible.
+ * possible.  Cheaply rematerializable nodes stay at the latest block
+ * next to their users instead, recomputing them costs less than the
+ * register pressure of a long live range.
  */
 static void place_floats_late(ir_node *n, deq_t *worklist)
 {
@@ -298,7 +328,8 @@ static void place_floats_late(ir_node *n, deq_t *worklist)
 	if (dca == NULL)
 		return;
 	set_nodes_block(n, dca);
-	move_out_of_loops(n, block);
+	if (!is_cheap_rematerializable(n))
+		move_to_cheapest_block(n, block);
 	if (get_irn_mode(n) == mode_T)
 		set_projs_block(n, get_nodes_block(n));
 }
@@ -336,6 +367,8 @@ void place_code(ir_graph *irg)
 		IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE |
 		IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
 
+	ir_estimate_execfreq(irg);
+
 	/* Place all floating nodes as early as possible. This guarantees
 	 a legal code placement. */
 	deq_t worklist;
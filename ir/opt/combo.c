@@ -37,11 +37,14 @@
 #include "iroptimize.h"
 #include "irouts_t.h"
 #include "irprintf.h"
+#include "iredges_t.h"
 #include "list.h"
 #include "obstack.h"
 #include "panic.h"
+#include "pdeq.h"
 #include "pmap.h"
 #include "set.h"
+#include "statev_t.h"
 #include "tv_t.h"
 #include <assert.h>
 
@@ -187,6 +190,10 @@ DEBUG_ONLY(static const char *what_reason;)
 /** Next partition number. */
 DEBUG_ONLY(static unsigned part_nr = 0;)
 
+stat_ev_cnt_register(combo_constants, STAT_EV_CAT_OPT, "combo_constants");
+stat_ev_cnt_register(combo_leaders,   STAT_EV_CAT_OPT, "combo_leaders");
+stat_ev_cnt_register(combo_cf_jumps,  STAT_EV_CAT_OPT, "combo_cf_jumps");
+
 /* forward */
 static node_t *identity(node_t *node);
 
@@ -3015,6 +3022,7 @@ static void apply_result(ir_node *irn, void *ctx)
 					DB((dbg, LEVEL_1, "%+F is replaced by %+F\n", irn, jmp));
 					DBG_OPT_COMBO(irn, jmp);
 					exchange(irn, jmp);
+					stat_ev_cnt_bump(combo_cf_jumps);
 					env->modified = true;
 				} else if (is_Switch(cond)) {
 					node_t    *sel = get_irn_node(get_Switch_selector(cond));
@@ -3045,6 +3053,7 @@ static void apply_result(ir_node *irn, void *ctx)
 			DB((dbg, LEVEL_1, "%+F is replaced by %+F\n", irn, c));
 			DBG_OPT_COMBO(irn, c);
 			exchange_leader(irn, c);
+			stat_ev_cnt_bump(combo_constants);
 			env->modified = true;
 		}
 	} else if (is_entity(node->type.ent)) {
@@ -3086,6 +3095,7 @@ static void apply_result(ir_node *irn, void *ctx)
 				DB((dbg, LEVEL_1, "%+F from part%d is replaced by %+F\n", irn, node->part->nr, leader));
 				DBG_OPT_COMBO(irn, leader);
 				exchange_leader(irn, leader);
+				stat_ev_cnt_bump(combo_leaders);
 				env->modified = true;
 			}
 		}
@@ -3185,6 +3195,10 @@ void combo(ir_graph *irg)
 		| IR_GRAPH_PROPERTY_NO_TUPLES
 		| IR_GRAPH_PROPERTY_CONSISTENT_OUTS
 		| IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+	/* the solver sorts and walks the out arrays with its own cursors;
+	 * freeze them as a snapshot instead of having the incremental
+	 * maintenance rewrite them while the result is applied */
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
 
 	/* register a debug mask */
 	FIRM_DBG_REGISTER(dbg, "firm.opt.combo");
@@ -3274,5 +3288,97 @@ void combo(ir_graph *irg)
 	/* restore value_of() default behavior */
 	set_value_of_func(NULL);
 
+	stat_ev_cnt_flush(combo_constants);
+	stat_ev_cnt_flush(combo_leaders);
+	stat_ev_cnt_flush(combo_cf_jumps);
+
+	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_NONE);
+}
+
+/**
+ * Enqueue all users of a node for incremental re-propagation.
+ * Handles mode_T nodes and block/Phi dependencies.
+ */
+static void icombo_enqueue_users(ir_node *n, deq_t *wq)
+{
+	foreach_out_edge(n, edge) {
+		ir_node *succ = get_edge_src_irn(edge);
+
+		if (get_irn_link(succ) != wq) {
+			deq_push_pointer_right(wq, succ);
+			set_irn_link(succ, wq);
+		}
+		if (is_Block(succ)) {
+			/* control flow changed: the block's Phis see other inputs */
+			foreach_out_edge(succ, edge2) {
+				ir_node *succ2 = get_edge_src_irn(edge2);
+				if (is_Phi(succ2) && get_irn_link(succ2) != wq) {
+					deq_push_pointer_right(wq, succ2);
+					set_irn_link(succ2, wq);
+				}
+			}
+		} else if (get_irn_mode(succ) == mode_T) {
+			/* the optimizations run on the Proj's of a mode_T node */
+			icombo_enqueue_users(succ, wq);
+		}
+	}
+}
+
+void combo_incremental(ir_graph *irg, ir_node *const *changed,
+                       size_t n_changed)
+{
+	/* The optimistic fixpoint of combo() must start from Top for every
+	 * node; once the graph was edited the old partitions may claim facts
+	 * that no longer hold, and re-entering the fixpoint from them is
+	 * unsound.  A small edit is handled by a pessimistic propagation over
+	 * the affected cone instead, which is sound from any start state.
+	 * Seeds covering a large part of the graph mean the "cone" is the
+	 * whole graph anyway, so redo the full analysis. */
+	if (changed == NULL || n_changed > (size_t)get_irg_last_idx(irg) / 8) {
+		combo(irg);
+		return;
+	}
+	if (n_changed == 0)
+		return;
+
+	FIRM_DBG_REGISTER(dbg, "firm.opt.combo");
+	DB((dbg, LEVEL_1, "Incremental COMBO for %+F (%zu seeds)\n", irg,
+	    n_changed));
+
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
+	new_identities(irg);
+
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
+
+	deq_t wq;
+	deq_init(&wq);
+	for (size_t i = 0; i < n_changed; ++i) {
+		ir_node *n = changed[i];
+		if (get_irn_link(n) != &wq) {
+			deq_push_pointer_right(&wq, n);
+			set_irn_link(n, &wq);
+		}
+	}
+
+	while (!deq_empty(&wq)) {
+		ir_node *n = deq_pop_pointer_left(ir_node, &wq);
+		set_irn_link(n, NULL);
+
+		/* iterate to the local fixpoint, like optimize_graph_df() */
+		ir_node *optimized = n;
+		ir_node *last;
+		do {
+			last      = optimized;
+			optimized = optimize_in_place_2(last);
+			if (optimized != last) {
+				icombo_enqueue_users(last, &wq);
+				exchange(last, optimized);
+			}
+		} while (optimized != last);
+	}
+	deq_free(&wq);
+
+	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+
 	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_NONE);
 }
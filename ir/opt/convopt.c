@@ -23,13 +23,16 @@
  */
 #include "debug.h"
 #include "ircons.h"
+#include "irdom.h"
 #include "iredges_t.h"
 #include "irgmod.h"
 #include "irgopt.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
+#include "irnodemap.h"
 #include "iropt_t.h"
 #include "iroptimize.h"
+#include "obst.h"
 #include "tv.h"
 #include "util.h"
 #include "vrp.h"
@@ -37,6 +40,21 @@
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
+/** A memoized result of the conversion cost analysis. */
+typedef struct conv_costs_entry_t conv_costs_entry_t;
+struct conv_costs_entry_t {
+	ir_mode            *dest_mode; /**< mode the costs were computed for */
+	int                 costs;
+	conv_costs_entry_t *next;      /**< entry for another destination mode */
+};
+
+typedef struct conv_opt_env_t {
+	struct obstack obst;     /**< holds the cost cache entries */
+	ir_nodemap     costs;    /**< node -> list of memoized costs */
+	ir_graph      *irg;
+	bool           changed;  /**< a node was transformed in this round */
+} conv_opt_env_t;
+
 static bool is_optimizable_node(const ir_node *node, ir_mode *dest_mode)
 {
 	switch (get_irn_opcode(node)) {
@@ -89,7 +107,12 @@ static bool is_shift(ir_node const *const node)
 	return is_Shl(node) || is_Shr(node) || is_Shrs(node);
 }
 
-static int get_conv_costs(const ir_node *const node, ir_mode *const dest_mode)
+static int get_conv_costs(conv_opt_env_t *env, const ir_node *node,
+                          ir_mode *dest_mode);
+
+static int compute_conv_costs(conv_opt_env_t *const env,
+                              const ir_node *const node,
+                              ir_mode *const dest_mode)
 {
 	ir_mode *const mode = get_irn_mode(node);
 	if (mode == dest_mode)
@@ -132,7 +155,7 @@ static int get_conv_costs(const ir_node *const node, ir_mode *const dest_mode)
 		ir_node *pred      = get_Conv_op(node);
 		ir_mode *pred_mode = get_irn_mode(pred);
 		if (smaller_mode(pred_mode, dest_mode)) {
-			return get_conv_costs(pred, dest_mode) - 1;
+			return get_conv_costs(env, pred, dest_mode) - 1;
 		} else if (may_leave_out_middle_conv(pred_mode, mode, dest_mode)) {
 			return 0;
 		} else {
@@ -148,13 +171,52 @@ static int get_conv_costs(const ir_node *const node, ir_mode *const dest_mode)
 	int const arity = is_shift(node) ? 1 : get_irn_arity(node);
 	for (int i = 0; i < arity; ++i) {
 		ir_node *const pred   = get_irn_n(node, i);
-		int      const pcosts = get_conv_costs(pred, dest_mode);
+		int      const pcosts = get_conv_costs(env, pred, dest_mode);
 		costs += MIN(pcosts, 1);
 	}
 
 	return costs;
 }
 
+/**
+ * Memoizing wrapper around compute_conv_costs(): each (node, dest_mode)
+ * pair is evaluated at most once between two graph modifications, so
+ * diamond-shaped dataflow is no longer descended into once per path.
+ */
+static int get_conv_costs(conv_opt_env_t *const env, const ir_node *const node,
+                          ir_mode *const dest_mode)
+{
+	conv_costs_entry_t *const head
+		= ir_nodemap_get(conv_costs_entry_t, &env->costs, node);
+	for (conv_costs_entry_t *entry = head; entry != NULL;
+	     entry = entry->next) {
+		if (entry->dest_mode == dest_mode)
+			return entry->costs;
+	}
+
+	int const costs = compute_conv_costs(env, node, dest_mode);
+
+	conv_costs_entry_t *const entry = OALLOC(&env->obst, conv_costs_entry_t);
+	entry->dest_mode = dest_mode;
+	entry->costs     = costs;
+	entry->next      = head;
+	ir_nodemap_insert(&env->costs, node, entry);
+	return costs;
+}
+
+/**
+ * Throw away all memoized costs.  Must be called after the graph was
+ * modified: out-edge counts and operand chains the costs depend on may
+ * have changed.
+ */
+static void flush_conv_costs(conv_opt_env_t *env)
+{
+	ir_nodemap_destroy(&env->costs);
+	obstack_free(&env->obst, NULL);
+	obstack_init(&env->obst);
+	ir_nodemap_init(&env->costs, env->irg);
+}
+
 static ir_node *place_conv(ir_node *node, ir_mode *dest_mode)
 {
 	ir_node *block = get_nodes_block(node);
@@ -162,7 +224,8 @@ static ir_node *place_conv(ir_node *node, ir_mode *dest_mode)
 	return conv;
 }
 
-static ir_node *conv_transform(ir_node *node, ir_mode *dest_mode)
+static ir_node *conv_transform(conv_opt_env_t *env, ir_node *node,
+                               ir_mode *dest_mode)
 {
 	ir_mode *const mode = get_irn_mode(node);
 	if (mode == dest_mode)
@@ -204,7 +267,7 @@ static ir_node *conv_transform(ir_node *node, ir_mode *dest_mode)
 		ir_node *pred      = get_Conv_op(node);
 		ir_mode *pred_mode = get_irn_mode(pred);
 		if (smaller_mode(pred_mode, dest_mode))
-			return conv_transform(get_Conv_op(node), dest_mode);
+			return conv_transform(env, get_Conv_op(node), dest_mode);
 		return place_conv(node, dest_mode);
 	}
 
@@ -220,10 +283,10 @@ static ir_node *conv_transform(ir_node *node, ir_mode *dest_mode)
 	for (int i = 0; i < conv_arity; i++) {
 		ir_node *pred = get_irn_n(node, i);
 		ir_node *transformed;
-		if (get_conv_costs(pred, dest_mode) > 1) {
+		if (get_conv_costs(env, pred, dest_mode) > 1) {
 			transformed = place_conv(pred, dest_mode);
 		} else {
-			transformed = conv_transform(pred, dest_mode);
+			transformed = conv_transform(env, pred, dest_mode);
 		}
 		ins[i] = transformed;
 	}
@@ -243,7 +306,7 @@ static ir_node *conv_transform(ir_node *node, ir_mode *dest_mode)
 
 static void conv_opt_walker(ir_node *node, void *data)
 {
-	bool *const changed = (bool*)data;
+	conv_opt_env_t *const env = (conv_opt_env_t*)data;
 
 	if (!is_Conv(node))
 		return;
@@ -261,16 +324,95 @@ static void conv_opt_walker(ir_node *node, void *data)
 		return;
 
 	/* - 1 for the initial conv */
-	int const costs = get_conv_costs(pred, mode) - 1;
+	int const costs = get_conv_costs(env, pred, mode) - 1;
 	DB((dbg, LEVEL_2, "Costs for %+F -> %+F: %d\n", node, pred, costs));
 	if (costs > 0)
 		return;
 
-	ir_node *const transformed = conv_transform(pred, mode);
+	ir_node *const transformed = conv_transform(env, pred, mode);
 	if (node != transformed) {
 		exchange(node, transformed);
-		*changed = true;
+		env->changed = true;
+		flush_conv_costs(env);
+	}
+}
+
+/** A Conv already seen for some operand. */
+typedef struct conv_vn_entry_t conv_vn_entry_t;
+struct conv_vn_entry_t {
+	ir_node         *conv;
+	conv_vn_entry_t *next;
+};
+
+typedef struct conv_vn_env_t {
+	struct obstack obst;
+	ir_nodemap     convs;    /**< operand -> list of Convs of the operand */
+	bool           changed;
+} conv_vn_env_t;
+
+/**
+ * Walker: collapse Convs that convert the same operand to the same mode
+ * but sit in different blocks.  Plain CSE only merges such Convs within
+ * one block; here the Conv in the dominating block wins and the other one
+ * is replaced by it.
+ */
+static void conv_vn_walker(ir_node *node, void *data)
+{
+	conv_vn_env_t *const env = (conv_vn_env_t*)data;
+
+	if (!is_Conv(node))
+		return;
+	ir_node *const block = get_nodes_block(node);
+	if (is_Bad(block))
+		return;
+
+	ir_mode *const mode = get_irn_mode(node);
+	ir_node *const op   = get_Conv_op(node);
+	conv_vn_entry_t *const head
+		= ir_nodemap_get(conv_vn_entry_t, &env->convs, op);
+	for (conv_vn_entry_t *entry = head; entry != NULL; entry = entry->next) {
+		if (get_irn_mode(entry->conv) != mode)
+			continue;
+		ir_node *const entry_block = get_nodes_block(entry->conv);
+		if (block_dominates(entry_block, block)) {
+			DB((dbg, LEVEL_2, "Replace %+F by equivalent %+F\n", node,
+			    entry->conv));
+			exchange(node, entry->conv);
+			env->changed = true;
+			return;
+		} else if (block_dominates(block, entry_block)) {
+			DB((dbg, LEVEL_2, "Replace %+F by equivalent %+F\n",
+			    entry->conv, node));
+			exchange(entry->conv, node);
+			entry->conv  = node;
+			env->changed = true;
+			return;
+		}
 	}
+
+	conv_vn_entry_t *const entry = OALLOC(&env->obst, conv_vn_entry_t);
+	entry->conv = node;
+	entry->next = head;
+	ir_nodemap_insert(&env->convs, op, entry);
+}
+
+/**
+ * Merge equivalent Convs across blocks.  Fewer Convs mean fewer out edges
+ * at their operands, which in turn lets the cost analysis push conversions
+ * further down.
+ */
+static bool collapse_equivalent_convs(ir_graph *irg)
+{
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+
+	conv_vn_env_t env;
+	obstack_init(&env.obst);
+	ir_nodemap_init(&env.convs, irg);
+	env.changed = false;
+	irg_walk_graph(irg, NULL, conv_vn_walker, &env);
+	ir_nodemap_destroy(&env.convs);
+	obstack_free(&env.obst, NULL);
+	return env.changed;
 }
 
 void conv_opt(ir_graph *irg)
@@ -281,11 +423,22 @@ void conv_opt(ir_graph *irg)
 
 	DB((dbg, LEVEL_1, "===> Performing conversion optimization on %+F\n", irg));
 
+	conv_opt_env_t env;
+	env.irg = irg;
+
 	bool global_changed = false;
 	bool changed;
 	do {
-		changed = false;
-		irg_walk_graph(irg, NULL, conv_opt_walker, &changed);
+		changed = collapse_equivalent_convs(irg);
+
+		obstack_init(&env.obst);
+		ir_nodemap_init(&env.costs, irg);
+		env.changed = false;
+		irg_walk_graph(irg, NULL, conv_opt_walker, &env);
+		ir_nodemap_destroy(&env.costs);
+		obstack_free(&env.obst, NULL);
+
+		changed |= env.changed;
 		if (changed)
 			local_optimize_graph(irg);
 		global_changed |= changed;
@@ -10,6 +10,7 @@
  *           Michael Beck
  */
 #include "ircons.h"
+#include "irdom.h"
 #include "irgopt.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
@@ -19,6 +20,8 @@
 typedef struct cf_env {
 	bool ignore_exc_edges; /**< set if exception edges should be ignored. */
 	bool changed;          /**< indicate that the cf graph has changed. */
+	bool dom_valid;        /**< dominance information was kept up to date
+	                            for all inserted blocks. */
 } cf_env;
 
 /**
@@ -70,6 +73,7 @@ insert:;
 			ir_node *jmp = new_r_Jmp(new_block);
 			/* set successor of new block */
 			set_irn_n(block, i, jmp);
+			cenv->dom_valid &= ir_dominance_block_inserted(new_block, block);
 			cenv->changed = true;
 		}
 	}
@@ -80,13 +84,18 @@ void remove_critical_cf_edges_ex(ir_graph *irg, int ignore_exception_edges)
 	cf_env env;
 	env.ignore_exc_edges = ignore_exception_edges;
 	env.changed          = false;
+	env.dom_valid        = true;
 
 	irg_block_walk_graph(irg, NULL, walk_critical_cf_edges, &env);
 	if (env.changed) {
 		/* control flow changed */
-		clear_irg_properties(irg, IR_GRAPH_PROPERTIES_ALL
-			& ~(IR_GRAPH_PROPERTY_ONE_RETURN
-				| IR_GRAPH_PROPERTY_MANY_RETURNS));
+		ir_graph_properties_t keep = IR_GRAPH_PROPERTY_ONE_RETURN
+		                           | IR_GRAPH_PROPERTY_MANY_RETURNS;
+		/* inserting blocks on existing edges keeps the dominator tree
+		 * valid when all insertions could be applied to it */
+		if (env.dom_valid)
+			keep |= IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE;
+		clear_irg_properties(irg, IR_GRAPH_PROPERTIES_ALL & ~keep);
 	}
 	add_irg_properties(irg, IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES);
 }
@@ -22,7 +22,7 @@
 #include "irnode_t.h"
 #include "iropt_t.h"
 #include "iroptimize.h"
-#include "irouts.h"
+#include "irouts_t.h"
 #include "irtools.h"
 #include "pmap.h"
 #include "vrp.h"
@@ -64,6 +64,48 @@ static void copy_graph_env(ir_graph *irg)
 	irg->anchor = new_anchor;
 }
 
+/** Walker helper for the liveness mark walk, the walk itself does all
+ * the work via the visited stamps. */
+static void mark_only(ir_node *node, void *env)
+{
+	(void)node;
+	(void)env;
+}
+
+void dead_node_reclamation(ir_graph *irg)
+{
+	/* mark everything reachable from the anchor */
+	irg_walk_in_or_dep(irg->anchor, mark_only, NULL, NULL);
+
+	/* Dead nodes may sit in the value table and would become stale
+	 * pointers into recycled memory; start with a fresh one just like
+	 * dead_node_elimination (CSE re-fills it lazily). */
+	new_identities(irg);
+
+	/* Sweep all allocated nodes, tear the dead ones down and thread
+	 * their memory onto the graph's free lists.  Live nodes keep their
+	 * identity, so edges, dominance and other cached analyses stay
+	 * intact; the teardown itself unhooks dead users from the edge and
+	 * out structures of their operands. */
+	for (unsigned idx = 0, last = get_irg_last_idx(irg); idx < last; ++idx) {
+		ir_node *const node = get_idx_irn(irg, idx);
+		if (node == NULL || irn_visited(node) || is_Deleted(node))
+			continue;
+
+		hook_replace(node, NULL);
+		if (edges_activated(irg))
+			edges_node_deleted(node);
+		irouts_node_deleted(node);
+		/* Thread the memory onto the free list before the op changes,
+		 * irn_recycle() derives the size class from it.  Only the first
+		 * word is overwritten, so dead nodes swept later can still
+		 * unlink their uses of this one. */
+		irn_recycle(node);
+		/* noone is allowed to reference this node anymore */
+		set_irn_op(node, op_Deleted);
+	}
+}
+
 /**
  * Copies all reachable nodes to a new obstack.  Removes bad inputs
  * from block nodes and the corresponding inputs from Phi nodes.
@@ -74,7 +116,10 @@ static void copy_graph_env(ir_graph *irg)
  */
 void dead_node_elimination(ir_graph *irg)
 {
-	edges_deactivate(irg);
+	/* The node obstack is swapped below, so even incrementally maintained
+	 * edge sets must be torn down for real. */
+	edges_free_kind(irg, EDGE_KIND_BLOCK);
+	edges_free_kind(irg, EDGE_KIND_NORMAL);
 
 	/* Handle graph state */
 	free_callee_info(irg);
@@ -9,6 +9,8 @@
  * @author  Michael Beck
  */
 #include "analyze_irg_args.h"
+#include "callgraph.h"
+#include "cgana.h"
 #include "dbginfo_t.h"
 #include "debug.h"
 #include "ircons.h"
@@ -42,6 +44,10 @@ static unsigned *ready_set;
 /** IRG's that are in progress are marked here. */
 static unsigned *busy_set;
 
+/** Set whenever an analysis round proved a new entity property; another
+ * round over the recursive graphs may then propagate it further. */
+static bool props_changed;
+
 static bool method_type_contains_aggregate(const ir_type *type)
 {
 	for (size_t i = 0, n_params = get_method_n_params(type);
@@ -505,6 +511,8 @@ early_finish:
 	SET_IRG_READY(irg);
 	const mtp_additional_properties final_prop = prop | max_prop;
 	set_entity_additional_properties(entity, final_prop);
+	if (final_prop != prop)
+		props_changed = true;
 
 	const mtp_additional_properties new_prop = max_prop & ~prop;
 	if (new_prop & mtp_property_pure) {
@@ -803,6 +811,15 @@ static mtp_additional_properties check_nothrow_or_malloc(ir_graph *irg, bool top
 	return curr_prop;
 }
 
+/**
+ * Call graph walker, collects the graphs in callee-first order.
+ */
+static void collect_irg_order(ir_graph *irg, void *data)
+{
+	ir_graph ***order = (ir_graph***)data;
+	ARR_APP1(ir_graph*, *order, irg);
+}
+
 void optimize_funccalls(void)
 {
 	/* prepare: mark all graphs as not analyzed */
@@ -810,8 +827,22 @@ void optimize_funccalls(void)
 	ready_set = rbitset_malloc(last_idx);
 	busy_set  = rbitset_malloc(last_idx);
 
+	/* Analyze graphs callee-first, so that when a caller is examined its
+	 * callees are already done and the pessimistic in-progress handling
+	 * only triggers for real recursion cycles. */
+	ir_entity **free_methods;
+	cgana(&free_methods);
+	free(free_methods);
+	compute_callgraph();
+	ir_graph **order = NEW_ARR_F(ir_graph*, 0);
+	callgraph_walk(NULL, collect_irg_order, &order);
+	size_t n_irgs = ARR_LEN(order);
+	/* only the order is needed, the edges may become stale below */
+	free_callgraph();
+
 	/* first step: detect, which functions are nothrow or malloc */
-	foreach_irp_irg(i, irg) {
+	for (size_t i = 0; i < n_irgs; ++i) {
+		ir_graph *irg = order[i];
 		const mtp_additional_properties prop
 			= check_nothrow_or_malloc(irg, true);
 		if (prop & mtp_property_nothrow) {
@@ -825,15 +856,22 @@ void optimize_funccalls(void)
 	   detection of pure functions take place. */
 	handle_nothrow_Calls();
 
-	rbitset_clear_all(ready_set, last_idx);
-	rbitset_clear_all(busy_set, last_idx);
-
-	/* third step: detect, which functions are const */
-	foreach_irp_irg(i, irg) {
-		analyze_irg(irg);
-	}
+	/* third step: detect, which functions are const. Within a recursion
+	 * cycle the first member is analyzed with incomplete knowledge about
+	 * the others, so iterate to a fixpoint. Entity properties only ever
+	 * grow here, hence this terminates; acyclic programs are stable
+	 * after the first round. */
+	do {
+		rbitset_clear_all(ready_set, last_idx);
+		rbitset_clear_all(busy_set, last_idx);
+		props_changed = false;
+		for (size_t i = 0; i < n_irgs; ++i) {
+			analyze_irg(order[i]);
+		}
+	} while (props_changed);
 	handle_const_Calls();
 
+	DEL_ARR_F(order);
 	free(busy_set);
 	free(ready_set);
 }
@@ -22,12 +22,73 @@ DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
 static void visit_entity(ir_entity *entity);
 
+/**
+ * Mark a type and everything referenced by it (operand types, the member
+ * entities of compounds and their types, related classes) as reachable.
+ * Unmarked types are freed at the end of the collection.
+ */
+static void mark_type_reachable(ir_type *type)
+{
+	if (type_visited(type))
+		return;
+	mark_type_visited(type);
+
+	switch (get_type_opcode(type)) {
+	case tpo_class:
+		for (size_t i = 0, n = get_class_n_supertypes(type); i < n; ++i) {
+			mark_type_reachable(get_class_supertype(type, i));
+		}
+		/* subtypes must stay intact as well: the class hierarchy links and
+		 * the overwrites relation of the members point down the hierarchy */
+		for (size_t i = 0, n = get_class_n_subtypes(type); i < n; ++i) {
+			mark_type_reachable(get_class_subtype(type, i));
+		}
+		/* FALLTHROUGH */
+	case tpo_segment:
+	case tpo_struct:
+	case tpo_union:
+		for (size_t i = 0, n = get_compound_n_members(type); i < n; ++i) {
+			ir_entity *member = get_compound_member(type, i);
+			visit_entity(member);
+			mark_type_reachable(get_entity_type(member));
+		}
+		return;
+
+	case tpo_method:
+		for (size_t i = 0, n = get_method_n_params(type); i < n; ++i) {
+			mark_type_reachable(get_method_param_type(type, i));
+		}
+		for (size_t i = 0, n = get_method_n_ress(type); i < n; ++i) {
+			mark_type_reachable(get_method_res_type(type, i));
+		}
+		return;
+
+	case tpo_pointer:
+		mark_type_reachable(get_pointer_points_to_type(type));
+		return;
+
+	case tpo_array:
+		mark_type_reachable(get_array_element_type(type));
+		return;
+
+	case tpo_code:
+	case tpo_primitive:
+	case tpo_unknown:
+	case tpo_uninitialized:
+		return;
+	}
+	panic("invalid type found");
+}
+
 static void visit_node(ir_node *node, void *env)
 {
 	(void)env;
 	ir_entity *entity = get_irn_entity_attr(node);
 	if (entity != NULL)
 		visit_entity(entity);
+	ir_type *type = get_irn_type_attr(node);
+	if (type != NULL)
+		mark_type_reachable(type);
 }
 
 static void start_visit_node(ir_node *node)
@@ -67,6 +128,9 @@ static void visit_entity(ir_entity *entity)
 		return;
 	mark_entity_visited(entity);
 
+	mark_type_reachable(get_entity_type(entity));
+	mark_type_reachable(get_entity_owner(entity));
+
 	switch (get_entity_kind(entity)) {
 	case IR_ENTITY_NORMAL: {
 		ir_initializer_t *const init = get_entity_initializer(entity);
@@ -152,5 +216,25 @@ void garbage_collect_entities(void)
 		ir_type *type = get_segment_type(s);
 		garbage_collect_in_segment(type);
 	}
+
+	/* mark the remaining type roots: everything referenced from surviving
+	 * entities and nodes was already marked while visiting them */
+	foreach_irp_irg(i, irg) {
+		mark_type_reachable(get_irg_frame_type(irg));
+		mark_type_reachable(get_entity_type(get_irg_entity(irg)));
+	}
+	mark_type_reachable(irp->code_type);
+	mark_type_reachable(irp->unknown_type);
+	mark_type_reachable(irp->dummy_owner);
+
+	/* sweep all types nothing references anymore */
+	for (size_t i = get_irp_n_types(); i-- > 0; ) {
+		ir_type *type = get_irp_type(i);
+		if (type_visited(type))
+			continue;
+
+		DB((dbg, LEVEL_1, "  removing type %+F\n", type));
+		free_type(type);
+	}
 	irp_free_resources(irp, IRP_RESOURCE_TYPE_VISITED);
 }
@@ -10,6 +10,7 @@
  */
 #include "cdep_t.h"
 #include "debug.h"
+#include "execfreq.h"
 #include "ircons.h"
 #include "irgmod.h"
 #include "irgopt.h"
@@ -19,6 +20,7 @@
 #include "irtools.h"
 #include "pdeq.h"
 #include "target_t.h"
+#include "util.h"
 #include <assert.h>
 #include <stdbool.h>
 
@@ -32,6 +34,35 @@ typedef struct walker_env {
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
+/**
+ * Estimated cycle cost of turning one Phi into a Mux.
+ */
+static unsigned mux_cost(ir_mode const *mode)
+{
+	if (ir_target.mux_cost != NULL)
+		return ir_target.mux_cost(mode);
+	/* selecting float values usually takes more than one instruction */
+	return mode_is_float(mode) ? 3 : 1;
+}
+
+/**
+ * Estimates whether replacing the branch by Muxes pays off. A strongly
+ * biased branch predicts well, so executing all Muxes unconditionally can
+ * be slower than the occasional misprediction.
+ */
+static bool muxes_are_profitable(ir_node const *pred0, ir_node const *pred1,
+                                 unsigned cost)
+{
+	double const freq0 = get_block_execfreq(pred0);
+	double const freq1 = get_block_execfreq(pred1);
+	double const sum   = freq0 + freq1;
+	if (sum <= 0.0) /* no frequency information, assume profitable */
+		return true;
+	double const mispredict_freq = MIN(freq0, freq1) / sum;
+	return (double)cost <= mispredict_freq
+	                       * ir_target.branch_mispredict_penalty;
+}
+
 /**
  * Returns non-zero if a Block can be emptied.
  *
@@ -308,6 +339,7 @@ restart:;
 				ir_node *phi       = get_Block_phis(block);
 				bool     supported = true;
 				bool     negated   = get_Proj_num(projx0) == pn_Cond_false;
+				unsigned cost      = 0;
 				for (ir_node *p = phi; p != NULL; p = get_Phi_next(p)) {
 					ir_node *mux_false;
 					ir_node *mux_true;
@@ -326,9 +358,15 @@ restart:;
 						supported = false;
 						break;
 					}
+					cost += mux_cost(mode);
 				}
 				if (!supported)
 					continue;
+				if (!muxes_are_profitable(pred0, pred1, cost)) {
+					DB((dbg, LEVEL_1, "Not converting %+F: Mux cost %u "
+					    "exceeds expected misprediction cost\n", cond, cost));
+					continue;
+				}
 
 				DB((dbg, LEVEL_1, "Found Cond %+F with proj %+F and %+F\n",
 					cond, projx0, projx1
@@ -451,6 +489,9 @@ void opt_if_conv_cb(ir_graph *irg, arch_allow_ifconv_func callback)
 	deq_t waitq;
 	deq_init(&waitq);
 
+	/* the profitability check weighs Mux costs against the branch bias */
+	ir_estimate_execfreq(irg);
+
 	assure_irg_properties(irg,
 		IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES
 		| IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
@@ -12,6 +12,7 @@
 #include "irgopt.h"
 
 #include "constbits.h"
+#include "firm_thread.h"
 #include "ircons.h"
 #include "iredges_t.h"
 #include "irflag_t.h"
@@ -21,10 +22,18 @@
 #include "irnode_t.h"
 #include "iropt_t.h"
 #include "iroptimize.h"
+#include "irprog_t.h"
 #include "irtools.h"
 #include "pdeq.h"
+#include "pqueue.h"
+#include "timereg.h"
+#include "xmalloc.h"
 #include <assert.h>
 
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
 /**
  * A wrapper around optimize_inplace_2() to be called from a walker.
  */
@@ -54,31 +63,52 @@ void local_optimize_node(ir_node *n)
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
 }
 
-static void enqueue_node(ir_node *node, deq_t *waitq)
+/**
+ * The worklist of the data flow optimizer: deduplicated via the link
+ * field and ordered so that nodes pop in the topological order assigned
+ * by the initial walk (defs before uses), which lets most nodes converge
+ * in a single visit.
+ */
+typedef struct opt_worklist_t {
+	pqueue_t *queue;
+	unsigned *order;   /**< topological order numbers, by node index */
+	unsigned  n_order; /**< size of the order array */
+	unsigned  counter; /**< running number used by the initial walk */
+} opt_worklist_t;
+
+static void enqueue_node(ir_node *node, opt_worklist_t *wl)
 {
-	if (get_irn_link(node) == waitq)
+	if (get_irn_link(node) == wl)
 		return;
-	deq_push_pointer_right(waitq, node);
-	set_irn_link(node, waitq);
+	/* nodes created after the initial walk have no order number yet and
+	 * simply pop last */
+	unsigned const idx  = get_irn_idx(node);
+	int      const prio = idx < wl->n_order ? -(int)wl->order[idx]
+	                                        : -(int)wl->counter;
+	pqueue_put(wl->queue, node, prio);
+	set_irn_link(node, wl);
 }
 
 static void enqueue_node_init(ir_node *node, void *env)
 {
-	deq_t *waitq = (deq_t *)env;
-	deq_push_pointer_right(waitq, node);
-	set_irn_link(node, waitq);
+	opt_worklist_t *wl  = (opt_worklist_t*)env;
+	unsigned const  idx = get_irn_idx(node);
+	assert(idx < wl->n_order);
+	wl->order[idx] = wl->counter++;
+	pqueue_put(wl->queue, node, -(int)wl->order[idx]);
+	set_irn_link(node, wl);
 }
 
 /**
  * Enqueue all users of a node to a wait queue.
  * Handles mode_T nodes.
  */
-static void enqueue_users(ir_node *n, deq_t *waitq)
+static void enqueue_users(ir_node *n, opt_worklist_t *wl)
 {
 	foreach_out_edge(n, edge) {
 		ir_node *succ = get_edge_src_irn(edge);
 
-		enqueue_node(succ, waitq);
+		enqueue_node(succ, wl);
 
 		/* Also enqueue Phis to prevent inconsistencies. */
 		if (is_Block(succ)) {
@@ -86,13 +116,13 @@ static void enqueue_users(ir_node *n, deq_t *waitq)
 				ir_node *succ2 = get_edge_src_irn(edge2);
 
 				if (is_Phi(succ2)) {
-					enqueue_node(succ2, waitq);
+					enqueue_node(succ2, wl);
 				}
 			}
 		} else if (get_irn_mode(succ) == mode_T) {
 		/* A mode_T node has Proj's. Because most optimizations
 			run on the Proj's we have to enqueue them also. */
-			enqueue_users(succ, waitq);
+			enqueue_users(succ, wl);
 		}
 	}
 }
@@ -105,25 +135,27 @@ static void find_unreachable_blocks(ir_node *block, void *env)
 	if (get_Block_dom_depth(block) >= 0)
 		return;
 
-	deq_t *waitq = (deq_t *)env;
+	opt_worklist_t *wl = (opt_worklist_t*)env;
 	foreach_block_succ(block, edge) {
 		ir_node *succ_block = get_edge_src_irn(edge);
-		enqueue_node(succ_block, waitq);
+		enqueue_node(succ_block, wl);
 		foreach_out_edge(succ_block, edge2) {
 			ir_node *succ = get_edge_src_irn(edge2);
 			if (is_Phi(succ))
-				enqueue_node(succ, waitq);
+				enqueue_node(succ, wl);
 		}
 	}
 
 	ir_graph *irg = get_irn_irg(block);
 	ir_node *end = get_irg_end(irg);
-	enqueue_node(end, waitq);
+	enqueue_node(end, wl);
 }
 
 void local_optimize_graph(ir_graph *irg)
 {
+	ir_timereg_push("local_optimize_graph", irg);
 	local_optimize_node(get_irg_end(irg));
+	ir_timereg_pop();
 }
 
 /**
@@ -131,7 +163,7 @@ void local_optimize_graph(ir_graph *irg)
  * Optimizes all nodes and enqueue its users
  * if done.
  */
-static void opt_walker(ir_node *n, deq_t *waitq)
+static void opt_walker(ir_node *n, opt_worklist_t *wl)
 {
 	/* If CSE occurs during the optimization,
 	 * our operands have fewer users than before.
@@ -145,7 +177,7 @@ static void opt_walker(ir_node *n, deq_t *waitq)
 		optimized = optimize_in_place_2(last);
 
 		if (optimized != last) {
-			enqueue_users(last, waitq);
+			enqueue_users(last, wl);
 			exchange(last, optimized);
 		}
 	} while (optimized != last);
@@ -153,6 +185,8 @@ static void opt_walker(ir_node *n, deq_t *waitq)
 
 void optimize_graph_df(ir_graph *irg)
 {
+	ir_timereg_push("optimize_graph_df", irg);
+
 	ir_graph_properties_t props = IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES;
 	if (get_opt_global_cse()) {
 		set_irg_pinned(irg, op_pin_state_floats);
@@ -174,20 +208,22 @@ void optimize_graph_df(ir_graph *irg)
 
 	constbits_analyze(irg);
 
-	deq_t waitq;
-	deq_init(&waitq);
-	irg_walk_graph(irg, NULL, enqueue_node_init, &waitq);
+	opt_worklist_t wl = { .queue   = new_pqueue(),
+	                      .n_order = get_irg_last_idx(irg),
+	                      .counter = 0 };
+	wl.order = XMALLOCNZ(unsigned, wl.n_order);
+	irg_walk_graph(irg, NULL, enqueue_node_init, &wl);
 
 	/* any optimized nodes are stored in the wait queue,
 	 * so if it's not empty, the graph has been changed */
-	while (!deq_empty(&waitq)) {
+	while (!pqueue_empty(wl.queue)) {
 		assure_irg_properties(irg, props);
 
 		/* finish the wait queue */
-		while (!deq_empty(&waitq)) {
-			ir_node *n = deq_pop_pointer_left(ir_node, &waitq);
+		while (!pqueue_empty(wl.queue)) {
+			ir_node *n = (ir_node*)pqueue_pop_front(wl.queue);
 			set_irn_link(n, NULL);
-			opt_walker(n, &waitq);
+			opt_walker(n, &wl);
 		}
 		if (irg_is_constrained(irg, IR_GRAPH_CONSTRAINT_OPTIMIZE_UNREACHABLE_CODE)) {
 			/* Calculate dominance so we can kill unreachable code
@@ -195,10 +231,11 @@ void optimize_graph_df(ir_graph *irg)
 			 * (phase coupling) */
 			compute_doms(irg);
 			assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
-			irg_block_walk_graph(irg, NULL, find_unreachable_blocks, &waitq);
+			irg_block_walk_graph(irg, NULL, find_unreachable_blocks, &wl);
 		}
 	}
-	deq_free(&waitq);
+	free(wl.order);
+	del_pqueue(wl.queue);
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
 
 	constbits_clear(irg);
@@ -217,6 +254,8 @@ void optimize_graph_df(ir_graph *irg)
 	 * Doing this AFTER edges where deactivated saves cycles */
 	ir_node *end = get_irg_end(irg);
 	remove_End_Bads_and_doublets(end);
+
+	ir_timereg_pop();
 }
 
 void local_opts_const_code(void)
@@ -229,3 +268,79 @@ void local_opts_const_code(void)
 	walk_const_code(firm_clear_link, optimize_in_place_wrapper, NULL);
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
 }
+
+/** Work distribution state shared between the pipeline worker threads. */
+typedef struct pipeline_work_t {
+	irg_pipeline_func func;    /**< the graph-local pipeline to run */
+	size_t            next;    /**< index of the next unprocessed irg */
+#ifndef _WIN32
+	pthread_mutex_t   lock;    /**< protects next */
+#endif
+} pipeline_work_t;
+
+static void run_pipeline_serial(irg_pipeline_func func)
+{
+	foreach_irp_irg(i, irg) {
+		func(irg);
+	}
+}
+
+#ifndef _WIN32
+
+static void *pipeline_worker(void *data)
+{
+	pipeline_work_t *work    = (pipeline_work_t*)data;
+	size_t const     n_irgs  = get_irp_n_irgs();
+
+	for (;;) {
+		pthread_mutex_lock(&work->lock);
+		size_t const pos = work->next++;
+		pthread_mutex_unlock(&work->lock);
+		if (pos >= n_irgs)
+			break;
+		work->func(get_irp_irg(pos));
+	}
+	return NULL;
+}
+
+void run_irg_pipeline_parallel(irg_pipeline_func func, unsigned n_threads)
+{
+	size_t const n_irgs = get_irp_n_irgs();
+	if (n_threads > n_irgs)
+		n_threads = (unsigned)n_irgs;
+	if (n_threads <= 1) {
+		run_pipeline_serial(func);
+		return;
+	}
+
+	pipeline_work_t work = { .func = func, .next = 0 };
+	pthread_mutex_init(&work.lock, NULL);
+	firm_parallel_begin();
+
+	pthread_t *workers = XMALLOCN(pthread_t, n_threads);
+	for (unsigned t = 0; t < n_threads; ++t) {
+		if (pthread_create(&workers[t], NULL, pipeline_worker, &work) != 0) {
+			/* fall back to running the remaining work ourselves */
+			n_threads = t;
+			break;
+		}
+	}
+	pipeline_worker(&work);
+	for (unsigned t = 0; t < n_threads; ++t) {
+		pthread_join(workers[t], NULL);
+	}
+	free(workers);
+
+	firm_parallel_end();
+	pthread_mutex_destroy(&work.lock);
+}
+
+#else
+
+void run_irg_pipeline_parallel(irg_pipeline_func func, unsigned n_threads)
+{
+	(void)n_threads;
+	run_pipeline_serial(func);
+}
+
+#endif
@@ -30,13 +30,17 @@
 #include "irnode_t.h"
 #include "iropt_dbg.h"
 #include "iroptimize.h"
+#include "irouts_t.h"
 #include "irtools.h"
 #include "irverify.h"
 #include "panic.h"
+#include "statev_t.h"
 #include "target_t.h"
 #include "tv_t.h"
+#include "util.h"
 #include "vrp.h"
 #include <stdbool.h>
+#include <stdio.h>
 #include <string.h>
 
 static bool imprecise_float_transforms_allowed;
@@ -1010,7 +1014,7 @@ static ir_tarval *computed_value_Proj(const ir_node *proj)
  */
 ir_tarval *computed_value(const ir_node *n)
 {
-	const vrp_attr *vrp = vrp_get_info(n);
+	const vrp_attr *vrp = vrp_get_or_compute_info(n);
 	if (vrp != NULL && vrp->bits_set == vrp->bits_not_set)
 		return vrp->bits_set;
 
@@ -1751,6 +1755,59 @@ static ir_node *equivalent_node_Confirm(ir_node *n)
 	return n;
 }
 
+/** Counters for one rule callback of one op. */
+typedef struct opt_rule_count_t {
+	unsigned long long attempts; /**< times the callback was invoked */
+	unsigned long long fired;    /**< times it returned another node */
+	unsigned long long created;  /**< nodes allocated during the callback */
+} opt_rule_count_t;
+
+/** Per opcode counters for the equivalent_node and transform_node rules. */
+typedef struct opt_rule_stat_t {
+	opt_rule_count_t equiv;
+	opt_rule_count_t trans;
+} opt_rule_stat_t;
+
+static opt_rule_stat_t *rule_stats;
+static unsigned         n_rule_stats;
+
+/**
+ * Rule counters are only collected while statistic events are written and
+ * the middle end optimization category is active; the dispatchers stay a
+ * plain indirect call otherwise.
+ */
+static inline bool rule_stats_active(void)
+{
+#ifdef DISABLE_STATEV
+	return false;
+#else
+	return stat_ev_cat_compiled(STAT_EV_CAT_OPT) && stat_ev_enabled
+	    && ((stat_ev_active_categories >> STAT_EV_CAT_OPT) & 1u);
+#endif
+}
+
+static opt_rule_stat_t *get_rule_stat(ir_op const *const op)
+{
+	unsigned const code = op->code;
+	if (code >= n_rule_stats) {
+		/* ops can be registered late (backend ops), grow on demand */
+		unsigned const new_size = ir_get_n_opcodes();
+		assert(code < new_size);
+		rule_stats = XREALLOC(rule_stats, opt_rule_stat_t, new_size);
+		memset(rule_stats + n_rule_stats, 0,
+		       (new_size - n_rule_stats) * sizeof(rule_stats[0]));
+		n_rule_stats = new_size;
+	}
+	return &rule_stats[code];
+}
+
+void firm_finish_localopt(void)
+{
+	free(rule_stats);
+	rule_stats   = NULL;
+	n_rule_stats = 0;
+}
+
 /**
  * equivalent_node() returns a node equivalent to input n. It skips all nodes that
  * perform no actual computation, as, e.g., the Id nodes.  It does not create
@@ -1760,9 +1817,20 @@ static ir_node *equivalent_node_Confirm(ir_node *n)
  */
 ir_node *equivalent_node(ir_node *n)
 {
-	if (n->op->ops.equivalent_node)
+	if (n->op->ops.equivalent_node == NULL)
+		return n;
+	if (!rule_stats_active())
 		return n->op->ops.equivalent_node(n);
-	return n;
+
+	opt_rule_count_t *const cnt    = &get_rule_stat(n->op)->equiv;
+	ir_graph         *const irg    = get_irn_irg(n);
+	unsigned          const before = get_irg_last_idx(irg);
+	ir_node          *const newn   = n->op->ops.equivalent_node(n);
+	++cnt->attempts;
+	cnt->created += get_irg_last_idx(irg) - before;
+	if (newn != n)
+		++cnt->fired;
+	return newn;
 }
 
 /** Returns true if we can be sure that @p node only has a single read user. */
@@ -7642,7 +7710,18 @@ restart:;
 		(iro == iro_Cond) ||
 		(iro == iro_Proj)) {    /* Flags tested local. */
 		if (n->op->ops.transform_node != NULL) {
-			n = n->op->ops.transform_node(n);
+			if (!rule_stats_active()) {
+				n = n->op->ops.transform_node(n);
+			} else {
+				opt_rule_count_t *const cnt    = &get_rule_stat(n->op)->trans;
+				ir_graph         *const irg    = get_irn_irg(n);
+				unsigned          const before = get_irg_last_idx(irg);
+				n = n->op->ops.transform_node(n);
+				++cnt->attempts;
+				cnt->created += get_irg_last_idx(irg) - before;
+				if (n != old_n)
+					++cnt->fired;
+			}
 			if (n != old_n)
 				goto restart;
 		}
@@ -7651,6 +7730,78 @@ restart:;
 	return n;
 }
 
+/** One line of the rule statistics report. */
+typedef struct rule_report_entry_t {
+	char const             *kind;    /**< "equiv" or "trans" */
+	char const             *op_name;
+	opt_rule_count_t const *cnt;
+} rule_report_entry_t;
+
+static int cmp_rule_report(void const *const p1, void const *const p2)
+{
+	rule_report_entry_t const *const e1 = (rule_report_entry_t const*)p1;
+	rule_report_entry_t const *const e2 = (rule_report_entry_t const*)p2;
+	/* rank by attempts that did not fire: that is the scan cost we pay
+	 * without getting anything back */
+	unsigned long long const miss1 = e1->cnt->attempts - e1->cnt->fired;
+	unsigned long long const miss2 = e2->cnt->attempts - e2->cnt->fired;
+	if (miss1 != miss2)
+		return QSORT_CMP(miss2, miss1);
+	return QSORT_CMP(e2->cnt->attempts, e1->cnt->attempts);
+}
+
+void ir_localopt_dump_rule_stats(FILE *const out)
+{
+	rule_report_entry_t *entries   = NEW_ARR_F(rule_report_entry_t, 0);
+	for (unsigned i = 0; i < n_rule_stats; ++i) {
+		ir_op const *const op = ir_get_opcode(i);
+		if (op == NULL)
+			continue;
+		char const *const name = get_op_name(op);
+		if (rule_stats[i].equiv.attempts != 0) {
+			rule_report_entry_t entry
+				= { "equiv", name, &rule_stats[i].equiv };
+			ARR_APP1(rule_report_entry_t, entries, entry);
+		}
+		if (rule_stats[i].trans.attempts != 0) {
+			rule_report_entry_t entry
+				= { "trans", name, &rule_stats[i].trans };
+			ARR_APP1(rule_report_entry_t, entries, entry);
+		}
+	}
+	QSORT_ARR(entries, cmp_rule_report);
+
+	fprintf(out, "%-5s %-10s %12s %12s %6s %12s\n",
+	        "rule", "op", "attempts", "fired", "hit%", "created");
+	for (size_t i = 0, n = ARR_LEN(entries); i < n; ++i) {
+		rule_report_entry_t const *const entry = &entries[i];
+		opt_rule_count_t    const *const cnt   = entry->cnt;
+		fprintf(out, "%-5s %-10s %12llu %12llu %6.2f %12llu\n",
+		        entry->kind, entry->op_name, cnt->attempts, cnt->fired,
+		        (double)cnt->fired * 100.0 / (double)cnt->attempts,
+		        cnt->created);
+
+#ifndef DISABLE_STATEV
+		/* also report the counters as statistic events, so the statev
+		 * tooling can aggregate them across compilations */
+		if (rule_stats_active()) {
+			char name[64];
+			snprintf(name, sizeof(name), "iropt_rule_%s_%s_attempts",
+			         entry->kind, entry->op_name);
+			stat_ev_ull(name, cnt->attempts);
+			snprintf(name, sizeof(name), "iropt_rule_%s_%s_fired",
+			         entry->kind, entry->op_name);
+			stat_ev_ull(name, cnt->fired);
+		}
+#endif
+	}
+	DEL_ARR_F(entries);
+
+	/* start the next measurement interval from zero */
+	if (n_rule_stats != 0)
+		memset(rule_stats, 0, n_rule_stats * sizeof(rule_stats[0]));
+}
+
 void ir_register_opt_node_ops(void)
 {
 	set_op_computed_value(op_Add,      computed_value_Add);
@@ -7885,8 +8036,10 @@ ir_node *identify_remember(ir_node *n)
 	ir_node *nn = (ir_node *)pset_insert(value_table, n, ir_node_hash(n));
 
 	/* nn is reachable again */
-	if (nn != n)
+	if (nn != n) {
 		edges_node_revival(nn);
+		irouts_node_revival(nn);
+	}
 
 	return nn;
 }
@@ -7959,6 +8112,7 @@ ir_node *optimize_node(ir_node *n)
 
 				/* note the inplace edges module */
 				edges_node_deleted(n);
+				irouts_node_deleted(n);
 
 				/* evaluation was successful -- replace the node. */
 				irg_kill_node(irg, n);
@@ -7986,6 +8140,7 @@ ir_node *optimize_node(ir_node *n)
 
 	if (n != oldn) {
 		edges_node_deleted(oldn);
+		irouts_node_deleted(oldn);
 
 		/* We found an existing, better node, so we can deallocate the old node. */
 		irg_kill_node(irg, oldn);
@@ -61,6 +61,9 @@ ir_node *identify_remember(ir_node *n);
 /** Visit each node in the value table of a graph. */
 void visit_all_identities(ir_graph *irg, irg_walk_func visit, void *env);
 
+/** Frees the rule hit counters of the local optimizer. */
+void firm_finish_localopt(void);
+
 /**
  * Normalize a node by putting constants (and operands with larger
  * node index) on the right (operator side).
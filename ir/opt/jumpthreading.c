@@ -21,6 +21,7 @@
 #include "iroptimize.h"
 #include "iroptimize.h"
 #include "irtools.h"
+#include "pdeq.h"
 #include "tv.h"
 #include "vrp.h"
 #include <assert.h>
@@ -546,7 +547,51 @@ static ir_node *find_candidate(jumpthreading_env_t *env, ir_node *jump,
 }
 
 /**
- * Block-walker: searches for the following construct
+ * Worklist of blocks that (re)became threading candidates.  Queued
+ * blocks carry the block mark so nothing is queued twice.
+ */
+typedef struct jt_worklist_t {
+	deq_t queue;
+	bool  changed;
+} jt_worklist_t;
+
+static void jt_enqueue(jt_worklist_t *wl, ir_node *block)
+{
+	if (get_Block_mark(block))
+		return;
+	set_Block_mark(block, 1);
+	deq_push_pointer_right(&wl->queue, block);
+}
+
+/** Block-walker: puts every block on the initial worklist.  The walker
+ * visits each block once, so the possibly stale mark is just set. */
+static void jt_collect_blocks(ir_node *block, void *data)
+{
+	jt_worklist_t *wl = (jt_worklist_t*)data;
+	set_Block_mark(block, 1);
+	deq_push_pointer_right(&wl->queue, block);
+}
+
+/** Re-queues all control flow successors of a block. */
+static void jt_enqueue_succs(jt_worklist_t *wl, ir_node *block)
+{
+	foreach_block_succ(block, edge) {
+		jt_enqueue(wl, get_edge_src_irn(edge));
+	}
+}
+
+/** Re-queues all control flow predecessor blocks of a block. */
+static void jt_enqueue_preds(jt_worklist_t *wl, ir_node *block)
+{
+	for (int i = get_Block_n_cfgpreds(block); i-- > 0; ) {
+		ir_node *pred = get_Block_cfgpred_block(block, i);
+		if (pred != NULL)
+			jt_enqueue(wl, pred);
+	}
+}
+
+/**
+ * Searches for the following construct
  *
  *  Const or Phi with constants
  *           |
@@ -558,9 +603,8 @@ static ir_node *find_candidate(jumpthreading_env_t *env, ir_node *jump,
  *        /
  *     Block
  */
-static void thread_jumps(ir_node* block, void* data)
+static void thread_jumps(ir_node* block, jt_worklist_t *wl)
 {
-	bool *changed = (bool*)data;
 
 	/* we do not deal with Phis, so restrict this to exactly one cfgpred */
 	if (get_Block_n_cfgpreds(block) != 1)
@@ -590,7 +634,9 @@ static void thread_jumps(ir_node* block, void* data)
 			[pn_Cond_true]  = is_true ? jmp : bad,
 		};
 		turn_into_tuple(cond, ARRAY_SIZE(in), in);
-		*changed = true;
+		wl->changed = true;
+		/* one branch died, the blocks behind it may thread further */
+		jt_enqueue_succs(wl, block);
 		return;
 	}
 	inc_irg_visited(irg);
@@ -627,10 +673,19 @@ static void thread_jumps(ir_node* block, void* data)
 		}
 
 		set_Block_cfgpred(env.cnst_pred, cnst_pos, badX);
+
+		/* the rewired edge may expose opportunities behind the pred */
+		jt_enqueue_succs(wl, env.cnst_pred);
 	}
 
-	/* the graph is changed now */
-	*changed = true;
+	/* the graph is changed now: revisit the neighborhood instead of
+	 * rescanning the whole graph */
+	wl->changed = true;
+	jt_enqueue(wl, block);
+	/* split_critical_edge() created fresh single-pred blocks in front
+	 * of our block, they are candidates themselves */
+	jt_enqueue_preds(wl, block);
+	jt_enqueue_succs(wl, block);
 }
 
 void opt_jumpthreading(ir_graph* irg)
@@ -644,17 +699,27 @@ void opt_jumpthreading(ir_graph* irg)
 
 	DB((dbg, LEVEL_1, "===> Performing jumpthreading on %+F\n", irg));
 
-	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_IRN_VISITED);
-
-	bool changed = false;
-	bool rerun;
-	do {
-		rerun = false;
-		irg_block_walk_graph(irg, thread_jumps, NULL, &rerun);
-		changed |= rerun;
-	} while (rerun);
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_IRN_VISITED
+	                        | IR_RESOURCE_BLOCK_MARK);
+
+	/* Collect all candidate blocks once, then only revisit blocks whose
+	 * neighborhood was rewritten by an applied thread.  This replaces
+	 * repeated whole-graph rescans with work proportional to the number
+	 * of applied threads. */
+	jt_worklist_t wl = { .changed = false };
+	deq_init(&wl.queue);
+	irg_block_walk_graph(irg, NULL, jt_collect_blocks, &wl);
+
+	while (!deq_empty(&wl.queue)) {
+		ir_node *block = deq_pop_pointer_left(ir_node, &wl.queue);
+		set_Block_mark(block, 0);
+		thread_jumps(block, &wl);
+	}
+	deq_free(&wl.queue);
 
-	ir_free_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_IRN_VISITED);
+	bool const changed = wl.changed;
+	ir_free_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_IRN_VISITED
+	                     | IR_RESOURCE_BLOCK_MARK);
 
 	if (changed) {
 		/* we tend to produce a lot of duplicated keep edges, remove them */
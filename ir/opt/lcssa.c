@@ -345,6 +345,9 @@ void assure_loop_lcssa(ir_graph *const irg, ir_loop *const loop)
 {
 	FIRM_DBG_REGISTER(dbg, "firm.opt.lcssa");
 	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO | IR_GRAPH_PROPERTY_CONSISTENT_OUTS | IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+	/* freeze the out arrays: they are iterated while the uses are rerouted
+	 * to the new Phis and must not be patched under the iteration */
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
 	inc_irg_visited(irg);
 	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
 	irg_walk_graph(irg, firm_clear_link, NULL, NULL);
@@ -20,7 +20,7 @@
 #include "irgraph_t.h"
 #include "irgwalk.h"
 #include "irhooks.h"
-#include "irmemory.h"
+#include "irmemory_t.h"
 #include "irmode_t.h"
 #include "irnode_t.h"
 #include "irnodehashmap.h"
@@ -2316,6 +2316,10 @@ void optimize_load_store(ir_graph *irg)
 	walk_env_t env = { .changes = NO_CHANGES };
 	obstack_init(&env.obst);
 
+	/* memoize alias queries, the walks below ask about the same address
+	 * pairs for every Load/Store on a memory chain */
+	ir_alias_cache_begin(irg);
+
 	/* init the links, then collect Loads/Stores/Proj's in lists */
 	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
 	master_visited = 0;
@@ -2333,6 +2337,8 @@ void optimize_load_store(ir_graph *irg)
 	env.changes |= optimize_loops(irg);
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
 
+	ir_alias_cache_end(irg);
+
 	obstack_free(&env.obst, NULL);
 
 	confirm_irg_properties(irg,
@@ -25,6 +25,7 @@
 #include "iroptimize.h"
 #include "irouts.h"
 #include "irtools.h"
+#include "loop_pass.h"
 #include "opt_init.h"
 #include "panic.h"
 #include "util.h"
@@ -74,8 +75,6 @@ static entry_edge *cur_head_outs;
 static ir_node *loop_head       = NULL;
 static bool     loop_head_valid = true;
 
-/* List of all inner loops, that are processed. */
-static ir_loop **loops;
 
 /* Stats */
 typedef struct loop_stats_t {
@@ -2261,23 +2260,6 @@ static void init_analyze(ir_graph *const irg, ir_loop *const loop, loop_op_t con
 	DB((dbg, LEVEL_1, "       <<<< end of loop with node %ld >>>>\n", get_loop_loop_nr(loop)));
 }
 
-/* Find innermost loops and add them to loops. */
-static void find_innermost_loop(ir_loop *const loop)
-{
-	bool         had_sons   = false;
-	size_t const n_elements = get_loop_n_elements(loop);
-	for (size_t e = 0; e < n_elements; ++e) {
-		loop_element element = get_loop_element(loop, e);
-		if (*element.kind == k_ir_loop) {
-			find_innermost_loop(element.son);
-			had_sons = true;
-		}
-	}
-
-	if (!had_sons)
-		ARR_APP1(ir_loop*, loops, loop);
-}
-
 static void set_loop_params(void)
 {
 	opt_params.max_loop_size            =  100;
@@ -2293,69 +2275,105 @@ static void set_loop_params(void)
 }
 
 /**
- * Optimize loops by peeling or unrolling them if beneficial.
- *
- * @param irg  The graph whose loops will be processed
- *
- * This function did not change the graph, only its frame type.
- * The layout state of the frame type will be set to layout_undefined
- * if entities were removed.
+ * Block walker: clears the backedge info of all Phis of a block.
  */
-static void loop_optimization(ir_graph *const irg, loop_op_t const loop_op)
+static void clear_phi_backedges(ir_node *const block, void *const env)
 {
-	/* Assure preconditions are met and go through all loops. */
+	(void)env;
+	for (ir_node *phi = get_Block_phis(block); phi != NULL;
+	     phi = get_Phi_next(phi)) {
+		clear_backedges(phi);
+	}
+}
+
+static void loop_opt_prepare(ir_graph *const irg, void *const env)
+{
+	(void)env;
+	/* Assure the remaining preconditions; the loop tree is provided by
+	 * the driver. */
 	assure_irg_properties(irg,
 		IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
-		| IR_GRAPH_PROPERTY_CONSISTENT_OUTS
-		| IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
-
-	set_loop_params();
-
-	/* Reset stats for this procedure */
-	reset_stats();
+		| IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
 
 	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_PHI_LIST);
 	collect_phiprojs_and_start_block_nodes(irg);
 
-	ir_loop *const loop = get_irg_loop(irg);
+	/* Set all links to NULL */
+	irg_walk_graph(irg, firm_clear_link, NULL, NULL);
+}
+
+static bool loop_opt_run_on_loop(ir_graph *const irg, ir_loop *const loop,
+                                 void *const env)
+{
+	loop_op_t const loop_op = *(loop_op_t const*)env;
 
-	loops = NEW_ARR_F(ir_loop *, 0);
-	/* List all inner loops */
+	/* Only innermost loops are processed. */
 	size_t const n_elements = get_loop_n_elements(loop);
 	for (size_t i = 0; i < n_elements; ++i) {
-		loop_element element = get_loop_element(loop, i);
-		if (*element.kind != k_ir_loop)
-			continue;
-		find_innermost_loop(element.son);
+		if (*get_loop_element(loop, i).kind == k_ir_loop)
+			return false;
 	}
 
-	/* Set all links to NULL */
-	irg_walk_graph(irg, firm_clear_link, NULL, NULL);
-
-	for (size_t i = 0; i < ARR_LEN(loops); ++i) {
-		ir_loop *const loop = loops[i];
+	++stats.loops;
 
-		++stats.loops;
+	/* Analyze and handle loop */
+	init_analyze(irg, loop, loop_op);
 
-		/* Analyze and handle loop */
-		init_analyze(irg, loop, loop_op);
+	/* Copied blocks do not have their phi list yet */
+	collect_phiprojs_and_start_block_nodes(irg);
 
-		/* Copied blocks do not have their phi list yet */
-		collect_phiprojs_and_start_block_nodes(irg);
+	/* Set links to NULL
+	 * TODO Still necessary? */
+	irg_walk_graph(irg, firm_clear_link, NULL, NULL);
 
-		/* Set links to NULL
-		 * TODO Still necessary? */
-		irg_walk_graph(irg, firm_clear_link, NULL, NULL);
-	}
+	/* The transformations invalidate the stale analyses themselves where
+	 * needed; the untouched part of the loop tree stays usable for the
+	 * rest of the sweep, so a single sweep suffices. */
+	return false;
+}
 
+static void loop_opt_finish(ir_graph *const irg, void *const env)
+{
+	(void)env;
 	print_stats();
 
-	DEL_ARR_F(loops);
+	/* The transformations above set backedge info on Phis of extended and
+	 * copied blocks. The loop tree construction only resets block
+	 * backedges, so drop the Phi bits here, while the Phi lists are still
+	 * valid. */
+	irg_block_walk_graph(irg, clear_phi_backedges, NULL, NULL);
+
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_PHI_LIST);
 
 	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_NONE);
 }
 
+/**
+ * Optimize loops by peeling or unrolling them if beneficial.
+ *
+ * @param irg  The graph whose loops will be processed
+ *
+ * This function did not change the graph, only its frame type.
+ * The layout state of the frame type will be set to layout_undefined
+ * if entities were removed.
+ */
+static void loop_optimization(ir_graph *const irg, loop_op_t loop_op)
+{
+	set_loop_params();
+
+	/* Reset stats for this procedure */
+	reset_stats();
+
+	loop_pass_t const pass = {
+		.name        = "loop",
+		.prepare     = loop_opt_prepare,
+		.run_on_loop = loop_opt_run_on_loop,
+		.finish      = loop_opt_finish,
+		.env         = &loop_op,
+	};
+	run_loop_passes(irg, &pass, 1);
+}
+
 void do_loop_unrolling(ir_graph *const irg)
 {
 	loop_optimization(irg, loop_op_unrolling);
@@ -0,0 +1,85 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2018 Karlsruhe Institute of Technology
+ */
+
+/**
+ * @file
+ * @brief   Shared driver for loop tree based optimizations
+ *
+ * The loop optimizations used to construct the loop tree on their own,
+ * each invalidating the tree the previous one had just built.  This
+ * driver builds the tree once per sweep, visits the loops innermost
+ * first and only rebuilds after a transformation actually changed the
+ * control flow.
+ */
+#include "loop_pass.h"
+
+#include "array.h"
+#include "debug.h"
+#include "irgraph_t.h"
+#include "irloop_t.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
+
+/** Appends the loops of the subtree rooted at @p loop to @p res in
+ * postorder, so inner loops come before the loops containing them. */
+static void collect_loops_postorder(ir_loop *const loop, ir_loop ***const res)
+{
+	size_t const n_elements = get_loop_n_elements(loop);
+	for (size_t i = 0; i < n_elements; ++i) {
+		loop_element const element = get_loop_element(loop, i);
+		if (*element.kind == k_ir_loop)
+			collect_loops_postorder(element.son, res);
+	}
+	ARR_APP1(ir_loop*, *res, loop);
+}
+
+void run_loop_passes(ir_graph *const irg, const loop_pass_t *const passes,
+                     size_t const n_passes)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.opt.loop-pass");
+
+	bool changed;
+	do {
+		changed = false;
+		assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+
+		for (size_t p = 0; p < n_passes; ++p) {
+			if (passes[p].prepare != NULL)
+				passes[p].prepare(irg, passes[p].env);
+		}
+
+		/* Snapshot the loops up front: the transformations may leave the
+		 * tree stale for the rest of the sweep.  The root loop merely
+		 * represents the whole graph and is not handed to the passes. */
+		ir_loop **postorder  = NEW_ARR_F(ir_loop*, 0);
+		ir_loop  *const root = get_irg_loop(irg);
+		size_t const n_elements = get_loop_n_elements(root);
+		for (size_t i = 0; i < n_elements; ++i) {
+			loop_element const element = get_loop_element(root, i);
+			if (*element.kind == k_ir_loop)
+				collect_loops_postorder(element.son, &postorder);
+		}
+
+		for (size_t i = 0; i < ARR_LEN(postorder); ++i) {
+			for (size_t p = 0; p < n_passes; ++p) {
+				if (passes[p].run_on_loop(irg, postorder[i], passes[p].env)) {
+					DB((dbg, LEVEL_2, "%s changed a loop of %+F\n",
+					    passes[p].name, irg));
+					changed = true;
+				}
+			}
+		}
+		DEL_ARR_F(postorder);
+
+		for (size_t p = 0; p < n_passes; ++p) {
+			if (passes[p].finish != NULL)
+				passes[p].finish(irg, passes[p].env);
+		}
+
+		if (changed)
+			clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+			                   | IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+	} while (changed);
+}
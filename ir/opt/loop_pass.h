@@ -0,0 +1,51 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2018 Karlsruhe Institute of Technology
+ */
+
+/**
+ * @file
+ * @brief   Shared driver for loop tree based optimizations
+ */
+#ifndef FIRM_OPT_LOOP_PASS_H
+#define FIRM_OPT_LOOP_PASS_H
+
+#include "firm_types.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A transformation run on single loops by run_loop_passes().
+ *
+ * The driver constructs the loop tree once per sweep and hands every
+ * loop to the registered passes, innermost loops first.  A
+ * transformation may leave the tree stale for the rest of the sweep as
+ * long as the structure of loops it did not touch stays intact; when
+ * any pass reports a change the driver rebuilds the tree and starts
+ * another sweep, so several passes share one loop tree construction
+ * instead of each rebuilding it.
+ */
+typedef struct loop_pass_t {
+	const char *name; /**< pass name for debug output */
+	/** Called once per sweep before the loops are visited.  May assure
+	 *  additional graph properties and reserve resources. */
+	void (*prepare)(ir_graph *irg, void *env);
+	/** Transform a single loop.  Returns true if the graph was changed
+	 *  in a way that invalidates the loop tree; the driver then runs
+	 *  another sweep over the rebuilt tree.  Local changes a pass
+	 *  accounts for itself may be reported as false to finish in a
+	 *  single sweep. */
+	bool (*run_on_loop)(ir_graph *irg, ir_loop *loop, void *env);
+	/** Called once per sweep after the loops were visited. */
+	void (*finish)(ir_graph *irg, void *env);
+	void *env; /**< opaque data passed to the callbacks */
+} loop_pass_t;
+
+/**
+ * Runs @p passes on every loop of @p irg, innermost loops first.
+ * Sweeps are repeated until no pass reports a change anymore.
+ */
+void run_loop_passes(ir_graph *irg, const loop_pass_t *passes,
+                     size_t n_passes);
+
+#endif
@@ -9,15 +9,31 @@
  * @author  Elias Aebi
  */
 #include "lcssa_t.h"
+#include "loop_iv.h"
+#include "loop_pass.h"
+#include "irloop_t.h"
 #include "irtools.h"
 #include "xmalloc.h"
 #include "debug.h"
+#include "execfreq.h"
+#include "irprofile.h"
+#include "util.h"
 #include <assert.h>
 #include <pset_new.h>
 #include "irnode_t.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
 
+/** Loops whose header runs less often than this fraction of the function
+ * entry are considered cold and not unrolled at all. */
+#define UNROLL_COLD_THRESHOLD 0.125
+/** Loops whose header runs at least this many times per function entry
+ * are considered hot. */
+#define UNROLL_HOT_THRESHOLD  64.0
+/** Maximum unroll factor granted to hot loops independently of the
+ * factor requested by the caller. */
+#define UNROLL_HOT_MAX_FACTOR 32
+
 pset_new_t loop_blocks;
 
 static void add_edge(ir_node *const node, ir_node *const pred)
@@ -49,48 +65,6 @@ static bool block_is_inside_loop(ir_node *const block, ir_loop *const loop)
 	return block_loop == loop || is_inner_loop(loop, block_loop);
 }
 
-static bool block_dominates_loop(ir_node *const block, ir_loop *const loop)
-{
-	size_t const n_elements = get_loop_n_elements(loop);
-	for (size_t i = 0; i < n_elements; ++i) {
-		loop_element const element = get_loop_element(loop, i);
-		if (*element.kind == k_ir_node) {
-			assert(is_Block(element.node));
-			if (!block_dominates(block, element.node))
-				return false;
-		} else if (*element.kind == k_ir_loop) {
-			if (!block_dominates_loop(block, element.son))
-				return false;
-		}
-	}
-	return true;
-}
-
-// returns the block that dominates all blocks in the loop or NULL
-static ir_node *get_loop_header(ir_loop *const loop)
-{
-	// pick a random block
-	ir_node *header = NULL;
-	size_t const n_elements = get_loop_n_elements(loop);
-	for (size_t i = 0; i < n_elements; ++i) {
-		loop_element const element = get_loop_element(loop, i);
-		if (*element.kind == k_ir_node) {
-			header = element.node;
-			break;
-		}
-	}
-	assert(header && is_Block(header));
-
-	// walk up the dominance tree
-	ir_node *idom = get_Block_idom(header);
-	while (idom && block_is_inside_loop(idom, loop)) {
-		header = idom;
-		idom = get_Block_idom(header);
-	}
-
-	return block_dominates_loop(header, loop) ? header : NULL;
-}
-
 static ir_node *duplicate_node(ir_node *const node, ir_node *const new_block)
 {
 	ir_node *const new_node = exact_copy(node);
@@ -215,6 +189,14 @@ static void duplicate_block(ir_node *const block)
 	ir_node *const new_block = duplicate_node(block, NULL);
 	pset_new_insert(&loop_blocks, new_block);
 
+	/* register the copy with the loop of the original so the loop tree
+	 * stays usable while the remaining loops of this run are processed */
+	ir_loop *const loop = get_irn_loop(block);
+	if (loop != NULL) {
+		set_irn_loop(new_block, loop);
+		add_loop_node(loop, new_block);
+	}
+
 	unsigned const n_outs = get_irn_n_outs(block);
 	for (unsigned i = 0; i < n_outs; ++i) {
 		ir_node *const node = get_irn_out(block, i);
@@ -263,13 +245,6 @@ static unsigned find_optimal_factor(unsigned long number, unsigned max) {
 /**
  * walk trivial phis (with only one input) until another node is found
  */
-static ir_node* skip_trivial_phis(ir_node *start) {
-	if (is_Phi(start) && get_Phi_n_preds(start) == 1) {
-		return skip_trivial_phis(get_Phi_pred(start, 0));
-	}
-	return start;
-}
-
 /**
  * Analyzes loop and decides whether it should be unrolled or not and chooses a suitable unroll factor.
  *
@@ -283,7 +258,7 @@ static ir_node* skip_trivial_phis(ir_node *start) {
  * @param fully_unroll pointer to where the decision to fully unroll the loop is stored
  * @return unroll factor to use fot this loop; 0 if loop should not be unrolled
  */
-static unsigned find_suitable_factor(ir_node *const header, unsigned max, bool *fully_unroll) {
+static unsigned find_suitable_factor(ir_loop *const loop, ir_node *const header, unsigned max, bool *fully_unroll) {
 	unsigned const DONT_UNROLL = 0;
 	unsigned const n_outs = get_irn_n_outs(header);
 	unsigned factor = 1;
@@ -294,110 +269,40 @@ static unsigned find_suitable_factor(ir_node *const header, unsigned max, bool *
 			continue;
 
 		if (is_Cmp(node)) {
-
-			ir_relation cmp_rel = get_Cmp_relation(node);
-			if (cmp_rel == ir_relation_less_greater || cmp_rel == ir_relation_equal || cmp_rel & ir_relation_unordered) {
+			ir_node *const cmp_right = get_Cmp_right(node);
+			if (!is_Const(cmp_right) || !mode_is_int(get_irn_mode(cmp_right))) {
 				return DONT_UNROLL;
 			}
-
-			ir_tarval *tv_init = NULL;
-			ir_tarval *tv_step = NULL;
-			ir_tarval *tv_limit = NULL;
-
-			ir_node *header_phi;
-			ir_node *cmp_right = get_Cmp_right(node);
-			if (is_Const(cmp_right) && mode_is_int(get_irn_mode(cmp_right))) {
-				if (!is_Phi(get_Cmp_left(node))) {
-					return DONT_UNROLL;
+			// found Cmp(?, const); the left side must be an induction
+			// variable of this loop
+			ir_node *const cmp_left = get_Cmp_left(node);
+			size_t          n_ivs;
+			loop_iv_t const *ivs = get_loop_ivs(loop, &n_ivs);
+			loop_iv_t const *iv  = NULL;
+			for (size_t j = 0; j < n_ivs; ++j) {
+				if (ivs[j].phi == cmp_left) {
+					iv = &ivs[j];
+					break;
 				}
-				// found Cmp(?, const)
-				header_phi = get_Cmp_left(node);
-				tv_limit = get_Const_tarval(get_Cmp_right(node));
-			} else {
-				return DONT_UNROLL;
 			}
-			int phi_preds = get_Phi_n_preds(header_phi);
-			ir_node *cnt_add = NULL;
-			for (int j = 0; j < phi_preds; j++) {
-				ir_node *phi_pred = get_Phi_pred(header_phi, j);
-				if (is_Const(phi_pred) && mode_is_int(get_irn_mode(cmp_right))) {
-					// found constant init for (possible) counter
-					ir_tarval *const_tv = get_Const_tarval(phi_pred);
-					if (tv_init == NULL || tarval_cmp(tv_init, const_tv) == ir_relation_equal) {
-						tv_init = const_tv;
-						continue;
-					}
-				}
-				phi_pred = skip_trivial_phis(phi_pred);
-				// is_binop() would find more cases, but we currently can only optimize further if we have an Add here
-				if (is_Add(phi_pred) && cnt_add == NULL) {
-					cnt_add = phi_pred;
-					ir_node *left = get_binop_left(phi_pred);
-					ir_node *right = get_binop_right(phi_pred);
-					if (is_Const(right) && is_Phi(left)) {
-						// found Add(phi, const)
-
-						bool found_constant_step = false;
-						// LCSSA construction builds additional phi nodes
-						do {
-							if (left == header_phi) {
-								found_constant_step = true;
-								tv_step = get_Const_tarval(right);
-								break;
-							}
-							left = get_Phi_pred(left, 0);
-
-						} while (is_Phi(left) && (get_Phi_n_preds(left) == 1 || left == header_phi));
-
-						if (found_constant_step) {
-							continue;
-						}
-					}
-					return DONT_UNROLL;
-				}
-				// multiple uses of the same loop counter increment/decrement
-				if (phi_pred == cnt_add) {
-					continue;
-				} else {
-					return DONT_UNROLL;
-				}
-			}
-
-			assert(tv_limit != NULL && tv_init != NULL && tv_step != NULL);
-
-			// normalize: use less or less_equal as relation
-			if (cmp_rel & ir_relation_greater) {
-				ir_tarval *tmp = tv_init;
-				tv_init = tv_limit;
-				tv_limit = tmp;
-				tv_step = tarval_neg(tv_step);
-				cmp_rel = get_inversed_relation(cmp_rel);
-			}
-
-			ir_tarval *tv_interval = tarval_sub(tv_limit, tv_init);
-			if (tarval_is_negative(tv_interval) || tarval_is_negative(tv_step)) {
+			if (iv == NULL || iv->init == NULL) {
 				return DONT_UNROLL;
 			}
 
-			ir_tarval *tv_one = new_tarval_from_long(1, get_tarval_mode(tv_interval));
-			// normalize: use less_equal as relation
-			if (!(cmp_rel & ir_relation_equal)) {
-				// interval -= 1
-				tarval_sub(tv_interval, tv_one);
+			ir_tarval *const tv_loop_count = get_iv_trip_count(iv,
+				get_Cmp_relation(node), get_Const_tarval(cmp_right));
+			if (tv_loop_count == NULL) {
+				return DONT_UNROLL;
 			}
-
-			assert(!tarval_is_null(tv_step));
-			// calculate loop iterations; add one iteration to count the first iteration
-			ir_tarval *tv_loop_count = (tarval_add(tarval_div(tv_interval, tv_step), tv_one));
 			long loop_count = get_tarval_long(tv_loop_count);
 			if (loop_count <= 0) {
 				return DONT_UNROLL;
 			}
 
 #ifdef DEBUG_libfirm
-			long limit = get_tarval_long(tv_limit);
-			long step = get_tarval_long(tv_step);
-			long init = get_tarval_long(tv_init);
+			long limit = get_tarval_long(get_Const_tarval(cmp_right));
+			long step = get_tarval_long(iv->step);
+			long init = get_tarval_long(iv->init);
 			DB((dbg, LEVEL_3 , "\tinit: %ld, step: %ld, limit: %ld, loop count: %ld\n", init, step, limit, loop_count));
 #endif
 			factor = find_optimal_factor((unsigned long) loop_count, max);
@@ -547,6 +452,28 @@ static void rewire_fully_unrolled(ir_loop *const loop, ir_node *header) {
 
 static unsigned n_loops_unrolled = 0;
 
+/**
+ * Execution frequency of the loop header relative to the graph entry,
+ * i.e. roughly the iteration count per invocation.  Prefers profile
+ * data when loaded and falls back to the static estimation.  Returns a
+ * negative value if no usable information is available.
+ */
+static double loop_relative_frequency(ir_node *const header)
+{
+	ir_graph *const irg   = get_irn_irg(header);
+	ir_node  *const start = get_irg_start_block(irg);
+	if (ir_profile_is_loaded()) {
+		uint32_t const entry_count = ir_profile_get_block_execcount(start);
+		if (entry_count > 0)
+			return (double)ir_profile_get_block_execcount(header)
+			       / (double)entry_count;
+	}
+	double const entry_freq = get_block_execfreq(start);
+	if (entry_freq <= 0.0)
+		return -1.0;
+	return get_block_execfreq(header) / entry_freq;
+}
+
 static bool unroll_loop(ir_loop *const loop, unsigned factor)
 {
 	ir_node *const header = get_loop_header(loop);
@@ -557,8 +484,18 @@ static bool unroll_loop(ir_loop *const loop, unsigned factor)
 
 	DB((dbg, LEVEL_4, "\tidentified loop header %+F\n", header));
 
+	double const rel_freq = loop_relative_frequency(header);
+	if (rel_freq >= 0.0) {
+		if (rel_freq < UNROLL_COLD_THRESHOLD) {
+			DB((dbg, LEVEL_3, "\t%+F is cold (%f), skip\n", loop, rel_freq));
+			return false;
+		}
+		if (rel_freq >= UNROLL_HOT_THRESHOLD)
+			factor = MAX(factor, UNROLL_HOT_MAX_FACTOR);
+	}
+
 	bool fully_unroll = false;
-	factor = find_suitable_factor(header, factor, &fully_unroll);
+	factor = find_suitable_factor(loop, header, factor, &fully_unroll);
 	if (factor < 1 || (factor == 1 && !fully_unroll)) {
 		return false;
 	}
@@ -624,50 +561,81 @@ static size_t count_nodes(ir_loop *const loop)
 	return n_nodes;
 }
 
-static bool reanalyze = false;
+typedef struct unroll_env_t {
+	unsigned factor;
+	unsigned maxsize;
+} unroll_env_t;
 
-static bool duplicate_innermost_loops(ir_loop *const loop, unsigned const factor, unsigned const maxsize, bool const container)
+static void unroll_prepare(ir_graph *const irg, void *const env)
 {
-	bool innermost  = true;
-	bool unrolled = true;
+	(void)env;
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+	/* (re)compute block frequencies, the CFG changes in every sweep */
+	ir_estimate_execfreq(irg);
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
+}
+
+static bool unroll_run_on_loop(ir_graph *const irg, ir_loop *const loop,
+                               void *const env)
+{
+	unroll_env_t const *const unroll_env = (unroll_env_t const*)env;
+
+	/* Only innermost loops are unrolled; a loop whose inner loops all
+	 * vanish gets its chance in the next sweep. */
 	size_t const n_elements = get_loop_n_elements(loop);
 	for (size_t i = 0; i < n_elements; ++i) {
-		loop_element const element = get_loop_element(loop, i);
-		if (*element.kind == k_ir_loop) {
-			unrolled = unrolled && duplicate_innermost_loops(element.son, factor, maxsize, false);
-			innermost = false;
-		}
+		if (*get_loop_element(loop, i).kind == k_ir_loop)
+			return false;
 	}
-	// all loops directly in this loop were unrolled. reanalyze later to possibly unroll this loop as well
-	if (unrolled && !innermost && !container) {
-		reanalyze = true;
+
+	DB((dbg, LEVEL_3, "inspect %+F\n", loop));
+	if (count_nodes(loop) > unroll_env->maxsize) {
+		DB((dbg, LEVEL_3, "\ttoo many nodes in %+F, skip\n", loop));
+		return false;
 	}
-	// found innermost loop, try to unroll
-	if (innermost && !container) {
-		DB((dbg, LEVEL_3, "inspect %+F\n", loop));
-		if (count_nodes(loop) <= maxsize) {
-			return unroll_loop(loop, factor);
-		} else {
-			DB((dbg, LEVEL_3, "\ttoo many nodes in %+F, skip\n", loop));
-		}
+	unsigned const before       = n_loops_unrolled;
+	bool     const fully_gone   = unroll_loop(loop, unroll_env->factor);
+	/* A fully unrolled loop may turn its parent into an innermost loop,
+	 * so ask for another sweep.  A partial unroll keeps the tree
+	 * structure; just mark the analyses stale instead of paying for a
+	 * rebuild. */
+	if (fully_gone)
+		return true;
+	if (n_loops_unrolled != before) {
+		clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+		                   | IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
 	}
 	return false;
 }
 
+static void unroll_finish(ir_graph *const irg, void *const env)
+{
+	(void)env;
+	/* drop the induction variable caches, the next sweep sees a
+	 * different tree */
+	free_loop_ivs(get_irg_loop(irg));
+	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+}
+
 void unroll_loops(ir_graph *const irg, unsigned factor, unsigned maxsize)
 {
 	FIRM_DBG_REGISTER(dbg, "firm.opt.loop-unrolling");
 	n_loops_unrolled = 0;
 	assure_lcssa(irg);
 	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS | IR_GRAPH_PROPERTY_NO_BADS);
-	do {
-		reanalyze = false;
-		assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO | IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
-		ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
-		duplicate_innermost_loops(get_irg_loop(irg), factor, maxsize, true);
-		free_loop_information(irg);
-		ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
-		clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE | IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
-	} while (reanalyze);
+	/* the out arrays are iterated while the loop bodies are duplicated and
+	 * rewired; freeze them as a snapshot instead of having the incremental
+	 * maintenance rewrite them under the iteration */
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
+
+	unroll_env_t env = { .factor = factor, .maxsize = maxsize };
+	loop_pass_t const pass = {
+		.name        = "loop-unrolling",
+		.prepare     = unroll_prepare,
+		.run_on_loop = unroll_run_on_loop,
+		.finish      = unroll_finish,
+		.env         = &env,
+	};
+	run_loop_passes(irg, &pass, 1);
 	DB((dbg, LEVEL_1, "%+F: %d loops unrolled\n", irg, n_loops_unrolled));
 }
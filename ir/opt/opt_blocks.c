@@ -18,6 +18,7 @@
 #include "irgraph_t.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
+#include "irnodeset.h"
 #include "iropt_t.h"
 #include "iroptimize.h"
 #include "set.h"
@@ -368,66 +369,74 @@ static void add_phi(block_t *block, ir_node *phi, environment_t *env)
 }
 
 /**
- * Creates an opcode from a node.
+ * Fills an opcode key for a node.
+ *
+ * @param irn       the node
+ * @param is_input  true if the node is a live input of its block
+ * @param key       the key to fill
  */
-static opcode_key_t *opcode(const node_t *node, environment_t *env)
+static void build_opcode_key(ir_node *irn, bool is_input, opcode_key_t *key)
 {
-	opcode_key_t key, *entry;
-	ir_node      *irn = node->node;
-
-	if (node->is_input) {
+	if (is_input) {
 		/* Node: as Block nodes are never propagated, it is safe to
 		   use its code for "input" node */
-		key.code   = iro_Block;
-		key.arity  = 0;
+		key->code   = iro_Block;
+		key->arity  = 0;
 	} else {
-		key.code   = get_irn_opcode(irn);
-		key.arity  = get_irn_arity(irn);
+		key->code   = get_irn_opcode(irn);
+		key->arity  = get_irn_arity(irn);
 	}
-	key.mode   = get_irn_mode(node->node);
-	key.u.proj = 0;
-	key.u.addr = NULL;
+	key->mode   = get_irn_mode(irn);
+	key->u.proj = 0;
+	key->u.addr = NULL;
 
-	switch (key.code) {
+	switch (key->code) {
 	case iro_Address:
-		key.u.ent = get_Address_entity(irn);
+		key->u.ent = get_Address_entity(irn);
 		break;
 	case iro_Align:
-		key.u.type = get_Align_type(irn);
+		key->u.type = get_Align_type(irn);
 		break;
 	case iro_Offset:
-		key.u.ent = get_Offset_entity(irn);
+		key->u.ent = get_Offset_entity(irn);
 		break;
 	case iro_Proj:
-		key.u.proj = get_Proj_num(irn);
+		key->u.proj = get_Proj_num(irn);
 		break;
 	case iro_Sel:
-		key.u.type = get_Sel_type(irn);
+		key->u.type = get_Sel_type(irn);
 		break;
 	case iro_Member:
-		key.u.ent = get_Member_entity(irn);
+		key->u.ent = get_Member_entity(irn);
 		break;
 	case iro_Const:
-		key.u.tv  = get_Const_tarval(irn);
+		key->u.tv  = get_Const_tarval(irn);
 		break;
 	case iro_Load:
-		key.mode = get_Load_mode(irn);
+		key->mode = get_Load_mode(irn);
 		break;
 	case iro_Div:
-		key.u.intVal = get_Div_no_remainder(irn);
+		key->u.intVal = get_Div_no_remainder(irn);
 		break;
 	case iro_Builtin:
-		key.u.intVal = get_Builtin_kind(irn);
+		key->u.intVal = get_Builtin_kind(irn);
 		break;
 	case iro_Size:
-		key.u.type = get_Size_type(irn);
+		key->u.type = get_Size_type(irn);
 		break;
 	default:
 		break;
 	}
+}
 
-	entry = set_insert(opcode_key_t, env->opcode2id_map, &key, sizeof(key), opcode_hash(&key));
-	return entry;
+/**
+ * Creates an opcode from a node.
+ */
+static opcode_key_t *opcode(const node_t *node, environment_t *env)
+{
+	opcode_key_t key;
+	build_opcode_key(node->node, node->is_input != 0, &key);
+	return set_insert(opcode_key_t, env->opcode2id_map, &key, sizeof(key), opcode_hash(&key));
 }
 
 /**
@@ -611,6 +620,107 @@ static void propagate(environment_t *env)
 	}
 }
 
+/**
+ * Accumulates a structural fingerprint of the cone of @p irn inside
+ * @p block into @p hash.
+ *
+ * The walk mirrors what propagate_blocks() will examine: opcode keys of
+ * the block-local nodes, inputs reduced to their mode and shared
+ * sub-cones visited once.  Congruent blocks therefore always end up with
+ * equal fingerprints; differing fingerprints prove that the refinement
+ * would split the blocks eventually.
+ *
+ * @param block    the block being fingerprinted
+ * @param irn      current root of the cone
+ * @param hash     the hash accumulated so far
+ * @param visited  set of block-local nodes already hashed
+ */
+static unsigned fingerprint_walk(ir_node *block, ir_node *irn, unsigned hash,
+                                 ir_nodeset_t *visited)
+{
+	/* a shared sub-cone enters the wait queues only once */
+	if (!ir_nodeset_insert(visited, irn))
+		return hash * 31 + 7;
+
+	opcode_key_t key;
+	build_opcode_key(irn, false, &key);
+	hash = hash * 31 + opcode_hash(&key);
+
+	foreach_irn_in(irn, i, pred) {
+		if (get_nodes_block(skip_Proj(pred)) == block) {
+			hash = fingerprint_walk(block, pred, hash, visited);
+		} else {
+			/* mirrors propagate_blocks(): only the Address input of a
+			   direct Call keeps its identity, everything else is a
+			   generic live input */
+			build_opcode_key(pred, is_input_node(pred, irn, i) != 0, &key);
+			hash = hash * 31 + opcode_hash(&key);
+		}
+	}
+	return hash;
+}
+
+/**
+ * Split a partition by the fingerprints of its blocks, so only blocks
+ * that can possibly be congruent enter the node-by-node refinement.
+ *
+ * @param part  the partition
+ * @param env   the environment
+ */
+static void split_by_fingerprint(partition_t *part, environment_t *env)
+{
+	listmap_t       map;
+	listmap_entry_t *iter;
+
+	DB((dbg, LEVEL_2, " Fingerprinting part%u\n", part->nr));
+
+	/* Let map be an empty mapping from fingerprints to (local) list of blocks. */
+	listmap_init(&map);
+	list_for_each_entry_safe(block_t, bl, next, &part->blocks, block_list) {
+		ir_nodeset_t visited;
+		ir_nodeset_init(&visited);
+
+		unsigned hash = 0;
+		list_for_each_entry(node_t, node, &bl->nodes, node_list) {
+			hash = fingerprint_walk(bl->block, node->node, hash, &visited);
+		}
+		/* blocks of different cone size can never be congruent, so let
+		   the size split them right away */
+		hash = hash * 31 + (unsigned)ir_nodeset_size(&visited);
+		ir_nodeset_destroy(&visited);
+
+		/* Add bl to map[fingerprint(bl)]. */
+		listmap_entry_t *entry = listmap_find(&map, (void*)(uintptr_t)hash);
+		bl->next    = entry->list;
+		entry->list = bl;
+	}
+
+	/* for all sets S except one in the range of map do */
+	for (iter = map.values; iter != NULL; iter = iter->next) {
+		if (iter->next == NULL) {
+			/* this is the last entry, ignore */
+			break;
+		}
+
+		/* Add SPLIT( X, S ) to P. */
+		split(part, iter->list, env);
+	}
+	listmap_term(&map);
+}
+
+/**
+ * Split all partitions by block fingerprints.
+ *
+ * @param env  the environment
+ */
+static void split_by_fingerprints(environment_t *env)
+{
+	list_for_each_entry_safe(partition_t, part, next, &env->partitions, part_list) {
+		if (part->n_blocks >= 2)
+			split_by_fingerprint(part, env);
+	}
+}
+
 /**
  * Map a block to the phi[block->input] live-trough.
  */
@@ -1211,6 +1321,10 @@ void shape_blocks(ir_graph *irg)
 	partition_for_end_block(get_irg_end_block(irg), &env);
 #endif
 
+	/* presort the partitions by block fingerprints: only blocks that can
+	 * possibly be congruent enter the quadratic refinement below */
+	split_by_fingerprints(&env);
+
 	propagate_live_troughs(&env);
 	while (! list_empty(&env.partitions))
 		propagate(&env);
@@ -10,9 +10,11 @@
  */
 #include "analyze_irg_args.h"
 #include "array.h"
+#include "callgraph.h"
 #include "cgana.h"
 #include "debug.h"
 #include "entity_t.h"
+#include "firm_thread.h"
 #include "irbackedge_t.h"
 #include "ircons_t.h"
 #include "iredges_t.h"
@@ -36,6 +38,7 @@
 #include "opt_init.h"
 #include "pmap.h"
 #include "pqueue.h"
+#include "util.h"
 #include "xmalloc.h"
 #include <assert.h>
 #include <limits.h>
@@ -701,6 +704,114 @@ static bool is_nop(const ir_node *node)
 	}
 }
 
+/**
+ * Cached per-graph cost summary for the inliner.  Counting callee nodes
+ * is the biggest cost of inline_functions() and the result only changes
+ * when the graph does, so the summary is kept on the ir_graph and
+ * revalidated via the node index high-water mark.  Everything lives in
+ * one malloc block so free_graph() can release it without knowing the
+ * layout.
+ */
+typedef struct inline_summary_t {
+	unsigned last_idx;     /**< irg last index when the summary was taken */
+	unsigned n_nodes;      /**< number of nodes except no-ops */
+	unsigned n_blocks;     /**< number of blocks without the end block */
+	unsigned n_call_nodes; /**< number of Call nodes */
+	bool     recursive;    /**< the graph calls itself */
+	size_t   n_calls;      /**< number of calls with statically known callee */
+	ir_node *calls[];      /**< those Call nodes */
+} inline_summary_t;
+
+typedef struct summary_env_t {
+	unsigned  n_nodes;
+	unsigned  n_blocks;
+	unsigned  n_call_nodes;
+	bool      recursive;
+	ir_node **calls;       /**< flexible array of inlinable Call nodes */
+} summary_env_t;
+
+/**
+ * post-walker: count the nodes of a graph for the inline summary and
+ * remember all calls with a statically known callee.
+ */
+static void summarize_node(ir_node *node, void *ctx)
+{
+	summary_env_t *env = (summary_env_t*)ctx;
+	if (is_nop(node))
+		return;
+	if (is_Block(node)) {
+		++env->n_blocks;
+		return;
+	}
+	++env->n_nodes;
+
+	if (!is_Call(node))
+		return;
+	++env->n_call_nodes;
+
+	ir_entity *callee_ent = get_Call_callee(node);
+	if (callee_ent == NULL)
+		return;
+	ir_graph *callee = get_entity_linktime_irg(callee_ent);
+	if (callee == NULL)
+		return;
+	if (callee == get_irn_irg(node))
+		env->recursive = true;
+	ARR_APP1(ir_node*, env->calls, node);
+}
+
+static bool inline_summary_is_valid(const ir_graph *irg,
+                                    const inline_summary_t *summary)
+{
+	if (summary == NULL || summary->last_idx != get_irg_last_idx(irg))
+		return false;
+	/* exchange() reuses node memory in place, so a remembered Call can
+	 * turn into an Id without bumping the index high-water mark */
+	for (size_t i = 0; i < summary->n_calls; ++i) {
+		if (!is_Call(summary->calls[i]))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Returns the (cached) inline cost summary of a graph, recomputing it
+ * if the graph changed since it was taken.  Reads only the given graph,
+ * so summaries of different graphs may be computed concurrently.
+ */
+static inline_summary_t *get_inline_summary(ir_graph *irg)
+{
+	inline_summary_t *summary = (inline_summary_t*)irg->inline_summary;
+	if (inline_summary_is_valid(irg, summary))
+		return summary;
+
+	summary_env_t env = {
+		.n_blocks = -1, /* do not count the end block */
+		.calls    = NEW_ARR_F(ir_node*, 0),
+	};
+	irg_walk_graph(irg, NULL, summarize_node, &env);
+
+	size_t const n_calls = ARR_LEN(env.calls);
+	free(irg->inline_summary);
+	summary = (inline_summary_t*)xmalloc(sizeof(*summary)
+	                                     + n_calls * sizeof(summary->calls[0]));
+	summary->last_idx     = get_irg_last_idx(irg);
+	summary->n_nodes      = env.n_nodes;
+	summary->n_blocks     = env.n_blocks;
+	summary->n_call_nodes = env.n_call_nodes;
+	summary->recursive    = env.recursive;
+	summary->n_calls      = n_calls;
+	MEMCPY(summary->calls, env.calls, n_calls);
+	DEL_ARR_F(env.calls);
+	irg->inline_summary = summary;
+	return summary;
+}
+
+static void warm_inline_summary(ir_graph *irg)
+{
+	(void)get_inline_summary(irg);
+}
+
 /**
  * post-walker: collect all calls in the inline-environment
  * of a graph and sum some statistics.
@@ -1006,7 +1117,10 @@ static ir_graph **create_irg_list(void)
 	callgraph_walk(NULL, callgraph_walker, &env);
 	assert(n_irgs == env.last_irg);
 
-	free_callgraph();
+	/* The callgraph is kept alive: inline_into() patches it incrementally
+	 * for every transformed call site, so iterated consumers do not need
+	 * a full recomputation. inline_functions() frees it before the
+	 * cleanup optimizations run. */
 
 	return env.irgs;
 }
@@ -1190,6 +1304,7 @@ static void inline_into(ir_graph *irg, unsigned maxsize,
 
 		/* remove it from the caller list */
 		list_del(&curr_call->list);
+		callgraph_note_removed_call(irg, curr_call->call, curr_call->callee);
 
 		/* callee was inline. Append its call list. */
 		env->got_inline = 1;
@@ -1220,6 +1335,7 @@ static void inline_into(ir_graph *irg, unsigned maxsize,
 			call_entry *new_entry
 				= duplicate_call_entry(centry, new_call, loop_depth);
 			list_add_tail(&new_entry->list, &env->calls);
+			callgraph_note_new_call(irg, new_call, centry->callee);
 			maybe_push_call(pqueue, new_entry, inline_threshold);
 		}
 		ir_free_resources(callee, IR_RESOURCE_IRN_LINK);
@@ -1252,17 +1368,49 @@ void inline_functions(unsigned maxsize, int inline_threshold,
 	for (size_t i = 0; i < n_irgs; ++i)
 		set_irg_link(irgs[i], alloc_inline_irg_env());
 
-	/* Precompute information in temporary data structure. */
-	wenv_t wenv;
-	wenv.ignore_callers = false;
+	/* Precompute information in temporary data structure.  The expensive
+	 * node counting comes from the cached per-graph summaries; warming
+	 * them only reads the respective graph, so all graphs are handled in
+	 * parallel.  The per-run call entries and caller counts link graphs
+	 * together and are rebuilt serially below. */
+	run_irg_pipeline_parallel(warm_inline_summary,
+	                          firm_parallel_default_threads());
+
 	for (size_t i = 0; i < n_irgs; ++i) {
 		ir_graph *irg = irgs[i];
 
 		free_callee_info(irg);
-
-		wenv.x = (inline_irg_env*)get_irg_link(irg);
 		assure_loopinfo(irg);
-		irg_walk_graph(irg, NULL, collect_calls2, &wenv);
+
+		inline_irg_env         *env     = (inline_irg_env*)get_irg_link(irg);
+		inline_summary_t const *summary = get_inline_summary(irg);
+		env->n_nodes           = summary->n_nodes;
+		env->n_nodes_orig      = summary->n_nodes;
+		env->n_blocks          = summary->n_blocks;
+		env->n_call_nodes      = summary->n_call_nodes;
+		env->n_call_nodes_orig = summary->n_call_nodes;
+		env->recursive         = summary->recursive;
+
+		for (size_t c = 0; c < summary->n_calls; ++c) {
+			ir_node   *call       = summary->calls[c];
+			ir_entity *callee_ent = get_Call_callee(call);
+			ir_graph  *callee     = get_entity_linktime_irg(callee_ent);
+			if (callee == NULL) {
+				/* the callee graph was freed since the summary was taken */
+				continue;
+			}
+			inline_irg_env *callee_env = (inline_irg_env*)get_irg_link(callee);
+			++callee_env->n_callers;
+			++callee_env->n_callers_orig;
+
+			call_entry *entry = OALLOC(&temp_obst, call_entry);
+			entry->call       = call;
+			entry->callee     = callee;
+			entry->loop_depth = get_irn_loop(get_nodes_block(call))->depth;
+			entry->benefice   = 0;
+			entry->all_const  = false;
+			list_add_tail(&entry->list, &env->calls);
+		}
 	}
 
 	/* -- and now inline. -- */
@@ -1271,6 +1419,10 @@ void inline_functions(unsigned maxsize, int inline_threshold,
 		inline_into(irg, maxsize, inline_threshold, copied_graphs);
 	}
 
+	/* free the callgraph before the cleanup optimizations below remove
+	 * Call nodes its call lists still point to */
+	free_callgraph();
+
 	for (size_t i = 0; i < n_irgs; ++i) {
 		ir_graph *irg = irgs[i];
 
@@ -18,7 +18,7 @@
 #include "irgmod.h"
 #include "irgopt.h"
 #include "irgwalk.h"
-#include "irmemory.h"
+#include "irmemory_t.h"
 #include "irnode_t.h"
 #include "irnodehashmap.h"
 #include "iropt.h"
@@ -1238,9 +1238,8 @@ static int backward_antic(block_t *bl)
 	}
 
 	MEMCPY(bl->id_2_memop_antic, env.curr_id_2_memop, env.rbs_size);
-	if (! rbitsets_equal(bl->anticL_in, env.curr_set, env.rbs_size)) {
+	if (rbitset_copy_changed(bl->anticL_in, env.curr_set, env.rbs_size)) {
 		/* changed */
-		rbitset_copy(bl->anticL_in, env.curr_set, env.rbs_size);
 		dump_curr(bl, "AnticL_in*");
 		return 1;
 	}
@@ -1712,9 +1711,8 @@ static int insert_Load(block_t *bl)
 	/* always update the map after gen/kill, as values might have been changed due to RAR/WAR/WAW */
 	MEMCPY(bl->id_2_memop_avail, env.curr_id_2_memop, env.rbs_size);
 
-	if (!rbitsets_equal(bl->avail_out, env.curr_set, env.rbs_size)) {
+	if (rbitset_copy_changed(bl->avail_out, env.curr_set, env.rbs_size)) {
 		/* the avail set has changed */
-		rbitset_copy(bl->avail_out, env.curr_set, env.rbs_size);
 		dump_curr(bl, "Avail_out*");
 		return 1;
 	}
@@ -1763,6 +1761,10 @@ void opt_ldst(ir_graph *irg)
 		| IR_GRAPH_PROPERTY_CONSISTENT_OUTS
 		| IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
 		| IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+	/* this pass transplants and rebuilds out arrays by hand while the
+	 * memory users are rerouted; freeze them as a snapshot so the
+	 * incremental maintenance keeps its hands off */
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
 
 	const ir_disambiguator_options opts =
 		get_irg_memory_disambiguator_options(irg);
@@ -1773,6 +1775,9 @@ void opt_ldst(ir_graph *irg)
 	obstack_init(&env.obst);
 	ir_nodehashmap_init(&env.adr_map);
 
+	/* memoize alias queries while the memops are collected and moved */
+	ir_alias_cache_begin(irg);
+
 	env.forward       = NULL;
 	env.backward      = NULL;
 	env.curr_adr_id   = 0;
@@ -1876,6 +1881,7 @@ no_changes:
 		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_ALL);
 	}
 
+	ir_alias_cache_end(irg);
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_BLOCK_MARK);
 	ir_nodehashmap_destroy(&env.adr_map);
 	obstack_free(&env.obst, NULL);
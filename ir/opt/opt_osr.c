@@ -28,6 +28,7 @@
 #include "iroptimize.h"
 #include "irouts.h"
 #include "irtools.h"
+#include "loop_iv.h"
 #include "obst.h"
 #include "panic.h"
 #include "pdeq.h"
@@ -469,43 +470,42 @@ static bool is_counter_iv(ir_node *iv, iv_env *env)
 		/* already analyzed */
 		return pscc->code != iro_Bad;
 	}
-
-	ir_node   *have_init = NULL;
-	ir_node   *have_incr = NULL;
-	ir_opcode  code      = iro_Bad;
 	pscc->code = iro_Bad;
+
+	/* the cycle must consist of Phis and a single increment; the shared
+	 * induction variable analysis checks the rest */
+	ir_node *binop = NULL;
 	for (ir_node *irn = pscc->head; irn != NULL; irn = e->next) {
 		if (is_Add(irn) || is_Sub(irn)) {
-			if (have_incr != NULL)
+			if (binop != NULL)
 				return false;
-
-			have_incr = get_binop_right(irn);
-			if (!is_Const(have_incr)) {
-				return false;
-			}
-			code = get_irn_opcode(irn);
-		} else if (is_Phi(irn)) {
-			for (int i = get_Phi_n_preds(irn) - 1; i >= 0; --i) {
-				ir_node    *pred = get_Phi_pred(irn, i);
-				node_entry *ne   = get_irn_ne(pred, env);
-
-				if (ne->header == e->header)
-					continue;
-				if (have_init != NULL)
-					return false;
-				have_init = pred;
-				if (!is_Const(pred))
-					return false;
-			}
-		} else {
+			binop = irn;
+		} else if (!is_Phi(irn)) {
 			return false;
 		}
 		e = get_irn_ne(irn, env);
 	}
-	pscc->init = get_Const_tarval(have_init);
-	pscc->incr = get_Const_tarval(have_incr);
-	pscc->code = code;
-	return code != iro_Bad;
+	if (binop == NULL)
+		return false;
+
+	/* one of the Phis carries the recurrence */
+	loop_iv_t liv;
+	bool      found = false;
+	e = get_irn_ne(iv, env);
+	for (ir_node *irn = pscc->head; irn != NULL; irn = e->next) {
+		if (is_Phi(irn) && get_phi_iv(irn, &liv) && liv.incr == binop) {
+			found = true;
+			break;
+		}
+		e = get_irn_ne(irn, env);
+	}
+	if (!found || liv.init == NULL)
+		return false;
+
+	pscc->init = liv.init;
+	pscc->incr = is_Sub(binop) ? tarval_neg(liv.step) : liv.step;
+	pscc->code = get_irn_opcode(binop);
+	return true;
 }
 
 /**
@@ -17,11 +17,12 @@
 #include "irgopt.h"
 #include "irgraph_t.h"
 #include "irgwalk.h"
-#include "irmemory.h"
+#include "irmemory_t.h"
 #include "irnode_t.h"
 #include "irnodeset.h"
 #include "iroptimize.h"
 #include "obst.h"
+#include "obstack_pool.h"
 #include "type_t.h"
 
 typedef struct parallelize_info
@@ -483,22 +484,25 @@ static void simplify_Sync(ir_node *irn, void *e)
 
 static void eliminate_sync_edges(ir_graph *irg)
 {
-	struct obstack obst;
-	obstack_init(&obst);
+	struct obstack *const obst = firm_temp_obst_grab();
 
-	irg_walk_graph(irg, prepare_links_Sync, NULL, &obst);
-	irg_walk_graph(irg, simplify_Sync, NULL, &obst);
+	irg_walk_graph(irg, prepare_links_Sync, NULL, obst);
+	irg_walk_graph(irg, simplify_Sync, NULL, obst);
 
-	obstack_free(&obst, NULL);
+	firm_temp_obst_release(obst);
 }
 
 void opt_parallelize_mem(ir_graph *irg)
 {
 	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
 	                           | IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+	/* memoize alias queries, the walk asks about the same address pairs
+	 * for every memory operation hanging off a chain */
+	ir_alias_cache_begin(irg);
 	irg_walk_blkwise_dom_top_down(irg, NULL, walker, NULL);
 	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
 	eliminate_sync_edges(irg);
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+	ir_alias_cache_end(irg);
 	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_CONTROL_FLOW);
 }
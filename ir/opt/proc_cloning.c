@@ -18,7 +18,9 @@
  */
 #include "analyze_irg_args.h"
 #include "array.h"
+#include "callgraph.h"
 #include "debug.h"
+#include "execfreq.h"
 #include "hashptr.h"
 #include "ircons.h"
 #include "irgmod.h"
@@ -333,6 +335,9 @@ static ir_node *get_irg_arg(ir_graph *irg, size_t pos)
 {
 	/* Call algorithm that computes the out edges */
 	assure_irg_outs(irg);
+	/* freeze the out arrays: the argument's uses are rewired while the
+	 * caller still walks them */
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
 
 	/* Search the argument with the number pos.*/
 	ir_node *arg      = NULL;
@@ -463,6 +468,9 @@ static ir_entity *clone_method(const quadruple_t *q)
 	/* We need now a new ir_graph for our clone method. */
 	create_clone_proc_irg(new_entity, q);
 
+	/* keep an existing callgraph consistent */
+	callgraph_note_new_irg(get_entity_linktime_irg(new_entity));
+
 	return new_entity;
 }
 
@@ -504,24 +512,39 @@ static ir_node *new_cl_Call(ir_node *call, ir_entity *new_entity, size_t pos)
 static void exchange_calls(quadruple_t *q, ir_entity *cloned_ent)
 {
 	/* We iterate the list of the "call".*/
-	size_t const pos = q->pos;
+	size_t          const pos       = q->pos;
+	ir_graph       *const old_irg   = get_entity_linktime_irg(q->ent);
+	ir_graph       *const clone_irg = get_entity_linktime_irg(cloned_ent);
 	for (size_t i = 0; i < ARR_LEN(q->calls); ++i) {
 		ir_node *const call = q->calls[i];
 		/* A clone exist and the copy of "call" in this
 		 * clone graph must be exchanged with new one. */
 		ir_node *const new_call = new_cl_Call(call, cloned_ent, pos);
 		exchange(call, new_call);
+
+		/* keep an existing callgraph consistent */
+		ir_graph *const caller = get_irn_irg(new_call);
+		callgraph_note_removed_call(caller, call, old_irg);
+		callgraph_note_new_call(caller, new_call, clone_irg);
 	}
 }
 
 /**
  * The weight formula:
  * We save one instruction in every caller and param_weight instructions
- * in the callee.
+ * in the callee, for every execution of a rewritten call. Weight the
+ * call sites by their estimated execution frequency instead of treating
+ * all of them alike, so a call in a hot loop outranks many cold ones.
  */
 static float calculate_weight(const entry_t *entry)
 {
-	return ARR_LEN(entry->q.calls) *
+	float freq = 0.0F;
+	for (size_t i = 0; i < ARR_LEN(entry->q.calls); ++i) {
+		/* might be exchanged, so skip Id nodes here. */
+		ir_node *const call = skip_Id(entry->q.calls[i]);
+		freq += (float)get_block_execfreq(get_nodes_block(call));
+	}
+	return freq *
 		(float)(get_method_param_weight(entry->q.ent, entry->q.pos) + 1);
 }
 
@@ -587,6 +610,24 @@ restart:
 	}
 }
 
+/** Cloning may grow the program by at most this fraction of its size. */
+#define CLONE_BUDGET_PERCENT 25
+
+static void count_nodes_walker(ir_node *node, void *env)
+{
+	(void)node;
+	++*(size_t*)env;
+}
+
+/** Counts the nodes of a graph, used as the code size measure for the
+ * cloning budget. */
+static size_t count_irg_nodes(ir_graph *irg)
+{
+	size_t count = 0;
+	irg_walk_graph(irg, count_nodes_walker, NULL, &count);
+	return count;
+}
+
 void proc_cloning(float threshold)
 {
 	DEBUG_ONLY(firm_dbg_module_t *dbg;)
@@ -599,6 +640,15 @@ void proc_cloning(float threshold)
 	hmap.map        = NULL;
 	hmap.heavy_uses = NULL;
 
+	/* the weights are based on block frequencies, estimate them for all
+	 * graphs first; along the way size up the program for the budget */
+	size_t budget = 0;
+	foreach_irp_irg(i, irg) {
+		ir_estimate_execfreq(irg);
+		budget += count_irg_nodes(irg);
+	}
+	budget = budget * CLONE_BUDGET_PERCENT / 100;
+
 	/* initially fill our map by visiting all irgs */
 	all_irg_walk(collect_irg_calls, NULL, &hmap);
 
@@ -646,10 +696,28 @@ void proc_cloning(float threshold)
 #endif
 		entry_t *const entry = hmap.heavy_uses;
 		if (entry) {
-			quadruple_t *const qp  = &entry->q;
-			ir_entity   *const ent = clone_method(qp);
+			quadruple_t *const qp = &entry->q;
+
+			/* stay within the global growth budget: a clone costs about
+			 * as many nodes as the original graph. Oversized candidates
+			 * are dropped, lighter but smaller ones may still fit. */
+			size_t const size
+				= count_irg_nodes(get_entity_linktime_irg(qp->ent));
+			if (size > budget) {
+				DB((dbg, LEVEL_1, "Skipped <%+F, %zu, %T>, size %zu exceeds budget\n",
+				    qp->ent, qp->pos, qp->tv, size));
+				hmap.heavy_uses = entry->next;
+				kill_entry(entry);
+				continue;
+			}
+			budget -= size;
+
+			ir_entity *const ent = clone_method(qp);
 			DB((dbg, LEVEL_1, "Cloned <%+F, %zu, %T> info %+F\n", qp->ent, qp->pos, qp->tv, ent));
 
+			/* weights of calls inside the clone need frequencies too */
+			ir_estimate_execfreq(get_entity_linktime_irg(ent));
+
 			hmap.heavy_uses = entry->next;
 
 			/* We must exchange the copies of this call in all clones too.*/
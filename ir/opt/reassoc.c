@@ -10,6 +10,7 @@
  */
 #include "reassoc_t.h"
 
+#include "array.h"
 #include "debug.h"
 #include "ircons_t.h"
 #include "iredges_t.h"
@@ -30,6 +31,7 @@
 #include "panic.h"
 #include "pdeq.h"
 #include "unionfind.h"
+#include "util.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
@@ -1666,6 +1668,46 @@ static multi_op *get_user(multi_op *o)
 	return user;
 }
 
+/**
+ * Returns the rank of an operand: the loop depth of its block.  Folding
+ * operands of low rank first keeps the partial results loop-invariant as
+ * long as possible, so they can be hoisted and shared between chains.
+ */
+static unsigned get_operand_rank(const ir_node *node)
+{
+	ir_loop *loop = get_irn_loop(get_nodes_block(node));
+	return loop != NULL ? get_loop_depth(loop) : 0;
+}
+
+/**
+ * Compares two operands by rank.  Ties are broken by the node index, so
+ * rebuilt chains are deterministic and identical subchains CSE.
+ */
+static int cmp_operand_rank(const void *p1, const void *p2)
+{
+	const ir_node *n1 = *(const ir_node *const *)p1;
+	const ir_node *n2 = *(const ir_node *const *)p2;
+	unsigned const r1 = get_operand_rank(n1);
+	unsigned const r2 = get_operand_rank(n2);
+	if (r1 != r2)
+		return QSORT_CMP(r1, r2);
+	return QSORT_CMP(get_irn_idx(n1), get_irn_idx(n2));
+}
+
+/**
+ * Collects the nodes of a pset into a rank-sorted flexible array.
+ * The caller must DEL_ARR_F() the result.
+ */
+static ir_node **rank_sorted_operands(pset *set)
+{
+	ir_node **nodes = NEW_ARR_F(ir_node*, 0);
+	foreach_pset(set, ir_node, node) {
+		ARR_APP1(ir_node*, nodes, node);
+	}
+	QSORT_ARR(nodes, cmp_operand_rank);
+	return nodes;
+}
+
 static ir_node *rebuild_node(multi_op *o, ir_node *curr, ir_node *node)
 {
 	ir_node  *block = get_nodes_block(o->base_node);
@@ -1796,18 +1838,23 @@ static void rebuild(multi_op_env *multi_env)
 					if (curr && is_one) {
 						inner = curr;
 					}
-					foreach_pset(positiv_set, ir_node, node) {
+					ir_node **sorted = rank_sorted_operands(positiv_set);
+					for (size_t i = 0, n = ARR_LEN(sorted); i < n; ++i) {
+						ir_node *node = sorted[i];
 						if (!inner) {
 							inner = node;
 						} else {
 							inner = new_rd_Add(dbgi, block, inner, node);
 						}
 					}
+					DEL_ARR_F(sorted);
 					assert(inner);
 					if (negativ_set) {
-						foreach_pset(negativ_set, ir_node, node) {
-							inner = new_rd_Sub(dbgi, block, inner, node);
+						sorted = rank_sorted_operands(negativ_set);
+						for (size_t i = 0, n = ARR_LEN(sorted); i < n; ++i) {
+							inner = new_rd_Sub(dbgi, block, inner, sorted[i]);
 						}
+						DEL_ARR_F(sorted);
 					}
 
 					if (!is_one) {
@@ -1837,14 +1884,17 @@ static void rebuild(multi_op_env *multi_env)
 				pset *negativ_set = pmap_get(pset, dic, negativ_val);
 				assert(negativ_set);
 
-				ir_node *inner = NULL;
-				foreach_pset(negativ_set, ir_node, node) {
+				ir_node  *inner  = NULL;
+				ir_node **sorted = rank_sorted_operands(negativ_set);
+				for (size_t i = 0, n = ARR_LEN(sorted); i < n; ++i) {
+					ir_node *node = sorted[i];
 					if (!inner) {
 						inner = node;
 					} else {
 						inner = new_rd_Add(dbgi, block, inner, node);
 					}
 				}
+				DEL_ARR_F(sorted);
 
 				ir_tarval *positiv_val = tarval_neg(negativ_val);
 				if (!tarval_is_one(positiv_val)) {
@@ -1869,13 +1919,18 @@ static void rebuild(multi_op_env *multi_env)
 			pmap_destroy(dic);
 		} else {
 			/* rebuild other sets */
+			ir_node **nodes = NEW_ARR_F(ir_node*, 0);
 			foreach_pset(o->multi_operands, multi_op, operand) {
-				ir_node *node = operand->base_node;
-				curr = rebuild_node(o, curr, node);
+				ARR_APP1(ir_node*, nodes, operand->base_node);
 			}
 			foreach_pset(o->operands, ir_node, node) {
-				curr = rebuild_node(o, curr, node);
+				ARR_APP1(ir_node*, nodes, node);
+			}
+			QSORT_ARR(nodes, cmp_operand_rank);
+			for (size_t i = 0, n = ARR_LEN(nodes); i < n; ++i) {
+				curr = rebuild_node(o, curr, nodes[i]);
 			}
+			DEL_ARR_F(nodes);
 		}
 
 		if (!curr) {
@@ -588,6 +588,9 @@ void opt_tail_rec_irg(ir_graph *irg)
 		IR_GRAPH_PROPERTY_MANY_RETURNS
 		| IR_GRAPH_PROPERTY_NO_BADS
 		| IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
+	/* freeze the out arrays as a snapshot; the control flow is rebuilt
+	 * while they are still consulted */
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
 	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
 
 	tr_env   env;
@@ -10,6 +10,7 @@
  * This is done by eliminating all edges into the unreachable code. So that
  * after that the unreachable code should be dead.
  */
+#include "array.h"
 #include "irgmod.h"
 #include "irgopt.h"
 #include "irgopt.h"
@@ -17,6 +18,11 @@
 #include "irnode_t.h"
 #include <stdbool.h>
 
+typedef struct unreachable_env_t {
+	ir_node **dirty_blocks; /**< reachable blocks that lost an entry */
+	bool      changed;
+} unreachable_env_t;
+
 static bool is_block_unreachable(ir_node *block)
 {
 	return get_Block_dom_depth(block) < 0;
@@ -25,21 +31,26 @@ static bool is_block_unreachable(ir_node *block)
 /**
  * Eliminate block- and phi-inputs pointing to unreachable code
  */
-static void unreachable_to_bad(ir_node *node, void *env)
+static void unreachable_to_bad(ir_node *node, void *data)
 {
-	bool *changed = (bool*)env;
+	unreachable_env_t *env = (unreachable_env_t*)data;
 	if (is_Block(node)) {
 		/* optimization: we do not have to do anything inside the unreachable
 		 * code */
 		if (is_block_unreachable(node))
 			return;
 
-		ir_graph *irg = get_irn_irg(node);
+		bool      block_changed = false;
+		ir_graph *irg           = get_irn_irg(node);
 		foreach_irn_in(node, i, pred) {
 			if (is_Bad(pred) || !is_block_unreachable(get_nodes_block(pred)))
 				continue;
 			set_irn_n(node, i, new_r_Bad(irg, mode_X));
-			*changed = true;
+			block_changed = true;
+		}
+		if (block_changed) {
+			ARR_APP1(ir_node*, env->dirty_blocks, node);
+			env->changed = true;
 		}
 	} else if (is_Phi(node)) {
 		/* optimization: we do not have to do anything inside the unreachable
@@ -58,7 +69,7 @@ static void unreachable_to_bad(ir_node *node, void *env)
 				continue;
 
 			set_irn_n(node, i, new_r_Bad(irg, get_irn_mode(node)));
-			*changed = true;
+			env->changed = true;
 		}
 	}
 }
@@ -97,15 +108,26 @@ void remove_unreachable_code(ir_graph *irg)
 	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
 	                         | IR_GRAPH_PROPERTY_NO_TUPLES);
 
-	bool changed = false;
-	irg_walk_graph(irg, unreachable_to_bad, NULL, &changed);
+	unreachable_env_t env = { NEW_ARR_F(ir_node*, 0), false };
+	irg_walk_graph(irg, unreachable_to_bad, NULL, &env);
+	bool changed = env.changed;
 	changed |= remove_unreachable_keeps(irg);
 
+	/* Only entries stemming from unreachable blocks were removed and
+	 * compute_doms ignores those anyway, so the dominator tree over the
+	 * surviving blocks is untouched.  Keep the property but declare the
+	 * changed blocks, so assure_irg_properties() can double-check. */
 	confirm_irg_properties(irg, changed
 		? IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES
 		| IR_GRAPH_PROPERTY_NO_TUPLES
 		| IR_GRAPH_PROPERTY_ONE_RETURN
 		| IR_GRAPH_PROPERTY_MANY_RETURNS
+		| IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
 		: IR_GRAPH_PROPERTIES_ALL);
+	for (size_t i = 0, n = ARR_LEN(env.dirty_blocks); i < n; ++i) {
+		clear_irg_properties_local(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE,
+		                           env.dirty_blocks[i]);
+	}
+	DEL_ARR_F(env.dirty_blocks);
 	add_irg_properties(irg, IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE);
 }
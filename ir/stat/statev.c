@@ -11,21 +11,33 @@
  */
 #include "statev_t.h"
 
+#include "hashptr.h"
 #include "irprintf.h"
 #include "stat_timing.h"
 #include "util.h"
+#include "xmalloc.h"
 #include <assert.h>
 #include <regex.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define MAX_TIMER 256
 
+/** Output buffer size. Keep event bursts from turning into many small write
+ * syscalls in the middle of the compilation being measured. */
+#define EV_BUF_SIZE (1u << 20)
+
 int (stat_ev_enabled) = 0;
 
+/* all categories report by default; compile-time stripping is done via
+ * STAT_EV_CATEGORY_MASK */
+unsigned stat_ev_active_categories = ~0u;
+
 static FILE          *stat_ev_file;
+static char          *stat_ev_buf;
 static int            stat_ev_timer_sp;
 static timing_ticks_t stat_ev_timer_elapsed[MAX_TIMER];
 static timing_ticks_t stat_ev_timer_start[MAX_TIMER];
@@ -33,12 +45,28 @@ static timing_ticks_t stat_ev_timer_start[MAX_TIMER];
 static regex_t  regex;
 static regex_t *filter;
 
+/** Nearly all events use a handful of string literals as keys, so remember
+ * the filter decision per key address instead of matching the regex on
+ * every event. */
+typedef struct match_cache_entry_t {
+	const char *key;
+	bool        match;
+} match_cache_entry_t;
+
+static match_cache_entry_t match_cache[64];
+
 static bool key_matches(const char *key)
 {
 	if (filter == NULL)
 		return true;
 
-	return regexec(filter, key, 0, NULL, 0) == 0;
+	match_cache_entry_t *const entry
+		= &match_cache[hash_ptr(key) % ARRAY_SIZE(match_cache)];
+	if (entry->key != key) {
+		entry->key   = key;
+		entry->match = regexec(filter, key, 0, NULL, 0) == 0;
+	}
+	return entry->match;
 }
 
 static void stat_ev_vprintf(char ev, const char *key, const char *fmt, va_list ap)
@@ -191,10 +219,14 @@ void stat_ev_begin(const char *prefix, const char *filt)
 	stat_ev_file = fopen(buf, "wt");
 	if (stat_ev_file == NULL) {
 		fprintf(stderr, "Warning: Couldn't create statev output '%s'\n", buf);
+	} else {
+		stat_ev_buf = XMALLOCN(char, EV_BUF_SIZE);
+		setvbuf(stat_ev_file, stat_ev_buf, _IOFBF, EV_BUF_SIZE);
 	}
 
 	if (filt != NULL && filt[0] != '\0') {
 		filter = NULL;
+		memset(match_cache, 0, sizeof(match_cache));
 		if (regcomp(&regex, filt, REG_EXTENDED) == 0) {
 			filter = &regex;
 		} else {
@@ -213,6 +245,8 @@ void stat_ev_end(void)
 		fclose(stat_ev_file);
 		stat_ev_file    = NULL;
 		stat_ev_enabled = 0;
+		free(stat_ev_buf);
+		stat_ev_buf     = NULL;
 	}
 	if (filter != NULL) {
 		regfree(filter);
@@ -25,6 +25,11 @@
 #define stat_ev_cnt_decl(var)                    ((void)0)
 #define stat_ev_cnt_inc(var)                     ((void)0)
 #define stat_ev_cnt_done(name, var)              ((void)0)
+
+#define stat_ev_cnt_register(var, category, evname) \
+	typedef int stat_ev_cnt_dummy_ ## var ## _t
+#define stat_ev_cnt_bump(var)                    ((void)0)
+#define stat_ev_cnt_flush(var)                   ((void)0)
 #define stat_ev_tim_push()                       ((void)0)
 #define stat_ev_tim_pop(name)                    ((void)0)
 
@@ -101,6 +106,65 @@ static inline void stat_ev_ctx_pop_(const char *key)
 #define stat_ev_cnt_inc(var)        do { ++stat_ev_cnt_var_ ## var; } while(0)
 #define stat_ev_cnt_done(var, name) stat_ev_int((name), stat_ev_cnt_var_ ## var)
 
+/**
+ * Categories for registered counters.  Whole categories can be stripped at
+ * compile time by defining STAT_EV_CATEGORY_MASK to a bitmask without the
+ * corresponding bits; counters of stripped categories then compile to
+ * nothing.
+ */
+typedef enum stat_ev_category_t {
+	STAT_EV_CAT_GENERAL, /**< miscellaneous counters */
+	STAT_EV_CAT_ANA,     /**< analysis statistics */
+	STAT_EV_CAT_RA,      /**< register allocator decisions */
+	STAT_EV_CAT_OPT,     /**< middle end optimization decisions */
+} stat_ev_category_t;
+
+#ifndef STAT_EV_CATEGORY_MASK
+#define STAT_EV_CATEGORY_MASK (~0u)
+#endif
+
+/** Constant expression, so counters of masked-out categories are removed
+ * entirely by the compiler. */
+#define stat_ev_cat_compiled(cat) (((STAT_EV_CATEGORY_MASK) >> (cat)) & 1u)
+
+/** Runtime mask of categories reported at flush time.  Bumping a counter
+ * is not gated on it, so the fast path stays a plain increment. */
+extern unsigned stat_ev_active_categories;
+
+#ifdef __GNUC__
+#define STAT_EV_TLS __thread
+#else
+#define STAT_EV_TLS
+#endif
+
+/**
+ * Registers a counter at file scope.  The value lives in a preallocated
+ * per-thread variable, so bumping it is a single increment without any
+ * enabled check.  Flush it at the end of the graph or pass.
+ */
+#define stat_ev_cnt_register(var, category, evname) \
+	static STAT_EV_TLS unsigned long long stat_ev_cnt_val_ ## var; \
+	enum { stat_ev_cnt_cat_ ## var = (category) }; \
+	static const char *const stat_ev_cnt_name_ ## var = (evname)
+
+/** Increments the registered counter @p var. */
+#define stat_ev_cnt_bump(var) \
+	do { \
+		if (stat_ev_cat_compiled(stat_ev_cnt_cat_ ## var)) \
+			++stat_ev_cnt_val_ ## var; \
+	} while (0)
+
+/** Reports the registered counter @p var as an event and resets it. */
+#define stat_ev_cnt_flush(var) \
+	do { \
+		if (stat_ev_cat_compiled(stat_ev_cnt_cat_ ## var)) { \
+			if (stat_ev_cnt_val_ ## var != 0 \
+			 && ((stat_ev_active_categories >> stat_ev_cnt_cat_ ## var) & 1u)) \
+				stat_ev_ull(stat_ev_cnt_name_ ## var, stat_ev_cnt_val_ ## var); \
+			stat_ev_cnt_val_ ## var = 0; \
+		} \
+	} while (0)
+
 #endif
 
 #endif
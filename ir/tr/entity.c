@@ -126,6 +126,7 @@ ir_entity *new_spillslot(ir_type *const frame, unsigned const size,
 	set_entity_alignment(res, 1u << po2align);
 	res->attr.spillslot.base.offset = INVALID_OFFSET;
 	res->attr.spillslot.size = size;
+	res->attr.spillslot.freq = 0.0;
 	return res;
 }
 
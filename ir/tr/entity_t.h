@@ -157,6 +157,9 @@ typedef struct alias_ent_attr {
 typedef struct spillslot_ent_attr {
 	compound_member_ent_attr base;
 	unsigned                 size;
+	/** Estimated access frequency of the slot. The backend uses it to place
+	 * frequently accessed slots near the frame base register. */
+	double                   freq;
 } spillslot_ent_attr;
 
 typedef enum ir_entity_kind {
@@ -33,6 +33,7 @@
 #include "bitfiddle.h"
 #include "dbginfo.h"
 #include "entity_t.h"
+#include "ident_t.h"
 #include "ircons.h"
 #include "irhooks.h"
 #include "irnode_t.h"
@@ -86,7 +87,7 @@ void ir_init_type(ir_prog *irp)
 	irp->unknown_type = new_type(tpo_unknown, 0, mode_ANY);
 	set_type_state (irp->unknown_type, layout_fixed);
 
-	irp->dummy_owner = new_type_struct(new_id_from_str("$dummy_owner$"));
+	irp->dummy_owner = new_type_struct(id_dummy_owner);
 }
 
 void ir_finish_type(ir_prog *irp)
@@ -872,7 +873,7 @@ int is_frame_type(ir_type const *const type)
 
 ir_type *new_type_frame(void)
 {
-	ir_type *res = new_type_class(new_id_from_str("<frame_type>"));
+	ir_type *res = new_type_class(id_frame_type);
 	res->flags |= tf_frame_type;
 
 	return res;
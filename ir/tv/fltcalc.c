@@ -284,6 +284,134 @@ static void fc_get_qnan(const float_descriptor_t *desc, fp_value *result)
 	fc_get_nan(desc, result, false, NULL);
 }
 
+/* The standard IEEE binary32/binary64 formats can be folded directly on
+ * the host FPU, which implements exactly the semantics the emulation
+ * reproduces bit by bit.  This requires FLT_EVAL_METHOD == 0, otherwise
+ * intermediate results are kept in a wider format (classic x87) and
+ * would be rounded twice.  x86 extended precision and other nonstandard
+ * descriptors always take the emulation path. */
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+#define FC_NATIVE_FOLDING 1
+#include <fenv.h>
+#endif
+
+#ifdef FC_NATIVE_FOLDING
+/** Returns whether values of descriptor @p desc have the given IEEE
+ * interchange layout. */
+static bool fc_is_ieee_format(const float_descriptor_t *desc,
+                              unsigned exponent_size, unsigned mantissa_size)
+{
+	return desc->exponent_size == exponent_size
+	    && desc->mantissa_size == mantissa_size
+	    && !desc->explicit_one;
+}
+
+/** Returns whether an operation on @p a and @p b may be computed on the
+ * host FPU.  NaN operands are excluded so the payload and selection
+ * rules stay in handle_NAN(). */
+static bool fc_can_fold_native(const fp_value *a, const fp_value *b)
+{
+	if (rounding_mode != FC_TONEAREST)
+		return false;
+	if (a->clss == FC_NAN || b->clss == FC_NAN)
+		return false;
+	const float_descriptor_t *desc = &a->desc;
+	if (b->desc.exponent_size != desc->exponent_size
+	 || b->desc.mantissa_size != desc->mantissa_size
+	 || b->desc.explicit_one  != desc->explicit_one)
+		return false;
+	return fc_is_ieee_format(desc, 8, 23) || fc_is_ieee_format(desc, 11, 52);
+}
+
+/** Copy between a host float/double object and the little endian byte
+ * encoding used by fc_val_from_bytes()/fc_val_to_bytes(). */
+static void fc_native_copy(void *dst, const void *src, size_t size)
+{
+#ifdef WORDS_BIGENDIAN
+	const unsigned char *from = (const unsigned char*)src;
+	unsigned char       *to   = (unsigned char*)dst;
+	for (size_t i = 0; i < size; ++i)
+		to[i] = from[size-1-i];
+#else
+	memcpy(dst, src, size);
+#endif
+}
+
+/**
+ * Try to fold the binary operation @p op on the host FPU.
+ *
+ * @return true if the result was computed, false if the operands need
+ *         the emulation path
+ */
+static bool fc_fold_native(char op, const fp_value *a, const fp_value *b,
+                           fp_value *result)
+{
+	if (!fc_can_fold_native(a, b))
+		return false;
+
+	/* the host environment may run with a non-default rounding mode */
+	int const old_round = fegetround();
+	if (old_round != FE_TONEAREST)
+		fesetround(FE_TONEAREST);
+	feclearexcept(FE_INEXACT);
+
+	unsigned char buf[sizeof(double)];
+	bool is_nan;
+	if (a->desc.mantissa_size == 23) {
+		float fa;
+		float fb;
+		fc_val_to_bytes(a, buf);
+		fc_native_copy(&fa, buf, sizeof(fa));
+		fc_val_to_bytes(b, buf);
+		fc_native_copy(&fb, buf, sizeof(fb));
+		/* volatile keeps the operation between the fenv calls */
+		volatile float res;
+		switch (op) {
+		case '+': res = fa + fb; break;
+		case '-': res = fa - fb; break;
+		case '*': res = fa * fb; break;
+		case '/': res = fa / fb; break;
+		default:  panic("invalid operation");
+		}
+		float const resv = res;
+		is_nan = isnan(resv);
+		fc_native_copy(buf, &resv, sizeof(resv));
+	} else {
+		double da;
+		double db;
+		fc_val_to_bytes(a, buf);
+		fc_native_copy(&da, buf, sizeof(da));
+		fc_val_to_bytes(b, buf);
+		fc_native_copy(&db, buf, sizeof(db));
+		volatile double res;
+		switch (op) {
+		case '+': res = da + db; break;
+		case '-': res = da - db; break;
+		case '*': res = da * db; break;
+		case '/': res = da / db; break;
+		default:  panic("invalid operation");
+		}
+		double const resv = res;
+		is_nan = isnan(resv);
+		fc_native_copy(buf, &resv, sizeof(resv));
+	}
+
+	fc_exact = fetestexcept(FE_INEXACT) == 0;
+	if (old_round != FE_TONEAREST)
+		fesetround(old_round);
+
+	/* generated NaNs (inf-inf, 0*inf, 0/0, ...) go through the emulation
+	 * so the canonical quiet NaN of fc_get_qnan() is produced */
+	if (is_nan)
+		return false;
+
+	/* result may alias a, so copy the descriptor first */
+	float_descriptor_t const desc = a->desc;
+	fc_val_from_bytes(result, buf, &desc);
+	return true;
+}
+#endif
+
 /**
  * calculate a + b, where a is the value with the bigger exponent
  */
@@ -392,6 +520,10 @@ static void _fadd(const fp_value *a, const fp_value *b, fp_value *result)
 void fc_mul(const fp_value *a, const fp_value *b, fp_value *result)
 {
 	fc_exact = true;
+#ifdef FC_NATIVE_FOLDING
+	if (fc_fold_native('*', a, b, result))
+		return;
+#endif
 	if (handle_NAN(a, b, result))
 		return;
 
@@ -469,6 +601,10 @@ void fc_mul(const fp_value *a, const fp_value *b, fp_value *result)
 void fc_div(const fp_value *a, const fp_value *b, fp_value *result)
 {
 	fc_exact = true;
+#ifdef FC_NATIVE_FOLDING
+	if (fc_fold_native('/', a, b, result))
+		return;
+#endif
 	if (handle_NAN(a, b, result))
 		return;
 
@@ -1083,6 +1219,10 @@ void init_fltcalc(unsigned precision)
 void fc_add(const fp_value *a, const fp_value *b, fp_value *result)
 {
 	fc_exact = true;
+#ifdef FC_NATIVE_FOLDING
+	if (fc_fold_native('+', a, b, result))
+		return;
+#endif
 	if (handle_NAN(a, b, result))
 		return;
 
@@ -1096,6 +1236,10 @@ void fc_add(const fp_value *a, const fp_value *b, fp_value *result)
 void fc_sub(const fp_value *a, const fp_value *b, fp_value *result)
 {
 	fc_exact = true;
+#ifdef FC_NATIVE_FOLDING
+	if (fc_fold_native('-', a, b, result))
+		return;
+#endif
 	if (handle_NAN(a, b, result))
 		return;
 
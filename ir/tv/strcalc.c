@@ -17,6 +17,7 @@
 #include "xmalloc.h"
 #include <assert.h>
 #include <limits.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -25,6 +26,32 @@
 #define SC_RESULT(x) ((x) & SC_MASK)
 #define SC_CARRY(x)  ((unsigned)(x) >> SC_BITS)
 
+/* Values are little-endian arrays of 8-bit digits.  The carry chains in
+ * the arithmetic kernels below process them in 64-bit limbs and only
+ * fall back to single digits for the trailing bytes when the buffer
+ * size is not a multiple of the limb size.  The digit representation
+ * stays the canonical one, so the serialization helpers and all users
+ * of sc_word are unaffected. */
+#define SC_LIMB_BYTES sizeof(uint64_t)
+
+/** Read a 64-bit limb from digit position @p p.  The byte assembly is
+ * endian-independent and compiles to a single load on little-endian
+ * hosts. */
+static uint64_t limb_get(const sc_word *p)
+{
+	uint64_t v = 0;
+	for (unsigned i = 0; i < SC_LIMB_BYTES; ++i)
+		v |= (uint64_t)p[i] << (i * SC_BITS);
+	return v;
+}
+
+/** Write the 64-bit limb @p v to digit position @p p. */
+static void limb_set(sc_word *p, uint64_t v)
+{
+	for (unsigned i = 0; i < SC_LIMB_BYTES; ++i)
+		p[i] = (sc_word)(v >> (i * SC_BITS));
+}
+
 static char *output_buffer = NULL;  /**< buffer for output */
 static unsigned bit_pattern_size;   /**< maximum number of bits */
 static unsigned calc_buffer_size;   /**< size of internally stored values */
@@ -88,39 +115,76 @@ void sc_andnot(const sc_word *val1, const sc_word *val2, sc_word *buffer)
 
 void sc_inc(sc_word *buffer)
 {
-	for (unsigned counter = 0; counter < calc_buffer_size; ++counter) {
-		sc_word v = buffer[counter];
+	unsigned i = 0;
+	for (; i + SC_LIMB_BYTES <= calc_buffer_size; i += SC_LIMB_BYTES) {
+		uint64_t const v = limb_get(&buffer[i]);
+		limb_set(&buffer[i], v + 1);
+		if (v != UINT64_MAX)
+			return;
+	}
+	for (; i < calc_buffer_size; ++i) {
+		sc_word v = buffer[i];
 		if (v < SC_MASK) {
-			buffer[counter] = v+1;
+			buffer[i] = v+1;
 			break;
 		}
-		buffer[counter] = 0;
+		buffer[i] = 0;
 	}
 }
 
 void sc_neg(const sc_word *val, sc_word *buffer)
 {
-	sc_not(val, buffer);
-	sc_inc(buffer);
+	unsigned i     = 0;
+	unsigned carry = 1;
+	for (; i + SC_LIMB_BYTES <= calc_buffer_size; i += SC_LIMB_BYTES) {
+		uint64_t const a = ~limb_get(&val[i]);
+		uint64_t const s = a + carry;
+		carry = s < a;
+		limb_set(&buffer[i], s);
+	}
+	for (; i < calc_buffer_size; ++i) {
+		unsigned const sum = (sc_word)~val[i] + carry;
+		buffer[i] = SC_RESULT(sum);
+		carry     = SC_CARRY(sum);
+	}
 }
 
 void sc_add(const sc_word *val1, const sc_word *val2, sc_word *buffer)
 {
-	sc_word carry = 0;
-	for (unsigned counter = 0; counter < calc_buffer_size; ++counter) {
-		unsigned const sum = val1[counter] + val2[counter] + carry;
-		buffer[counter] = SC_RESULT(sum);
-		carry           = SC_CARRY(sum);
+	unsigned i     = 0;
+	unsigned carry = 0;
+	for (; i + SC_LIMB_BYTES <= calc_buffer_size; i += SC_LIMB_BYTES) {
+		uint64_t const a = limb_get(&val1[i]);
+		uint64_t const b = limb_get(&val2[i]);
+		uint64_t const t = a + b;
+		uint64_t const s = t + carry;
+		carry = (t < a) | (s < t);
+		limb_set(&buffer[i], s);
+	}
+	for (; i < calc_buffer_size; ++i) {
+		unsigned const sum = val1[i] + val2[i] + carry;
+		buffer[i] = SC_RESULT(sum);
+		carry     = SC_CARRY(sum);
 	}
 }
 
 void sc_sub(const sc_word *val1, const sc_word *val2, sc_word *buffer)
 {
-	/* intermediate buffer to hold -val2 */
-	sc_word *temp_buffer = ALLOCAN(sc_word, calc_buffer_size);
-
-	sc_neg(val2, temp_buffer);
-	sc_add(val1, temp_buffer, buffer);
+	unsigned i      = 0;
+	unsigned borrow = 0;
+	for (; i + SC_LIMB_BYTES <= calc_buffer_size; i += SC_LIMB_BYTES) {
+		uint64_t const a = limb_get(&val1[i]);
+		uint64_t const b = limb_get(&val2[i]);
+		uint64_t const t = a - b;
+		uint64_t const d = t - borrow;
+		borrow = (a < b) | (t < (uint64_t)borrow);
+		limb_set(&buffer[i], d);
+	}
+	for (; i < calc_buffer_size; ++i) {
+		unsigned const diff = val1[i] - val2[i] - borrow;
+		buffer[i] = SC_RESULT(diff);
+		borrow    = SC_CARRY(diff) & 1;
+	}
 }
 
 void sc_mul(const sc_word *val1, const sc_word *val2, sc_word *buffer)
@@ -143,6 +207,41 @@ void sc_mul(const sc_word *val1, const sc_word *val2, sc_word *buffer)
 		sign = !sign;
 	}
 
+#ifdef __SIZEOF_INT128__
+	/* Schoolbook multiplication on 64-bit limbs with 128-bit products.
+	 * The operands fit into max_value_size digits (they were made
+	 * positive above), so gather them into zero-padded limb arrays and
+	 * scatter the product back into the digit buffer afterwards. */
+	unsigned const n_limbs = (max_value_size + SC_LIMB_BYTES - 1)
+	                       / SC_LIMB_BYTES;
+	uint64_t *const a = ALLOCANZ(uint64_t, n_limbs);
+	uint64_t *const b = ALLOCANZ(uint64_t, n_limbs);
+	uint64_t *const r = ALLOCANZ(uint64_t, 2 * n_limbs);
+	for (unsigned i = 0; i < max_value_size; ++i) {
+		a[i / SC_LIMB_BYTES]
+			|= (uint64_t)val1[i] << (i % SC_LIMB_BYTES * SC_BITS);
+		b[i / SC_LIMB_BYTES]
+			|= (uint64_t)val2[i] << (i % SC_LIMB_BYTES * SC_BITS);
+	}
+
+	for (unsigned i = 0; i < n_limbs; ++i) {
+		if (b[i] == 0)
+			continue;
+		uint64_t carry = 0;
+		for (unsigned j = 0; j < n_limbs; ++j) {
+			unsigned __int128 const t
+				= (unsigned __int128)a[j] * b[i] + r[i+j] + carry;
+			r[i+j] = (uint64_t)t;
+			carry  = (uint64_t)(t >> 64);
+		}
+		r[i + n_limbs] = carry;
+	}
+
+	for (unsigned i = 0; i < calc_buffer_size; ++i) {
+		temp_buffer[i] = (sc_word)
+			(r[i / SC_LIMB_BYTES] >> (i % SC_LIMB_BYTES * SC_BITS));
+	}
+#else
 	for (unsigned c_outer = 0; c_outer < max_value_size; c_outer++) {
 		sc_word outer = val2[c_outer];
 		if (outer == 0)
@@ -180,6 +279,7 @@ void sc_mul(const sc_word *val1, const sc_word *val2, sc_word *buffer)
 		/* c_outer is always smaller than max_value_size! */
 		temp_buffer[max_value_size + c_outer] = carry;
 	}
+#endif
 
 	if (sign)
 		sc_neg(temp_buffer, buffer);
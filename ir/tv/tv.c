@@ -21,6 +21,7 @@
 #include "bitfiddle.h"
 #include "entity_t.h"
 #include "firm_common.h"
+#include "firm_thread.h"
 #include "fltcalc.h"
 #include "hashptr.h"
 #include "hashptr.h"
@@ -42,8 +43,14 @@
  * constant target values */
 #define N_CONSTANTS 2048
 
-/** A set containing all existing tarvals. */
-static struct set *tarvals = NULL;
+/** Number of shards of the tarval intern table.  Kept in sync with the
+ * number of available intern locks so each shard has its own lock. */
+#define N_TARVAL_SHARDS FIRM_INTERN_N_LOCKS
+
+/** The sets containing all existing tarvals, sharded by mode so parallel
+ * graph drivers interning values of different modes do not serialize on
+ * a single lock. */
+static struct set *tarvals[N_TARVAL_SHARDS];
 
 static unsigned sc_value_length;
 static unsigned fp_value_size;
@@ -70,9 +77,36 @@ static int cmp_tv(const void *p1, const void *p2, size_t n)
 
 static ir_tarval *identify_tarval(ir_tarval const *const tv)
 {
-	unsigned hash = hash_tv(tv);
-	return set_insert(ir_tarval, tarvals, tv, sizeof(ir_tarval) + tv->length,
-	                  hash);
+	unsigned const hash  = hash_tv(tv);
+	unsigned const shard = hash_ptr(tv->mode) % N_TARVAL_SHARDS;
+	firm_intern_lock_shard(shard);
+	ir_tarval *const res = set_insert(ir_tarval, tarvals[shard], tv,
+	                                  sizeof(ir_tarval) + tv->length, hash);
+	firm_intern_unlock_shard(shard);
+	return res;
+}
+
+/**
+ * Look up @p value in the mode's preallocated constant cache.  The small
+ * nonnegative constants and the all-one value account for most intern
+ * hits and are answered here without touching the intern table.
+ *
+ * @return the cached tarval or NULL if the value is not cached
+ */
+static ir_tarval *get_cached_int_tarval(ir_mode *mode, const sc_word *value)
+{
+	for (unsigned i = 1; i < sc_value_length; ++i) {
+		if (value[i] != 0)
+			goto not_small;
+	}
+	if (value[0] < IR_MODE_INT_CACHE_SIZE)
+		return mode->int_cache[value[0]];
+not_small:;
+	ir_tarval *const all_one = mode->all_one;
+	if (all_one != NULL && all_one != tarval_bad
+	 && memcmp(value, all_one->value, sc_value_length) == 0)
+		return all_one;
+	return NULL;
 }
 
 static ir_tarval *get_fp_tarval(const fp_value *value, ir_mode *mode)
@@ -99,6 +133,9 @@ static ir_tarval *get_int_tarval(const sc_word *value, ir_mode *mode)
 	} else {
 		sc_zero_extend((sc_word*)tv->value, get_mode_size_bits(mode));
 	}
+	ir_tarval *const cached = get_cached_int_tarval(mode, tv->value);
+	if (cached != NULL)
+		return cached;
 	return identify_tarval(tv);
 }
 
@@ -127,6 +164,25 @@ static ir_tarval *get_int_tarval_overflow(const sc_word *value, ir_mode *mode)
 	return get_int_tarval(value, mode);
 }
 
+/** Returns the lane values of a vector tarval. */
+static ir_tarval *const *get_vector_lanes(ir_tarval const *tv)
+{
+	return (ir_tarval *const*)tv->value;
+}
+
+/** Intern a vector tarval from its lane values.  Vector values are
+ * represented as the array of their (already interned) lane tarvals. */
+static ir_tarval *get_vector_tarval(ir_tarval *const *lanes, ir_mode *mode)
+{
+	unsigned const size = mode->n_lanes * sizeof(ir_tarval*);
+	ir_tarval *const tv = ALLOCAF(ir_tarval, value, size);
+	tv->kind   = k_tarval;
+	tv->mode   = mode;
+	tv->length = size;
+	memcpy(tv->value, lanes, size);
+	return identify_tarval(tv);
+}
+
 static ir_tarval tarval_bad_obj;
 static ir_tarval tarval_unknown_obj;
 
@@ -245,6 +301,37 @@ ir_tarval *new_tarval_nan(ir_mode *mode, int signaling,
 	return get_fp_tarval(buffer, mode);
 }
 
+ir_tarval *new_tarval_vector(ir_tarval *const *lanes, size_t n_lanes,
+                             ir_mode *mode)
+{
+	assert(mode_is_vector(mode));
+	assert(n_lanes == mode->n_lanes);
+	(void)n_lanes;
+#ifndef NDEBUG
+	for (size_t i = 0; i < n_lanes; ++i)
+		assert(get_tarval_mode(lanes[i]) == mode->lane_mode);
+#endif
+	return get_vector_tarval(lanes, mode);
+}
+
+ir_tarval *new_tarval_vector_splat(ir_tarval *lane_value, ir_mode *mode)
+{
+	assert(mode_is_vector(mode));
+	assert(get_tarval_mode(lane_value) == mode->lane_mode);
+	unsigned    const n_lanes = mode->n_lanes;
+	ir_tarval **const lanes   = ALLOCAN(ir_tarval*, n_lanes);
+	for (unsigned i = 0; i < n_lanes; ++i)
+		lanes[i] = lane_value;
+	return get_vector_tarval(lanes, mode);
+}
+
+ir_tarval *get_tarval_vector_lane(ir_tarval const *tv, unsigned lane)
+{
+	assert(mode_is_vector(tv->mode));
+	assert(lane < tv->mode->n_lanes);
+	return get_vector_lanes(tv)[lane];
+}
+
 ir_tarval *new_tarval_from_bytes(unsigned char const *buf,
                                  ir_mode *mode)
 {
@@ -270,6 +357,16 @@ ir_tarval *new_tarval_from_bytes(unsigned char const *buf,
 
 void tarval_to_bytes(unsigned char *buffer, ir_tarval const *tv)
 {
+	if (mode_is_vector(get_tarval_mode(tv))) {
+		ir_mode *const mode       = get_tarval_mode(tv);
+		unsigned const lane_bytes = get_mode_size_bytes(mode->lane_mode);
+		for (unsigned i = 0, n = mode->n_lanes; i < n; ++i) {
+			tarval_to_bytes(buffer, get_tarval_vector_lane(tv, i));
+			buffer += lane_bytes;
+		}
+		return;
+	}
+
 	switch (get_mode_arithmetic(get_tarval_mode(tv))) {
 	case irma_ieee754:
 	case irma_x86_extended_float:
@@ -426,8 +523,25 @@ ir_tarval *get_tarval_epsilon(ir_mode *mode)
 	return get_fp_tarval(buffer, mode);
 }
 
+/** Build the vector constant with all lanes set to @p lane_value, or
+ * tarval_bad if the lane mode does not provide the constant. */
+static ir_tarval *vector_splat_constant(ir_mode *mode, ir_tarval *lane_value)
+{
+	if (lane_value == NULL || !tarval_is_constant(lane_value))
+		return tarval_bad;
+	unsigned    const n_lanes = mode->n_lanes;
+	ir_tarval **const lanes   = ALLOCAN(ir_tarval*, n_lanes);
+	for (unsigned i = 0; i < n_lanes; ++i)
+		lanes[i] = lane_value;
+	return get_vector_tarval(lanes, mode);
+}
+
 void init_mode_values(ir_mode* mode)
 {
+	/* modes live on an obstack, so clear the constant cache explicitly
+	 * before the first get_int_tarval() call consults it */
+	memset(mode->int_cache, 0, sizeof(mode->int_cache));
+
 	switch (get_mode_sort(mode)) {
 	case irms_float_number: {
 		const float_descriptor_t *desc = get_descriptor(mode);
@@ -470,11 +584,33 @@ void init_mode_values(ir_mode* mode)
 		mode->null      = get_int_tarval(buf, mode);
 		sc_set_bit_at(buf, 0);
 		mode->one       = get_int_tarval(buf, mode);
+
+		/* preallocate the small constants, tiny modes represent fewer
+		 * nonnegative values */
+		unsigned n_cache = IR_MODE_INT_CACHE_SIZE;
+		if (bits - sign < 4)
+			n_cache = 1u << (bits - sign);
+		for (unsigned i = 0; i < n_cache; ++i) {
+			sc_val_from_ulong(i, buf);
+			mode->int_cache[i] = get_int_tarval(buf, mode);
+		}
 		break;
 	}
 
 	case irms_auxiliary:
 	case irms_data:
+		if (mode_is_vector(mode)) {
+			/* splat the lane mode's constants, the lane mode was
+			 * registered (and initialized) before the vector mode */
+			ir_mode *const lane_mode = mode->lane_mode;
+			mode->all_one   = vector_splat_constant(mode, lane_mode->all_one);
+			mode->min       = vector_splat_constant(mode, lane_mode->min);
+			mode->max       = vector_splat_constant(mode, lane_mode->max);
+			mode->null      = vector_splat_constant(mode, lane_mode->null);
+			mode->one       = vector_splat_constant(mode, lane_mode->one);
+			mode->infinity  = vector_splat_constant(mode, lane_mode->infinity);
+			break;
+		}
 		mode->all_one   = tarval_bad;
 		mode->min       = tarval_bad;
 		mode->max       = tarval_bad;
@@ -692,12 +828,50 @@ ir_tarval *tarval_bitcast(ir_tarval const *src, ir_mode *const dst_mode)
 	return new_tarval_from_bytes(buffer, dst_mode);
 }
 
+/** Fold a binary operation lane-wise on two vector tarvals. */
+static ir_tarval *fold_vector_binop(ir_tarval const *a, ir_tarval const *b,
+		ir_tarval *(*fold)(ir_tarval const*, ir_tarval const*))
+{
+	ir_mode          *const mode    = a->mode;
+	unsigned          const n_lanes = mode->n_lanes;
+	ir_tarval *const *const lanes_a = get_vector_lanes(a);
+	ir_tarval *const *const lanes_b = get_vector_lanes(b);
+	ir_tarval       **const lanes   = ALLOCAN(ir_tarval*, n_lanes);
+	for (unsigned i = 0; i < n_lanes; ++i) {
+		ir_tarval *const res = fold(lanes_a[i], lanes_b[i]);
+		if (!tarval_is_constant(res))
+			return tarval_bad;
+		lanes[i] = res;
+	}
+	return get_vector_tarval(lanes, mode);
+}
+
+/** Fold a unary operation lane-wise on a vector tarval. */
+static ir_tarval *fold_vector_unop(ir_tarval const *a,
+		ir_tarval *(*fold)(ir_tarval const*))
+{
+	ir_mode          *const mode    = a->mode;
+	unsigned          const n_lanes = mode->n_lanes;
+	ir_tarval *const *const lanes_a = get_vector_lanes(a);
+	ir_tarval       **const lanes   = ALLOCAN(ir_tarval*, n_lanes);
+	for (unsigned i = 0; i < n_lanes; ++i) {
+		ir_tarval *const res = fold(lanes_a[i]);
+		if (!tarval_is_constant(res))
+			return tarval_bad;
+		lanes[i] = res;
+	}
+	return get_vector_tarval(lanes, mode);
+}
+
 ir_tarval *tarval_not(ir_tarval const *const a)
 {
 	ir_mode *const mode = a->mode;
 	if (get_mode_sort(mode) == irms_internal_boolean)
 		return a == tarval_b_true ? tarval_b_false : tarval_b_true;
 
+	if (mode_is_vector(mode))
+		return fold_vector_unop(a, tarval_not);
+
 	assert(get_mode_arithmetic(mode) == irma_twos_complement);
 	sc_word *const buffer = ALLOCAN(sc_word, sc_value_length);
 	sc_not(a->value, buffer);
@@ -707,6 +881,9 @@ ir_tarval *tarval_not(ir_tarval const *const a)
 ir_tarval *tarval_neg(ir_tarval const *const a)
 {
 	ir_mode *const mode = a->mode;
+	if (mode_is_vector(mode))
+		return fold_vector_unop(a, tarval_neg);
+
 	switch (get_mode_sort(mode)) {
 	case irms_int_number:
 	case irms_reference: {
@@ -740,6 +917,9 @@ ir_tarval *tarval_add(ir_tarval const *a, ir_tarval const *b)
 	ir_mode *const mode = a->mode;
 	assert(mode == b->mode);
 
+	if (mode_is_vector(mode))
+		return fold_vector_binop(a, b, tarval_add);
+
 	switch (get_mode_sort(mode)) {
 	case irms_reference:
 	case irms_int_number: {
@@ -781,6 +961,9 @@ ir_tarval *tarval_sub(ir_tarval const *a, ir_tarval const *b)
 		dst_mode = a->mode;
 	}
 
+	if (mode_is_vector(dst_mode))
+		return fold_vector_binop(a, b, tarval_sub);
+
 	switch (get_mode_sort(dst_mode)) {
 	case irms_reference:
 	case irms_int_number: {
@@ -810,6 +993,9 @@ ir_tarval *tarval_mul(ir_tarval const *const a, ir_tarval const *const b)
 	ir_mode *const mode = a->mode;
 	assert(mode == b->mode);
 
+	if (mode_is_vector(mode))
+		return fold_vector_binop(a, b, tarval_mul);
+
 	switch (get_mode_sort(mode)) {
 	case irms_int_number:
 	case irms_reference: {
@@ -910,6 +1096,9 @@ ir_tarval *tarval_and(ir_tarval const *const a, ir_tarval const *const b)
 	if (get_mode_sort(mode) == irms_internal_boolean)
 		return a == tarval_b_false ? (ir_tarval*)a : (ir_tarval*)b;
 
+	if (mode_is_vector(mode))
+		return fold_vector_binop(a, b, tarval_and);
+
 	assert(get_mode_arithmetic(mode) == irma_twos_complement);
 	sc_word *const buffer = ALLOCAN(sc_word, sc_value_length);
 	sc_and(a->value, b->value, buffer);
@@ -936,6 +1125,9 @@ ir_tarval *tarval_or(ir_tarval const *const a, ir_tarval const *const b)
 	if (get_mode_sort(mode) == irms_internal_boolean)
 		return a == tarval_b_true ? (ir_tarval*)a : (ir_tarval*)b;
 
+	if (mode_is_vector(mode))
+		return fold_vector_binop(a, b, tarval_or);
+
 	assert(get_mode_arithmetic(mode) == irma_twos_complement);
 	sc_word *const buffer = ALLOCAN(sc_word, sc_value_length);
 	sc_or(a->value, b->value, buffer);
@@ -962,6 +1154,9 @@ ir_tarval *tarval_eor(ir_tarval const *const a, ir_tarval const *const b)
 	if (get_mode_sort(mode) == irms_internal_boolean)
 		return a == b ? tarval_b_false : tarval_b_true;
 
+	if (mode_is_vector(mode))
+		return fold_vector_binop(a, b, tarval_eor);
+
 	assert(get_mode_arithmetic(mode) == irma_twos_complement);
 	sc_word *const buffer = ALLOCAN(sc_word, sc_value_length);
 	sc_xor(a->value, b->value, buffer);
@@ -1153,6 +1348,21 @@ const char *ir_tarval_to_ascii(char *buf, size_t len, ir_tarval const *tv)
 			return "bad";
 		else if (tv == tarval_unknown)
 			return "unknown";
+		if (mode_is_vector(mode)) {
+			/* lane values joined by ':' so the result is a single word */
+			size_t ofs = 0;
+			for (unsigned i = 0, n = mode->n_lanes; i < n; ++i) {
+				char lane_buf[128];
+				const char *lane_str
+					= ir_tarval_to_ascii(lane_buf, sizeof(lane_buf),
+					                     get_tarval_vector_lane(tv, i));
+				int written = snprintf(buf + ofs, len - ofs, "%s%s",
+				                       i == 0 ? "" : ":", lane_str);
+				assert(written >= 0 && (size_t)written < len - ofs);
+				ofs += written;
+			}
+			return buf;
+		}
 		break;
 	}
 	panic("invalid tarval");
@@ -1183,6 +1393,23 @@ ir_tarval *ir_tarval_from_ascii(const char *buf, ir_mode *mode)
 			return tarval_bad;
 		else if (streq(buf, "unknown"))
 			return tarval_unknown;
+		if (mode_is_vector(mode)) {
+			unsigned    const n_lanes   = get_mode_n_lanes(mode);
+			ir_mode    *const lane_mode = get_mode_lane_mode(mode);
+			ir_tarval **const lanes     = ALLOCAN(ir_tarval*, n_lanes);
+			const char       *p         = buf;
+			for (unsigned i = 0; i < n_lanes; ++i) {
+				const char *end = strchr(p, ':');
+				size_t      n   = end != NULL ? (size_t)(end - p) : strlen(p);
+				char lane_buf[128];
+				assert(n < sizeof(lane_buf));
+				memcpy(lane_buf, p, n);
+				lane_buf[n] = '\0';
+				lanes[i] = ir_tarval_from_ascii(lane_buf, lane_mode);
+				p += n + (end != NULL);
+			}
+			return get_vector_tarval(lanes, mode);
+		}
 		break;
 	}
 	panic("invalid mode for tarval_from_ascii");
@@ -1190,6 +1417,12 @@ ir_tarval *ir_tarval_from_ascii(const char *buf, ir_mode *mode)
 
 unsigned char get_tarval_sub_bits(ir_tarval const *tv, unsigned byte_ofs)
 {
+	if (mode_is_vector(tv->mode)) {
+		unsigned const lane_bytes = get_mode_size_bytes(tv->mode->lane_mode);
+		ir_tarval *const lane = get_tarval_vector_lane(tv, byte_ofs/lane_bytes);
+		return get_tarval_sub_bits(lane, byte_ofs % lane_bytes);
+	}
+
 	switch (get_mode_arithmetic(tv->mode)) {
 	case irma_twos_complement:
 		return sc_sub_bits(tv->value, get_mode_size_bits(tv->mode), byte_ofs);
@@ -1331,7 +1564,8 @@ void init_tarval_1(void)
 {
 	/* initialize the sets holding the tarvals with a comparison function and
 	 * an initial size, which is the expected number of constants */
-	tarvals = new_set(cmp_tv, N_CONSTANTS);
+	for (unsigned i = 0; i < N_TARVAL_SHARDS; ++i)
+		tarvals[i] = new_set(cmp_tv, N_CONSTANTS / N_TARVAL_SHARDS);
 	/* calls init_strcalc() with needed size */
 	init_fltcalc(128);
 
@@ -1359,7 +1593,10 @@ void init_tarval_2(void)
 void finish_tarval(void)
 {
 	finish_strcalc();
-	del_set(tarvals); tarvals = NULL;
+	for (unsigned i = 0; i < N_TARVAL_SHARDS; ++i) {
+		del_set(tarvals[i]);
+		tarvals[i] = NULL;
+	}
 }
 
 bool tarval_in_range(ir_tarval const *const min, ir_tarval const *const val, ir_tarval const *const max)
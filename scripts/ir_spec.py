@@ -50,6 +50,7 @@ class TypeConst(Node):
 @op
 class Add(Binop):
     """returns the sum of its operands"""
+    fast_path = True
     mode = "get_irn_mode(mode_is_reference(get_irn_mode(irn_right)) ? irn_right : irn_left)"
     flags = ["commutative"]
 
@@ -315,6 +316,15 @@ class Call(Node):
     throws_init = "false"
     init = '''
     assert((get_unknown_type() == type) || is_Method_type(type));
+    /* A doubleword result may never materialize as a node (unused result),
+     * so note the result modes in the graph's mode size mask here. */
+    if (is_Method_type(type)) {
+        for (size_t i = 0, n = get_method_n_ress(type); i < n; ++i) {
+            ir_type *res_tp = get_method_res_type(type, i);
+            if (is_Primitive_type(res_tp))
+                irg_note_mode_size(irg, get_type_mode(res_tp));
+        }
+    }
     '''
 
 
@@ -568,6 +578,7 @@ class Jmp(Node):
 @op
 class Load(Node):
     """Loads a value from memory (heap or stack)."""
+    fast_path = True
     ins = [
         ("mem", "memory dependency"),
         ("ptr", "address to load from"),
@@ -710,6 +721,7 @@ class Phi(Node):
     """Choose a value based on control flow. A phi node has 1 input for each
     predecessor of its block. If a block is entered from its nth predecessor
     all phi nodes produce their nth input as result."""
+    fast_path = True
     pinned = "yes"
     arity = "variable"
     input_name = "pred"
@@ -740,6 +752,7 @@ class Pin(Node):
 @op
 class Proj(Node):
     """returns an entry of a tuple value"""
+    fast_path = True
     ins = [
         ("pred", "the tuple value from which a part is extracted"),
     ]
@@ -871,6 +884,7 @@ class Start(Node):
 @op
 class Store(Node):
     """Stores a value into memory (heap or stack)."""
+    fast_path = True
     ins = [
         ("mem", "memory dependency"),
         ("ptr", "address to store to"),
@@ -14,6 +14,7 @@ class Node(object):
     attrs = []
     constructor = True
     constructor_args = []
+    fast_path = False
     block = None
     mode = None
     pinned_init = None
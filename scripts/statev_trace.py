@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""Turn statev event streams into flamegraphs and Chrome traces.
+
+libFirm writes statistic events as text lines (see ir/stat/statev.c):
+
+    P;key;value     push context (e.g. bemain_irg)
+    O;key           pop context
+    E;key;value     report a value in the current context
+
+With --statev the backend reports the per-pass timers of ir/be/bemain.c as
+``E;bemain_time_<pass>;<usec>`` events inside the ``bemain_compilation_unit``
+and ``bemain_irg`` contexts. This tool attributes those timer values to
+compilation unit x irg x pass and emits either:
+
+  * collapsed-stack format for flamegraph.pl / speedscope (--format folded)
+  * Chrome trace-event JSON for chrome://tracing / Perfetto (--format trace)
+
+statev events carry no timestamps, so the trace timeline is reconstructed by
+laying the measured spans out sequentially in reporting order: durations are
+exact, concurrency and gaps are not represented.
+
+Typical use on a fleet of build logs:
+
+    statev_trace.py --format folded stat-*.ev | flamegraph.pl > passes.svg
+    statev_trace.py --format trace stat-foo.ev -o foo.trace.json
+"""
+import argparse
+import gzip
+import json
+import re
+import sys
+
+
+def open_events(filename):
+    if filename.endswith(".gz"):
+        return gzip.open(filename, "rt")
+    if filename == "-":
+        return sys.stdin
+    return open(filename, "r")
+
+
+def parse_events(stream, timer_re):
+    """Yield (context_stack, timer_name, usec) for every matching event.
+
+    The context stack is a tuple of (key, value) pairs of the currently
+    pushed contexts, innermost last.
+    """
+    stack = []
+    for line in stream:
+        line = line.rstrip("\n")
+        if len(line) < 2 or line[1] != ";":
+            continue
+        kind, rest = line[0], line[2:]
+        if kind == "P":
+            key, _, value = rest.partition(";")
+            stack.append((key, value))
+        elif kind == "O":
+            key = rest.split(";", 1)[0]
+            # contexts are popped in order, but be lenient about
+            # truncated streams from crashed compilations
+            while stack:
+                popped = stack.pop()
+                if popped[0] == key:
+                    break
+        elif kind == "E":
+            key, _, value = rest.partition(";")
+            m = timer_re.match(key)
+            if m is None:
+                continue
+            name = m.group(1) if m.groups() else key
+            try:
+                usec = float(value)
+            except ValueError:
+                continue
+            yield tuple(stack), name, usec
+
+
+def frame_names(stack):
+    """Human readable frame per pushed context."""
+    frames = []
+    for key, value in stack:
+        if key == "bemain_compilation_unit":
+            frames.append(value)
+        elif key == "bemain_irg":
+            frames.append(value)
+        else:
+            frames.append("%s:%s" % (key, value))
+    return frames
+
+
+def collect(filenames, timer_re, tag_files):
+    """Aggregate usec by (frame tuple, pass name)."""
+    total = {}
+    order = []
+    for filename in filenames:
+        with open_events(filename) as stream:
+            for stack, name, usec in parse_events(stream, timer_re):
+                frames = frame_names(stack)
+                if tag_files:
+                    frames.insert(0, filename)
+                key = (tuple(frames), name)
+                if key not in total:
+                    total[key] = 0.0
+                    order.append(key)
+                total[key] += usec
+    return [(frames, name, total[(frames, name)]) for frames, name in order]
+
+
+def emit_folded(samples, out):
+    for frames, name, usec in samples:
+        stack = ";".join(list(frames) + [name]).replace(" ", "_")
+        out.write("%s %d\n" % (stack, round(usec)))
+
+
+def emit_trace(samples, out):
+    """Chrome trace-event JSON; spans laid out sequentially per frame."""
+    events = []
+    cursor = {}       # frame tuple -> running end of its last span
+    for frames, name, usec in samples:
+        parent = frames[:-1]
+        start = max(cursor.get(tuple(frames), 0.0),
+                    cursor.get(tuple(parent), 0.0))
+        events.append({
+            "name": name,
+            "cat": "pass",
+            "ph": "X",
+            "ts": start,
+            "dur": usec,
+            "pid": 1,
+            "tid": 1,
+            "args": {"stack": "/".join(frames)},
+        })
+        cursor[tuple(frames)] = start + usec
+        # a finished child pushes the parent cursors forward as well
+        for depth in range(len(frames)):
+            prefix = tuple(frames[:depth])
+            cursor[prefix] = max(cursor.get(prefix, 0.0), start + usec)
+    json.dump({"traceEvents": events, "displayTimeUnit": "ms"}, out,
+              indent=1)
+    out.write("\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("files", nargs="+",
+                        help="statev event files (.ev, .ev.gz or - for stdin)")
+    parser.add_argument("--format", choices=["folded", "trace"],
+                        default="folded", help="output format")
+    parser.add_argument("--timer-regex", default=r"bemain_time_(.*)",
+                        help="regex selecting timer events; group 1 names "
+                             "the pass (default: %(default)s)")
+    parser.add_argument("--tag-files", action="store_true",
+                        help="prefix stacks with the input file name "
+                             "(useful when merging a fleet of logs)")
+    parser.add_argument("-o", "--output", default=None,
+                        help="output file (default: stdout)")
+    args = parser.parse_args()
+
+    timer_re = re.compile(args.timer_regex)
+    samples = collect(args.files, timer_re, args.tag_files)
+    out = open(args.output, "w") if args.output else sys.stdout
+    try:
+        if args.format == "folded":
+            emit_folded(samples, out)
+        else:
+            emit_trace(samples, out)
+    finally:
+        if args.output:
+            out.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -11,6 +11,7 @@
 #include <libfirm/irgraph.h>
 #include "{{spec.external}}/nodes.h"
 {% else %}
+#include "irnode_new_t.h"
 #include "irnode_t.h"
 #include "irop_t.h"
 #include "irverify_t.h"
@@ -53,7 +54,9 @@ ir_node *new_rd_{{node.name}}(
 	{{node|irgassign}}
 	{{node|insdecl}}
 
-	ir_node *res = new_ir_node(
+	{#- ops marked fast_path in the spec inline the allocation core, so
+	    the constant arity unrolls the in copy and edge notification #}
+	ir_node *res = new_ir_node{% if node.fast_path and not spec.external %}_{% endif %}(
 		{%- filter arguments %}
 			dbgi
 			irg
@@ -3,22 +3,48 @@
  * This file is a supplement to libFirm. It is public domain.
  *  @author Matthias Braun, Steven Schaefer
  */
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-/* Prevent the compiler from mangling the name of this function. */
+/* Number of per-thread counter shards instrumented by the compiler for the
+ * v2 format. Must match IR_PROFILE_N_SHARDS in libfirm. */
+#define FIRMPROF_N_SHARDS 8
+
+/* Prevent the compiler from mangling the names of these symbols. */
 void __init_firmprof(const char*, unsigned int*, size_t)
      asm("__init_firmprof");
+void __init_firmprof2(const char*, unsigned int*, size_t, size_t, unsigned)
+     asm("__init_firmprof2");
+void firmprof_flush(void) asm("firmprof_flush");
+void firmprof_install_flush_handler(int) asm("firmprof_install_flush_handler");
+extern __thread unsigned firmprof_shard asm("__firmprof_shard");
+
+/* The shard index of the calling thread, read by instrumented code. */
+__thread unsigned firmprof_shard;
 
 typedef struct _profile_counter_t {
 	const char *filename;
 	unsigned   *counters;
 	unsigned    len;
+	unsigned    n_shards;   /* 0: v1 counter registered by __init_firmprof */
+	unsigned    block_hash;
 	struct _profile_counter_t *next;
 } profile_counter_t;
 
 static profile_counter_t *counters = NULL;
 
+/**
+ * Assign the calling thread its own counter shard. Call this once in every
+ * worker thread; threads that don't share shard 0.
+ */
+void firmprof_thread_init(void)
+{
+	static unsigned next_shard = 0;
+	firmprof_shard = __sync_fetch_and_add(&next_shard, 1) % FIRMPROF_N_SHARDS;
+}
+
 /**
  * Write counter values to profiling output file.
  * We define our output format to be a sequence of 32-bit unsigned integer
@@ -41,22 +67,140 @@ void write_little_endian(unsigned *counter, unsigned len, FILE *f)
 	}
 }
 
+static unsigned read_le32(FILE *f, int *ok)
+{
+	unsigned char bytes[4];
+	if (fread(bytes, 4, 1, f) != 1) {
+		*ok = 0;
+		return 0;
+	}
+	return ((unsigned)bytes[0] <<  0) | ((unsigned)bytes[1] <<  8)
+	     | ((unsigned)bytes[2] << 16) | ((unsigned)bytes[3] << 24);
+}
+
+static void write_le32(unsigned v, FILE *f)
+{
+	unsigned char bytes[4];
+
+	bytes[0] = ((v >>  0) & 0xff);
+	bytes[1] = ((v >>  8) & 0xff);
+	bytes[2] = ((v >> 16) & 0xff);
+	bytes[3] = ((v >> 24) & 0xff);
+
+	fwrite(bytes, 1, 4, f);
+}
+
+/**
+ * Write one v2 counter section: fold all thread shards into the first
+ * shard, merge with the counters already present in the file (so profiles
+ * from several processes accumulate instead of overwriting each other) and
+ * write header plus counters.  Afterwards all shards are reset to zero so
+ * repeated flushes only add counts gathered since the previous one.
+ */
+static void write_profile2(profile_counter_t *counter)
+{
+	unsigned *counts   = counter->counters;
+	unsigned  len      = counter->len;
+	unsigned  s, i;
+
+	/* fold the shards */
+	for (s = 1; s < counter->n_shards; ++s) {
+		for (i = 0; i < len; ++i) {
+			unsigned long long sum =
+				(unsigned long long)counts[i] + counts[s * len + i];
+			counts[i] = sum > 0xffffffffu ? 0xffffffffu : (unsigned)sum;
+		}
+	}
+
+	/* merge with an existing profile of the same compilation */
+	FILE *f = fopen(counter->filename, "rb");
+	if (f != NULL) {
+		char magic[8];
+		int  ok = fread(magic, 8, 1, f) == 1
+		       && memcmp(magic, "firmprf2", 8) == 0;
+		if (ok) {
+			unsigned old_len  = read_le32(f, &ok);
+			unsigned old_hash = read_le32(f, &ok);
+			if (ok && old_len == len && old_hash == counter->block_hash) {
+				for (i = 0; ok && i < len; ++i) {
+					unsigned long long sum =
+						(unsigned long long)counts[i] + read_le32(f, &ok);
+					if (ok)
+						counts[i] = sum > 0xffffffffu ? 0xffffffffu
+						                              : (unsigned)sum;
+				}
+			}
+		}
+		fclose(f);
+	}
+
+	f = fopen(counter->filename, "wb");
+	if (f == NULL) {
+		perror("Warning: couldn't open file for writing profiling data");
+		return;
+	}
+	fputs("firmprf2", f);
+	write_le32(len, f);
+	write_le32(counter->block_hash, f);
+	write_little_endian(counts, len, f);
+	fclose(f);
+
+	memset(counts, 0,
+	       (size_t)len * (counter->n_shards ? counter->n_shards : 1)
+	       * sizeof(*counts));
+}
+
+/**
+ * Write all registered counter sections out.  Unlike the atexit handler
+ * this keeps the registration list intact, so it may be called repeatedly
+ * (e.g. from a signal handler of a long-running service) — v2 sections are
+ * merged into their files and reset, making each flush incremental.
+ */
+void firmprof_flush(void)
+{
+	profile_counter_t *counter;
+	for (counter = counters; counter != NULL; counter = counter->next) {
+		if (counter->n_shards > 0) {
+			write_profile2(counter);
+		} else {
+			FILE *f = fopen(counter->filename, "wb");
+			if (f == NULL) {
+				perror("Warning: couldn't open file for writing profiling data");
+			} else {
+				fputs("firmprof", f);
+				write_little_endian(counter->counters, counter->len, f);
+				fclose(f);
+			}
+		}
+	}
+}
+
+static void flush_signal_handler(int sig)
+{
+	(void)sig;
+	firmprof_flush();
+}
+
+/**
+ * Install a handler that flushes all profiles when @p signum is delivered.
+ * Intended for services that never reach exit(); the handler performs stdio
+ * calls, so deliver the signal only from a quiescent state.
+ */
+void firmprof_install_flush_handler(int signum)
+{
+	signal(signum, flush_signal_handler);
+}
+
 static void write_profiles(void)
 {
 	profile_counter_t *counter = counters;
+	firmprof_flush();
 	while (counter != NULL) {
 		profile_counter_t *next = counter->next;
-		FILE *f = fopen(counter->filename, "wb");
-		if (f == NULL) {
-			perror("Warning: couldn't open file for writing profiling data");
-		} else {
-			fputs("firmprof", f);
-			write_little_endian(counter->counters, counter->len, f);
-			fclose(f);
-		}
 		free(counter);
 		counter = next;
 	}
+	counters = NULL;
 }
 
 /**
@@ -64,8 +208,8 @@ static void write_profiles(void)
  * for each translation unit. Incidentally, referring to this function as
  * "__init_firmprof" is perfectly linker friendly.
  */
-void __init_firmprof(const char *filename,
-                      unsigned int *counts, size_t len)
+static void register_counter(const char *filename, unsigned int *counts,
+                             size_t len, size_t n_shards, unsigned block_hash)
 {
 	static int initialized = 0;
 	profile_counter_t *counter;
@@ -79,10 +223,28 @@ void __init_firmprof(const char *filename,
 	if (counter == NULL)
 		return;
 
-	counter->filename = filename;
-	counter->counters = counts;
-	counter->next     = counters;
-	counter->len      = len;
+	counter->filename   = filename;
+	counter->counters   = counts;
+	counter->next       = counters;
+	counter->len        = len;
+	counter->n_shards   = n_shards;
+	counter->block_hash = block_hash;
 
 	counters = counter;
 }
+
+void __init_firmprof(const char *filename,
+                      unsigned int *counts, size_t len)
+{
+	register_counter(filename, counts, len, 0, 0);
+}
+
+/**
+ * Register a v2 profile counter section with per-thread shards and a
+ * staleness hash over the instrumented block ids.
+ */
+void __init_firmprof2(const char *filename, unsigned int *counts,
+                      size_t len, size_t n_shards, unsigned block_hash)
+{
+	register_counter(filename, counts, len, n_shards, block_hash);
+}
@@ -0,0 +1,87 @@
+#include "array.h"
+#include "obst.h"
+
+#include <assert.h>
+
+#define N 5000
+
+static void test_flexible(void)
+{
+	int *arr = NEW_ARR_F(int, 0);
+	for (int i = 0; i < N; ++i)
+		ARR_APP1(int, arr, i);
+	assert(ARR_LEN(arr) == N);
+	for (int i = 0; i < N; ++i)
+		assert(arr[i] == i);
+	DEL_ARR_F(arr);
+}
+
+static void test_obstack(void)
+{
+	struct obstack obst;
+	obstack_init(&obst);
+
+	int *arr = NEW_ARR_O(int, &obst, 0);
+	for (int i = 0; i < N; ++i)
+		ARR_APP1(int, arr, i);
+	assert(ARR_LEN(arr) == N);
+	for (int i = 0; i < N; ++i)
+		assert(arr[i] == i);
+
+	/* interleave allocations so the arrays are not always the topmost
+	 * obstack object while growing */
+	int *arr2 = NEW_ARR_O(int, &obst, 0);
+	for (int i = 0; i < N; ++i) {
+		ARR_APP1(int, arr2, -i);
+		if (i % 7 == 0)
+			(void)obstack_alloc(&obst, 16);
+	}
+	assert(ARR_LEN(arr2) == N);
+	for (int i = 0; i < N; ++i)
+		assert(arr2[i] == -i);
+	assert(ARR_LEN(arr) == N);
+	for (int i = 0; i < N; ++i)
+		assert(arr[i] == i);
+
+	ARR_SHRINKLEN(arr2, 10);
+	assert(ARR_LEN(arr2) == 10);
+
+	obstack_free(&obst, NULL);
+}
+
+static void test_small_buffer(void)
+{
+	/* stays within the buffer */
+	{
+		DECL_ARR_S(int, arr, 8);
+		for (int i = 0; i < 8; ++i)
+			ARR_APP1(int, arr, i);
+		assert(ARR_LEN(arr) == 8);
+		assert((char*)arr > (char*)&arr__storage
+		    && (char*)arr < (char*)(&arr__storage + 1));
+		for (int i = 0; i < 8; ++i)
+			assert(arr[i] == i);
+		DEL_ARR_F(arr);
+	}
+
+	/* outgrows the buffer and migrates to the heap */
+	{
+		DECL_ARR_S(int, arr, 8);
+		for (int i = 0; i < N; ++i)
+			ARR_APP1(int, arr, i);
+		assert(ARR_LEN(arr) == N);
+		assert((char*)arr < (char*)&arr__storage
+		    || (char*)arr >= (char*)(&arr__storage + 1));
+		for (int i = 0; i < N; ++i)
+			assert(arr[i] == i);
+		DEL_ARR_F(arr);
+	}
+}
+
+int main(void)
+{
+	test_flexible();
+	test_obstack();
+	test_small_buffer();
+	return 0;
+}
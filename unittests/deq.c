@@ -170,6 +170,31 @@ static void test_mixed(void)
 	deq_free(&deq);
 }
 
+static void test_bulk(void)
+{
+	static char *ptrs[5000];
+	for (unsigned i = 0; i < 5000; ++i)
+		ptrs[i] = arr + i;
+
+	deq_t deq;
+	deq_init(&deq);
+
+	deq_push_pointer_array_right(&deq, (void *const*)ptrs, 5000);
+	verify(&deq, 5000, arr, arr+5000);
+	pop_left(&deq, 5000, arr);
+	assert(deq_empty(&deq));
+
+	/* bulk append onto a partially filled queue */
+	push_right(&deq, 3, arr);
+	deq_push_pointer_array_right(&deq, (void *const*)(ptrs + 3), 4997);
+	verify(&deq, 5000, arr, arr+5000);
+	pop_right(&deq, 5000, arr);
+	assert(deq_empty(&deq));
+
+	deq_free(&deq);
+	deq_pool_finish();
+}
+
 typedef void (*push_func)(deq_t *deq, unsigned n, char *refp);
 typedef void (*pop_func)(deq_t *deq, unsigned n, char *refp);
 static void test_mixed_4(push_func push0, pop_func pop0,
@@ -198,6 +223,7 @@ int main(void)
 
 	test_many();
 	test_mixed();
+	test_bulk();
 
 	test_mixed_4(push_left,  pop_left,  push_left,  pop_left);
 	test_mixed_4(push_left,  pop_left,  push_left,  pop_right);
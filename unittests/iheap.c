@@ -0,0 +1,94 @@
+#include "iheap.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#define N 5000
+
+static int prios[N];
+
+static void test_order(void)
+{
+	iheap_t *heap = new_iheap();
+	assert(iheap_empty(heap));
+
+	for (unsigned i = 0; i < N; ++i) {
+		prios[i] = (int)((i * 7919u) % N);
+		iheap_put(heap, i, &prios[i], prios[i]);
+		assert(iheap_contains(heap, i));
+	}
+	assert(iheap_length(heap) == N);
+
+	int last = N;
+	for (unsigned i = 0; i < N; ++i) {
+		int *p = (int*)iheap_pop(heap);
+		assert(*p <= last);
+		last = *p;
+	}
+	assert(iheap_empty(heap));
+
+	del_iheap(heap);
+}
+
+static void test_update(void)
+{
+	iheap_t *heap = new_iheap();
+
+	for (unsigned i = 0; i < N; ++i) {
+		prios[i] = (int)i;
+		iheap_put(heap, i, &prios[i], prios[i]);
+	}
+
+	/* updating a queued id must not grow the heap */
+	for (unsigned i = 0; i < N; i += 2) {
+		prios[i] = -(int)i;
+		iheap_put(heap, i, &prios[i], prios[i]);
+	}
+	assert(iheap_length(heap) == N);
+
+	/* increase-key on a single element makes it pop first */
+	prios[42] = N + 1;
+	iheap_put(heap, 42, &prios[42], prios[42]);
+	int *p = (int*)iheap_pop(heap);
+	assert(p == &prios[42]);
+	assert(!iheap_contains(heap, 42));
+
+	int last = N + 1;
+	while (!iheap_empty(heap)) {
+		p = (int*)iheap_pop(heap);
+		assert(*p <= last);
+		last = *p;
+	}
+
+	del_iheap(heap);
+}
+
+static void test_build(void)
+{
+	iheap_t *heap = new_iheap();
+
+	for (unsigned i = 0; i < N; ++i) {
+		prios[i] = (int)((i * 104729u) % N);
+		iheap_append(heap, i, &prios[i], prios[i]);
+	}
+	iheap_build(heap);
+	assert(iheap_length(heap) == N);
+
+	int last = N;
+	for (unsigned i = 0; i < N; ++i) {
+		int *p = (int*)iheap_pop(heap);
+		assert(*p <= last);
+		last = *p;
+	}
+	assert(iheap_empty(heap));
+
+	del_iheap(heap);
+}
+
+int main(void)
+{
+	test_order();
+	test_update();
+	test_build();
+	return 0;
+}
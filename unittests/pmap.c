@@ -0,0 +1,76 @@
+#include "pmap.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+#define N 5000
+
+static char keys[N];
+static char values[N];
+
+int main(void)
+{
+	pmap *map = pmap_create();
+	assert(pmap_count(map) == 0);
+
+	for (int i = 0; i < N; ++i)
+		pmap_insert(map, &keys[i], &values[i]);
+	assert(pmap_count(map) == N);
+
+	for (int i = 0; i < N; ++i) {
+		assert(pmap_contains(map, &keys[i]));
+		assert(pmap_get(char, map, &keys[i]) == &values[i]);
+		pmap_entry *entry = pmap_find(map, &keys[i]);
+		assert(entry != NULL && entry->key == &keys[i]);
+	}
+	assert(!pmap_contains(map, values));
+	assert(pmap_get(char, map, values) == NULL);
+
+	/* overwriting an existing key must not create a new entry */
+	pmap_insert(map, &keys[7], &values[8]);
+	assert(pmap_count(map) == N);
+	assert(pmap_get(char, map, &keys[7]) == &values[8]);
+	pmap_insert(map, &keys[7], &values[7]);
+
+	/* the NULL key is a valid key */
+	assert(!pmap_contains(map, NULL));
+	pmap_insert(map, NULL, &values[0]);
+	assert(pmap_contains(map, NULL));
+	assert(pmap_get(char, map, NULL) == &values[0]);
+	assert(pmap_count(map) == N + 1);
+
+	unsigned n = 0;
+	foreach_pmap(map, entry) {
+		if (entry->key != NULL)
+			assert((char*)entry->value - values
+			    == (char const*)entry->key - keys);
+		++n;
+	}
+	assert(n == N + 1);
+
+	/* break an iteration early and start over */
+	n = 0;
+	foreach_pmap(map, entry) {
+		if (++n == N / 2) {
+			pmap_break(map);
+			break;
+		}
+	}
+	n = 0;
+	foreach_pmap(map, entry) {
+		(void)entry;
+		++n;
+	}
+	assert(n == N + 1);
+
+	pmap_destroy(map);
+
+	/* preallocated capacity */
+	map = pmap_create_ex(N);
+	for (int i = 0; i < N; ++i)
+		pmap_insert(map, &keys[i], &values[i]);
+	assert(pmap_count(map) == N);
+	pmap_destroy(map);
+
+	return 0;
+}
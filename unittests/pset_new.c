@@ -0,0 +1,100 @@
+#include "pset_new.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#define N 20000
+
+static char storage[N];
+
+static void *ptr(unsigned i)
+{
+	return &storage[i];
+}
+
+static void test_insert_find(void)
+{
+	pset_new_t set;
+	pset_new_init(&set);
+
+	for (unsigned i = 0; i < N; ++i) {
+		assert(!pset_new_contains(&set, ptr(i)));
+		bool new_element = pset_new_insert(&set, ptr(i));
+		assert(new_element);
+		assert(pset_new_contains(&set, ptr(i)));
+	}
+	assert(pset_new_size(&set) == N);
+
+	/* inserting again must not create duplicates */
+	for (unsigned i = 0; i < N; ++i) {
+		bool new_element = pset_new_insert(&set, ptr(i));
+		assert(!new_element);
+	}
+	assert(pset_new_size(&set) == N);
+
+	pset_new_destroy(&set);
+}
+
+static void test_remove(void)
+{
+	pset_new_t set;
+	pset_new_init(&set);
+
+	for (unsigned i = 0; i < N; ++i)
+		pset_new_insert(&set, ptr(i));
+
+	/* remove every second element */
+	for (unsigned i = 0; i < N; i += 2)
+		pset_new_remove(&set, ptr(i));
+	assert(pset_new_size(&set) == N / 2);
+	for (unsigned i = 0; i < N; ++i)
+		assert(pset_new_contains(&set, ptr(i)) == (i % 2 != 0));
+
+	/* reinsert into the tombstones */
+	for (unsigned i = 0; i < N; i += 2) {
+		bool new_element = pset_new_insert(&set, ptr(i));
+		assert(new_element);
+	}
+	assert(pset_new_size(&set) == N);
+
+	/* removing everything must shrink the set without corrupting it */
+	for (unsigned i = 0; i < N; ++i)
+		pset_new_remove(&set, ptr(i));
+	assert(pset_new_size(&set) == 0);
+	for (unsigned i = 0; i < N; ++i)
+		assert(!pset_new_contains(&set, ptr(i)));
+
+	pset_new_destroy(&set);
+}
+
+static void test_iterate(void)
+{
+	pset_new_t set;
+	pset_new_init_size(&set, N);
+
+	for (unsigned i = 0; i < N; ++i)
+		pset_new_insert(&set, ptr(i));
+
+	bool seen[N] = { false };
+	pset_new_iterator_t iter;
+	size_t count = 0;
+	void  *value;
+	foreach_pset_new(&set, void*, value, iter) {
+		size_t index = (size_t)((char*)value - storage);
+		assert(index < N);
+		assert(!seen[index]);
+		seen[index] = true;
+		++count;
+	}
+	assert(count == N);
+
+	pset_new_destroy(&set);
+}
+
+int main(void)
+{
+	test_insert_find();
+	test_remove();
+	test_iterate();
+	return 0;
+}
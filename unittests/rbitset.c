@@ -54,6 +54,19 @@ int main(void)
 	assert(rbitset_prev(field1, 3, false) == 2);
 	assert(rbitset_prev(field1, 1, false) == 0);
 
+	unsigned *big0 = rbitset_malloc(200);
+	unsigned *big1 = rbitset_malloc(200);
+	rbitset_set(big0, 2);
+	rbitset_set(big0, 190);
+	rbitset_set(big1, 2);
+	assert(!rbitset_or_changed(big0, big1, 200));
+	assert(rbitset_or_changed(big1, big0, 200));
+	assert(rbitsets_equal(big0, big1, 200));
+	assert(!rbitset_copy_changed(big0, big1, 200));
+	rbitset_set(big1, 77);
+	assert(rbitset_copy_changed(big0, big1, 200));
+	assert(rbitsets_equal(big0, big1, 200));
+
 	unsigned *null = (unsigned*)0;
 	rbitset_flip_all(null, 0);
 	rbitset_set_all(null, 0);
@@ -64,6 +77,8 @@ int main(void)
 	rbitset_and(null, 0, 0);
 	rbitset_or(null, 0, 0);
 	rbitset_andnot(null, 0, 0);
+	assert(!rbitset_or_changed(null, 0, 0));
+	assert(!rbitset_copy_changed(null, 0, 0));
 	assert(rbitsets_equal(null, NULL, 0));
 	assert(rbitset_contains(null, NULL, 0));
 	assert(!rbitsets_have_common(null, NULL, 0));
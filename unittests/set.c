@@ -0,0 +1,126 @@
+#include "pset.h"
+#include "set.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define N 5000
+
+static unsigned string_hash(char const *str, size_t len)
+{
+	unsigned hash = 0;
+	for (size_t i = 0; i < len; ++i)
+		hash = 31 * hash + (unsigned char)str[i];
+	return hash;
+}
+
+static int string_cmp(void const *elt, void const *key, size_t size)
+{
+	return memcmp(elt, key, size);
+}
+
+static void test_set(void)
+{
+	set *strings = new_set(string_cmp, 16);
+
+	char buf[32];
+	for (unsigned i = 0; i < N; ++i) {
+		size_t len = (size_t)snprintf(buf, sizeof(buf), "element%u", i);
+		char  *elt = set_insert(char, strings, buf, len,
+		                        string_hash(buf, len));
+		assert(memcmp(elt, buf, len) == 0);
+	}
+	assert(set_count(strings) == N);
+
+	/* inserting again must return the existing copies */
+	for (unsigned i = 0; i < N; ++i) {
+		size_t len = (size_t)snprintf(buf, sizeof(buf), "element%u", i);
+		unsigned hash  = string_hash(buf, len);
+		char    *found = set_find(char, strings, buf, len, hash);
+		assert(found != NULL);
+		assert(set_insert(char, strings, buf, len, hash) == found);
+	}
+	assert(set_count(strings) == N);
+
+	/* element copies must be stable over later insertions */
+	size_t   len0  = strlen("element0");
+	unsigned hash0 = string_hash("element0", len0);
+	char    *elt0  = set_find(char, strings, "element0", len0, hash0);
+	size_t   len   = (size_t)snprintf(buf, sizeof(buf), "extra");
+	set_insert(char, strings, buf, len, string_hash(buf, len));
+	assert(set_find(char, strings, "element0", len0, hash0) == elt0);
+
+	/* hinsert0 zero-terminates the copy */
+	set_entry *entry = set_hinsert0(strings, "zero", 4,
+	                                string_hash("zero", 4));
+	assert(entry->size == 4);
+	assert(strcmp((char const*)entry->dptr, "zero") == 0);
+
+	size_t n_visited = 0;
+	foreach_set(strings, char, elt) {
+		assert(elt != NULL);
+		++n_visited;
+	}
+	assert(n_visited == set_count(strings));
+
+	del_set(strings);
+}
+
+static char storage[N];
+
+static void test_pset(void)
+{
+	pset *set = pset_new_ptr_default();
+
+	for (unsigned i = 0; i < N; ++i) {
+		assert(pset_find_ptr(set, &storage[i]) == NULL);
+		assert(pset_insert_ptr(set, &storage[i]) == &storage[i]);
+		assert(pset_find_ptr(set, &storage[i]) == &storage[i]);
+	}
+	assert(pset_count(set) == N);
+
+	/* inserting again must not create duplicates */
+	for (unsigned i = 0; i < N; ++i)
+		assert(pset_insert_ptr(set, &storage[i]) == &storage[i]);
+	assert(pset_count(set) == N);
+
+	/* remove every second element and reinsert into the tombstones */
+	for (unsigned i = 0; i < N; i += 2)
+		assert(pset_remove_ptr(set, &storage[i]) == &storage[i]);
+	assert(pset_count(set) == N / 2);
+	for (unsigned i = 0; i < N; ++i)
+		assert((pset_find_ptr(set, &storage[i]) != NULL) == (i % 2 != 0));
+	for (unsigned i = 0; i < N; i += 2)
+		pset_insert_ptr(set, &storage[i]);
+	assert(pset_count(set) == N);
+
+	size_t n_visited = 0;
+	foreach_pset(set, char, elt) {
+		assert(elt >= storage && elt < storage + N);
+		++n_visited;
+	}
+	assert(n_visited == N);
+
+	/* break an unfinished iteration, then iterate again */
+	foreach_pset(set, char, elt) {
+		pset_break(set);
+		break;
+	}
+	n_visited = 0;
+	foreach_pset(set, char, elt) {
+		(void)elt;
+		++n_visited;
+	}
+	assert(n_visited == N);
+
+	del_pset(set);
+}
+
+int main(void)
+{
+	test_set();
+	test_pset();
+	return 0;
+}
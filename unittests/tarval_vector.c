@@ -0,0 +1,81 @@
+#include "ident_t.h"
+#include "irmode_t.h"
+#include "irprog_t.h"
+#include "tv_t.h"
+#include "type_t.h"
+#include "util.h"
+#include "xmalloc.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+int main(void)
+{
+	init_ident();
+	init_tarval_1();
+	init_irprog_1();
+	init_mode();
+	init_tarval_2();
+
+	ir_mode *vec4 = new_vector_mode(mode_Is, 4);
+	assert(mode_is_vector(vec4));
+	assert(get_mode_lane_mode(vec4) == mode_Is);
+	assert(get_mode_n_lanes(vec4) == 4);
+	assert(get_mode_size_bits(vec4) == 4 * get_mode_size_bits(mode_Is));
+	/* registering the same vector mode again yields the existing one */
+	assert(new_vector_mode(mode_Is, 4) == vec4);
+
+	/* construction and interning */
+	ir_tarval *lanes[4];
+	for (int i = 0; i < 4; ++i)
+		lanes[i] = new_tarval_from_long(i + 1, mode_Is);
+	ir_tarval *v = new_tarval_vector(lanes, 4, vec4);
+	assert(get_tarval_mode(v) == vec4);
+	for (int i = 0; i < 4; ++i)
+		assert(get_tarval_vector_lane(v, i) == lanes[i]);
+	assert(new_tarval_vector(lanes, 4, vec4) == v);
+
+	/* splat and mode constants */
+	ir_tarval *zero = new_tarval_from_long(0, mode_Is);
+	assert(new_tarval_vector_splat(zero, vec4) == get_mode_null(vec4));
+	ir_tarval *one = new_tarval_from_long(1, mode_Is);
+	assert(new_tarval_vector_splat(one, vec4) == get_mode_one(vec4));
+
+	/* lane-wise folding */
+	ir_tarval *sum = tarval_add(v, v);
+	for (int i = 0; i < 4; ++i)
+		assert(get_tarval_vector_lane(sum, i)
+		    == new_tarval_from_long(2 * (i + 1), mode_Is));
+	assert(tarval_sub(sum, v) == v);
+	assert(tarval_mul(v, get_mode_one(vec4)) == v);
+	assert(tarval_add(v, get_mode_null(vec4)) == v);
+	assert(tarval_neg(tarval_neg(v)) == v);
+	assert(tarval_eor(v, v) == get_mode_null(vec4));
+	assert(tarval_and(v, get_mode_all_one(vec4)) == v);
+	assert(tarval_or(v, get_mode_null(vec4)) == v);
+
+	/* ascii round trip as used by the ir serializer */
+	char buf[256];
+	const char *ascii = ir_tarval_to_ascii(buf, sizeof(buf), v);
+	assert(ir_tarval_from_ascii(ascii, vec4) == v);
+
+	/* byte access composes the lanes in little endian lane order */
+	unsigned char bytes[16];
+	tarval_to_bytes(bytes, v);
+	for (int i = 0; i < 4; ++i) {
+		assert(bytes[4 * i] == (unsigned char)(i + 1));
+		assert(get_tarval_sub_bits(v, 4 * i) == (unsigned char)(i + 1));
+	}
+
+	/* float lanes fold lane-wise, too */
+	ir_mode   *vecd2 = new_vector_mode(mode_D, 2);
+	ir_tarval *dv    = new_tarval_vector_splat(
+		new_tarval_from_double(1.5, mode_D), vecd2);
+	ir_tarval *dsum  = tarval_add(dv, dv);
+	assert(get_tarval_vector_lane(dsum, 0)
+	    == new_tarval_from_double(3.0, mode_D));
+	assert(ir_tarval_from_ascii(ir_tarval_to_ascii(buf, sizeof(buf), dsum),
+	                            vecd2) == dsum);
+
+	return 0;
+}